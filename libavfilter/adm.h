@@ -0,0 +1,58 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_ADM_H
+#define AVFILTER_ADM_H
+
+#include <stddef.h>
+
+/**
+ * All functions may process up to 7 elements past w, the buffers must have
+ * room for them.
+ */
+typedef struct ADMDSPContext {
+    /**
+     * Vertical db2 wavelet pass: lo[j] and hi[j] are the low and high pass
+     * filtered src[0..3][j], for j in [0, w).
+     */
+    void (*dwt_v)(float *lo, float *hi, const float *const *src, int w);
+    /**
+     * Horizontal db2 wavelet pass with decimation: lo[j] and hi[j] are the
+     * low and high pass filtered src[2 * j - 1 .. 2 * j + 2], for j in [0, w).
+     * src must be readable from src[-2].
+     */
+    void (*dwt_h)(float *lo, float *hi, const float *src, int w);
+    /**
+     * Split the h, v and d detail bands of the distorted picture (dis) into
+     * the part restored from the reference (r) and the additive impairment,
+     * weighted with the contrast sensitivity function (a). f is the
+     * contribution of a to the masking threshold.
+     *
+     * The h, v and d bands of every buffer are band_stride floats apart.
+     * factors holds the csf weights of the h, v and d bands followed by the
+     * enhancement gain limit.
+     */
+    void (*decouple)(float *r, float *a, float *f, const float *ref,
+                     const float *dis, ptrdiff_t band_stride,
+                     const float *factors, int w);
+} ADMDSPContext;
+
+void ff_adm_init_dsp(ADMDSPContext *dsp);
+void ff_adm_init_x86(ADMDSPContext *dsp);
+
+#endif /* AVFILTER_ADM_H */
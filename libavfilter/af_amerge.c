@@ -209,6 +209,48 @@ static inline void copy_samples(int nb_inputs, struct amerge_input in[],
     }
 }
 
+typedef struct ThreadData {
+    AVFrame **in;
+    AVFrame *out;
+} ThreadData;
+
+static int copy_jobs(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AMergeContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int nb_samples = td->out->nb_samples;
+    const int start = (nb_samples * jobnr) / nb_jobs;
+    const int end = (nb_samples * (jobnr + 1)) / nb_jobs;
+    const int ns = end - start;
+    uint8_t *ins[SWR_CH_MAX], *outs;
+
+    if (!ns)
+        return 0;
+
+    for (int i = 0; i < s->nb_inputs; i++)
+        ins[i] = td->in[i]->data[0] + start * s->in[i].nb_ch * s->bps;
+    outs = td->out->data[0] + start * td->out->ch_layout.nb_channels * s->bps;
+
+    /* Unroll the most common sample formats: speed +~350% for the loop,
+       +~13% overall (including two common decoders) */
+    switch (s->bps) {
+        case 1:
+            copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, ns, 1);
+            break;
+        case 2:
+            copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, ns, 2);
+            break;
+        case 4:
+            copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, ns, 4);
+            break;
+        default:
+            copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, ns, s->bps);
+            break;
+    }
+
+    return 0;
+}
+
 static void free_frames(int nb_inputs, AVFrame **input_frames)
 {
     int i;
@@ -222,7 +264,7 @@ static int try_push_frame(AVFilterContext *ctx, int nb_samples)
     AVFilterLink *outlink = ctx->outputs[0];
     int i, ret;
     AVFrame *outbuf, *inbuf[SWR_CH_MAX] = { NULL };
-    uint8_t *outs, *ins[SWR_CH_MAX];
+    ThreadData td;
 
     for (i = 0; i < ctx->nb_inputs; i++) {
         ret = ff_inlink_consume_samples(ctx->inputs[i], nb_samples, nb_samples, &inbuf[i]);
@@ -230,7 +272,6 @@ static int try_push_frame(AVFilterContext *ctx, int nb_samples)
             free_frames(i, inbuf);
             return ret;
         }
-        ins[i] = inbuf[i]->data[0];
     }
 
     outbuf = ff_get_audio_buffer(ctx->outputs[0], nb_samples);
@@ -239,7 +280,6 @@ static int try_push_frame(AVFilterContext *ctx, int nb_samples)
         return AVERROR(ENOMEM);
     }
 
-    outs = outbuf->data[0];
     outbuf->pts = inbuf[0]->pts;
 
     outbuf->nb_samples     = nb_samples;
@@ -252,26 +292,10 @@ FF_DISABLE_DEPRECATION_WARNINGS
 FF_ENABLE_DEPRECATION_WARNINGS
 #endif
 
-    while (nb_samples) {
-        /* Unroll the most common sample formats: speed +~350% for the loop,
-           +~13% overall (including two common decoders) */
-        switch (s->bps) {
-            case 1:
-                copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, 1);
-                break;
-            case 2:
-                copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, 2);
-                break;
-            case 4:
-                copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, 4);
-                break;
-            default:
-                copy_samples(s->nb_inputs, s->in, s->route, ins, &outs, nb_samples, s->bps);
-                break;
-        }
-
-        nb_samples = 0;
-    }
+    td.in  = inbuf;
+    td.out = outbuf;
+    ff_filter_execute(ctx, copy_jobs, &td, NULL,
+                      FFMIN(nb_samples, ff_filter_get_nb_threads(ctx)));
 
     free_frames(s->nb_inputs, inbuf);
     return ff_filter_frame(ctx->outputs[0], outbuf);
@@ -354,5 +378,6 @@ const AVFilter ff_af_amerge = {
     FILTER_OUTPUTS(amerge_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &amerge_class,
-    .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_INPUTS |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
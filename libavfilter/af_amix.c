@@ -177,6 +177,7 @@ typedef struct MixContext {
     float *scale_norm;          /**< normalization factor for every input */
     int64_t next_pts;           /**< calculated pts for next output frame */
     FrameList *frame_list;      /**< list of frame info for the first input */
+    AVFrame **in_bufs;          /**< samples read from each input for mixing */
 } MixContext;
 
 #define OFFSET(x) offsetof(MixContext, x)
@@ -274,6 +275,10 @@ static int config_output(AVFilterLink *outlink)
     memset(s->input_state, INPUT_ON, s->nb_inputs);
     s->active_inputs = s->nb_inputs;
 
+    s->in_bufs = av_calloc(s->nb_inputs, sizeof(*s->in_bufs));
+    if (!s->in_bufs)
+        return AVERROR(ENOMEM);
+
     s->input_scale = av_calloc(s->nb_inputs, sizeof(*s->input_scale));
     s->scale_norm  = av_calloc(s->nb_inputs, sizeof(*s->scale_norm));
     if (!s->input_scale || !s->scale_norm)
@@ -291,6 +296,64 @@ static int config_output(AVFilterLink *outlink)
     return 0;
 }
 
+/**
+ * Add the planes [p_start, p_end) of one input, samples [start, end) of
+ * each, to the output.
+ */
+static void mix_input(MixContext *s, AVFrame *out_buf, const AVFrame *in_buf,
+                      float scale, int p_start, int p_end, int start, int end)
+{
+    const int is_float = out_buf->format == AV_SAMPLE_FMT_FLT ||
+                         out_buf->format == AV_SAMPLE_FMT_FLTP;
+
+    for (int p = p_start; p < p_end; p++) {
+        if (is_float) {
+            s->fdsp->vector_fmac_scalar((float *)out_buf->extended_data[p] + start,
+                                        (float *) in_buf->extended_data[p] + start,
+                                        scale, end - start);
+        } else {
+            s->fdsp->vector_dmac_scalar((double *)out_buf->extended_data[p] + start,
+                                        (double *) in_buf->extended_data[p] + start,
+                                        scale, end - start);
+        }
+    }
+}
+
+/**
+ * Mix the samples of all active inputs into a part of the output.
+ *
+ * Planar formats are split by channels, packed formats by sample ranges
+ * which keep the alignment float_dsp needs.
+ */
+static int mix_jobs(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    MixContext *s = ctx->priv;
+    AVFrame *out_buf = arg;
+    const int planes = s->planar ? s->nb_channels : 1;
+    const int plane_size = FFALIGN(out_buf->nb_samples * (s->planar ? 1 : s->nb_channels), 16);
+    int start = 0, end = plane_size;
+    int p_start = 0, p_end = planes;
+
+    if (planes > 1) {
+        p_start = (planes * jobnr) / nb_jobs;
+        p_end   = (planes * (jobnr + 1)) / nb_jobs;
+    } else {
+        start = ((plane_size / 16) * jobnr / nb_jobs) * 16;
+        end   = ((plane_size / 16) * (jobnr + 1) / nb_jobs) * 16;
+    }
+
+    if (start >= end)
+        return 0;
+
+    for (int i = 0; i < s->nb_inputs; i++) {
+        if (s->input_state[i] & INPUT_ON)
+            mix_input(s, out_buf, s->in_bufs[i], s->input_scale[i],
+                      p_start, p_end, start, end);
+    }
+
+    return 0;
+}
+
 /**
  * Read samples from the input FIFOs, mix, and write to the output link.
  */
@@ -298,8 +361,8 @@ static int output_frame(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
     MixContext      *s = ctx->priv;
-    AVFrame *out_buf, *in_buf;
-    int nb_samples, ns, i;
+    AVFrame *out_buf;
+    int nb_samples, nb_jobs, ns, i;
 
     if (s->input_state[0] & INPUT_ON) {
         /* first input live: use the corresponding frame size */
@@ -344,40 +407,40 @@ static int output_frame(AVFilterLink *outlink)
     if (!out_buf)
         return AVERROR(ENOMEM);
 
-    in_buf = ff_get_audio_buffer(outlink, nb_samples);
-    if (!in_buf) {
-        av_frame_free(&out_buf);
-        return AVERROR(ENOMEM);
-    }
+    if (s->planar)
+        nb_jobs = FFMIN(s->nb_channels, ff_filter_get_nb_threads(ctx));
+    else
+        nb_jobs = FFMIN(FFALIGN(nb_samples * s->nb_channels, 16) / 16,
+                        ff_filter_get_nb_threads(ctx));
 
     for (i = 0; i < s->nb_inputs; i++) {
         if (s->input_state[i] & INPUT_ON) {
-            int planes, plane_size, p;
+            /* a single job mixes every input right after reading it, reusing
+             * one buffer keeps the working set in cache */
+            AVFrame **in_buf = &s->in_bufs[nb_jobs > 1 ? i : 0];
+
+            /* the read buffers are kept around, only grow them when needed */
+            if (!*in_buf || (*in_buf)->nb_samples < nb_samples) {
+                av_frame_free(in_buf);
+                *in_buf = ff_get_audio_buffer(outlink, nb_samples);
+                if (!*in_buf) {
+                    av_frame_free(&out_buf);
+                    return AVERROR(ENOMEM);
+                }
+            }
 
-            av_audio_fifo_read(s->fifos[i], (void **)in_buf->extended_data,
+            av_audio_fifo_read(s->fifos[i], (void **)(*in_buf)->extended_data,
                                nb_samples);
 
-            planes     = s->planar ? s->nb_channels : 1;
-            plane_size = nb_samples * (s->planar ? 1 : s->nb_channels);
-            plane_size = FFALIGN(plane_size, 16);
-
-            if (out_buf->format == AV_SAMPLE_FMT_FLT ||
-                out_buf->format == AV_SAMPLE_FMT_FLTP) {
-                for (p = 0; p < planes; p++) {
-                    s->fdsp->vector_fmac_scalar((float *)out_buf->extended_data[p],
-                                                (float *) in_buf->extended_data[p],
-                                                s->input_scale[i], plane_size);
-                }
-            } else {
-                for (p = 0; p < planes; p++) {
-                    s->fdsp->vector_dmac_scalar((double *)out_buf->extended_data[p],
-                                                (double *) in_buf->extended_data[p],
-                                                s->input_scale[i], plane_size);
-                }
-            }
+            if (nb_jobs == 1)
+                mix_input(s, out_buf, *in_buf, s->input_scale[i],
+                          0, s->planar ? s->nb_channels : 1, 0,
+                          FFALIGN(nb_samples * (s->planar ? 1 : s->nb_channels), 16));
         }
     }
-    av_frame_free(&in_buf);
+
+    if (nb_jobs > 1)
+        ff_filter_execute(ctx, mix_jobs, out_buf, NULL, nb_jobs);
 
     out_buf->pts = s->next_pts;
     if (s->next_pts != AV_NOPTS_VALUE)
@@ -583,6 +646,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     frame_list_clear(s->frame_list);
     av_freep(&s->frame_list);
     av_freep(&s->input_state);
+    for (i = 0; i < s->nb_inputs && s->in_bufs; i++)
+        av_frame_free(&s->in_bufs[i]);
+    av_freep(&s->in_bufs);
     av_freep(&s->input_scale);
     av_freep(&s->scale_norm);
     av_freep(&s->weights);
@@ -628,5 +694,6 @@ const AVFilter ff_af_amix = {
     FILTER_SAMPLEFMTS(AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_FLTP,
                       AV_SAMPLE_FMT_DBL, AV_SAMPLE_FMT_DBLP),
     .process_command = process_command,
-    .flags          = AVFILTER_FLAG_DYNAMIC_INPUTS,
+    .flags          = AVFILTER_FLAG_DYNAMIC_INPUTS |
+                      AVFILTER_FLAG_SLICE_THREADS,
 };
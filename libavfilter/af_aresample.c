@@ -141,6 +141,11 @@ static int config_output(AVFilterLink *outlink)
     if (ret < 0)
         return ret;
 
+    /* an explicit threads option of the filter is used to resample
+     * channels in parallel */
+    if (ctx->nb_threads > 0)
+        av_opt_set_int(aresample->swr, "threads", ff_filter_get_nb_threads(ctx), 0);
+
     ret = swr_init(aresample->swr);
     if (ret < 0)
         return ret;
@@ -28,8 +28,10 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include "libavutil/avstring.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/float_dsp.h"
 #include "libavutil/opt.h"
 #include "libswresample/swresample.h"
 #include "audio.h"
@@ -52,6 +54,11 @@ typedef struct PanContext {
     /* channel mapping specific */
     int channel_map[MAX_CHANNELS];
     struct SwrContext *swr;
+
+    /* planar float and double are mixed directly, one job per output channel */
+    int native;
+    int nb_input_channels;
+    AVFloatDSPContext *fdsp;
 } PanContext;
 
 static void skip_spaces(char **arg)
@@ -290,6 +297,18 @@ static int config_props(AVFilterLink *link)
         return AVERROR_PATCHWELCOME;
     }
 
+    pan->nb_input_channels = link->ch_layout.nb_channels;
+    /* planar float is mixed directly with float_dsp; the summation order
+     * and the fused multiply-adds of some float_dsp versions make the
+     * result differ from libswresample in the last bits */
+    pan->native = link->format == AV_SAMPLE_FMT_FLTP ||
+                  link->format == AV_SAMPLE_FMT_DBLP;
+    if (pan->native && !pan->fdsp) {
+        pan->fdsp = avpriv_float_dsp_alloc(0);
+        if (!pan->fdsp)
+            return AVERROR(ENOMEM);
+    }
+
     // init libswresample context
     ret = swr_alloc_set_opts2(&pan->swr,
                               &pan->out_channel_layout, link->format, link->sample_rate,
@@ -364,6 +383,75 @@ static int config_props(AVFilterLink *link)
     return 0;
 }
 
+static int mix_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PanContext *pan = ctx->priv;
+    AVFrame **frames = arg;
+    const AVFrame *in = frames[0];
+    AVFrame *out = frames[1];
+    const int nb_channels = out->ch_layout.nb_channels;
+    const int start = (nb_channels * jobnr) / nb_jobs;
+    const int end = (nb_channels * (jobnr + 1)) / nb_jobs;
+    const int nb_samples = in->nb_samples;
+    const int size = nb_samples * av_get_bytes_per_sample(out->format);
+    /* float_dsp handles multiples of 16 samples, the rest is mixed here */
+    const int len = nb_samples & ~15;
+
+    for (int i = start; i < end; i++) {
+        int first = 1;
+
+        for (int j = 0; j < pan->nb_input_channels; j++) {
+            const double gain = pan->gain[i][j];
+
+            if (!gain)
+                continue;
+
+            if (first && gain == 1.0) {
+                /* exact, and much cheaper than a scalar multiply */
+                memcpy(out->extended_data[i], in->extended_data[j], size);
+            } else if (out->format == AV_SAMPLE_FMT_FLTP) {
+                float *dst = (float *)out->extended_data[i];
+                const float *src = (const float *)in->extended_data[j];
+                const float fgain = gain;
+
+                if (first) {
+                    if (len)
+                        pan->fdsp->vector_fmul_scalar(dst, src, fgain, len);
+                    for (int n = len; n < nb_samples; n++)
+                        dst[n] = src[n] * fgain;
+                } else {
+                    if (len)
+                        pan->fdsp->vector_fmac_scalar(dst, src, fgain, len);
+                    for (int n = len; n < nb_samples; n++)
+                        dst[n] += src[n] * fgain;
+                }
+            } else {
+                double *dst = (double *)out->extended_data[i];
+                const double *src = (const double *)in->extended_data[j];
+
+                if (first) {
+                    if (len)
+                        pan->fdsp->vector_dmul_scalar(dst, src, gain, len);
+                    for (int n = len; n < nb_samples; n++)
+                        dst[n] = src[n] * gain;
+                } else {
+                    if (len)
+                        pan->fdsp->vector_dmac_scalar(dst, src, gain, len);
+                    for (int n = len; n < nb_samples; n++)
+                        dst[n] += src[n] * gain;
+                }
+            }
+            first = 0;
+        }
+
+        /* output channels without any input are silent */
+        if (first)
+            memset(out->extended_data[i], 0, size);
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
     int ret;
@@ -376,8 +464,17 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
         av_frame_free(&insamples);
         return AVERROR(ENOMEM);
     }
-    swr_convert(pan->swr, outsamples->extended_data, n,
-                (void *)insamples->extended_data, n);
+    if (pan->native) {
+        AVFilterContext *ctx = inlink->dst;
+        AVFrame *frames[2] = { insamples, outsamples };
+
+        ff_filter_execute(ctx, mix_channels, frames, NULL,
+                          FFMIN(outlink->ch_layout.nb_channels,
+                                ff_filter_get_nb_threads(ctx)));
+    } else {
+        swr_convert(pan->swr, outsamples->extended_data, n,
+                    (void *)insamples->extended_data, n);
+    }
     av_frame_copy_props(outsamples, insamples);
 #if FF_API_OLD_CHANNEL_LAYOUT
 FF_DISABLE_DEPRECATION_WARNINGS
@@ -397,6 +494,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     PanContext *pan = ctx->priv;
     swr_free(&pan->swr);
+    av_freep(&pan->fdsp);
 }
 
 #define OFFSET(x) offsetof(PanContext, x)
@@ -434,4 +532,5 @@ const AVFilter ff_af_pan = {
     FILTER_INPUTS(pan_inputs),
     FILTER_OUTPUTS(pan_outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
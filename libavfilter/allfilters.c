@@ -171,6 +171,7 @@ extern const AVFilter ff_asrc_sine;
 extern const AVFilter ff_asink_anullsink;
 
 extern const AVFilter ff_vf_addroi;
+extern const AVFilter ff_vf_adm;
 extern const AVFilter ff_vf_alphaextract;
 extern const AVFilter ff_vf_alphamerge;
 extern const AVFilter ff_vf_amplify;
@@ -400,6 +401,7 @@ extern const AVFilter ff_vf_program_opencl;
 extern const AVFilter ff_vf_pseudocolor;
 extern const AVFilter ff_vf_psnr;
 extern const AVFilter ff_vf_pullup;
+extern const AVFilter ff_vf_qcstats;
 extern const AVFilter ff_vf_qp;
 extern const AVFilter ff_vf_random;
 extern const AVFilter ff_vf_readeia608;
@@ -25,7 +25,9 @@
 
 #include "dnn_backend_native.h"
 #include "libavutil/avassert.h"
+#include "libavutil/cpu.h"
 #include "dnn_backend_native_layer_conv2d.h"
+#include "dnn_backend_native_layer_dense.h"
 #include "dnn_backend_native_layers.h"
 #include "dnn_io_proc.h"
 #include "dnn_backend_common.h"
@@ -48,6 +50,59 @@ static const AVClass dnn_native_class = {
 
 static int execute_model_native(Queue *lltask_queue);
 
+static void native_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    NativeContext *ctx = priv;
+    ctx->job_func(ctx->job_arg, jobnr, nb_jobs);
+}
+
+int ff_dnn_native_get_nb_threads(const NativeContext *ctx)
+{
+    return ctx && ctx->slicethread ? ctx->nb_threads : 1;
+}
+
+void ff_dnn_native_execute(NativeContext *ctx, void (*func)(void *arg, int jobnr, int nb_jobs),
+                           void *arg, int nb_jobs)
+{
+    if (!ctx || !ctx->slicethread) {
+        for (int i = 0; i < nb_jobs; i++)
+            func(arg, i, nb_jobs);
+        return;
+    }
+
+    ctx->job_func = func;
+    ctx->job_arg  = arg;
+    avpriv_slicethread_execute(ctx->slicethread, nb_jobs, 0);
+}
+
+int ff_dnn_native_alloc_job_buffer(NativeContext *ctx, int size)
+{
+    if (size > ctx->job_buffer_size) {
+        av_freep(&ctx->job_buffer);
+        ctx->job_buffer_size = 0;
+        ctx->job_buffer = av_malloc_array(ff_dnn_native_get_nb_threads(ctx), size * sizeof(float));
+        if (!ctx->job_buffer)
+            return AVERROR(ENOMEM);
+        ctx->job_buffer_size = size;
+    }
+    return 0;
+}
+
+float *ff_dnn_native_pack_kernel(const float *kernel, int nb_filters, int nb_taps,
+                                 int *filter_stride)
+{
+    const int stride = FFALIGN(nb_filters, 16);
+    float *packed = av_calloc(nb_taps, stride * sizeof(*packed));
+
+    if (!packed)
+        return NULL;
+    for (int n = 0; n < nb_filters; n++)
+        for (int i = 0; i < nb_taps; i++)
+            packed[i * stride + n] = kernel[n * nb_taps + i];
+    *filter_stride = stride;
+    return packed;
+}
+
 static int extract_lltask_from_task(TaskItem *task, Queue *lltask_queue)
 {
     NativeModel *native_model = task->model;
@@ -195,12 +250,28 @@ DNNModel *ff_dnn_load_model_native(const char *model_filename, DNNFunctionType f
         native_model->ctx.options.async = 0;
     }
 
-#if !HAVE_PTHREAD_CANCEL
-    if (native_model->ctx.options.conv2d_threads > 1){
-        av_log(&native_model->ctx, AV_LOG_WARNING, "'conv2d_threads' option was set but it is not supported "
-                       "on this build (pthread support is required)\n");
+    if ((int)native_model->ctx.options.conv2d_threads != 1) {
+        int nb_threads = (int)native_model->ctx.options.conv2d_threads;
+        int ret;
+
+        if (nb_threads <= 0 || nb_threads > av_cpu_count())
+            nb_threads = 0;
+        ret = avpriv_slicethread_create(&native_model->ctx.slicethread, &native_model->ctx,
+                                        native_worker, NULL, nb_threads);
+        if (ret == AVERROR(ENOSYS)) {
+            if (nb_threads > 1)
+                av_log(&native_model->ctx, AV_LOG_WARNING, "'conv2d_threads' option was set but it is not supported "
+                       "on this build (thread support is required)\n");
+        } else if (ret < 0) {
+            goto fail;
+        } else {
+            native_model->ctx.nb_threads = ret;
+        }
     }
-#endif
+
+    native_model->ctx.fdsp = avpriv_float_dsp_alloc(1);
+    if (!native_model->ctx.fdsp)
+        goto fail;
 
     avio_seek(model_file_context, file_size - 8, SEEK_SET);
     native_model->layers_num = (int32_t)avio_rl32(model_file_context);
@@ -242,6 +313,14 @@ DNNModel *ff_dnn_load_model_native(const char *model_filename, DNNFunctionType f
             goto fail;
         }
         dnn_size += parsed_size;
+
+        if (layer_type == DLT_CONV2D || layer_type == DLT_DENSE) {
+            const int filter_stride = layer_type == DLT_CONV2D ?
+                ((ConvolutionalParams *)native_model->layers[layer].params)->filter_stride :
+                ((DenseParams *)native_model->layers[layer].params)->filter_stride;
+            if (ff_dnn_native_alloc_job_buffer(&native_model->ctx, filter_stride) < 0)
+                goto fail;
+        }
     }
 
     for (int32_t i = 0; i < native_model->operands_num; ++i){
@@ -516,6 +595,7 @@ void ff_dnn_free_model_native(DNNModel **model)
 {
     NativeModel *native_model;
     ConvolutionalParams *conv_params;
+    DenseParams *dense_params;
     int32_t layer;
 
     if (*model)
@@ -524,10 +604,18 @@ void ff_dnn_free_model_native(DNNModel **model)
             native_model = (*model)->model;
             if (native_model->layers) {
                 for (layer = 0; layer < native_model->layers_num; ++layer){
+                    if (!native_model->layers[layer].params)
+                        continue;
                     if (native_model->layers[layer].type == DLT_CONV2D){
                         conv_params = (ConvolutionalParams *)native_model->layers[layer].params;
                         av_freep(&conv_params->kernel);
+                        av_freep(&conv_params->packed_kernel);
                         av_freep(&conv_params->biases);
+                    } else if (native_model->layers[layer].type == DLT_DENSE) {
+                        dense_params = (DenseParams *)native_model->layers[layer].params;
+                        av_freep(&dense_params->kernel);
+                        av_freep(&dense_params->packed_kernel);
+                        av_freep(&dense_params->biases);
                     }
                     av_freep(&native_model->layers[layer].params);
                 }
@@ -554,6 +642,9 @@ void ff_dnn_free_model_native(DNNModel **model)
             }
             ff_queue_destroy(native_model->task_queue);
 
+            avpriv_slicethread_free(&native_model->ctx.slicethread);
+            av_freep(&native_model->ctx.fdsp);
+            av_freep(&native_model->ctx.job_buffer);
             av_freep(&native_model);
         }
         av_freep(model);
@@ -29,7 +29,9 @@
 
 #include "../dnn_interface.h"
 #include "libavformat/avio.h"
+#include "libavutil/float_dsp.h"
 #include "libavutil/opt.h"
+#include "libavutil/slicethread.h"
 #include "queue.h"
 
 /**
@@ -118,6 +120,20 @@ typedef struct NativeOptions{
 typedef struct NativeContext {
     const AVClass *class;
     NativeOptions options;
+    /**
+     * worker threads kept for the lifetime of the model, NULL if layers
+     * are executed on the calling thread only
+     */
+    AVSliceThread *slicethread;
+    int nb_threads;
+    void (*job_func)(void *arg, int jobnr, int nb_jobs);
+    void *job_arg;
+    AVFloatDSPContext *fdsp;
+    /**
+     * scratch memory of the layers, job_buffer_size floats for each job
+     */
+    float *job_buffer;
+    int job_buffer_size;
 } NativeContext;
 
 // Represents simple feed-forward convolutional network.
@@ -142,6 +158,34 @@ int ff_dnn_flush_native(const DNNModel *model);
 
 void ff_dnn_free_model_native(DNNModel **model);
 
+/**
+ * @return the number of jobs a layer can usefully split its work into
+ */
+int ff_dnn_native_get_nb_threads(const NativeContext *ctx);
+
+/**
+ * Run func for jobnr 0..nb_jobs-1 on the worker threads of ctx, or
+ * sequentially if ctx has none. Returns when all jobs are done.
+ */
+void ff_dnn_native_execute(NativeContext *ctx, void (*func)(void *arg, int jobnr, int nb_jobs),
+                           void *arg, int nb_jobs);
+
+/**
+ * Make sure ctx has a job buffer of at least size floats for each of
+ * its jobs.
+ */
+int ff_dnn_native_alloc_job_buffer(NativeContext *ctx, int size);
+
+/**
+ * Transpose a [filter][tap] kernel to [tap][filter], padding the filter
+ * dimension to *filter_stride, a multiple of 16, so that a layer can
+ * accumulate all its filters at once with vector_fmac_scalar().
+ *
+ * @return the transposed kernel, NULL if out of memory
+ */
+float *ff_dnn_native_pack_kernel(const float *kernel, int nb_filters, int nb_taps,
+                                 int *filter_stride);
+
 // NOTE: User must check for error (return value <= 0) to handle
 // case like integer overflow.
 int32_t ff_calculate_operand_data_length(const DnnOperand *oprd);
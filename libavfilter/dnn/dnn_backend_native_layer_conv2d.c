@@ -19,8 +19,7 @@
  */
 
 #include "libavutil/avassert.h"
-#include "libavutil/thread.h"
-#include "libavutil/cpu.h"
+#include "libavutil/mem.h"
 #include "dnn_backend_native_layer_conv2d.h"
 
 #define CLAMP_TO_EDGE(x, w) ((x) < 0 ? 0 : ((x) >= (w) ? (w - 1) : (x)))
@@ -33,15 +32,8 @@ typedef struct ThreadCommonParam{
     const void *parameters;
     NativeContext *ctx;
     float *output_data;
-} ThreadCommonParam;
-
-typedef struct ThreadParam{
-    ThreadCommonParam *thread_common_param;
     int thread_start, thread_end;
-#if HAVE_PTHREAD_CANCEL
-    pthread_t thread;
-#endif
-} ThreadParam;
+} ThreadCommonParam;
 
 int ff_dnn_load_layer_conv2d(Layer *layer, AVIOContext *model_file_context, int file_size, int operands_num)
 {
@@ -82,11 +74,21 @@ int ff_dnn_load_layer_conv2d(Layer *layer, AVIOContext *model_file_context, int
         conv_params->kernel[i] = av_int2float(avio_rl32(model_file_context));
     }
 
+    conv_params->packed_kernel = ff_dnn_native_pack_kernel(conv_params->kernel, conv_params->output_num,
+                                                           kernel_size / conv_params->output_num,
+                                                           &conv_params->filter_stride);
+    if (!conv_params->packed_kernel) {
+        av_freep(&conv_params->kernel);
+        av_freep(&conv_params);
+        return 0;
+    }
+
     conv_params->biases = NULL;
     if (conv_params->has_bias) {
         conv_params->biases = av_malloc_array(conv_params->output_num, sizeof(*conv_params->biases));
         if (!conv_params->biases){
             av_freep(&conv_params->kernel);
+            av_freep(&conv_params->packed_kernel);
             av_freep(&conv_params);
             return 0;
         }
@@ -108,11 +110,10 @@ int ff_dnn_load_layer_conv2d(Layer *layer, AVIOContext *model_file_context, int
     return dnn_size;
 }
 
-static void * dnn_execute_layer_conv2d_thread(void *threadarg)
+static void dnn_execute_layer_conv2d_thread(void *threadarg, int jobnr, int nb_jobs)
 {
     //pass parameters
-    ThreadParam *thread_param = threadarg;
-    ThreadCommonParam *thread_common_param = thread_param->thread_common_param;
+    ThreadCommonParam *thread_common_param = threadarg;
     DnnOperand *operands = thread_common_param->operands;
     int32_t input_operand_index = thread_common_param->input_operand_indexes[0];
     int height = operands[input_operand_index].dims[1];
@@ -120,86 +121,91 @@ static void * dnn_execute_layer_conv2d_thread(void *threadarg)
     int channel = operands[input_operand_index].dims[3];
     const float *input = operands[input_operand_index].data;
     const ConvolutionalParams *conv_params = thread_common_param->parameters;
+    const AVFloatDSPContext *fdsp = thread_common_param->ctx->fdsp;
+    const int filter_stride = conv_params->filter_stride;
+    const float *kernel = conv_params->packed_kernel;
+    float *acc = thread_common_param->ctx->job_buffer + jobnr * thread_common_param->ctx->job_buffer_size;
+    const int rows = thread_common_param->thread_end - thread_common_param->thread_start;
+    const int thread_start = thread_common_param->thread_start + (rows *  jobnr     ) / nb_jobs;
+    const int thread_end   = thread_common_param->thread_start + (rows * (jobnr + 1)) / nb_jobs;
 
     int radius = conv_params->kernel_size >> 1;
     int src_linesize = width * conv_params->input_num;
-    int filter_linesize = conv_params->kernel_size * conv_params->input_num;
-    int filter_size = conv_params->kernel_size * filter_linesize;
     int pad_size = (conv_params->padding_method == VALID) ? (conv_params->kernel_size - 1) / 2 * conv_params->dilation : 0;
 
     float *output = thread_common_param->output_data;
-    output += (conv_params->output_num) * (width - 2 * pad_size) * (thread_param->thread_start - pad_size);
+    output += (conv_params->output_num) * (width - 2 * pad_size) * (thread_start - pad_size);
 
     av_assert0(channel == conv_params->input_num);
 
-    for (int y = thread_param->thread_start; y < thread_param->thread_end; ++y) {
+    for (int y = thread_start; y < thread_end; ++y) {
         for (int x = pad_size; x < width - pad_size; ++x) {
-            for (int n_filter = 0; n_filter < conv_params->output_num; ++n_filter) {
-                if (conv_params->has_bias)
-                    output[n_filter] = conv_params->biases[n_filter];
-                else
-                    output[n_filter] = 0.f;
-
-                for (int ch = 0; ch < conv_params->input_num; ++ch) {
-                    for (int kernel_y = 0; kernel_y < conv_params->kernel_size; ++kernel_y) {
-                        for (int kernel_x = 0; kernel_x < conv_params->kernel_size; ++kernel_x) {
-                            float input_pel;
-                            if (conv_params->padding_method == SAME_CLAMP_TO_EDGE) {
-                                int y_pos = CLAMP_TO_EDGE(y + (kernel_y - radius) * conv_params->dilation, height);
-                                int x_pos = CLAMP_TO_EDGE(x + (kernel_x - radius) * conv_params->dilation, width);
-                                input_pel = input[y_pos * src_linesize + x_pos * conv_params->input_num + ch];
-                            } else {
-                                int y_pos = y + (kernel_y - radius) * conv_params->dilation;
-                                int x_pos = x + (kernel_x - radius) * conv_params->dilation;
-                                input_pel = (x_pos < 0 || x_pos >= width || y_pos < 0 || y_pos >= height) ? 0.0 :
-                                                   input[y_pos * src_linesize + x_pos * conv_params->input_num + ch];
-                            }
-
-
-                            output[n_filter] += input_pel * conv_params->kernel[n_filter * filter_size + kernel_y * filter_linesize +
-                                                                                kernel_x * conv_params->input_num + ch];
-                        }
+            const float *k = kernel;
+
+            memset(acc, 0, filter_stride * sizeof(*acc));
+            if (conv_params->has_bias)
+                memcpy(acc, conv_params->biases, conv_params->output_num * sizeof(*acc));
+
+            for (int kernel_y = 0; kernel_y < conv_params->kernel_size; ++kernel_y) {
+                int y_pos = y + (kernel_y - radius) * conv_params->dilation;
+
+                if (conv_params->padding_method == SAME_CLAMP_TO_EDGE)
+                    y_pos = CLAMP_TO_EDGE(y_pos, height);
+
+                for (int kernel_x = 0; kernel_x < conv_params->kernel_size; ++kernel_x) {
+                    int x_pos = x + (kernel_x - radius) * conv_params->dilation;
+                    const float *src;
+
+                    if (conv_params->padding_method == SAME_CLAMP_TO_EDGE)
+                        x_pos = CLAMP_TO_EDGE(x_pos, width);
+
+                    /* zero padding contributes nothing */
+                    if (x_pos < 0 || x_pos >= width || y_pos < 0 || y_pos >= height) {
+                        k += conv_params->input_num * filter_stride;
+                        continue;
+                    }
+
+                    src = input + y_pos * src_linesize + x_pos * conv_params->input_num;
+                    for (int ch = 0; ch < conv_params->input_num; ++ch) {
+                        fdsp->vector_fmac_scalar(acc, k, src[ch], filter_stride);
+                        k += filter_stride;
                     }
                 }
+            }
+
+            for (int n_filter = 0; n_filter < conv_params->output_num; ++n_filter) {
                 switch (conv_params->activation){
                 case RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0);
+                    output[n_filter] = FFMAX(acc[n_filter], 0.0);
                     break;
                 case TANH:
-                    output[n_filter] = 2.0f  / (1.0f + exp(-2.0f * output[n_filter])) - 1.0f;
+                    output[n_filter] = 2.0f  / (1.0f + exp(-2.0f * acc[n_filter])) - 1.0f;
                     break;
                 case SIGMOID:
-                    output[n_filter] = 1.0f / (1.0f + exp(-output[n_filter]));
+                    output[n_filter] = 1.0f / (1.0f + exp(-acc[n_filter]));
                     break;
                 case NONE:
+                    output[n_filter] = acc[n_filter];
                     break;
                 case LEAKY_RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0) + 0.2 * FFMIN(output[n_filter], 0.0);
+                    output[n_filter] = FFMAX(acc[n_filter], 0.0) + 0.2 * FFMIN(acc[n_filter], 0.0);
                 }
             }
             output += conv_params->output_num;
         }
     }
-    return NULL;
 }
 
 
 int ff_dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_operand_indexes,
                                 int32_t output_operand_index, const void *parameters, NativeContext *ctx)
 {
-#if HAVE_PTHREAD_CANCEL
-    int thread_num = (ctx->options.conv2d_threads <= 0 || ctx->options.conv2d_threads > av_cpu_count())
-        ? (av_cpu_count() + 1) : (ctx->options.conv2d_threads);
-    int ret = 0, thread_stride;
-    ThreadParam *thread_param;
-#else
-    ThreadParam thread_param = { 0 };
-#endif
     ThreadCommonParam thread_common_param;
     const ConvolutionalParams *conv_params = parameters;
     int height = operands[input_operand_indexes[0]].dims[1];
     int width = operands[input_operand_indexes[0]].dims[2];
     int pad_size = (conv_params->padding_method == VALID) ? (conv_params->kernel_size - 1) / 2 * conv_params->dilation : 0;
+    int nb_jobs = FFMAX(FFMIN(ff_dnn_native_get_nb_threads(ctx), height - pad_size * 2), 1);
     DnnOperand *output_operand = &operands[output_operand_index];
     void *tmp;
 
@@ -225,41 +231,11 @@ int ff_dnn_execute_layer_conv2d(DnnOperand *operands, const int32_t *input_opera
     thread_common_param.output_operand_index = output_operand_index;
     thread_common_param.parameters = parameters;
     thread_common_param.ctx = ctx;
+    thread_common_param.thread_start = pad_size;
+    thread_common_param.thread_end = height - pad_size;
 
-#if HAVE_PTHREAD_CANCEL
-    thread_param = av_malloc_array(thread_num, sizeof(*thread_param));
-    if (!thread_param)
-        return AVERROR(ENOMEM);
-    thread_stride = (height - pad_size * 2) / thread_num;
-    //create threads
-    for (int i = 0; i < thread_num; i++){
-        int thread_ret = 0;
-        thread_param[i].thread_common_param = &thread_common_param;
-        thread_param[i].thread_start = thread_stride * i + pad_size;
-        thread_param[i].thread_end = (i == thread_num - 1) ? (height - pad_size) : (thread_param[i].thread_start + thread_stride);
-        thread_ret = pthread_create(&thread_param[i].thread, NULL,
-                                    dnn_execute_layer_conv2d_thread, &thread_param[i]);
-        if (thread_ret) {
-            thread_num = i;
-            ret = AVERROR(thread_ret);
-            break;
-        }
-    }
-
-    for (int i = 0; i < thread_num; i++){
-        pthread_join(thread_param[i].thread, NULL);
-    }
-
-    //release memory
-    av_freep(&thread_param);
-
-    return ret;
-#else
-    thread_param.thread_common_param = &thread_common_param;
-    thread_param.thread_start = pad_size;
-    thread_param.thread_end = height - pad_size;
-    dnn_execute_layer_conv2d_thread(&thread_param);
+    av_assert0(ctx->job_buffer_size >= conv_params->filter_stride);
+    ff_dnn_native_execute(ctx, dnn_execute_layer_conv2d_thread, &thread_common_param, nb_jobs);
 
     return 0;
-#endif
 }
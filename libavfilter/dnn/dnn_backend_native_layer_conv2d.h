@@ -32,6 +32,12 @@ typedef struct ConvolutionalParams{
     int32_t has_bias;
     float *kernel;
     float *biases;
+    /**
+     * kernel transposed at load time to [kernel_y][kernel_x][input channel][filter]
+     * with ff_dnn_native_pack_kernel()
+     */
+    float *packed_kernel;
+    int filter_stride;
 } ConvolutionalParams;
 
 /**
@@ -58,7 +64,8 @@ int ff_dnn_load_layer_conv2d(Layer *layer, AVIOContext *model_file_context, int
  * @param input_operand_indexes input operand indexes for this layer
  * @param output_operand_index output operand index for this layer
  * @param parameters convolution parameters
- * @param ctx pointer to Native model context for logging
+ * @param ctx pointer to Native model context, providing the worker threads,
+ * the float DSP functions and a job buffer of at least filter_stride floats
  * @retval 0 if the execution succeeds
  * @retval AVERROR(ENOMEM) if memory allocation fails
  * @retval AVERROR(EINVAL) for invalid arguments
@@ -19,8 +19,17 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/mem.h"
 #include "dnn_backend_native_layer_dense.h"
 
+typedef struct ThreadData {
+    const DenseParams *params;
+    NativeContext *ctx;
+    const float *input;
+    float *output;
+    int height, width;
+} ThreadData;
+
 int ff_dnn_load_layer_dense(Layer *layer, AVIOContext *model_file_context, int file_size, int operands_num)
 {
     DenseParams *dense_params;
@@ -56,11 +65,21 @@ int ff_dnn_load_layer_dense(Layer *layer, AVIOContext *model_file_context, int f
         dense_params->kernel[i] = av_int2float(avio_rl32(model_file_context));
     }
 
+    dense_params->packed_kernel = ff_dnn_native_pack_kernel(dense_params->kernel, dense_params->output_num,
+                                                            dense_params->input_num,
+                                                            &dense_params->filter_stride);
+    if (!dense_params->packed_kernel) {
+        av_freep(&dense_params->kernel);
+        av_freep(&dense_params);
+        return 0;
+    }
+
     dense_params->biases = NULL;
     if (dense_params->has_bias) {
         dense_params->biases = av_malloc(dense_params->output_num * sizeof(float));
         if (!dense_params->biases){
             av_freep(&dense_params->kernel);
+            av_freep(&dense_params->packed_kernel);
             av_freep(&dense_params);
             return 0;
         }
@@ -82,20 +101,65 @@ int ff_dnn_load_layer_dense(Layer *layer, AVIOContext *model_file_context, int f
     return dnn_size;
 }
 
+static void dnn_execute_layer_dense_thread(void *arg, int jobnr, int nb_jobs)
+{
+    const ThreadData *td = arg;
+    const DenseParams *dense_params = td->params;
+    const AVFloatDSPContext *fdsp = td->ctx->fdsp;
+    const int filter_stride = dense_params->filter_stride;
+    const int slice_start = (td->height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->height * (jobnr + 1)) / nb_jobs;
+    const int src_linesize = td->width * dense_params->input_num;
+    float *acc = td->ctx->job_buffer + jobnr * td->ctx->job_buffer_size;
+    float *output = td->output + slice_start * td->width * dense_params->output_num;
+
+    for (int y = slice_start; y < slice_end; ++y) {
+        for (int x = 0; x < td->width; ++x) {
+            const float *src = td->input + y * src_linesize + x * dense_params->input_num;
+
+            memset(acc, 0, filter_stride * sizeof(*acc));
+            if (dense_params->has_bias)
+                memcpy(acc, dense_params->biases, dense_params->output_num * sizeof(*acc));
+
+            for (int ch = 0; ch < dense_params->input_num; ++ch)
+                fdsp->vector_fmac_scalar(acc, dense_params->packed_kernel + ch * filter_stride,
+                                         src[ch], filter_stride);
+
+            for (int n_filter = 0; n_filter < dense_params->output_num; ++n_filter) {
+                switch (dense_params->activation){
+                case RELU:
+                    output[n_filter] = FFMAX(acc[n_filter], 0.0);
+                    break;
+                case TANH:
+                    output[n_filter] = 2.0f  / (1.0f + exp(-2.0f * acc[n_filter])) - 1.0f;
+                    break;
+                case SIGMOID:
+                    output[n_filter] = 1.0f / (1.0f + exp(-acc[n_filter]));
+                    break;
+                case NONE:
+                    output[n_filter] = acc[n_filter];
+                    break;
+                case LEAKY_RELU:
+                    output[n_filter] = FFMAX(acc[n_filter], 0.0) + 0.2 * FFMIN(acc[n_filter], 0.0);
+                }
+            }
+            output += dense_params->output_num;
+        }
+    }
+}
+
 int ff_dnn_execute_layer_dense(DnnOperand *operands, const int32_t *input_operand_indexes,
                                int32_t output_operand_index, const void *parameters, NativeContext *ctx)
 {
-    float *output;
     int32_t input_operand_index = input_operand_indexes[0];
     int number = operands[input_operand_index].dims[0];
     int height = operands[input_operand_index].dims[1];
     int width = operands[input_operand_index].dims[2];
     int channel = operands[input_operand_index].dims[3];
-    const float *input = operands[input_operand_index].data;
     const DenseParams *dense_params = parameters;
-
-    int src_linesize = width * channel;
     DnnOperand *output_operand = &operands[output_operand_index];
+    ThreadData td;
+
     output_operand->dims[0] = number;
     output_operand->dims[1] = height;
     output_operand->dims[2] = width;
@@ -111,41 +175,18 @@ int ff_dnn_execute_layer_dense(DnnOperand *operands, const int32_t *input_operan
         av_log(ctx, AV_LOG_ERROR, "Failed to reallocate memory for output\n");
         return AVERROR(ENOMEM);
     }
-    output = output_operand->data;
 
     av_assert0(channel == dense_params->input_num);
+    av_assert0(ctx->job_buffer_size >= dense_params->filter_stride);
+
+    td.params = dense_params;
+    td.ctx    = ctx;
+    td.input  = operands[input_operand_index].data;
+    td.output = output_operand->data;
+    td.height = height;
+    td.width  = width;
+    ff_dnn_native_execute(ctx, dnn_execute_layer_dense_thread, &td,
+                          FFMAX(FFMIN(ff_dnn_native_get_nb_threads(ctx), height), 1));
 
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            for (int n_filter = 0; n_filter < dense_params->output_num; ++n_filter) {
-                if (dense_params->has_bias)
-                    output[n_filter] = dense_params->biases[n_filter];
-                else
-                    output[n_filter] = 0.f;
-
-                for (int ch = 0; ch < dense_params->input_num; ++ch) {
-                    float input_pel;
-                    input_pel = input[y * src_linesize + x * dense_params->input_num + ch];
-                    output[n_filter] += input_pel * dense_params->kernel[n_filter*dense_params->input_num + ch];
-                }
-                switch (dense_params->activation){
-                case RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0);
-                    break;
-                case TANH:
-                    output[n_filter] = 2.0f  / (1.0f + exp(-2.0f * output[n_filter])) - 1.0f;
-                    break;
-                case SIGMOID:
-                    output[n_filter] = 1.0f / (1.0f + exp(-output[n_filter]));
-                    break;
-                case NONE:
-                    break;
-                case LEAKY_RELU:
-                    output[n_filter] = FFMAX(output[n_filter], 0.0) + 0.2 * FFMIN(output[n_filter], 0.0);
-                }
-            }
-            output += dense_params->output_num;
-        }
-    }
     return 0;
 }
@@ -29,6 +29,12 @@ typedef struct DenseParams{
     int32_t has_bias;
     float *kernel;
     float *biases;
+    /**
+     * kernel transposed at load time to [input channel][filter] with
+     * ff_dnn_native_pack_kernel()
+     */
+    float *packed_kernel;
+    int filter_stride;
 } DenseParams;
 
 /**
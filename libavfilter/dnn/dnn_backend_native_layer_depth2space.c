@@ -23,6 +23,8 @@
  * DNN native backend implementation.
  */
 
+#include <string.h>
+
 #include "dnn_backend_native.h"
 #include "dnn_backend_native_layer_depth2space.h"
 
@@ -61,7 +63,7 @@ int ff_dnn_execute_layer_depth2space(DnnOperand *operands, const int32_t *input_
     int channels = operands[input_operand_index].dims[3];
     const float *input = operands[input_operand_index].data;
 
-    int y, x, by, bx, ch;
+    int y, x, by;
     int new_channels = channels / (block_size * block_size);
     int output_linesize = width * channels;
     int by_linesize = output_linesize / block_size;
@@ -88,12 +90,10 @@ int ff_dnn_execute_layer_depth2space(DnnOperand *operands, const int32_t *input_
     for (y = 0; y < height; ++y){
         for (x = 0; x < width; ++x){
             for (by = 0; by < block_size; ++by){
-                for (bx = 0; bx < block_size; ++bx){
-                    for (ch = 0; ch < new_channels; ++ch){
-                        output[by * by_linesize + x * x_linesize + bx * new_channels + ch] = input[ch];
-                    }
-                    input += new_channels;
-                }
+                /* the block_size pixels of a block row are contiguous in both layouts */
+                memcpy(output + by * by_linesize + x * x_linesize, input,
+                       x_linesize * sizeof(*input));
+                input += x_linesize;
             }
         }
         output += output_linesize;
@@ -21,6 +21,7 @@
  * Scene SAD functions
  */
 
+#include "libavutil/common.h"
 #include "scene_sad.h"
 
 void ff_scene_sad16_c(SCENE_SAD_PARAMS)
@@ -71,3 +72,12 @@ ff_scene_sad_fn ff_scene_sad_get_fn(int depth)
     return sad;
 }
 
+
+double ff_scene_sad_score(uint64_t sad, uint64_t count, int depth, double *prev_mafd)
+{
+    const double mafd = (double)sad * 100. / count / (1ULL << depth);
+    const double diff = fabs(mafd - *prev_mafd);
+
+    *prev_mafd = mafd;
+    return av_clipf(FFMIN(mafd, diff), 0, 100.);
+}
@@ -41,4 +41,15 @@ ff_scene_sad_fn ff_scene_sad_get_fn_x86(int depth);
 
 ff_scene_sad_fn ff_scene_sad_get_fn(int depth);
 
+/**
+ * Compute the scene change score of a frame from its SAD to the previous
+ * frame, as reported by the scdet filter.
+ *
+ * @param count     number of samples the SAD was computed over
+ * @param prev_mafd mean absolute frame difference of the previous frame,
+ *                  updated to the one of this frame
+ * @return the score, in the range [0, 100]
+ */
+double ff_scene_sad_score(uint64_t sad, uint64_t count, int depth, double *prev_mafd);
+
 #endif /* AVFILTER_SCENE_SAD_H */
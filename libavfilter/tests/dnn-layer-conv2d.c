@@ -21,10 +21,30 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
 #include "libavfilter/dnn/dnn_backend_native_layer_conv2d.h"
 
 #define EPSON 0.00001
 
+static int prepare_layer(NativeContext *ctx, ConvolutionalParams *params)
+{
+    ctx->fdsp = avpriv_float_dsp_alloc(1);
+    params->packed_kernel = ff_dnn_native_pack_kernel(params->kernel, params->output_num,
+                                                      params->kernel_size * params->kernel_size *
+                                                      params->input_num, &params->filter_stride);
+    if (!ctx->fdsp || !params->packed_kernel)
+        return AVERROR(ENOMEM);
+    return ff_dnn_native_alloc_job_buffer(ctx, params->filter_stride);
+}
+
+static void free_layer(NativeContext *ctx, ConvolutionalParams *params)
+{
+    av_freep(&ctx->fdsp);
+    av_freep(&ctx->job_buffer);
+    av_freep(&params->packed_kernel);
+}
+
 static int test_with_same_dilate(void)
 {
     // the input data and expected data are generated with below python code.
@@ -96,8 +116,7 @@ static int test_with_same_dilate(void)
     };
     float bias[2] = { -1.6574852, -0.72915393 };
 
-    NativeContext ctx;
-    ctx.class = NULL;
+    NativeContext ctx = { 0 };
     ctx.options.conv2d_threads = 1;
 
     params.activation = TANH;
@@ -118,7 +137,12 @@ static int test_with_same_dilate(void)
     operands[1].data = NULL;
 
     input_indexes[0] = 0;
-    ff_dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, &ctx);
+    if (prepare_layer(&ctx, &params) < 0 ||
+        ff_dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, &ctx) < 0) {
+        free_layer(&ctx, &params);
+        return 1;
+    }
+    free_layer(&ctx, &params);
 
     output = operands[1].data;
     for (int i = 0; i < sizeof(expected_output) / sizeof(float); i++) {
@@ -200,8 +224,7 @@ static int test_with_valid(void)
     };
     float bias[2] = { -0.4773722, -0.19620377 };
 
-    NativeContext ctx;
-    ctx.class = NULL;
+    NativeContext ctx = { 0 };
     ctx.options.conv2d_threads = 1;
 
     params.activation = TANH;
@@ -222,7 +245,12 @@ static int test_with_valid(void)
     operands[1].data = NULL;
 
     input_indexes[0] = 0;
-    ff_dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, &ctx);
+    if (prepare_layer(&ctx, &params) < 0 ||
+        ff_dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, &ctx) < 0) {
+        free_layer(&ctx, &params);
+        return 1;
+    }
+    free_layer(&ctx, &params);
 
     output = operands[1].data;
     for (int i = 0; i < sizeof(expected_output) / sizeof(float); i++) {
@@ -237,6 +265,127 @@ static int test_with_valid(void)
     return 0;
 }
 
+static float reference_pel(const ConvolutionalParams *params, const float *input,
+                           int height, int width, int y, int x, int n_filter)
+{
+    int radius = params->kernel_size >> 1;
+    int pad_size = params->padding_method == VALID ? radius * params->dilation : 0;
+    float sum = params->has_bias ? params->biases[n_filter] : 0.f;
+
+    for (int ch = 0; ch < params->input_num; ch++) {
+        for (int ky = 0; ky < params->kernel_size; ky++) {
+            for (int kx = 0; kx < params->kernel_size; kx++) {
+                int iy = y + pad_size + (ky - radius) * params->dilation;
+                int ix = x + pad_size + (kx - radius) * params->dilation;
+
+                if (params->padding_method == SAME_CLAMP_TO_EDGE) {
+                    iy = av_clip(iy, 0, height - 1);
+                    ix = av_clip(ix, 0, width - 1);
+                } else if (iy < 0 || iy >= height || ix < 0 || ix >= width) {
+                    continue;
+                }
+                sum += input[(iy * width + ix) * params->input_num + ch] *
+                       params->kernel[((n_filter * params->kernel_size + ky) *
+                                       params->kernel_size + kx) * params->input_num + ch];
+            }
+        }
+    }
+
+    return sum;
+}
+
+static void worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    NativeContext *ctx = priv;
+    ctx->job_func(ctx->job_arg, jobnr, nb_jobs);
+}
+
+// compare against a direct convolution with sizes that exercise the
+// filter padding and the job split of the threaded implementation
+static int test_with_random(DNNPaddingParam padding, int dilation, int threads)
+{
+    const int height = 23, width = 19, input_num = 5, output_num = 19, kernel_size = 3;
+    int out_h, out_w, pad_size, ret = 1;
+    ConvolutionalParams params = { 0 };
+    DnnOperand operands[2];
+    int32_t input_indexes[1] = { 0 };
+    NativeContext ctx = { 0 };
+    float *input, *kernel, *bias, *output;
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    input  = av_malloc_array(height * width * input_num, sizeof(*input));
+    kernel = av_malloc_array(output_num * kernel_size * kernel_size * input_num, sizeof(*kernel));
+    bias   = av_malloc_array(output_num, sizeof(*bias));
+    if (!input || !kernel || !bias)
+        goto end;
+
+    for (int i = 0; i < height * width * input_num; i++)
+        input[i] = av_lfg_get(&lfg) / (float)UINT32_MAX;
+    for (int i = 0; i < output_num * kernel_size * kernel_size * input_num; i++)
+        kernel[i] = av_lfg_get(&lfg) / (float)UINT32_MAX - 0.5f;
+    for (int i = 0; i < output_num; i++)
+        bias[i] = av_lfg_get(&lfg) / (float)UINT32_MAX - 0.5f;
+
+    ctx.options.conv2d_threads = threads;
+    if (threads > 1) {
+        int nb_threads = avpriv_slicethread_create(&ctx.slicethread, &ctx, worker, NULL, threads);
+        if (nb_threads > 0)
+            ctx.nb_threads = nb_threads;
+    }
+
+    params.activation = NONE;
+    params.has_bias = 1;
+    params.biases = bias;
+    params.dilation = dilation;
+    params.input_num = input_num;
+    params.kernel = kernel;
+    params.kernel_size = kernel_size;
+    params.output_num = output_num;
+    params.padding_method = padding;
+
+    operands[0].data = input;
+    operands[0].dims[0] = 1;
+    operands[0].dims[1] = height;
+    operands[0].dims[2] = width;
+    operands[0].dims[3] = input_num;
+    operands[1].data = NULL;
+
+    if (prepare_layer(&ctx, &params) < 0 ||
+        ff_dnn_execute_layer_conv2d(operands, input_indexes, 1, &params, &ctx) < 0)
+        goto end;
+
+    pad_size = padding == VALID ? (kernel_size >> 1) * dilation : 0;
+    out_h = height - 2 * pad_size;
+    out_w = width - 2 * pad_size;
+    output = operands[1].data;
+    ret = 0;
+    for (int y = 0; y < out_h && !ret; y++) {
+        for (int x = 0; x < out_w && !ret; x++) {
+            for (int n = 0; n < output_num; n++) {
+                float expected = reference_pel(&params, input, height, width, y, x, n);
+                float out = output[(y * out_w + x) * output_num + n];
+                if (fabs(out - expected) > EPSON * 10) {
+                    printf("padding %d dilation %d at (%d, %d, %d), output: %f, expected_output: %f\n",
+                           padding, dilation, y, x, n, out, expected);
+                    ret = 1;
+                    break;
+                }
+            }
+        }
+    }
+    av_freep(&operands[1].data);
+
+end:
+    free_layer(&ctx, &params);
+    avpriv_slicethread_free(&ctx.slicethread);
+    av_freep(&input);
+    av_freep(&kernel);
+    av_freep(&bias);
+    return ret;
+}
+
 int main(int argc, char **argv)
 {
     if (test_with_valid())
@@ -244,5 +393,16 @@ int main(int argc, char **argv)
     if (test_with_same_dilate())
         return 1;
 
+    for (int dilation = 1; dilation <= 2; dilation++) {
+        if (test_with_random(VALID, dilation, 1))
+            return 1;
+        if (test_with_random(SAME, dilation, 1))
+            return 1;
+        if (test_with_random(SAME_CLAMP_TO_EDGE, dilation, 1))
+            return 1;
+        if (test_with_random(SAME_CLAMP_TO_EDGE, dilation, 4))
+            return 1;
+    }
+
     return 0;
 }
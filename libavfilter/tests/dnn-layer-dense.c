@@ -21,10 +21,29 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
 #include "libavfilter/dnn/dnn_backend_native_layer_dense.h"
 
 #define EPSON 0.00001
 
+static int prepare_layer(NativeContext *ctx, DenseParams *params)
+{
+    ctx->fdsp = avpriv_float_dsp_alloc(1);
+    params->packed_kernel = ff_dnn_native_pack_kernel(params->kernel, params->output_num,
+                                                      params->input_num, &params->filter_stride);
+    if (!ctx->fdsp || !params->packed_kernel)
+        return AVERROR(ENOMEM);
+    return ff_dnn_native_alloc_job_buffer(ctx, params->filter_stride);
+}
+
+static void free_layer(NativeContext *ctx, DenseParams *params)
+{
+    av_freep(&ctx->fdsp);
+    av_freep(&ctx->job_buffer);
+    av_freep(&params->packed_kernel);
+}
+
 static int test(void)
 {
     // the input data and expected data are generated with below python code.
@@ -91,6 +110,7 @@ static int test(void)
     float kernel[3*3] = {
         0.56611896, -0.5144603, -0.82600045, 0.19219112, 0.3835776, -0.7475352, 0.5209291, -0.6301091, -0.99442935};
     float bias[3] = {-0.3654299, -1.5711838, -0.15546428};
+    NativeContext ctx = { 0 };
 
     params.activation = TANH;
     params.has_bias = 1;
@@ -107,7 +127,12 @@ static int test(void)
     operands[1].data = NULL;
 
     input_indexes[0] = 0;
-    ff_dnn_execute_layer_dense(operands, input_indexes, 1, &params, NULL);
+    if (prepare_layer(&ctx, &params) < 0 ||
+        ff_dnn_execute_layer_dense(operands, input_indexes, 1, &params, &ctx) < 0) {
+        free_layer(&ctx, &params);
+        return 1;
+    }
+    free_layer(&ctx, &params);
 
     output = operands[1].data;
     for (int i = 0; i < sizeof(expected_output) / sizeof(float); i++) {
@@ -122,10 +147,98 @@ static int test(void)
     return 0;
 }
 
+static void worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    NativeContext *ctx = priv;
+    ctx->job_func(ctx->job_arg, jobnr, nb_jobs);
+}
+
+// compare the threaded layer against a direct computation, with an output
+// count that is not a multiple of the SIMD width
+static int test_with_random(int threads)
+{
+    const int height = 13, width = 7, input_num = 6, output_num = 21;
+    int ret = 1;
+    DenseParams params = { 0 };
+    DnnOperand operands[2];
+    int32_t input_indexes[1] = { 0 };
+    NativeContext ctx = { 0 };
+    float *input, *kernel, *bias, *output;
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    input  = av_malloc_array(height * width * input_num, sizeof(*input));
+    kernel = av_malloc_array(output_num * input_num, sizeof(*kernel));
+    bias   = av_malloc_array(output_num, sizeof(*bias));
+    if (!input || !kernel || !bias)
+        goto end;
+
+    for (int i = 0; i < height * width * input_num; i++)
+        input[i] = av_lfg_get(&lfg) / (float)UINT32_MAX;
+    for (int i = 0; i < output_num * input_num; i++)
+        kernel[i] = av_lfg_get(&lfg) / (float)UINT32_MAX - 0.5f;
+    for (int i = 0; i < output_num; i++)
+        bias[i] = av_lfg_get(&lfg) / (float)UINT32_MAX - 0.5f;
+
+    if (threads > 1) {
+        int nb_threads = avpriv_slicethread_create(&ctx.slicethread, &ctx, worker, NULL, threads);
+        if (nb_threads > 0)
+            ctx.nb_threads = nb_threads;
+    }
+
+    params.activation = NONE;
+    params.has_bias = 1;
+    params.biases = bias;
+    params.input_num = input_num;
+    params.kernel = kernel;
+    params.output_num = output_num;
+
+    operands[0].data = input;
+    operands[0].dims[0] = 1;
+    operands[0].dims[1] = height;
+    operands[0].dims[2] = width;
+    operands[0].dims[3] = input_num;
+    operands[1].data = NULL;
+
+    if (prepare_layer(&ctx, &params) < 0 ||
+        ff_dnn_execute_layer_dense(operands, input_indexes, 1, &params, &ctx) < 0)
+        goto end;
+
+    output = operands[1].data;
+    ret = 0;
+    for (int i = 0; i < height * width && !ret; i++) {
+        for (int n = 0; n < output_num; n++) {
+            float expected = bias[n];
+            for (int ch = 0; ch < input_num; ch++)
+                expected += input[i * input_num + ch] * kernel[n * input_num + ch];
+            if (fabs(output[i * output_num + n] - expected) > EPSON * 10) {
+                printf("threads %d at (%d, %d), output: %f, expected_output: %f\n",
+                       threads, i, n, output[i * output_num + n], expected);
+                ret = 1;
+                break;
+            }
+        }
+    }
+    av_freep(&operands[1].data);
+
+end:
+    free_layer(&ctx, &params);
+    avpriv_slicethread_free(&ctx.slicethread);
+    av_freep(&input);
+    av_freep(&kernel);
+    av_freep(&bias);
+    return ret;
+}
+
 int main(int argc, char **argv)
 {
     if (test())
         return 1;
+    if (test_with_random(1))
+        return 1;
+    if (test_with_random(4))
+        return 1;
 
     return 0;
 }
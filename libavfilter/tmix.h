@@ -0,0 +1,38 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_TMIX_H
+#define AVFILTER_TMIX_H
+
+#include <stdint.h>
+
+typedef struct TMixDSPContext {
+    /**
+     * Move the per pixel window sums by one frame and output the mix:
+     * sum[x] += add[x] - sub[x]
+     * dst[x]  = clip(lrintf((float)(sum[x] * weight) * factor), 0, max)
+     * for x in [0, w), with pixels of 1 (depth <= 8) or 2 bytes.
+     */
+    void (*slide)(uint8_t *dst, uint32_t *sum, const uint8_t *add,
+                  const uint8_t *sub, int w, int weight, int max, float factor);
+} TMixDSPContext;
+
+void ff_tmix_init_dsp(TMixDSPContext *dsp, int depth);
+void ff_tmix_init_x86(TMixDSPContext *dsp, int depth);
+
+#endif /* AVFILTER_TMIX_H */
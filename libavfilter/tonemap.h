@@ -0,0 +1,99 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_TONEMAP_H
+#define AVFILTER_TONEMAP_H
+
+#include <stdint.h>
+
+enum TonemapAlgorithm {
+    TONEMAP_NONE,
+    TONEMAP_LINEAR,
+    TONEMAP_GAMMA,
+    TONEMAP_CLIP,
+    TONEMAP_REINHARD,
+    TONEMAP_HABLE,
+    TONEMAP_MOBIUS,
+    TONEMAP_MAX,
+};
+
+/**
+ * Per-frame constants shared by the tonemap row functions.
+ * The layout is fixed, it is accessed by offset from assembly.
+ */
+typedef struct TonemapParams {
+    float desat;        ///< desaturation strength, <= 0 disables it
+    float coeffs[3];    ///< luma coefficients for r, g and b
+    float param;        ///< algorithm parameter
+    float peak;         ///< signal peak
+    float k[3];         ///< algorithm specific constants derived from param and peak
+} TonemapParams;
+
+#define TONEMAP_LIN_LUT_SIZE   (1 << 12)
+#define TONEMAP_DELIN_LUT_SIZE (1 << 14)
+
+/**
+ * Per-frame constants of the YUV input path.
+ * The layout is fixed, it is accessed by offset from assembly.
+ */
+typedef struct TonemapYUVParams {
+    float yuv2rgb[3][3];
+    float rgb2y[3];
+    float in_scale[2];      ///< luma and chroma input scale
+    float in_offset[2];     ///< luma and chroma input offset
+    float out_scale;        ///< luma output scale
+    float out_offset;       ///< luma output offset
+    int   in_shift;         ///< shift of the input samples
+    int   out_shift;        ///< shift of the output samples
+    int   out_max;          ///< largest output value before the shift
+    const float *lin_lut;   ///< TONEMAP_LIN_LUT_SIZE entries
+    const float *delin_lut; ///< TONEMAP_DELIN_LUT_SIZE entries
+} TonemapYUVParams;
+
+typedef struct TonemapDSPContext {
+    /**
+     * Tonemap one row of linear light planar float RGB.
+     * dst may be equal to src. Assembly versions may process up to
+     * 32 bytes past the end of each row.
+     */
+    void (*tonemap[TONEMAP_MAX])(float *dst_r, float *dst_g, float *dst_b,
+                                 const float *src_r, const float *src_g,
+                                 const float *src_b, const TonemapParams *p,
+                                 int w);
+
+    /**
+     * Convert one row of 4:2:0 YUV to linear light planar float RGB through
+     * the linearization table, yuv2linear[0] reads planar chroma from src_u
+     * and src_v, yuv2linear[1] interleaved chroma from src_u.
+     * Assembly versions require w to be a multiple of 8.
+     */
+    void (*yuv2linear[2])(float *dst_r, float *dst_g, float *dst_b,
+                          const uint16_t *src_y, const uint16_t *src_u,
+                          const uint16_t *src_v, const TonemapYUVParams *p, int w);
+
+    /**
+     * Delinearize one row of planar float RGB in place and write its luma.
+     * Assembly versions require w to be a multiple of 8.
+     */
+    void (*linear2y)(uint16_t *dst_y, float *r, float *g, float *b,
+                     const TonemapYUVParams *p, int w);
+} TonemapDSPContext;
+
+void ff_tonemap_init_x86(TonemapDSPContext *dsp);
+
+#endif /* AVFILTER_TONEMAP_H */
@@ -196,6 +196,5 @@ typedef struct V360Context {
 } V360Context;
 
 void ff_v360_init(V360Context *s, int depth);
-void ff_v360_init_x86(V360Context *s, int depth);
 
 #endif /* AVFILTER_V360_H */
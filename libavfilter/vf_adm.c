@@ -0,0 +1,672 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Calculate the ADM (additive impairment and detail loss measure) between
+ * two input videos, following the floating point model of VMAF.
+ */
+
+#include <float.h>
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "avfilter.h"
+#include "framesync.h"
+#include "internal.h"
+#include "video.h"
+#include "adm.h"
+
+#define NUM_SCALES 4
+#define BORDER_FACTOR 0.1
+#define TMP_PAD 8
+
+#define EPS 1e-30f
+#define COS_1DEG_SQ 0.99969542f
+#define ONE_BY_15 (1.f / 15)
+#define ONE_BY_30 (1.f / 30)
+
+typedef struct ADMContext {
+    const AVClass *class;
+    FFFrameSync fs;
+    const AVPixFmtDescriptor *desc;
+    float gain_limit;
+    double view_dist;
+    int display_height;
+
+    int width;
+    int height;
+    int nb_threads;
+    int data_stride;
+    int band_stride;
+    ptrdiff_t band_size;     ///< distance between the h, v and d bands
+    float factors[NUM_SCALES][4];
+    float *ref_data;
+    float *main_data;
+    float *ref_a[2];         ///< approximation bands, alternating between scales
+    float *main_a[2];
+    float *ref_hvd;          ///< detail bands
+    float *main_hvd;
+    float *r, *a, *f;        ///< outputs of ADMDSPContext.decouple
+    float **temp;
+    float *row_sums;         ///< 3 num and 3 den sums of each band row
+    double score_sum[NUM_SCALES + 1];
+    double score_min[NUM_SCALES + 1];
+    double score_max[NUM_SCALES + 1];
+    uint64_t nb_frames;
+    ADMDSPContext dsp;
+} ADMContext;
+
+#define OFFSET(x) offsetof(ADMContext, x)
+#define FLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_VIDEO_PARAM
+
+static const AVOption adm_options[] = {
+    { "gain_limit",     "set the enhancement gain limit",          OFFSET(gain_limit),     AV_OPT_TYPE_FLOAT,  {.dbl=100},  1,  100, FLAGS },
+    { "view_dist",      "set the viewing distance in display heights", OFFSET(view_dist), AV_OPT_TYPE_DOUBLE, {.dbl=3}, 0.75, 24, FLAGS },
+    { "display_height", "set the display height in pixels",        OFFSET(display_height), AV_OPT_TYPE_INT,    {.i64=1080}, 1, 8640, FLAGS },
+    { NULL }
+};
+
+FRAMESYNC_DEFINE_CLASS(adm, ADMContext, fs);
+
+static const float dwt_lo[4] = {
+     0.482962913144690f, 0.836516303737469f, 0.224143868041857f, -0.129409522550921f,
+};
+
+static const float dwt_hi[4] = {
+    -0.129409522550921f, -0.224143868041857f, 0.836516303737469f, -0.482962913144690f,
+};
+
+/* amplitudes of the db2 basis functions of the h, v, d and a bands of each scale */
+static const float basis_amplitudes[NUM_SCALES][4] = {
+    { 0.62171f,  0.67234f, 0.72709f, 0.67234f },
+    { 0.34537f,  0.41317f, 0.49428f, 0.41317f },
+    { 0.18004f,  0.22727f, 0.28688f, 0.22727f },
+    { 0.091401f, 0.11792f, 0.15214f, 0.11792f },
+};
+
+static void dwt_v_c(float *lo, float *hi, const float *const *src, int w)
+{
+    for (int j = 0; j < w; j++) {
+        const float s0 = src[0][j], s1 = src[1][j], s2 = src[2][j], s3 = src[3][j];
+
+        lo[j] = dwt_lo[0] * s0 + dwt_lo[1] * s1 + dwt_lo[2] * s2 + dwt_lo[3] * s3;
+        hi[j] = dwt_hi[0] * s0 + dwt_hi[1] * s1 + dwt_hi[2] * s2 + dwt_hi[3] * s3;
+    }
+}
+
+static void dwt_h_c(float *lo, float *hi, const float *src, int w)
+{
+    for (int j = 0; j < w; j++) {
+        const float s0 = src[2 * j - 1], s1 = src[2 * j];
+        const float s2 = src[2 * j + 1], s3 = src[2 * j + 2];
+
+        lo[j] = dwt_lo[0] * s0 + dwt_lo[1] * s1 + dwt_lo[2] * s2 + dwt_lo[3] * s3;
+        hi[j] = dwt_hi[0] * s0 + dwt_hi[1] * s1 + dwt_hi[2] * s2 + dwt_hi[3] * s3;
+    }
+}
+
+static void decouple_c(float *r, float *a, float *f, const float *ref,
+                       const float *dis, ptrdiff_t band_stride,
+                       const float *factors, int w)
+{
+    const float gain_limit = factors[3];
+
+    for (int j = 0; j < w; j++) {
+        const float oh = ref[j], ov = ref[j + band_stride];
+        const float th = dis[j], tv = dis[j + band_stride];
+        const float ot_dp = oh * th + ov * tv;
+        const float o_mag_sq = oh * oh + ov * ov;
+        const float t_mag_sq = th * th + tv * tv;
+        const int angle_flag = ot_dp >= 0.f &&
+                               ot_dp * ot_dp >= COS_1DEG_SQ * o_mag_sq * t_mag_sq;
+
+        for (int b = 0; b < 3; b++) {
+            const ptrdiff_t x = j + b * band_stride;
+            const float o = ref[x], t = dis[x];
+            float k = t / (o + EPS);
+            float rst, csf_a;
+
+            k = k < 0.f ? 0.f : (k > 1.f ? 1.f : k);
+            rst = k * o;
+            if (angle_flag) {
+                if (rst > 0.f)
+                    rst = FFMIN(rst * gain_limit, t);
+                else if (rst < 0.f)
+                    rst = FFMAX(rst * gain_limit, t);
+            }
+            csf_a = (t - rst) * factors[b];
+
+            r[x] = rst;
+            a[x] = csf_a;
+            f[x] = ONE_BY_30 * fabsf(csf_a);
+        }
+    }
+}
+
+av_cold void ff_adm_init_dsp(ADMDSPContext *dsp)
+{
+    dsp->dwt_v    = dwt_v_c;
+    dsp->dwt_h    = dwt_h_c;
+    dsp->decouple = decouple_c;
+
+#if ARCH_X86
+    ff_adm_init_x86(dsp);
+#endif
+}
+
+/**
+ * Quantization step of the wavelet coefficients of a band at which the
+ * distortion becomes visible, Watson et al., 1997.
+ */
+static float dwt_quant_step(int scale, int theta, double view_dist, int display_height)
+{
+    static const float a = 0.495f, k = 0.466f, f0 = 0.401f;
+    static const float g[4] = { 1.501f, 1.f, 0.534f, 1.f };
+    /* display visual resolution in pixels per degree of visual angle */
+    const float r = view_dist * display_height * M_PI / 180.0;
+    const float temp = log10(pow(2.0, scale + 1) * f0 * g[theta] / r);
+
+    return 2.0 * a * pow(10.0, k * temp * temp) / basis_amplitudes[scale][theta];
+}
+
+static inline int mirror(int i, int n)
+{
+    return i < 0 ? -i : (i >= n ? 2 * n - i - 1 : i);
+}
+
+typedef struct DWTData {
+    const float *src[2];
+    float *a[2];
+    float *hvd[2];
+    int src_stride;
+    int w, h;
+} DWTData;
+
+static int dwt_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ADMContext *s = ctx->priv;
+    const DWTData *td = arg;
+    const int w = td->w, h = td->h;
+    const int bw = (w + 1) / 2, bh = (h + 1) / 2;
+    const int slice_start = (bh *  jobnr     ) / nb_jobs;
+    const int slice_end   = (bh * (jobnr + 1)) / nb_jobs;
+    float *lo = s->temp[jobnr] + TMP_PAD;
+    float *hi = lo + s->data_stride + 6 * TMP_PAD;
+
+    for (int n = 0; n < 2; n++) {
+        float *band_h = td->hvd[n];
+        float *band_v = band_h + s->band_size;
+        float *band_d = band_v + s->band_size;
+
+        for (int i = slice_start; i < slice_end; i++) {
+            const ptrdiff_t offset = i * s->band_stride;
+            const float *lines[4];
+
+            for (int k = 0; k < 4; k++)
+                lines[k] = td->src[n] + mirror(2 * i - 1 + k, h) * td->src_stride;
+            s->dsp.dwt_v(lo, hi, lines, w);
+
+            lo[-1] = lo[1]; lo[w] = lo[w - 1]; lo[w + 1] = lo[w - 2];
+            hi[-1] = hi[1]; hi[w] = hi[w - 1]; hi[w + 1] = hi[w - 2];
+            s->dsp.dwt_h(td->a[n] + offset, band_v + offset, lo, bw);
+            s->dsp.dwt_h(band_h + offset, band_d + offset, hi, bw);
+        }
+    }
+
+    return 0;
+}
+
+typedef struct ScaleData {
+    const float *factors;
+    int w, h;
+    int left, right, top, bottom;
+} ScaleData;
+
+static int decouple_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ADMContext *s = ctx->priv;
+    const ScaleData *td = arg;
+    const int slice_start = (td->h *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->h * (jobnr + 1)) / nb_jobs;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        const ptrdiff_t offset = i * s->band_stride;
+
+        s->dsp.decouple(s->r + offset, s->a + offset, s->f + offset,
+                        s->ref_hvd + offset, s->main_hvd + offset,
+                        s->band_size, td->factors, td->w);
+    }
+
+    return 0;
+}
+
+static int cm_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ADMContext *s = ctx->priv;
+    const ScaleData *td = arg;
+    const ptrdiff_t stride = s->band_stride;
+    const ptrdiff_t bs = s->band_size;
+    const float *rfactor = td->factors;
+    const int rows = td->bottom - td->top;
+    const int slice_start = td->top + (rows *  jobnr     ) / nb_jobs;
+    const int slice_end   = td->top + (rows * (jobnr + 1)) / nb_jobs;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        const ptrdiff_t up   = i > 0         ? -stride : 0;
+        const ptrdiff_t down = i < td->h - 1 ?  stride : 0;
+        float *row_sums = s->row_sums + i * 6;
+        float num[3] = { 0 }, den[3] = { 0 };
+
+        for (int j = td->left; j < td->right; j++) {
+            const ptrdiff_t x = i * stride + j;
+            const int left  = j > 0         ? -1 : 0;
+            const int right = j < td->w - 1 ?  1 : 0;
+            float thr = 0.f;
+
+            for (int theta = 0; theta < 3; theta++) {
+                const float *f = s->f + theta * bs + x;
+                float sum = 0.f;
+
+                sum += f[up + left];
+                sum += f[up];
+                sum += f[up + right];
+                sum += f[left];
+                sum += ONE_BY_15 * fabsf(s->a[theta * bs + x]);
+                sum += f[right];
+                sum += f[down + left];
+                sum += f[down];
+                sum += f[down + right];
+                thr += sum;
+            }
+
+            for (int theta = 0; theta < 3; theta++) {
+                float xr = fabsf(s->r[theta * bs + x] * rfactor[theta]) - thr;
+                float xo = fabsf(s->ref_hvd[theta * bs + x] * rfactor[theta]);
+
+                xr = xr < 0.f ? 0.f : xr;
+                num[theta] += xr * xr * xr;
+                den[theta] += xo * xo * xo;
+            }
+        }
+
+        for (int theta = 0; theta < 3; theta++) {
+            row_sums[theta]     = num[theta];
+            row_sums[theta + 3] = den[theta];
+        }
+    }
+
+    return 0;
+}
+
+static double compute_adm(AVFilterContext *ctx, double *scale_score)
+{
+    ADMContext *s = ctx->priv;
+    const double numden_limit = 1e-10 * (s->width * s->height) / (1920.0 * 1080.0);
+    const float *ref = s->ref_data, *main = s->main_data;
+    int w = s->width, h = s->height, stride = s->data_stride;
+    double num = 0, den = 0;
+
+    for (int scale = 0; scale < NUM_SCALES; scale++) {
+        DWTData dd = {
+            .src = { ref, main },
+            .a   = { s->ref_a[scale & 1], s->main_a[scale & 1] },
+            .hvd = { s->ref_hvd, s->main_hvd },
+            .src_stride = stride,
+            .w = w, .h = h,
+        };
+        ScaleData sd;
+        float accum[6] = { 0 };
+        float num_scale, den_scale, area;
+
+        ff_filter_execute(ctx, dwt_slice, &dd, NULL,
+                          FFMIN((h + 1) / 2, s->nb_threads));
+
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+        sd.factors = s->factors[scale];
+        sd.w       = w;
+        sd.h       = h;
+        sd.left    = w * BORDER_FACTOR - 0.5;
+        sd.top     = h * BORDER_FACTOR - 0.5;
+        sd.right   = w - sd.left;
+        sd.bottom  = h - sd.top;
+
+        ff_filter_execute(ctx, decouple_slice, &sd, NULL,
+                          FFMIN(h, s->nb_threads));
+        ff_filter_execute(ctx, cm_slice, &sd, NULL,
+                          FFMIN(sd.bottom - sd.top, s->nb_threads));
+
+        /* summed in row order, so the score does not depend on the slicing */
+        for (int i = sd.top; i < sd.bottom; i++) {
+            for (int k = 0; k < 6; k++)
+                accum[k] += s->row_sums[i * 6 + k];
+        }
+
+        area = cbrtf((sd.bottom - sd.top) * (sd.right - sd.left) / 32.0f);
+        num_scale = (cbrtf(accum[0]) + area) + (cbrtf(accum[1]) + area) +
+                    (cbrtf(accum[2]) + area);
+        den_scale = (cbrtf(accum[3]) + area) + (cbrtf(accum[4]) + area) +
+                    (cbrtf(accum[5]) + area);
+        scale_score[scale] = num_scale / den_scale;
+        num += num_scale;
+        den += den_scale;
+
+        ref    = s->ref_a[scale & 1];
+        main   = s->main_a[scale & 1];
+        stride = s->band_stride;
+    }
+
+    num = num < numden_limit ? 0 : num;
+    den = den < numden_limit ? 0 : den;
+
+    return den == 0 ? 1.0 : num / den;
+}
+
+#define offset_fn(type, bits)                                             \
+static void offset_##bits##bit(ADMContext *s,                             \
+                               const AVFrame *ref,                        \
+                               AVFrame *main, int w)                      \
+{                                                                         \
+    const int ref_stride = ref->linesize[0];                              \
+    const int main_stride = main->linesize[0];                            \
+    const float factor = 1.f / (1 << (s->desc->comp[0].depth - 8));       \
+                                                                          \
+    const type *ref_ptr = (const type *) ref->data[0];                    \
+    const type *main_ptr = (const type *) main->data[0];                  \
+                                                                          \
+    float *ref_ptr_data = s->ref_data;                                    \
+    float *main_ptr_data = s->main_data;                                  \
+                                                                          \
+    for (int i = 0; i < s->height; i++) {                                 \
+        for (int j = 0; j < w; j++) {                                     \
+            ref_ptr_data[j] = ref_ptr[j] * factor - 128.f;                \
+            main_ptr_data[j] = main_ptr[j] * factor - 128.f;              \
+        }                                                                 \
+        ref_ptr += ref_stride / sizeof(type);                             \
+        ref_ptr_data += s->data_stride;                                   \
+        main_ptr += main_stride / sizeof(type);                           \
+        main_ptr_data += s->data_stride;                                  \
+    }                                                                     \
+}
+
+offset_fn(uint8_t, 8)
+offset_fn(uint16_t, 16)
+
+static void set_meta(AVDictionary **metadata, const char *key, float d)
+{
+    char value[257];
+    snprintf(value, sizeof(value), "%f", d);
+    av_dict_set(metadata, key, value, 0);
+}
+
+static AVFrame *do_adm(AVFilterContext *ctx, AVFrame *main, const AVFrame *ref)
+{
+    ADMContext *s = ctx->priv;
+    AVDictionary **metadata = &main->metadata;
+    double score[NUM_SCALES + 1];
+    char key[32];
+
+    if (s->desc->comp[0].depth <= 8) {
+        offset_8bit(s, ref, main, s->width);
+    } else {
+        offset_16bit(s, ref, main, s->width);
+    }
+
+    score[NUM_SCALES] = compute_adm(ctx, score);
+
+    for (int i = 0; i < NUM_SCALES; i++) {
+        snprintf(key, sizeof(key), "lavfi.adm.scale.%d", i);
+        set_meta(metadata, key, score[i]);
+    }
+    set_meta(metadata, "lavfi.adm.score", score[NUM_SCALES]);
+
+    for (int i = 0; i <= NUM_SCALES; i++) {
+        s->score_min[i]  = FFMIN(s->score_min[i], score[i]);
+        s->score_max[i]  = FFMAX(s->score_max[i], score[i]);
+        s->score_sum[i] += score[i];
+    }
+
+    s->nb_frames++;
+
+    return main;
+}
+
+static const enum AVPixelFormat pix_fmts[] = {
+    AV_PIX_FMT_GRAY8, AV_PIX_FMT_GRAY9, AV_PIX_FMT_GRAY10,
+    AV_PIX_FMT_GRAY12, AV_PIX_FMT_GRAY14, AV_PIX_FMT_GRAY16,
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV444P,
+    AV_PIX_FMT_YUV440P, AV_PIX_FMT_YUV411P, AV_PIX_FMT_YUV410P,
+    AV_PIX_FMT_YUVJ411P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ422P,
+    AV_PIX_FMT_YUVJ440P, AV_PIX_FMT_YUVJ444P,
+#define PF(suf) AV_PIX_FMT_YUV420##suf,  AV_PIX_FMT_YUV422##suf,  AV_PIX_FMT_YUV444##suf
+    PF(P9), PF(P10), PF(P12), PF(P14), PF(P16),
+    AV_PIX_FMT_NONE
+};
+
+static int config_input_ref(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx  = inlink->dst;
+    ADMContext *s = ctx->priv;
+    int band_h;
+
+    if (ctx->inputs[0]->w != ctx->inputs[1]->w ||
+        ctx->inputs[0]->h != ctx->inputs[1]->h) {
+        av_log(ctx, AV_LOG_ERROR, "Width and height of input videos must be same.\n");
+        return AVERROR(EINVAL);
+    }
+
+    if (inlink->w < 16 || inlink->h < 16) {
+        av_log(ctx, AV_LOG_ERROR, "Input videos must be at least 16x16.\n");
+        return AVERROR(EINVAL);
+    }
+
+    s->desc = av_pix_fmt_desc_get(inlink->format);
+    s->width = ctx->inputs[0]->w;
+    s->height = ctx->inputs[0]->h;
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+
+    /* the dsp functions process the rows in steps of 8 floats */
+    s->data_stride = FFALIGN(s->width, 8);
+    s->band_stride = FFALIGN((s->width + 1) / 2, 8);
+    band_h = (s->height + 1) / 2;
+    s->band_size = (ptrdiff_t)s->band_stride * band_h;
+
+    ff_adm_init_dsp(&s->dsp);
+
+    for (int scale = 0; scale < NUM_SCALES; scale++) {
+        for (int theta = 0; theta < 3; theta++) {
+            /* the h and v bands share the quantization step */
+            s->factors[scale][theta] = 1.f / dwt_quant_step(scale, FFMAX(theta, 1),
+                                                            s->view_dist,
+                                                            s->display_height);
+        }
+        s->factors[scale][3] = s->gain_limit;
+    }
+
+    for (int i = 0; i <= NUM_SCALES; i++) {
+        s->score_min[i] =  DBL_MAX;
+        s->score_max[i] = -DBL_MAX;
+    }
+
+    if (!(s->ref_data = av_calloc(s->data_stride, s->height * sizeof(float))))
+        return AVERROR(ENOMEM);
+
+    if (!(s->main_data = av_calloc(s->data_stride, s->height * sizeof(float))))
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < 2; i++) {
+        if (!(s->ref_a[i] = av_calloc(s->band_size, sizeof(float))))
+            return AVERROR(ENOMEM);
+        if (!(s->main_a[i] = av_calloc(s->band_size, sizeof(float))))
+            return AVERROR(ENOMEM);
+    }
+
+    if (!(s->ref_hvd = av_calloc(s->band_size, 3 * sizeof(float))) ||
+        !(s->main_hvd = av_calloc(s->band_size, 3 * sizeof(float))) ||
+        !(s->r = av_calloc(s->band_size, 3 * sizeof(float))) ||
+        !(s->a = av_calloc(s->band_size, 3 * sizeof(float))) ||
+        !(s->f = av_calloc(s->band_size, 3 * sizeof(float))))
+        return AVERROR(ENOMEM);
+
+    if (!(s->row_sums = av_calloc(band_h, 6 * sizeof(*s->row_sums))))
+        return AVERROR(ENOMEM);
+
+    if (!(s->temp = av_calloc(s->nb_threads, sizeof(s->temp[0]))))
+        return AVERROR(ENOMEM);
+
+    /* two lines, padded for the mirrored edges and the overreads of dwt_h */
+    for (int i = 0; i < s->nb_threads; i++) {
+        if (!(s->temp[i] = av_calloc(2 * (s->data_stride + 6 * TMP_PAD), sizeof(float))))
+            return AVERROR(ENOMEM);
+    }
+
+    return 0;
+}
+
+static int process_frame(FFFrameSync *fs)
+{
+    AVFilterContext *ctx = fs->parent;
+    ADMContext *s = fs->opaque;
+    AVFilterLink *outlink = ctx->outputs[0];
+    AVFrame *out_frame, *main_frame = NULL, *ref_frame = NULL;
+    int ret;
+
+    ret = ff_framesync_dualinput_get(fs, &main_frame, &ref_frame);
+    if (ret < 0)
+        return ret;
+
+    if (ctx->is_disabled || !ref_frame) {
+        out_frame = main_frame;
+    } else {
+        out_frame = do_adm(ctx, main_frame, ref_frame);
+    }
+
+    out_frame->pts = av_rescale_q(s->fs.pts, s->fs.time_base, outlink->time_base);
+
+    return ff_filter_frame(outlink, out_frame);
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    ADMContext *s = ctx->priv;
+    AVFilterLink *mainlink = ctx->inputs[0];
+    FFFrameSyncIn *in;
+    int ret;
+
+    outlink->w = mainlink->w;
+    outlink->h = mainlink->h;
+    outlink->time_base = mainlink->time_base;
+    outlink->sample_aspect_ratio = mainlink->sample_aspect_ratio;
+    outlink->frame_rate = mainlink->frame_rate;
+    if ((ret = ff_framesync_init(&s->fs, ctx, 2)) < 0)
+        return ret;
+
+    in = s->fs.in;
+    in[0].time_base = mainlink->time_base;
+    in[1].time_base = ctx->inputs[1]->time_base;
+    in[0].sync   = 2;
+    in[0].before = EXT_STOP;
+    in[0].after  = EXT_STOP;
+    in[1].sync   = 1;
+    in[1].before = EXT_STOP;
+    in[1].after  = EXT_STOP;
+    s->fs.opaque   = s;
+    s->fs.on_event = process_frame;
+
+    return ff_framesync_configure(&s->fs);
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    ADMContext *s = ctx->priv;
+    return ff_framesync_activate(&s->fs);
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    ADMContext *s = ctx->priv;
+
+    if (s->nb_frames > 0) {
+        for (int i = 0; i < NUM_SCALES; i++)
+            av_log(ctx, AV_LOG_INFO, "ADM scale=%d average:%f min:%f: max:%f\n",
+                   i, s->score_sum[i] / s->nb_frames, s->score_min[i], s->score_max[i]);
+        av_log(ctx, AV_LOG_INFO, "ADM average:%f min:%f: max:%f\n",
+               s->score_sum[NUM_SCALES] / s->nb_frames,
+               s->score_min[NUM_SCALES], s->score_max[NUM_SCALES]);
+    }
+
+    av_freep(&s->ref_data);
+    av_freep(&s->main_data);
+    for (int i = 0; i < 2; i++) {
+        av_freep(&s->ref_a[i]);
+        av_freep(&s->main_a[i]);
+    }
+    av_freep(&s->ref_hvd);
+    av_freep(&s->main_hvd);
+    av_freep(&s->r);
+    av_freep(&s->a);
+    av_freep(&s->f);
+    av_freep(&s->row_sums);
+
+    for (int i = 0; i < s->nb_threads && s->temp; i++)
+        av_freep(&s->temp[i]);
+
+    av_freep(&s->temp);
+
+    ff_framesync_uninit(&s->fs);
+}
+
+static const AVFilterPad adm_inputs[] = {
+    {
+        .name         = "main",
+        .type         = AVMEDIA_TYPE_VIDEO,
+    },{
+        .name         = "reference",
+        .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_input_ref,
+    },
+};
+
+static const AVFilterPad adm_outputs[] = {
+    {
+        .name          = "default",
+        .type          = AVMEDIA_TYPE_VIDEO,
+        .config_props  = config_output,
+    },
+};
+
+const AVFilter ff_vf_adm = {
+    .name          = "adm",
+    .description   = NULL_IF_CONFIG_SMALL("Calculate the ADM between two video streams."),
+    .preinit       = adm_framesync_preinit,
+    .uninit        = uninit,
+    .priv_size     = sizeof(ADMContext),
+    .priv_class    = &adm_class,
+    .activate      = activate,
+    FILTER_INPUTS(adm_inputs),
+    FILTER_OUTPUTS(adm_outputs),
+    FILTER_PIXFMTS_ARRAY(pix_fmts),
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_INTERNAL |
+                     AVFILTER_FLAG_SLICE_THREADS             |
+                     AVFILTER_FLAG_METADATA_ONLY,
+};
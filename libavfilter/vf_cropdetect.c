@@ -34,6 +34,7 @@
 #include "internal.h"
 #include "video.h"
 #include "edge_common.h"
+#include "vf_cropdetect.h"
 
 typedef struct CropDetectContext {
     const AVClass *class;
@@ -57,6 +58,10 @@ typedef struct CropDetectContext {
     uint16_t *gradients;
     char     *directions;
     int      *bboxes[4];
+
+    int      nb_threads;
+    int64_t  *line_sums;    ///< per job partial sums of the lines of a batch
+    int      *line_totals;  ///< averages of the lines of a batch
 } CropDetectContext;
 
 static const enum AVPixelFormat pix_fmts[] = {
@@ -87,7 +92,10 @@ static int comp(const int *a,const int *b)
     return FFDIFFSIGN(*a, *b);
 }
 
-static int checkline(void *ctx, const unsigned char *src, int stride, int len, int bpp)
+/* lines whose average is computed in one batch while searching a border */
+#define LINE_BATCH 64
+
+int ff_cropdetect_checkline(const uint8_t *src, int stride, int len, int bpp)
 {
     int total = 0;
     int div = len;
@@ -138,10 +146,132 @@ static int checkline(void *ctx, const unsigned char *src, int stride, int len, i
     }
     total /= div;
 
-    av_log(ctx, AV_LOG_DEBUG, "total:%d\n", total);
     return total;
 }
 
+typedef struct ThreadData {
+    AVFrame *frame;
+    int start;              ///< first row or column of the batch
+    int count;              ///< number of rows or columns in the batch
+} ThreadData;
+
+/**
+ * Average whole rows, each job handling a subset of the rows of the batch.
+ */
+static int checkrows_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    CropDetectContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *frame = td->frame;
+    const int bpp = s->max_pixsteps[0];
+    const int slice_start = (td->count *  jobnr     ) / nb_jobs;
+    const int slice_end   = (td->count * (jobnr + 1)) / nb_jobs;
+
+    for (int i = slice_start; i < slice_end; i++)
+        s->line_totals[i] = ff_cropdetect_checkline(frame->data[0] + frame->linesize[0] * (td->start + i),
+                                                    bpp, frame->width, bpp);
+
+    return 0;
+}
+
+/**
+ * Sum a band of rows over the columns of the batch. Columns are summed
+ * row by row so that each job reads the frame sequentially.
+ */
+static int checkcolumns_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    CropDetectContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const AVFrame *frame = td->frame;
+    const int bpp = s->max_pixsteps[0];
+    const int slice_start = (frame->height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (frame->height * (jobnr + 1)) / nb_jobs;
+    int64_t *sums = s->line_sums + jobnr * LINE_BATCH;
+
+    memset(sums, 0, td->count * sizeof(*sums));
+
+    for (int y = slice_start; y < slice_end; y++) {
+        const uint8_t *src = frame->data[0] + y * frame->linesize[0] + td->start * bpp;
+        const uint16_t *src16 = (const uint16_t *)src;
+
+        switch (bpp) {
+        case 1:
+            for (int i = 0; i < td->count; i++)
+                sums[i] += src[i];
+            break;
+        case 2:
+            for (int i = 0; i < td->count; i++)
+                sums[i] += src16[i];
+            break;
+        case 3:
+        case 4:
+            for (int i = 0; i < td->count; i++)
+                sums[i] += src[i * bpp] + src[i * bpp + 1] + src[i * bpp + 2];
+            break;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Compute the averages of the rows or columns [start, start + count) of the
+ * first plane into s->line_totals.
+ */
+static void checklines(AVFilterContext *ctx, AVFrame *frame, int start, int count, int columns)
+{
+    CropDetectContext *s = ctx->priv;
+    ThreadData td = { .frame = frame, .start = start, .count = count };
+
+    if (!columns) {
+        ff_filter_execute(ctx, checkrows_slice, &td, NULL,
+                          FFMIN(count, s->nb_threads));
+    } else {
+        const int nb_jobs = FFMIN(frame->height, s->nb_threads);
+        const int div = frame->height * (s->max_pixsteps[0] >= 3 ? 3 : 1);
+
+        ff_filter_execute(ctx, checkcolumns_slice, &td, NULL, nb_jobs);
+        for (int i = 0; i < count; i++) {
+            int64_t total = 0;
+            for (int j = 0; j < nb_jobs; j++)
+                total += s->line_sums[j * LINE_BATCH + i];
+            s->line_totals[i] = total / div;
+        }
+    }
+}
+
+/**
+ * Scan rows or columns starting at from in steps of inc while they are
+ * before end, and set *dst to the last black line followed by more than
+ * max_outliers bright lines. *dst is untouched if no such line is found.
+ */
+static void find_border(AVFilterContext *ctx, AVFrame *frame, int *dst,
+                        int from, int end, int inc, int columns, int limit)
+{
+    CropDetectContext *s = ctx->priv;
+    int outliers = 0, last_y = from;
+
+    for (int y = from; inc > 0 ? y < end : y > end; ) {
+        const int count = FFMIN(LINE_BATCH, inc > 0 ? end - y : y - end);
+        const int start = inc > 0 ? y : y - count + 1;
+
+        checklines(ctx, frame, start, count, columns);
+
+        for (int i = 0; i < count; i++, y += inc) {
+            const int total = s->line_totals[y - start];
+
+            av_log(ctx, AV_LOG_DEBUG, "total:%d\n", total);
+            if (total > limit) {
+                if (++outliers > s->max_outliers) {
+                    *dst = last_y;
+                    return;
+                }
+            } else
+                last_y = y + inc;
+        }
+    }
+}
+
 static int checkline_edge(void *ctx, const unsigned char *src, int stride, int len, int bpp)
 {
     const uint16_t *src16 = (const uint16_t *)src;
@@ -198,6 +328,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->bboxes[1]);
     av_freep(&s->bboxes[2]);
     av_freep(&s->bboxes[3]);
+    av_freep(&s->line_sums);
+    av_freep(&s->line_totals);
 }
 
 static int config_input(AVFilterLink *inlink)
@@ -231,8 +363,15 @@ static int config_input(AVFilterLink *inlink)
     s->bboxes[2]   = av_malloc(s->window_size * sizeof(*s->bboxes[2]));
     s->bboxes[3]   = av_malloc(s->window_size * sizeof(*s->bboxes[3]));
 
+    s->nb_threads  = ff_filter_get_nb_threads(ctx);
+    av_freep(&s->line_sums);
+    av_freep(&s->line_totals);
+    s->line_sums   = av_calloc(s->nb_threads * LINE_BATCH, sizeof(*s->line_sums));
+    s->line_totals = av_calloc(LINE_BATCH, sizeof(*s->line_totals));
+
     if (!s->tmpbuf    || !s->filterbuf || !s->gradients || !s->directions ||
-        !s->bboxes[0] || !s->bboxes[1] || !s->bboxes[2] || !s->bboxes[3])
+        !s->bboxes[0] || !s->bboxes[1] || !s->bboxes[2] || !s->bboxes[3] ||
+        !s->line_sums || !s->line_totals)
         return AVERROR(ENOMEM);
 
     return 0;
@@ -241,16 +380,63 @@ static int config_input(AVFilterLink *inlink)
 #define SET_META(key, value) \
     av_dict_set_int(metadata, key, value, 0)
 
+void ff_cropdetect_set_metadata(void *log_ctx, AVFrame *frame, AVRational time_base,
+                                int x1, int x2, int y1, int y2, int *round, float limit)
+{
+    AVDictionary **metadata = &frame->metadata;
+    int w, h, x, y, shrink_by;
+    char limit_str[22];
+
+    // round x and y (up), important for yuv colorspaces
+    // make sure they stay rounded!
+    x = (x1+1) & ~1;
+    y = (y1+1) & ~1;
+
+    w = x2 - x + 1;
+    h = y2 - y + 1;
+
+    // w and h must be divisible by 2 as well because of yuv
+    // colorspace problems.
+    if (*round <= 1)
+        *round = 16;
+    if (*round % 2)
+        *round *= 2;
+
+    shrink_by = w % *round;
+    w -= shrink_by;
+    x += (shrink_by/2 + 1) & ~1;
+
+    shrink_by = h % *round;
+    h -= shrink_by;
+    y += (shrink_by/2 + 1) & ~1;
+
+    SET_META("lavfi.cropdetect.x1", x1);
+    SET_META("lavfi.cropdetect.x2", x2);
+    SET_META("lavfi.cropdetect.y1", y1);
+    SET_META("lavfi.cropdetect.y2", y2);
+    SET_META("lavfi.cropdetect.w",  w);
+    SET_META("lavfi.cropdetect.h",  h);
+    SET_META("lavfi.cropdetect.x",  x);
+    SET_META("lavfi.cropdetect.y",  y);
+
+    snprintf(limit_str, sizeof(limit_str), "%f", limit);
+    av_dict_set(metadata, "lavfi.cropdetect.limit", limit_str, 0);
+
+    av_log(log_ctx, AV_LOG_INFO,
+           "x1:%d x2:%d y1:%d y2:%d w:%d h:%d x:%d y:%d pts:%"PRId64" t:%f limit:%f crop=%d:%d:%d:%d\n",
+           x1, x2, y1, y2, w, h, x, y, frame->pts,
+           frame->pts == AV_NOPTS_VALUE ? -1 : frame->pts * av_q2d(time_base),
+           limit, w, h, x, y);
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
     AVFilterContext *ctx = inlink->dst;
     CropDetectContext *s = ctx->priv;
     int bpp = s->max_pixsteps[0];
-    int w, h, x, y, shrink_by, i;
-    AVDictionary **metadata;
-    int outliers, last_y;
+    int y, i;
+    int last_y;
     int limit_upscaled = lrint(s->limit_upscaled);
-    char limit_str[22];
 
     const int inw = inlink->w;
     const int inh = inlink->h;
@@ -271,8 +457,6 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 
     // ignore first s->skip frames
     if (++s->frame_nb > 0) {
-        metadata = &frame->metadata;
-
         // Reset the crop area every reset_count frames, if reset_count is > 0
         if (s->reset_count > 0 && s->frame_nb > s->reset_count) {
             s->x1 = frame->width  - 1;
@@ -282,23 +466,11 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
             s->frame_nb = 1;
         }
 
-#define FIND(DST, FROM, NOEND, INC, STEP0, STEP1, LEN) \
-        outliers = 0;\
-        for (last_y = y = FROM; NOEND; y = y INC) {\
-            if (checkline(ctx, frame->data[0] + STEP0 * y, STEP1, LEN, bpp) > limit_upscaled) {\
-                if (++outliers > s->max_outliers) { \
-                    DST = last_y;\
-                    break;\
-                }\
-            } else\
-                last_y = y INC;\
-        }
-
         if (s->mode == MODE_BLACK) {
-            FIND(s->y1,                 0,               y < s->y1, +1, frame->linesize[0], bpp, frame->width);
-            FIND(s->y2, frame->height - 1, y > FFMAX(s->y2, s->y1), -1, frame->linesize[0], bpp, frame->width);
-            FIND(s->x1,                 0,               y < s->x1, +1, bpp, frame->linesize[0], frame->height);
-            FIND(s->x2,  frame->width - 1, y > FFMAX(s->x2, s->x1), -1, bpp, frame->linesize[0], frame->height);
+            find_border(ctx, frame, &s->y1,                 0,               s->y1, +1, 0, limit_upscaled);
+            find_border(ctx, frame, &s->y2, frame->height - 1, FFMAX(s->y2, s->y1), -1, 0, limit_upscaled);
+            find_border(ctx, frame, &s->x1,                 0,               s->x1, +1, 1, limit_upscaled);
+            find_border(ctx, frame, &s->x2,  frame->width - 1, FFMAX(s->x2, s->x1), -1, 1, limit_upscaled);
         } else { // MODE_MV_EDGES
             sd = av_frame_get_side_data(frame, AV_FRAME_DATA_MOTION_VECTORS);
             s->x1 = 0;
@@ -398,46 +570,8 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
             }
         }
 
-        // round x and y (up), important for yuv colorspaces
-        // make sure they stay rounded!
-        x = (s->x1+1) & ~1;
-        y = (s->y1+1) & ~1;
-
-        w = s->x2 - x + 1;
-        h = s->y2 - y + 1;
-
-        // w and h must be divisible by 2 as well because of yuv
-        // colorspace problems.
-        if (s->round <= 1)
-            s->round = 16;
-        if (s->round % 2)
-            s->round *= 2;
-
-        shrink_by = w % s->round;
-        w -= shrink_by;
-        x += (shrink_by/2 + 1) & ~1;
-
-        shrink_by = h % s->round;
-        h -= shrink_by;
-        y += (shrink_by/2 + 1) & ~1;
-
-        SET_META("lavfi.cropdetect.x1", s->x1);
-        SET_META("lavfi.cropdetect.x2", s->x2);
-        SET_META("lavfi.cropdetect.y1", s->y1);
-        SET_META("lavfi.cropdetect.y2", s->y2);
-        SET_META("lavfi.cropdetect.w",  w);
-        SET_META("lavfi.cropdetect.h",  h);
-        SET_META("lavfi.cropdetect.x",  x);
-        SET_META("lavfi.cropdetect.y",  y);
-
-        snprintf(limit_str, sizeof(limit_str), "%f", s->limit);
-        av_dict_set(metadata, "lavfi.cropdetect.limit", limit_str, 0);
-
-        av_log(ctx, AV_LOG_INFO,
-               "x1:%d x2:%d y1:%d y2:%d w:%d h:%d x:%d y:%d pts:%"PRId64" t:%f limit:%f crop=%d:%d:%d:%d\n",
-               s->x1, s->x2, s->y1, s->y2, w, h, x, y, frame->pts,
-               frame->pts == AV_NOPTS_VALUE ? -1 : frame->pts * av_q2d(inlink->time_base),
-               s->limit, w, h, x, y);
+        ff_cropdetect_set_metadata(ctx, frame, inlink->time_base,
+                                   s->x1, s->x2, s->y1, s->y2, &s->round, s->limit);
     }
 
     return ff_filter_frame(inlink->dst->outputs[0], frame);
@@ -512,6 +646,7 @@ const AVFilter ff_vf_cropdetect = {
     FILTER_INPUTS(avfilter_vf_cropdetect_inputs),
     FILTER_OUTPUTS(avfilter_vf_cropdetect_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_METADATA_ONLY |
+                     AVFILTER_FLAG_SLICE_THREADS,
     .process_command = process_command,
 };
@@ -0,0 +1,41 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef AVFILTER_CROPDETECT_H
+#define AVFILTER_CROPDETECT_H
+
+#include "libavutil/frame.h"
+#include "libavutil/rational.h"
+
+/**
+ * Return the average of the len pixels of a line starting at src, stride
+ * bytes apart. For bpp 3 and 4 the first three components are averaged.
+ */
+int ff_cropdetect_checkline(const uint8_t *src, int stride, int len, int bpp);
+
+/**
+ * Round the detected borders to the crop area, set the lavfi.cropdetect
+ * metadata of frame and log the area.
+ *
+ * @param round the value the width and height are made divisible by, fixed
+ *              up to an even value greater than 1
+ */
+void ff_cropdetect_set_metadata(void *log_ctx, AVFrame *frame, AVRational time_base,
+                                int x1, int x2, int y1, int y2, int *round, float limit);
+
+#endif /* AVFILTER_CROPDETECT_H */
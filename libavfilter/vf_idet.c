@@ -21,6 +21,7 @@
 #include <float.h> /* FLT_MAX */
 
 #include "libavutil/common.h"
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "internal.h"
 #include "vf_idet.h"
@@ -50,8 +51,6 @@ static const char *type2str(Type type)
     return NULL;
 }
 
-#define PRECISION 1048576
-
 static uint64_t uintpow(uint64_t b,unsigned int e)
 {
     uint64_t r=1;
@@ -109,52 +108,82 @@ int ff_idet_filter_line_c_16bit(const uint16_t *a, const uint16_t *b, const uint
     return ret;
 }
 
-static void filter(AVFilterContext *ctx)
+av_cold void ff_idet_init(IDETContext *idet, int for_16b)
+{
+    idet->filter_line = for_16b ? (ff_idet_filter_func)ff_idet_filter_line_c_16bit
+                                : ff_idet_filter_line_c;
+#if ARCH_X86
+    ff_idet_init_x86(idet, for_16b);
+#endif
+}
+
+av_cold void ff_idet_init_history(IDETContext *idet)
+{
+    idet->last_type = UNDETERMINED;
+    memset(idet->history, UNDETERMINED, HIST_SIZE);
+
+    if( idet->half_life > 0 )
+        idet->decay_coefficient = lrint( PRECISION * exp2(-1.0 / idet->half_life) );
+    else
+        idet->decay_coefficient = PRECISION;
+}
+
+static int filter_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     IDETContext *idet = ctx->priv;
-    int y, i;
-    int64_t alpha[2]={0};
-    int64_t delta=0;
-    int64_t gamma[2]={0};
-    Type type, best_type;
-    RepeatedField repeat;
-    int match = 0;
-    AVDictionary **metadata = &idet->cur->metadata;
+    IDETSliceSums *sums = &idet->slice_sums[jobnr];
 
-    for (i = 0; i < idet->csp->nb_components; i++) {
+    memset(sums, 0, sizeof(*sums));
+
+    for (int i = 0; i < idet->csp->nb_components; i++) {
         int w = idet->cur->width;
         int h = idet->cur->height;
         int refs = idet->cur->linesize[i];
+        int slice_start, slice_end;
 
         if (i && i<3) {
             w = AV_CEIL_RSHIFT(w, idet->csp->log2_chroma_w);
             h = AV_CEIL_RSHIFT(h, idet->csp->log2_chroma_h);
         }
 
-        for (y = 2; y < h - 2; y++) {
-            uint8_t *prev = &idet->prev->data[i][y*refs];
-            uint8_t *cur  = &idet->cur ->data[i][y*refs];
-            uint8_t *next = &idet->next->data[i][y*refs];
-            alpha[ y   &1] += idet->filter_line(cur-refs, prev, cur+refs, w);
-            alpha[(y^1)&1] += idet->filter_line(cur-refs, next, cur+refs, w);
-            delta          += idet->filter_line(cur-refs,  cur, cur+refs, w);
-            gamma[(y^1)&1] += idet->filter_line(cur     , prev, cur     , w);
+        if (h <= 4)
+            continue;
+        slice_start = 2 + (h - 4) *  jobnr      / nb_jobs;
+        slice_end   = 2 + (h - 4) * (jobnr + 1) / nb_jobs;
+
+        for (int y = slice_start; y < slice_end; y++) {
+            ff_idet_filter_row(sums, idet->filter_line,
+                               &idet->prev->data[i][y*refs],
+                               &idet->cur ->data[i][y*refs],
+                               &idet->next->data[i][y*refs], refs, y, w);
         }
     }
 
-    if      (alpha[0] > idet->interlace_threshold * alpha[1]){
+    return 0;
+}
+
+void ff_idet_classify(IDETContext *idet, void *log_ctx, AVFrame *frame,
+                      const IDETSliceSums *sums)
+{
+    int i;
+    Type type, best_type;
+    RepeatedField repeat;
+    int match = 0;
+    AVDictionary **metadata = &frame->metadata;
+
+    if      (sums->alpha[0] > idet->interlace_threshold * sums->alpha[1]){
         type = TFF;
-    }else if(alpha[1] > idet->interlace_threshold * alpha[0]){
+    }else if(sums->alpha[1] > idet->interlace_threshold * sums->alpha[0]){
         type = BFF;
-    }else if(alpha[1] > idet->progressive_threshold * delta){
+    }else if(sums->alpha[1] > idet->progressive_threshold * sums->delta){
         type = PROGRESSIVE;
     }else{
         type = UNDETERMINED;
     }
 
-    if ( gamma[0] > idet->repeat_threshold * gamma[1] ){
+    if ( sums->gamma[0] > idet->repeat_threshold * sums->gamma[1] ){
         repeat = REPEAT_TOP;
-    } else if ( gamma[1] > idet->repeat_threshold * gamma[0] ){
+    } else if ( sums->gamma[1] > idet->repeat_threshold * sums->gamma[0] ){
         repeat = REPEAT_BOTTOM;
     } else {
         repeat = REPEAT_NONE;
@@ -183,13 +212,13 @@ static void filter(AVFilterContext *ctx)
     }
 
     if      (idet->last_type == TFF){
-        idet->cur->top_field_first = 1;
-        idet->cur->interlaced_frame = 1;
+        frame->top_field_first = 1;
+        frame->interlaced_frame = 1;
     }else if(idet->last_type == BFF){
-        idet->cur->top_field_first = 0;
-        idet->cur->interlaced_frame = 1;
+        frame->top_field_first = 0;
+        frame->interlaced_frame = 1;
     }else if(idet->last_type == PROGRESSIVE){
-        idet->cur->interlaced_frame = 0;
+        frame->interlaced_frame = 0;
     }
 
     for(i=0; i<3; i++)
@@ -209,7 +238,7 @@ static void filter(AVFilterContext *ctx)
     idet->total_poststat[idet->last_type] ++;
     idet->poststat      [idet->last_type] += PRECISION;
 
-    av_log(ctx, AV_LOG_DEBUG, "Repeated Field:%12s, Single frame:%12s, Multi frame:%12s\n",
+    av_log(log_ctx, AV_LOG_DEBUG, "Repeated Field:%12s, Single frame:%12s, Multi frame:%12s\n",
            rep2str(repeat), type2str(type), type2str(idet->last_type));
 
     av_dict_set    (metadata, "lavfi.idet.repeated.current_frame", rep2str(repeat), 0);
@@ -230,6 +259,25 @@ static void filter(AVFilterContext *ctx)
     av_dict_set_fxp(metadata, "lavfi.idet.multiple.undetermined",  idet->poststat[UNDETERMINED], 2, 0);
 }
 
+static void filter(AVFilterContext *ctx)
+{
+    IDETContext *idet = ctx->priv;
+    IDETSliceSums sums = { { 0 } };
+    const int nb_jobs = FFMAX(1, FFMIN(idet->cur->height >> 2, idet->nb_threads));
+
+    ff_filter_execute(ctx, filter_slice, NULL, NULL, nb_jobs);
+
+    for (int i = 0; i < nb_jobs; i++) {
+        sums.alpha[0] += idet->slice_sums[i].alpha[0];
+        sums.alpha[1] += idet->slice_sums[i].alpha[1];
+        sums.delta    += idet->slice_sums[i].delta;
+        sums.gamma[0] += idet->slice_sums[i].gamma[0];
+        sums.gamma[1] += idet->slice_sums[i].gamma[1];
+    }
+
+    ff_idet_classify(idet, ctx, idet->cur, &sums);
+}
+
 static int filter_frame(AVFilterLink *link, AVFrame *picref)
 {
     AVFilterContext *ctx = link->dst;
@@ -274,12 +322,8 @@ static int filter_frame(AVFilterLink *link, AVFrame *picref)
 
     if (!idet->csp)
         idet->csp = av_pix_fmt_desc_get(link->format);
-    if (idet->csp->comp[0].depth > 8){
-        idet->filter_line = (ff_idet_filter_func)ff_idet_filter_line_c_16bit;
-#if ARCH_X86
-        ff_idet_init_x86(idet, 1);
-#endif
-    }
+    if (idet->csp->comp[0].depth > 8)
+        ff_idet_init(idet, 1);
 
     if (idet->analyze_interlaced_flag) {
         if (idet->cur->interlaced_frame) {
@@ -333,31 +377,37 @@ static int request_frame(AVFilterLink *link)
     return ret;
 }
 
-static av_cold void uninit(AVFilterContext *ctx)
+void ff_idet_log_totals(IDETContext *idet, void *log_ctx)
 {
-    IDETContext *idet = ctx->priv;
-
-    av_log(ctx, AV_LOG_INFO, "Repeated Fields: Neither:%6"PRId64" Top:%6"PRId64" Bottom:%6"PRId64"\n",
+    av_log(log_ctx, AV_LOG_INFO, "Repeated Fields: Neither:%6"PRId64" Top:%6"PRId64" Bottom:%6"PRId64"\n",
            idet->total_repeats[REPEAT_NONE],
            idet->total_repeats[REPEAT_TOP],
            idet->total_repeats[REPEAT_BOTTOM]
         );
-    av_log(ctx, AV_LOG_INFO, "Single frame detection: TFF:%6"PRId64" BFF:%6"PRId64" Progressive:%6"PRId64" Undetermined:%6"PRId64"\n",
+    av_log(log_ctx, AV_LOG_INFO, "Single frame detection: TFF:%6"PRId64" BFF:%6"PRId64" Progressive:%6"PRId64" Undetermined:%6"PRId64"\n",
            idet->total_prestat[TFF],
            idet->total_prestat[BFF],
            idet->total_prestat[PROGRESSIVE],
            idet->total_prestat[UNDETERMINED]
         );
-    av_log(ctx, AV_LOG_INFO, "Multi frame detection: TFF:%6"PRId64" BFF:%6"PRId64" Progressive:%6"PRId64" Undetermined:%6"PRId64"\n",
+    av_log(log_ctx, AV_LOG_INFO, "Multi frame detection: TFF:%6"PRId64" BFF:%6"PRId64" Progressive:%6"PRId64" Undetermined:%6"PRId64"\n",
            idet->total_poststat[TFF],
            idet->total_poststat[BFF],
            idet->total_poststat[PROGRESSIVE],
            idet->total_poststat[UNDETERMINED]
         );
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    IDETContext *idet = ctx->priv;
+
+    ff_idet_log_totals(idet, ctx);
 
     av_frame_free(&idet->prev);
     av_frame_free(&idet->cur );
     av_frame_free(&idet->next);
+    av_freep(&idet->slice_sums);
 }
 
 static const enum AVPixelFormat pix_fmts[] = {
@@ -399,19 +449,22 @@ static av_cold int init(AVFilterContext *ctx)
     IDETContext *idet = ctx->priv;
 
     idet->eof = 0;
-    idet->last_type = UNDETERMINED;
-    memset(idet->history, UNDETERMINED, HIST_SIZE);
+    ff_idet_init_history(idet);
+    ff_idet_init(idet, 0);
 
-    if( idet->half_life > 0 )
-        idet->decay_coefficient = lrint( PRECISION * exp2(-1.0 / idet->half_life) );
-    else
-        idet->decay_coefficient = PRECISION;
+    return 0;
+}
 
-    idet->filter_line = ff_idet_filter_line_c;
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    IDETContext *idet = ctx->priv;
 
-#if ARCH_X86
-    ff_idet_init_x86(idet, 0);
-#endif
+    idet->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&idet->slice_sums);
+    idet->slice_sums = av_calloc(idet->nb_threads, sizeof(*idet->slice_sums));
+    if (!idet->slice_sums)
+        return AVERROR(ENOMEM);
 
     return 0;
 }
@@ -421,6 +474,7 @@ static const AVFilterPad idet_inputs[] = {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
         .filter_frame = filter_frame,
+        .config_props = config_input,
     },
 };
 
@@ -438,7 +492,7 @@ const AVFilter ff_vf_idet = {
     .priv_size     = sizeof(IDETContext),
     .init          = init,
     .uninit        = uninit,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(idet_inputs),
     FILTER_OUTPUTS(idet_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
@@ -23,6 +23,7 @@
 #include "avfilter.h"
 
 #define HIST_SIZE 4
+#define PRECISION 1048576
 
 typedef int (*ff_idet_filter_func)(const uint8_t *a, const uint8_t *b, const uint8_t *c, int w);
 
@@ -39,6 +40,15 @@ typedef enum {
     REPEAT_BOTTOM,
 } RepeatedField;
 
+/**
+ * Field differences gathered by one slice job.
+ */
+typedef struct IDETSliceSums {
+    int64_t alpha[2];
+    int64_t delta;
+    int64_t gamma[2];
+} IDETSliceSums;
+
 typedef struct IDETContext {
     const AVClass *class;
     float interlace_threshold;
@@ -69,10 +79,45 @@ typedef struct IDETContext {
 
     const AVPixFmtDescriptor *csp;
     int eof;
+
+    IDETSliceSums *slice_sums;
+    int nb_threads;
 } IDETContext;
 
+void ff_idet_init(IDETContext *idet, int for_16b);
 void ff_idet_init_x86(IDETContext *idet, int for_16b);
 
+/**
+ * Reset the detection history and set the decay of the statistics from
+ * the half_life option.
+ */
+void ff_idet_init_history(IDETContext *idet);
+
+/**
+ * Accumulate the field differences of line y of a plane into sums.
+ * Lines y - 1 and y + 1 must exist.
+ */
+static inline void ff_idet_filter_row(IDETSliceSums *sums, ff_idet_filter_func filter_line,
+                                      const uint8_t *prev, const uint8_t *cur,
+                                      const uint8_t *next, int refs, int y, int w)
+{
+    sums->alpha[ y   &1] += filter_line(cur-refs, prev, cur+refs, w);
+    sums->alpha[(y^1)&1] += filter_line(cur-refs, next, cur+refs, w);
+    sums->delta          += filter_line(cur-refs,  cur, cur+refs, w);
+    sums->gamma[(y^1)&1] += filter_line(cur     , prev, cur     , w);
+}
+
+/**
+ * Classify a frame from the field differences of all its lines, update the
+ * statistics and set the frame flags and the lavfi.idet metadata.
+ */
+void ff_idet_classify(IDETContext *idet, void *log_ctx, AVFrame *frame,
+                      const IDETSliceSums *sums);
+
+/**
+ * Log the detection totals.
+ */
+void ff_idet_log_totals(IDETContext *idet, void *log_ctx);
 /* main fall-back for left-over */
 int ff_idet_filter_line_c(const uint8_t *a, const uint8_t *b, const uint8_t *c, int w);
 int ff_idet_filter_line_c_16bit(const uint16_t *a, const uint16_t *b, const uint16_t *c, int w);
@@ -35,6 +35,7 @@
 #include "drawutils.h"
 #include "internal.h"
 #include "video.h"
+#include "warp.h"
 
 typedef struct LenscorrectionCtx {
     const AVClass *av_class;
@@ -49,7 +50,9 @@ typedef struct LenscorrectionCtx {
 
     int32_t *correction[4];
 
-    int (*filter_slice)(AVFilterContext *ctx, void *arg, int job, int nb_jobs, int plane);
+    WarpContext warp;
+    WarpMap map[4];
+    int32_t *pos;
 } LenscorrectionCtx;
 
 #define OFFSET(x) offsetof(LenscorrectionCtx, x)
@@ -59,9 +62,10 @@ static const AVOption lenscorrection_options[] = {
     { "cy", "set relative center y", OFFSET(cy), AV_OPT_TYPE_DOUBLE, {.dbl=0.5}, 0, 1, .flags=FLAGS },
     { "k1", "set quadratic distortion factor", OFFSET(k1), AV_OPT_TYPE_DOUBLE, {.dbl=0.0}, -1, 1, .flags=FLAGS },
     { "k2", "set double quadratic distortion factor", OFFSET(k2), AV_OPT_TYPE_DOUBLE, {.dbl=0.0}, -1, 1, .flags=FLAGS },
-    { "i",  "set interpolation type", OFFSET(interpolation), AV_OPT_TYPE_INT, {.i64=0}, 0, 64, .flags=FLAGS, "i" },
+    { "i",  "set interpolation type", OFFSET(interpolation), AV_OPT_TYPE_INT, {.i64=0}, 0, 2, .flags=FLAGS, "i" },
     {  "nearest",  "nearest neighbour", 0,                   AV_OPT_TYPE_CONST, {.i64=0},0, 0, .flags=FLAGS, "i" },
     {  "bilinear", "bilinear",          0,                   AV_OPT_TYPE_CONST, {.i64=1},0, 0, .flags=FLAGS, "i" },
+    {  "bicubic",  "bicubic",           0,                   AV_OPT_TYPE_CONST, {.i64=2},0, 0, .flags=FLAGS, "i" },
     { "fc", "set the color of the unmapped pixels", OFFSET(fill_rgba), AV_OPT_TYPE_COLOR, {.str="black@0"}, .flags = FLAGS },
     { NULL }
 };
@@ -72,108 +76,74 @@ typedef struct ThreadData {
     AVFrame *in, *out;
 } ThreadData;
 
-#define NEAREST(type, name)                                                    \
-static int filter##name##_slice(AVFilterContext *ctx, void *arg, int job,      \
-                                int nb_jobs, int plane)                        \
-{                                                                              \
-    LenscorrectionCtx *rect = ctx->priv;                                       \
-    ThreadData *td = arg;                                                      \
-    AVFrame *in = td->in;                                                      \
-    AVFrame *out = td->out;                                                    \
-                                                                               \
-    const int32_t *correction = rect->correction[plane];                       \
-    const int fill_color = rect->fill_color[plane];                            \
-    const int w = rect->planewidth[plane], h = rect->planeheight[plane];       \
-    const int xcenter = rect->cx * w;                                          \
-    const int ycenter = rect->cy * h;                                          \
-    const int start = (h *  job   ) / nb_jobs;                                 \
-    const int end   = (h * (job+1)) / nb_jobs;                                 \
-    const int inlinesize = in->linesize[plane] / sizeof(type);                 \
-    const int outlinesize = out->linesize[plane] / sizeof(type);               \
-    const type *indata = (const type *)in->data[plane];                        \
-    type *outrow = (type *)out->data[plane] + start * outlinesize;             \
-    for (int i = start; i < end; i++, outrow += outlinesize) {                 \
-        const int off_y = i - ycenter;                                         \
-        type *out = outrow;                                                    \
-        for (int j = 0; j < w; j++) {                                          \
-            const int off_x = j - xcenter;                                     \
-            const int64_t radius_mult = correction[j + i*w];                   \
-            const int x = xcenter + ((radius_mult * off_x + (1<<23))>>24);     \
-            const int y = ycenter + ((radius_mult * off_y + (1<<23))>>24);     \
-            const char isvalid = x >= 0 && x < w && y >= 0 && y < h;           \
-            *out++ =  isvalid ? indata[y * inlinesize + x] : fill_color;       \
-        }                                                                      \
-    }                                                                          \
-    return 0;                                                                  \
-}
+static int build_map_slice(AVFilterContext *ctx, void *arg, int job,
+                           int nb_jobs)
+{
+    LenscorrectionCtx *rect = ctx->priv;
+    int32_t *pos = rect->pos + job * 2 * rect->planewidth[0];
 
+    for (int plane = 0; plane < rect->nb_planes; plane++) {
+        const int32_t *correction = rect->correction[plane];
+        const int w = rect->planewidth[plane], h = rect->planeheight[plane];
+        const int xcenter = rect->cx * w;
+        const int ycenter = rect->cy * h;
+        const int start = (h *  job   ) / nb_jobs;
+        const int end   = (h * (job+1)) / nb_jobs;
+
+        for (int i = start; i < end; i++) {
+            const int off_y = i - ycenter;
+
+            for (int j = 0; j < w; j++) {
+                const int off_x = j - xcenter;
+                const int64_t radius_mult = correction[j + i*w];
+                const int x = xcenter + ((radius_mult * off_x + (1<<23)) >> 24);
+                const int y = ycenter + ((radius_mult * off_y + (1<<23)) >> 24);
+
+                if (x >= 0 && x < w && y >= 0 && y < h) {
+                    if (rect->interpolation) {
+                        /* x and y are the rounded positions, interpolate
+                         * between them and the next pixels like before */
+                        pos[2 * j    ] = xcenter * WARP_SUBPEL + ((radius_mult * off_x + (1<<23)) >> (24 - WARP_SUBPEL_BITS));
+                        pos[2 * j + 1] = ycenter * WARP_SUBPEL + ((radius_mult * off_y + (1<<23)) >> (24 - WARP_SUBPEL_BITS));
+                    } else {
+                        pos[2 * j    ] = x << WARP_SUBPEL_BITS;
+                        pos[2 * j + 1] = y << WARP_SUBPEL_BITS;
+                    }
+                } else {
+                    pos[2 * j    ] = WARP_INVALID;
+                    pos[2 * j + 1] = 0;
+                }
+            }
+
+            ff_warp_map_set_row(&rect->warp, &rect->map[plane], i, pos);
+        }
+    }
 
-NEAREST(uint8_t, 8)
-NEAREST(uint16_t, 16)
-
-#define BILINEAR(type, name)                                                   \
-static int filter##name##_slice_bilinear(AVFilterContext *ctx, void *arg,      \
-                                         int job, int nb_jobs, int plane)      \
-{                                                                              \
-    LenscorrectionCtx *rect = ctx->priv;                                       \
-    ThreadData *td = arg;                                                      \
-    AVFrame *in = td->in;                                                      \
-    AVFrame *out = td->out;                                                    \
-                                                                               \
-    const int32_t *correction = rect->correction[plane];                       \
-    const int fill_color = rect->fill_color[plane];                            \
-    const int depth = rect->depth;                                             \
-    const uint64_t max = (1 << 24) - 1;                                        \
-    const uint64_t add = (1 << 23);                                            \
-    const int w = rect->planewidth[plane], h = rect->planeheight[plane];       \
-    const int xcenter = rect->cx * w;                                          \
-    const int ycenter = rect->cy * h;                                          \
-    const int start = (h *  job   ) / nb_jobs;                                 \
-    const int end   = (h * (job+1)) / nb_jobs;                                 \
-    const int inlinesize = in->linesize[plane] / sizeof(type);                 \
-    const int outlinesize = out->linesize[plane] / sizeof(type);               \
-    const type *indata = (const type *)in->data[plane];                        \
-    type *outrow = (type *)out->data[plane] + start * outlinesize;             \
-                                                                               \
-    for (int i = start; i < end; i++, outrow += outlinesize) {                 \
-        const int off_y = i - ycenter;                                         \
-        type *out = outrow;                                                    \
-                                                                               \
-        for (int j = 0; j < w; j++) {                                          \
-            const int off_x = j - xcenter;                                     \
-            const int64_t radius_mult = correction[j + i*w];                   \
-            const int x = xcenter + ((radius_mult * off_x + (1<<23)) >> 24);   \
-            const int y = ycenter + ((radius_mult * off_y + (1<<23)) >> 24);   \
-            const char isvalid = x >= 0 && x <= w - 1 && y >= 0 && y <= h - 1; \
-                                                                               \
-            if (isvalid) {                                                     \
-                const int nx = FFMIN(x + 1, w - 1);                            \
-                const int ny = FFMIN(y + 1, h - 1);                            \
-                const uint64_t du = off_x >= 0 ? (radius_mult * off_x + add) & max : max - ((radius_mult * -off_x + add) & max); \
-                const uint64_t dv = off_y >= 0 ? (radius_mult * off_y + add) & max : max - ((radius_mult * -off_y + add) & max); \
-                const uint64_t p0 = indata[ y * inlinesize +  x];              \
-                const uint64_t p1 = indata[ y * inlinesize + nx];              \
-                const uint64_t p2 = indata[ny * inlinesize +  x];              \
-                const uint64_t p3 = indata[ny * inlinesize + nx];              \
-                uint64_t sum = 0;                                              \
-                                                                               \
-                sum += (max - du) * (max - dv) * p0;                           \
-                sum += (      du) * (max - dv) * p1;                           \
-                sum += (max - du) * (      dv) * p2;                           \
-                sum += (      du) * (      dv) * p3;                           \
-                                                                               \
-                out[j] = av_clip_uintp2_c((sum + (1ULL << 47)) >> 48, depth);  \
-            } else {                                                           \
-                out[j] = fill_color;                                           \
-            }                                                                  \
-        }                                                                      \
-    }                                                                          \
-                                                                               \
-    return 0;                                                                  \
+    return 0;
 }
 
-BILINEAR(uint8_t, 8)
-BILINEAR(uint16_t, 16)
+static int filter_slice(AVFilterContext *ctx, void *arg, int job,
+                        int nb_jobs)
+{
+    LenscorrectionCtx *rect = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in;
+    AVFrame *out = td->out;
+
+    for (int plane = 0; plane < rect->nb_planes; plane++) {
+        const int h = rect->planeheight[plane];
+        const int start = (h *  job   ) / nb_jobs;
+        const int end   = (h * (job+1)) / nb_jobs;
+
+        for (int i = start; i < end; i++)
+            ff_warp_map_apply_row(&rect->warp, &rect->map[plane], i,
+                                  out->data[plane] + i * out->linesize[plane],
+                                  in->data[plane], in->linesize[plane],
+                                  rect->fill_color[plane]);
+    }
+
+    return 0;
+}
 
 static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_GRAY8, AV_PIX_FMT_GRAY9,
@@ -210,6 +180,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     for (i = 0; i < FF_ARRAY_ELEMS(rect->correction); i++) {
         av_freep(&rect->correction[i]);
     }
+    for (i = 0; i < FF_ARRAY_ELEMS(rect->map); i++)
+        ff_warp_map_free(&rect->map[i]);
+    av_freep(&rect->pos);
 }
 
 static void calc_correction(AVFilterContext *ctx, int plane)
@@ -246,6 +219,12 @@ static int config_output(AVFilterLink *outlink)
     uint8_t rgba_map[4];
     int factor;
 
+    if (inlink->w > INT16_MAX || inlink->h > INT16_MAX) {
+        av_log(ctx, AV_LOG_ERROR, "Input dimensions %dx%d exceed %d.\n",
+               inlink->w, inlink->h, INT16_MAX);
+        return AVERROR(EINVAL);
+    }
+
     ff_fill_rgba_map(rgba_map, inlink->format);
     rect->depth = pixdesc->comp[0].depth;
     factor = 1 << (rect->depth - 8);
@@ -254,9 +233,7 @@ static int config_output(AVFilterLink *outlink)
     rect->planewidth[1]  = rect->planewidth[2]  = AV_CEIL_RSHIFT(inlink->w, pixdesc->log2_chroma_w);
     rect->planewidth[0]  = rect->planewidth[3]  = inlink->w;
     rect->nb_planes = av_pix_fmt_count_planes(inlink->format);
-    rect->filter_slice = rect->depth <= 8 ? filter8_slice : filter16_slice;
-    if (rect->interpolation)
-        rect->filter_slice = rect->depth <= 8 ? filter8_slice_bilinear : filter16_slice_bilinear;
+    ff_warp_init(&rect->warp, rect->interpolation, rect->depth);
 
     if (is_rgb) {
         rect->fill_color[rgba_map[0]] = rect->fill_rgba[0] * factor;
@@ -273,24 +250,27 @@ static int config_output(AVFilterLink *outlink)
     for (int plane = 0; plane < rect->nb_planes; plane++) {
         int w = rect->planewidth[plane];
         int h = rect->planeheight[plane];
+        int ret;
 
         if (!rect->correction[plane])
             rect->correction[plane] = av_malloc_array(w, h * sizeof(**rect->correction));
         if (!rect->correction[plane])
             return AVERROR(ENOMEM);
         calc_correction(ctx, plane);
-    }
 
-    return 0;
-}
+        ret = ff_warp_map_alloc(&rect->warp, &rect->map[plane], w, h, w, h);
+        if (ret < 0)
+            return ret;
+    }
 
-static int filter_slice(AVFilterContext *ctx, void *arg, int job,
-                        int nb_jobs)
-{
-    LenscorrectionCtx *rect = ctx->priv;
+    av_freep(&rect->pos);
+    rect->pos = av_malloc_array(ff_filter_get_nb_threads(ctx),
+                                2 * rect->planewidth[0] * sizeof(*rect->pos));
+    if (!rect->pos)
+        return AVERROR(ENOMEM);
 
-    for (int plane = 0; plane < rect->nb_planes; plane++)
-        rect->filter_slice(ctx, arg, job, nb_jobs, plane);
+    ff_filter_execute(ctx, build_map_slice, NULL, NULL,
+                      FFMIN(rect->planeheight[1], ff_filter_get_nb_threads(ctx)));
 
     return 0;
 }
@@ -30,6 +30,7 @@
 #include "formats.h"
 #include "internal.h"
 #include "framesync.h"
+#include "tmix.h"
 #include "video.h"
 
 typedef struct MixContext {
@@ -58,6 +59,12 @@ typedef struct MixContext {
 
     AVFrame **frames;
     FFFrameSync fs;
+
+    int slide;
+    int slide_weight;
+    int sums_valid;
+    uint32_t *sums[4];
+    TMixDSPContext dsp;
 } MixContext;
 
 static int query_formats(AVFilterContext *ctx)
@@ -142,7 +149,7 @@ static av_cold int init(AVFilterContext *ctx)
 }
 
 typedef struct ThreadData {
-    AVFrame **in, *out;
+    AVFrame **in, *out, *old;
 } ThreadData;
 
 #define MIX_SLICE(type, fun, clip)                                                              \
@@ -191,6 +198,35 @@ typedef struct ThreadData {
 #define CLIPF(x, min, max) (x)
 #define NOP(x) (x)
 
+#if CONFIG_TMIX_FILTER
+#define SLIDE(name, type, clip)                                                 \
+static void slide_##name(uint8_t *dstp, uint32_t *sum, const uint8_t *addp,    \
+                         const uint8_t *subp, int w, int weight, int max,      \
+                         float factor)                                         \
+{                                                                               \
+    const type *add = (const type *)addp;                                       \
+    const type *sub = (const type *)subp;                                       \
+    type *dst = (type *)dstp;                                                   \
+                                                                                \
+    for (int x = 0; x < w; x++) {                                               \
+        sum[x] += add[x] - sub[x];                                              \
+        dst[x] = clip(lrintf((float)(sum[x] * weight) * factor), 0, max);       \
+    }                                                                           \
+}
+
+SLIDE(8,  uint8_t,  CLIP8)
+SLIDE(16, uint16_t, CLIP16)
+
+av_cold void ff_tmix_init_dsp(TMixDSPContext *dsp, int depth)
+{
+    dsp->slide = depth <= 8 ? slide_8 : slide_16;
+
+#if ARCH_X86
+    ff_tmix_init_x86(dsp, depth);
+#endif
+}
+#endif
+
 static int mix_frames(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     MixContext *s = ctx->priv;
@@ -248,6 +284,42 @@ static int process_frame(FFFrameSync *fs)
     return ff_filter_frame(outlink, out);
 }
 
+/*
+ * With equal integer weights the weighted sum of the tmix window can be
+ * kept per pixel and updated by adding the newest and subtracting the
+ * oldest frame, instead of summing all frames again for every output.
+ * This is only done if the sum stays exactly representable as float, so
+ * the output is identical to the full sum.
+ */
+static void update_slide(MixContext *s)
+{
+    const float weight = s->weights[0];
+    int pixel_max;
+
+    s->slide = 0;
+    s->sums_valid = 0;
+
+    if (!s->tmix || !s->desc || s->depth > 16 ||
+        (s->desc->flags & AV_PIX_FMT_FLAG_FLOAT))
+        return;
+
+    if (weight < 1.f || weight > 1 << 24 || weight != (int)weight)
+        return;
+
+    for (int i = 1; i < s->nb_inputs; i++) {
+        if (s->weights[i] != weight)
+            return;
+    }
+
+    pixel_max = s->depth <= 8 ? UINT8_MAX : UINT16_MAX;
+    if ((double)s->nb_inputs * pixel_max * weight > 1 << 24 ||
+        (double)s->nb_inputs * pixel_max * weight * s->wfactor >= INT_MAX)
+        return;
+
+    s->slide_weight = weight;
+    s->slide = 1;
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -283,6 +355,12 @@ static int config_output(AVFilterLink *outlink)
     s->height[1] = s->height[2] = AV_CEIL_RSHIFT(inlink->h, s->desc->log2_chroma_h);
     s->height[0] = s->height[3] = inlink->h;
 
+#if CONFIG_TMIX_FILTER
+    if (s->tmix && s->depth <= 16)
+        ff_tmix_init_dsp(&s->dsp, s->depth);
+#endif
+    update_slide(s);
+
     s->data = av_calloc(s->nb_threads * s->nb_inputs, sizeof(*s->data));
     if (!s->data)
         return AVERROR(ENOMEM);
@@ -330,6 +408,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_freep(&s->weights);
     av_freep(&s->data);
     av_freep(&s->linesize);
+    for (i = 0; i < 4; i++)
+        av_freep(&s->sums[i]);
 
     if (s->tmix) {
         for (i = 0; i < s->nb_frames && s->frames; i++)
@@ -341,13 +421,20 @@ static av_cold void uninit(AVFilterContext *ctx)
 static int process_command(AVFilterContext *ctx, const char *cmd, const char *args,
                            char *res, int res_len, int flags)
 {
+    MixContext *s = ctx->priv;
     int ret;
 
     ret = ff_filter_process_command(ctx, cmd, args, res, res_len, flags);
     if (ret < 0)
         return ret;
 
-    return parse_weights(ctx);
+    ret = parse_weights(ctx);
+    if (ret < 0)
+        return ret;
+
+    update_slide(s);
+
+    return 0;
 }
 
 static int activate(AVFilterContext *ctx)
@@ -401,11 +488,67 @@ const AVFilter ff_vf_mix = {
 #endif /* CONFIG_MIX_FILTER */
 
 #if CONFIG_TMIX_FILTER
+static int tmix_slide_frames(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    MixContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame **in = td->in;
+    AVFrame *newest = in[s->nb_inputs - 1];
+    AVFrame *old = td->old;
+    AVFrame *out = td->out;
+    const int bytes = s->depth <= 8 ? 1 : 2;
+
+    for (int p = 0; p < s->nb_planes; p++) {
+        const int slice_start = (s->height[p] * jobnr) / nb_jobs;
+        const int slice_end = (s->height[p] * (jobnr+1)) / nb_jobs;
+        const int width = s->linesizes[p] / bytes;
+        uint8_t *dst = out->data[p] + slice_start * out->linesize[p];
+
+        if (!((1 << p) & s->planes)) {
+            av_image_copy_plane(dst, out->linesize[p],
+                                in[0]->data[p] + slice_start * in[0]->linesize[p],
+                                in[0]->linesize[p],
+                                s->linesizes[p], slice_end - slice_start);
+            continue;
+        }
+
+        for (int y = slice_start; y < slice_end; y++) {
+            const uint8_t *add = newest->data[p] + y * newest->linesize[p];
+            const uint8_t *sub = add;
+            uint32_t *sum = s->sums[p] + y * width;
+
+            if (old) {
+                sub = old->data[p] + y * old->linesize[p];
+            } else {
+                memset(sum, 0, width * sizeof(*sum));
+                for (int i = 0; i < s->nb_inputs; i++) {
+                    const uint8_t *src = in[i]->data[p] + y * in[i]->linesize[p];
+
+                    if (bytes == 1) {
+                        for (int x = 0; x < width; x++)
+                            sum[x] += src[x];
+                    } else {
+                        for (int x = 0; x < width; x++)
+                            sum[x] += ((const uint16_t *)src)[x];
+                    }
+                }
+            }
+
+            s->dsp.slide(dst, sum, add, sub, width,
+                         s->slide_weight, s->max, s->wfactor);
+            dst += out->linesize[p];
+        }
+    }
+
+    return 0;
+}
+
 static int tmix_filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     AVFilterLink *outlink = ctx->outputs[0];
     MixContext *s = ctx->priv;
+    AVFrame *old = NULL;
     ThreadData td;
     AVFrame *out;
 
@@ -422,12 +565,14 @@ static int tmix_filter_frame(AVFilterLink *inlink, AVFrame *in)
             s->nb_frames++;
         }
     } else {
-        av_frame_free(&s->frames[0]);
+        old = s->frames[0];
         memmove(&s->frames[0], &s->frames[1], sizeof(*s->frames) * (s->nb_inputs - 1));
         s->frames[s->nb_inputs - 1] = in;
     }
 
     if (ctx->is_disabled) {
+        av_frame_free(&old);
+        s->sums_valid = 0;
         out = av_frame_clone(s->frames[0]);
         if (!out)
             return AVERROR(ENOMEM);
@@ -435,14 +580,35 @@ static int tmix_filter_frame(AVFilterLink *inlink, AVFrame *in)
     }
 
     out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
-    if (!out)
+    if (!out) {
+        av_frame_free(&old);
         return AVERROR(ENOMEM);
+    }
     out->pts = s->frames[s->nb_frames - 1]->pts;
 
     td.out = out;
     td.in = s->frames;
-    ff_filter_execute(ctx, mix_frames, &td, NULL,
-                      FFMIN(s->height[1], s->nb_threads));
+    if (s->slide) {
+        for (int p = 0; p < s->nb_planes && !s->sums[p]; p++) {
+            const int width = s->linesizes[p] / (s->depth <= 8 ? 1 : 2);
+
+            s->sums[p] = av_malloc_array(width * s->height[p], sizeof(*s->sums[p]));
+            if (!s->sums[p]) {
+                av_frame_free(&old);
+                av_frame_free(&out);
+                return AVERROR(ENOMEM);
+            }
+        }
+
+        td.old = s->sums_valid ? old : NULL;
+        ff_filter_execute(ctx, tmix_slide_frames, &td, NULL,
+                          FFMIN(s->height[1], s->nb_threads));
+        s->sums_valid = 1;
+    } else {
+        ff_filter_execute(ctx, mix_frames, &td, NULL,
+                          FFMIN(s->height[1], s->nb_threads));
+    }
+    av_frame_free(&old);
 
     return ff_filter_frame(outlink, out);
 }
@@ -24,6 +24,8 @@
  * Rich Felker.
  */
 
+#include <stdatomic.h>
+
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixelutils.h"
@@ -49,6 +51,9 @@ typedef struct DecimateContext {
     int hsub, vsub;                ///< chroma subsampling values
     AVFrame *ref;                  ///< reference picture
     av_pixelutils_sad_fn sad;      ///< sum of absolute difference function
+
+    int *slice_count;              ///< per job number of blocks above the low threshold
+    int nb_threads;
 } DecimateContext;
 
 #define OFFSET(x) offsetof(DecimateContext, x)
@@ -65,6 +70,53 @@ static const AVOption mpdecimate_options[] = {
 
 AVFILTER_DEFINE_CLASS(mpdecimate);
 
+typedef struct ThreadData {
+    uint8_t *cur, *ref;
+    int cur_linesize, ref_linesize;
+    int w, h;
+    int t;                         ///< maximum number of blocks above the low threshold
+    atomic_int different;          ///< set as soon as any job found the planes different
+    atomic_int hi_diff;            ///< SAD of a block found above the high threshold
+} ThreadData;
+
+/**
+ * Count the 8x8 blocks of a band of rows which are above the low threshold,
+ * stopping early once the planes are known to differ.
+ */
+static int diff_planes_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DecimateContext *decimate = ctx->priv;
+    ThreadData *td = arg;
+    const int nb_rows = (td->h - 4) / 4;
+    const int row_start = (nb_rows *  jobnr     ) / nb_jobs;
+    const int row_end   = (nb_rows * (jobnr + 1)) / nb_jobs;
+    int x, y, d, c = 0;
+
+    /* compute difference for blocks of 8x8 bytes */
+    for (y = row_start * 4; y < row_end * 4; y += 4) {
+        if (atomic_load_explicit(&td->different, memory_order_relaxed))
+            break;
+        for (x = 8; x < td->w-7; x += 4) {
+            d = decimate->sad(td->cur + y*td->cur_linesize + x, td->cur_linesize,
+                              td->ref + y*td->ref_linesize + x, td->ref_linesize);
+            if (d > decimate->hi) {
+                atomic_store(&td->hi_diff, d);
+                atomic_store(&td->different, 1);
+                goto end;
+            }
+            if (d > decimate->lo && ++c > td->t) {
+                atomic_store(&td->different, 1);
+                goto end;
+            }
+        }
+    }
+
+end:
+    emms_c();
+    decimate->slice_count[jobnr] = c;
+    return 0;
+}
+
 /**
  * Return 1 if the two planes are different, 0 otherwise.
  */
@@ -74,31 +126,38 @@ static int diff_planes(AVFilterContext *ctx,
                        int w, int h)
 {
     DecimateContext *decimate = ctx->priv;
+    ThreadData td;
+    int nb_jobs, c = 0;
 
-    int x, y;
-    int d, c = 0;
-    int t = (w/16)*(h/16)*decimate->frac;
+    if (h < 8)
+        return 0;
 
-    /* compute difference for blocks of 8x8 bytes */
-    for (y = 0; y < h-7; y += 4) {
-        for (x = 8; x < w-7; x += 4) {
-            d = decimate->sad(cur + y*cur_linesize + x, cur_linesize,
-                              ref + y*ref_linesize + x, ref_linesize);
-            if (d > decimate->hi) {
-                av_log(ctx, AV_LOG_DEBUG, "%d>=hi ", d);
-                return 1;
-            }
-            if (d > decimate->lo) {
-                c++;
-                if (c > t) {
-                    av_log(ctx, AV_LOG_DEBUG, "lo:%d>=%d ", c, t);
-                    return 1;
-                }
-            }
-        }
+    td.cur          = cur;
+    td.ref          = ref;
+    td.cur_linesize = cur_linesize;
+    td.ref_linesize = ref_linesize;
+    td.w            = w;
+    td.h            = h;
+    td.t            = (w/16)*(h/16)*decimate->frac;
+    atomic_init(&td.hi_diff, 0);
+    atomic_init(&td.different, 0);
+
+    nb_jobs = FFMIN((h - 4) / 4, decimate->nb_threads);
+    ff_filter_execute(ctx, diff_planes_slice, &td, NULL, nb_jobs);
+
+    if (atomic_load(&td.hi_diff)) {
+        av_log(ctx, AV_LOG_DEBUG, "%d>=hi ", atomic_load(&td.hi_diff));
+        return 1;
+    }
+
+    for (int i = 0; i < nb_jobs; i++)
+        c += decimate->slice_count[i];
+    if (atomic_load(&td.different) || c > td.t) {
+        av_log(ctx, AV_LOG_DEBUG, "lo:%d>=%d ", c, td.t);
+        return 1;
     }
 
-    av_log(ctx, AV_LOG_DEBUG, "lo:%d<%d ", c, t);
+    av_log(ctx, AV_LOG_DEBUG, "lo:%d<%d ", c, td.t);
     return 0;
 }
 
@@ -131,13 +190,10 @@ static int decimate_frame(AVFilterContext *ctx,
                         cur->data[plane], cur->linesize[plane],
                         ref->data[plane], ref->linesize[plane],
                         AV_CEIL_RSHIFT(ref->width,  hsub),
-                        AV_CEIL_RSHIFT(ref->height, vsub))) {
-            emms_c();
+                        AV_CEIL_RSHIFT(ref->height, vsub)))
             return 0;
-        }
     }
 
-    emms_c();
     return 1;
 }
 
@@ -159,6 +215,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     DecimateContext *decimate = ctx->priv;
     av_frame_free(&decimate->ref);
+    av_freep(&decimate->slice_count);
 }
 
 static const enum AVPixelFormat pix_fmts[] = {
@@ -185,6 +242,12 @@ static int config_input(AVFilterLink *inlink)
     decimate->hsub = pix_desc->log2_chroma_w;
     decimate->vsub = pix_desc->log2_chroma_h;
 
+    decimate->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&decimate->slice_count);
+    decimate->slice_count = av_calloc(decimate->nb_threads, sizeof(*decimate->slice_count));
+    if (!decimate->slice_count)
+        return AVERROR(ENOMEM);
+
     return 0;
 }
 
@@ -243,4 +306,5 @@ const AVFilter ff_vf_mpdecimate = {
     FILTER_INPUTS(mpdecimate_inputs),
     FILTER_OUTPUTS(mpdecimate_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
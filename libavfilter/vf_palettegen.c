@@ -56,6 +56,18 @@ struct hist_node {
     int nb_entries;
 };
 
+/* Open addressing table of the color counts of a job */
+struct color_count {
+    uint32_t color;
+    int64_t count;      // 0 if the entry is unused
+};
+
+struct count_table {
+    struct color_count *entries;
+    unsigned mask;      // number of entries - 1
+    unsigned nb_used;   // number of used entries
+};
+
 enum {
     STATS_MODE_ALL_FRAMES,
     STATS_MODE_DIFF_FRAMES,
@@ -64,6 +76,7 @@ enum {
 };
 
 #define HIST_SIZE (1<<15)
+#define COUNT_TABLE_SIZE (1<<12) // initial size of the count tables
 
 typedef struct PaletteGenContext {
     const AVClass *class;
@@ -71,9 +84,14 @@ typedef struct PaletteGenContext {
     int max_colors;
     int reserve_transparent;
     int stats_mode;
+    int frame_step;
 
     AVFrame *prev_frame;                    // previous frame used for the diff stats_mode
     struct hist_node histogram[HIST_SIZE];  // histogram/hashtable of the colors
+    struct count_table *thread_counts;      // per-job color counts, merged into histogram when needed
+    int *thread_ret;                        // per-job return values
+    int nb_threads;
+    int64_t nb_frames;                      // number of input frames seen
     struct color_ref **refs;                // references of all the colors used in the stream
     int nb_refs;                            // number of color references (or number of different colors)
     struct range_box boxes[256];            // define the segmentation of the colorspace (the final palette)
@@ -92,6 +110,7 @@ static const AVOption palettegen_options[] = {
         { "full", "compute full frame histograms", 0, AV_OPT_TYPE_CONST, {.i64=STATS_MODE_ALL_FRAMES}, INT_MIN, INT_MAX, FLAGS, "mode" },
         { "diff", "compute histograms only for the part that differs from previous frame", 0, AV_OPT_TYPE_CONST, {.i64=STATS_MODE_DIFF_FRAMES}, INT_MIN, INT_MAX, FLAGS, "mode" },
         { "single", "compute new histogram for each frame", 0, AV_OPT_TYPE_CONST, {.i64=STATS_MODE_SINGLE_FRAMES}, INT_MIN, INT_MAX, FLAGS, "mode" },
+    { "frame_step", "set the interval between analyzed frames", OFFSET(frame_step), AV_OPT_TYPE_INT, {.i64=1}, 1, INT_MAX, FLAGS },
     { NULL }
 };
 
@@ -112,6 +131,8 @@ static int query_formats(AVFilterContext *ctx)
 
 typedef int (*cmp_func)(const void *, const void *);
 
+/* Colors only differing by their alpha are ordered by their value, so that the
+ * order of the histogram entries has no influence on the palette. */
 #define DECLARE_CMP_FUNC(k0, k1, k2)                        \
 static int cmp_##k0##k1##k2(const void *pa, const void *pb) \
 {                                                           \
@@ -120,7 +141,8 @@ static int cmp_##k0##k1##k2(const void *pa, const void *pb) \
     const int c0 = FFDIFFSIGN((*a)->lab.k0, (*b)->lab.k0);  \
     const int c1 = FFDIFFSIGN((*a)->lab.k1, (*b)->lab.k1);  \
     const int c2 = FFDIFFSIGN((*a)->lab.k2, (*b)->lab.k2);  \
-    return c0 ? c0 : c1 ? c1 : c2;                          \
+    const int c3 = FFDIFFSIGN((*a)->color,  (*b)->color);   \
+    return c0 ? c0 : c1 ? c1 : c2 ? c2 : c3;                \
 }
 
 DECLARE_CMP_FUNC(L, a, b)
@@ -387,9 +409,9 @@ static AVFrame *get_palette_frame(AVFilterContext *ctx)
 }
 
 /**
- * Locate the color in the hash table and increment its counter.
+ * Locate the color in the hash table and add count to its counter.
  */
-static int color_inc(struct hist_node *hist, uint32_t color)
+static int color_inc(struct hist_node *hist, uint32_t color, int64_t count)
 {
     const uint32_t hash = ff_lowbias32(color) & (HIST_SIZE - 1);
     struct hist_node *node = &hist[hash];
@@ -398,7 +420,7 @@ static int color_inc(struct hist_node *hist, uint32_t color)
     for (int i = 0; i < node->nb_entries; i++) {
         e = &node->entries[i];
         if (e->color == color) {
-            e->count++;
+            e->count += count;
             return 0;
         }
     }
@@ -409,52 +431,140 @@ static int color_inc(struct hist_node *hist, uint32_t color)
         return AVERROR(ENOMEM);
     e->color = color;
     e->lab = ff_srgb_u8_to_oklab_int(color);
-    e->count = 1;
+    e->count = count;
     return 1;
 }
 
+static int count_table_alloc(struct count_table *t, unsigned size)
+{
+    t->entries = av_calloc(size, sizeof(*t->entries));
+    if (!t->entries)
+        return AVERROR(ENOMEM);
+    t->mask    = size - 1;
+    t->nb_used = 0;
+    return 0;
+}
+
+static inline struct color_count *count_table_find(const struct count_table *t, uint32_t color)
+{
+    unsigned i = ff_lowbias32(color) & t->mask;
+
+    while (t->entries[i].count && t->entries[i].color != color)
+        i = (i + 1) & t->mask;
+    return &t->entries[i];
+}
+
+/**
+ * Double the size of the table and rehash its entries.
+ */
+static int count_table_grow(struct count_table *t)
+{
+    const struct count_table old = *t;
+    int ret;
+
+    if (old.mask >= UINT_MAX / 4)
+        return AVERROR(ENOMEM);
+    if ((ret = count_table_alloc(t, (old.mask + 1) * 2)) < 0) {
+        *t = old;
+        return ret;
+    }
+    for (unsigned i = 0; i <= old.mask; i++)
+        if (old.entries[i].count)
+            *count_table_find(t, old.entries[i].color) = old.entries[i];
+    t->nb_used = old.nb_used;
+    av_free(old.entries);
+    return 0;
+}
+
+/**
+ * Add count to the color in the count table of a job. Unlike the histogram,
+ * the table is flat and kept at most half full, so that most colors are found
+ * with a single memory access.
+ */
+static inline int count_inc(struct count_table *t, uint32_t color, int64_t count)
+{
+    struct color_count *e = count_table_find(t, color);
+
+    if (e->count) {
+        e->count += count;
+        return 0;
+    }
+    e->color = color;
+    e->count = count;
+    if (++t->nb_used > t->mask >> 1)
+        return count_table_grow(t);
+    return 0;
+}
+
+typedef struct ThreadData {
+    const AVFrame *f1, *f2;
+} ThreadData;
+
 /**
- * Update histogram when pixels differ from previous frame.
+ * Update the histogram of the job with its slice of the frame. When f2 is
+ * set, only the pixels of f1 differing from it are accounted.
  */
-static int update_histogram_diff(struct hist_node *hist,
-                                 const AVFrame *f1, const AVFrame *f2)
+static int update_histogram_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    int x, y, ret, nb_diff_colors = 0;
+    PaletteGenContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const AVFrame *f1 = td->f1, *f2 = td->f2;
+    struct count_table *counts = &s->thread_counts[jobnr];
+    const int w = f1->width;
+    const int slice_start = (f1->height *  jobnr     ) / nb_jobs;
+    const int slice_end   = (f1->height * (jobnr + 1)) / nb_jobs;
+    uint32_t run_color = 0;
+    int64_t run = 0;
+    int ret;
 
-    for (y = 0; y < f1->height; y++) {
+    for (int y = slice_start; y < slice_end; y++) {
         const uint32_t *p = (const uint32_t *)(f1->data[0] + y*f1->linesize[0]);
-        const uint32_t *q = (const uint32_t *)(f2->data[0] + y*f2->linesize[0]);
+        const uint32_t *q = f2 ? (const uint32_t *)(f2->data[0] + y*f2->linesize[0]) : NULL;
 
-        for (x = 0; x < f1->width; x++) {
-            if (p[x] == q[x])
+        for (int x = 0; x < w; x++) {
+            if (q && p[x] == q[x])
+                continue;
+            /* batch the runs of identical colors */
+            if (run && p[x] == run_color) {
+                run++;
                 continue;
-            ret = color_inc(hist, p[x]);
-            if (ret < 0)
+            }
+            if (run && (ret = count_inc(counts, run_color, run)) < 0)
                 return ret;
-            nb_diff_colors += ret;
+            run_color = p[x];
+            run = 1;
         }
     }
-    return nb_diff_colors;
+
+    if (run && (ret = count_inc(counts, run_color, run)) < 0)
+        return ret;
+    return 0;
 }
 
 /**
- * Simple histogram of the frame.
+ * Merge the per-job color counts into the main histogram and reset them. The
+ * palette does not depend on the order of the histogram entries, so neither
+ * does it on the number of jobs.
  */
-static int update_histogram_frame(struct hist_node *hist, const AVFrame *f)
+static int merge_histograms(PaletteGenContext *s)
 {
-    int x, y, ret, nb_diff_colors = 0;
+    for (int n = 0; n < s->nb_threads; n++) {
+        struct count_table *t = &s->thread_counts[n];
 
-    for (y = 0; y < f->height; y++) {
-        const uint32_t *p = (const uint32_t *)(f->data[0] + y*f->linesize[0]);
+        for (unsigned i = 0; i <= t->mask; i++) {
+            const struct color_count *e = &t->entries[i];
+            int ret;
 
-        for (x = 0; x < f->width; x++) {
-            ret = color_inc(hist, p[x]);
-            if (ret < 0)
+            if (!e->count)
+                continue;
+            if ((ret = color_inc(s->histogram, e->color, e->count)) < 0)
                 return ret;
-            nb_diff_colors += ret;
+            s->nb_refs += ret;
         }
+        memset(t->entries, 0, (t->mask + 1) * sizeof(*t->entries));
+        t->nb_used = 0;
     }
-    return nb_diff_colors;
+    return 0;
 }
 
 /**
@@ -464,24 +574,47 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     AVFilterContext *ctx = inlink->dst;
     PaletteGenContext *s = ctx->priv;
-    int ret;
+    const int nb_jobs = FFMIN(s->nb_threads, in->height);
+    ThreadData td;
+    int ret = 0;
 
     if (in->color_trc != AVCOL_TRC_UNSPECIFIED && in->color_trc != AVCOL_TRC_IEC61966_2_1)
         av_log(ctx, AV_LOG_WARNING, "The input frame is not in sRGB, colors may be off\n");
 
-    ret = s->prev_frame ? update_histogram_diff(s->histogram, s->prev_frame, in)
-                        : update_histogram_frame(s->histogram, in);
-    if (ret > 0)
-        s->nb_refs += ret;
+    /* every frame needs its own palette in single mode */
+    if (s->stats_mode != STATS_MODE_SINGLE_FRAMES && s->nb_frames++ % s->frame_step) {
+        av_frame_free(&in);
+        return 0;
+    }
+
+    td.f1 = s->prev_frame ? s->prev_frame : in;
+    td.f2 = s->prev_frame ? in : NULL;
+    ff_filter_execute(ctx, update_histogram_slice, &td, s->thread_ret, nb_jobs);
+    for (int i = 0; i < nb_jobs; i++) {
+        if (s->thread_ret[i] < 0) {
+            av_frame_free(&in);
+            return s->thread_ret[i];
+        }
+    }
 
     if (s->stats_mode == STATS_MODE_DIFF_FRAMES) {
         av_frame_free(&s->prev_frame);
         s->prev_frame = in;
-    } else if (s->stats_mode == STATS_MODE_SINGLE_FRAMES && s->nb_refs > 0) {
+    } else if (s->stats_mode == STATS_MODE_SINGLE_FRAMES) {
         AVFrame *out;
         int i;
 
+        ret = merge_histograms(s);
+        if (ret < 0 || !s->nb_refs) {
+            av_frame_free(&in);
+            return ret;
+        }
+
         out = get_palette_frame(ctx);
+        if (!out) {
+            av_frame_free(&in);
+            return AVERROR(ENOMEM);
+        }
         out->pts = in->pts;
         av_frame_free(&in);
         ret = ff_filter_frame(ctx->outputs[0], out);
@@ -510,14 +643,60 @@ static int request_frame(AVFilterLink *outlink)
     int r;
 
     r = ff_request_frame(inlink);
-    if (r == AVERROR_EOF && !s->palette_pushed && s->nb_refs && s->stats_mode != STATS_MODE_SINGLE_FRAMES) {
-        r = ff_filter_frame(outlink, get_palette_frame(ctx));
+    if (r == AVERROR_EOF && !s->palette_pushed && s->stats_mode != STATS_MODE_SINGLE_FRAMES) {
+        AVFrame *out;
+
+        if ((r = merge_histograms(s)) < 0)
+            return r;
+        if (!s->nb_refs)
+            return AVERROR_EOF;
+        out = get_palette_frame(ctx);
+        if (!out)
+            return AVERROR(ENOMEM);
+        r = ff_filter_frame(outlink, out);
         s->palette_pushed = 1;
         return r;
     }
     return r;
 }
 
+static void free_thread_counts(PaletteGenContext *s)
+{
+    if (s->thread_counts) {
+        for (int i = 0; i < s->nb_threads; i++)
+            av_freep(&s->thread_counts[i].entries);
+    }
+    av_freep(&s->thread_counts);
+    av_freep(&s->thread_ret);
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    PaletteGenContext *s = ctx->priv;
+
+    /* keep the colors counted before a reconfiguration */
+    if (s->thread_counts) {
+        int ret = merge_histograms(s);
+        if (ret < 0)
+            return ret;
+    }
+    free_thread_counts(s);
+
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    s->thread_counts = av_calloc(s->nb_threads, sizeof(*s->thread_counts));
+    s->thread_ret    = av_calloc(s->nb_threads, sizeof(*s->thread_ret));
+    if (!s->thread_counts || !s->thread_ret)
+        return AVERROR(ENOMEM);
+    for (int i = 0; i < s->nb_threads; i++) {
+        int ret = count_table_alloc(&s->thread_counts[i], COUNT_TABLE_SIZE);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 /**
  * The output is one simple 16x16 squared-pixels palette.
  */
@@ -547,6 +726,7 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     for (i = 0; i < HIST_SIZE; i++)
         av_freep(&s->histogram[i].entries);
+    free_thread_counts(s);
     av_freep(&s->refs);
     av_frame_free(&s->prev_frame);
 }
@@ -556,6 +736,7 @@ static const AVFilterPad palettegen_inputs[] = {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
         .filter_frame = filter_frame,
+        .config_props = config_input,
     },
 };
 
@@ -578,4 +759,5 @@ const AVFilter ff_vf_palettegen = {
     FILTER_OUTPUTS(palettegen_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &palettegen_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
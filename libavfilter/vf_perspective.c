@@ -28,10 +28,10 @@
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "warp.h"
 
 #define SUB_PIXEL_BITS  8
 #define SUB_PIXELS      (1 << SUB_PIXEL_BITS)
-#define COEFF_BITS      11
 
 #define LINEAR 0
 #define CUBIC  1
@@ -41,17 +41,16 @@ typedef struct PerspectiveContext {
     char *expr_str[4][2];
     double ref[4][2];
     int32_t (*pv)[2];
-    int32_t coeff[SUB_PIXELS][4];
     int interpolation;
+    WarpContext warp;
+    WarpMap map[4];
+    int32_t *pos;
     int linesize[4];
     int height[4];
     int hsub, vsub;
     int nb_planes;
     int sense;
     int eval_mode;
-
-    int (*perspective)(AVFilterContext *ctx,
-                       void *arg, int job, int nb_jobs);
 } PerspectiveContext;
 
 #define OFFSET(x) offsetof(PerspectiveContext, x)
@@ -101,22 +100,6 @@ static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_GBRP, AV_PIX_FMT_GBRAP, AV_PIX_FMT_GRAY8, AV_PIX_FMT_NONE
 };
 
-static inline double get_coeff(double d)
-{
-    double coeff, A = -0.60;
-
-    d = fabs(d);
-
-    if (d < 1.0)
-        coeff = (1.0 - (A + 3.0) * d * d + (A + 2.0) * d * d * d);
-    else if (d < 2.0)
-        coeff = (-4.0 * A + 8.0 * A * d - 5.0 * A * d * d + A * d * d * d);
-    else
-        coeff = 0.0;
-
-    return coeff;
-}
-
 static const char *const var_names[] = {   "W",   "H",   "in",   "on",        NULL };
 enum                                   { VAR_W, VAR_H, VAR_IN, VAR_ON, VAR_VARS_NB };
 
@@ -217,51 +200,6 @@ static int calc_persp_luts(AVFilterContext *ctx, AVFilterLink *inlink)
     return 0;
 }
 
-static int config_input(AVFilterLink *inlink)
-{
-    AVFilterContext *ctx = inlink->dst;
-    PerspectiveContext *s = ctx->priv;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
-    int h = inlink->h;
-    int w = inlink->w;
-    int i, j, ret;
-    s->hsub = desc->log2_chroma_w;
-    s->vsub = desc->log2_chroma_h;
-    s->nb_planes = av_pix_fmt_count_planes(inlink->format);
-    if ((ret = av_image_fill_linesizes(s->linesize, inlink->format, inlink->w)) < 0)
-        return ret;
-
-    s->height[1] = s->height[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
-    s->height[0] = s->height[3] = inlink->h;
-
-    s->pv = av_realloc_f(s->pv, w * h, 2 * sizeof(*s->pv));
-    if (!s->pv)
-        return AVERROR(ENOMEM);
-
-    if (s->eval_mode == EVAL_MODE_INIT) {
-        if ((ret = calc_persp_luts(ctx, inlink)) < 0) {
-            return ret;
-        }
-    }
-
-    for (i = 0; i < SUB_PIXELS; i++){
-        double d = i / (double)SUB_PIXELS;
-        double temp[4];
-        double sum = 0;
-
-        for (j = 0; j < 4; j++)
-            temp[j] = get_coeff(j - d - 1);
-
-        for (j = 0; j < 4; j++)
-            sum += temp[j];
-
-        for (j = 0; j < 4; j++)
-            s->coeff[i][j] = lrint((1 << COEFF_BITS) * temp[j] / sum);
-    }
-
-    return 0;
-}
-
 typedef struct ThreadData {
     uint8_t *dst;
     int dst_linesize;
@@ -269,17 +207,14 @@ typedef struct ThreadData {
     int src_linesize;
     int w, h;
     int hsub, vsub;
+    WarpMap *map;
 } ThreadData;
 
-static int resample_cubic(AVFilterContext *ctx, void *arg,
-                          int job, int nb_jobs)
+static int build_map_slice(AVFilterContext *ctx, void *arg,
+                           int job, int nb_jobs)
 {
     PerspectiveContext *s = ctx->priv;
     ThreadData *td = arg;
-    uint8_t *dst = td->dst;
-    int dst_linesize = td->dst_linesize;
-    uint8_t *src = td->src;
-    int src_linesize = td->src_linesize;
     int w = td->w;
     int h = td->h;
     int hsub = td->hsub;
@@ -287,156 +222,102 @@ static int resample_cubic(AVFilterContext *ctx, void *arg,
     int start = (h * job) / nb_jobs;
     int end   = (h * (job+1)) / nb_jobs;
     const int linesize = s->linesize[0];
-    int x, y;
-
-    for (y = start; y < end; y++) {
-        int sy = y << vsub;
-        for (x = 0; x < w; x++) {
-            int u, v, subU, subV, sum, sx;
-
-            sx   = x << hsub;
-            u    = s->pv[sx + sy * linesize][0] >> hsub;
-            v    = s->pv[sx + sy * linesize][1] >> vsub;
-            subU = u & (SUB_PIXELS - 1);
-            subV = v & (SUB_PIXELS - 1);
-            u  >>= SUB_PIXEL_BITS;
-            v  >>= SUB_PIXEL_BITS;
-
-            if (u > 0 && v > 0 && u < w - 2 && v < h - 2){
-                const int index = u + v*src_linesize;
-                const int a = s->coeff[subU][0];
-                const int b = s->coeff[subU][1];
-                const int c = s->coeff[subU][2];
-                const int d = s->coeff[subU][3];
-
-                sum = s->coeff[subV][0] * (a * src[index - 1 -     src_linesize] + b * src[index - 0 -     src_linesize]  +
-                                      c *      src[index + 1 -     src_linesize] + d * src[index + 2 -     src_linesize]) +
-                      s->coeff[subV][1] * (a * src[index - 1                   ] + b * src[index - 0                   ]  +
-                                      c *      src[index + 1                   ] + d * src[index + 2                   ]) +
-                      s->coeff[subV][2] * (a * src[index - 1 +     src_linesize] + b * src[index - 0 +     src_linesize]  +
-                                      c *      src[index + 1 +     src_linesize] + d * src[index + 2 +     src_linesize]) +
-                      s->coeff[subV][3] * (a * src[index - 1 + 2 * src_linesize] + b * src[index - 0 + 2 * src_linesize]  +
-                                      c *      src[index + 1 + 2 * src_linesize] + d * src[index + 2 + 2 * src_linesize]);
-            } else {
-                int dx, dy;
-
-                sum = 0;
-
-                for (dy = 0; dy < 4; dy++) {
-                    int iy = v + dy - 1;
-
-                    if (iy < 0)
-                        iy = 0;
-                    else if (iy >= h)
-                        iy = h-1;
-                    for (dx = 0; dx < 4; dx++) {
-                        int ix = u + dx - 1;
-
-                        if (ix < 0)
-                            ix = 0;
-                        else if (ix >= w)
-                            ix = w - 1;
-
-                        sum += s->coeff[subU][dx] * s->coeff[subV][dy] * src[ ix + iy * src_linesize];
-                    }
-                }
-            }
-
-            sum = (sum + (1<<(COEFF_BITS * 2 - 1))) >> (COEFF_BITS * 2);
-            sum = av_clip_uint8(sum);
-            dst[x + y * dst_linesize] = sum;
+    const int shift = WARP_SUBPEL_BITS - SUB_PIXEL_BITS;
+    int32_t *pos = s->pos + job * 2 * linesize;
+
+    for (int y = start; y < end; y++) {
+        const int32_t (*pv)[2] = s->pv + (y << vsub) * linesize;
+
+        for (int x = 0; x < w; x++) {
+            pos[2 * x    ] = av_clip(pv[x << hsub][0] >> hsub, -(1 << 24), 1 << 24) << shift;
+            pos[2 * x + 1] = av_clip(pv[x << hsub][1] >> vsub, -(1 << 24), 1 << 24) << shift;
         }
+
+        ff_warp_map_set_row(&s->warp, td->map, y, pos);
     }
     return 0;
 }
 
-static int resample_linear(AVFilterContext *ctx, void *arg,
-                           int job, int nb_jobs)
+static void build_maps(AVFilterContext *ctx)
 {
     PerspectiveContext *s = ctx->priv;
-    ThreadData *td = arg;
-    uint8_t *dst = td->dst;
-    int dst_linesize = td->dst_linesize;
-    uint8_t *src = td->src;
-    int src_linesize = td->src_linesize;
-    int w = td->w;
-    int h = td->h;
-    int hsub = td->hsub;
-    int vsub = td->vsub;
-    int start = (h * job) / nb_jobs;
-    int end   = (h * (job+1)) / nb_jobs;
-    const int linesize = s->linesize[0];
-    int x, y;
 
-    for (y = start; y < end; y++){
-        int sy = y << vsub;
-        for (x = 0; x < w; x++){
-            int u, v, subU, subV, sum, sx, index, subUI, subVI;
-
-            sx   = x << hsub;
-            u    = s->pv[sx + sy * linesize][0] >> hsub;
-            v    = s->pv[sx + sy * linesize][1] >> vsub;
-            subU = u & (SUB_PIXELS - 1);
-            subV = v & (SUB_PIXELS - 1);
-            u  >>= SUB_PIXEL_BITS;
-            v  >>= SUB_PIXEL_BITS;
-
-            index = u + v * src_linesize;
-            subUI = SUB_PIXELS - subU;
-            subVI = SUB_PIXELS - subV;
-
-            if ((unsigned)u < (unsigned)(w - 1)){
-                if((unsigned)v < (unsigned)(h - 1)){
-                    sum = subVI * (subUI * src[index] + subU * src[index + 1]) +
-                          subV  * (subUI * src[index + src_linesize] + subU * src[index + src_linesize + 1]);
-                    sum = (sum + (1 << (SUB_PIXEL_BITS * 2 - 1)))>> (SUB_PIXEL_BITS * 2);
-                } else {
-                    if (v < 0)
-                        v = 0;
-                    else
-                        v = h - 1;
-                    index = u + v * src_linesize;
-                    sum   = subUI * src[index] + subU * src[index + 1];
-                    sum   = (sum + (1 << (SUB_PIXEL_BITS - 1))) >> SUB_PIXEL_BITS;
-                }
-            } else {
-                if (u < 0)
-                    u = 0;
-                else
-                    u = w - 1;
-                if ((unsigned)v < (unsigned)(h - 1)){
-                    index = u + v * src_linesize;
-                    sum   = subVI * src[index] + subV * src[index + src_linesize];
-                    sum   = (sum + (1 << (SUB_PIXEL_BITS - 1))) >> SUB_PIXEL_BITS;
-                } else {
-                    if (v < 0)
-                        v = 0;
-                    else
-                        v = h - 1;
-                    index = u + v * src_linesize;
-                    sum   = src[index];
-                }
-            }
-
-            sum = av_clip_uint8(sum);
-            dst[x + y * dst_linesize] = sum;
-        }
+    for (int plane = 0; plane < s->nb_planes; plane++) {
+        ThreadData td = {.w = s->linesize[plane],
+                         .h = s->height[plane],
+                         .hsub = plane == 1 || plane == 2 ? s->hsub : 0,
+                         .vsub = plane == 1 || plane == 2 ? s->vsub : 0,
+                         .map = &s->map[plane] };
+        ff_filter_execute(ctx, build_map_slice, &td, NULL,
+                          FFMIN(td.h, ff_filter_get_nb_threads(ctx)));
     }
-    return 0;
 }
 
-static av_cold int init(AVFilterContext *ctx)
+static int config_input(AVFilterLink *inlink)
 {
+    AVFilterContext *ctx = inlink->dst;
     PerspectiveContext *s = ctx->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+    int h = inlink->h;
+    int w = inlink->w;
+    int ret;
+
+    if (w > INT16_MAX || h > INT16_MAX) {
+        av_log(ctx, AV_LOG_ERROR, "Input dimensions %dx%d exceed %d.\n",
+               w, h, INT16_MAX);
+        return AVERROR(EINVAL);
+    }
+
+    s->hsub = desc->log2_chroma_w;
+    s->vsub = desc->log2_chroma_h;
+    s->nb_planes = av_pix_fmt_count_planes(inlink->format);
+    if ((ret = av_image_fill_linesizes(s->linesize, inlink->format, inlink->w)) < 0)
+        return ret;
+
+    s->height[1] = s->height[2] = AV_CEIL_RSHIFT(inlink->h, desc->log2_chroma_h);
+    s->height[0] = s->height[3] = inlink->h;
+
+    s->pv = av_realloc_f(s->pv, w * h, 2 * sizeof(*s->pv));
+    if (!s->pv)
+        return AVERROR(ENOMEM);
+
+    ff_warp_init(&s->warp, s->interpolation == CUBIC ? WARP_BICUBIC : WARP_BILINEAR, 8);
+    for (int plane = 0; plane < s->nb_planes; plane++) {
+        ret = ff_warp_map_alloc(&s->warp, &s->map[plane], s->linesize[plane], s->height[plane],
+                                s->linesize[plane], s->height[plane]);
+        if (ret < 0)
+            return ret;
+    }
+
+    av_freep(&s->pos);
+    s->pos = av_malloc_array(ff_filter_get_nb_threads(ctx), 2 * w * sizeof(*s->pos));
+    if (!s->pos)
+        return AVERROR(ENOMEM);
 
-    switch (s->interpolation) {
-    case LINEAR: s->perspective = resample_linear; break;
-    case CUBIC:  s->perspective = resample_cubic;  break;
+    if (s->eval_mode == EVAL_MODE_INIT) {
+        if ((ret = calc_persp_luts(ctx, inlink)) < 0) {
+            return ret;
+        }
+        build_maps(ctx);
     }
 
     return 0;
 }
 
+static int resample(AVFilterContext *ctx, void *arg,
+                    int job, int nb_jobs)
+{
+    PerspectiveContext *s = ctx->priv;
+    ThreadData *td = arg;
+    int start = (td->h * job) / nb_jobs;
+    int end   = (td->h * (job+1)) / nb_jobs;
+
+    for (int y = start; y < end; y++)
+        ff_warp_map_apply_row(&s->warp, td->map, y, td->dst + y * td->dst_linesize,
+                              td->src, td->src_linesize, 0);
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
     AVFilterContext *ctx = inlink->dst;
@@ -458,6 +339,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
             av_frame_free(&out);
             return ret;
         }
+        build_maps(ctx);
     }
 
     for (plane = 0; plane < s->nb_planes; plane++) {
@@ -470,8 +352,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
                          .w = s->linesize[plane],
                          .h = s->height[plane],
                          .hsub = hsub,
-                         .vsub = vsub };
-        ff_filter_execute(ctx, s->perspective, &td, NULL,
+                         .vsub = vsub,
+                         .map = &s->map[plane] };
+        ff_filter_execute(ctx, resample, &td, NULL,
                           FFMIN(td.h, ff_filter_get_nb_threads(ctx)));
     }
 
@@ -484,6 +367,9 @@ static av_cold void uninit(AVFilterContext *ctx)
     PerspectiveContext *s = ctx->priv;
 
     av_freep(&s->pv);
+    for (int i = 0; i < FF_ARRAY_ELEMS(s->map); i++)
+        ff_warp_map_free(&s->map[i]);
+    av_freep(&s->pos);
 }
 
 static const AVFilterPad perspective_inputs[] = {
@@ -506,7 +392,6 @@ const AVFilter ff_vf_perspective = {
     .name          = "perspective",
     .description   = NULL_IF_CONFIG_SMALL("Correct the perspective of video."),
     .priv_size     = sizeof(PerspectiveContext),
-    .init          = init,
     .uninit        = uninit,
     FILTER_INPUTS(perspective_inputs),
     FILTER_OUTPUTS(perspective_outputs),
@@ -0,0 +1,708 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Video quality control analysis gathering the statistics of the
+ * signalstats, cropdetect, blackdetect, freezedetect, idet and scdet
+ * filters in a single pass over each frame.
+ *
+ * Every row of the frame is loaded once and all enabled statistics are
+ * computed while it is in cache. The frame metadata is the same as the one
+ * set by the individual filters with equivalent options.
+ */
+
+#include <float.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/timestamp.h"
+#include "avfilter.h"
+#include "internal.h"
+#include "scene_sad.h"
+#include "video.h"
+#include "vf_cropdetect.h"
+#include "vf_idet.h"
+#include "vf_signalstats.h"
+
+enum QCMetric {
+    METRIC_SIGNALSTATS,
+    METRIC_CROPDETECT,
+    METRIC_BLACKDETECT,
+    METRIC_FREEZEDETECT,
+    METRIC_IDET,
+    METRIC_SCDET,
+};
+
+#define METRIC(x) (1 << METRIC_##x)
+
+/**
+ * Statistics gathered by one slice job.
+ */
+typedef struct QCSliceStats {
+    uint64_t freeze_sad;        ///< differences to the freezedetect reference
+    uint64_t tail_dif;          ///< chroma differences of rows ignored by freezedetect
+    IDETSliceSums idet;
+} QCSliceStats;
+
+typedef struct QCStatsContext {
+    const AVClass *class;
+    int metrics;
+
+    /* cropdetect */
+    float crop_limit;
+    int crop_round;
+    int crop_reset;
+    int crop_skip;
+    int crop_max_outliers;
+    int x1, y1, x2, y2;
+    int crop_frame_nb;
+
+    /* blackdetect */
+    double black_min_duration_time;
+    double picture_black_ratio_th;
+    double pixel_black_th;
+    int64_t black_min_duration;
+    int64_t black_start;
+    int64_t black_end;
+    int64_t last_picref_pts;
+    int black_started;
+
+    /* freezedetect */
+    double freeze_noise;
+    int64_t freeze_duration;
+    AVFrame *freeze_ref;
+    int freeze_ref_is_prev;     ///< the reference is the previous frame
+    int64_t freeze_n;
+    int64_t freeze_ref_n;
+    int frozen;
+
+    /* idet, only the thresholds, statistics and line function are used */
+    IDETContext idet;
+
+    /* scdet */
+    double sc_threshold;
+    double prev_mafd;
+
+    int depth;
+    int hsub, vsub;
+    int chromaw, chromah;
+    int fs, cfs;                ///< pixel count of the luma and chroma planes
+    int maxsize;                ///< histogram size
+    ff_scene_sad_fn sad;
+
+    AVFrame *prev, *cur, *next;
+    int64_t nb_frames;
+    int eof;
+
+    int nb_threads;
+    QCSliceStats *slice_stats;
+    SignalstatsHist *hists;     ///< histograms and differences to the previous frame of each job
+    unsigned *hist_buf;
+} QCStatsContext;
+
+#define OFFSET(x) offsetof(QCStatsContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
+
+static const AVOption qcstats_options[] = {
+    { "metrics", "set the statistics to compute", OFFSET(metrics), AV_OPT_TYPE_FLAGS, {.i64=0x3f}, 0, 0x3f, FLAGS, "metrics" },
+        { "signalstats",  NULL, 0, AV_OPT_TYPE_CONST, {.i64=METRIC(SIGNALSTATS)},  0, 0, FLAGS, "metrics" },
+        { "cropdetect",   NULL, 0, AV_OPT_TYPE_CONST, {.i64=METRIC(CROPDETECT)},   0, 0, FLAGS, "metrics" },
+        { "blackdetect",  NULL, 0, AV_OPT_TYPE_CONST, {.i64=METRIC(BLACKDETECT)},  0, 0, FLAGS, "metrics" },
+        { "freezedetect", NULL, 0, AV_OPT_TYPE_CONST, {.i64=METRIC(FREEZEDETECT)}, 0, 0, FLAGS, "metrics" },
+        { "idet",         NULL, 0, AV_OPT_TYPE_CONST, {.i64=METRIC(IDET)},         0, 0, FLAGS, "metrics" },
+        { "scdet",        NULL, 0, AV_OPT_TYPE_CONST, {.i64=METRIC(SCDET)},        0, 0, FLAGS, "metrics" },
+    { "crop_limit",        "set the cropdetect black threshold",           OFFSET(crop_limit),              AV_OPT_TYPE_FLOAT,    {.dbl=24.0/255}, 0, 65535, FLAGS },
+    { "crop_round",        "set the cropdetect size divisor",              OFFSET(crop_round),              AV_OPT_TYPE_INT,      {.i64=16},       0, INT_MAX, FLAGS },
+    { "crop_reset",        "recalculate the crop area after this many frames", OFFSET(crop_reset),          AV_OPT_TYPE_INT,      {.i64=0},        0, INT_MAX, FLAGS },
+    { "crop_skip",         "set the number of initial frames cropdetect skips", OFFSET(crop_skip),          AV_OPT_TYPE_INT,      {.i64=2},        0, INT_MAX, FLAGS },
+    { "crop_max_outliers", "set the cropdetect threshold count of outliers", OFFSET(crop_max_outliers),     AV_OPT_TYPE_INT,      {.i64=0},        0, INT_MAX, FLAGS },
+    { "black_duration",    "set the minimum detected black duration in seconds", OFFSET(black_min_duration_time), AV_OPT_TYPE_DOUBLE, {.dbl=2}, 0, DBL_MAX, FLAGS },
+    { "black_pic_th",      "set the picture black ratio threshold",        OFFSET(picture_black_ratio_th),  AV_OPT_TYPE_DOUBLE,   {.dbl=.98},      0, 1, FLAGS },
+    { "black_pix_th",      "set the pixel black threshold",                OFFSET(pixel_black_th),          AV_OPT_TYPE_DOUBLE,   {.dbl=.10},      0, 1, FLAGS },
+    { "freeze_noise",      "set the freezedetect noise tolerance",         OFFSET(freeze_noise),            AV_OPT_TYPE_DOUBLE,   {.dbl=0.001},    0, 1.0, FLAGS },
+    { "freeze_duration",   "set the minimum freeze duration in seconds",   OFFSET(freeze_duration),         AV_OPT_TYPE_DURATION, {.i64=2000000},  0, INT64_MAX, FLAGS },
+    { "intl_thres",        "set the idet interlacing threshold",           OFFSET(idet.interlace_threshold),     AV_OPT_TYPE_FLOAT,    {.dbl=1.04},     -1, FLT_MAX, FLAGS },
+    { "prog_thres",        "set the idet progressive threshold",           OFFSET(idet.progressive_threshold),   AV_OPT_TYPE_FLOAT,    {.dbl=1.5},      -1, FLT_MAX, FLAGS },
+    { "rep_thres",         "set the idet repeat threshold",                OFFSET(idet.repeat_threshold),        AV_OPT_TYPE_FLOAT,    {.dbl=3.0},      -1, FLT_MAX, FLAGS },
+    { "half_life",         "set the half life of the idet statistics",     OFFSET(idet.half_life),               AV_OPT_TYPE_FLOAT,    {.dbl=0.0},      -1, INT_MAX, FLAGS },
+    { "sc_threshold",      "set the scene change detection threshold",     OFFSET(sc_threshold),            AV_OPT_TYPE_DOUBLE,   {.dbl=10.},      0, 100., FLAGS },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(qcstats);
+
+static const enum AVPixelFormat pix_fmts[] = {
+    AV_PIX_FMT_YUV444P, AV_PIX_FMT_YUV422P, AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV411P,
+    AV_PIX_FMT_YUV440P,
+    AV_PIX_FMT_YUVJ422P, AV_PIX_FMT_YUVJ444P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ411P,
+    AV_PIX_FMT_YUVJ440P,
+    AV_PIX_FMT_YUV444P9, AV_PIX_FMT_YUV422P9, AV_PIX_FMT_YUV420P9,
+    AV_PIX_FMT_YUV444P10, AV_PIX_FMT_YUV422P10, AV_PIX_FMT_YUV420P10,
+    AV_PIX_FMT_YUV440P10,
+    AV_PIX_FMT_YUV444P12, AV_PIX_FMT_YUV422P12, AV_PIX_FMT_YUV420P12,
+    AV_PIX_FMT_YUV440P12,
+    AV_PIX_FMT_YUV444P14, AV_PIX_FMT_YUV422P14, AV_PIX_FMT_YUV420P14,
+    AV_PIX_FMT_YUV444P16, AV_PIX_FMT_YUV422P16, AV_PIX_FMT_YUV420P16,
+    AV_PIX_FMT_NONE
+};
+
+static const enum AVPixelFormat yuvj_formats[] = {
+    AV_PIX_FMT_YUVJ411P, AV_PIX_FMT_YUVJ420P, AV_PIX_FMT_YUVJ422P, AV_PIX_FMT_YUVJ444P, AV_PIX_FMT_YUVJ440P,
+    AV_PIX_FMT_NONE
+};
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    QCStatsContext *s = ctx->priv;
+
+    s->crop_frame_nb = -1 * s->crop_skip;
+
+    ff_idet_init_history(&s->idet);
+
+    return 0;
+}
+
+static int config_input(AVFilterLink *inlink)
+{
+    AVFilterContext *ctx = inlink->dst;
+    QCStatsContext *s = ctx->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+
+    s->depth   = desc->comp[0].depth;
+    s->hsub    = desc->log2_chroma_w;
+    s->vsub    = desc->log2_chroma_h;
+    s->maxsize = 1 << s->depth;
+    s->chromaw = AV_CEIL_RSHIFT(inlink->w, s->hsub);
+    s->chromah = AV_CEIL_RSHIFT(inlink->h, s->vsub);
+    s->fs      = inlink->w * inlink->h;
+    s->cfs     = s->chromaw * s->chromah;
+
+    s->x1 = inlink->w - 1;
+    s->y1 = inlink->h - 1;
+    s->x2 = 0;
+    s->y2 = 0;
+
+    s->black_min_duration = s->black_min_duration_time / av_q2d(inlink->time_base);
+
+    s->sad = ff_scene_sad_get_fn(s->depth == 8 ? 8 : 16);
+    if (!s->sad)
+        return AVERROR(EINVAL);
+
+    ff_idet_init(&s->idet, s->depth > 8);
+
+    s->nb_threads = ff_filter_get_nb_threads(ctx);
+    av_freep(&s->slice_stats);
+    av_freep(&s->hists);
+    av_freep(&s->hist_buf);
+    s->slice_stats = av_calloc(s->nb_threads, sizeof(*s->slice_stats));
+    s->hists       = av_calloc(s->nb_threads, sizeof(*s->hists));
+    s->hist_buf    = av_calloc(s->nb_threads, 4 * s->maxsize * sizeof(*s->hist_buf));
+    if (!s->slice_stats || !s->hists || !s->hist_buf)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < s->nb_threads; i++) {
+        unsigned *hist = s->hist_buf + 4 * s->maxsize * i;
+
+        s->hists[i].histy   = hist;
+        s->hists[i].histu   = hist + s->maxsize;
+        s->hists[i].histv   = hist + s->maxsize * 2;
+        s->hists[i].histsat = hist + s->maxsize * 3;
+    }
+
+    return 0;
+}
+
+typedef struct ThreadData {
+    AVFrame *cur, *prev, *next;
+    AVFrame *ref;               ///< freezedetect reference if it is not prev
+} ThreadData;
+
+static void idet_row(QCStatsContext *s, QCSliceStats *st, ThreadData *td,
+                     int plane, int y, int w)
+{
+    const int refs = td->cur->linesize[plane];
+
+    ff_idet_filter_row(&st->idet, s->idet.filter_line,
+                       td->prev->data[plane] + y * refs,
+                       td->cur ->data[plane] + y * refs,
+                       td->next->data[plane] + y * refs, refs, y, w);
+}
+
+static int stats_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    QCStatsContext *s = ctx->priv;
+    ThreadData *td = arg;
+    QCSliceStats *st = &s->slice_stats[jobnr];
+    SignalstatsHist *hs = &s->hists[jobnr];
+    const AVFrame *cur = td->cur, *prev = td->prev, *ref = td->ref;
+    const int w = cur->width, h = cur->height, cw = s->chromaw;
+    const int hist  = s->metrics & (METRIC(SIGNALSTATS) | METRIC(BLACKDETECT));
+    const int stats = s->metrics & METRIC(SIGNALSTATS);
+    const int dif   = s->metrics & (METRIC(SIGNALSTATS) | METRIC(FREEZEDETECT) | METRIC(SCDET));
+    const int cdif  = s->metrics & (METRIC(SIGNALSTATS) | METRIC(FREEZEDETECT));
+    const int idet  = s->metrics & METRIC(IDET);
+    const int freeze_h = h >> s->vsub;
+    const int mid = 1 << (s->depth - 1);
+    const int slice_start  = (h *  jobnr     ) / nb_jobs;
+    const int slice_end    = (h * (jobnr + 1)) / nb_jobs;
+    const int cslice_start = (s->chromah *  jobnr     ) / nb_jobs;
+    const int cslice_end   = (s->chromah * (jobnr + 1)) / nb_jobs;
+    uint64_t sad;
+
+    memset(&st->idet, 0, sizeof(st->idet));
+    st->freeze_sad = st->tail_dif = 0;
+    if (hist)
+        ff_signalstats_hist_reset(hs, s->maxsize, stats);
+    else
+        hs->dify = hs->difu = hs->difv = 0;
+
+    /* every row is loaded once for all the metrics enabled */
+    for (int y = slice_start; y < slice_end; y++) {
+        const uint8_t *src  = cur ->data[0] + y * cur ->linesize[0];
+        const uint8_t *psrc = prev->data[0] + y * prev->linesize[0];
+
+        if (hist) {
+            if (s->depth > 8)
+                ff_signalstats_luma_line16(hs, src, psrc, w);
+            else
+                ff_signalstats_luma_line8 (hs, src, psrc, w);
+        } else if (dif) {
+            s->sad(src, 0, psrc, 0, w, 1, &sad);
+            hs->dify += sad;
+        }
+        if (ref) {
+            s->sad(src, 0, ref->data[0] + y * ref->linesize[0], 0, w, 1, &sad);
+            st->freeze_sad += sad;
+        }
+        if (idet && y >= 2 && y < h - 2)
+            idet_row(s, st, td, 0, y, w);
+    }
+
+    for (int y = cslice_start; y < cslice_end; y++) {
+        const uint8_t *srcu  = cur ->data[1] + y * cur ->linesize[1];
+        const uint8_t *srcv  = cur ->data[2] + y * cur ->linesize[2];
+        const uint8_t *psrcu = prev->data[1] + y * prev->linesize[1];
+        const uint8_t *psrcv = prev->data[2] + y * prev->linesize[2];
+        const uint64_t difu = hs->difu, difv = hs->difv;
+
+        if (stats) {
+            if (s->depth > 8)
+                ff_signalstats_chroma_line16(hs, srcu, srcv, psrcu, psrcv, cw, mid);
+            else
+                ff_signalstats_chroma_line8 (hs, srcu, srcv, psrcu, psrcv, cw, mid);
+        } else if (cdif) {
+            s->sad(srcu, 0, psrcu, 0, cw, 1, &sad);
+            hs->difu += sad;
+            s->sad(srcv, 0, psrcv, 0, cw, 1, &sad);
+            hs->difv += sad;
+        }
+        if (y >= freeze_h) {
+            st->tail_dif += hs->difu - difu + hs->difv - difv;
+        } else if (ref) {
+            s->sad(srcu, 0, ref->data[1] + y * ref->linesize[1], 0, cw, 1, &sad);
+            st->freeze_sad += sad;
+            s->sad(srcv, 0, ref->data[2] + y * ref->linesize[2], 0, cw, 1, &sad);
+            st->freeze_sad += sad;
+        }
+        if (idet && y >= 2 && y < s->chromah - 2) {
+            idet_row(s, st, td, 1, y, cw);
+            idet_row(s, st, td, 2, y, cw);
+        }
+    }
+
+    emms_c();
+    return 0;
+}
+
+static void set_meta(AVFrame *frame, const char *key, const char *fmt, ...)
+{
+    char buf[128];
+    va_list vl;
+
+    va_start(vl, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, vl);
+    va_end(vl);
+    av_dict_set(&frame->metadata, key, buf, 0);
+}
+
+/**
+ * Scan the luma lines from the border inwards. Only the lines up to the
+ * first non-black ones are read, so this is left out of the frame sweep.
+ */
+static void find_border(QCStatsContext *s, const AVFrame *frame, int *dst,
+                        int from, int end, int inc, int columns, int limit)
+{
+    const int bpp = 1 + (s->depth > 8);
+    const ptrdiff_t linesize = frame->linesize[0];
+    int outliers = 0, last_y = from;
+
+    for (int y = from; inc > 0 ? y < end : y > end; y += inc) {
+        const uint8_t *src = frame->data[0] + (columns ? y * bpp : y * linesize);
+        const ptrdiff_t stride = columns ? linesize : bpp;
+        const int len = columns ? frame->height : frame->width;
+        const int total = ff_cropdetect_checkline(src, stride, len, bpp);
+
+        if (total > limit) {
+            if (++outliers > s->crop_max_outliers) {
+                *dst = last_y;
+                return;
+            }
+        } else
+            last_y = y + inc;
+    }
+}
+
+static void cropdetect_metadata(AVFilterContext *ctx, AVFrame *frame)
+{
+    QCStatsContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    const int limit = lrint(s->crop_limit < 1.0 ? s->crop_limit * ((1 << s->depth) - 1)
+                                                : s->crop_limit);
+
+    if (s->crop_reset > 0 && s->crop_frame_nb > s->crop_reset) {
+        s->x1 = frame->width  - 1;
+        s->y1 = frame->height - 1;
+        s->x2 = 0;
+        s->y2 = 0;
+        s->crop_frame_nb = 1;
+    }
+
+    find_border(s, frame, &s->y1,                 0,               s->y1, +1, 0, limit);
+    find_border(s, frame, &s->y2, frame->height - 1, FFMAX(s->y2, s->y1), -1, 0, limit);
+    find_border(s, frame, &s->x1,                 0,               s->x1, +1, 1, limit);
+    find_border(s, frame, &s->x2,  frame->width - 1, FFMAX(s->x2, s->x1), -1, 1, limit);
+
+    ff_cropdetect_set_metadata(ctx, frame, inlink->time_base,
+                               s->x1, s->x2, s->y1, s->y2, &s->crop_round, s->crop_limit);
+}
+
+static void check_black_end(AVFilterContext *ctx)
+{
+    QCStatsContext *s = ctx->priv;
+    AVRational tb = ctx->inputs[0]->time_base;
+
+    if ((s->black_end - s->black_start) >= s->black_min_duration) {
+        av_log(ctx, AV_LOG_INFO,
+               "black_start:%s black_end:%s black_duration:%s\n",
+               av_ts2timestr(s->black_start, &tb),
+               av_ts2timestr(s->black_end,   &tb),
+               av_ts2timestr(s->black_end - s->black_start, &tb));
+    }
+}
+
+static void blackdetect_metadata(AVFilterContext *ctx, AVFrame *frame, int nb_jobs)
+{
+    QCStatsContext *s = ctx->priv;
+    AVRational tb = ctx->inputs[0]->time_base;
+    const int max = (1 << s->depth) - 1;
+    const int factor = (1 << (s->depth - 8));
+    const int full = frame->color_range == AVCOL_RANGE_JPEG ||
+                     ff_fmt_is_in(frame->format, yuvj_formats);
+    const unsigned int threshold = full ? s->pixel_black_th * max :
+        16 * factor + s->pixel_black_th * (235 - 16) * factor;
+    uint64_t nb_black_pixels = 0;
+    double picture_black_ratio;
+
+    for (int i = 0; i < nb_jobs; i++) {
+        const unsigned *histy = s->hists[i].histy;
+        for (unsigned j = 0; j <= FFMIN(threshold, max); j++)
+            nb_black_pixels += histy[j];
+    }
+
+    picture_black_ratio = (double)nb_black_pixels / s->fs;
+
+    if (picture_black_ratio >= s->picture_black_ratio_th) {
+        if (!s->black_started) {
+            s->black_started = 1;
+            s->black_start = frame->pts;
+            av_dict_set(&frame->metadata, "lavfi.black_start",
+                        av_ts2timestr(s->black_start, &tb), 0);
+        }
+    } else if (s->black_started) {
+        s->black_started = 0;
+        s->black_end = frame->pts;
+        check_black_end(ctx);
+        av_dict_set(&frame->metadata, "lavfi.black_end",
+                    av_ts2timestr(s->black_end, &tb), 0);
+    }
+
+    s->last_picref_pts = frame->pts;
+}
+
+static int freezedetect_metadata(AVFilterContext *ctx, AVFrame *frame, int nb_jobs)
+{
+    QCStatsContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    int frozen = 0;
+
+    s->freeze_n++;
+
+    if (s->freeze_ref) {
+        const uint64_t count = s->fs + 2 * (uint64_t)s->chromaw * (frame->height >> s->vsub);
+        uint64_t sad = 0;
+        int64_t duration;
+
+        for (int i = 0; i < nb_jobs; i++) {
+            const QCSliceStats *st = &s->slice_stats[i];
+            const SignalstatsHist *hs = &s->hists[i];
+            sad += s->freeze_ref_is_prev ? hs->dify + hs->difu + hs->difv - st->tail_dif
+                                         : st->freeze_sad;
+        }
+
+        if (s->freeze_ref->pts == AV_NOPTS_VALUE || frame->pts == AV_NOPTS_VALUE || frame->pts < s->freeze_ref->pts)
+            duration = inlink->frame_rate.num > 0 ? av_rescale_q(s->freeze_n - s->freeze_ref_n, av_inv_q(inlink->frame_rate), AV_TIME_BASE_Q) : 0;
+        else
+            duration = av_rescale_q(frame->pts - s->freeze_ref->pts, inlink->time_base, AV_TIME_BASE_Q);
+
+        frozen = (double)sad / count / (1ULL << s->depth) <= s->freeze_noise;
+        if (duration >= s->freeze_duration) {
+            if (!s->frozen) {
+                const char *start = av_ts2timestr(s->freeze_ref->pts, &inlink->time_base);
+                av_log(ctx, AV_LOG_INFO, "lavfi.freezedetect.freeze_start: %s\n", start);
+                av_dict_set(&frame->metadata, "lavfi.freezedetect.freeze_start", start, 0);
+            }
+            if (!frozen) {
+                const char *dur = av_ts2timestr(duration, &AV_TIME_BASE_Q);
+                av_log(ctx, AV_LOG_INFO, "lavfi.freezedetect.freeze_duration: %s\n", dur);
+                av_dict_set(&frame->metadata, "lavfi.freezedetect.freeze_duration", dur, 0);
+                dur = av_ts2timestr(frame->pts, &inlink->time_base);
+                av_log(ctx, AV_LOG_INFO, "lavfi.freezedetect.freeze_end: %s\n", dur);
+                av_dict_set(&frame->metadata, "lavfi.freezedetect.freeze_end", dur, 0);
+            }
+            s->frozen = frozen;
+        }
+    }
+
+    s->freeze_ref_is_prev = 0;
+    if (!frozen) {
+        av_frame_free(&s->freeze_ref);
+        s->freeze_ref = av_frame_clone(frame);
+        if (!s->freeze_ref)
+            return AVERROR(ENOMEM);
+        s->freeze_ref_n = s->freeze_n;
+        s->freeze_ref_is_prev = 1;
+    }
+
+    return 0;
+}
+
+static void idet_metadata(AVFilterContext *ctx, AVFrame *cur, int nb_jobs)
+{
+    QCStatsContext *s = ctx->priv;
+    IDETSliceSums sums = { { 0 } };
+
+    for (int i = 0; i < nb_jobs; i++) {
+        const IDETSliceSums *st = &s->slice_stats[i].idet;
+        sums.alpha[0] += st->alpha[0];
+        sums.alpha[1] += st->alpha[1];
+        sums.delta    += st->delta;
+        sums.gamma[0] += st->gamma[0];
+        sums.gamma[1] += st->gamma[1];
+    }
+
+    ff_idet_classify(&s->idet, ctx, cur, &sums);
+}
+
+static void scdet_metadata(AVFilterContext *ctx, AVFrame *frame, int nb_jobs)
+{
+    QCStatsContext *s = ctx->priv;
+    AVRational tb = ctx->inputs[0]->time_base;
+    double score = 0;
+
+    if (s->nb_frames) {
+        uint64_t sad = 0;
+
+        for (int i = 0; i < nb_jobs; i++)
+            sad += s->hists[i].dify;
+        score = ff_scene_sad_score(sad, s->fs, s->depth, &s->prev_mafd);
+    }
+
+    set_meta(frame, "lavfi.scd.mafd",  "%0.3f", s->prev_mafd);
+    set_meta(frame, "lavfi.scd.score", "%0.3f", score);
+    if (score >= s->sc_threshold) {
+        av_log(ctx, AV_LOG_INFO, "lavfi.scd.score: %.3f, lavfi.scd.time: %s\n",
+               score, av_ts2timestr(frame->pts, &tb));
+        av_dict_set(&frame->metadata, "lavfi.scd.time", av_ts2timestr(frame->pts, &tb), 0);
+    }
+}
+
+/**
+ * Compute the statistics of cur and set its metadata.
+ *
+ * @param prev the previous frame, or a frame identical to cur for the first one
+ * @param next the next frame if idet is enabled
+ */
+static int analyze(AVFilterContext *ctx, AVFrame *cur, AVFrame *prev, AVFrame *next)
+{
+    QCStatsContext *s = ctx->priv;
+    const int nb_jobs = FFMAX(1, FFMIN(s->chromah, s->nb_threads));
+    ThreadData td = {
+        .cur  = cur,
+        .prev = prev,
+        .next = next,
+        .ref  = s->metrics & METRIC(FREEZEDETECT) && s->freeze_ref &&
+                !s->freeze_ref_is_prev ? s->freeze_ref : NULL,
+    };
+    int ret;
+
+    if (s->metrics & METRIC(CROPDETECT))
+        s->crop_frame_nb++;
+
+    ff_filter_execute(ctx, stats_slice, &td, NULL, nb_jobs);
+
+    if (s->metrics & METRIC(BLACKDETECT))
+        blackdetect_metadata(ctx, cur, nb_jobs);
+    if (s->metrics & METRIC(FREEZEDETECT)) {
+        ret = freezedetect_metadata(ctx, cur, nb_jobs);
+        if (ret < 0)
+            return ret;
+    }
+    if (s->metrics & METRIC(IDET))
+        idet_metadata(ctx, cur, nb_jobs);
+    if (s->metrics & METRIC(SCDET))
+        scdet_metadata(ctx, cur, nb_jobs);
+    if (s->metrics & METRIC(CROPDETECT) && s->crop_frame_nb > 0)
+        cropdetect_metadata(ctx, cur);
+    /* merges the histograms in place, keep it last */
+    if (s->metrics & METRIC(SIGNALSTATS))
+        ff_signalstats_set_metadata(&cur->metadata, s->hists, nb_jobs,
+                                    s->maxsize, s->fs, s->cfs);
+
+    s->nb_frames++;
+    return 0;
+}
+
+static int filter_frame(AVFilterLink *inlink, AVFrame *in)
+{
+    AVFilterContext *ctx = inlink->dst;
+    AVFilterLink *outlink = ctx->outputs[0];
+    QCStatsContext *s = ctx->priv;
+    AVFrame *out;
+    int ret;
+
+    if (!(s->metrics & METRIC(IDET))) {
+        ret = analyze(ctx, in, s->prev ? s->prev : in, NULL);
+        av_frame_free(&s->prev);
+        if (ret >= 0 && !(s->prev = av_frame_clone(in)))
+            ret = AVERROR(ENOMEM);
+        if (ret < 0) {
+            av_frame_free(&in);
+            return ret;
+        }
+        return ff_filter_frame(outlink, in);
+    }
+
+    /* idet needs the next frame, delay the output by one frame */
+    av_frame_free(&s->prev);
+    s->prev = s->cur;
+    s->cur  = s->next;
+    s->next = in;
+
+    if (!s->cur && !(s->cur = av_frame_clone(s->next)))
+        return AVERROR(ENOMEM);
+    if (!s->prev)
+        return 0;
+
+    ret = analyze(ctx, s->cur, s->prev, s->next);
+    if (ret < 0)
+        return ret;
+
+    out = av_frame_clone(s->cur);
+    if (!out)
+        return AVERROR(ENOMEM);
+
+    return ff_filter_frame(outlink, out);
+}
+
+static int request_frame(AVFilterLink *link)
+{
+    AVFilterContext *ctx = link->src;
+    QCStatsContext *s = ctx->priv;
+    int ret;
+
+    if (s->eof)
+        return AVERROR_EOF;
+
+    ret = ff_request_frame(ctx->inputs[0]);
+
+    if (ret == AVERROR_EOF && s->cur && s->metrics & METRIC(IDET)) {
+        AVFrame *next = av_frame_clone(s->next);
+
+        if (!next)
+            return AVERROR(ENOMEM);
+
+        ret = filter_frame(ctx->inputs[0], next);
+        s->eof = 1;
+    }
+
+    return ret;
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    QCStatsContext *s = ctx->priv;
+
+    if (s->metrics & METRIC(IDET) && s->idet.total_prestat[0] + s->idet.total_prestat[1] +
+                                     s->idet.total_prestat[2] + s->idet.total_prestat[3])
+        ff_idet_log_totals(&s->idet, ctx);
+
+    if (s->metrics & METRIC(BLACKDETECT) && s->black_started) {
+        s->black_end = s->last_picref_pts;
+        check_black_end(ctx);
+    }
+
+    av_frame_free(&s->prev);
+    av_frame_free(&s->cur);
+    av_frame_free(&s->next);
+    av_frame_free(&s->freeze_ref);
+    av_freep(&s->slice_stats);
+    av_freep(&s->hists);
+    av_freep(&s->hist_buf);
+}
+
+static const AVFilterPad qcstats_inputs[] = {
+    {
+        .name         = "default",
+        .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_input,
+        .filter_frame = filter_frame,
+    },
+};
+
+static const AVFilterPad qcstats_outputs[] = {
+    {
+        .name          = "default",
+        .type          = AVMEDIA_TYPE_VIDEO,
+        .request_frame = request_frame,
+    },
+};
+
+const AVFilter ff_vf_qcstats = {
+    .name          = "qcstats",
+    .description   = NULL_IF_CONFIG_SMALL("Compute quality control statistics of the video in a single pass."),
+    .priv_size     = sizeof(QCStatsContext),
+    .priv_class    = &qcstats_class,
+    .init          = init,
+    .uninit        = uninit,
+    FILTER_INPUTS(qcstats_inputs),
+    FILTER_OUTPUTS(qcstats_outputs),
+    FILTER_PIXFMTS_ARRAY(pix_fmts),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS | AVFILTER_FLAG_METADATA_ONLY,
+};
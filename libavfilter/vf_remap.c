@@ -46,6 +46,7 @@
 #include "framesync.h"
 #include "internal.h"
 #include "video.h"
+#include "warp.h"
 
 typedef struct RemapContext {
     const AVClass *class;
@@ -56,6 +57,12 @@ typedef struct RemapContext {
     int step;
     uint8_t fill_rgba[4];
     int fill_color[4];
+    int depth;
+
+    WarpContext warp;
+    WarpMap *line_maps;                     ///< one row map per thread
+    int nb_line_maps;
+    int32_t *pos;
 
     FFFrameSync fs;
 
@@ -176,6 +183,51 @@ static int remap_planar##bits##_##name##_slice(AVFilterContext *ctx, void *arg,
 DEFINE_REMAP_PLANAR_FUNC(nearest, 8, 1)
 DEFINE_REMAP_PLANAR_FUNC(nearest, 16, 2)
 
+/**
+ * Same as remap_planar, using the warp engine for the pixel fetch.
+ * Needs source planes with dimensions fitting into int16_t.
+ */
+static int remap_planar_warp_slice(AVFilterContext *ctx, void *arg,
+                                   int jobnr, int nb_jobs)
+{
+    RemapContext *s = ctx->priv;
+    const ThreadData *td = arg;
+    const AVFrame *in  = td->in;
+    const AVFrame *xin = td->xin;
+    const AVFrame *yin = td->yin;
+    const AVFrame *out = td->out;
+    const int slice_start = (out->height *  jobnr   ) / nb_jobs;
+    const int slice_end   = (out->height * (jobnr+1)) / nb_jobs;
+    const int xlinesize = xin->linesize[0] / 2;
+    const int ylinesize = yin->linesize[0] / 2;
+    int32_t *pos = s->pos + jobnr * 2 * out->width;
+    WarpMap *map = &s->line_maps[jobnr];
+
+    for (int y = slice_start; y < slice_end; y++) {
+        const uint16_t *xmap = (const uint16_t *)xin->data[0] + y * xlinesize;
+        const uint16_t *ymap = (const uint16_t *)yin->data[0] + y * ylinesize;
+
+        for (int x = 0; x < out->width; x++) {
+            if (ymap[x] < in->height && xmap[x] < in->width) {
+                pos[2 * x    ] = xmap[x] << WARP_SUBPEL_BITS;
+                pos[2 * x + 1] = ymap[x] << WARP_SUBPEL_BITS;
+            } else {
+                pos[2 * x    ] = WARP_INVALID;
+                pos[2 * x + 1] = 0;
+            }
+        }
+
+        ff_warp_map_set_row(&s->warp, map, 0, pos);
+        for (int plane = 0; plane < td->nb_planes; plane++)
+            ff_warp_map_apply_row(&s->warp, map, 0,
+                                  out->data[plane] + y * out->linesize[plane],
+                                  in->data[plane], in->linesize[plane],
+                                  s->fill_color[plane]);
+    }
+
+    return 0;
+}
+
 /**
  * remap_packed algorithm expects pixels with both padded bits (step) and
  * number of components correctly set.
@@ -239,6 +291,7 @@ static int config_input(AVFilterLink *inlink)
     ff_fill_rgba_map(rgba_map, inlink->format);
     s->nb_planes = av_pix_fmt_count_planes(inlink->format);
     s->nb_components = desc->nb_components;
+    s->depth = depth;
 
     if (is_rgb) {
         s->fill_color[rgba_map[0]] = s->fill_rgba[0] * factor;
@@ -266,6 +319,10 @@ static int config_input(AVFilterLink *inlink)
         }
     }
 
+    if ((s->nb_planes > 1 || s->nb_components == 1) &&
+        inlink->w <= INT16_MAX && inlink->h <= INT16_MAX)
+        s->remap_slice = remap_planar_warp_slice;
+
     s->step = av_get_padded_bits_per_pixel(desc) >> 3;
     return 0;
 }
@@ -306,6 +363,15 @@ static int process_frame(FFFrameSync *fs)
     return ff_filter_frame(outlink, out);
 }
 
+static void free_line_maps(RemapContext *s)
+{
+    for (int i = 0; i < s->nb_line_maps; i++)
+        ff_warp_map_free(&s->line_maps[i]);
+    av_freep(&s->line_maps);
+    s->nb_line_maps = 0;
+    av_freep(&s->pos);
+}
+
 static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -330,6 +396,24 @@ static int config_output(AVFilterLink *outlink)
     outlink->sample_aspect_ratio = srclink->sample_aspect_ratio;
     outlink->frame_rate = srclink->frame_rate;
 
+    if (s->remap_slice == remap_planar_warp_slice) {
+        const int nb_threads = ff_filter_get_nb_threads(ctx);
+
+        ff_warp_init(&s->warp, WARP_NEAREST, s->depth);
+        free_line_maps(s);
+        s->pos = av_malloc_array(nb_threads, 2 * outlink->w * sizeof(*s->pos));
+        s->line_maps = av_calloc(nb_threads, sizeof(*s->line_maps));
+        if (!s->pos || !s->line_maps)
+            return AVERROR(ENOMEM);
+        s->nb_line_maps = nb_threads;
+        for (int i = 0; i < nb_threads; i++) {
+            ret = ff_warp_map_alloc(&s->warp, &s->line_maps[i], outlink->w, 1,
+                                    srclink->w, srclink->h);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
     ret = ff_framesync_init(&s->fs, ctx, 3);
     if (ret < 0)
         return ret;
@@ -367,6 +451,7 @@ static av_cold void uninit(AVFilterContext *ctx)
     RemapContext *s = ctx->priv;
 
     ff_framesync_uninit(&s->fs);
+    free_line_maps(s);
 }
 
 static const AVFilterPad remap_inputs[] = {
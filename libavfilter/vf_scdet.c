@@ -113,7 +113,6 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
     if (prev_picref && frame->height == prev_picref->height
                     && frame->width  == prev_picref->width) {
         uint64_t sad = 0;
-        double mafd, diff;
         uint64_t count = 0;
 
         for (int plane = 0; plane < s->nb_planes; plane++) {
@@ -126,10 +125,7 @@ static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
         }
 
         emms_c();
-        mafd = (double)sad * 100. / count / (1ULL << s->bitdepth);
-        diff = fabs(mafd - s->prev_mafd);
-        ret  = av_clipf(FFMIN(mafd, diff), 0, 100.);
-        s->prev_mafd = mafd;
+        ret = ff_scene_sad_score(sad, count, s->bitdepth, &s->prev_mafd);
         av_frame_free(&prev_picref);
     }
     s->prev_picref = av_frame_clone(frame);
@@ -25,6 +25,7 @@
 #include "libavutil/pixdesc.h"
 #include "filters.h"
 #include "internal.h"
+#include "vf_signalstats.h"
 
 enum FilterMode {
     FILTER_NONE = -1,
@@ -52,10 +53,8 @@ typedef struct SignalstatsContext {
     int *jobs_rets;
 
     int maxsize;    // history stats array size
-    int *histy, *histu, *histv, *histsat;
-
-    AVFrame *frame_sat;
-    AVFrame *frame_hue;
+    SignalstatsHist *hists; // statistics of each job
+    unsigned *hist_buf;
 } SignalstatsContext;
 
 typedef struct ThreadData {
@@ -63,10 +62,9 @@ typedef struct ThreadData {
     AVFrame *out;
 } ThreadData;
 
-typedef struct ThreadDataHueSatMetrics {
-    const AVFrame *src;
-    AVFrame *dst_sat, *dst_hue;
-} ThreadDataHueSatMetrics;
+typedef struct ThreadDataStats {
+    const AVFrame *in, *prev;
+} ThreadDataStats;
 
 #define OFFSET(x) offsetof(SignalstatsContext, x)
 #define FLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_VIDEO_PARAM
@@ -108,13 +106,9 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     SignalstatsContext *s = ctx->priv;
     av_frame_free(&s->frame_prev);
-    av_frame_free(&s->frame_sat);
-    av_frame_free(&s->frame_hue);
     av_freep(&s->jobs_rets);
-    av_freep(&s->histy);
-    av_freep(&s->histu);
-    av_freep(&s->histv);
-    av_freep(&s->histsat);
+    av_freep(&s->hists);
+    av_freep(&s->hist_buf);
 }
 
 // TODO: add more
@@ -133,24 +127,6 @@ static const enum AVPixelFormat pix_fmts[] = {
     AV_PIX_FMT_NONE
 };
 
-static AVFrame *alloc_frame(enum AVPixelFormat pixfmt, int w, int h)
-{
-    AVFrame *frame = av_frame_alloc();
-    if (!frame)
-        return NULL;
-
-    frame->format = pixfmt;
-    frame->width  = w;
-    frame->height = h;
-
-    if (av_frame_get_buffer(frame, 0) < 0) {
-        av_frame_free(&frame);
-        return NULL;
-    }
-
-    return frame;
-}
-
 static int config_output(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -161,13 +137,6 @@ static int config_output(AVFilterLink *outlink)
     s->vsub = desc->log2_chroma_h;
     s->depth = desc->comp[0].depth;
     s->maxsize = 1 << s->depth;
-    s->histy = av_malloc_array(s->maxsize, sizeof(*s->histy));
-    s->histu = av_malloc_array(s->maxsize, sizeof(*s->histu));
-    s->histv = av_malloc_array(s->maxsize, sizeof(*s->histv));
-    s->histsat = av_malloc_array(s->maxsize, sizeof(*s->histsat));
-
-    if (!s->histy || !s->histu || !s->histv || !s->histsat)
-        return AVERROR(ENOMEM);
 
     outlink->w = inlink->w;
     outlink->h = inlink->h;
@@ -179,14 +148,23 @@ static int config_output(AVFilterLink *outlink)
     s->cfs = s->chromaw * s->chromah;
 
     s->nb_jobs   = FFMAX(1, FFMIN(inlink->h, ff_filter_get_nb_threads(ctx)));
+    av_freep(&s->jobs_rets);
+    av_freep(&s->hists);
+    av_freep(&s->hist_buf);
     s->jobs_rets = av_malloc_array(s->nb_jobs, sizeof(*s->jobs_rets));
-    if (!s->jobs_rets)
+    s->hists     = av_calloc(s->nb_jobs, sizeof(*s->hists));
+    s->hist_buf  = av_malloc_array(s->nb_jobs, 4 * s->maxsize * sizeof(*s->hist_buf));
+    if (!s->jobs_rets || !s->hists || !s->hist_buf)
         return AVERROR(ENOMEM);
 
-    s->frame_sat = alloc_frame(s->depth > 8 ? AV_PIX_FMT_GRAY16 : AV_PIX_FMT_GRAY8,  inlink->w, inlink->h);
-    s->frame_hue = alloc_frame(AV_PIX_FMT_GRAY16, inlink->w, inlink->h);
-    if (!s->frame_sat || !s->frame_hue)
-        return AVERROR(ENOMEM);
+    for (int i = 0; i < s->nb_jobs; i++) {
+        unsigned *hist = s->hist_buf + 4 * s->maxsize * i;
+
+        s->hists[i].histy   = hist;
+        s->hists[i].histu   = hist + s->maxsize;
+        s->hists[i].histv   = hist + s->maxsize * 2;
+        s->hists[i].histsat = hist + s->maxsize * 3;
+    }
 
     return 0;
 }
@@ -455,218 +433,143 @@ static const struct {
     {NULL}
 };
 
-static int compute_sat_hue_metrics8(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+void ff_signalstats_hist_reset(SignalstatsHist *h, int maxsize, int chroma)
 {
-    int i, j;
-    ThreadDataHueSatMetrics *td = arg;
-    const SignalstatsContext *s = ctx->priv;
-    const AVFrame *src = td->src;
-    AVFrame *dst_sat = td->dst_sat;
-    AVFrame *dst_hue = td->dst_hue;
-
-    const int slice_start = (s->chromah *  jobnr   ) / nb_jobs;
-    const int slice_end   = (s->chromah * (jobnr+1)) / nb_jobs;
-
-    const int lsz_u = src->linesize[1];
-    const int lsz_v = src->linesize[2];
-    const uint8_t *p_u = src->data[1] + slice_start * lsz_u;
-    const uint8_t *p_v = src->data[2] + slice_start * lsz_v;
-
-    const int lsz_sat = dst_sat->linesize[0];
-    const int lsz_hue = dst_hue->linesize[0];
-    uint8_t *p_sat = dst_sat->data[0] + slice_start * lsz_sat;
-    uint8_t *p_hue = dst_hue->data[0] + slice_start * lsz_hue;
-
-    for (j = slice_start; j < slice_end; j++) {
-        for (i = 0; i < s->chromaw; i++) {
-            const int yuvu = p_u[i];
-            const int yuvv = p_v[i];
-            p_sat[i] = hypotf(yuvu - 128, yuvv - 128); // int or round?
-            ((int16_t*)p_hue)[i] = fmodf(floorf((180.f / M_PI) * atan2f(yuvu-128, yuvv-128) + 180.f), 360.f);
-        }
-        p_u   += lsz_u;
-        p_v   += lsz_v;
-        p_sat += lsz_sat;
-        p_hue += lsz_hue;
+    memset(h->histy, 0, maxsize * sizeof(*h->histy));
+    if (chroma) {
+        memset(h->histu,   0, maxsize * sizeof(*h->histu));
+        memset(h->histv,   0, maxsize * sizeof(*h->histv));
+        memset(h->histsat, 0, maxsize * sizeof(*h->histsat));
+        memset(h->histhue, 0, sizeof(h->histhue));
     }
-
-    return 0;
+    h->masky = h->masku = h->maskv = 0;
+    h->dify  = h->difu  = h->difv  = 0;
 }
 
-static int compute_sat_hue_metrics16(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
-{
-    int i, j;
-    ThreadDataHueSatMetrics *td = arg;
-    const SignalstatsContext *s = ctx->priv;
-    const AVFrame *src = td->src;
-    AVFrame *dst_sat = td->dst_sat;
-    AVFrame *dst_hue = td->dst_hue;
-    const int mid = 1 << (s->depth - 1);
-
-    const int slice_start = (s->chromah *  jobnr   ) / nb_jobs;
-    const int slice_end   = (s->chromah * (jobnr+1)) / nb_jobs;
-
-    const int lsz_u = src->linesize[1] / 2;
-    const int lsz_v = src->linesize[2] / 2;
-    const uint16_t *p_u = (uint16_t*)src->data[1] + slice_start * lsz_u;
-    const uint16_t *p_v = (uint16_t*)src->data[2] + slice_start * lsz_v;
-
-    const int lsz_sat = dst_sat->linesize[0] / 2;
-    const int lsz_hue = dst_hue->linesize[0] / 2;
-    uint16_t *p_sat = (uint16_t*)dst_sat->data[0] + slice_start * lsz_sat;
-    uint16_t *p_hue = (uint16_t*)dst_hue->data[0] + slice_start * lsz_hue;
-
-    for (j = slice_start; j < slice_end; j++) {
-        for (i = 0; i < s->chromaw; i++) {
-            const int yuvu = p_u[i];
-            const int yuvv = p_v[i];
-            p_sat[i] = hypotf(yuvu - mid, yuvv - mid); // int or round?
-            ((int16_t*)p_hue)[i] = fmodf(floorf((180.f / M_PI) * atan2f(yuvu-mid, yuvv-mid) + 180.f), 360.f);
-        }
-        p_u   += lsz_u;
-        p_v   += lsz_v;
-        p_sat += lsz_sat;
-        p_hue += lsz_hue;
-    }
-
-    return 0;
+#define DEFINE_LINE_FUNCS(bits)                                                  \
+void ff_signalstats_luma_line##bits(SignalstatsHist *h, const uint8_t *src,      \
+                                    const uint8_t *prev, int w)                  \
+{                                                                                \
+    const uint##bits##_t *p  = (const uint##bits##_t *)src;                      \
+    const uint##bits##_t *pp = (const uint##bits##_t *)prev;                     \
+    unsigned *histy = h->histy;                                                  \
+    uint64_t dif = 0;                                                            \
+    unsigned mask = 0;                                                           \
+                                                                                 \
+    for (int x = 0; x < w; x++) {                                                \
+        const int yuv = p[x];                                                    \
+                                                                                 \
+        mask |= yuv;                                                             \
+        histy[yuv]++;                                                            \
+        dif += abs(yuv - pp[x]);                                                 \
+    }                                                                            \
+    h->masky |= mask;                                                            \
+    h->dify  += dif;                                                             \
+}                                                                                \
+                                                                                 \
+void ff_signalstats_chroma_line##bits(SignalstatsHist *h, const uint8_t *srcu,   \
+                                      const uint8_t *srcv, const uint8_t *prevu, \
+                                      const uint8_t *prevv, int w, int mid)      \
+{                                                                                \
+    const uint##bits##_t *pu  = (const uint##bits##_t *)srcu;                    \
+    const uint##bits##_t *pv  = (const uint##bits##_t *)srcv;                    \
+    const uint##bits##_t *ppu = (const uint##bits##_t *)prevu;                   \
+    const uint##bits##_t *ppv = (const uint##bits##_t *)prevv;                   \
+    uint64_t difu = 0, difv = 0;                                                 \
+    unsigned masku = 0, maskv = 0;                                               \
+                                                                                 \
+    for (int x = 0; x < w; x++) {                                                \
+        const int yuvu = pu[x];                                                  \
+        const int yuvv = pv[x];                                                  \
+        const uint##bits##_t sat = hypotf(yuvu - mid, yuvv - mid);               \
+        const int16_t hue = fmodf(floorf((180.f / M_PI) *                        \
+                                         atan2f(yuvu - mid, yuvv - mid) + 180.f), \
+                                  360.f);                                        \
+                                                                                 \
+        masku |= yuvu;                                                           \
+        maskv |= yuvv;                                                           \
+        h->histu[yuvu]++;                                                        \
+        h->histv[yuvv]++;                                                        \
+        difu += abs(yuvu - ppu[x]);                                              \
+        difv += abs(yuvv - ppv[x]);                                              \
+        h->histsat[sat]++;                                                       \
+        h->histhue[hue]++;                                                       \
+    }                                                                            \
+    h->masku |= masku;                                                           \
+    h->maskv |= maskv;                                                           \
+    h->difu  += difu;                                                            \
+    h->difv  += difv;                                                            \
 }
 
+DEFINE_LINE_FUNCS(8)
+DEFINE_LINE_FUNCS(16)
+
 static unsigned compute_bit_depth(uint16_t mask)
 {
     return av_popcount(mask);
 }
 
-static int filter_frame8(AVFilterLink *link, AVFrame *in)
+static void set_meta(AVDictionary **metadata, const char *key, const char *fmt, ...)
 {
-    AVFilterContext *ctx = link->dst;
-    SignalstatsContext *s = ctx->priv;
-    AVFilterLink *outlink = ctx->outputs[0];
-    AVFrame *out = in;
-    int i, j;
-    int  w = 0,  cw = 0, // in
-        pw = 0, cpw = 0; // prev
-    int fil;
     char metabuf[128];
-    unsigned int *histy = s->histy,
-                 *histu = s->histu,
-                 *histv = s->histv,
-                 histhue[360] = {0},
-                 *histsat = s->histsat;
+    va_list vl;
+
+    va_start(vl, fmt);
+    vsnprintf(metabuf, sizeof(metabuf), fmt, vl);
+    va_end(vl);
+    av_dict_set(metadata, key, metabuf, 0);
+}
+
+void ff_signalstats_set_metadata(AVDictionary **metadata, SignalstatsHist *hists,
+                                 int nb_hists, int maxsize, int fs, int cfs)
+{
+    unsigned *histy = hists[0].histy,
+             *histu = hists[0].histu,
+             *histv = hists[0].histv,
+             *histsat = hists[0].histsat,
+             *histhue = hists[0].histhue;
     int miny  = -1, minu  = -1, minv  = -1;
     int maxy  = -1, maxu  = -1, maxv  = -1;
     int lowy  = -1, lowu  = -1, lowv  = -1;
     int highy = -1, highu = -1, highv = -1;
     int minsat = -1, maxsat = -1, lowsat = -1, highsat = -1;
     int lowp, highp, clowp, chighp;
-    int accy, accu, accv;
-    int accsat, acchue = 0;
-    int medhue, maxhue;
-    int toty = 0, totu = 0, totv = 0, totsat=0;
-    int tothue = 0;
-    int dify = 0, difu = 0, difv = 0;
+    int accy = 0, accu = 0, accv = 0, accsat = 0, acchue = 0;
+    int medhue = -1;
+    int64_t toty = 0, totu = 0, totv = 0, totsat = 0, tothue = 0;
+    uint64_t dify = 0, difu = 0, difv = 0;
     uint16_t masky = 0, masku = 0, maskv = 0;
-    int ret;
-    int filtot[FILT_NUMB] = {0};
-    AVFrame *prev;
-
-    AVFrame *sat = s->frame_sat;
-    AVFrame *hue = s->frame_hue;
-    const uint8_t *p_sat = sat->data[0];
-    const uint8_t *p_hue = hue->data[0];
-    const int lsz_sat = sat->linesize[0];
-    const int lsz_hue = hue->linesize[0];
-    ThreadDataHueSatMetrics td_huesat = {
-        .src     = in,
-        .dst_sat = sat,
-        .dst_hue = hue,
-    };
-
-    if (!s->frame_prev)
-        s->frame_prev = av_frame_clone(in);
-
-    prev = s->frame_prev;
-
-    if (s->outfilter != FILTER_NONE) {
-        out = av_frame_clone(in);
-        if (!out) {
-            av_frame_free(&in);
-            return AVERROR(ENOMEM);
-        }
-        ret = ff_inlink_make_frame_writable(link, &out);
-        if (ret < 0) {
-            av_frame_free(&out);
-            av_frame_free(&in);
-            return ret;
-        }
-    }
-
-    ff_filter_execute(ctx, compute_sat_hue_metrics8, &td_huesat,
-                      NULL, FFMIN(s->chromah, ff_filter_get_nb_threads(ctx)));
 
-    // Calculate luma histogram and difference with previous frame or field.
-    memset(s->histy, 0, s->maxsize * sizeof(*s->histy));
-    for (j = 0; j < link->h; j++) {
-        for (i = 0; i < link->w; i++) {
-            const int yuv = in->data[0][w + i];
-
-            masky |= yuv;
-            histy[yuv]++;
-            dify += abs(yuv - prev->data[0][pw + i]);
-        }
-        w  += in->linesize[0];
-        pw += prev->linesize[0];
-    }
+    for (int i = 0; i < nb_hists; i++) {
+        const SignalstatsHist *h = &hists[i];
 
-    // Calculate chroma histogram and difference with previous frame or field.
-    memset(s->histu, 0, s->maxsize * sizeof(*s->histu));
-    memset(s->histv, 0, s->maxsize * sizeof(*s->histv));
-    memset(s->histsat, 0, s->maxsize * sizeof(*s->histsat));
-    for (j = 0; j < s->chromah; j++) {
-        for (i = 0; i < s->chromaw; i++) {
-            const int yuvu = in->data[1][cw+i];
-            const int yuvv = in->data[2][cw+i];
-
-            masku |= yuvu;
-            maskv |= yuvv;
-            histu[yuvu]++;
-            difu += abs(yuvu - prev->data[1][cpw+i]);
-            histv[yuvv]++;
-            difv += abs(yuvv - prev->data[2][cpw+i]);
-
-            histsat[p_sat[i]]++;
-            histhue[((int16_t*)p_hue)[i]]++;
-        }
-        cw  += in->linesize[1];
-        cpw += prev->linesize[1];
-        p_sat += lsz_sat;
-        p_hue += lsz_hue;
-    }
-
-    for (fil = 0; fil < FILT_NUMB; fil ++) {
-        if (s->filters & 1<<fil) {
-            ThreadData td = {
-                .in = in,
-                .out = out != in && s->outfilter == fil ? out : NULL,
-            };
-            memset(s->jobs_rets, 0, s->nb_jobs * sizeof(*s->jobs_rets));
-            ff_filter_execute(ctx, filters_def[fil].process8,
-                              &td, s->jobs_rets, s->nb_jobs);
-            for (i = 0; i < s->nb_jobs; i++)
-                filtot[fil] += s->jobs_rets[i];
+        masky |= h->masky;
+        masku |= h->masku;
+        maskv |= h->maskv;
+        dify  += h->dify;
+        difu  += h->difu;
+        difv  += h->difv;
+        if (!i)
+            continue;
+        for (int j = 0; j < maxsize; j++) {
+            histy[j]   += h->histy[j];
+            histu[j]   += h->histu[j];
+            histv[j]   += h->histv[j];
+            histsat[j] += h->histsat[j];
         }
+        for (int j = 0; j < 360; j++)
+            histhue[j] += h->histhue[j];
     }
 
     // find low / high based on histogram percentile
     // these only need to be calculated once.
 
-    lowp   = lrint(s->fs  * 10 / 100.);
-    highp  = lrint(s->fs  * 90 / 100.);
-    clowp  = lrint(s->cfs * 10 / 100.);
-    chighp = lrint(s->cfs * 90 / 100.);
+    lowp   = lrint(fs  * 10 / 100.);
+    highp  = lrint(fs  * 90 / 100.);
+    clowp  = lrint(cfs * 10 / 100.);
+    chighp = lrint(cfs * 90 / 100.);
 
-    accy = accu = accv = accsat = 0;
-    for (fil = 0; fil < s->maxsize; fil++) {
+    for (int fil = 0; fil < maxsize; fil++) {
         if (miny   < 0 && histy[fil])   miny = fil;
         if (minu   < 0 && histu[fil])   minu = fil;
         if (minv   < 0 && histv[fil])   minv = fil;
@@ -677,10 +580,10 @@ static int filter_frame8(AVFilterLink *link, AVFrame *in)
         if (histv[fil])   maxv   = fil;
         if (histsat[fil]) maxsat = fil;
 
-        toty   += histy[fil]   * fil;
-        totu   += histu[fil]   * fil;
-        totv   += histv[fil]   * fil;
-        totsat += histsat[fil] * fil;
+        toty   += histy[fil]   * (int64_t)fil;
+        totu   += histu[fil]   * (int64_t)fil;
+        totv   += histv[fil]   * (int64_t)fil;
+        totsat += histsat[fil] * (int64_t)fil;
 
         accy   += histy[fil];
         accu   += histu[fil];
@@ -698,126 +601,106 @@ static int filter_frame8(AVFilterLink *link, AVFrame *in)
         if (highsat == -1 && accsat >= chighp) highsat = fil;
     }
 
-    maxhue = histhue[0];
-    medhue = -1;
-    for (fil = 0; fil < 360; fil++) {
-        tothue += histhue[fil] * fil;
+    for (int fil = 0; fil < 360; fil++) {
+        tothue += histhue[fil] * (int64_t)fil;
         acchue += histhue[fil];
 
-        if (medhue == -1 && acchue > s->cfs / 2)
+        if (medhue == -1 && acchue > cfs / 2)
             medhue = fil;
-        if (histhue[fil] > maxhue) {
-            maxhue = histhue[fil];
-        }
     }
 
-    av_frame_free(&s->frame_prev);
-    s->frame_prev = av_frame_clone(in);
-
-#define SET_META(key, fmt, val) do {                                \
-    snprintf(metabuf, sizeof(metabuf), fmt, val);                   \
-    av_dict_set(&out->metadata, "lavfi.signalstats." key, metabuf, 0);   \
-} while (0)
+#define SET_META(key, fmt, val) set_meta(metadata, "lavfi.signalstats." key, fmt, val)
 
     SET_META("YMIN",    "%d", miny);
     SET_META("YLOW",    "%d", lowy);
-    SET_META("YAVG",    "%g", 1.0 * toty / s->fs);
+    SET_META("YAVG",    "%g", 1.0 * toty / fs);
     SET_META("YHIGH",   "%d", highy);
     SET_META("YMAX",    "%d", maxy);
 
     SET_META("UMIN",    "%d", minu);
     SET_META("ULOW",    "%d", lowu);
-    SET_META("UAVG",    "%g", 1.0 * totu / s->cfs);
+    SET_META("UAVG",    "%g", 1.0 * totu / cfs);
     SET_META("UHIGH",   "%d", highu);
     SET_META("UMAX",    "%d", maxu);
 
     SET_META("VMIN",    "%d", minv);
     SET_META("VLOW",    "%d", lowv);
-    SET_META("VAVG",    "%g", 1.0 * totv / s->cfs);
+    SET_META("VAVG",    "%g", 1.0 * totv / cfs);
     SET_META("VHIGH",   "%d", highv);
     SET_META("VMAX",    "%d", maxv);
 
     SET_META("SATMIN",  "%d", minsat);
     SET_META("SATLOW",  "%d", lowsat);
-    SET_META("SATAVG",  "%g", 1.0 * totsat / s->cfs);
+    SET_META("SATAVG",  "%g", 1.0 * totsat / cfs);
     SET_META("SATHIGH", "%d", highsat);
     SET_META("SATMAX",  "%d", maxsat);
 
     SET_META("HUEMED",  "%d", medhue);
-    SET_META("HUEAVG",  "%g", 1.0 * tothue / s->cfs);
+    SET_META("HUEAVG",  "%g", 1.0 * tothue / cfs);
 
-    SET_META("YDIF",    "%g", 1.0 * dify / s->fs);
-    SET_META("UDIF",    "%g", 1.0 * difu / s->cfs);
-    SET_META("VDIF",    "%g", 1.0 * difv / s->cfs);
+    SET_META("YDIF",    "%g", 1.0 * dify / fs);
+    SET_META("UDIF",    "%g", 1.0 * difu / cfs);
+    SET_META("VDIF",    "%g", 1.0 * difv / cfs);
 
     SET_META("YBITDEPTH", "%d", compute_bit_depth(masky));
     SET_META("UBITDEPTH", "%d", compute_bit_depth(masku));
     SET_META("VBITDEPTH", "%d", compute_bit_depth(maskv));
+}
 
-    for (fil = 0; fil < FILT_NUMB; fil ++) {
-        if (s->filters & 1<<fil) {
-            char metaname[128];
-            snprintf(metabuf,  sizeof(metabuf),  "%g", 1.0 * filtot[fil] / s->fs);
-            snprintf(metaname, sizeof(metaname), "lavfi.signalstats.%s", filters_def[fil].name);
-            av_dict_set(&out->metadata, metaname, metabuf, 0);
-        }
+static int compute_stats(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    SignalstatsContext *s = ctx->priv;
+    const ThreadDataStats *td = arg;
+    const AVFrame *in = td->in, *prev = td->prev;
+    SignalstatsHist *h = &s->hists[jobnr];
+    const int mid = 1 << (s->depth - 1);
+    const int slice_start  = (in->height *  jobnr     ) / nb_jobs;
+    const int slice_end    = (in->height * (jobnr + 1)) / nb_jobs;
+    const int cslice_start = (s->chromah *  jobnr     ) / nb_jobs;
+    const int cslice_end   = (s->chromah * (jobnr + 1)) / nb_jobs;
+
+    ff_signalstats_hist_reset(h, s->maxsize, 1);
+
+    // Calculate luma histogram and difference with previous frame or field.
+    for (int y = slice_start; y < slice_end; y++) {
+        const uint8_t *src  = in  ->data[0] + y * in  ->linesize[0];
+        const uint8_t *psrc = prev->data[0] + y * prev->linesize[0];
+
+        if (s->depth > 8)
+            ff_signalstats_luma_line16(h, src, psrc, in->width);
+        else
+            ff_signalstats_luma_line8 (h, src, psrc, in->width);
     }
 
-    if (in != out)
-        av_frame_free(&in);
-    return ff_filter_frame(outlink, out);
+    // Calculate chroma histogram and difference with previous frame or field.
+    for (int y = cslice_start; y < cslice_end; y++) {
+        const uint8_t *srcu  = in  ->data[1] + y * in  ->linesize[1];
+        const uint8_t *srcv  = in  ->data[2] + y * in  ->linesize[2];
+        const uint8_t *psrcu = prev->data[1] + y * prev->linesize[1];
+        const uint8_t *psrcv = prev->data[2] + y * prev->linesize[2];
+
+        if (s->depth > 8)
+            ff_signalstats_chroma_line16(h, srcu, srcv, psrcu, psrcv, s->chromaw, mid);
+        else
+            ff_signalstats_chroma_line8 (h, srcu, srcv, psrcu, psrcv, s->chromaw, mid);
+    }
+
+    return 0;
 }
 
-static int filter_frame16(AVFilterLink *link, AVFrame *in)
+static int filter_frame(AVFilterLink *link, AVFrame *in)
 {
     AVFilterContext *ctx = link->dst;
     SignalstatsContext *s = ctx->priv;
     AVFilterLink *outlink = ctx->outputs[0];
     AVFrame *out = in;
-    int i, j;
-    int  w = 0,  cw = 0, // in
-        pw = 0, cpw = 0; // prev
-    int fil;
-    char metabuf[128];
-    unsigned int *histy = s->histy,
-                 *histu = s->histu,
-                 *histv = s->histv,
-                 histhue[360] = {0},
-                 *histsat = s->histsat;
-    int miny  = -1, minu  = -1, minv  = -1;
-    int maxy  = -1, maxu  = -1, maxv  = -1;
-    int lowy  = -1, lowu  = -1, lowv  = -1;
-    int highy = -1, highu = -1, highv = -1;
-    int minsat = -1, maxsat = -1, lowsat = -1, highsat = -1;
-    int lowp, highp, clowp, chighp;
-    int accy, accu, accv;
-    int accsat, acchue = 0;
-    int medhue, maxhue;
-    int64_t toty = 0, totu = 0, totv = 0, totsat=0;
-    int64_t tothue = 0;
-    int64_t dify = 0, difu = 0, difv = 0;
-    uint16_t masky = 0, masku = 0, maskv = 0;
-
+    int fil, ret;
     int filtot[FILT_NUMB] = {0};
-    AVFrame *prev;
-    int ret;
-    AVFrame *sat = s->frame_sat;
-    AVFrame *hue = s->frame_hue;
-    const uint16_t *p_sat = (uint16_t *)sat->data[0];
-    const uint16_t *p_hue = (uint16_t *)hue->data[0];
-    const int lsz_sat = sat->linesize[0] / 2;
-    const int lsz_hue = hue->linesize[0] / 2;
-    ThreadDataHueSatMetrics td_huesat = {
-        .src     = in,
-        .dst_sat = sat,
-        .dst_hue = hue,
-    };
+    ThreadDataStats td_stats;
 
     if (!s->frame_prev)
         s->frame_prev = av_frame_clone(in);
 
-    prev = s->frame_prev;
-
     if (s->outfilter != FILTER_NONE) {
         out = av_frame_clone(in);
         if (!out) {
@@ -832,47 +715,9 @@ static int filter_frame16(AVFilterLink *link, AVFrame *in)
         }
     }
 
-    ff_filter_execute(ctx, compute_sat_hue_metrics16, &td_huesat,
-                      NULL, FFMIN(s->chromah, ff_filter_get_nb_threads(ctx)));
-
-    // Calculate luma histogram and difference with previous frame or field.
-    memset(s->histy, 0, s->maxsize * sizeof(*s->histy));
-    for (j = 0; j < link->h; j++) {
-        for (i = 0; i < link->w; i++) {
-            const int yuv = AV_RN16(in->data[0] + w + i * 2);
-
-            masky |= yuv;
-            histy[yuv]++;
-            dify += abs(yuv - (int)AV_RN16(prev->data[0] + pw + i * 2));
-        }
-        w  += in->linesize[0];
-        pw += prev->linesize[0];
-    }
-
-    // Calculate chroma histogram and difference with previous frame or field.
-    memset(s->histu, 0, s->maxsize * sizeof(*s->histu));
-    memset(s->histv, 0, s->maxsize * sizeof(*s->histv));
-    memset(s->histsat, 0, s->maxsize * sizeof(*s->histsat));
-    for (j = 0; j < s->chromah; j++) {
-        for (i = 0; i < s->chromaw; i++) {
-            const int yuvu = AV_RN16(in->data[1] + cw + i * 2);
-            const int yuvv = AV_RN16(in->data[2] + cw + i * 2);
-
-            masku |= yuvu;
-            maskv |= yuvv;
-            histu[yuvu]++;
-            difu += abs(yuvu - (int)AV_RN16(prev->data[1] + cpw + i * 2));
-            histv[yuvv]++;
-            difv += abs(yuvv - (int)AV_RN16(prev->data[2] + cpw + i * 2));
-
-            histsat[p_sat[i]]++;
-            histhue[((int16_t*)p_hue)[i]]++;
-        }
-        cw  += in->linesize[1];
-        cpw += prev->linesize[1];
-        p_sat += lsz_sat;
-        p_hue += lsz_hue;
-    }
+    td_stats.in   = in;
+    td_stats.prev = s->frame_prev;
+    ff_filter_execute(ctx, compute_stats, &td_stats, NULL, s->nb_jobs);
 
     for (fil = 0; fil < FILT_NUMB; fil ++) {
         if (s->filters & 1<<fil) {
@@ -881,111 +726,25 @@ static int filter_frame16(AVFilterLink *link, AVFrame *in)
                 .out = out != in && s->outfilter == fil ? out : NULL,
             };
             memset(s->jobs_rets, 0, s->nb_jobs * sizeof(*s->jobs_rets));
-            ff_filter_execute(ctx, filters_def[fil].process16,
+            ff_filter_execute(ctx, s->depth > 8 ? filters_def[fil].process16
+                                                : filters_def[fil].process8,
                               &td, s->jobs_rets, s->nb_jobs);
-            for (i = 0; i < s->nb_jobs; i++)
+            for (int i = 0; i < s->nb_jobs; i++)
                 filtot[fil] += s->jobs_rets[i];
         }
     }
 
-    // find low / high based on histogram percentile
-    // these only need to be calculated once.
-
-    lowp   = lrint(s->fs  * 10 / 100.);
-    highp  = lrint(s->fs  * 90 / 100.);
-    clowp  = lrint(s->cfs * 10 / 100.);
-    chighp = lrint(s->cfs * 90 / 100.);
-
-    accy = accu = accv = accsat = 0;
-    for (fil = 0; fil < s->maxsize; fil++) {
-        if (miny   < 0 && histy[fil])   miny = fil;
-        if (minu   < 0 && histu[fil])   minu = fil;
-        if (minv   < 0 && histv[fil])   minv = fil;
-        if (minsat < 0 && histsat[fil]) minsat = fil;
-
-        if (histy[fil])   maxy   = fil;
-        if (histu[fil])   maxu   = fil;
-        if (histv[fil])   maxv   = fil;
-        if (histsat[fil]) maxsat = fil;
-
-        toty   += histy[fil]   * fil;
-        totu   += histu[fil]   * fil;
-        totv   += histv[fil]   * fil;
-        totsat += histsat[fil] * fil;
-
-        accy   += histy[fil];
-        accu   += histu[fil];
-        accv   += histv[fil];
-        accsat += histsat[fil];
-
-        if (lowy   == -1 && accy   >=  lowp) lowy   = fil;
-        if (lowu   == -1 && accu   >= clowp) lowu   = fil;
-        if (lowv   == -1 && accv   >= clowp) lowv   = fil;
-        if (lowsat == -1 && accsat >= clowp) lowsat = fil;
-
-        if (highy   == -1 && accy   >=  highp) highy   = fil;
-        if (highu   == -1 && accu   >= chighp) highu   = fil;
-        if (highv   == -1 && accv   >= chighp) highv   = fil;
-        if (highsat == -1 && accsat >= chighp) highsat = fil;
-    }
-
-    maxhue = histhue[0];
-    medhue = -1;
-    for (fil = 0; fil < 360; fil++) {
-        tothue += histhue[fil] * fil;
-        acchue += histhue[fil];
-
-        if (medhue == -1 && acchue > s->cfs / 2)
-            medhue = fil;
-        if (histhue[fil] > maxhue) {
-            maxhue = histhue[fil];
-        }
-    }
-
     av_frame_free(&s->frame_prev);
     s->frame_prev = av_frame_clone(in);
 
-    SET_META("YMIN",    "%d", miny);
-    SET_META("YLOW",    "%d", lowy);
-    SET_META("YAVG",    "%g", 1.0 * toty / s->fs);
-    SET_META("YHIGH",   "%d", highy);
-    SET_META("YMAX",    "%d", maxy);
-
-    SET_META("UMIN",    "%d", minu);
-    SET_META("ULOW",    "%d", lowu);
-    SET_META("UAVG",    "%g", 1.0 * totu / s->cfs);
-    SET_META("UHIGH",   "%d", highu);
-    SET_META("UMAX",    "%d", maxu);
-
-    SET_META("VMIN",    "%d", minv);
-    SET_META("VLOW",    "%d", lowv);
-    SET_META("VAVG",    "%g", 1.0 * totv / s->cfs);
-    SET_META("VHIGH",   "%d", highv);
-    SET_META("VMAX",    "%d", maxv);
-
-    SET_META("SATMIN",  "%d", minsat);
-    SET_META("SATLOW",  "%d", lowsat);
-    SET_META("SATAVG",  "%g", 1.0 * totsat / s->cfs);
-    SET_META("SATHIGH", "%d", highsat);
-    SET_META("SATMAX",  "%d", maxsat);
-
-    SET_META("HUEMED",  "%d", medhue);
-    SET_META("HUEAVG",  "%g", 1.0 * tothue / s->cfs);
-
-    SET_META("YDIF",    "%g", 1.0 * dify / s->fs);
-    SET_META("UDIF",    "%g", 1.0 * difu / s->cfs);
-    SET_META("VDIF",    "%g", 1.0 * difv / s->cfs);
-
-    SET_META("YBITDEPTH", "%d", compute_bit_depth(masky));
-    SET_META("UBITDEPTH", "%d", compute_bit_depth(masku));
-    SET_META("VBITDEPTH", "%d", compute_bit_depth(maskv));
+    ff_signalstats_set_metadata(&out->metadata, s->hists, s->nb_jobs,
+                                s->maxsize, s->fs, s->cfs);
 
     for (fil = 0; fil < FILT_NUMB; fil ++) {
         if (s->filters & 1<<fil) {
             char metaname[128];
-            snprintf(metabuf,  sizeof(metabuf),  "%g", 1.0 * filtot[fil] / s->fs);
             snprintf(metaname, sizeof(metaname), "lavfi.signalstats.%s", filters_def[fil].name);
-            av_dict_set(&out->metadata, metaname, metabuf, 0);
+            set_meta(&out->metadata, metaname, "%g", 1.0 * filtot[fil] / s->fs);
         }
     }
 
@@ -994,17 +753,6 @@ static int filter_frame16(AVFilterLink *link, AVFrame *in)
     return ff_filter_frame(outlink, out);
 }
 
-static int filter_frame(AVFilterLink *link, AVFrame *in)
-{
-    AVFilterContext *ctx = link->dst;
-    SignalstatsContext *s = ctx->priv;
-
-    if (s->depth > 8)
-        return filter_frame16(link, in);
-    else
-        return filter_frame8(link, in);
-}
-
 static const AVFilterPad signalstats_inputs[] = {
     {
         .name           = "default",
@@ -0,0 +1,72 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_SIGNALSTATS_H
+#define AVFILTER_SIGNALSTATS_H
+
+#include <stdint.h>
+
+#include "libavutil/dict.h"
+
+/**
+ * Histograms, bit masks and differences to the previous frame of the
+ * lines of a frame, usually the part handled by one slice job.
+ */
+typedef struct SignalstatsHist {
+    unsigned *histy, *histu, *histv, *histsat; ///< 1 << depth entries each
+    unsigned histhue[360];
+    uint16_t masky, masku, maskv;
+    uint64_t dify, difu, difv;
+} SignalstatsHist;
+
+/**
+ * Clear the statistics. The chroma histograms are only cleared if chroma
+ * is set.
+ */
+void ff_signalstats_hist_reset(SignalstatsHist *h, int maxsize, int chroma);
+
+/**
+ * Add a luma line to the statistics.
+ */
+void ff_signalstats_luma_line8 (SignalstatsHist *h, const uint8_t *src,
+                                const uint8_t *prev, int w);
+void ff_signalstats_luma_line16(SignalstatsHist *h, const uint8_t *src,
+                                const uint8_t *prev, int w);
+
+/**
+ * Add a line of both chroma planes to the statistics, mid being the value
+ * of zero chroma.
+ */
+void ff_signalstats_chroma_line8 (SignalstatsHist *h, const uint8_t *srcu,
+                                  const uint8_t *srcv, const uint8_t *prevu,
+                                  const uint8_t *prevv, int w, int mid);
+void ff_signalstats_chroma_line16(SignalstatsHist *h, const uint8_t *srcu,
+                                  const uint8_t *srcv, const uint8_t *prevu,
+                                  const uint8_t *prevv, int w, int mid);
+
+/**
+ * Merge the statistics of nb_hists jobs into the first one and set the
+ * lavfi.signalstats metadata derived from them.
+ *
+ * @param fs  pixel count of the luma plane
+ * @param cfs pixel count of a chroma plane
+ */
+void ff_signalstats_set_metadata(AVDictionary **metadata, SignalstatsHist *hists,
+                                 int nb_hists, int maxsize, int fs, int cfs);
+
+#endif /* AVFILTER_SIGNALSTATS_H */
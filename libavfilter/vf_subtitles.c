@@ -37,6 +37,7 @@
 #endif
 #include "libavutil/avstring.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
 #include "drawutils.h"
@@ -61,6 +62,21 @@ typedef struct AssContext {
     int original_w, original_h;
     int shaping;
     FFDrawContext draw;
+
+    /* All the images of the last list composited into one layer: blending
+     * it replaces sample p with base + p * trans / max, which is what
+     * blending every image in turn does. */
+    uint8_t *layer;
+    unsigned int layer_size;
+    int *spans;                 ///< first and last sample + 1 touched in each layer row
+    unsigned int spans_size;
+    int layer_x, layer_y, layer_w, layer_h;
+    int layer_planes;
+    uint8_t *base[4], *trans[4];
+    int *span[4];
+    int layer_linesize[4];
+    int layer_rows[4];
+    int cache_valid;
 } AssContext;
 
 #define OFFSET(x) offsetof(AssContext, x)
@@ -133,6 +149,8 @@ static av_cold void uninit(AVFilterContext *ctx)
         ass_renderer_done(ass->renderer);
     if (ass->library)
         ass_library_done(ass->library);
+    av_freep(&ass->layer);
+    av_freep(&ass->spans);
 }
 
 static int query_formats(AVFilterContext *ctx)
@@ -146,6 +164,8 @@ static int config_input(AVFilterLink *inlink)
 
     ff_draw_init(&ass->draw, inlink->format, ass->alpha ? FF_DRAW_PROCESS_ALPHA : 0);
 
+    ass->cache_valid = 0;
+
     ass_set_frame_size  (ass->renderer, inlink->w, inlink->h);
     if (ass->original_w && ass->original_h) {
         ass_set_pixel_aspect(ass->renderer, (double)inlink->w / inlink->h /
@@ -166,19 +186,173 @@ static int config_input(AVFilterLink *inlink)
 #define AB(c)  (((c)>>8) &0xFF)
 #define AA(c)  ((0xFF-(c)) &0xFF)
 
-static void overlay_ass_image(AssContext *ass, AVFrame *picref,
-                              const ASS_Image *image)
+static int composite_ass_image(AssContext *ass, const ASS_Image *image,
+                               int frame_w, int frame_h)
 {
-    for (; image; image = image->next) {
-        uint8_t rgba_color[] = {AR(image->color), AG(image->color), AB(image->color), AA(image->color)};
+    const FFDrawContext *draw = &ass->draw;
+    const int bytes = (draw->desc->comp[0].depth + 7) >> 3;
+    const int hmask = (1 << draw->hsub_max) - 1;
+    const int vmask = (1 << draw->vsub_max) - 1;
+    const ASS_Image *img;
+    int x0 = INT_MAX, y0 = INT_MAX, x1 = INT_MIN, y1 = INT_MIN;
+    size_t layer_size = 0, spans_size = 0;
+    int nb_planes;
+
+    ass->cache_valid = 0;
+    ass->layer_w = ass->layer_h = 0;
+
+    for (img = image; img; img = img->next) {
+        if (img->w <= 0 || img->h <= 0 || AA(img->color) == 0)
+            continue;
+        x0 = FFMIN(x0, img->dst_x);
+        y0 = FFMIN(y0, img->dst_y);
+        x1 = FFMAX(x1, img->dst_x + img->w);
+        y1 = FFMAX(y1, img->dst_y + img->h);
+    }
+    /* align the layer on the chroma grid of the frame */
+    x0 = FFMAX(x0, 0) & ~hmask;
+    y0 = FFMAX(y0, 0) & ~vmask;
+    x1 = FFMIN(x1, frame_w);
+    y1 = FFMIN(y1, frame_h);
+    if (x0 >= x1 || y0 >= y1) {
+        ass->cache_valid = 1;
+        return 0;
+    }
+
+    nb_planes = draw->nb_planes - !!(draw->desc->flags & AV_PIX_FMT_FLAG_ALPHA &&
+                                     !(draw->flags & FF_DRAW_PROCESS_ALPHA));
+    nb_planes += !nb_planes;
+    for (int plane = 0; plane < nb_planes; plane++) {
+        ass->layer_linesize[plane] = AV_CEIL_RSHIFT(x1 - x0, draw->hsub[plane]) *
+                                     draw->pixelstep[plane];
+        ass->layer_rows[plane]     = AV_CEIL_RSHIFT(y1 - y0, draw->vsub[plane]);
+        layer_size += 2 * (size_t)ass->layer_linesize[plane] * ass->layer_rows[plane];
+        spans_size += 2 * ass->layer_rows[plane];
+    }
+    if (layer_size > INT_MAX || spans_size > INT_MAX / sizeof(*ass->spans))
+        return AVERROR(ENOMEM);
+    av_fast_malloc(&ass->layer, &ass->layer_size, layer_size);
+    av_fast_malloc(&ass->spans, &ass->spans_size, spans_size * sizeof(*ass->spans));
+    if (!ass->layer || !ass->spans)
+        return AVERROR(ENOMEM);
+
+    layer_size = spans_size = 0;
+    for (int plane = 0; plane < nb_planes; plane++) {
+        const size_t size = (size_t)ass->layer_linesize[plane] * ass->layer_rows[plane];
+
+        ass->base[plane]  = ass->layer + layer_size;
+        ass->trans[plane] = ass->layer + layer_size + size;
+        ass->span[plane]  = ass->spans + spans_size;
+        memset(ass->base[plane],  0x00, size);
+        memset(ass->trans[plane], 0xff, size);
+        layer_size += 2 * size;
+        spans_size += 2 * ass->layer_rows[plane];
+    }
+
+    /* Blending is affine in the destination sample, so blending the images
+     * over black and over white gives the offset and the slope. */
+    for (img = image; img; img = img->next) {
+        uint8_t rgba_color[] = {AR(img->color), AG(img->color), AB(img->color), AA(img->color)};
         FFDrawColor color;
+
+        if (img->w <= 0 || img->h <= 0 || AA(img->color) == 0)
+            continue;
         ff_draw_color(&ass->draw, &color, rgba_color);
-        ff_blend_mask(&ass->draw, &color,
-                      picref->data, picref->linesize,
-                      picref->width, picref->height,
-                      image->bitmap, image->stride, image->w, image->h,
-                      3, 0, image->dst_x, image->dst_y);
+        ff_blend_mask(&ass->draw, &color, ass->base, ass->layer_linesize,
+                      x1 - x0, y1 - y0, img->bitmap, img->stride, img->w, img->h,
+                      3, 0, img->dst_x - x0, img->dst_y - y0);
+        ff_blend_mask(&ass->draw, &color, ass->trans, ass->layer_linesize,
+                      x1 - x0, y1 - y0, img->bitmap, img->stride, img->w, img->h,
+                      3, 0, img->dst_x - x0, img->dst_y - y0);
+    }
+
+    for (int plane = 0; plane < nb_planes; plane++) {
+        const int n = ass->layer_linesize[plane] / bytes;
+
+        for (int y = 0; y < ass->layer_rows[plane]; y++) {
+            const int offset = y * ass->layer_linesize[plane];
+            int start = n, end = 0;
+
+            if (bytes == 1) {
+                uint8_t *base  = ass->base[plane]  + offset;
+                uint8_t *trans = ass->trans[plane] + offset;
+
+                for (int x = 0; x < n; x++) {
+                    trans[x] -= base[x];
+                    if (base[x] || trans[x] != 0xff) {
+                        start = FFMIN(start, x);
+                        end   = x + 1;
+                    }
+                }
+            } else {
+                uint16_t *base  = (uint16_t *)(ass->base[plane]  + offset);
+                uint16_t *trans = (uint16_t *)(ass->trans[plane] + offset);
+
+                for (int x = 0; x < n; x++) {
+                    trans[x] -= base[x];
+                    if (base[x] || trans[x] != 0xffff) {
+                        start = FFMIN(start, x);
+                        end   = x + 1;
+                    }
+                }
+            }
+            ass->span[plane][2 * y    ] = start;
+            ass->span[plane][2 * y + 1] = end;
+        }
+    }
+
+    ass->layer_x      = x0;
+    ass->layer_y      = y0;
+    ass->layer_w      = x1 - x0;
+    ass->layer_h      = y1 - y0;
+    ass->layer_planes = nb_planes;
+    ass->cache_valid  = 1;
+    return 0;
+}
+
+static int blend_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    AssContext *ass = ctx->priv;
+    AVFrame *frame = arg;
+    const int bytes = (ass->draw.desc->comp[0].depth + 7) >> 3;
+
+    for (int plane = 0; plane < ass->layer_planes; plane++) {
+        const int rows  = ass->layer_rows[plane];
+        const int start = (rows *  jobnr     ) / nb_jobs;
+        const int end   = (rows * (jobnr + 1)) / nb_jobs;
+        uint8_t *dst0 = frame->data[plane] +
+                        (ass->layer_y >> ass->draw.vsub[plane]) * frame->linesize[plane] +
+                        (ass->layer_x >> ass->draw.hsub[plane]) * ass->draw.pixelstep[plane];
+
+        for (int y = start; y < end; y++) {
+            const int offset = y * ass->layer_linesize[plane];
+            const int x0 = ass->span[plane][2 * y], x1 = ass->span[plane][2 * y + 1];
+            uint8_t *dst = dst0 + y * frame->linesize[plane];
+
+            /* base + trans never exceeds the maximum, and
+             * (t + (t >> n)) >> n rounds t / (2^n - 1) exactly */
+            if (bytes == 1) {
+                const uint8_t *base  = ass->base[plane]  + offset;
+                const uint8_t *trans = ass->trans[plane] + offset;
+
+                for (int x = x0; x < x1; x++) {
+                    unsigned t = trans[x] * dst[x] + 0x80;
+                    dst[x] = base[x] + ((t + (t >> 8)) >> 8);
+                }
+            } else {
+                const uint16_t *base  = (const uint16_t *)(ass->base[plane]  + offset);
+                const uint16_t *trans = (const uint16_t *)(ass->trans[plane] + offset);
+                uint16_t *dst16 = (uint16_t *)dst;
+
+                for (int x = x0; x < x1; x++) {
+                    unsigned t = trans[x] * dst16[x] + 0x8000;
+                    dst16[x] = base[x] + ((t + (t >> 16)) >> 16);
+                }
+            }
+        }
     }
+
+    return 0;
 }
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
@@ -191,10 +365,22 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *picref)
     ASS_Image *image = ass_render_frame(ass->renderer, ass->track,
                                         time_ms, &detect_change);
 
-    if (detect_change)
-        av_log(ctx, AV_LOG_DEBUG, "Change happened at time ms:%f\n", time_ms);
+    if (detect_change || !ass->cache_valid) {
+        int ret;
+
+        if (detect_change)
+            av_log(ctx, AV_LOG_DEBUG, "Change happened at time ms:%f\n", time_ms);
+
+        ret = composite_ass_image(ass, image, inlink->w, inlink->h);
+        if (ret < 0) {
+            av_frame_free(&picref);
+            return ret;
+        }
+    }
 
-    overlay_ass_image(ass, picref, image);
+    if (ass->layer_w)
+        ff_filter_execute(ctx, blend_slice, picref, NULL,
+                          FFMIN(ass->layer_h, ff_filter_get_nb_threads(ctx)));
 
     return ff_filter_frame(outlink, picref);
 }
@@ -260,6 +446,7 @@ const AVFilter ff_vf_ass = {
     FILTER_OUTPUTS(ass_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &ass_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif
 
@@ -500,5 +687,6 @@ const AVFilter ff_vf_subtitles = {
     FILTER_OUTPUTS(ass_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &subtitles_class,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif
@@ -38,18 +38,9 @@
 #include "colorspace.h"
 #include "formats.h"
 #include "internal.h"
+#include "tonemap.h"
 #include "video.h"
-
-enum TonemapAlgorithm {
-    TONEMAP_NONE,
-    TONEMAP_LINEAR,
-    TONEMAP_GAMMA,
-    TONEMAP_CLIP,
-    TONEMAP_REINHARD,
-    TONEMAP_HABLE,
-    TONEMAP_MOBIUS,
-    TONEMAP_MAX,
-};
+#include "vf_tonemap_init.h"
 
 typedef struct TonemapContext {
     const AVClass *class;
@@ -58,8 +49,23 @@ typedef struct TonemapContext {
     double param;
     double desat;
     double peak;
+    int trc;
 
     const AVLumaCoefficients *coeffs;
+    TonemapDSPContext dsp;
+
+    /* YUV input only */
+    int depth;
+    int semi_planar;
+    TonemapYUVParams yuv;
+    float rgb2yuv[3][3];
+    float chroma_scale, chroma_offset;
+    float *lin_lut, *delin_lut;
+    enum AVColorTransferCharacteristic lut_trc;
+    double lut_peak;
+    float *rgb_buf;
+    int rgb_stride;
+    int nb_threads;
 } TonemapContext;
 
 static av_cold int init(AVFilterContext *ctx)
@@ -84,98 +90,157 @@ static av_cold int init(AVFilterContext *ctx)
     if (isnan(s->param))
         s->param = 1.0f;
 
+    s->lut_trc = AVCOL_TRC_RESERVED0;
+    ff_tonemap_init(&s->dsp);
+
     return 0;
 }
 
-static float hable(float in)
+static av_cold void uninit(AVFilterContext *ctx)
 {
-    float a = 0.15f, b = 0.50f, c = 0.10f, d = 0.20f, e = 0.02f, f = 0.30f;
-    return (in * (in * a + b * c) + d * e) / (in * (in * a + b) + d * f) - e / f;
+    TonemapContext *s = ctx->priv;
+
+    av_freep(&s->lin_lut);
+    av_freep(&s->rgb_buf);
 }
 
-static float mobius(float in, float j, double peak)
+static int config_input(AVFilterLink *inlink)
 {
-    float a, b;
+    AVFilterContext *ctx = inlink->dst;
+    TonemapContext *s = ctx->priv;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(inlink->format);
+
+    av_freep(&s->rgb_buf);
+    if (desc->flags & AV_PIX_FMT_FLAG_FLOAT)
+        return 0;
+
+    s->depth       = desc->comp[0].depth;
+    s->semi_planar = desc->comp[1].plane == desc->comp[2].plane;
+    s->nb_threads  = ff_filter_get_nb_threads(ctx);
+    s->rgb_stride  = FFALIGN(inlink->w + 1, 16);
+    s->rgb_buf     = av_calloc(s->nb_threads * 6 * s->rgb_stride, sizeof(*s->rgb_buf));
+    if (!s->rgb_buf)
+        return AVERROR(ENOMEM);
 
-    if (in <= j)
-        return in;
+    return 0;
+}
 
-    a = -j * j * (peak - 1.0f) / (j * j - 2.0f * j + peak);
-    b = (j * j - 2.0f * j * peak + peak) / FFMAX(peak - 1.0f, 1e-6);
+/* invert a monotonic transfer function over [0, max] by bisection */
+static double trc_inverse(av_csp_trc_function func, double v, double max)
+{
+    double lo = 0.0, hi = max;
+
+    for (int i = 0; i < 32; i++) {
+        double mid = (lo + hi) * 0.5;
+        if (func(mid) < v)
+            lo = mid;
+        else
+            hi = mid;
+    }
 
-    return (b * b + 2.0f * b * j + j * j) / (b - a) * (in + a) / (in + b);
+    return (lo + hi) * 0.5;
 }
 
-#define MIX(x,y,a) (x) * (1 - (a)) + (y) * (a)
-static void tonemap(TonemapContext *s, AVFrame *out, const AVFrame *in,
-                    const AVPixFmtDescriptor *desc, int x, int y, double peak)
+static int build_luts(AVFilterContext *ctx, enum AVColorTransferCharacteristic trc,
+                      double peak)
 {
-    int map[3] = { desc->comp[0].plane, desc->comp[1].plane, desc->comp[2].plane };
-    const float *r_in = (const float *)(in->data[map[0]] + x * desc->comp[map[0]].step + y * in->linesize[map[0]]);
-    const float *g_in = (const float *)(in->data[map[1]] + x * desc->comp[map[1]].step + y * in->linesize[map[1]]);
-    const float *b_in = (const float *)(in->data[map[2]] + x * desc->comp[map[2]].step + y * in->linesize[map[2]]);
-    float *r_out = (float *)(out->data[map[0]] + x * desc->comp[map[0]].step + y * out->linesize[map[0]]);
-    float *g_out = (float *)(out->data[map[1]] + x * desc->comp[map[1]].step + y * out->linesize[map[1]]);
-    float *b_out = (float *)(out->data[map[2]] + x * desc->comp[map[2]].step + y * out->linesize[map[2]]);
-    float sig, sig_orig;
-
-    /* load values */
-    *r_out = *r_in;
-    *g_out = *g_in;
-    *b_out = *b_in;
-
-    /* desaturate to prevent unnatural colors */
-    if (s->desat > 0) {
-        float luma = av_q2d(s->coeffs->cr) * *r_in + av_q2d(s->coeffs->cg) * *g_in + av_q2d(s->coeffs->cb) * *b_in;
-        float overbright = FFMAX(luma - s->desat, 1e-6) / FFMAX(luma, 1e-6);
-        *r_out = MIX(*r_in, luma, overbright);
-        *g_out = MIX(*g_in, luma, overbright);
-        *b_out = MIX(*b_in, luma, overbright);
+    TonemapContext *s = ctx->priv;
+    av_csp_trc_function lin_func   = av_csp_trc_func_from_id(trc);
+    av_csp_trc_function delin_func = av_csp_trc_func_from_id(s->trc);
+    double max = 1.0, scale = 1.0;
+
+    if (trc == s->lut_trc && (trc != AVCOL_TRC_ARIB_STD_B67 || peak == s->lut_peak))
+        return 0;
+
+    if (!lin_func || !delin_func) {
+        av_log(ctx, AV_LOG_ERROR, "Unsupported transfer function '%s'\n",
+               av_color_transfer_name(lin_func ? s->trc : trc));
+        return AVERROR(EINVAL);
     }
 
-    /* pick the brightest component, reducing the value range as necessary
-     * to keep the entire signal in range and preventing discoloration due to
-     * out-of-bounds clipping */
-    sig = FFMAX(FFMAX3(*r_out, *g_out, *b_out), 1e-6);
-    sig_orig = sig;
+    if (!s->lin_lut) {
+        s->lin_lut = av_malloc_array(TONEMAP_LIN_LUT_SIZE + TONEMAP_DELIN_LUT_SIZE,
+                                     sizeof(*s->lin_lut));
+        if (!s->lin_lut)
+            return AVERROR(ENOMEM);
+        s->delin_lut = &s->lin_lut[TONEMAP_LIN_LUT_SIZE];
 
-    switch(s->tonemap) {
-    default:
-    case TONEMAP_NONE:
-        // do nothing
-        break;
-    case TONEMAP_LINEAR:
-        sig = sig * s->param / peak;
-        break;
-    case TONEMAP_GAMMA:
-        sig = sig > 0.05f ? pow(sig / peak, 1.0f / s->param)
-                          : sig * pow(0.05f / peak, 1.0f / s->param) / 0.05f;
-        break;
-    case TONEMAP_CLIP:
-        sig = av_clipf(sig * s->param, 0, 1.0f);
-        break;
-    case TONEMAP_HABLE:
-        sig = hable(sig) / hable(peak);
-        break;
-    case TONEMAP_REINHARD:
-        sig = sig / (sig + s->param) * (peak + s->param) / peak;
-        break;
-    case TONEMAP_MOBIUS:
-        sig = mobius(sig, s->param, peak);
-        break;
+        for (int n = 0; n < TONEMAP_DELIN_LUT_SIZE; n++)
+            s->delin_lut[n] = delin_func(n / (double)(TONEMAP_DELIN_LUT_SIZE - 1));
+    }
+
+    /* linear light is expressed relative to the reference white */
+    if (trc == AVCOL_TRC_SMPTE2084) {
+        max   = 10000.0;
+        scale = 1.0 / REFERENCE_WHITE;
+    } else if (trc == AVCOL_TRC_ARIB_STD_B67) {
+        scale = peak;
+    }
+
+    for (int n = 0; n < TONEMAP_LIN_LUT_SIZE; n++)
+        s->lin_lut[n] = trc_inverse(lin_func, n / (double)(TONEMAP_LIN_LUT_SIZE - 1), max) * scale;
+
+    s->lut_trc  = trc;
+    s->lut_peak = peak;
+
+    return 0;
+}
+
+static int setup_yuv_matrix(AVFilterContext *ctx, const AVFrame *in,
+                            const AVPixFmtDescriptor *desc)
+{
+    TonemapContext *s = ctx->priv;
+    TonemapYUVParams *p = &s->yuv;
+    const AVLumaCoefficients *coeffs = s->coeffs;
+    const int depth = s->depth;
+    double rgb2yuv[3][3], yuv2rgb[3][3];
+    int yoff, yrange, crange;
+
+    if (!coeffs) {
+        av_log(ctx, AV_LOG_WARNING, "Unknown color space, assuming BT.2020\n");
+        coeffs = av_csp_luma_coeffs_from_avcsp(AVCOL_SPC_BT2020_NCL);
     }
 
-    /* apply the computed scale factor to the color,
-     * linearly to prevent discoloration */
-    *r_out *= sig / sig_orig;
-    *g_out *= sig / sig_orig;
-    *b_out *= sig / sig_orig;
+    ff_fill_rgb2yuv_table(coeffs, rgb2yuv);
+    ff_matrix_invert_3x3(rgb2yuv, yuv2rgb);
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            p->yuv2rgb[i][j] = yuv2rgb[i][j];
+            s->rgb2yuv[i][j] = rgb2yuv[i][j];
+        }
+        p->rgb2y[i] = rgb2yuv[0][i];
+    }
+
+    if (in->color_range == AVCOL_RANGE_JPEG) {
+        yoff   = 0;
+        yrange = crange = (1 << depth) - 1;
+    } else {
+        yoff   = 16  << (depth - 8);
+        yrange = 219 << (depth - 8);
+        crange = 224 << (depth - 8);
+    }
+
+    p->in_scale[0]   = 1.0f / yrange;
+    p->in_scale[1]   = 1.0f / crange;
+    p->in_offset[0]  = -yoff / (float)yrange;
+    p->in_offset[1]  = -(1 << (depth - 1)) / (float)crange;
+    p->out_scale     = yrange;
+    p->out_offset    = yoff;
+    p->in_shift      = desc->comp[0].shift;
+    p->out_shift     = desc->comp[0].shift;
+    p->out_max       = (1 << depth) - 1;
+    p->lin_lut       = s->lin_lut;
+    p->delin_lut     = s->delin_lut;
+    s->chroma_scale  = crange;
+    s->chroma_offset = 1 << (depth - 1);
+
+    return 0;
 }
 
 typedef struct ThreadData {
     AVFrame *in, *out;
     const AVPixFmtDescriptor *desc;
-    double peak;
+    TonemapParams params;
 } ThreadData;
 
 static int tonemap_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
@@ -187,11 +252,102 @@ static int tonemap_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs
     const AVPixFmtDescriptor *desc = td->desc;
     const int slice_start = (in->height * jobnr) / nb_jobs;
     const int slice_end = (in->height * (jobnr+1)) / nb_jobs;
-    double peak = td->peak;
+    const int map[3] = { desc->comp[0].plane, desc->comp[1].plane, desc->comp[2].plane };
+
+    for (int y = slice_start; y < slice_end; y++) {
+        s->dsp.tonemap[s->tonemap]((float *)(out->data[map[0]] + y * out->linesize[map[0]]),
+                                   (float *)(out->data[map[1]] + y * out->linesize[map[1]]),
+                                   (float *)(out->data[map[2]] + y * out->linesize[map[2]]),
+                                   (const float *)(in->data[map[0]] + y * in->linesize[map[0]]),
+                                   (const float *)(in->data[map[1]] + y * in->linesize[map[1]]),
+                                   (const float *)(in->data[map[2]] + y * in->linesize[map[2]]),
+                                   &td->params, out->width);
+    }
+
+    return 0;
+}
+
+#define COMP_ROW(frame, comp, y) \
+    (uint16_t *)((frame)->data[(comp)->plane] + (comp)->offset + (y) * (frame)->linesize[(comp)->plane])
+
+static void yuv2linear(const TonemapContext *s, float *rgb[3],
+                       const AVFrame *in, const AVPixFmtDescriptor *desc, int y)
+{
+    const uint16_t *src_y = COMP_ROW(in, &desc->comp[0], y);
+    const uint16_t *src_u = COMP_ROW(in, &desc->comp[1], y >> 1);
+    const uint16_t *src_v = COMP_ROW(in, &desc->comp[2], y >> 1);
+    const int w = in->width, wa = w & ~7;
+    const int uv_step = s->semi_planar ? 2 : 1;
+
+    s->dsp.yuv2linear[s->semi_planar](rgb[0], rgb[1], rgb[2], src_y, src_u, src_v,
+                                      &s->yuv, wa);
+    if (wa < w)
+        yuv2linear_row_c(rgb[0] + wa, rgb[1] + wa, rgb[2] + wa, src_y + wa,
+                         src_u + (wa >> 1) * uv_step, src_v + (wa >> 1) * uv_step,
+                         &s->yuv, w - wa, uv_step);
+}
+
+static void linear2yuv(const TonemapContext *s, AVFrame *out,
+                       const AVPixFmtDescriptor *desc, float *rgb[2][3],
+                       int cy, int nb_rows)
+{
+    const AVComponentDescriptor *c[3] = { &desc->comp[0], &desc->comp[1], &desc->comp[2] };
+    const float (*m)[3] = s->rgb2yuv;
+    const int depth = s->depth;
+    const int w = out->width, wa = w & ~7;
+    uint16_t *dst_u = COMP_ROW(out, c[1], cy);
+    uint16_t *dst_v = COMP_ROW(out, c[2], cy);
+
+    for (int i = 0; i < nb_rows; i++) {
+        uint16_t *dst_y = COMP_ROW(out, c[0], 2 * cy + i);
+        float *r = rgb[i][0], *g = rgb[i][1], *b = rgb[i][2];
+
+        s->dsp.linear2y(dst_y, r, g, b, &s->yuv, wa);
+        if (wa < w)
+            linear2y_c(dst_y + wa, r + wa, g + wa, b + wa, &s->yuv, w - wa);
+    }
 
-    for (int y = slice_start; y < slice_end; y++)
-        for (int x = 0; x < out->width; x++)
-            tonemap(s, out, in, desc, x, y, peak);
+    for (int x = 0; x < AV_CEIL_RSHIFT(w, 1); x++) {
+        const int x0 = 2 * x, x1 = FFMIN(2 * x + 1, w - 1);
+        const int i1 = nb_rows - 1;
+        const float r = (rgb[0][0][x0] + rgb[0][0][x1] + rgb[i1][0][x0] + rgb[i1][0][x1]) * 0.25f;
+        const float g = (rgb[0][1][x0] + rgb[0][1][x1] + rgb[i1][1][x0] + rgb[i1][1][x1]) * 0.25f;
+        const float b = (rgb[0][2][x0] + rgb[0][2][x1] + rgb[i1][2][x0] + rgb[i1][2][x1]) * 0.25f;
+        const float u = m[1][0] * r + m[1][1] * g + m[1][2] * b;
+        const float v = m[2][0] * r + m[2][1] * g + m[2][2] * b;
+
+        dst_u[x * (c[1]->step >> 1)] = av_clip_uintp2(lrintf(u * s->chroma_scale + s->chroma_offset), depth) << c[1]->shift;
+        dst_v[x * (c[2]->step >> 1)] = av_clip_uintp2(lrintf(v * s->chroma_scale + s->chroma_offset), depth) << c[2]->shift;
+    }
+}
+
+static int tonemap_yuv_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    TonemapContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in = td->in;
+    AVFrame *out = td->out;
+    const AVPixFmtDescriptor *desc = td->desc;
+    const int height = AV_CEIL_RSHIFT(in->height, 1);
+    const int slice_start = (height * jobnr) / nb_jobs;
+    const int slice_end = (height * (jobnr+1)) / nb_jobs;
+    float *rgb[2][3];
+
+    for (int i = 0; i < 2; i++)
+        for (int p = 0; p < 3; p++)
+            rgb[i][p] = s->rgb_buf + (jobnr * 6 + i * 3 + p) * s->rgb_stride;
+
+    for (int cy = slice_start; cy < slice_end; cy++) {
+        const int nb_rows = FFMIN(2, in->height - 2 * cy);
+
+        for (int i = 0; i < nb_rows; i++) {
+            yuv2linear(s, rgb[i], in, desc, 2 * cy + i);
+            s->dsp.tonemap[s->tonemap](rgb[i][0], rgb[i][1], rgb[i][2],
+                                       rgb[i][0], rgb[i][1], rgb[i][2],
+                                       &td->params, in->width);
+        }
+        linear2yuv(s, out, desc, rgb, cy, nb_rows);
+    }
 
     return 0;
 }
@@ -205,6 +361,8 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
     AVFrame *out;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(link->format);
     const AVPixFmtDescriptor *odesc = av_pix_fmt_desc_get(outlink->format);
+    const int is_float = desc && desc->flags & AV_PIX_FMT_FLAG_FLOAT;
+    enum AVColorTransferCharacteristic trc = in->color_trc;
     int ret, x, y;
     double peak = s->peak;
 
@@ -226,12 +384,21 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
         return ret;
     }
 
-    /* input and output transfer will be linear */
-    if (in->color_trc == AVCOL_TRC_UNSPECIFIED) {
-        av_log(s, AV_LOG_WARNING, "Untagged transfer, assuming linear light\n");
-        out->color_trc = AVCOL_TRC_LINEAR;
-    } else if (in->color_trc != AVCOL_TRC_LINEAR)
-        av_log(s, AV_LOG_WARNING, "Tonemapping works on linear light only\n");
+    if (is_float) {
+        /* input and output transfer will be linear */
+        if (in->color_trc == AVCOL_TRC_UNSPECIFIED) {
+            av_log(s, AV_LOG_WARNING, "Untagged transfer, assuming linear light\n");
+            out->color_trc = AVCOL_TRC_LINEAR;
+        } else if (in->color_trc != AVCOL_TRC_LINEAR)
+            av_log(s, AV_LOG_WARNING, "Tonemapping works on linear light only\n");
+    } else {
+        /* linearize and delinearize through lookup tables */
+        if (trc == AVCOL_TRC_UNSPECIFIED) {
+            av_log(s, AV_LOG_WARNING, "Untagged transfer, assuming SMPTE ST 2084\n");
+            trc = AVCOL_TRC_SMPTE2084;
+        }
+        out->color_trc = s->trc;
+    }
 
     /* read peak from side data if not passed in */
     if (!peak) {
@@ -251,13 +418,32 @@ static int filter_frame(AVFilterLink *link, AVFrame *in)
         s->desat = 0;
     }
 
+    if (!is_float) {
+        if ((ret = build_luts(ctx, trc, peak)) < 0 ||
+            (ret = setup_yuv_matrix(ctx, in, desc)) < 0) {
+            av_frame_free(&in);
+            av_frame_free(&out);
+            return ret;
+        }
+    }
+
     /* do the tone map */
     td.out = out;
     td.in = in;
     td.desc = desc;
-    td.peak = peak;
-    ff_filter_execute(ctx, tonemap_slice, &td, NULL,
-                      FFMIN(in->height, ff_filter_get_nb_threads(ctx)));
+    ff_tonemap_params_init(&td.params, s->tonemap, s->param, peak);
+    td.params.desat = s->desat;
+    if (s->coeffs) {
+        td.params.coeffs[0] = av_q2d(s->coeffs->cr);
+        td.params.coeffs[1] = av_q2d(s->coeffs->cg);
+        td.params.coeffs[2] = av_q2d(s->coeffs->cb);
+    }
+    if (is_float)
+        ff_filter_execute(ctx, tonemap_slice, &td, NULL,
+                          FFMIN(in->height, ff_filter_get_nb_threads(ctx)));
+    else
+        ff_filter_execute(ctx, tonemap_yuv_slice, &td, NULL,
+                          FFMIN(AV_CEIL_RSHIFT(in->height, 1), s->nb_threads));
 
     /* copy/generate alpha if needed */
     if (desc->flags & AV_PIX_FMT_FLAG_ALPHA && odesc->flags & AV_PIX_FMT_FLAG_ALPHA) {
@@ -294,6 +480,10 @@ static const AVOption tonemap_options[] = {
     { "param",        "tonemap parameter", OFFSET(param), AV_OPT_TYPE_DOUBLE, {.dbl = NAN}, DBL_MIN, DBL_MAX, FLAGS },
     { "desat",        "desaturation strength", OFFSET(desat), AV_OPT_TYPE_DOUBLE, {.dbl = 2}, 0, DBL_MAX, FLAGS },
     { "peak",         "signal peak override", OFFSET(peak), AV_OPT_TYPE_DOUBLE, {.dbl = 0}, 0, DBL_MAX, FLAGS },
+    { "transfer",     "output transfer for YUV input", OFFSET(trc), AV_OPT_TYPE_INT, {.i64 = AVCOL_TRC_BT709}, 0, AVCOL_TRC_NB - 1, FLAGS, "transfer" },
+    { "t",            "output transfer for YUV input", OFFSET(trc), AV_OPT_TYPE_INT, {.i64 = AVCOL_TRC_BT709}, 0, AVCOL_TRC_NB - 1, FLAGS, "transfer" },
+    {     "bt709",    0, 0, AV_OPT_TYPE_CONST, {.i64 = AVCOL_TRC_BT709},           0, 0, FLAGS, "transfer" },
+    {     "bt2020",   0, 0, AV_OPT_TYPE_CONST, {.i64 = AVCOL_TRC_BT2020_10},       0, 0, FLAGS, "transfer" },
     { NULL }
 };
 
@@ -304,6 +494,7 @@ static const AVFilterPad tonemap_inputs[] = {
         .name         = "default",
         .type         = AVMEDIA_TYPE_VIDEO,
         .filter_frame = filter_frame,
+        .config_props = config_input,
     },
 };
 
@@ -318,10 +509,12 @@ const AVFilter ff_vf_tonemap = {
     .name            = "tonemap",
     .description     = NULL_IF_CONFIG_SMALL("Conversion to/from different dynamic ranges."),
     .init            = init,
+    .uninit          = uninit,
     .priv_size       = sizeof(TonemapContext),
     .priv_class      = &tonemap_class,
     FILTER_INPUTS(tonemap_inputs),
     FILTER_OUTPUTS(tonemap_outputs),
-    FILTER_PIXFMTS(AV_PIX_FMT_GBRPF32, AV_PIX_FMT_GBRAPF32),
+    FILTER_PIXFMTS(AV_PIX_FMT_GBRPF32, AV_PIX_FMT_GBRAPF32,
+                   AV_PIX_FMT_YUV420P10, AV_PIX_FMT_P010),
     .flags           = AVFILTER_FLAG_SLICE_THREADS,
 };
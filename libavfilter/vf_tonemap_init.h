@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2017 Vittorio Giovara <vittorio.giovara@gmail.com>
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_TONEMAP_INIT_H
+#define AVFILTER_TONEMAP_INIT_H
+
+#include <math.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "tonemap.h"
+
+static av_always_inline float hable(float in)
+{
+    float a = 0.15f, b = 0.50f, c = 0.10f, d = 0.20f, e = 0.02f, f = 0.30f;
+    return (in * (in * a + b * c) + d * e) / (in * (in * a + b) + d * f) - e / f;
+}
+
+/**
+ * Derive the per-algorithm constants of p from param and peak.
+ */
+static av_unused void ff_tonemap_params_init(TonemapParams *p, enum TonemapAlgorithm algo,
+                                             double param, double peak)
+{
+    double a, b;
+
+    p->param = param;
+    p->peak  = peak;
+    p->k[0] = p->k[1] = p->k[2] = 0.0f;
+
+    switch (algo) {
+    case TONEMAP_LINEAR:
+        p->k[0] = param / peak;
+        break;
+    case TONEMAP_GAMMA:
+        p->k[0] = 1.0 / param;
+        p->k[1] = 1.0 / peak;
+        p->k[2] = pow(0.05 / peak, 1.0 / param) / 0.05;
+        break;
+    case TONEMAP_REINHARD:
+        p->k[0] = (peak + param) / peak;
+        break;
+    case TONEMAP_HABLE:
+        p->k[0] = 1.0f / hable(peak);
+        break;
+    case TONEMAP_MOBIUS:
+        a = -param * param * (peak - 1.0) / (param * param - 2.0 * param + peak);
+        b = (param * param - 2.0 * param * peak + peak) / FFMAX(peak - 1.0, 1e-6);
+        p->k[0] = a;
+        p->k[1] = b;
+        p->k[2] = (b * b + 2.0 * b * param + param * param) / (b - a);
+        break;
+    }
+}
+
+#define MIX(x,y,a) (x) * (1 - (a)) + (y) * (a)
+static av_always_inline void tonemap_row_c(float *dst_r, float *dst_g, float *dst_b,
+                                           const float *src_r, const float *src_g,
+                                           const float *src_b, const TonemapParams *p,
+                                           int w, enum TonemapAlgorithm algo)
+{
+    const float desat = p->desat;
+    const float param = p->param;
+    const float k0 = p->k[0], k1 = p->k[1], k2 = p->k[2];
+
+    for (int x = 0; x < w; x++) {
+        float r = src_r[x], g = src_g[x], b = src_b[x];
+        float sig, sig_orig;
+
+        /* desaturate to prevent unnatural colors */
+        if (desat > 0) {
+            float luma = p->coeffs[0] * r + p->coeffs[1] * g + p->coeffs[2] * b;
+            float overbright = FFMAX(luma - desat, 1e-6f) / FFMAX(luma, 1e-6f);
+            r = MIX(r, luma, overbright);
+            g = MIX(g, luma, overbright);
+            b = MIX(b, luma, overbright);
+        }
+
+        /* pick the brightest component, reducing the value range as necessary
+         * to keep the entire signal in range and preventing discoloration due to
+         * out-of-bounds clipping */
+        sig = FFMAX(FFMAX3(r, g, b), 1e-6f);
+        sig_orig = sig;
+
+        switch (algo) {
+        default:
+        case TONEMAP_NONE:
+            // do nothing
+            break;
+        case TONEMAP_LINEAR:
+            sig = sig * k0;
+            break;
+        case TONEMAP_GAMMA:
+            sig = sig > 0.05f ? powf(sig * k1, k0) : sig * k2;
+            break;
+        case TONEMAP_CLIP:
+            sig = av_clipf(sig * param, 0, 1.0f);
+            break;
+        case TONEMAP_HABLE:
+            sig = hable(sig) * k0;
+            break;
+        case TONEMAP_REINHARD:
+            sig = sig / (sig + param) * k0;
+            break;
+        case TONEMAP_MOBIUS:
+            if (sig > param)
+                sig = k2 * (sig + k0) / (sig + k1);
+            break;
+        }
+
+        /* apply the computed scale factor to the color,
+         * linearly to prevent discoloration */
+        if (algo != TONEMAP_NONE) {
+            const float scale = sig / sig_orig;
+            r *= scale;
+            g *= scale;
+            b *= scale;
+        }
+
+        dst_r[x] = r;
+        dst_g[x] = g;
+        dst_b[x] = b;
+    }
+}
+#undef MIX
+
+#define DEFINE_TONEMAP_ROW(name, algo)                                              \
+static void tonemap_##name##_c(float *dst_r, float *dst_g, float *dst_b,            \
+                               const float *src_r, const float *src_g,              \
+                               const float *src_b, const TonemapParams *p, int w)   \
+{                                                                                   \
+    tonemap_row_c(dst_r, dst_g, dst_b, src_r, src_g, src_b, p, w, algo);            \
+}
+
+DEFINE_TONEMAP_ROW(none,     TONEMAP_NONE)
+DEFINE_TONEMAP_ROW(linear,   TONEMAP_LINEAR)
+DEFINE_TONEMAP_ROW(gamma,    TONEMAP_GAMMA)
+DEFINE_TONEMAP_ROW(clip,     TONEMAP_CLIP)
+DEFINE_TONEMAP_ROW(reinhard, TONEMAP_REINHARD)
+DEFINE_TONEMAP_ROW(hable,    TONEMAP_HABLE)
+DEFINE_TONEMAP_ROW(mobius,   TONEMAP_MOBIUS)
+
+/**
+ * Linearly interpolated lookup of v in [0, 1] into a table of size entries.
+ */
+static av_always_inline float tonemap_lut_interp(const float *lut, int size, float v)
+{
+    float t = av_clipf(v * (size - 1), 0.0f, size - 1);
+    int i = FFMIN((int)t, size - 2);
+    float f = t - i;
+    return lut[i] + f * (lut[i + 1] - lut[i]);
+}
+
+static av_always_inline void yuv2linear_row_c(float *dst_r, float *dst_g, float *dst_b,
+                                              const uint16_t *src_y, const uint16_t *src_u,
+                                              const uint16_t *src_v, const TonemapYUVParams *p,
+                                              int w, int uv_step)
+{
+    const float (*m)[3] = p->yuv2rgb;
+    const int shift = p->in_shift;
+
+    for (int x = 0; x < w; x++) {
+        const int xc = (x >> 1) * uv_step;
+        float y = (src_y[x]  >> shift) * p->in_scale[0] + p->in_offset[0];
+        float u = (src_u[xc] >> shift) * p->in_scale[1] + p->in_offset[1];
+        float v = (src_v[xc] >> shift) * p->in_scale[1] + p->in_offset[1];
+
+        dst_r[x] = tonemap_lut_interp(p->lin_lut, TONEMAP_LIN_LUT_SIZE,
+                                      m[0][0] * y + m[0][1] * u + m[0][2] * v);
+        dst_g[x] = tonemap_lut_interp(p->lin_lut, TONEMAP_LIN_LUT_SIZE,
+                                      m[1][0] * y + m[1][1] * u + m[1][2] * v);
+        dst_b[x] = tonemap_lut_interp(p->lin_lut, TONEMAP_LIN_LUT_SIZE,
+                                      m[2][0] * y + m[2][1] * u + m[2][2] * v);
+    }
+}
+
+static void yuv2linear_planar_c(float *dst_r, float *dst_g, float *dst_b,
+                                const uint16_t *src_y, const uint16_t *src_u,
+                                const uint16_t *src_v, const TonemapYUVParams *p, int w)
+{
+    yuv2linear_row_c(dst_r, dst_g, dst_b, src_y, src_u, src_v, p, w, 1);
+}
+
+static void yuv2linear_nv_c(float *dst_r, float *dst_g, float *dst_b,
+                            const uint16_t *src_y, const uint16_t *src_u,
+                            const uint16_t *src_v, const TonemapYUVParams *p, int w)
+{
+    yuv2linear_row_c(dst_r, dst_g, dst_b, src_y, src_u, src_u + 1, p, w, 2);
+}
+
+static void linear2y_c(uint16_t *dst_y, float *r, float *g, float *b,
+                       const TonemapYUVParams *p, int w)
+{
+    for (int x = 0; x < w; x++) {
+        float y;
+
+        r[x] = tonemap_lut_interp(p->delin_lut, TONEMAP_DELIN_LUT_SIZE, r[x]);
+        g[x] = tonemap_lut_interp(p->delin_lut, TONEMAP_DELIN_LUT_SIZE, g[x]);
+        b[x] = tonemap_lut_interp(p->delin_lut, TONEMAP_DELIN_LUT_SIZE, b[x]);
+
+        y = p->rgb2y[0] * r[x] + p->rgb2y[1] * g[x] + p->rgb2y[2] * b[x];
+        dst_y[x] = av_clip(lrintf(y * p->out_scale + p->out_offset), 0, p->out_max) << p->out_shift;
+    }
+}
+
+static av_unused void ff_tonemap_init(TonemapDSPContext *dsp)
+{
+    dsp->yuv2linear[0] = yuv2linear_planar_c;
+    dsp->yuv2linear[1] = yuv2linear_nv_c;
+    dsp->linear2y      = linear2y_c;
+
+    dsp->tonemap[TONEMAP_NONE]     = tonemap_none_c;
+    dsp->tonemap[TONEMAP_LINEAR]   = tonemap_linear_c;
+    dsp->tonemap[TONEMAP_GAMMA]    = tonemap_gamma_c;
+    dsp->tonemap[TONEMAP_CLIP]     = tonemap_clip_c;
+    dsp->tonemap[TONEMAP_REINHARD] = tonemap_reinhard_c;
+    dsp->tonemap[TONEMAP_HABLE]    = tonemap_hable_c;
+    dsp->tonemap[TONEMAP_MOBIUS]   = tonemap_mobius_c;
+#if ARCH_X86
+    ff_tonemap_init_x86(dsp);
+#endif
+}
+
+#endif /* AVFILTER_TONEMAP_INIT_H */
@@ -44,6 +44,7 @@
 #include "internal.h"
 #include "video.h"
 #include "v360.h"
+#include "warp.h"
 
 typedef struct ThreadData {
     AVFrame *in;
@@ -253,24 +254,6 @@ static int query_formats(AVFilterContext *ctx)
     return ff_set_common_formats_from_list(ctx, s->alpha ? alpha_pix_fmts : pix_fmts);
 }
 
-#define DEFINE_REMAP1_LINE(bits, div)                                                    \
-static void remap1_##bits##bit_line_c(uint8_t *dst, int width, const uint8_t *const src, \
-                                      ptrdiff_t in_linesize,                             \
-                                      const int16_t *const u, const int16_t *const v,    \
-                                      const int16_t *const ker)                          \
-{                                                                                        \
-    const uint##bits##_t *const s = (const uint##bits##_t *const)src;                    \
-    uint##bits##_t *d = (uint##bits##_t *)dst;                                           \
-                                                                                         \
-    in_linesize /= div;                                                                  \
-                                                                                         \
-    for (int x = 0; x < width; x++)                                                      \
-        d[x] = s[v[x] * in_linesize + u[x]];                                             \
-}
-
-DEFINE_REMAP1_LINE( 8, 1)
-DEFINE_REMAP1_LINE(16, 2)
-
 /**
  * Generate remapping function with a given window size and pixel depth.
  *
@@ -333,65 +316,26 @@ DEFINE_REMAP(2, 16)
 DEFINE_REMAP(3, 16)
 DEFINE_REMAP(4, 16)
 
-#define DEFINE_REMAP_LINE(ws, bits, div)                                                      \
-static void remap##ws##_##bits##bit_line_c(uint8_t *dst, int width, const uint8_t *const src, \
-                                           ptrdiff_t in_linesize,                             \
-                                           const int16_t *const u, const int16_t *const v,    \
-                                           const int16_t *const ker)                          \
-{                                                                                             \
-    const uint##bits##_t *const s = (const uint##bits##_t *const)src;                         \
-    uint##bits##_t *d = (uint##bits##_t *)dst;                                                \
-                                                                                              \
-    in_linesize /= div;                                                                       \
-                                                                                              \
-    for (int x = 0; x < width; x++) {                                                         \
-        const int16_t *const uu = u + x * ws * ws;                                            \
-        const int16_t *const vv = v + x * ws * ws;                                            \
-        const int16_t *const kker = ker + x * ws * ws;                                        \
-        int tmp = 0;                                                                          \
-                                                                                              \
-        for (int i = 0; i < ws; i++) {                                                        \
-            const int iws = i * ws;                                                           \
-            for (int j = 0; j < ws; j++) {                                                    \
-                tmp += kker[iws + j] * s[vv[iws + j] * in_linesize + uu[iws + j]];            \
-            }                                                                                 \
-        }                                                                                     \
-                                                                                              \
-        d[x] = av_clip_uint##bits(tmp >> 14);                                                 \
-    }                                                                                         \
-}
-
-DEFINE_REMAP_LINE(2,  8, 1)
-DEFINE_REMAP_LINE(3,  8, 1)
-DEFINE_REMAP_LINE(4,  8, 1)
-DEFINE_REMAP_LINE(2, 16, 2)
-DEFINE_REMAP_LINE(3, 16, 2)
-DEFINE_REMAP_LINE(4, 16, 2)
-
 void ff_v360_init(V360Context *s, int depth)
 {
     switch (s->interp) {
     case NEAREST:
-        s->remap_line = depth <= 8 ? remap1_8bit_line_c : remap1_16bit_line_c;
+        s->remap_line = ff_warp_get_line_fn(1, depth);
         break;
     case BILINEAR:
-        s->remap_line = depth <= 8 ? remap2_8bit_line_c : remap2_16bit_line_c;
+        s->remap_line = ff_warp_get_line_fn(2, depth);
         break;
     case LAGRANGE9:
-        s->remap_line = depth <= 8 ? remap3_8bit_line_c : remap3_16bit_line_c;
+        s->remap_line = ff_warp_get_line_fn(3, depth);
         break;
     case BICUBIC:
     case LANCZOS:
     case SPLINE16:
     case GAUSSIAN:
     case MITCHELL:
-        s->remap_line = depth <= 8 ? remap4_8bit_line_c : remap4_16bit_line_c;
+        s->remap_line = ff_warp_get_line_fn(4, depth);
         break;
     }
-
-#if ARCH_X86
-    ff_v360_init_x86(s, depth);
-#endif
 }
 
 /**
@@ -27,6 +27,9 @@
 
 #include <float.h>
 
+#include "config.h"
+
+#include "libavutil/attributes.h"
 #include "libavutil/avstring.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
@@ -36,8 +39,9 @@
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
+#include "vif.h"
 
-#define NUM_DATA_BUFS 13
+#define NUM_DATA_BUFS 10
 
 typedef struct VIFContext {
     const AVClass *class;
@@ -49,12 +53,15 @@ typedef struct VIFContext {
     float factor;
     float *data_buf[NUM_DATA_BUFS];
     float **temp;
+    float *row_num;
+    float *row_den;
     float *ref_data;
     float *main_data;
     double vif_sum[4];
     double vif_min[4];
     double vif_max[4];
     uint64_t nb_frames;
+    VIFDSPContext dsp;
 } VIFContext;
 
 #define OFFSET(x) offsetof(VIFContext, x)
@@ -88,6 +95,7 @@ static const float vif_filter1d_table[4][17] =
 };
 
 typedef struct ThreadData {
+    const VIFDSPContext *dsp;
     const float *filter;
     const float *src;
     float *dst;
@@ -98,6 +106,55 @@ typedef struct ThreadData {
     float **temp;
 } ThreadData;
 
+typedef struct SquaresData {
+    const float *x, *y;
+    float *xx, *yy, *xy;
+    int w, h;
+} SquaresData;
+
+typedef struct StatisticData {
+    const float *mu1, *mu2;
+    const float *xx_filt, *yy_filt, *xy_filt;
+    float *row_num, *row_den;
+    int w, h;
+} StatisticData;
+
+static void filter_v_c(float *dst, const float *const *src,
+                       const float *filter, int filt_w, int w)
+{
+    for (int j = 0; j < w; j++) {
+        float sum = 0.f;
+
+        for (int k = 0; k < filt_w; k++)
+            sum += filter[k] * src[k][j];
+
+        dst[j] = sum;
+    }
+}
+
+static void filter_h_c(float *dst, const float *src,
+                       const float *filter, int filt_w, int w)
+{
+    for (int j = 0; j < w; j++) {
+        float sum = 0.f;
+
+        for (int k = 0; k < filt_w; k++)
+            sum += filter[k] * src[j + k];
+
+        dst[j] = sum;
+    }
+}
+
+av_cold void ff_vif_init_dsp(VIFDSPContext *dsp)
+{
+    dsp->filter_v = filter_v_c;
+    dsp->filter_h = filter_h_c;
+
+#if ARCH_X86
+    ff_vif_init_x86(dsp);
+#endif
+}
+
 static void vif_dec2(const float *src, float *dst, int w, int h,
                      int src_stride, int dst_stride)
 {
@@ -109,30 +166,36 @@ static void vif_dec2(const float *src, float *dst, int w, int h,
     }
 }
 
-static void vif_statistic(const float *mu1_sq, const float *mu2_sq,
-                          const float *mu1_mu2, const float *xx_filt,
-                          const float *yy_filt, const float *xy_filt,
-                          float *num, float *den, int w, int h)
+static int vif_statistic(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
+    StatisticData *td = arg;
     static const float sigma_nsq = 2;
-    float mu1_sq_val, mu2_sq_val, mu1_mu2_val, xx_filt_val, yy_filt_val, xy_filt_val;
+    float mu1_val, mu2_val, mu1_sq_val, mu2_sq_val, mu1_mu2_val, xx_filt_val, yy_filt_val, xy_filt_val;
     float sigma1_sq, sigma2_sq, sigma12, g, sv_sq, eps = 1.0e-10f;
     float gain_limit = 100.f;
     float num_val, den_val;
-    float accum_num = 0.0f;
-    float accum_den = 0.0f;
+    const int w = td->w;
+    const int slice_start = (td->h * jobnr) / nb_jobs;
+    const int slice_end = (td->h * (jobnr+1)) / nb_jobs;
 
-    for (int i = 0; i < h; i++) {
+    for (int i = slice_start; i < slice_end; i++) {
+        const float *mu1 = td->mu1 + i * w;
+        const float *mu2 = td->mu2 + i * w;
+        const float *xx_filt = td->xx_filt + i * w;
+        const float *yy_filt = td->yy_filt + i * w;
+        const float *xy_filt = td->xy_filt + i * w;
         float accum_inner_num = 0.f;
         float accum_inner_den = 0.f;
 
         for (int j = 0; j < w; j++) {
-            mu1_sq_val  = mu1_sq[i * w + j];
-            mu2_sq_val  = mu2_sq[i * w + j];
-            mu1_mu2_val = mu1_mu2[i * w + j];
-            xx_filt_val = xx_filt[i * w + j];
-            yy_filt_val = yy_filt[i * w + j];
-            xy_filt_val = xy_filt[i * w + j];
+            mu1_val     = mu1[j];
+            mu2_val     = mu2[j];
+            mu1_sq_val  = mu1_val * mu1_val;
+            mu2_sq_val  = mu2_val * mu2_val;
+            mu1_mu2_val = mu1_val * mu2_val;
+            xx_filt_val = xx_filt[j];
+            yy_filt_val = yy_filt[j];
+            xy_filt_val = xy_filt[j];
 
             sigma1_sq = xx_filt_val - mu1_sq_val;
             sigma2_sq = yy_filt_val - mu2_sq_val;
@@ -174,18 +237,28 @@ static void vif_statistic(const float *mu1_sq, const float *mu2_sq,
             accum_inner_den += den_val;
         }
 
-        accum_num += accum_inner_num;
-        accum_den += accum_inner_den;
+        /* summed up in line order afterwards, so the result does not
+         * depend on the number of threads */
+        td->row_num[i] = accum_inner_num;
+        td->row_den[i] = accum_inner_den;
     }
 
-    num[0] = accum_num;
-    den[0] = accum_den;
+    return 0;
 }
 
-static void vif_xx_yy_xy(const float *x, const float *y, float *xx, float *yy,
-                         float *xy, int w, int h)
+static int vif_xx_yy_xy(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
-    for (int i = 0; i < h; i++) {
+    SquaresData *td = arg;
+    const int w = td->w;
+    const int slice_start = (td->h * jobnr) / nb_jobs;
+    const int slice_end = (td->h * (jobnr+1)) / nb_jobs;
+    const float *x = td->x + slice_start * w;
+    const float *y = td->y + slice_start * w;
+    float *xx = td->xx + slice_start * w;
+    float *yy = td->yy + slice_start * w;
+    float *xy = td->xy + slice_start * w;
+
+    for (int i = slice_start; i < slice_end; i++) {
         for (int j = 0; j < w; j++) {
             float xval = x[j];
             float yval = y[j];
@@ -204,11 +277,19 @@ static void vif_xx_yy_xy(const float *x, const float *y, float *xx, float *yy,
         x  += w;
         y  += w;
     }
+
+    return 0;
+}
+
+static av_always_inline int mirror(int i, int n)
+{
+    return i < 0 ? -i : (i >= n ? 2 * n - i - 1 : i);
 }
 
 static int vif_filter1d(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
 {
     ThreadData *td = arg;
+    const VIFDSPContext *dsp = td->dsp;
     const float *filter = td->filter;
     const float *src = td->src;
     float *dst = td->dst;
@@ -217,67 +298,34 @@ static int vif_filter1d(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
     int src_stride = td->src_stride;
     int dst_stride = td->dst_stride;
     int filt_w = td->filter_width;
+    const int radius = filt_w / 2;
     float *temp = td->temp[jobnr];
     const int slice_start = (h * jobnr) / nb_jobs;
     const int slice_end = (h * (jobnr+1)) / nb_jobs;
 
     for (int i = slice_start; i < slice_end; i++) {
-        /** Vertical pass. */
-        for (int j = 0; j < w; j++) {
-            float sum = 0.f;
+        const float *lines[17];
+        float *dst_line = dst + i * dst_stride;
 
-            if (i >= filt_w / 2 && i < h - filt_w / 2 - 1) {
-                for (int filt_i = 0; filt_i < filt_w; filt_i++) {
-                    const float filt_coeff = filter[filt_i];
-                    float img_coeff;
-                    int ii = i - filt_w / 2 + filt_i;
-
-                    img_coeff = src[ii * src_stride + j];
-                    sum += filt_coeff * img_coeff;
-                }
-            } else {
-                for (int filt_i = 0; filt_i < filt_w; filt_i++) {
-                    const float filt_coeff = filter[filt_i];
-                    int ii = i - filt_w / 2 + filt_i;
-                    float img_coeff;
-
-                    ii = ii < 0 ? -ii : (ii >= h ? 2 * h - ii - 1 : ii);
-
-                    img_coeff = src[ii * src_stride + j];
-                    sum += filt_coeff * img_coeff;
-                }
-            }
-
-            temp[j] = sum;
-        }
+        /** Vertical pass. */
+        for (int k = 0; k < filt_w; k++)
+            lines[k] = src + mirror(i - radius + k, h) * src_stride;
+        dsp->filter_v(temp, lines, filter, filt_w, w);
 
         /** Horizontal pass. */
+        if (w > 2 * radius)
+            dsp->filter_h(dst_line + radius, temp, filter, filt_w, w - 2 * radius);
+
         for (int j = 0; j < w; j++) {
             float sum = 0.f;
 
-            if (j >= filt_w / 2 && j < w - filt_w / 2 - 1) {
-                for (int filt_j = 0; filt_j < filt_w; filt_j++) {
-                    const float filt_coeff = filter[filt_j];
-                    int jj = j - filt_w / 2 + filt_j;
-                    float img_coeff;
-
-                    img_coeff = temp[jj];
-                    sum += filt_coeff * img_coeff;
-                }
-            } else {
-                for (int filt_j = 0; filt_j < filt_w; filt_j++) {
-                    const float filt_coeff = filter[filt_j];
-                    int jj = j - filt_w / 2 + filt_j;
-                    float img_coeff;
-
-                    jj = jj < 0 ? -jj : (jj >= w ? 2 * w - jj - 1 : jj);
-
-                    img_coeff = temp[jj];
-                    sum += filt_coeff * img_coeff;
-                }
-            }
+            if (j == radius && w > 2 * radius)
+                j = w - radius;
 
-            dst[i * dst_stride + j] = sum;
+            for (int filt_j = 0; filt_j < filt_w; filt_j++)
+                sum += filter[filt_j] * temp[mirror(j - radius + filt_j, w)];
+
+            dst_line[j] = sum;
         }
     }
 
@@ -290,7 +338,10 @@ static int compute_vif2(AVFilterContext *ctx,
                         float *const data_buf[NUM_DATA_BUFS], float **temp,
                         int gnb_threads)
 {
+    VIFContext *s = ctx->priv;
     ThreadData td;
+    SquaresData sqd;
+    StatisticData sd;
     float *ref_scale = data_buf[0];
     float *main_scale = data_buf[1];
     float *ref_sq = data_buf[2];
@@ -298,20 +349,16 @@ static int compute_vif2(AVFilterContext *ctx,
     float *ref_main = data_buf[4];
     float *mu1 = data_buf[5];
     float *mu2 = data_buf[6];
-    float *mu1_sq = data_buf[7];
-    float *mu2_sq = data_buf[8];
-    float *mu1_mu2 = data_buf[9];
-    float *ref_sq_filt = data_buf[10];
-    float *main_sq_filt = data_buf[11];
-    float *ref_main_filt = data_buf[12];
+    float *ref_sq_filt = data_buf[7];
+    float *main_sq_filt = data_buf[8];
+    float *ref_main_filt = data_buf[9];
 
     float *curr_ref_scale = (float *)ref;
     float *curr_main_scale = (float *)main;
     int curr_ref_stride = ref_stride;
     int curr_main_stride = main_stride;
 
-    float num = 0.f;
-    float den = 0.f;
+    td.dsp = &s->dsp;
 
     for (int scale = 0; scale < 4; scale++) {
         const float *filter = vif_filter1d_table[scale];
@@ -319,6 +366,8 @@ static int compute_vif2(AVFilterContext *ctx,
         const int nb_threads = FFMIN(h, gnb_threads);
         int buf_valid_w = w;
         int buf_valid_h = h;
+        float num = 0.f;
+        float den = 0.f;
 
         td.filter = filter;
         td.filter_width = filter_width;
@@ -368,9 +417,14 @@ static int compute_vif2(AVFilterContext *ctx,
         td.src_stride = curr_main_stride;
         ff_filter_execute(ctx, vif_filter1d, &td, NULL, nb_threads);
 
-        vif_xx_yy_xy(mu1, mu2, mu1_sq, mu2_sq, mu1_mu2, w, h);
-
-        vif_xx_yy_xy(curr_ref_scale, curr_main_scale, ref_sq, main_sq, ref_main, w, h);
+        sqd.x = curr_ref_scale;
+        sqd.y = curr_main_scale;
+        sqd.xx = ref_sq;
+        sqd.yy = main_sq;
+        sqd.xy = ref_main;
+        sqd.w = w;
+        sqd.h = h;
+        ff_filter_execute(ctx, vif_xx_yy_xy, &sqd, NULL, nb_threads);
 
         td.src = ref_sq;
         td.dst = ref_sq_filt;
@@ -386,8 +440,21 @@ static int compute_vif2(AVFilterContext *ctx,
         td.dst = ref_main_filt;
         ff_filter_execute(ctx, vif_filter1d, &td, NULL, nb_threads);
 
-        vif_statistic(mu1_sq, mu2_sq, mu1_mu2, ref_sq_filt, main_sq_filt,
-                      ref_main_filt, &num, &den, w, h);
+        sd.mu1 = mu1;
+        sd.mu2 = mu2;
+        sd.xx_filt = ref_sq_filt;
+        sd.yy_filt = main_sq_filt;
+        sd.xy_filt = ref_main_filt;
+        sd.row_num = s->row_num;
+        sd.row_den = s->row_den;
+        sd.w = w;
+        sd.h = h;
+        ff_filter_execute(ctx, vif_statistic, &sd, NULL, nb_threads);
+
+        for (int i = 0; i < h; i++) {
+            num += s->row_num[i];
+            den += s->row_den[i];
+        }
 
         score[scale] = den <= FLT_EPSILON ? 1.f : num / den;
     }
@@ -497,6 +564,8 @@ static int config_input_ref(AVFilterLink *inlink)
     s->height = ctx->inputs[0]->h;
     s->nb_threads = ff_filter_get_nb_threads(ctx);
 
+    ff_vif_init_dsp(&s->dsp);
+
     for (int i = 0; i < 4; i++) {
         s->vif_min[i] =  DBL_MAX;
         s->vif_max[i] = -DBL_MAX;
@@ -513,6 +582,12 @@ static int config_input_ref(AVFilterLink *inlink)
     if (!(s->main_data = av_calloc(s->width, s->height * sizeof(float))))
         return AVERROR(ENOMEM);
 
+    if (!(s->row_num = av_calloc(s->height, sizeof(*s->row_num))))
+        return AVERROR(ENOMEM);
+
+    if (!(s->row_den = av_calloc(s->height, sizeof(*s->row_den))))
+        return AVERROR(ENOMEM);
+
     if (!(s->temp = av_calloc(s->nb_threads, sizeof(s->temp[0]))))
         return AVERROR(ENOMEM);
 
@@ -600,6 +675,8 @@ static av_cold void uninit(AVFilterContext *ctx)
 
     av_freep(&s->ref_data);
     av_freep(&s->main_data);
+    av_freep(&s->row_num);
+    av_freep(&s->row_den);
 
     for (int i = 0; i < s->nb_threads && s->temp; i++)
         av_freep(&s->temp[i]);
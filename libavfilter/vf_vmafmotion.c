@@ -24,6 +24,9 @@
  * Calculate VMAF Motion score.
  */
 
+#include "config.h"
+
+#include "libavutil/attributes.h"
 #include "libavutil/file_open.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
@@ -78,128 +81,122 @@ static uint64_t image_sad(const uint16_t *img1, const uint16_t *img2, int w,
     return sum;
 }
 
-static void convolution_x(const uint16_t *filter, int filt_w, const uint16_t *src,
-                          uint16_t *dst, int w, int h, ptrdiff_t _src_stride,
-                          ptrdiff_t _dst_stride)
+static void convolution_x(const uint16_t *filter, const uint16_t *src,
+                          uint16_t *dst, int w)
 {
-    ptrdiff_t src_stride = _src_stride / sizeof(*src);
-    ptrdiff_t dst_stride = _dst_stride / sizeof(*dst);
-    int radius = filt_w / 2;
-    int borders_left = radius;
-    int borders_right = w - (filt_w - radius);
-    int i, j, k;
-    int sum = 0;
-
-    for (i = 0; i < h; i++) {
-        for (j = 0; j < borders_left; j++) {
-            sum = 0;
-            for (k = 0; k < filt_w; k++) {
-                int j_tap = FFABS(j - radius + k);
-                if (j_tap >= w) {
-                    j_tap = w - (j_tap - w + 1);
-                }
-                sum += filter[k] * src[i * src_stride + j_tap];
-            }
-            dst[i * dst_stride + j] = sum >> BIT_SHIFT;
-        }
-
-        for (j = borders_left; j < borders_right; j++) {
-            int sum = 0;
-            for (k = 0; k < filt_w; k++) {
-                sum += filter[k] * src[i * src_stride + j - radius + k];
-            }
-            dst[i * dst_stride + j] = sum >> BIT_SHIFT;
-        }
-
-        for (j = borders_right; j < w; j++) {
-            sum = 0;
-            for (k = 0; k < filt_w; k++) {
-                int j_tap = FFABS(j - radius + k);
-                if (j_tap >= w) {
-                    j_tap = w - (j_tap - w + 1);
-                }
-                sum += filter[k] * src[i * src_stride + j_tap];
-            }
-            dst[i * dst_stride + j] = sum >> BIT_SHIFT;
-        }
+    for (int j = 0; j < w; j++) {
+        int sum = 0;
+        for (int k = 0; k < 5; k++)
+            sum += filter[k] * src[j - 2 + k];
+        dst[j] = sum >> BIT_SHIFT;
     }
 }
 
 #define conv_y_fn(type, bits) \
-static void convolution_y_##bits##bit(const uint16_t *filter, int filt_w, \
-                                      const uint8_t *_src, uint16_t *dst, \
-                                      int w, int h, ptrdiff_t _src_stride, \
-                                      ptrdiff_t _dst_stride) \
+static void convolution_y_##bits##bit(const uint16_t *filter, \
+                                      const uint8_t *const *_src, \
+                                      uint16_t *dst, int w) \
 { \
-    const type *src = (const type *) _src; \
-    ptrdiff_t src_stride = _src_stride / sizeof(*src); \
-    ptrdiff_t dst_stride = _dst_stride / sizeof(*dst); \
-    int radius = filt_w / 2; \
-    int borders_top = radius; \
-    int borders_bottom = h - (filt_w - radius); \
-    int i, j, k; \
-    int sum = 0; \
+    const type *const *src = (const type *const *)_src; \
     \
-    for (i = 0; i < borders_top; i++) { \
-        for (j = 0; j < w; j++) { \
-            sum = 0; \
-            for (k = 0; k < filt_w; k++) { \
-                int i_tap = FFABS(i - radius + k); \
-                if (i_tap >= h) { \
-                    i_tap = h - (i_tap - h + 1); \
-                } \
-                sum += filter[k] * src[i_tap * src_stride + j]; \
-            } \
-            dst[i * dst_stride + j] = sum >> bits; \
-        } \
-    } \
-    for (i = borders_top; i < borders_bottom; i++) { \
-        for (j = 0; j < w; j++) { \
-            sum = 0; \
-            for (k = 0; k < filt_w; k++) { \
-                sum += filter[k] * src[(i - radius + k) * src_stride + j]; \
-            } \
-            dst[i * dst_stride + j] = sum >> bits; \
-        } \
-    } \
-    for (i = borders_bottom; i < h; i++) { \
-        for (j = 0; j < w; j++) { \
-            sum = 0; \
-            for (k = 0; k < filt_w; k++) { \
-                int i_tap = FFABS(i - radius + k); \
-                if (i_tap >= h) { \
-                    i_tap = h - (i_tap - h + 1); \
-                } \
-                sum += filter[k] * src[i_tap * src_stride + j]; \
-            } \
-            dst[i * dst_stride + j] = sum >> bits; \
-        } \
+    for (int j = 0; j < w; j++) { \
+        int sum = 0; \
+        for (int k = 0; k < 5; k++) \
+            sum += filter[k] * src[k][j]; \
+        dst[j] = sum >> bits; \
     } \
 }
 
 conv_y_fn(uint8_t, 8)
 conv_y_fn(uint16_t, 10)
 
-static void vmafmotiondsp_init(VMAFMotionDSPContext *dsp, int bpp) {
+av_cold void ff_vmafmotion_init_dsp(VMAFMotionDSPContext *dsp, int bpp)
+{
     dsp->convolution_x = convolution_x;
     dsp->convolution_y = bpp == 10 ? convolution_y_10bit : convolution_y_8bit;
     dsp->sad = image_sad;
+
+#if ARCH_X86
+    ff_vmafmotion_init_x86(dsp, bpp);
+#endif
+}
+
+static av_always_inline int mirror(int i, int n)
+{
+    i = FFABS(i);
+    return i >= n ? n - (i - n + 1) : i;
+}
+
+typedef struct ThreadData {
+    VMAFMotionData *s;
+    const AVFrame *ref;
+} ThreadData;
+
+static int blur_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ThreadData *td = arg;
+    VMAFMotionData *s = td->s;
+    const AVFrame *ref = td->ref;
+    const int w = s->width, h = s->height;
+    const int slice_start = (h *  jobnr     ) / nb_jobs;
+    const int slice_end   = (h * (jobnr + 1)) / nb_jobs;
+    ptrdiff_t stride = s->stride / sizeof(uint16_t);
+    uint16_t *dst  = s->blur_data[0];
+    uint16_t *temp = s->temp_data;
+
+    for (int i = slice_start; i < slice_end; i++) {
+        const uint8_t *src[5];
+
+        for (int k = 0; k < 5; k++)
+            src[k] = ref->data[0] + mirror(i - 2 + k, h) * ref->linesize[0];
+        s->vmafdsp.convolution_y(s->filter, src, temp + i * stride, w);
+    }
+
+    /* the horizontal pass only reads the lines of this slice */
+    for (int i = slice_start; i < slice_end; i++) {
+        const uint16_t *src = temp + i * stride;
+        uint16_t *line = dst + i * stride;
+
+        /* SIMD versions may write past the interior, so fix up the
+         * mirrored borders afterwards */
+        if (w > 4)
+            s->vmafdsp.convolution_x(s->filter, src + 2, line + 2, w - 4);
+
+        for (int j = 0; j < w; j++) {
+            int sum = 0;
+
+            if (j == 2 && w > 4)
+                j = w - 2;
+            for (int k = 0; k < 5; k++)
+                sum += s->filter[k] * src[mirror(j - 2 + k, w)];
+            line[j] = sum >> BIT_SHIFT;
+        }
+    }
+
+    if (s->nb_frames)
+        s->job_sad[jobnr] = s->vmafdsp.sad(s->blur_data[1] + slice_start * stride,
+                                           dst + slice_start * stride, w,
+                                           slice_end - slice_start,
+                                           s->stride, s->stride);
+
+    return 0;
 }
 
-double ff_vmafmotion_process(VMAFMotionData *s, AVFrame *ref)
+double ff_vmafmotion_process(AVFilterContext *ctx, VMAFMotionData *s, AVFrame *ref)
 {
+    ThreadData td = { .s = s, .ref = ref };
+    const int nb_jobs = FFMIN(ff_filter_get_nb_threads(ctx), s->height);
     double score;
 
-    s->vmafdsp.convolution_y(s->filter, 5, ref->data[0], s->temp_data,
-                             s->width, s->height, ref->linesize[0], s->stride);
-    s->vmafdsp.convolution_x(s->filter, 5, s->temp_data, s->blur_data[0],
-                             s->width, s->height, s->stride, s->stride);
+    ff_filter_execute(ctx, blur_slice, &td, NULL, nb_jobs);
 
     if (!s->nb_frames) {
         score = 0.0;
     } else {
-        uint64_t sad = s->vmafdsp.sad(s->blur_data[1], s->blur_data[0],
-                                      s->width, s->height, s->stride, s->stride);
+        uint64_t sad = 0;
+
+        for (int i = 0; i < nb_jobs; i++)
+            sad += s->job_sad[i];
         // the output score is always normalized to 8 bits
         score = (double) (sad * 1.0 / (s->width * s->height << (BIT_SHIFT - 8)));
     }
@@ -223,7 +220,7 @@ static void do_vmafmotion(AVFilterContext *ctx, AVFrame *ref)
     VMAFMotionContext *s = ctx->priv;
     double score;
 
-    score = ff_vmafmotion_process(&s->data, ref);
+    score = ff_vmafmotion_process(ctx, &s->data, ref);
     set_meta(&ref->metadata, "lavfi.vmafmotion.score", score);
     if (s->stats_file) {
         fprintf(s->stats_file,
@@ -244,12 +241,16 @@ int ff_vmafmotion_init(VMAFMotionData *s,
 
     s->width = w;
     s->height = h;
-    s->stride = FFALIGN(w * sizeof(uint16_t), 32);
-
-    data_sz = (size_t) s->stride * h;
-    if (!(s->blur_data[0] = av_malloc(data_sz)) ||
-        !(s->blur_data[1] = av_malloc(data_sz)) ||
-        !(s->temp_data    = av_malloc(data_sz))) {
+    /* the SIMD line functions write up to 15 pixels past w, keep that
+     * inside the line so that slices never touch each other's lines */
+    s->stride = FFALIGN((w + 16) * sizeof(uint16_t), 32);
+
+    /* the SIMD line functions read and write a little past the last line */
+    data_sz = (size_t) s->stride * h + 64;
+    if (!(s->blur_data[0] = av_mallocz(data_sz)) ||
+        !(s->blur_data[1] = av_mallocz(data_sz)) ||
+        !(s->temp_data    = av_mallocz(data_sz)) ||
+        !(s->job_sad      = av_calloc(h, sizeof(*s->job_sad)))) {
         return AVERROR(ENOMEM);
     }
 
@@ -257,7 +258,7 @@ int ff_vmafmotion_init(VMAFMotionData *s,
         s->filter[i] = lrint(FILTER_5[i] * (1 << BIT_SHIFT));
     }
 
-    vmafmotiondsp_init(&s->vmafdsp, desc->comp[0].depth);
+    ff_vmafmotion_init_dsp(&s->vmafdsp, desc->comp[0].depth);
 
     return 0;
 }
@@ -294,6 +295,7 @@ double ff_vmafmotion_uninit(VMAFMotionData *s)
     av_free(s->blur_data[0]);
     av_free(s->blur_data[1]);
     av_free(s->temp_data);
+    av_free(s->job_sad);
 
     return s->nb_frames > 0 ? s->motion_sum / s->nb_frames : 0.0;
 }
@@ -364,7 +366,7 @@ const AVFilter ff_vf_vmafmotion = {
     .uninit        = uninit,
     .priv_size     = sizeof(VMAFMotionContext),
     .priv_class    = &vmafmotion_class,
-    .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags         = AVFILTER_FLAG_METADATA_ONLY | AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(vmafmotion_inputs),
     FILTER_OUTPUTS(vmafmotion_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -0,0 +1,38 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_VIF_H
+#define AVFILTER_VIF_H
+
+typedef struct VIFDSPContext {
+    /**
+     * dst[j] = sum(filter[k] * src[k][j]) for k in [0, filt_w), j in [0, w)
+     */
+    void (*filter_v)(float *dst, const float *const *src,
+                     const float *filter, int filt_w, int w);
+    /**
+     * dst[j] = sum(filter[k] * src[j + k]) for k in [0, filt_w), j in [0, w)
+     */
+    void (*filter_h)(float *dst, const float *src,
+                     const float *filter, int filt_w, int w);
+} VIFDSPContext;
+
+void ff_vif_init_dsp(VIFDSPContext *dsp);
+void ff_vif_init_x86(VIFDSPContext *dsp);
+
+#endif /* AVFILTER_VIF_H */
@@ -29,15 +29,24 @@
 typedef struct VMAFMotionDSPContext {
     uint64_t (*sad)(const uint16_t *img1, const uint16_t *img2, int w, int h,
                     ptrdiff_t img1_stride, ptrdiff_t img2_stride);
-    void (*convolution_x)(const uint16_t *filter, int filt_w, const uint16_t *src,
-                          uint16_t *dst, int w, int h, ptrdiff_t src_stride,
-                          ptrdiff_t dst_stride);
-    void (*convolution_y)(const uint16_t *filter, int filt_w, const uint8_t *src,
-                          uint16_t *dst, int w, int h, ptrdiff_t src_stride,
-                          ptrdiff_t dst_stride);
+    /**
+     * Filter one line horizontally with the 5 tap filter, reading
+     * src[-2] .. src[w + 1]. Borders are handled by the caller.
+     * SIMD versions may read and write up to 15 pixels past w.
+     */
+    void (*convolution_x)(const uint16_t *filter, const uint16_t *src,
+                          uint16_t *dst, int w);
+    /**
+     * Filter one line vertically with the 5 tap filter, src holds the
+     * 5 (already mirrored) input lines. SIMD versions may read and
+     * write up to 15 pixels past w.
+     */
+    void (*convolution_y)(const uint16_t *filter, const uint8_t *const *src,
+                          uint16_t *dst, int w);
 } VMAFMotionDSPContext;
 
-void ff_vmafmotion_init_x86(VMAFMotionDSPContext *dsp);
+void ff_vmafmotion_init_dsp(VMAFMotionDSPContext *dsp, int bpp);
+void ff_vmafmotion_init_x86(VMAFMotionDSPContext *dsp, int bpp);
 
 typedef struct VMAFMotionData {
     uint16_t filter[5];
@@ -46,13 +55,14 @@ typedef struct VMAFMotionData {
     ptrdiff_t stride;
     uint16_t *blur_data[2 /* cur, prev */];
     uint16_t *temp_data;
+    uint64_t *job_sad;      ///< SAD of each slice, one entry per line at most
     double motion_sum;
     uint64_t nb_frames;
     VMAFMotionDSPContext vmafdsp;
 } VMAFMotionData;
 
 int ff_vmafmotion_init(VMAFMotionData *data, int w, int h, enum AVPixelFormat fmt);
-double ff_vmafmotion_process(VMAFMotionData *data, AVFrame *frame);
+double ff_vmafmotion_process(AVFilterContext *ctx, VMAFMotionData *data, AVFrame *frame);
 double ff_vmafmotion_uninit(VMAFMotionData *data);
 
 #endif /* AVFILTER_VMAF_MOTION_H */
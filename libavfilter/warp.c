@@ -0,0 +1,333 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Generic coordinate remapping (warping) of planar images
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/error.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "warp.h"
+
+#define DEFINE_REMAP1_LINE(bits, div)                                                    \
+static void remap1_##bits##bit_line_c(uint8_t *dst, int width, const uint8_t *const src, \
+                                      ptrdiff_t in_linesize,                             \
+                                      const int16_t *const u, const int16_t *const v,    \
+                                      const int16_t *const ker)                          \
+{                                                                                        \
+    const uint##bits##_t *const s = (const uint##bits##_t *const)src;                    \
+    uint##bits##_t *d = (uint##bits##_t *)dst;                                           \
+                                                                                         \
+    in_linesize /= div;                                                                  \
+                                                                                         \
+    for (int x = 0; x < width; x++)                                                      \
+        d[x] = s[v[x] * in_linesize + u[x]];                                             \
+}
+
+DEFINE_REMAP1_LINE( 8, 1)
+DEFINE_REMAP1_LINE(16, 2)
+
+#define DEFINE_REMAP_LINE(ws, bits, div)                                                      \
+static void remap##ws##_##bits##bit_line_c(uint8_t *dst, int width, const uint8_t *const src, \
+                                           ptrdiff_t in_linesize,                             \
+                                           const int16_t *const u, const int16_t *const v,    \
+                                           const int16_t *const ker)                          \
+{                                                                                             \
+    const uint##bits##_t *const s = (const uint##bits##_t *const)src;                         \
+    uint##bits##_t *d = (uint##bits##_t *)dst;                                                \
+                                                                                              \
+    in_linesize /= div;                                                                       \
+                                                                                              \
+    for (int x = 0; x < width; x++) {                                                         \
+        const int16_t *const uu = u + x * ws * ws;                                            \
+        const int16_t *const vv = v + x * ws * ws;                                            \
+        const int16_t *const kker = ker + x * ws * ws;                                        \
+        int tmp = 0;                                                                          \
+                                                                                              \
+        for (int i = 0; i < ws; i++) {                                                        \
+            const int iws = i * ws;                                                           \
+            for (int j = 0; j < ws; j++) {                                                    \
+                tmp += kker[iws + j] * s[vv[iws + j] * in_linesize + uu[iws + j]];            \
+            }                                                                                 \
+        }                                                                                     \
+                                                                                              \
+        d[x] = av_clip_uint##bits(tmp >> 14);                                                 \
+    }                                                                                         \
+}
+
+DEFINE_REMAP_LINE(2,  8, 1)
+DEFINE_REMAP_LINE(3,  8, 1)
+DEFINE_REMAP_LINE(4,  8, 1)
+DEFINE_REMAP_LINE(2, 16, 2)
+DEFINE_REMAP_LINE(3, 16, 2)
+DEFINE_REMAP_LINE(4, 16, 2)
+
+ff_warp_line_fn ff_warp_get_line_fn(int ws, int depth)
+{
+    ff_warp_line_fn fn = NULL;
+
+#if ARCH_X86
+    fn = ff_warp_get_line_fn_x86(ws, depth);
+#endif
+    if (fn)
+        return fn;
+
+    switch (ws) {
+    case 1: return depth <= 8 ? remap1_8bit_line_c : remap1_16bit_line_c;
+    case 2: return depth <= 8 ? remap2_8bit_line_c : remap2_16bit_line_c;
+    case 3: return depth <= 8 ? remap3_8bit_line_c : remap3_16bit_line_c;
+    case 4: return depth <= 8 ? remap4_8bit_line_c : remap4_16bit_line_c;
+    }
+
+    return NULL;
+}
+
+/**
+ * Keys cubic convolution kernel.
+ */
+static double cubic_coeff(double d)
+{
+    const double A = -0.60;
+
+    d = fabs(d);
+
+    if (d < 1.0)
+        return 1.0 - (A + 3.0) * d * d + (A + 2.0) * d * d * d;
+    else if (d < 2.0)
+        return -4.0 * A + 8.0 * A * d - 5.0 * A * d * d + A * d * d * d;
+    return 0.0;
+}
+
+static void init_cubic_kernel(WarpContext *s)
+{
+    for (int i = 0; i < WARP_KERNEL_SIZE; i++) {
+        const double d = i / (double)WARP_KERNEL_SIZE;
+        double coeffs[4], sum = 0.0;
+        int isum = 0, center = 0;
+
+        for (int j = 0; j < 4; j++)
+            sum += cubic_coeff(j - d - 1);
+        for (int j = 0; j < 4; j++)
+            coeffs[j] = cubic_coeff(j - d - 1) / sum;
+
+        for (int j = 0; j < 4; j++) {
+            s->kernel[i][j] = lrint(coeffs[j] * (1 << s->coeff_bits));
+            isum += s->kernel[i][j];
+            if (s->kernel[i][j] > s->kernel[i][center])
+                center = j;
+        }
+        /* An 11-bit kernel is off by at most one, which moves flat 8-bit
+         * areas by less than a quarter; keep deeper flat areas flat. */
+        if (s->depth > 8)
+            s->kernel[i][center] += (1 << s->coeff_bits) - isum;
+    }
+}
+
+void ff_warp_init(WarpContext *s, enum WarpInterpolation interp, int depth)
+{
+    static const int window_size[WARP_NB_INTERP] = { 1, 2, 4 };
+
+    s->interp = interp;
+    s->ws     = window_size[interp];
+    s->depth  = depth;
+    /* 8-bit sums must fit in 32 bits, deeper ones are summed in 64 bits */
+    s->coeff_bits = depth <= 8 ? 11 : 14;
+
+    memset(s->kernel, 0, sizeof(s->kernel));
+    if (interp == WARP_BICUBIC)
+        init_cubic_kernel(s);
+
+    s->warp_line = ff_warp_get_line_fn(s->ws, depth);
+}
+
+int ff_warp_map_alloc(const WarpContext *s, WarpMap *map, int width, int height,
+                      int in_w, int in_h)
+{
+    ff_warp_map_free(map);
+
+    if (in_w > INT16_MAX || in_h > INT16_MAX)
+        return AVERROR(EINVAL);
+
+    map->width  = width;
+    map->height = height;
+    map->in_w   = in_w;
+    map->in_h   = in_h;
+    /* SIMD versions read up to 16 pixels past width, these stay zero */
+    map->stride = width + 16;
+    map->x        = av_calloc(2 * map->stride, height * sizeof(*map->x));
+    map->fill     = av_calloc(width, height);
+    map->row_fill = av_calloc(height, 1);
+    if (s->ws > 1)
+        map->phase = av_calloc(2 * width, height * sizeof(*map->phase));
+    if (!map->x || !map->fill || !map->row_fill || (s->ws > 1 && !map->phase)) {
+        ff_warp_map_free(map);
+        return AVERROR(ENOMEM);
+    }
+    map->y = map->x + map->stride * height;
+
+    return 0;
+}
+
+void ff_warp_map_free(WarpMap *map)
+{
+    av_freep(&map->x);
+    av_freep(&map->phase);
+    av_freep(&map->fill);
+    av_freep(&map->row_fill);
+    map->y = NULL;
+}
+
+void ff_warp_map_set_row(const WarpContext *s, WarpMap *map, int y,
+                         const int32_t *pos)
+{
+    const int ws = s->ws;
+    const int off = (ws - 1) >> 1;
+    const int in_w = map->in_w, in_h = map->in_h;
+    int16_t *mx = map->x + y * map->stride;
+    int16_t *my = map->y + y * map->stride;
+    uint16_t *phase = ws > 1 ? map->phase + (size_t)y * 2 * map->width : NULL;
+    uint8_t *fill = map->fill + (size_t)y * map->width;
+    int row_fill = 0;
+
+    for (int x = 0; x < map->width; x++) {
+        const int px = pos[2 * x], py = pos[2 * x + 1];
+
+        /* an unmapped pixel keeps whatever in-range position it held
+         * before, its output is replaced by fill */
+        fill[x] = px == WARP_INVALID;
+        if (fill[x]) {
+            row_fill = 1;
+        } else if (ws == 1) {
+            mx[x] = av_clip((px + WARP_SUBPEL / 2) >> WARP_SUBPEL_BITS, 0, in_w - 1);
+            my[x] = av_clip((py + WARP_SUBPEL / 2) >> WARP_SUBPEL_BITS, 0, in_h - 1);
+        } else {
+            /* windows starting further out only sample the edge pixels */
+            mx[x] = av_clip((px >> WARP_SUBPEL_BITS) - off, -ws, in_w);
+            my[x] = av_clip((py >> WARP_SUBPEL_BITS) - off, -ws, in_h);
+            phase[2 * x    ] = px & (WARP_SUBPEL - 1);
+            phase[2 * x + 1] = py & (WARP_SUBPEL - 1);
+        }
+    }
+
+    map->row_fill[y] = row_fill;
+}
+
+#define DEFINE_INTERP_ROW(bits, sum_t)                                                        \
+static av_always_inline void interp_row_##bits(const WarpContext *s, const WarpMap *map,       \
+                                               int y, uint8_t *dst, const uint8_t *src,        \
+                                               ptrdiff_t in_linesize, int ws)                  \
+{                                                                                              \
+    const uint##bits##_t *const sp = (const uint##bits##_t *)src;                              \
+    uint##bits##_t *d = (uint##bits##_t *)dst;                                                 \
+    const int shift = 2 * s->coeff_bits;                                                       \
+    const int in_w = map->in_w, in_h = map->in_h;                                              \
+    const int16_t *mx = map->x + y * map->stride;                                              \
+    const int16_t *my = map->y + y * map->stride;                                              \
+    const uint16_t *phase = map->phase + (size_t)y * 2 * map->width;                           \
+    const int phase_shift = WARP_SUBPEL_BITS - s->coeff_bits;                                  \
+                                                                                               \
+    in_linesize /= sizeof(*sp);                                                                \
+                                                                                               \
+    for (int x = 0; x < map->width; x++) {                                                     \
+        const uint##bits##_t *row[4];                                                          \
+        int kx[4], ky[4], cu[4];                                                               \
+        sum_t sum = 0;                                                                         \
+                                                                                               \
+        if (ws == 2) {                                                                         \
+            kx[1] = phase[2 * x    ] >> phase_shift;                                           \
+            ky[1] = phase[2 * x + 1] >> phase_shift;                                           \
+            kx[0] = (1 << s->coeff_bits) - kx[1];                                              \
+            ky[0] = (1 << s->coeff_bits) - ky[1];                                              \
+        } else {                                                                               \
+            const int16_t *k = s->kernel[phase[2 * x] >> (WARP_SUBPEL_BITS - WARP_KERNEL_BITS)]; \
+            for (int j = 0; j < 4; j++)                                                        \
+                kx[j] = k[j];                                                                  \
+            k = s->kernel[phase[2 * x + 1] >> (WARP_SUBPEL_BITS - WARP_KERNEL_BITS)];          \
+            for (int i = 0; i < 4; i++)                                                        \
+                ky[i] = k[i];                                                                  \
+        }                                                                                      \
+                                                                                               \
+        if (mx[x] >= 0 && mx[x] <= in_w - ws) {                                                \
+            for (int j = 0; j < ws; j++)                                                       \
+                cu[j] = mx[x] + j;                                                             \
+        } else {                                                                               \
+            for (int j = 0; j < ws; j++)                                                       \
+                cu[j] = av_clip(mx[x] + j, 0, in_w - 1);                                       \
+        }                                                                                      \
+        if (my[x] >= 0 && my[x] <= in_h - ws) {                                                \
+            for (int i = 0; i < ws; i++)                                                       \
+                row[i] = sp + (my[x] + i) * in_linesize;                                       \
+        } else {                                                                               \
+            for (int i = 0; i < ws; i++)                                                       \
+                row[i] = sp + av_clip(my[x] + i, 0, in_h - 1) * in_linesize;                   \
+        }                                                                                      \
+                                                                                               \
+        /* the products are summed exactly and rounded once */                                 \
+        for (int i = 0; i < ws; i++) {                                                         \
+            sum_t tmp = 0;                                                                     \
+            for (int j = 0; j < ws; j++)                                                       \
+                tmp += kx[j] * row[i][cu[j]];                                                  \
+            sum += tmp * ky[i];                                                                \
+        }                                                                                      \
+                                                                                               \
+        d[x] = av_clip_uintp2((sum + ((sum_t)1 << (shift - 1))) >> shift, s->depth);           \
+    }                                                                                          \
+}
+
+DEFINE_INTERP_ROW( 8, int)
+DEFINE_INTERP_ROW(16, int64_t)
+
+void ff_warp_map_apply_row(const WarpContext *s, const WarpMap *map, int y,
+                           uint8_t *dst, const uint8_t *src,
+                           ptrdiff_t src_linesize, int fill)
+{
+    const uint8_t *fill_map = map->fill + (size_t)y * map->width;
+    const int width = map->width;
+
+    if (s->ws == 1)
+        s->warp_line(dst, width, src, src_linesize,
+                     map->x + y * map->stride, map->y + y * map->stride, NULL);
+    else if (s->depth <= 8 && s->ws == 2)
+        interp_row_8(s, map, y, dst, src, src_linesize, 2);
+    else if (s->depth <= 8)
+        interp_row_8(s, map, y, dst, src, src_linesize, 4);
+    else if (s->ws == 2)
+        interp_row_16(s, map, y, dst, src, src_linesize, 2);
+    else
+        interp_row_16(s, map, y, dst, src, src_linesize, 4);
+
+    if (!map->row_fill[y])
+        return;
+
+    for (int x = 0; x < width; x++) {
+        if (!fill_map[x])
+            continue;
+        if (s->depth <= 8)
+            dst[x] = fill;
+        else
+            AV_WN16(dst + 2 * x, fill);
+    }
+}
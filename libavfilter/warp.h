@@ -0,0 +1,123 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Generic coordinate remapping (warping) of planar images
+ */
+
+#ifndef AVFILTER_WARP_H
+#define AVFILTER_WARP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define WARP_SUBPEL_BITS 14
+#define WARP_SUBPEL      (1 << WARP_SUBPEL_BITS)
+
+/**
+ * Sub-pixel phases of the bicubic kernel table.
+ */
+#define WARP_KERNEL_BITS 8
+#define WARP_KERNEL_SIZE (1 << WARP_KERNEL_BITS)
+
+/**
+ * Source position marking an output pixel which is not mapped to the input.
+ */
+#define WARP_INVALID     INT32_MIN
+
+enum WarpInterpolation {
+    WARP_NEAREST,
+    WARP_BILINEAR,
+    WARP_BICUBIC,
+    WARP_NB_INTERP,
+};
+
+/**
+ * Remap one line of pixels.
+ *
+ * For every output pixel, u, v and ker hold a window of ws * ws source
+ * coordinates and 14-bit interpolation weights (ker is unused for ws == 1).
+ * SIMD versions may read u, v and ker for up to 16 pixels past width and
+ * write up to 16 bytes past the end of dst.
+ */
+typedef void (*ff_warp_line_fn)(uint8_t *dst, int width, const uint8_t *const src,
+                                ptrdiff_t in_linesize,
+                                const int16_t *const u, const int16_t *const v,
+                                const int16_t *const ker);
+
+typedef struct WarpContext {
+    int interp;
+    int ws;                                 ///< interpolation window size
+    int depth;
+    int coeff_bits;                         ///< fractional bits of the interpolation weights
+    int16_t kernel[WARP_KERNEL_SIZE][4];    ///< 1-D bicubic weights for each sub-pixel phase
+    ff_warp_line_fn warp_line;
+} WarpContext;
+
+/**
+ * Source positions of a plane. Each output pixel stores the top left
+ * pixel of its window and the sub-pixel phases, from which the
+ * interpolation weights are derived.
+ */
+typedef struct WarpMap {
+    int width, height;
+    int in_w, in_h;                         ///< source plane dimensions
+    size_t stride;                          ///< elements per row of x and y
+    int16_t *x, *y;                         ///< window origin, or the source pixel for ws == 1
+    uint16_t *phase;                        ///< 2 * width * height sub-pixel phases, unused for ws == 1
+    uint8_t *fill;                          ///< width * height, nonzero for unmapped pixels
+    uint8_t *row_fill;                      ///< height, nonzero for rows with unmapped pixels
+} WarpMap;
+
+ff_warp_line_fn ff_warp_get_line_fn(int ws, int depth);
+
+ff_warp_line_fn ff_warp_get_line_fn_x86(int ws, int depth);
+
+void ff_warp_init(WarpContext *s, enum WarpInterpolation interp, int depth);
+
+/**
+ * Allocate map for a plane of the given dimensions, freeing any previous
+ * allocation. All windows start out pointing at the top left source pixel.
+ *
+ * @param in_w source plane width, must not exceed INT16_MAX
+ * @param in_h source plane height, must not exceed INT16_MAX
+ */
+int ff_warp_map_alloc(const WarpContext *s, WarpMap *map, int width, int height,
+                      int in_w, int in_h);
+
+void ff_warp_map_free(WarpMap *map);
+
+/**
+ * Set row y of map from source positions.
+ *
+ * @param pos  width pairs of (x, y) source positions with WARP_SUBPEL_BITS
+ *             fractional bits, or WARP_INVALID as x to output fill instead;
+ *             positions outside the source are clamped to its edges
+ */
+void ff_warp_map_set_row(const WarpContext *s, WarpMap *map, int y,
+                         const int32_t *pos);
+
+/**
+ * Warp row y of map from src into dst.
+ */
+void ff_warp_map_apply_row(const WarpContext *s, const WarpMap *map, int y,
+                           uint8_t *dst, const uint8_t *src,
+                           ptrdiff_t src_linesize, int fill);
+
+#endif /* AVFILTER_WARP_H */
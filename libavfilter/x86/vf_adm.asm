@@ -0,0 +1,199 @@
+;*****************************************************************************
+;* x86-optimized functions for adm filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+dwt_coeffs:   dd 0x3ef746ea, 0x3f5625ef, 0x3e6585f8, 0xbe0483ee ; lo
+              dd 0xbe0483ee, 0xbe6585f8, 0x3f5625ef, 0xbef746ea ; hi
+pf_eps:       times 8 dd 0x0da24260 ; 1e-30
+pf_1:         times 8 dd 1.0
+pf_cos_1deg_sq: times 8 dd 0x3f7fec0a
+pf_1_by_30:   times 8 dd 0x3d088889
+pd_abs_mask:  times 8 dd 0x7fffffff
+
+SECTION .text
+
+; The products are summed in the same order as the C code, with separate
+; multiplies and adds, so the results are bit-exact.
+
+; %1 dst, %2-%5 coefficients, %6-%9 samples, %10 temporary
+%macro DWT_TAPS 10
+    mulps          %1, %2, %6
+    mulps         %10, %3, %7
+    addps          %1, %10
+    mulps         %10, %4, %8
+    addps          %1, %10
+    mulps         %10, %5, %9
+    addps          %1, %10
+%endmacro
+
+%macro LOAD_DWT_COEFFS 0
+%assign i 0
+%rep 8
+    vbroadcastss   m %+ i, [dwt_coeffs + i * 4]
+%assign i i+1
+%endrep
+%endmacro
+
+%if ARCH_X86_64
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+
+;------------------------------------------------------------------------------
+; void ff_adm_dwt_v(float *lo, float *hi, const float *const *src, int w)
+;------------------------------------------------------------------------------
+cglobal adm_dwt_v, 4, 9, 14, lo, hi, src, w, l0, l1, l2, l3, x
+    mov            l0q, [srcq + 0 * gprsize]
+    mov            l1q, [srcq + 1 * gprsize]
+    mov            l2q, [srcq + 2 * gprsize]
+    mov            l3q, [srcq + 3 * gprsize]
+    LOAD_DWT_COEFFS
+    xor             xq, xq
+
+.loop:
+    movu            m8, [l0q + xq]
+    movu            m9, [l1q + xq]
+    movu           m10, [l2q + xq]
+    movu           m11, [l3q + xq]
+    DWT_TAPS       m12, m0, m1, m2, m3, m8, m9, m10, m11, m13
+    movu   [loq + xq], m12
+    DWT_TAPS       m12, m4, m5, m6, m7, m8, m9, m10, m11, m13
+    movu   [hiq + xq], m12
+    add             xq, mmsize
+    sub             wd, mmsize / 4
+    jg .loop
+    RET
+
+;------------------------------------------------------------------------------
+; void ff_adm_decouple(float *r, float *a, float *f, const float *ref,
+;                      const float *dis, ptrdiff_t band_stride,
+;                      const float *factors, int w)
+;------------------------------------------------------------------------------
+
+; %1 band offset, %2 factor index, %3 ref band, %4 dis band
+%macro DECOUPLE_BAND 4
+    addps           m6, %3, [pf_eps]
+    divps           m6, %4, m6
+    maxps           m6, m14, m6          ; k < 0 ? 0 : k
+    minps           m6, m13, m6          ; k > 1 ? 1 : k
+    mulps           m6, %3               ; rst
+    vbroadcastss    m7, [factorsq + 12]
+    mulps           m7, m6               ; rst * gain_limit
+    minps           m8, %4, m7
+    maxps           m9, m7, %4
+    cmpltps        m10, m14, m6          ; rst > 0
+    cmpltps        m11, m6, m14          ; rst < 0
+    blendvps       m12, m6, m8, m10
+    blendvps       m12, m12, m9, m11
+    blendvps       m12, m6, m12, m15
+    movu [rq + %1], m12
+    subps          m12, %4, m12
+    vbroadcastss    m7, [factorsq + %2 * 4]
+    mulps          m12, m7
+    movu [aq + %1], m12
+    andps          m12, [pd_abs_mask]
+    mulps          m12, [pf_1_by_30]
+    movu [fq + %1], m12
+%endmacro
+
+cglobal adm_decouple, 8, 8, 16, r, a, f, ref, dis, bs, factors, w
+    shl            bsq, 2
+    xorps          m14, m14
+    movaps         m13, [pf_1]
+
+.loop:
+    movu            m0, [refq]
+    movu            m1, [refq + bsq]
+    movu            m2, [refq + bsq * 2]
+    movu            m3, [disq]
+    movu            m4, [disq + bsq]
+    movu            m5, [disq + bsq * 2]
+
+    mulps           m6, m0, m3
+    mulps           m7, m1, m4
+    addps           m6, m7               ; ot_dp
+    mulps           m7, m0, m0
+    mulps           m8, m1, m1
+    addps           m7, m8               ; o_mag_sq
+    mulps           m8, m3, m3
+    mulps           m9, m4, m4
+    addps           m8, m9               ; t_mag_sq
+    mulps           m7, [pf_cos_1deg_sq]
+    mulps           m7, m8
+    mulps           m8, m6, m6
+    cmpleps         m7, m8               ; ot_dp^2 >= cos_1deg_sq * o_mag_sq * t_mag_sq
+    cmpleps         m6, m14, m6          ; ot_dp >= 0
+    andps          m15, m6, m7           ; angle_flag
+
+    DECOUPLE_BAND 0,         0, m0, m3
+    DECOUPLE_BAND bsq,       1, m1, m4
+    DECOUPLE_BAND bsq * 2,   2, m2, m5
+
+    add             rq, mmsize
+    add             aq, mmsize
+    add             fq, mmsize
+    add           refq, mmsize
+    add           disq, mmsize
+    sub             wd, mmsize / 4
+    jg .loop
+    RET
+%endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+
+;------------------------------------------------------------------------------
+; void ff_adm_dwt_h(float *lo, float *hi, const float *src, int w)
+;------------------------------------------------------------------------------
+
+; The even and odd samples come out of shufps in the lane order 0 1 4 5 2 3 6 7,
+; which vpermpd restores after the taps.
+cglobal adm_dwt_h, 4, 4, 16, lo, hi, src, w
+    LOAD_DWT_COEFFS
+
+.loop:
+    movu            m8, [srcq - 8]
+    movu            m9, [srcq + 24]
+    shufps         m10, m8, m9, q3131   ; src[2 * j - 1]
+    movu            m8, [srcq]
+    movu            m9, [srcq + 32]
+    shufps         m11, m8, m9, q2020   ; src[2 * j]
+    shufps         m12, m8, m9, q3131   ; src[2 * j + 1]
+    movu            m8, [srcq + 8]
+    movu            m9, [srcq + 40]
+    shufps         m13, m8, m9, q2020   ; src[2 * j + 2]
+
+    DWT_TAPS       m14, m0, m1, m2, m3, m10, m11, m12, m13, m15
+    vpermpd        m14, m14, q3120
+    movu         [loq], m14
+    DWT_TAPS       m14, m4, m5, m6, m7, m10, m11, m12, m13, m15
+    vpermpd        m14, m14, q3120
+    movu         [hiq], m14
+
+    add           srcq, 2 * mmsize
+    add            loq, mmsize
+    add            hiq, mmsize
+    sub             wd, mmsize / 4
+    jg .loop
+    RET
+%endif
+%endif
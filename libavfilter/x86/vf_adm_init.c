@@ -0,0 +1,44 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/adm.h"
+
+void ff_adm_dwt_v_avx(float *lo, float *hi, const float *const *src, int w);
+void ff_adm_dwt_h_avx2(float *lo, float *hi, const float *src, int w);
+void ff_adm_decouple_avx(float *r, float *a, float *f, const float *ref,
+                         const float *dis, ptrdiff_t band_stride,
+                         const float *factors, int w);
+
+av_cold void ff_adm_init_x86(ADMDSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX_FAST(cpu_flags)) {
+        dsp->dwt_v    = ff_adm_dwt_v_avx;
+        dsp->decouple = ff_adm_decouple_avx;
+    }
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        dsp->dwt_h = ff_adm_dwt_h_avx2;
+#endif
+}
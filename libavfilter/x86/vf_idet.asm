@@ -26,7 +26,7 @@
 SECTION .text
 
 ;******************************************************************************
-; 16bit implementation that does 4/8-pixels at a time
+; 16bit implementation that does 8/16-pixels at a time
 
 %macro PABS_DIFF_WD 3    ; a, b, junk   , output=a
   psubusw   %3, %2, %1
@@ -39,7 +39,7 @@ SECTION .text
   paddd     %1, %2
 %endmacro
 
-%macro IDET_FILTER_LINE_16BIT 1   ; %1=increment (4 or 8 words)
+%macro IDET_FILTER_LINE_16BIT 0
 cglobal idet_filter_line_16bit, 4, 5, 8, a, b, c, width, index
     xor       indexq, indexq
 %define m_zero m1
@@ -54,7 +54,7 @@ cglobal idet_filter_line_16bit, 4, 5, 8, a, b, c, width, index
     psubusw   m5, m2, m3             ; ba
 
     movu      m4, [cq + indexq * 2]  ; C
-    add       indexq, %1
+    add       indexq, mmsize / 2
     psubusw   m3, m2                 ; ab
     CMP       indexd, widthd
 
@@ -67,24 +67,28 @@ cglobal idet_filter_line_16bit, 4, 5, 8, a, b, c, width, index
     paddd          m_sum, m5
     jl        .loop_16bit
 
-    HADDD     m_sum, m2
-    movd      eax, m_sum
+    HADDD     m0, m2
+    movd      eax, xm0
     RET
 %endmacro
 
 INIT_XMM sse2
-IDET_FILTER_LINE_16BIT 8
+IDET_FILTER_LINE_16BIT
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+IDET_FILTER_LINE_16BIT
+%endif
 
 ;******************************************************************************
-; SSE2 8-bit implementation that does 16-bytes at a time:
+; 8-bit implementation that does 16/32-bytes at a time:
 
-INIT_XMM sse2
+%macro IDET_FILTER_LINE 0
 cglobal idet_filter_line, 4, 6, 7, a, b, c, width, index, total
     xor       indexq, indexq
     pxor      m0, m0
     pxor      m1, m1
 
-.sse2_loop:
+.loop:
     movu      m2, [bq + indexq*1]  ; B
     movu      m3, [aq + indexq*1]  ; A
     mova      m6, m2
@@ -92,7 +96,7 @@ cglobal idet_filter_line, 4, 6, 7, a, b, c, width, index, total
     psubusb   m5, m2, m3           ; ba
 
     movu      m3, [cq + indexq*1]  ; C
-    add       indexq, 0x10
+    add       indexq, mmsize
     psubusb   m4, m2               ; ab
     CMP       indexd, widthd
 
@@ -103,10 +107,22 @@ cglobal idet_filter_line, 4, 6, 7, a, b, c, width, index, total
     paddq     m0, m4
     psadbw    m5, m3               ; |ba - cb|
     paddq     m1, m5
-    jl       .sse2_loop
+    jl       .loop
 
     paddq     m0, m1
-    movhlps   m1, m0
-    paddq     m0, m1
-    movd      eax, m0
+%if mmsize == 32
+    vextracti128 xm1, m0, 1
+    paddq     xm0, xm1
+%endif
+    movhlps   xm1, xm0
+    paddq     xm0, xm1
+    movd      eax, xm0
     RET
+%endmacro
+
+INIT_XMM sse2
+IDET_FILTER_LINE
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+IDET_FILTER_LINE
+%endif
@@ -58,6 +58,8 @@ static int idet_filter_line_16bit_##KIND(const uint16_t *a, const uint16_t *b, \
 
 FUNC_MAIN_DECL(sse2, 16)
 FUNC_MAIN_DECL_16bit(sse2, 8)
+FUNC_MAIN_DECL(avx2, 32)
+FUNC_MAIN_DECL_16bit(avx2, 16)
 
 #endif
 av_cold void ff_idet_init_x86(IDETContext *idet, int for_16b)
@@ -68,5 +70,8 @@ av_cold void ff_idet_init_x86(IDETContext *idet, int for_16b)
     if (EXTERNAL_SSE2(cpu_flags)) {
         idet->filter_line = for_16b ? (ff_idet_filter_func)idet_filter_line_16bit_sse2 : idet_filter_line_sse2;
     }
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        idet->filter_line = for_16b ? (ff_idet_filter_func)idet_filter_line_16bit_avx2 : idet_filter_line_avx2;
+    }
 #endif // HAVE_X86ASM
 }
@@ -0,0 +1,118 @@
+;*****************************************************************************
+;* x86-optimized functions for tmix filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+; The product sum * weight is below 2^24, so converting it to float is
+; exact and the result matches the C code.
+
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+
+;------------------------------------------------------------------------------
+; void ff_tmix_slide_<bits>(uint8_t *dst, uint32_t *sum, const uint8_t *add,
+;                           const uint8_t *sub, int w, int weight, int max,
+;                           float factor)
+;------------------------------------------------------------------------------
+%macro SLIDE 1 ; bits
+cglobal tmix_slide_%1, 7, 8, 6, dst, sum, new, old, w, weight, pmax, x
+%if WIN64
+    VBROADCASTSS    m3, r7m
+%else
+    VBROADCASTSS    m3, xmm0
+%endif
+    movd           xm4, weightd
+    vpbroadcastd    m4, xm4
+    movd           xm5, pmaxd
+    vpbroadcastd    m5, xm5
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+    sub             wq, mmsize / 4
+    jl .tail
+
+.loop:
+%if %1 == 8
+    pmovzxbd        m0, [newq + xq]
+    pmovzxbd        m1, [oldq + xq]
+%else
+    pmovzxwd        m0, [newq + xq * 2]
+    pmovzxwd        m1, [oldq + xq * 2]
+%endif
+    psubd           m0, m1
+    paddd           m0, [sumq + xq * 4]
+    movu [sumq + xq * 4], m0
+    pmulld          m0, m4
+    cvtdq2ps        m0, m0
+    mulps           m0, m3
+    cvtps2dq        m0, m0
+    pminsd          m0, m5
+    vextracti128   xm1, m0, 1
+    packusdw       xm0, xm1
+%if %1 == 8
+    packuswb       xm0, xm0
+    movq   [dstq + xq], xm0
+%else
+    movu [dstq + xq * 2], xm0
+%endif
+    add             xq, mmsize / 4
+    cmp             xq, wq
+    jle .loop
+
+.tail:
+    add             wq, mmsize / 4
+    cmp             xq, wq
+    jge .end
+.loop_tail:
+%if %1 == 8
+    movzx      weightd, byte [newq + xq]
+    movzx        pmaxd, byte [oldq + xq]
+%else
+    movzx      weightd, word [newq + xq * 2]
+    movzx        pmaxd, word [oldq + xq * 2]
+%endif
+    sub        weightd, pmaxd
+    add        weightd, [sumq + xq * 4]
+    mov [sumq + xq * 4], weightd
+    movd           xm0, weightd
+    pmulld         xm0, xm4
+    cvtdq2ps       xm0, xm0
+    mulss          xm0, xm3
+    cvtps2dq       xm0, xm0
+    pminsd         xm0, xm5
+    movd       weightd, xm0
+%if %1 == 8
+    mov    [dstq + xq], weightb
+%else
+    mov [dstq + xq * 2], weightw
+%endif
+    inc             xq
+    cmp             xq, wq
+    jl .loop_tail
+.end:
+    RET
+%endmacro
+
+SLIDE 8
+SLIDE 16
+%endif
+%endif
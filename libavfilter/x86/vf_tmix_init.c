@@ -0,0 +1,39 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/tmix.h"
+
+void ff_tmix_slide_8_avx2(uint8_t *dst, uint32_t *sum, const uint8_t *add,
+                          const uint8_t *sub, int w, int weight, int max, float factor);
+void ff_tmix_slide_16_avx2(uint8_t *dst, uint32_t *sum, const uint8_t *add,
+                           const uint8_t *sub, int w, int weight, int max, float factor);
+
+av_cold void ff_tmix_init_x86(TMixDSPContext *dsp, int depth)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags))
+        dsp->slide = depth <= 8 ? ff_tmix_slide_8_avx2 : ff_tmix_slide_16_avx2;
+#endif
+}
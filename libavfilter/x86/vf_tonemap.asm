@@ -0,0 +1,364 @@
+;*****************************************************************************
+;* x86-optimized functions for tonemap filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;*****************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pf_1:        times 8 dd 1.0
+pf_1e6:      times 8 dd 1.0e-6
+pf_hable_a:  times 8 dd 0.15
+pf_hable_b:  times 8 dd 0.5
+pf_hable_bc: times 8 dd 0.05
+pf_hable_de: times 8 dd 0.004
+pf_hable_df: times 8 dd 0.06
+pf_hable_ef: times 8 dd 0.06666667
+
+pf_lin_max:   times 8 dd 4095.0
+pd_lin_max:   times 8 dd 4094
+pf_delin_max: times 8 dd 16383.0
+pd_delin_max: times 8 dd 16382
+pd_uv_planar: dd 0, 0, 1, 1, 2, 2, 3, 3
+pd_u_nv:      dd 0, 0, 2, 2, 4, 4, 6, 6
+pd_v_nv:      dd 1, 1, 3, 3, 5, 5, 7, 7
+
+; offsets into TonemapParams
+%define DESAT  0
+%define COEFFS 4
+%define PARAM  16
+%define K0     24
+%define K1     28
+%define K2     32
+
+; offsets into TonemapYUVParams
+%define YUV2RGB    0
+%define RGB2Y      36
+%define IN_SCALE   48
+%define IN_OFFSET  56
+%define OUT_SCALE  64
+%define OUT_OFFSET 68
+%define IN_SHIFT   72
+%define OUT_SHIFT  76
+%define OUT_MAX    80
+%define LIN_LUT    88
+%define DELIN_LUT  96
+
+SECTION .text
+
+%if ARCH_X86_64
+
+; computes the tonemapped signal m4 from the signal m3
+; %1 = algorithm
+%macro TONEMAP_SIG 1
+%ifidn %1, linear
+    mulps         m4, m3, m13
+%elifidn %1, clip
+    mulps         m4, m3, m12
+    xorps         m5, m5
+    maxps         m4, m5
+    minps         m4, [pf_1]
+%elifidn %1, reinhard
+    addps         m5, m3, m12
+    divps         m4, m3, m5
+    mulps         m4, m13
+%elifidn %1, hable
+    mulps         m4, m3, [pf_hable_a]
+    addps         m5, m4, [pf_hable_b]
+    addps         m4, [pf_hable_bc]
+    mulps         m4, m3
+    mulps         m5, m3
+    addps         m4, [pf_hable_de]
+    addps         m5, [pf_hable_df]
+    divps         m4, m5
+    subps         m4, [pf_hable_ef]
+    mulps         m4, m13
+%elifidn %1, mobius
+    addps         m4, m3, m13
+    addps         m5, m3, m14
+    mulps         m4, m15
+    divps         m4, m5
+    vcmpleps      m5, m3, m12 ; sig <= param
+    vblendvps     m4, m4, m3, m5
+%endif
+%endmacro
+
+; %1 = algorithm, %2 = desaturate
+%macro TONEMAP_LOOP 2
+.loop_%2:
+    movu          m0, [srcrq + wq]
+    movu          m1, [srcgq + wq]
+    movu          m2, [srcbq + wq]
+%if %2
+    mulps         m3, m0, m9
+    mulps         m4, m1, m10
+    addps         m3, m4
+    mulps         m4, m2, m11
+    addps         m3, m4          ; luma
+    subps         m4, m3, m8
+    maxps         m4, m7
+    maxps         m5, m3, m7
+    divps         m4, m5          ; overbright
+    subps         m5, m6, m4
+    mulps         m0, m5
+    mulps         m1, m5
+    mulps         m2, m5
+    mulps         m3, m4
+    addps         m0, m3
+    addps         m1, m3
+    addps         m2, m3
+%endif
+%ifnidn %1, none
+    maxps         m3, m0, m1
+    maxps         m3, m2
+    maxps         m3, m7          ; sig_orig
+    TONEMAP_SIG   %1
+    divps         m4, m3
+    mulps         m0, m4
+    mulps         m1, m4
+    mulps         m2, m4
+%endif
+    movu [dstrq + wq], m0
+    movu [dstgq + wq], m1
+    movu [dstbq + wq], m2
+    add           wq, mmsize
+    jl .loop_%2
+    RET
+%endmacro
+
+; void ff_tonemap_<algo>(float *dst_r, float *dst_g, float *dst_b,
+;                        const float *src_r, const float *src_g, const float *src_b,
+;                        const TonemapParams *p, int w)
+%macro TONEMAP 1
+cglobal tonemap_%1, 8, 8, 16, dstr, dstg, dstb, srcr, srcg, srcb, params, w
+    movsxdifnidn  wq, wd
+    shl           wq, 2
+    add       dstrq, wq
+    add       dstgq, wq
+    add       dstbq, wq
+    add       srcrq, wq
+    add       srcgq, wq
+    add       srcbq, wq
+    neg           wq
+    jge .end
+
+    movaps        m6, [pf_1]
+    movaps        m7, [pf_1e6]
+    VBROADCASTSS  m8, [paramsq + DESAT]
+    VBROADCASTSS  m9, [paramsq + COEFFS + 0]
+    VBROADCASTSS m10, [paramsq + COEFFS + 4]
+    VBROADCASTSS m11, [paramsq + COEFFS + 8]
+    VBROADCASTSS m12, [paramsq + PARAM]
+    VBROADCASTSS m13, [paramsq + K0]
+    VBROADCASTSS m14, [paramsq + K1]
+    VBROADCASTSS m15, [paramsq + K2]
+
+    xorps        xm0, xm0
+    vcomiss      xm8, xm0
+    ja .desat
+    TONEMAP_LOOP  %1, 0
+.desat:
+    TONEMAP_LOOP  %1, 1
+.end:
+    RET
+%endmacro
+
+; linearly interpolates the table %2 at %1 * (size - 1), in place
+; %3 = size - 1 as float, %4 = size - 2 as int
+; expects m9 = all ones and m10 = zero, clobbers m0 and m6-m8
+%macro LUT_INTERP 4
+    mulps         %1, %3
+    maxps         %1, m10
+    minps         %1, %3
+    cvttps2dq     m6, %1
+    pminsd        m6, %4
+    cvtdq2ps      m7, m6
+    subps         %1, m7          ; f
+    mova          m8, m9
+    vgatherdps    m7, [%2 + m6*4], m8
+    mova          m8, m9
+    vgatherdps    m0, [%2 + m6*4 + 4], m8
+    subps         m0, m7
+    mulps         %1, m0
+    addps         %1, m7          ; lut[i] + f * (lut[i + 1] - lut[i])
+%endmacro
+
+; %1 = dst, %2 = offset of the matrix row, y/u/v in m0/m1/m2
+%macro YUV2RGB_ROW 2
+    VBROADCASTSS  %1, [paramsq + YUV2RGB + %2 + 0]
+    mulps         %1, m0
+    VBROADCASTSS  m6, [paramsq + YUV2RGB + %2 + 4]
+    mulps         m6, m1
+    addps         %1, m6
+    VBROADCASTSS  m6, [paramsq + YUV2RGB + %2 + 8]
+    mulps         m6, m2
+    addps         %1, m6
+%endmacro
+
+; void ff_tonemap_yuv2linear_<planar|nv>(float *dst_r, float *dst_g, float *dst_b,
+;                                        const uint16_t *src_y, const uint16_t *src_u,
+;                                        const uint16_t *src_v, const TonemapYUVParams *p,
+;                                        int w)
+%macro YUV2LINEAR 1
+cglobal tonemap_yuv2linear_%1, 8, 9, 16, dstr, dstg, dstb, srcy, srcu, srcv, params, w, lut
+    movsxdifnidn  wq, wd
+    lea        dstrq, [dstrq + wq*4]
+    lea        dstgq, [dstgq + wq*4]
+    lea        dstbq, [dstbq + wq*4]
+    lea        srcyq, [srcyq + wq*2]
+%ifidn %1, nv
+    lea        srcuq, [srcuq + wq*2]
+%else
+    add        srcuq, wq
+    add        srcvq, wq
+%endif
+    neg           wq
+    jge .end
+
+    mov         lutq, [paramsq + LIN_LUT]
+    pcmpeqd       m9, m9
+    xorps        m10, m10
+    mova         m11, [pd_lin_max]
+    mova         m12, [pf_lin_max]
+    movd        xm13, [paramsq + IN_SHIFT]
+%ifidn %1, nv
+    mova         m14, [pd_v_nv]
+    mova         m15, [pd_u_nv]
+%else
+    mova         m15, [pd_uv_planar]
+%endif
+
+.loop:
+    pmovzxwd      m0, [srcyq + wq*2]
+%ifidn %1, nv
+    pmovzxwd      m1, [srcuq + wq*2]
+    vpermd        m2, m14, m1
+    vpermd        m1, m15, m1
+%else
+    pmovzxwd     xm1, [srcuq + wq]
+    pmovzxwd     xm2, [srcvq + wq]
+    vpermd        m1, m15, m1
+    vpermd        m2, m15, m2
+%endif
+    psrld         m0, xm13
+    psrld         m1, xm13
+    psrld         m2, xm13
+    cvtdq2ps      m0, m0
+    cvtdq2ps      m1, m1
+    cvtdq2ps      m2, m2
+    VBROADCASTSS  m6, [paramsq + IN_SCALE + 0]
+    VBROADCASTSS  m7, [paramsq + IN_OFFSET + 0]
+    mulps         m0, m6
+    addps         m0, m7
+    VBROADCASTSS  m6, [paramsq + IN_SCALE + 4]
+    VBROADCASTSS  m7, [paramsq + IN_OFFSET + 4]
+    mulps         m1, m6
+    mulps         m2, m6
+    addps         m1, m7
+    addps         m2, m7
+
+    YUV2RGB_ROW   m3, 0
+    YUV2RGB_ROW   m4, 12
+    YUV2RGB_ROW   m5, 24
+    LUT_INTERP    m3, lutq, m12, m11
+    LUT_INTERP    m4, lutq, m12, m11
+    LUT_INTERP    m5, lutq, m12, m11
+    movu [dstrq + wq*4], m3
+    movu [dstgq + wq*4], m4
+    movu [dstbq + wq*4], m5
+    add           wq, mmsize / 4
+    jl .loop
+.end:
+    RET
+%endmacro
+
+; void ff_tonemap_linear2y(uint16_t *dst_y, float *r, float *g, float *b,
+;                          const TonemapYUVParams *p, int w)
+%macro LINEAR2Y 0
+cglobal tonemap_linear2y, 6, 7, 16, dsty, srcr, srcg, srcb, params, w, lut
+    movsxdifnidn  wq, wd
+    lea        dstyq, [dstyq + wq*2]
+    lea        srcrq, [srcrq + wq*4]
+    lea        srcgq, [srcgq + wq*4]
+    lea        srcbq, [srcbq + wq*4]
+    neg           wq
+    jge .end
+
+    mov         lutq, [paramsq + DELIN_LUT]
+    pcmpeqd       m9, m9
+    xorps        m10, m10
+    mova         m11, [pd_delin_max]
+    mova         m12, [pf_delin_max]
+    VBROADCASTSS m13, [paramsq + RGB2Y + 0]
+    VBROADCASTSS m14, [paramsq + RGB2Y + 4]
+    VBROADCASTSS m15, [paramsq + RGB2Y + 8]
+
+.loop:
+    movu          m3, [srcrq + wq*4]
+    movu          m4, [srcgq + wq*4]
+    movu          m5, [srcbq + wq*4]
+    LUT_INTERP    m3, lutq, m12, m11
+    LUT_INTERP    m4, lutq, m12, m11
+    LUT_INTERP    m5, lutq, m12, m11
+    movu [srcrq + wq*4], m3
+    movu [srcgq + wq*4], m4
+    movu [srcbq + wq*4], m5
+
+    mulps         m1, m3, m13
+    mulps         m2, m4, m14
+    addps         m1, m2
+    mulps         m2, m5, m15
+    addps         m1, m2
+    VBROADCASTSS  m2, [paramsq + OUT_SCALE]
+    mulps         m1, m2
+    VBROADCASTSS  m2, [paramsq + OUT_OFFSET]
+    addps         m1, m2
+    cvtps2dq      m1, m1
+    pmaxsd        m1, m10
+    VPBROADCASTD  m2, [paramsq + OUT_MAX]
+    pminsd        m1, m2
+    movd         xm2, [paramsq + OUT_SHIFT]
+    pslld         m1, xm2
+    vextracti128 xm2, m1, 1
+    packusdw     xm1, xm2
+    movu [dstyq + wq*2], xm1
+    add           wq, mmsize / 4
+    jl .loop
+.end:
+    RET
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+YUV2LINEAR planar
+YUV2LINEAR nv
+LINEAR2Y
+%endif
+
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+TONEMAP none
+TONEMAP linear
+TONEMAP clip
+TONEMAP reinhard
+TONEMAP hable
+TONEMAP mobius
+%endif
+
+%endif
@@ -0,0 +1,69 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/tonemap.h"
+
+#define DECLARE_TONEMAP(name, opt)                                                  \
+void ff_tonemap_##name##_##opt(float *dst_r, float *dst_g, float *dst_b,            \
+                               const float *src_r, const float *src_g,              \
+                               const float *src_b, const TonemapParams *p, int w);
+
+DECLARE_TONEMAP(none,     avx)
+DECLARE_TONEMAP(linear,   avx)
+DECLARE_TONEMAP(clip,     avx)
+DECLARE_TONEMAP(reinhard, avx)
+DECLARE_TONEMAP(hable,    avx)
+DECLARE_TONEMAP(mobius,   avx)
+
+void ff_tonemap_yuv2linear_planar_avx2(float *dst_r, float *dst_g, float *dst_b,
+                                       const uint16_t *src_y, const uint16_t *src_u,
+                                       const uint16_t *src_v, const TonemapYUVParams *p,
+                                       int w);
+void ff_tonemap_yuv2linear_nv_avx2(float *dst_r, float *dst_g, float *dst_b,
+                                   const uint16_t *src_y, const uint16_t *src_u,
+                                   const uint16_t *src_v, const TonemapYUVParams *p,
+                                   int w);
+void ff_tonemap_linear2y_avx2(uint16_t *dst_y, float *r, float *g, float *b,
+                              const TonemapYUVParams *p, int w);
+
+av_cold void ff_tonemap_init_x86(TonemapDSPContext *dsp)
+{
+#if ARCH_X86_64
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX_FAST(cpu_flags)) {
+        dsp->tonemap[TONEMAP_NONE]     = ff_tonemap_none_avx;
+        dsp->tonemap[TONEMAP_LINEAR]   = ff_tonemap_linear_avx;
+        dsp->tonemap[TONEMAP_CLIP]     = ff_tonemap_clip_avx;
+        dsp->tonemap[TONEMAP_REINHARD] = ff_tonemap_reinhard_avx;
+        dsp->tonemap[TONEMAP_HABLE]    = ff_tonemap_hable_avx;
+        dsp->tonemap[TONEMAP_MOBIUS]   = ff_tonemap_mobius_avx;
+    }
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->yuv2linear[0] = ff_tonemap_yuv2linear_planar_avx2;
+        dsp->yuv2linear[1] = ff_tonemap_yuv2linear_nv_avx2;
+        dsp->linear2y      = ff_tonemap_linear2y_avx2;
+    }
+#endif
+}
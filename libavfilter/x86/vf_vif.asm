@@ -0,0 +1,127 @@
+;*****************************************************************************
+;* x86-optimized functions for vif filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+; The taps are accumulated in the same order as the C code, with separate
+; multiplies and adds, so the results are bit-exact.
+
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+
+;------------------------------------------------------------------------------
+; void ff_vif_filter_h(float *dst, const float *src, const float *filter,
+;                      int filt_w, int w)
+;------------------------------------------------------------------------------
+cglobal vif_filter_h, 5, 6, 2, dst, src, filter, fw, w, k
+    movsxdifnidn   fwq, fwd
+    sub             wd, mmsize / 4
+    jl .tail
+
+.loop:
+    xorps           m0, m0
+    xor             kq, kq
+.loop_k:
+    vbroadcastss    m1, [filterq + kq * 4]
+    mulps           m1, [srcq + kq * 4]
+    addps           m0, m1
+    inc             kq
+    cmp             kq, fwq
+    jl .loop_k
+    movu        [dstq], m0
+    add           srcq, mmsize
+    add           dstq, mmsize
+    sub             wd, mmsize / 4
+    jge .loop
+
+.tail:
+    add             wd, mmsize / 4
+    jz .end
+.loop_tail:
+    xorps          xm0, xm0
+    xor             kq, kq
+.loop_tail_k:
+    movss          xm1, [filterq + kq * 4]
+    mulss          xm1, [srcq + kq * 4]
+    addss          xm0, xm1
+    inc             kq
+    cmp             kq, fwq
+    jl .loop_tail_k
+    movss       [dstq], xm0
+    add           srcq, 4
+    add           dstq, 4
+    dec             wd
+    jg .loop_tail
+.end:
+    RET
+
+%if ARCH_X86_64
+;------------------------------------------------------------------------------
+; void ff_vif_filter_v(float *dst, const float *const *src, const float *filter,
+;                      int filt_w, int w)
+;------------------------------------------------------------------------------
+cglobal vif_filter_v, 5, 8, 2, dst, src, filter, fw, w, x, k, line
+    movsxdifnidn   fwq, fwd
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+    sub             wq, mmsize / 4
+    jl .tail
+
+.loop:
+    xorps           m0, m0
+    xor             kq, kq
+.loop_k:
+    mov          lineq, [srcq + kq * gprsize]
+    vbroadcastss    m1, [filterq + kq * 4]
+    mulps           m1, [lineq + xq * 4]
+    addps           m0, m1
+    inc             kq
+    cmp             kq, fwq
+    jl .loop_k
+    movu [dstq + xq * 4], m0
+    add             xq, mmsize / 4
+    cmp             xq, wq
+    jle .loop
+
+.tail:
+    add             wq, mmsize / 4
+    cmp             xq, wq
+    jge .end
+.loop_tail:
+    xorps          xm0, xm0
+    xor             kq, kq
+.loop_tail_k:
+    mov          lineq, [srcq + kq * gprsize]
+    movss          xm1, [filterq + kq * 4]
+    mulss          xm1, [lineq + xq * 4]
+    addss          xm0, xm1
+    inc             kq
+    cmp             kq, fwq
+    jl .loop_tail_k
+    movss [dstq + xq * 4], xm0
+    inc             xq
+    cmp             xq, wq
+    jl .loop_tail
+.end:
+    RET
+%endif
+%endif
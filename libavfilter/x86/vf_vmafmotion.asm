@@ -0,0 +1,174 @@
+;*****************************************************************************
+;* x86-optimized functions for vmafmotion filter
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA 32
+
+pw_1: times 16 dw 1
+
+SECTION .text
+
+; the 5 taps are used as word pairs (f0, f1), (f2, f3) and (f4, 0) with
+; pmaddwd, all inputs are below 2^15 so the signed multiply is exact
+%macro LOAD_FILTER 1 ; tmp gpr
+    vpbroadcastd    m5, [filterq]
+    vpbroadcastd    m6, [filterq + 4]
+    movzx          %1d, word [filterq + 8]
+    movd           xm7, %1d
+    vpbroadcastd    m7, xm7
+%endmacro
+
+; in: lines j-2 .. j+2 in m0 .. m4, out: sum >> %1 packed to words in m0
+%macro FILTER5 1 ; shift
+    punpcklwd       m8, m0, m1
+    punpckhwd       m0, m1
+    pmaddwd         m8, m5
+    pmaddwd         m0, m5
+    punpcklwd       m1, m2, m3
+    punpckhwd       m2, m3
+    pmaddwd         m1, m6
+    pmaddwd         m2, m6
+    paddd           m8, m1
+    paddd           m0, m2
+    punpcklwd       m1, m4, m4
+    punpckhwd       m4, m4
+    pmaddwd         m1, m7
+    pmaddwd         m4, m7
+    paddd           m8, m1
+    paddd           m0, m4
+    psrad           m8, %1
+    psrad           m0, %1
+    packusdw        m8, m0
+%endmacro
+
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+
+;------------------------------------------------------------------------------
+; void ff_vmafmotion_convolution_y_<bits>bit(const uint16_t *filter,
+;                                            const uint8_t *const *src,
+;                                            uint16_t *dst, int w)
+;------------------------------------------------------------------------------
+%macro CONVOLUTION_Y 1 ; bits
+cglobal vmafmotion_convolution_y_%1bit, 4, 10, 9, filter, src, dst, w, x, s0, s1, s2, s3, s4
+    LOAD_FILTER     x
+    movsxdifnidn    wq, wd
+    mov            s0q, [srcq + 0 * gprsize]
+    mov            s1q, [srcq + 1 * gprsize]
+    mov            s2q, [srcq + 2 * gprsize]
+    mov            s3q, [srcq + 3 * gprsize]
+    mov            s4q, [srcq + 4 * gprsize]
+    xor             xq, xq
+
+.loop:
+%if %1 == 8
+    pmovzxbw        m0, [s0q + xq]
+    pmovzxbw        m1, [s1q + xq]
+    pmovzxbw        m2, [s2q + xq]
+    pmovzxbw        m3, [s3q + xq]
+    pmovzxbw        m4, [s4q + xq]
+%else
+    movu            m0, [s0q + xq * 2]
+    movu            m1, [s1q + xq * 2]
+    movu            m2, [s2q + xq * 2]
+    movu            m3, [s3q + xq * 2]
+    movu            m4, [s4q + xq * 2]
+%endif
+    FILTER5         %1
+    movu   [dstq + xq * 2], m8
+    add             xq, mmsize / 2
+    cmp             xq, wq
+    jl .loop
+    RET
+%endmacro
+
+CONVOLUTION_Y 8
+CONVOLUTION_Y 10
+
+;------------------------------------------------------------------------------
+; void ff_vmafmotion_convolution_x(const uint16_t *filter, const uint16_t *src,
+;                                  uint16_t *dst, int w)
+;------------------------------------------------------------------------------
+cglobal vmafmotion_convolution_x, 4, 5, 9, filter, src, dst, w, x
+    LOAD_FILTER     x
+    movsxdifnidn    wq, wd
+    xor             xq, xq
+
+.loop:
+    movu            m0, [srcq + xq * 2 - 4]
+    movu            m1, [srcq + xq * 2 - 2]
+    movu            m2, [srcq + xq * 2]
+    movu            m3, [srcq + xq * 2 + 2]
+    movu            m4, [srcq + xq * 2 + 4]
+    FILTER5         15
+    movu   [dstq + xq * 2], m8
+    add             xq, mmsize / 2
+    cmp             xq, wq
+    jl .loop
+    RET
+
+;------------------------------------------------------------------------------
+; uint64_t ff_vmafmotion_sad(const uint16_t *img1, const uint16_t *img2,
+;                            int w, int h, ptrdiff_t img1_stride,
+;                            ptrdiff_t img2_stride)
+;
+; w must be a multiple of 16
+;------------------------------------------------------------------------------
+cglobal vmafmotion_sad, 6, 7, 5, img1, img2, w, h, stride1, stride2, x
+    movsxdifnidn    wq, wd
+    lea          img1q, [img1q + wq * 2]
+    lea          img2q, [img2q + wq * 2]
+    neg             wq
+    pxor            m3, m3
+    pxor            m4, m4
+    mova            m1, [pw_1]
+
+.nextrow:
+    mov             xq, wq
+    pxor            m2, m2
+
+.loop:
+    movu            m0, [img1q + xq * 2]
+    psubw           m0, [img2q + xq * 2]
+    pabsw           m0, m0
+    pmaddwd         m0, m1
+    paddd           m2, m0
+    add             xq, mmsize / 2
+    jl .loop
+
+    punpckldq       m0, m2, m4
+    punpckhdq       m2, m4
+    paddq           m3, m0
+    paddq           m3, m2
+    add          img1q, stride1q
+    add          img2q, stride2q
+    dec             hd
+    jg .nextrow
+
+    vextracti128   xm0, m3, 1
+    paddq          xm3, xm0
+    punpckhqdq     xm0, xm3, xm3
+    paddq          xm3, xm0
+    movq           rax, xm3
+    RET
+%endif
+%endif
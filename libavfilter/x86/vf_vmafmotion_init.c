@@ -0,0 +1,70 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+
+#include "config.h"
+
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libavfilter/vmaf_motion.h"
+
+void ff_vmafmotion_convolution_y_8bit_avx2(const uint16_t *filter, const uint8_t *const *src,
+                                           uint16_t *dst, int w);
+void ff_vmafmotion_convolution_y_10bit_avx2(const uint16_t *filter, const uint8_t *const *src,
+                                            uint16_t *dst, int w);
+void ff_vmafmotion_convolution_x_avx2(const uint16_t *filter, const uint16_t *src,
+                                      uint16_t *dst, int w);
+uint64_t ff_vmafmotion_sad_avx2(const uint16_t *img1, const uint16_t *img2, int w, int h,
+                                ptrdiff_t img1_stride, ptrdiff_t img2_stride);
+
+#if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+static uint64_t vmafmotion_sad_avx2(const uint16_t *img1, const uint16_t *img2, int w, int h,
+                                    ptrdiff_t img1_stride, ptrdiff_t img2_stride)
+{
+    const int awidth = w & ~15;
+    uint64_t sum = 0;
+
+    if (awidth)
+        sum = ff_vmafmotion_sad_avx2(img1, img2, awidth, h, img1_stride, img2_stride);
+
+    for (int i = 0; i < h && awidth < w; i++) {
+        for (int j = awidth; j < w; j++)
+            sum += abs(img1[j] - img2[j]);
+        img1 += img1_stride / sizeof(*img1);
+        img2 += img2_stride / sizeof(*img2);
+    }
+
+    return sum;
+}
+#endif
+
+av_cold void ff_vmafmotion_init_x86(VMAFMotionDSPContext *dsp, int bpp)
+{
+#if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+    int cpu_flags = av_get_cpu_flags();
+
+    if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        dsp->sad           = vmafmotion_sad_avx2;
+        dsp->convolution_x = ff_vmafmotion_convolution_x_avx2;
+        dsp->convolution_y = bpp == 10 ? ff_vmafmotion_convolution_y_10bit_avx2
+                                       : ff_vmafmotion_convolution_y_8bit_avx2;
+    }
+#endif
+}
@@ -1,5 +1,5 @@
 ;*****************************************************************************
-;* x86-optimized functions for v360 filter
+;* x86-optimized line remapping functions for the warp engine
 ;*
 ;* This file is part of FFmpeg.
 ;*
@@ -252,5 +252,52 @@ cglobal remap4_8bit_line, 7, 9, 11, dst, width, src, in_linesize, u, v, ker, x,
         jl .loop
     RET
 
+INIT_YMM avx2
+cglobal remap4_16bit_line, 7, 9, 11, dst, width, src, in_linesize, u, v, ker, x, y
+    movsxdifnidn widthq, widthd
+    xor             yq, yq
+    xor             xq, xq
+    movd           xm0, in_linesized
+    pcmpeqw         m7, m7
+    vpbroadcastd    m0, xm0
+    vpbroadcastd    m6, [pd_65535]
+
+    .loop:
+        pmovsxwd   m1, [kerq + yq]
+        pmovsxwd   m5, [kerq + yq + 16]
+        pmovsxwd   m2, [vq + yq]
+        pmovsxwd   m8, [vq + yq + 16]
+        pmovsxwd   m3, [uq + yq]
+        pmovsxwd   m9, [uq + yq + 16]
+
+        pslld           m3, 0x1
+        pslld           m9, 0x1
+        pmulld          m4, m2, m0
+        pmulld         m10, m8, m0
+        paddd           m4, m3
+        paddd           m10, m9
+        mova            m3, m7
+        vpgatherdd      m2, [srcq + m4], m3
+        mova            m3, m7
+        vpgatherdd      m4, [srcq + m10], m3
+        pand            m2, m6
+        pand            m4, m6
+        pmulld          m2, m1
+        pmulld          m4, m5
+
+        paddd           m2, m4
+        HADDD           m2, m1
+        ; cubic weights are signed, clip the result to 0..65535
+        psrad           m2, m2, 0xe
+        packusdw        m2, m2
+
+        pextrw [dstq+xq*2], xm2, 0
+
+        add   xq, 1
+        add   yq, 32
+        cmp   xq, widthq
+        jl .loop
+    RET
+
 %endif
 %endif
@@ -21,7 +21,7 @@
 #include "libavutil/attributes.h"
 #include "libavutil/cpu.h"
 #include "libavutil/x86/cpu.h"
-#include "libavfilter/v360.h"
+#include "libavfilter/warp.h"
 
 void ff_remap1_8bit_line_avx2(uint8_t *dst, int width, const uint8_t *src, ptrdiff_t in_linesize,
                               const int16_t *const u, const int16_t *const v, const int16_t *const ker);
@@ -41,31 +41,29 @@ void ff_remap1_16bit_line_avx2(uint8_t *dst, int width, const uint8_t *src, ptrd
 void ff_remap2_16bit_line_avx2(uint8_t *dst, int width, const uint8_t *src, ptrdiff_t in_linesize,
                                const int16_t *const u, const int16_t *const v, const int16_t *const ker);
 
-av_cold void ff_v360_init_x86(V360Context *s, int depth)
+void ff_remap4_16bit_line_avx2(uint8_t *dst, int width, const uint8_t *src, ptrdiff_t in_linesize,
+                               const int16_t *const u, const int16_t *const v, const int16_t *const ker);
+
+av_cold ff_warp_line_fn ff_warp_get_line_fn_x86(int ws, int depth)
 {
     int cpu_flags = av_get_cpu_flags();
 
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && s->interp == NEAREST && depth <= 8)
-        s->remap_line = ff_remap1_8bit_line_avx2;
-
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && s->interp == BILINEAR && depth <= 8)
-        s->remap_line = ff_remap2_8bit_line_avx2;
+    if (!EXTERNAL_AVX2_FAST(cpu_flags))
+        return NULL;
 
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && s->interp == NEAREST && depth > 8)
-        s->remap_line = ff_remap1_16bit_line_avx2;
+    if (ws == 1)
+        return depth <= 8 ? ff_remap1_8bit_line_avx2 : ff_remap1_16bit_line_avx2;
 
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && s->interp == BILINEAR && depth > 8)
-        s->remap_line = ff_remap2_16bit_line_avx2;
+    if (ws == 2)
+        return depth <= 8 ? ff_remap2_8bit_line_avx2 : ff_remap2_16bit_line_avx2;
 
 #if ARCH_X86_64
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && s->interp == LAGRANGE9 && depth <= 8)
-        s->remap_line = ff_remap3_8bit_line_avx2;
-
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && (s->interp == BICUBIC ||
-                                          s->interp == LANCZOS ||
-                                          s->interp == SPLINE16 ||
-                                          s->interp == GAUSSIAN ||
-                                          s->interp == MITCHELL) && depth <= 8)
-        s->remap_line = ff_remap4_8bit_line_avx2;
+    if (ws == 3 && depth <= 8)
+        return ff_remap3_8bit_line_avx2;
+
+    if (ws == 4)
+        return depth <= 8 ? ff_remap4_8bit_line_avx2 : ff_remap4_16bit_line_avx2;
 #endif
+
+    return NULL;
 }
@@ -864,8 +864,8 @@
 %endif
 %endmacro
 
-%macro VBROADCASTSD 2 ; dst xmm/ymm, src m64
-%if cpuflag(avx) && mmsize == 32
+%macro VBROADCASTSD 2 ; dst xmm/ymm/zmm, src m64
+%if cpuflag(avx) && mmsize >= 32
     vbroadcastsd %1, %2
 %elif cpuflag(sse3)
     movddup      %1, %2
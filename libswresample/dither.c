@@ -19,6 +19,7 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/mem_internal.h"
 #include "swresample_internal.h"
 
 #include "noise_shaping_data.c"
@@ -76,6 +77,100 @@ int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSam
     return 0;
 }
 
+/* same operations as swri_noise_shaping_float() for each channel */
+static void noise_shaping_float_x4_c(float *dst, const float *src, const float *noise, float *errors,
+                                     const float *coeffs, integer taps, integer pos, integer len)
+{
+    const float S_1 = coeffs[0];
+    const float S   = coeffs[4];
+    const float *c  = coeffs + 8;
+    int i, j, k;
+
+    for (i = 0; i < len; i++) {
+        int npos = pos ? pos - 1 : taps - 1;
+        for (k = 0; k < 4; k++) {
+            const float *e = errors + 4*pos + k;
+            double d1, d = src[4*i + k]*S_1;
+            for (j = 0; j < taps-2; j += 4) {
+                d -= c[4*j     ] * e[4*j     ]
+                    +c[4*j +  4] * e[4*j +  4]
+                    +c[4*j +  8] * e[4*j +  8]
+                    +c[4*j + 12] * e[4*j + 12];
+            }
+            if (j < taps)
+                d -= c[4*j] * e[4*j];
+            d1 = rint(d + noise[4*i + k]);
+            errors[4*(npos + taps) + k] = errors[4*npos + k] = d1 - d;
+            dst[4*i + k] = d1 * S;
+        }
+        pos = npos;
+    }
+}
+
+#define NS_BLOCK 256
+
+void swri_noise_shaping_float_simd(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count)
+{
+    LOCAL_ALIGNED_32(float, coeffs, [8 + 4*NS_TAPS]);
+    LOCAL_ALIGNED_32(float, errors, [4*2*NS_TAPS]);
+    LOCAL_ALIGNED_32(float, buf,    [4*NS_BLOCK]);
+    LOCAL_ALIGNED_32(float, noise,  [4*NS_BLOCK]);
+    int taps = s->dither.ns_taps;
+    int pos  = s->dither.ns_pos;
+    int i, j, k, ch;
+
+    av_assert2((taps&3) != 2);
+    av_assert2((taps&3) != 3 || s->dither.ns_coeffs[taps] == 0);
+
+    for (k = 0; k < 4; k++) {
+        coeffs[k    ] = s->dither.ns_scale_1;
+        coeffs[k + 4] = s->dither.ns_scale;
+        for (j = 0; j < NS_TAPS; j++)
+            coeffs[8 + 4*j + k] = s->dither.ns_coeffs[j];
+    }
+
+    /* Channels are processed 4 at a time, missing ones in the last group
+     * repeat its last channel and are not written back. */
+    for (ch = 0; ch < srcs->ch_count; ch += 4) {
+        int nb_ch = FFMIN(srcs->ch_count - ch, 4);
+        const float *src[4], *nse[4];
+        float *dst[4], *ns_errors[4];
+
+        for (k = 0; k < 4; k++) {
+            int c = ch + FFMIN(k, nb_ch - 1);
+            src[k]       = (const float *)srcs->ch[c];
+            nse[k]       = (const float *)noises->ch[c] + s->dither.noise_pos;
+            dst[k]       = (float *)dsts->ch[c];
+            ns_errors[k] = s->dither.ns_errors[c];
+            for (j = 0; j < 2*taps; j++)
+                errors[4*j + k] = ns_errors[k][j];
+        }
+
+        pos = s->dither.ns_pos;
+        for (i = 0; i < count; i += NS_BLOCK) {
+            int len = FFMIN(count - i, NS_BLOCK);
+
+            for (j = 0; j < len; j++) {
+                for (k = 0; k < 4; k++) {
+                    buf  [4*j + k] = src[k][i + j];
+                    noise[4*j + k] = nse[k][i + j];
+                }
+            }
+            s->dither.ns_x4_simd(buf, buf, noise, errors, coeffs, taps, pos, len);
+            pos = (pos + taps - len % taps) % taps;
+            for (k = 0; k < nb_ch; k++)
+                for (j = 0; j < len; j++)
+                    dst[k][i + j] = buf[4*j + k];
+        }
+
+        for (k = 0; k < nb_ch; k++)
+            for (j = 0; j < 2*taps; j++)
+                ns_errors[k][j] = errors[4*j + k];
+    }
+
+    s->dither.ns_pos = pos;
+}
+
 av_cold int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt)
 {
     int i;
@@ -128,6 +223,12 @@ av_cold int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AV
         s->dither.method = SWR_DITHER_TRIANGULAR_HIGHPASS;
     }
 
+    s->dither.ns_x4_f    = noise_shaping_float_x4_c;
+    s->dither.ns_x4_simd = NULL;
+#if ARCH_X86 && HAVE_X86ASM && HAVE_MMX
+    swri_dither_init_x86(&s->dither);
+#endif
+
     return 0;
 }
 
@@ -41,6 +41,21 @@
 #include "rematrix_template.c"
 #undef TEMPLATE_REMATRIX_S32
 
+/**
+ * Mix nb_in int16 inputs into one output with the 17.15 fixed point
+ * coefficients in coeffp, saturating the result.
+ */
+static void sumn_s16(int16_t *out, const int16_t * const *in, const int32_t *coeffp, integer nb_in, integer len){
+    int i, j;
+
+    for(i=0; i<len; i++) {
+        int64_t v = 16384;
+        for(j=0; j<nb_in; j++)
+            v += in[j][i] * (int64_t)coeffp[j];
+        out[i] = av_clip_int16(v >> 15);
+    }
+}
+
 #define FRONT_LEFT             0
 #define FRONT_RIGHT            1
 #define FRONT_CENTER           2
@@ -530,6 +545,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
             s->mix_2_1_f = (mix_2_1_func_type*)sum2_clip_s16;
             s->mix_any_f = (mix_any_func_type*)get_mix_any_func_clip_s16(s);
         }
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_s16;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_FLTP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(float));
         s->native_one    = av_mallocz(sizeof(float));
@@ -542,6 +558,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_float;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
         s->native_one    = av_mallocz(sizeof(double));
@@ -554,6 +571,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_double;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
         s->native_one    = av_mallocz(sizeof(int));
         if (!s->native_one)
@@ -576,6 +594,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_s32;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_s32;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_s32(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_s32;
     }else
         av_assert0(0);
     //FIXME quantize for integeres
@@ -589,6 +608,31 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->matrix_ch[i][0]= ch_in;
     }
 
+    s->native_matrix_n = av_calloc(nb_out, NATIVE_MATRIX_N_STRIDE(s));
+    if (!s->native_matrix_n)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < nb_out; i++) {
+        uint8_t *coeffp = s->native_matrix_n + i * NATIVE_MATRIX_N_STRIDE(s);
+        int n = s->matrix_ch[i][0];
+
+        switch (s->midbuf.fmt) {
+        case AV_SAMPLE_FMT_S16P:
+        case AV_SAMPLE_FMT_S32P:
+            for (j = 0; j < n; j++)
+                ((int32_t *)coeffp)[j] = s->matrix32[i][s->matrix_ch[i][1 + j]];
+            break;
+        case AV_SAMPLE_FMT_FLTP:
+            for (j = 0; j < n; j++)
+                ((float *)coeffp)[j] = s->matrix_flt[i][s->matrix_ch[i][1 + j]];
+            break;
+        case AV_SAMPLE_FMT_DBLP:
+            for (j = 0; j < n; j++)
+                ((double *)coeffp)[j] = s->matrix[i][s->matrix_ch[i][1 + j]];
+            break;
+        }
+    }
+    s->mix_n_1_simd = NULL;
+
 #if ARCH_X86 && HAVE_X86ASM && HAVE_MMX
     return swri_rematrix_init_x86(s);
 #endif
@@ -601,10 +645,53 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_one);
     av_freep(&s->native_simd_matrix);
     av_freep(&s->native_simd_one);
+    av_freep(&s->native_matrix_n);
+    av_freep(&s->native_simd_matrix_n);
+}
+
+static void mix_n_1(SwrContext *s, mix_n_1_func_type *mix, const uint8_t *matrix,
+                    AudioData *out, const AudioData *in, int out_i, int off, int len)
+{
+    const uint8_t *ins[SWR_CH_MAX + 1];
+    int nb_in = s->matrix_ch[out_i][0];
+    int j;
+
+    for (j = 0; j < nb_in; j++)
+        ins[j] = in->ch[s->matrix_ch[out_i][1 + j]] + off * in->bps;
+    ins[nb_in] = ins[nb_in - 1];
+
+    mix(out->ch[out_i] + off * out->bps, (const void * const *)ins,
+        matrix + out_i * NATIVE_MATRIX_N_STRIDE(s), nb_in, len);
+}
+
+/**
+ * Mix all outputs with more than 2 inputs, one block at a time so that the
+ * inputs stay in the cache for all outputs after the first one.
+ */
+static void mix_n_1_blocks(SwrContext *s, AudioData *out, const AudioData *in, int len)
+{
+    const uint8_t *simd_matrix = s->native_simd_matrix_n ? s->native_simd_matrix_n
+                                                         : s->native_matrix_n;
+    int block = FFMAX(16384 / (in->ch_count * in->bps), 16) & ~15;
+    int len1  = len & ~15;
+    int off, out_i;
+
+    for (off = 0; off < len1; off += block) {
+        for (out_i = 0; out_i < out->ch_count; out_i++)
+            if (s->matrix_ch[out_i][0] > 2)
+                mix_n_1(s, s->mix_n_1_simd, simd_matrix, out, in, out_i,
+                        off, FFMIN(block, len1 - off));
+    }
+    if (len != len1) {
+        for (out_i = 0; out_i < out->ch_count; out_i++)
+            if (s->matrix_ch[out_i][0] > 2)
+                mix_n_1(s, s->mix_n_1_f, s->native_matrix_n, out, in, out_i,
+                        len1, len - len1);
+    }
 }
 
 int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
-    int out_i, in_i, i, j;
+    int out_i, in_i;
     int len1 = 0;
     int off = 0;
 
@@ -651,35 +738,11 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
         default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
-                }
-            }else{
-                for(i=0; i<len; i++){
-                    int v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((int16_t*)in->ch[in_i])[i] * s->matrix32[out_i][in_i];
-                    }
-                    ((int16_t*)out->ch[out_i])[i]= (v + 16384)>>15;
-                }
-            }
+            if (!s->mix_n_1_simd)
+                mix_n_1(s, s->mix_n_1_f, s->native_matrix_n, out, in, out_i, 0, len);
         }
     }
+    if (s->mix_n_1_simd)
+        mix_n_1_blocks(s, out, in, len);
     return 0;
 }
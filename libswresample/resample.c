@@ -27,7 +27,10 @@
  */
 
 #include "libavutil/avassert.h"
+#include "libavutil/buffer.h"
 #include "libavutil/cpu.h"
+#include "libavutil/thread.h"
+#include "libavutil/tx.h"
 #include "resample.h"
 
 static inline double eval_poly(const double *coeff, int size, double x) {
@@ -134,30 +137,135 @@ static double bessel(double x) {
     }
 }
 
+/**
+ * Replace the filter h of length len by the minimum phase filter with the
+ * same magnitude response, computed from the real cepstrum.
+ */
+static int minimum_phase(double *h, int len)
+{
+    AVTXContext *fft = NULL, *ifft = NULL;
+    av_tx_fn fft_fn, ifft_fn;
+    AVComplexDouble *buf = NULL, *tmp = NULL;
+    double scale = 1.0, max = 0;
+    int i, n, ret;
+
+    /* the cepstrum of the filter is not time limited, oversize the
+     * transform to keep its aliasing low */
+    if (len > 1 << 24)
+        return AVERROR(EINVAL);
+    n = 1 << av_ceil_log2(8 * len);
+
+    if ((ret = av_tx_init(&fft,  &fft_fn,  AV_TX_DOUBLE_FFT, 0, n, &scale, 0)) < 0 ||
+        (ret = av_tx_init(&ifft, &ifft_fn, AV_TX_DOUBLE_FFT, 1, n, &scale, 0)) < 0)
+        goto end;
+    buf = av_calloc(n, sizeof(*buf));
+    tmp = av_calloc(n, sizeof(*tmp));
+    ret = AVERROR(ENOMEM);
+    if (!buf || !tmp)
+        goto end;
+
+    for (i = 0; i < len; i++)
+        buf[i].re = h[i];
+    fft_fn(fft, tmp, buf, sizeof(*buf));
+
+    /* log magnitude, floored to keep the stopband finite */
+    for (i = 0; i < n; i++)
+        max = FFMAX(max, hypot(tmp[i].re, tmp[i].im));
+    for (i = 0; i < n; i++) {
+        buf[i].re = log(FFMAX(hypot(tmp[i].re, tmp[i].im), max * 1e-12));
+        buf[i].im = 0;
+    }
+    ifft_fn(ifft, tmp, buf, sizeof(*buf));
+
+    /* fold the anticausal part of the cepstrum onto the causal one */
+    for (i = 0; i < n; i++) {
+        buf[i].re = i && i < n / 2 ? 2 * tmp[i].re / n :
+                    i <= n / 2     ?     tmp[i].re / n : 0;
+        buf[i].im = 0;
+    }
+    fft_fn(fft, tmp, buf, sizeof(*buf));
+
+    for (i = 0; i < n; i++) {
+        double m = exp(tmp[i].re);
+        buf[i].re = m * cos(tmp[i].im);
+        buf[i].im = m * sin(tmp[i].im);
+    }
+    ifft_fn(ifft, tmp, buf, sizeof(*buf));
+
+    for (i = 0; i < len; i++)
+        h[i] = tmp[i].re / n;
+
+    ret = 0;
+end:
+    av_tx_uninit(&fft);
+    av_tx_uninit(&ifft);
+    av_free(buf);
+    av_free(tmp);
+    return ret;
+}
+
+/* quantize the taps of one phase and store them in the filter bank */
+static void store_phase(ResampleContext *c, void *filter, int alloc, int ph,
+                        const double *tab, int tap_count, int scale, double norm)
+{
+    int i;
+
+    switch(c->format){
+    case AV_SAMPLE_FMT_S16P:
+        for(i=0;i<tap_count;i++)
+            ((int16_t*)filter)[ph * alloc + i] = av_clip_int16(lrintf(tab[i] * scale / norm));
+        break;
+    case AV_SAMPLE_FMT_S32P:
+        for(i=0;i<tap_count;i++)
+            ((int32_t*)filter)[ph * alloc + i] = av_clipl_int32(llrint(tab[i] * scale / norm));
+        break;
+    case AV_SAMPLE_FMT_FLTP:
+        for(i=0;i<tap_count;i++)
+            ((float*)filter)[ph * alloc + i] = tab[i] * scale / norm;
+        break;
+    case AV_SAMPLE_FMT_DBLP:
+        for(i=0;i<tap_count;i++)
+            ((double*)filter)[ph * alloc + i] = tab[i] * scale / norm;
+        break;
+    }
+}
+
 /**
  * builds a polyphase filterbank.
+ * Phase ph of the default linear phase filters is centered at tap
+ * (tap_count-1)/2 + ph/phase_count. With min_phase, the filters are causal:
+ * phase ph tap i is the minimum phase impulse response at a delay of
+ * tap_count-1-i + ph/phase_count input samples.
  * @param factor resampling factor
  * @param scale wanted sum of coefficients for each filter
  * @param filter_type  filter type
  * @param kaiser_beta  kaiser window beta
+ * @param min_phase  build causal minimum phase filters
  * @return 0 on success, negative on error
  */
 static int build_filter(ResampleContext *c, void *filter, double factor, int tap_count, int alloc, int phase_count, int scale,
-                        int filter_type, double kaiser_beta){
+                        int filter_type, double kaiser_beta, int min_phase){
     int ph, i;
     int ph_nb = phase_count % 2 ? phase_count : phase_count / 2 + 1;
     double x, y, w, t, s;
     double *tab = av_malloc_array(tap_count+1,  sizeof(*tab));
+    double *rev = av_malloc_array(tap_count+1,  sizeof(*rev));
     double *sin_lut = av_malloc_array(ph_nb, sizeof(*sin_lut));
+    double *proto = NULL;
     const int center= (tap_count-1)/2;
     double norm = 0;
     int ret = AVERROR(ENOMEM);
 
-    if (!tab || !sin_lut)
+    if (!tab || !rev || !sin_lut)
         goto fail;
 
     av_assert0(tap_count == 1 || tap_count % 2 == 0);
 
+    /* the prototype filter at phase_count times the input rate,
+     * sample n is at (n + 1) / phase_count - center - 1 */
+    if (min_phase && !(proto = av_calloc((size_t)tap_count * phase_count, sizeof(*proto))))
+        goto fail;
+
     /* if upsampling, only need to interpolate, no filter */
     if (factor > 1.0)
         factor = 1.0;
@@ -196,41 +304,34 @@ static int build_filter(ResampleContext *c, void *filter, double factor, int tap
             }
 
             tab[i] = y;
+            rev[tap_count-1-i] = y;
             s = -s;
             if (!ph)
                 norm += y;
         }
 
+        if (proto) {
+            for (i = 0; i < tap_count; i++) {
+                proto[i * phase_count + phase_count-1-ph] = tab[i];
+                if (ph && !(phase_count % 2))
+                    proto[i * phase_count + ph-1] = rev[i];
+            }
+            continue;
+        }
+
         /* normalize so that an uniform color remains the same */
-        switch(c->format){
-        case AV_SAMPLE_FMT_S16P:
-            for(i=0;i<tap_count;i++)
-                ((int16_t*)filter)[ph * alloc + i] = av_clip_int16(lrintf(tab[i] * scale / norm));
-            if (phase_count % 2) break;
-            for (i = 0; i < tap_count; i++)
-                ((int16_t*)filter)[(phase_count-ph) * alloc + tap_count-1-i] = ((int16_t*)filter)[ph * alloc + i];
-            break;
-        case AV_SAMPLE_FMT_S32P:
-            for(i=0;i<tap_count;i++)
-                ((int32_t*)filter)[ph * alloc + i] = av_clipl_int32(llrint(tab[i] * scale / norm));
-            if (phase_count % 2) break;
-            for (i = 0; i < tap_count; i++)
-                ((int32_t*)filter)[(phase_count-ph) * alloc + tap_count-1-i] = ((int32_t*)filter)[ph * alloc + i];
-            break;
-        case AV_SAMPLE_FMT_FLTP:
-            for(i=0;i<tap_count;i++)
-                ((float*)filter)[ph * alloc + i] = tab[i] * scale / norm;
-            if (phase_count % 2) break;
-            for (i = 0; i < tap_count; i++)
-                ((float*)filter)[(phase_count-ph) * alloc + tap_count-1-i] = ((float*)filter)[ph * alloc + i];
-            break;
-        case AV_SAMPLE_FMT_DBLP:
-            for(i=0;i<tap_count;i++)
-                ((double*)filter)[ph * alloc + i] = tab[i] * scale / norm;
-            if (phase_count % 2) break;
+        store_phase(c, filter, alloc, ph, tab, tap_count, scale, norm);
+        if (!(phase_count % 2))
+            store_phase(c, filter, alloc, phase_count-ph, rev, tap_count, scale, norm);
+    }
+
+    if (proto) {
+        if ((ret = minimum_phase(proto, tap_count * phase_count)) < 0)
+            goto fail;
+        for (ph = 0; ph < phase_count; ph++) {
             for (i = 0; i < tap_count; i++)
-                ((double*)filter)[(phase_count-ph) * alloc + tap_count-1-i] = ((double*)filter)[ph * alloc + i];
-            break;
+                tab[i] = proto[(tap_count-1-i) * phase_count + ph];
+            store_phase(c, filter, alloc, ph, tab, tap_count, scale, norm);
         }
     }
 #if 0
@@ -273,27 +374,281 @@ static int build_filter(ResampleContext *c, void *filter, double factor, int tap
     ret = 0;
 fail:
     av_free(tab);
+    av_free(rev);
     av_free(sin_lut);
+    av_free(proto);
     return ret;
 }
 
+/*
+ * Process-wide cache of built filter banks, so that creating many resamplers
+ * with the same parameters does not recompute the windowed sinc each time.
+ * The banks are never modified after being built and are shared between
+ * contexts by reference. The least recently used entry is evicted when the
+ * cache is full.
+ */
+#define FILTER_CACHE_ENTRIES   32
+#define FILTER_CACHE_MAX_BYTES (64 << 20)
+
+typedef struct FilterBankKey {
+    double factor;
+    double kaiser_beta;
+    int filter_length, filter_alloc, phase_count;
+    enum AVSampleFormat format;
+    enum SwrFilterType filter_type;
+    int min_phase;
+} FilterBankKey;
+
+typedef struct FilterCacheEntry {
+    FilterBankKey key;
+    AVBufferRef  *buf;
+    unsigned      last_use;
+} FilterCacheEntry;
+
+static AVMutex filter_cache_lock = AV_MUTEX_INITIALIZER;
+static FilterCacheEntry filter_cache[FILTER_CACHE_ENTRIES];
+static size_t   filter_cache_size;
+static unsigned filter_cache_clock;
+
+static void filter_cache_evict(FilterCacheEntry *e)
+{
+    filter_cache_size -= e->buf->size;
+    av_buffer_unref(&e->buf);
+}
+
+static FilterCacheEntry *filter_cache_lru(void)
+{
+    FilterCacheEntry *lru = NULL;
+
+    for (int i = 0; i < FILTER_CACHE_ENTRIES; i++) {
+        FilterCacheEntry *e = &filter_cache[i];
+        if (e->buf && (!lru || e->last_use < lru->last_use))
+            lru = e;
+    }
+
+    return lru;
+}
+
+static FilterCacheEntry *filter_cache_find(const FilterBankKey *key)
+{
+    for (int i = 0; i < FILTER_CACHE_ENTRIES; i++) {
+        FilterCacheEntry *e = &filter_cache[i];
+        if (e->buf && !memcmp(&e->key, key, sizeof(*key)))
+            return e;
+    }
+    return NULL;
+}
+
+static AVBufferRef *filter_cache_get(const FilterBankKey *key)
+{
+    AVBufferRef *buf = NULL;
+    FilterCacheEntry *e;
+
+    ff_mutex_lock(&filter_cache_lock);
+    if ((e = filter_cache_find(key))) {
+        buf = av_buffer_ref(e->buf);
+        e->last_use = ++filter_cache_clock;
+    }
+    ff_mutex_unlock(&filter_cache_lock);
+
+    return buf;
+}
+
+static void filter_cache_put(const FilterBankKey *key, AVBufferRef *buf)
+{
+    FilterCacheEntry *e;
+
+    if (buf->size > FILTER_CACHE_MAX_BYTES / 4)
+        return;
+
+    ff_mutex_lock(&filter_cache_lock);
+    /* another context may have built the same bank concurrently */
+    if (filter_cache_find(key))
+        goto end;
+
+    while (filter_cache_size + buf->size > FILTER_CACHE_MAX_BYTES)
+        filter_cache_evict(filter_cache_lru());
+
+    e = NULL;
+    for (int i = 0; i < FILTER_CACHE_ENTRIES && !e; i++)
+        if (!filter_cache[i].buf)
+            e = &filter_cache[i];
+    if (!e) {
+        e = filter_cache_lru();
+        filter_cache_evict(e);
+    }
+
+    if ((e->buf = av_buffer_ref(buf))) {
+        e->key       = *key;
+        e->last_use  = ++filter_cache_clock;
+        filter_cache_size += buf->size;
+    }
+end:
+    ff_mutex_unlock(&filter_cache_lock);
+}
+
+/**
+ * Get a filter bank with phase_count phases for the parameters of c, either
+ * from the cache or by building it. The returned bank must not be modified.
+ */
+static AVBufferRef *get_filter_bank(ResampleContext *c, int phase_count)
+{
+    FilterBankKey key;
+    AVBufferRef *buf;
+    uint8_t *bank;
+
+    /* zeroed so that the padding compares equal */
+    memset(&key, 0, sizeof(key));
+    key.factor        = c->factor;
+    key.kaiser_beta   = c->kaiser_beta;
+    key.filter_length = c->filter_length;
+    key.filter_alloc  = c->filter_alloc;
+    key.phase_count   = phase_count;
+    key.format        = c->format;
+    key.filter_type   = c->filter_type;
+    key.min_phase     = c->min_phase;
+
+    if ((buf = filter_cache_get(&key)))
+        return buf;
+
+    if (phase_count + 1LL > SIZE_MAX / c->felem_size / c->filter_alloc)
+        return NULL;
+    buf = av_buffer_allocz((size_t)c->filter_alloc * (phase_count + 1) * c->felem_size);
+    if (!buf)
+        return NULL;
+    bank = buf->data;
+
+    if (build_filter(c, bank, c->factor, c->filter_length, c->filter_alloc,
+                     phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta, c->min_phase) < 0) {
+        av_buffer_unref(&buf);
+        return NULL;
+    }
+    memcpy(bank + (c->filter_alloc*phase_count+1)*c->felem_size, bank, (c->filter_alloc-1)*c->felem_size);
+    memcpy(bank + (c->filter_alloc*phase_count  )*c->felem_size, bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+    /* the first tap of the causal filters is not preceded by anything */
+    if (c->min_phase)
+        memset(bank + (c->filter_alloc*phase_count)*c->felem_size, 0, c->felem_size);
+    /* the SIMD kernels read the rows up to a multiple of the vector size,
+     * keep the shifted copy from spilling into that padding */
+    memset(bank + (c->filter_alloc*phase_count + c->filter_length)*c->felem_size, 0,
+           (c->filter_alloc - c->filter_length)*c->felem_size);
+
+    filter_cache_put(&key, buf);
+
+    return buf;
+}
+
+/* number of taps before the nominal position of the output sample */
+static int filter_center(const ResampleContext *c)
+{
+    return c->min_phase ? c->filter_length - 1 : (c->filter_length - 1) / 2;
+}
+
+/**
+ * Group delay at DC of the causal filters relative to the nominal output
+ * position, in input samples. The linear phase filters have none.
+ */
+static double filter_group_delay(const ResampleContext *c)
+{
+    const int center = filter_center(c);
+    double sum = 0, wsum = 0;
+
+    if (!c->min_phase)
+        return 0;
+
+    for (int ph = 0; ph < c->phase_count; ph++) {
+        const uint8_t *f = c->filter_bank + ph * c->filter_alloc * c->felem_size;
+        for (int i = 0; i < c->filter_length; i++) {
+            double v;
+            switch (c->format) {
+            case AV_SAMPLE_FMT_S16P: v = ((const int16_t *)f)[i]; break;
+            case AV_SAMPLE_FMT_S32P: v = ((const int32_t *)f)[i]; break;
+            case AV_SAMPLE_FMT_FLTP: v = ((const float   *)f)[i]; break;
+            default:                 v = ((const double  *)f)[i]; break;
+            }
+            sum  += v;
+            wsum += v * (center - i + (double)ph / c->phase_count);
+        }
+    }
+
+    return sum ? wsum / sum : 0;
+}
+
 static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
-    av_freep(&c->filter_bank);
+    avpriv_slicethread_free(&c->slicethread);
+    av_buffer_unref(&c->filter_bank_buf);
+    av_buffer_unref(&c->filter_bank_compensation_buf);
     av_freep(cc);
 }
 
+typedef int (*resample_fn)(struct ResampleContext *c, void *dst,
+                           const void *src, int n, int update_ctx);
+
+typedef struct ResampleJob {
+    resample_fn func;
+    AudioData *dst;
+    const AudioData *src;
+    int dst_size;
+    /* resampler state after the last channel */
+    int consumed, index, frac;
+} ResampleJob;
+
+/* minimum number of multiply-adds per call for using threads */
+#define THREAD_MIN_WORK (1 << 20)
+
+/**
+ * Resample channels [ch_start, ch_end), with the multichannel kernel if
+ * there is one, so that each filter row is loaded once for several channels.
+ */
+static int resample_channels(ResampleContext *c, resample_fn func, AudioData *dst,
+                             const AudioData *src, int ch_start, int ch_end, int dst_size)
+{
+    int consumed = 0;
+
+    if (func == c->dsp.resample_common && c->dsp.resample_common_multi &&
+        ch_end - ch_start > 1)
+        return c->dsp.resample_common_multi(c, dst->ch + ch_start, src->ch + ch_start,
+                                            ch_end - ch_start, dst_size, 1);
+
+    for (int i = ch_start; i < ch_end; i++)
+        consumed = func(c, dst->ch[i], src->ch[i], dst_size, i + 1 == ch_end);
+
+    return consumed;
+}
+
+static void resample_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    const ResampleContext *c = priv;
+    ResampleJob *job = c->job;
+    /* each job advances its own copy of the resampler state */
+    ResampleContext tc = *c;
+    int ch_start = job->dst->ch_count *  jobnr      / nb_jobs;
+    int ch_end   = job->dst->ch_count * (jobnr + 1) / nb_jobs;
+    int consumed = resample_channels(&tc, job->func, job->dst, job->src,
+                                     ch_start, ch_end, job->dst_size);
+
+    if (jobnr == nb_jobs - 1) {
+        job->consumed = consumed;
+        job->index    = tc.index;
+        job->frac     = tc.frac;
+    }
+}
+
 static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff0, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta,
-                                    double precision, int cheby, int exact_rational)
+                                    double precision, int cheby, int exact_rational, int nb_threads, int min_phase,
+                                    int compensation)
 {
     double cutoff = cutoff0? cutoff0 : 0.97;
     double factor= FFMIN(out_rate * cutoff / in_rate, 1.0);
     int phase_count= 1<<phase_shift;
     int phase_count_compensation = phase_count;
     int filter_length = FFMAX((int)ceil(filter_size/factor), 1);
+    /* finer rate steps when compensating drift */
+    int incr_min = compensation ? 1 << 26 : 1 << 20;
 
     if (filter_length > 1)
         filter_length = FFALIGN(filter_length, 2);
@@ -310,7 +665,8 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     if (!c || c->phase_count != phase_count || c->linear!=linear || c->factor != factor
            || c->filter_length != filter_length || c->format != format
-           || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta) {
+           || c->filter_type != filter_type || c->kaiser_beta != kaiser_beta
+           || c->min_phase != min_phase || c->compensation != compensation) {
         resample_free(&c);
         c = av_mallocz(sizeof(*c));
         if (!c)
@@ -345,23 +701,31 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->linear        = linear;
         c->factor        = factor;
         c->filter_length = filter_length;
-        c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
+        /* the float kernels load 16 coefficients at a time with AVX-512 */
+        c->filter_alloc  = FFALIGN(c->filter_length, format == AV_SAMPLE_FMT_FLTP ? 16 : 8);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
-        if (!c->filter_bank)
-            goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+        c->min_phase     = min_phase;
+        c->compensation  = compensation;
+        c->filter_bank_buf = get_filter_bank(c, phase_count);
+        if (!c->filter_bank_buf)
             goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+        c->filter_bank   = c->filter_bank_buf->data;
+        c->group_delay   = filter_group_delay(c);
+        /* Build the filter bank used for compensation now, so that it is
+         * not computed in the middle of the stream on the first drift. */
+        if (compensation && phase_count_compensation != phase_count) {
+            c->filter_bank_compensation_buf = get_filter_bank(c, phase_count_compensation);
+            if (!c->filter_bank_compensation_buf)
+                goto error;
+        }
     }
 
     c->compensation_distance= 0;
     if(!av_reduce(&c->src_incr, &c->dst_incr, out_rate, in_rate * (int64_t)phase_count, INT32_MAX/2))
         goto error;
-    while (c->dst_incr < (1<<20) && c->src_incr < (1<<20)) {
+    while (c->dst_incr < incr_min && c->src_incr < incr_min) {
         c->dst_incr *= 2;
         c->src_incr *= 2;
     }
@@ -369,53 +733,66 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
     c->dst_incr_div   = c->dst_incr / c->src_incr;
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
 
-    c->index= -phase_count*((c->filter_length-1)/2);
+    c->index= -phase_count*filter_center(c);
     c->frac= 0;
 
+    if (c->nb_threads != nb_threads || (nb_threads != 1 && !c->slicethread)) {
+        int ret = 0;
+
+        avpriv_slicethread_free(&c->slicethread);
+        c->nb_threads   = nb_threads;
+        c->thread_count = 1;
+        if (nb_threads != 1)
+            ret = avpriv_slicethread_create(&c->slicethread, c, resample_worker,
+                                            NULL, nb_threads);
+        if (ret > 0)
+            c->thread_count = ret;
+        else if (ret < 0 && ret != AVERROR(ENOSYS))
+            goto error;
+    }
+
     swri_resample_dsp_init(c);
 
     return c;
 error:
-    av_freep(&c->filter_bank);
+    avpriv_slicethread_free(&c->slicethread);
+    av_buffer_unref(&c->filter_bank_buf);
+    av_buffer_unref(&c->filter_bank_compensation_buf);
     av_free(c);
     return NULL;
 }
 
 static int rebuild_filter_bank_with_compensation(ResampleContext *c)
 {
-    uint8_t *new_filter_bank;
+    AVBufferRef *new_filter_bank;
     int new_src_incr, new_dst_incr;
     int phase_count = c->phase_count_compensation;
-    int ret;
+    int incr_min = c->compensation ? 1 << 26 : 1 << 20;
 
     if (phase_count == c->phase_count)
         return 0;
 
     av_assert0(!c->frac && !c->dst_incr_mod);
 
-    new_filter_bank = av_calloc(c->filter_alloc, (phase_count + 1) * c->felem_size);
-    if (!new_filter_bank)
-        return AVERROR(ENOMEM);
-
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
-    if (ret < 0) {
-        av_freep(&new_filter_bank);
-        return ret;
+    if (c->filter_bank_compensation_buf) {
+        new_filter_bank = c->filter_bank_compensation_buf;
+        c->filter_bank_compensation_buf = NULL;
+    } else {
+        new_filter_bank = get_filter_bank(c, phase_count);
+        if (!new_filter_bank)
+            return AVERROR(ENOMEM);
     }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
 
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
     {
-        av_freep(&new_filter_bank);
+        av_buffer_unref(&new_filter_bank);
         return AVERROR(EINVAL);
     }
 
     c->src_incr = new_src_incr;
     c->dst_incr = new_dst_incr;
-    while (c->dst_incr < (1<<20) && c->src_incr < (1<<20)) {
+    while (c->dst_incr < incr_min && c->src_incr < incr_min) {
         c->dst_incr *= 2;
         c->src_incr *= 2;
     }
@@ -424,15 +801,20 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
     c->index         *= phase_count / c->phase_count;
     c->phase_count    = phase_count;
-    av_freep(&c->filter_bank);
-    c->filter_bank = new_filter_bank;
+    av_buffer_unref(&c->filter_bank_buf);
+    c->filter_bank_buf = new_filter_bank;
+    c->filter_bank     = new_filter_bank->data;
+    c->group_delay     = filter_group_delay(c);
     return 0;
 }
 
-static int set_compensation(ResampleContext *c, int sample_delta, int compensation_distance){
+static int set_compensation(ResampleContext *c, double sample_delta, int compensation_distance){
+    /* 16 fractional bits, integer deltas give the same dst_incr as with
+     * integer arithmetic */
+    int64_t delta = llrint(sample_delta * (1 << 16));
     int ret;
 
-    if (compensation_distance && sample_delta) {
+    if (compensation_distance && delta) {
         ret = rebuild_filter_bank_with_compensation(c);
         if (ret < 0)
             return ret;
@@ -440,7 +822,8 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
 
     c->compensation_distance= compensation_distance;
     if (compensation_distance)
-        c->dst_incr = c->ideal_dst_incr - c->ideal_dst_incr * (int64_t)sample_delta / compensation_distance;
+        c->dst_incr = c->ideal_dst_incr - av_rescale_rnd(delta, c->ideal_dst_incr,
+                                                         (int64_t)compensation_distance << 16, AV_ROUND_ZERO);
     else
         c->dst_incr = c->ideal_dst_incr;
 
@@ -483,8 +866,7 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
         int64_t end_index = (1LL + src_size - c->filter_length) * c->phase_count;
         int64_t delta_frac = (end_index - c->index) * c->src_incr - c->frac;
         int delta_n = (delta_frac + c->dst_incr - 1) / c->dst_incr;
-        int (*resample_func)(struct ResampleContext *c, void *dst,
-                             const void *src, int n, int update_ctx);
+        resample_fn resample_func;
 
         dst_size = FFMAX(FFMIN(dst_size, delta_n), 0);
         if (dst_size > 0) {
@@ -492,8 +874,25 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
              * when frac and dst_incr_mod are zero */
             resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
                             c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            if (c->slicethread && dst->ch_count > 1 &&
+                (int64_t)dst_size * c->filter_length * dst->ch_count >= THREAD_MIN_WORK) {
+                ResampleJob job = {
+                    .func     = resample_func,
+                    .dst      = dst,
+                    .src      = src,
+                    .dst_size = dst_size,
+                };
+                c->job = &job;
+                avpriv_slicethread_execute(c->slicethread,
+                                           FFMIN(c->thread_count, dst->ch_count), 0);
+                c->job    = NULL;
+                c->index  = job.index;
+                c->frac   = job.frac;
+                *consumed = job.consumed;
+            } else {
+                *consumed = resample_channels(c, resample_func, dst, src,
+                                              0, dst->ch_count, dst_size);
+            }
         }
     }
 
@@ -511,7 +910,7 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
 
 static int64_t get_delay(struct SwrContext *s, int64_t base){
     ResampleContext *c = s->resample;
-    int64_t num = s->in_buffer_count - (c->filter_length-1)/2;
+    int64_t num = s->in_buffer_count - filter_center(c);
     num *= c->phase_count;
     num -= c->index;
     num *= c->src_incr;
@@ -538,11 +937,30 @@ static int64_t get_out_samples(struct SwrContext *s, int in_samples) {
     return num;
 }
 
+static int64_t get_latency(struct SwrContext *s, int in_samples, int64_t base){
+    ResampleContext *c = s->resample;
+    int64_t src_size  = s->in_buffer_count + (int64_t)in_samples;
+    int64_t end_index = (1 + src_size - c->filter_length) * c->phase_count;
+    int64_t pos       = c->index * (int64_t)c->src_incr + c->frac;
+    int64_t delta_frac = end_index * c->src_incr - pos;
+    int64_t num;
+
+    /* move to the first output sample the call cannot produce,
+     * see multiple_resample() */
+    if (delta_frac > 0)
+        pos += (delta_frac + c->dst_incr - 1) / c->dst_incr * c->dst_incr;
+
+    num = (src_size - filter_center(c)) * c->phase_count * c->src_incr - pos;
+    return av_rescale(num, base, s->in_sample_rate*(int64_t)c->src_incr * c->phase_count) +
+           llrint(c->group_delay * base / s->in_sample_rate);
+}
+
 static int resample_flush(struct SwrContext *s) {
     ResampleContext *c = s->resample;
     AudioData *a= &s->in_buffer;
     int i, j, ret;
-    int reflection = (FFMIN(s->in_buffer_count, c->filter_length) + 1) / 2;
+    /* the causal filters need no input after the last output sample */
+    int reflection = c->min_phase ? 0 : (FFMIN(s->in_buffer_count, c->filter_length) + 1) / 2;
 
     if((ret = swri_realloc_audio(a, s->in_buffer_index + s->in_buffer_count + reflection)) < 0)
         return ret;
@@ -566,6 +984,21 @@ static int invert_initial_buffer(ResampleContext *c, AudioData *dst, const Audio
     if (c->index >= 0)
         return 0;
 
+    /* the causal filters start on silence without waiting for input */
+    if (c->min_phase) {
+        if ((res = swri_realloc_audio(dst, c->filter_length)) < 0)
+            return res;
+        for (ch = 0; ch < dst->ch_count; ch++)
+            memset(dst->ch[ch], 0, c->filter_length * c->felem_size);
+        *out_idx = c->filter_length;
+        while (c->index < 0) {
+            --*out_idx;
+            c->index += c->phase_count;
+        }
+        *out_sz = c->filter_length - *out_idx;
+        return 0;
+    }
+
     if ((res = swri_realloc_audio(dst, c->filter_length * 2 + 1)) < 0)
         return res;
 
@@ -614,4 +1047,5 @@ struct Resampler const swri_resampler={
   get_delay,
   invert_initial_buffer,
   get_out_samples,
+  get_latency,
 };
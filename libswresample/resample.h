@@ -22,14 +22,18 @@
 #ifndef SWRESAMPLE_RESAMPLE_H
 #define SWRESAMPLE_RESAMPLE_H
 
+#include "libavutil/buffer.h"
 #include "libavutil/log.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/slicethread.h"
 
 #include "swresample_internal.h"
 
+struct ResampleJob;
+
 typedef struct ResampleContext {
     const AVClass *av_class;
-    uint8_t *filter_bank;
+    const uint8_t *filter_bank;
     int filter_length;
     int filter_alloc;
     int ideal_dst_incr;
@@ -57,7 +61,23 @@ typedef struct ResampleContext {
                                const void *src, int n, int update_ctx);
         int (*resample_linear)(struct ResampleContext *c, void *dst,
                                const void *src, int n, int update_ctx);
+        /* resample_common for ch_count planes at once, NULL if unavailable */
+        int (*resample_common_multi)(struct ResampleContext *c, uint8_t **dst,
+                                     uint8_t * const *src, int ch_count,
+                                     int n, int update_ctx);
     } dsp;
+
+    AVBufferRef *filter_bank_buf;      /* backs filter_bank, may be shared with other contexts */
+    AVBufferRef *filter_bank_compensation_buf; /* prebuilt bank with phase_count_compensation phases, see resample_init() */
+
+    int nb_threads;                    /* requested number of threads, 0 for automatic */
+    int thread_count;                  /* number of threads of slicethread */
+    AVSliceThread *slicethread;
+    struct ResampleJob *job;           /* arguments of the running threaded call */
+
+    int min_phase;                     /* causal minimum phase filters, see build_filter() */
+    double group_delay;                /* low frequency group delay of the filters in input samples */
+    int compensation;                  /* set up for continuous drift compensation, see resample_init() */
 } ResampleContext;
 
 void swri_resample_dsp_init(ResampleContext *c);
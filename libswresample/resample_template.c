@@ -140,6 +140,89 @@ static int RENAME(resample_common)(ResampleContext *c,
     return sample_index;
 }
 
+/**
+ * Same as resample_common for ch_count planes, with the filter taps loaded
+ * once for MULTI_CHANNELS planes. The sums are done in the same order, so
+ * the output is identical.
+ */
+static int RENAME(resample_common_multi)(ResampleContext *c,
+                                         uint8_t **dest, uint8_t * const *source,
+                                         int ch_count, int n, int update_ctx)
+{
+    int ch, k, dst_index;
+    int index = c->index;
+    int frac = c->frac;
+    int sample_index = 0;
+
+    for (ch = 0; ch < ch_count; ch += MULTI_CHANNELS) {
+        const int nb = FFMIN(MULTI_CHANNELS, ch_count - ch);
+        const DELEM *src[MULTI_CHANNELS];
+
+        /* the missing planes of the last group repeat the first one */
+        for (k = 0; k < MULTI_CHANNELS; k++)
+            src[k] = (const DELEM *)source[ch + (k < nb ? k : 0)];
+
+        index = c->index;
+        frac = c->frac;
+        sample_index = 0;
+
+        while (index >= c->phase_count) {
+            sample_index++;
+            index -= c->phase_count;
+        }
+
+        for (dst_index = 0; dst_index < n; dst_index++) {
+            FELEM *filter = ((FELEM *) c->filter_bank) + c->filter_alloc * index;
+            FELEM2 val[MULTI_CHANNELS], val2[MULTI_CHANNELS];
+            int i;
+
+            for (k = 0; k < MULTI_CHANNELS; k++) {
+                val[k]  = FOFFSET;
+                val2[k] = 0;
+            }
+            for (i = 0; i + 1 < c->filter_length; i+=2) {
+                const FELEM2 f0 = filter[i], f1 = filter[i + 1];
+                for (k = 0; k < MULTI_CHANNELS; k++) {
+                    val[k]  += src[k][sample_index + i    ] * f0;
+                    val2[k] += src[k][sample_index + i + 1] * f1;
+                }
+            }
+            if (i < c->filter_length) {
+                const FELEM2 f0 = filter[i];
+                for (k = 0; k < MULTI_CHANNELS; k++)
+                    val[k] += src[k][sample_index + i] * f0;
+            }
+            for (k = 0; k < nb; k++) {
+                DELEM *dst = (DELEM *)dest[ch + k];
+#ifdef FELEML
+                OUT(dst[dst_index], val[k] + (FELEML)val2[k]);
+#else
+                OUT(dst[dst_index], val[k] + val2[k]);
+#endif
+            }
+
+            frac  += c->dst_incr_mod;
+            index += c->dst_incr_div;
+            if (frac >= c->src_incr) {
+                frac -= c->src_incr;
+                index++;
+            }
+
+            while (index >= c->phase_count) {
+                sample_index++;
+                index -= c->phase_count;
+            }
+        }
+    }
+
+    if(update_ctx){
+        c->frac= frac;
+        c->index= index;
+    }
+
+    return sample_index;
+}
+
 static int RENAME(resample_linear)(ResampleContext *c,
                                    void *dest, const void *source,
                                    int n, int update_ctx)
@@ -27,7 +27,7 @@
 
 #include <float.h>
 
-#define ALIGN 32
+#define ALIGN 64
 
 int swr_set_channel_mapping(struct SwrContext *s, const int *channel_map){
     if(!s || s->in_convert) // s needs to be allocated but not initialized
@@ -191,7 +191,7 @@ av_cold void swr_close(SwrContext *s){
 }
 
 av_cold int swr_init(struct SwrContext *s){
-    int ret;
+    int ret, soft_compensation;
     char l1[1024], l2[1024];
 
     clear_context(s);
@@ -382,8 +382,14 @@ av_cold int swr_init(struct SwrContext *s){
         }
     }
 
+    /* With soft compensation, prepare the resampler for it, so that the first
+     * drift does not build filters in the middle of the stream. Streams whose
+     * rates match only get a resampler once a drift is compensated. */
+    soft_compensation = s->min_compensation < FLT_MAX/2 && s->soft_compensation_duration &&
+                        s->max_soft_compensation && s->resampler->set_compensation;
+
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
-        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
+        s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational, s->nb_threads, s->low_delay, soft_compensation);
         if (!s->resample) {
             av_log(s, AV_LOG_ERROR, "Failed to initialize resampler\n");
             return AVERROR(ENOMEM);
@@ -603,7 +609,8 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     AudioData in, out, tmp;
     int ret_sum=0;
     int border=0;
-    int padless = ARCH_X86 && s->engine == SWR_ENGINE_SWR ? 7 : 0;
+    /* the AVX-512 float kernels read up to 15 samples past the filter */
+    int padless = ARCH_X86 && s->engine == SWR_ENGINE_SWR ? 15 : 0;
 
     av_assert1(s->in_buffer.ch_count == in_param->ch_count);
     av_assert1(s->in_buffer.planar   == in_param->planar);
@@ -811,7 +818,12 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
                 switch(s->int_sample_fmt) {
                 case AV_SAMPLE_FMT_S16P :swri_noise_shaping_int16(s, conv_src, preout, &s->dither.noise, out_count); break;
                 case AV_SAMPLE_FMT_S32P :swri_noise_shaping_int32(s, conv_src, preout, &s->dither.noise, out_count); break;
-                case AV_SAMPLE_FMT_FLTP :swri_noise_shaping_float(s, conv_src, preout, &s->dither.noise, out_count); break;
+                case AV_SAMPLE_FMT_FLTP :
+                    if (s->dither.ns_x4_simd)
+                        swri_noise_shaping_float_simd(s, conv_src, preout, &s->dither.noise, out_count);
+                    else
+                        swri_noise_shaping_float(s, conv_src, preout, &s->dither.noise, out_count);
+                    break;
                 case AV_SAMPLE_FMT_DBLP :swri_noise_shaping_double(s,conv_src, preout, &s->dither.noise, out_count); break;
                 }
             }
@@ -990,6 +1002,16 @@ int64_t swr_get_delay(struct SwrContext *s, int64_t base){
     }
 }
 
+int64_t swr_get_latency(struct SwrContext *s, int in_samples, int64_t base)
+{
+    if (s->resampler && s->resample && s->resampler->get_latency)
+        return s->resampler->get_latency(s, in_samples, base);
+    if (s->resampler && s->resample)
+        return s->resampler->get_delay(s, base);
+    /* without resampling, all input is converted by the call */
+    return 0;
+}
+
 int swr_get_out_samples(struct SwrContext *s, int in_samples)
 {
     int64_t out_samples;
@@ -1012,7 +1034,7 @@ int swr_get_out_samples(struct SwrContext *s, int in_samples)
     return out_samples;
 }
 
-int swr_set_compensation(struct SwrContext *s, int sample_delta, int compensation_distance){
+static int set_compensation(struct SwrContext *s, double sample_delta, int compensation_distance){
     int ret;
 
     if (!s || compensation_distance < 0)
@@ -1032,6 +1054,10 @@ int swr_set_compensation(struct SwrContext *s, int sample_delta, int compensatio
     }
 }
 
+int swr_set_compensation(struct SwrContext *s, int sample_delta, int compensation_distance){
+    return set_compensation(s, sample_delta, compensation_distance);
+}
+
 int64_t swr_next_pts(struct SwrContext *s, int64_t pts){
     if(pts == INT64_MIN)
         return s->outpts;
@@ -1056,9 +1082,10 @@ int64_t swr_next_pts(struct SwrContext *s, int64_t pts){
             } else if(s->soft_compensation_duration && s->max_soft_compensation) {
                 int duration = s->out_sample_rate * s->soft_compensation_duration;
                 double max_soft_compensation = s->max_soft_compensation / (s->max_soft_compensation < 0 ? -s->in_sample_rate : 1);
-                int comp = av_clipf(fdelta, -max_soft_compensation, max_soft_compensation) * duration ;
-                av_log(s, AV_LOG_VERBOSE, "compensating audio timestamp drift:%f compensation:%d in:%d\n", fdelta, comp, duration);
-                swr_set_compensation(s, comp, duration);
+                /* not rounded to whole samples, for a fine control of the rate */
+                double comp = av_clipd(fdelta, -max_soft_compensation, max_soft_compensation) * duration;
+                av_log(s, AV_LOG_VERBOSE, "compensating audio timestamp drift:%f compensation:%f in:%d\n", fdelta, comp, duration);
+                set_compensation(s, comp, duration);
             }
         }
 
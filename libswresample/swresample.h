@@ -533,6 +533,25 @@ int swr_inject_silence(struct SwrContext *s, int count);
  */
 int64_t swr_get_delay(struct SwrContext *s, int64_t base);
 
+/**
+ * Gets the algorithmic latency of the output of the next swr_convert() call,
+ * if it is called with in_samples input samples and enough output space.
+ *
+ * This is the delay swr_get_delay() will return after that call, plus the
+ * low frequency group delay of the resampling filter. The latter is only
+ * nonzero with the causal minimum phase filters of the low_delay option, the
+ * delay of the default linear phase filters is part of the buffered samples.
+ * Unlike swr_get_delay(), this can be used to know the latency of the output
+ * of a call before making it.
+ *
+ * @param s          initialized swr context
+ * @param in_samples number of input samples of the next call
+ * @param base       timebase in which the returned latency will be, see
+ *                   swr_get_delay()
+ * @returns          the latency in 1 / @c base units.
+ */
+int64_t swr_get_latency(struct SwrContext *s, int in_samples, int64_t base);
+
 /**
  * Find an upper bound on the number of samples that the next swr_convert
  * call will output, if called with in_samples of input samples. This
@@ -41,6 +41,18 @@ typedef void (mix_1_1_func_type)(void *out, const void *in, void *coeffp, intege
 typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, void *coeffp, integer index1, integer index2, integer len);
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
+typedef void (mix_n_1_func_type)(void *out, const void * const *in, const void *coeffp, integer nb_in, integer len);
+
+/**
+ * Noise shaping of 4 interleaved float channels.
+ * coeffs holds the scale^-1 and scale for all 4 channels followed by each
+ * filter coefficient repeated 4 times, errors the interleaved error history.
+ */
+typedef void (noise_shaping_x4_func_type)(float *dst, const float *src, const float *noise, float *errors,
+                                          const float *coeffs, integer taps, integer pos, integer len);
+
+/* bytes per output channel in SwrContext.native_matrix_n */
+#define NATIVE_MATRIX_N_STRIDE(s) ((SWR_CH_MAX + 1) * ((s)->midbuf.fmt == AV_SAMPLE_FMT_DBLP ? 8 : 4))
 
 typedef struct AudioData{
     uint8_t *ch[SWR_CH_MAX];    ///< samples buffer per channel
@@ -66,17 +78,22 @@ struct DitherContext {
     AudioData noise;                                ///< noise used for dithering
     AudioData temp;                                 ///< temporary storage when writing into the input buffer isn't possible
     int output_sample_bits;                         ///< the number of used output bits, needed to scale dither correctly
+
+    noise_shaping_x4_func_type *ns_x4_f;
+    noise_shaping_x4_func_type *ns_x4_simd;
 };
 
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
-                                    double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
+                                    double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational,
+                                    int nb_threads, int min_phase, int compensation);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
 typedef int     (* multiple_resample_func)(struct ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed);
 typedef int     (* resample_flush_func)(struct SwrContext *c);
-typedef int     (* set_compensation_func)(struct ResampleContext *c, int sample_delta, int compensation_distance);
+typedef int     (* set_compensation_func)(struct ResampleContext *c, double sample_delta, int compensation_distance);
 typedef int64_t (* get_delay_func)(struct SwrContext *s, int64_t base);
 typedef int     (* invert_initial_buffer_func)(struct ResampleContext *c, AudioData *dst, const AudioData *src, int src_size, int *dst_idx, int *dst_count);
 typedef int64_t (* get_out_samples_func)(struct SwrContext *s, int in_samples);
+typedef int64_t (* get_latency_func)(struct SwrContext *s, int in_samples, int64_t base);
 
 struct Resampler {
   resample_init_func            init;
@@ -87,6 +104,7 @@ struct Resampler {
   get_delay_func                get_delay;
   invert_initial_buffer_func    invert_initial_buffer;
   get_out_samples_func          get_out_samples;
+  get_latency_func              get_latency;
 };
 
 extern struct Resampler const swri_resampler;
@@ -138,6 +156,8 @@ struct SwrContext {
     double kaiser_beta;                                /**< swr beta value for Kaiser window (only applicable if filter_type == AV_FILTER_TYPE_KAISER) */
     double precision;                               /**< soxr resampling precision (in bits) */
     int cheby;                                      /**< soxr: if 1 then passband rolloff will be none (Chebyshev) & irrational ratio approximation precision will be higher */
+    int nb_threads;                                 /**< swr: number of threads resampling channels in parallel, 0 for automatic */
+    int low_delay;                                  /**< swr: if 1 then use causal minimum phase filters */
 
     float min_compensation;                         ///< swr minimum below which no compensation will happen
     float min_hard_compensation;                    ///< swr minimum below which no silence inject / sample drop will happen
@@ -179,6 +199,8 @@ struct SwrContext {
     uint8_t *native_one;
     uint8_t *native_simd_one;
     uint8_t *native_simd_matrix;
+    uint8_t *native_matrix_n;                       ///< per output coefficients of the inputs listed in matrix_ch, see rematrix.c
+    uint8_t *native_simd_matrix_n;                  ///< native_matrix_n for mix_n_1_simd if it needs another layout
     int32_t matrix32[SWR_CH_MAX][SWR_CH_MAX];       ///< 17.15 fixed point rematrixing coefficients
     uint8_t matrix_ch[SWR_CH_MAX][SWR_CH_MAX+1];    ///< Lists of input channels per output channel that have non zero rematrixing coefficients
     mix_1_1_func_type *mix_1_1_f;
@@ -189,6 +211,9 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    mix_n_1_func_type *mix_n_1_f;
+    mix_n_1_func_type *mix_n_1_simd;
+
     /* TODO: callbacks for ASM optimizations */
 };
 
@@ -199,6 +224,7 @@ void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *
 void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_double(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
+void swri_noise_shaping_float_simd(SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 
 av_warn_unused_result
 int swri_rematrix_init(SwrContext *s);
@@ -210,6 +236,7 @@ av_warn_unused_result
 int swri_get_dither(SwrContext *s, void *dst, int len, unsigned seed, enum AVSampleFormat noise_fmt);
 av_warn_unused_result
 int swri_dither_init(SwrContext *s, enum AVSampleFormat out_fmt, enum AVSampleFormat in_fmt);
+void swri_dither_init_x86(struct DitherContext *c);
 
 void swri_audio_convert_init_aarch64(struct AudioConvert *ac,
                                  enum AVSampleFormat out_fmt,
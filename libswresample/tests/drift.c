@@ -0,0 +1,158 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that soft compensation follows a clock drift of a few ppm to a
+ * fraction of a sample, and that it leaves the output untouched when the
+ * timestamps do not drift.
+ *
+ * The timestamps of the input run slightly faster or slower than its
+ * samples. After every call, the difference between the timestamps and the
+ * output, as seen by swr_next_pts(), must stay below TOLERANCE once the
+ * compensation has settled. The compensation corrects the difference at a
+ * rate of 1/s, so it settles at ppm * out_rate / 1e6 samples. Rounded to
+ * whole samples, the compensation would be 0 for drifts this small, and the
+ * difference would keep growing.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/macros.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libswresample/swresample.h"
+
+#define CHUNK       1024
+#define DURATION    10      ///< in seconds
+#define TOLERANCE   0.25    ///< in output samples
+
+static const struct {
+    int in_rate, out_rate;
+    double ppm;             ///< drift of the input timestamps
+} tests[] = {
+    { 44100, 48000,   0 },
+    { 44100, 48000,   4 },
+    { 44100, 48000,  -4 },
+    { 48000, 44100,   3 },
+    { 48000,  8000, -20 },
+};
+
+static SwrContext *alloc_swr(int in_rate, int out_rate, int compensate)
+{
+    AVChannelLayout mono = AV_CHANNEL_LAYOUT_MONO;
+    SwrContext *s = NULL;
+
+    if (swr_alloc_set_opts2(&s, &mono, AV_SAMPLE_FMT_DBL, out_rate,
+                                &mono, AV_SAMPLE_FMT_DBL, in_rate, 0, NULL) < 0)
+        return NULL;
+    if (compensate) {
+        av_opt_set_double(s, "min_comp",      1e-7, 0);
+        av_opt_set_double(s, "comp_duration", 0.05, 0);
+        av_opt_set_double(s, "max_soft_comp", 0.01, 0);
+    }
+    if (swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static int run_test(int n)
+{
+    const int in_rate = tests[n].in_rate, out_rate = tests[n].out_rate;
+    const int64_t base = (int64_t)in_rate * out_rate;
+    const int nb_calls = DURATION * in_rate / CHUNK;
+    SwrContext *s   = alloc_swr(in_rate, out_rate, 1);
+    SwrContext *ref = alloc_swr(in_rate, out_rate, 0);
+    int out_max = av_rescale_rnd(CHUNK, out_rate, in_rate, AV_ROUND_UP) + 256;
+    double *in = av_malloc_array(CHUNK, sizeof(*in));
+    double *out = av_malloc_array(out_max, sizeof(*out));
+    double *out_ref = av_malloc_array(out_max, sizeof(*out_ref));
+    double max_err = 0;
+    int64_t total_in = 0;
+    int ret = 0, differs = 0;
+
+    if (!s || !ref || !in || !out || !out_ref) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (int call = 0; call < nb_calls; call++) {
+        int64_t pts = llrint(total_in * (double)out_rate * (1 + tests[n].ppm * 1e-6));
+        int ret_ref;
+        double err;
+
+        for (int i = 0; i < CHUNK; i++)
+            in[i] = 0.5 * sin(2 * M_PI * 440 * (total_in + i) / in_rate);
+        total_in += CHUNK;
+
+        swr_next_pts(s, pts);
+        ret = swr_convert(s, (uint8_t **)&out, out_max, (const uint8_t **)&in, CHUNK);
+        if (ret < 0)
+            goto end;
+        ret_ref = swr_convert(ref, (uint8_t **)&out_ref, out_max, (const uint8_t **)&in, CHUNK);
+        if (ret_ref < 0) {
+            ret = ret_ref;
+            goto end;
+        }
+        if (!tests[n].ppm)
+            differs |= ret != ret_ref || memcmp(out, out_ref, ret * sizeof(*out));
+
+        /* distance of the next timestamp from the output, skipping the
+         * first half for the compensation to settle */
+        pts = llrint(total_in * (double)out_rate * (1 + tests[n].ppm * 1e-6));
+        err = (pts - swr_get_delay(s, base) - swr_next_pts(s, INT64_MIN)) / (double)in_rate;
+        if (call >= nb_calls / 2)
+            max_err = FFMAX(max_err, fabs(err));
+    }
+
+    printf("%d -> %d %+g ppm: drift %s", in_rate, out_rate, tests[n].ppm,
+           max_err < TOLERANCE ? "followed" : "not followed");
+    if (!tests[n].ppm)
+        printf(", output %s", differs ? "differs" : "unchanged");
+    printf("\n");
+    if (max_err >= TOLERANCE)
+        fprintf(stderr, "max error %f output samples\n", max_err);
+    ret = max_err >= TOLERANCE || differs;
+
+end:
+    swr_free(&s);
+    swr_free(&ref);
+    av_free(in);
+    av_free(out);
+    av_free(out_ref);
+    return ret;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        int err = run_test(i);
+        if (err < 0)
+            fprintf(stderr, "test %d failed: %s\n", i, av_err2str(err));
+        if (err)
+            ret = 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,162 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the latency predicted by swr_get_latency() before a call
+ * matches the delay measured on the output, with and without low_delay.
+ *
+ * A low frequency tone is resampled in chunks of random size. If the
+ * prediction is right, the position of the output stream relative to the
+ * input stream computed from it is the same after every call, and equal to
+ * the phase delay of the tone measured on the output.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+
+#include "libswresample/swresample.h"
+
+#define MAX_CHUNK   1024
+#define NB_CALLS    200
+#define TONE_PERIOD 480     ///< in input samples
+#define TOLERANCE   0.01    ///< in input samples
+
+static const struct {
+    int in_rate, out_rate;
+} tests[] = {
+    { 48000, 44100 },
+    { 44100, 48000 },
+    { 48000,  8000 },
+    {  8000, 48000 },
+    { 44100, 22050 },
+};
+
+static int run_test(int n, int low_delay, AVLFG *lfg)
+{
+    const int in_rate = tests[n].in_rate, out_rate = tests[n].out_rate;
+    const int64_t base = (int64_t)in_rate * out_rate;
+    const double omega = 2 * M_PI / TONE_PERIOD * in_rate;
+    AVChannelLayout mono = AV_CHANNEL_LAYOUT_MONO;
+    SwrContext *s = NULL;
+    double *in = NULL, *out = NULL;
+    int out_max = av_rescale_rnd(MAX_CHUNK, out_rate, in_rate, AV_ROUND_UP) + 256;
+    int64_t total_in = 0, total_out = 0;
+    double min_pred = INFINITY, max_pred = -INFINITY;
+    double ys = 0, yc = 0, ss = 0, cc = 0, sc = 0, a, b, det, measured, err;
+    int ret, warmup = -1;
+
+    ret = swr_alloc_set_opts2(&s, &mono, AV_SAMPLE_FMT_DBL, out_rate,
+                                  &mono, AV_SAMPLE_FMT_DBL, in_rate, 0, NULL);
+    if (ret < 0)
+        goto end;
+    av_opt_set_int(s, "low_delay", low_delay, 0);
+    if ((ret = swr_init(s)) < 0)
+        goto end;
+
+    in  = av_malloc_array(MAX_CHUNK, sizeof(*in));
+    out = av_malloc_array(out_max,   sizeof(*out));
+    if (!in || !out) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (int call = 0; call < NB_CALLS; call++) {
+        int in_samples = 1 + av_lfg_get(lfg) % MAX_CHUNK;
+        int64_t latency = swr_get_latency(s, in_samples, base);
+        double pred;
+
+        for (int i = 0; i < in_samples; i++)
+            in[i] = 0.5 * sin(omega * (total_in + i) / in_rate);
+
+        ret = swr_convert(s, (uint8_t **)&out, out_max,
+                          (const uint8_t **)&in, in_samples);
+        if (ret < 0)
+            goto end;
+
+        /* let the filter settle before measuring */
+        if (warmup < 0 && total_out >= out_rate / 10)
+            warmup = call;
+        if (warmup >= 0) {
+            for (int i = 0; i < ret; i++) {
+                double si = sin(omega * (total_out + i) / out_rate);
+                double co = cos(omega * (total_out + i) / out_rate);
+                ys += out[i] * si;
+                yc += out[i] * co;
+                ss += si * si;
+                cc += co * co;
+                sc += si * co;
+            }
+        }
+
+        total_in  += in_samples;
+        total_out += ret;
+
+        /* delay of the output stream relative to the input, in input samples */
+        pred = (total_out * (double)in_rate / out_rate - total_in) +
+               latency / (double)out_rate;
+        min_pred = FFMIN(min_pred, pred);
+        max_pred = FFMAX(max_pred, pred);
+    }
+
+    /* least squares fit of out = a * sin + b * cos, the phase gives the delay */
+    det = ss * cc - sc * sc;
+    a   = (ys * cc - yc * sc) / det;
+    b   = (yc * ss - ys * sc) / det;
+    measured = -atan2(b, a) / omega * in_rate;
+    err = FFMAX(fabs(max_pred - measured), fabs(min_pred - measured));
+
+    printf("%d -> %d low_delay %d: latency %s\n", in_rate, out_rate, low_delay,
+           err < TOLERANCE ? "ok" : "differs");
+    if (err >= TOLERANCE)
+        fprintf(stderr, "predicted %f..%f, measured %f input samples\n",
+                min_pred, max_pred, measured);
+    ret = err >= TOLERANCE;
+
+end:
+    swr_free(&s);
+    av_free(in);
+    av_free(out);
+    return ret;
+}
+
+int main(void)
+{
+    AVLFG lfg;
+    int ret = 0;
+
+    av_lfg_init(&lfg, 1);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        for (int low_delay = 0; low_delay <= 1; low_delay++) {
+            int err = run_test(i, low_delay, &lfg);
+            if (err < 0)
+                fprintf(stderr, "test %d failed: %s\n", i, av_err2str(err));
+            if (err)
+                ret = 1;
+        }
+    }
+
+    return ret;
+}
@@ -23,6 +23,7 @@
 #include "libavutil/channel_layout.h"
 #include "libavutil/common.h"
 #include "libavutil/opt.h"
+#include "libavutil/time.h"
 
 #include "libswresample/swresample.h"
 
@@ -222,6 +223,56 @@ static void audiogen(void *data, enum AVSampleFormat sample_fmt,
     }
 }
 
+static int bench_init(void)
+{
+    static const struct {
+        int in_rate, out_rate, filter_size, phase_shift;
+        enum AVSampleFormat fmt;
+    } configs[] = {
+        { 48000, 44100,  32, 10, AV_SAMPLE_FMT_S16P },
+        { 48000, 44100,  32, 10, AV_SAMPLE_FMT_FLTP },
+        { 48000, 44100,  64, 12, AV_SAMPLE_FMT_FLTP },
+        { 48000, 44100, 128, 14, AV_SAMPLE_FMT_FLTP },
+        { 44100, 48000,  64, 12, AV_SAMPLE_FMT_FLTP },
+        { 96000, 44100,  64, 12, AV_SAMPLE_FMT_DBLP },
+    };
+    static const int runs = 100;
+    AVChannelLayout layout = AV_CHANNEL_LAYOUT_STEREO;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(configs); i++) {
+        int64_t t, first = 0;
+
+        t = av_gettime_relative();
+        for (int run = 0; run < runs; run++) {
+            struct SwrContext *ctx = NULL;
+
+            if (swr_alloc_set_opts2(&ctx, &layout, configs[i].fmt, configs[i].out_rate,
+                                          &layout, configs[i].fmt, configs[i].in_rate,
+                                          0, NULL) < 0)
+                return 1;
+            av_opt_set_int(ctx, "filter_size", configs[i].filter_size, 0);
+            av_opt_set_int(ctx, "phase_shift", configs[i].phase_shift, 0);
+            av_opt_set_int(ctx, "exact_rational", 0, 0);
+            if (swr_init(ctx) < 0) {
+                swr_free(&ctx);
+                return 1;
+            }
+            swr_free(&ctx);
+            if (!run)
+                first = av_gettime_relative() - t;
+        }
+        t = av_gettime_relative() - t;
+
+        fprintf(stderr, "rate:%5d->%5d filter_size:%3d phase_shift:%2d fmt:%s first:%8.1fus avg:%8.1fus\n",
+                configs[i].in_rate, configs[i].out_rate,
+                configs[i].filter_size, configs[i].phase_shift,
+                av_get_sample_fmt_name(configs[i].fmt),
+                (double)first, (double)t / runs);
+    }
+
+    return 0;
+}
+
 int main(int argc, char **argv){
     int in_sample_rate, out_sample_rate, ch ,i, flush_count;
     AVChannelLayout in_ch_layout = { 0 }, out_ch_layout = { 0 };
@@ -248,9 +299,13 @@ int main(int argc, char **argv){
     if (argc > 1) {
         if (!strcmp(argv[1], "-h") || !strcmp(argv[1], "--help")) {
             av_log(NULL, AV_LOG_INFO, "Usage: swresample-test [<num_tests>[ <test>]]  \n"
-                   "num_tests           Default is %d\n", num_tests);
+                   "       swresample-test -bench\n"
+                   "num_tests           Default is %d\n"
+                   "-bench              Time swr_init() for a few common setups\n", num_tests);
             return 0;
         }
+        if (!strcmp(argv[1], "-bench"))
+            return bench_init();
         num_tests = strtol(argv[1], NULL, 0);
         if(num_tests < 0) {
             num_tests = -num_tests;
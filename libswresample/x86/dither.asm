@@ -0,0 +1,93 @@
+;******************************************************************************
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION .text
+
+%if ARCH_X86_64
+; void noise_shaping_float_x4(float *dst, const float *src, const float *noise,
+;                             float *errors, const float *coeffs,
+;                             integer taps, integer pos, integer len)
+; One lane per channel, the products and sums are meant to be done in the same
+; order and precision as the C code; checkasm compares the output with it.
+INIT_YMM avx
+cglobal noise_shaping_float_x4, 8, 11, 5, dst, src, noise, errors, coeffs, taps, pos, len, gend, j, err
+    mova            xm3, [coeffsq]          ; scale^-1
+    cvtps2pd         m4, [coeffsq + 16]     ; scale
+    add         coeffsq, 32
+    shl           tapsq, 4
+    shl            posq, 4
+    lea           gendq, [tapsq + 16]       ; (taps + 1) / 4 groups of 4 taps
+    and           gendq, ~63
+    shl            lenq, 4
+    add            srcq, lenq
+    add            dstq, lenq
+    add          noiseq, lenq
+    neg            lenq
+.loop:
+    mulps           xm0, xm3, [srcq + lenq]
+    cvtps2pd         m0, xm0
+    lea            errq, [errorsq + posq]
+    xor             jd, jd
+    test          gendq, gendq
+    jz .tail
+.group:
+    mova            xm1, [coeffsq + jq]
+    mulps           xm1, [errq + jq]
+    mova            xm2, [coeffsq + jq + 16]
+    mulps           xm2, [errq + jq + 16]
+    addps           xm1, xm2
+    mova            xm2, [coeffsq + jq + 32]
+    mulps           xm2, [errq + jq + 32]
+    addps           xm1, xm2
+    mova            xm2, [coeffsq + jq + 48]
+    mulps           xm2, [errq + jq + 48]
+    addps           xm1, xm2
+    cvtps2pd         m1, xm1
+    subpd            m0, m1
+    add              jq, 64
+    cmp              jq, gendq
+    jl .group
+.tail:
+    cmp              jq, tapsq
+    jge .noise
+    mova            xm1, [coeffsq + jq]
+    mulps           xm1, [errq + jq]
+    cvtps2pd         m1, xm1
+    subpd            m0, m1
+.noise:
+    cvtps2pd         m1, [noiseq + lenq]
+    addpd            m1, m0
+    roundpd          m1, m1, 4              ; rint()
+    subpd            m2, m1, m0
+    cvtpd2ps        xm2, m2
+    sub            posq, 16
+    jge .nowrap
+    add            posq, tapsq
+.nowrap:
+    lea            errq, [errorsq + posq]
+    mova  [errq        ], xm2
+    mova  [errq + tapsq], xm2
+    mulpd            m1, m4
+    cvtpd2ps        xm1, m1
+    movu  [dstq + lenq], xm1
+    add            lenq, 16
+    jl .loop
+    RET
+%endif
@@ -24,6 +24,7 @@
 SECTION_RODATA 32
 dw1: times 8  dd 1
 w1 : times 16 dw 1
+dq16384: times 4 dq 16384
 
 SECTION .text
 
@@ -242,3 +243,125 @@ MIX2_FLT a
 MIX1_FLT u
 MIX1_FLT a
 %endif
+
+%if ARCH_X86_64
+; Mix nb_in inputs into one output, in points to the input pointers, coeffp
+; to their coefficients; len must be a multiple of 16, there are no alignment
+; requirements. The inputs are summed in the same order as the C code.
+%macro MIXN_FLT 0
+cglobal mix_n_1_float, 5, 8, 5, out, in, coeffp, nb_in, len, i, src, pos
+    shl        lenq, 2
+    xor        posq, posq
+.next:
+    xorps        m0, m0
+    xorps        m1, m1
+    xor          iq, iq
+.next_in:
+    mov        srcq, [inq + iq*gprsize]
+    VBROADCASTSS m2, [coeffpq + 4*iq]
+    movu         m3, [srcq + posq         ]
+    movu         m4, [srcq + posq + mmsize]
+    mulps        m3, m3, m2
+    mulps        m4, m4, m2
+    addps        m0, m0, m3
+    addps        m1, m1, m4
+    inc          iq
+    cmp          iq, nb_inq
+        jl .next_in
+    movu  [outq + posq         ], m0
+    movu  [outq + posq + mmsize], m1
+    add        posq, mmsize*2
+    cmp        posq, lenq
+        jl .next
+    RET
+%endmacro
+
+; coeffp holds the shift followed by pairs of 16 bit coefficients,
+; in[nb_in] must be valid for odd nb_in, its coefficient is 0
+%macro MIXN_INT16 0
+cglobal mix_n_1_int16, 5, 8, 8, out, in, coeffp, nb_in, len, i, src, pos
+    movd        xm4, [coeffpq]
+    mova         m5, [dw1]
+    pslld        m5, xm4
+    psrld        m5, 1
+    add        lenq, lenq
+    xor        posq, posq
+.next:
+    mova         m0, m5
+    mova         m1, m5
+    xor          iq, iq
+.next_in:
+    mov        srcq, [inq + iq*gprsize]
+    movu         m2, [srcq + posq]
+    mov        srcq, [inq + iq*gprsize + gprsize]
+    movu         m6, [srcq + posq]
+    VPBROADCASTD m7, [coeffpq + 2*iq + 4]
+    mova         m3, m2
+    punpcklwd    m2, m6
+    punpckhwd    m3, m6
+    pmaddwd      m2, m7
+    pmaddwd      m3, m7
+    paddd        m0, m2
+    paddd        m1, m3
+    add          iq, 2
+    cmp          iq, nb_inq
+        jl .next_in
+    psrad        m0, xm4
+    psrad        m1, xm4
+    packssdw     m0, m1
+    movu  [outq + posq], m0
+    add        posq, mmsize
+    cmp        posq, lenq
+        jl .next
+    RET
+%endmacro
+
+; 64 bit sums of the 17.15 fixed point products, like the C code
+%macro MIXN_INT32 0
+cglobal mix_n_1_int32, 5, 8, 5, out, in, coeffp, nb_in, len, i, src, pos
+    shl        lenq, 2
+    xor        posq, posq
+.next:
+    mova         m0, [dq16384]
+    mova         m1, m0
+    xor          iq, iq
+.next_in:
+    mov        srcq, [inq + iq*gprsize]
+    vpbroadcastd m4, [coeffpq + 4*iq]
+    pmovsxdq     m2, [srcq + posq     ]
+    pmovsxdq     m3, [srcq + posq + 16]
+    pmuldq       m2, m4
+    pmuldq       m3, m4
+    paddq        m0, m2
+    paddq        m1, m3
+    inc          iq
+    cmp          iq, nb_inq
+        jl .next_in
+    psrlq        m0, 15
+    psrlq        m1, 15
+    shufps       m0, m1, q2020
+    vpermq       m0, m0, q3120
+    movu  [outq + posq], m0
+    add        posq, mmsize
+    cmp        posq, lenq
+        jl .next
+    RET
+%endmacro
+
+INIT_XMM sse
+MIXN_FLT
+
+INIT_XMM sse2
+MIXN_INT16
+
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+MIXN_FLT
+%endif
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+MIXN_INT16
+MIXN_INT32
+%endif
+%endif ; ARCH_X86_64
@@ -30,6 +30,12 @@ D(float, sse)
 D(float, avx)
 D(int16, sse2)
 
+mix_n_1_func_type ff_mix_n_1_float_sse;
+mix_n_1_func_type ff_mix_n_1_float_avx;
+mix_n_1_func_type ff_mix_n_1_int16_sse2;
+mix_n_1_func_type ff_mix_n_1_int16_avx2;
+mix_n_1_func_type ff_mix_n_1_int32_avx2;
+
 av_cold int swri_rematrix_init_x86(struct SwrContext *s){
 #if HAVE_X86ASM
     int mm_flags = av_get_cpu_flags();
@@ -46,6 +52,34 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
             s->mix_1_1_simd = ff_mix_1_1_a_int16_sse2;
             s->mix_2_1_simd = ff_mix_2_1_a_int16_sse2;
         }
+        if (ARCH_X86_64 && EXTERNAL_SSE2(mm_flags)) {
+            int exact = 1;
+
+            /* The kernels take 16 bit coefficients and sum in 32 bits. Use
+             * them only if that gives the same result as the C code, i.e.
+             * no gain reaches 1.0 and the sums cannot overflow. */
+            s->native_simd_matrix_n = av_calloc(nb_out, NATIVE_MATRIX_N_STRIDE(s));
+            if (!s->native_simd_matrix_n)
+                return AVERROR(ENOMEM);
+            for (i = 0; i < nb_out; i++) {
+                const int32_t *coeff = (const int32_t *)(s->native_matrix_n + i * NATIVE_MATRIX_N_STRIDE(s));
+                uint8_t *coeffp = s->native_simd_matrix_n + i * NATIVE_MATRIX_N_STRIDE(s);
+                int64_t sum = 0;
+
+                ((int32_t *)coeffp)[0] = 15;
+                for (j = 0; j < s->matrix_ch[i][0]; j++) {
+                    if (coeff[j] != (int16_t)coeff[j])
+                        exact = 0;
+                    sum += FFABS(coeff[j]);
+                    ((int16_t *)(coeffp + 4))[j] = coeff[j];
+                }
+                if (s->matrix_ch[i][0] > 2 && sum > 65535)
+                    exact = 0;
+            }
+            if (exact)
+                s->mix_n_1_simd = EXTERNAL_AVX2_FAST(mm_flags) ? ff_mix_n_1_int16_avx2
+                                                              : ff_mix_n_1_int16_sse2;
+        }
         s->native_simd_matrix = av_calloc(num,  2 * sizeof(int16_t));
         s->native_simd_one    = av_mallocz(2 * sizeof(int16_t));
         if (!s->native_simd_matrix || !s->native_simd_one)
@@ -73,12 +107,19 @@ av_cold int swri_rematrix_init_x86(struct SwrContext *s){
             s->mix_1_1_simd = ff_mix_1_1_a_float_avx;
             s->mix_2_1_simd = ff_mix_2_1_a_float_avx;
         }
+        if (ARCH_X86_64 && EXTERNAL_SSE(mm_flags))
+            s->mix_n_1_simd = ff_mix_n_1_float_sse;
+        if (ARCH_X86_64 && EXTERNAL_AVX_FAST(mm_flags))
+            s->mix_n_1_simd = ff_mix_n_1_float_avx;
         s->native_simd_matrix = av_calloc(num, sizeof(float));
         s->native_simd_one = av_mallocz(sizeof(float));
         if (!s->native_simd_matrix || !s->native_simd_one)
             return AVERROR(ENOMEM);
         memcpy(s->native_simd_matrix, s->native_matrix, num * sizeof(float));
         memcpy(s->native_simd_one, s->native_one, sizeof(float));
+    } else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
+        if (ARCH_X86_64 && EXTERNAL_AVX2_FAST(mm_flags))
+            s->mix_n_1_simd = ff_mix_n_1_int32_avx2;
     }
 #endif
 
@@ -41,9 +41,11 @@ RESAMPLE_FUNCS(float,  sse);
 RESAMPLE_FUNCS(float,  avx);
 RESAMPLE_FUNCS(float,  fma3);
 RESAMPLE_FUNCS(float,  fma4);
+RESAMPLE_FUNCS(float,  avx512);
 RESAMPLE_FUNCS(double, sse2);
 RESAMPLE_FUNCS(double, avx);
 RESAMPLE_FUNCS(double, fma3);
+RESAMPLE_FUNCS(double, avx512);
 
 av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
 {
@@ -77,6 +79,10 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
             c->dsp.resample_linear = ff_resample_linear_float_fma4;
             c->dsp.resample_common = ff_resample_common_float_fma4;
         }
+        if (EXTERNAL_AVX512(mm_flags)) {
+            c->dsp.resample_linear = ff_resample_linear_float_avx512;
+            c->dsp.resample_common = ff_resample_common_float_avx512;
+        }
         break;
     case AV_SAMPLE_FMT_DBLP:
         if (EXTERNAL_SSE2(mm_flags)) {
@@ -91,6 +97,10 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
             c->dsp.resample_linear = ff_resample_linear_double_fma3;
             c->dsp.resample_common = ff_resample_common_double_fma3;
         }
+        if (EXTERNAL_AVX512(mm_flags)) {
+            c->dsp.resample_linear = ff_resample_linear_double_avx512;
+            c->dsp.resample_common = ff_resample_common_double_avx512;
+        }
         break;
     }
 }
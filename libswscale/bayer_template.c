@@ -184,12 +184,6 @@
     B(1, 1) = (T(0, 1) + T(2, 1)) >> 1;
 #endif
 
-/**
- * invoke ff_rgb24toyv12 for 2x2 pixels
- */
-#define rgb24toyv12_2x2(src, dstY, dstU, dstV, luma_stride, src_stride, rgb2yuv) \
-    ff_rgb24toyv12(src, dstY, dstV, dstU, 2, 2, luma_stride, 0, src_stride, rgb2yuv)
-
 static void BAYER_RENAME(rgb24_copy)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width)
 {
     int i;
@@ -200,11 +194,14 @@ static void BAYER_RENAME(rgb24_copy)(const uint8_t *src, int src_stride, uint8_t
     }
 }
 
-static void BAYER_RENAME(rgb24_interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width)
+/**
+ * interpolate the inner columns [2, width - 2), the caller copies the
+ * first and the last pixel pair
+ */
+static void BAYER_RENAME(rgb24_interpolate_inner)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width)
 {
     int i;
 
-    BAYER_TO_RGB24_COPY
     src += 2 * BAYER_SIZEOF;
     dst += 6;
 
@@ -213,10 +210,6 @@ static void BAYER_RENAME(rgb24_interpolate)(const uint8_t *src, int src_stride,
         src += 2 * BAYER_SIZEOF;
         dst += 6;
     }
-
-    if (width > 2) {
-        BAYER_TO_RGB24_COPY
-    }
 }
 
 static void BAYER_RENAME(rgb48_copy)(const uint8_t *src, int src_stride, uint8_t *ddst, int dst_stride, int width)
@@ -232,13 +225,12 @@ static void BAYER_RENAME(rgb48_copy)(const uint8_t *src, int src_stride, uint8_t
     }
 }
 
-static void BAYER_RENAME(rgb48_interpolate)(const uint8_t *src, int src_stride, uint8_t *ddst, int dst_stride, int width)
+static void BAYER_RENAME(rgb48_interpolate_inner)(const uint8_t *src, int src_stride, uint8_t *ddst, int dst_stride, int width)
 {
     uint16_t *dst = (uint16_t *)ddst;
     int i;
 
     dst_stride /= 2;
-    BAYER_TO_RGB48_COPY
     src += 2 * BAYER_SIZEOF;
     dst += 6;
 
@@ -247,53 +239,6 @@ static void BAYER_RENAME(rgb48_interpolate)(const uint8_t *src, int src_stride,
         src += 2 * BAYER_SIZEOF;
         dst += 6;
     }
-
-    if (width > 2) {
-        BAYER_TO_RGB48_COPY
-    }
-}
-
-static void BAYER_RENAME(yv12_copy)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv)
-{
-    uint8_t dst[12];
-    const int dst_stride = 6;
-    int i;
-    for (i = 0 ; i < width; i+= 2) {
-        BAYER_TO_RGB24_COPY
-        rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
-        src  += 2 * BAYER_SIZEOF;
-        dstY += 2;
-        dstU++;
-        dstV++;
-    }
-}
-
-static void BAYER_RENAME(yv12_interpolate)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv)
-{
-    uint8_t dst[12];
-    const int dst_stride = 6;
-    int i;
-
-    BAYER_TO_RGB24_COPY
-    rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
-    src  += 2 * BAYER_SIZEOF;
-    dstY += 2;
-    dstU++;
-    dstV++;
-
-    for (i = 2 ; i < width - 2; i+= 2) {
-        BAYER_TO_RGB24_INTERPOLATE
-        rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
-        src  += 2 * BAYER_SIZEOF;
-        dstY += 2;
-        dstU++;
-        dstV++;
-    }
-
-    if (width > 2) {
-        BAYER_TO_RGB24_COPY
-        rgb24toyv12_2x2(dst, dstY, dstU, dstV, luma_stride, dst_stride, rgb2yuv);
-    }
 }
 
 #undef S
@@ -0,0 +1,333 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Fused 2:1 downscaling of YUV images.
+ *
+ * For an exact 2:1 downscale with the area or bilinear filter every output
+ * sample is a fixed weighted sum of a 2x2 or 4x4 block of input samples.
+ * When the horizontal scaler keeps all bits of that sum, the generic
+ * hscale -> vscale -> output chain reduces to a single rounding step, so
+ * the output can be computed directly from the source planes without the
+ * intermediate line buffers. The result is identical to the C versions of
+ * the generic path, and to the SIMD ones as long as 8-bit output is only
+ * fused with SWS_ACCURATE_RND.
+ *
+ * The fused loops are plain C. They beat the C scalers by 1.5-3x but are
+ * several times slower than the SIMD ones, so ff_sws_init_scale() drops
+ * them again when an arch init replaces the C horizontal scaler. Bicubic
+ * and the other multi-tap filters are not fused.
+ */
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/pixdesc.h"
+
+#include "swscale.h"
+#include "swscale_internal.h"
+
+enum FusedFilter {
+    FUSED_NONE,
+    FUSED_AREA,
+    FUSED_BILINEAR,
+};
+
+typedef struct FusedComponent {
+    const uint8_t *src;
+    uint8_t *dst;
+    ptrdiff_t src_stride, dst_stride;
+    int src_step, src_shift;
+    int dst_step, dst_shift;
+    int src_w, src_h;
+    int dst_w;
+    int dither_offset;
+} FusedComponent;
+
+/**
+ * Check that a filter computed by initFilter() is the 2:1 area or bilinear
+ * kernel with taps outside the source clamped to the edge samples.
+ */
+static int check_filter(const int16_t *filter, const int32_t *filter_pos,
+                        int filter_size, int src_w, int dst_w, int one,
+                        enum FusedFilter type)
+{
+    static const int weights[2][4] = { { 4, 4, 0, 0 }, { 1, 3, 3, 1 } };
+    const int *w = weights[type == FUSED_BILINEAR];
+    const int first = type == FUSED_BILINEAR ? -1 : 0;
+
+    if (src_w != 2 * dst_w)
+        return 0;
+
+    for (int i = 0; i < dst_w; i++) {
+        int expected[4] = { 0 }, actual[4] = { 0 };
+
+        for (int k = 0; k < 4; k++) {
+            const int pos = av_clip(2 * i + first + k, 0, src_w - 1);
+            expected[pos - (2 * i + first)] += w[k] * one / 8;
+        }
+
+        for (int j = 0; j < filter_size; j++) {
+            const int16_t coeff = filter[i * filter_size + j];
+            const int pos = filter_pos[i] + j - (2 * i + first);
+
+            if (!coeff)
+                continue;
+            if (pos < 0 || pos > 3)
+                return 0;
+            actual[pos] += coeff;
+        }
+
+        if (memcmp(expected, actual, sizeof(expected)))
+            return 0;
+    }
+
+    return 1;
+}
+
+#define READ(row, j) \
+    ((src16 ? AV_RN16(row + 2 * (j) * step) : row[(j) * step]) >> shift)
+
+static av_always_inline void
+downscale_line(const FusedComponent *fc, uint8_t *dst, const uint8_t *const rows[4],
+               const int bias[8], int mult, int out_shift, int out_max,
+               int bilinear, int src16, int dst16)
+{
+    const int step  = fc->src_step;
+    const int shift = fc->src_shift;
+    const int dstep = fc->dst_step;
+    const int dshift = fc->dst_shift;
+    const int src_w = fc->src_w;
+    int sum;
+
+#define STORE(x, sum)                                                         \
+    do {                                                                      \
+        int val = FFMIN((bias[(x) & 7] + (sum) * mult) >> out_shift, out_max); \
+        if (dst16)                                                            \
+            AV_WN16(dst + 2 * (x) * dstep, val << dshift);                    \
+        else                                                                  \
+            dst[(x) * dstep] = val;                                           \
+    } while (0)
+
+    if (bilinear) {
+        const uint8_t *r0 = rows[0], *r1 = rows[1], *r2 = rows[2], *r3 = rows[3];
+#define COLUMN(j) \
+    (READ(r0, j) + 3 * (READ(r1, j) + READ(r2, j)) + READ(r3, j))
+        int prev = COLUMN(0), even = prev;
+
+        for (int x = 0; x < fc->dst_w; x++) {
+            const int odd  = COLUMN(2 * x + 1);
+            const int next = 2 * x + 2 < src_w ? COLUMN(2 * x + 2) : odd;
+
+            sum  = prev + 3 * (even + odd) + next;
+            prev = odd;
+            even = next;
+            STORE(x, sum);
+        }
+#undef COLUMN
+    } else {
+        const uint8_t *r0 = rows[0], *r1 = rows[1];
+
+        for (int x = 0; x < fc->dst_w; x++) {
+            sum = READ(r0, 2 * x) + READ(r0, 2 * x + 1) +
+                  READ(r1, 2 * x) + READ(r1, 2 * x + 1);
+            STORE(x, sum);
+        }
+    }
+#undef STORE
+}
+
+#define DOWNSCALE_LINE(name, bilinear, src16, dst16)                           \
+static void downscale_line_ ## name(const FusedComponent *fc, uint8_t *dst,    \
+                                    const uint8_t *const rows[4],              \
+                                    const int bias[8], int mult,               \
+                                    int out_shift, int out_max)                \
+{                                                                              \
+    downscale_line(fc, dst, rows, bias, mult, out_shift, out_max,              \
+                   bilinear, src16, dst16);                                    \
+}
+
+DOWNSCALE_LINE(area_8_8,       0, 0, 0)
+DOWNSCALE_LINE(area_8_16,      0, 0, 1)
+DOWNSCALE_LINE(area_16_8,      0, 1, 0)
+DOWNSCALE_LINE(area_16_16,     0, 1, 1)
+DOWNSCALE_LINE(bilinear_8_8,   1, 0, 0)
+DOWNSCALE_LINE(bilinear_8_16,  1, 0, 1)
+DOWNSCALE_LINE(bilinear_16_8,  1, 1, 0)
+DOWNSCALE_LINE(bilinear_16_16, 1, 1, 1)
+
+typedef void (*downscale_line_fn)(const FusedComponent *fc, uint8_t *dst,
+                                  const uint8_t *const rows[4],
+                                  const int bias[8], int mult,
+                                  int out_shift, int out_max);
+
+static const downscale_line_fn downscale_lines[2][2][2] = {
+    { { downscale_line_area_8_8,     downscale_line_area_8_16     },
+      { downscale_line_area_16_8,    downscale_line_area_16_16    } },
+    { { downscale_line_bilinear_8_8,  downscale_line_bilinear_8_16  },
+      { downscale_line_bilinear_16_8, downscale_line_bilinear_16_16 } },
+};
+
+static int fused_downscale(SwsContext *c, const uint8_t *src[],
+                           int srcStride[], int dstSliceY, int dstSliceH,
+                           uint8_t *dst[], int dstStride[])
+{
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(c->dstFormat);
+    const int bilinear  = c->fused_filter == FUSED_BILINEAR;
+    const int src_depth = src_desc->comp[0].depth;
+    const int dst_depth = dst_desc->comp[0].depth;
+    const int src16     = src_depth > 8;
+    const int dst16     = dst_depth > 8;
+    /* hscale output is sum * h_one >> h_shift, vscale multiplies by v_one */
+    const int h_shift   = src16 ? src_depth - 1 : 7;
+    const int h_mult    = (bilinear ? 2048 : 8192) >> h_shift;
+    const int mult      = h_mult * (bilinear ? 512 : 2048);
+    const int out_shift = dst16 ? 11 + 16 - dst_depth : 19;
+    const int out_max   = (1 << dst_depth) - 1;
+    const int nb_components = isGray(c->srcFormat) ? 1 : 3;
+    const downscale_line_fn line_fn = downscale_lines[bilinear][src16][dst16];
+
+    for (int i = 0; i < nb_components; i++) {
+        const AVComponentDescriptor *sc = &src_desc->comp[i];
+        const AVComponentDescriptor *dc = &dst_desc->comp[i];
+        const int bytes = src16 ? 2 : 1, dbytes = dst16 ? 2 : 1;
+        const int chroma = i > 0;
+        const int vsub = chroma ? c->chrDstVSubSample : 0;
+        const int y_start = AV_CEIL_RSHIFT(dstSliceY, vsub);
+        const int y_end   = AV_CEIL_RSHIFT(dstSliceY + dstSliceH, vsub);
+        FusedComponent fc = {
+            .src_stride    = srcStride[sc->plane],
+            .dst_stride    = dstStride[dc->plane],
+            .src_step      = sc->step / bytes,
+            .src_shift     = sc->shift,
+            .dst_step      = dc->step / dbytes,
+            .dst_shift     = dc->shift,
+            .src_w         = chroma ? c->chrSrcW : c->srcW,
+            .src_h         = chroma ? c->chrSrcH : c->srcH,
+            .dst_w         = chroma ? c->chrDstW : c->dstW,
+            .dither_offset = i == 2 ? 3 : 0,
+        };
+
+        fc.src = src[sc->plane] + sc->offset;
+        fc.dst = dst[dc->plane] + dc->offset;
+
+        for (int y = y_start; y < y_end; y++) {
+            const uint8_t *rows[4];
+            uint8_t *line = fc.dst + (y - y_start) * fc.dst_stride;
+            int bias[8];
+
+            if (dst16) {
+                for (int x = 0; x < 8; x++)
+                    bias[x] = 1 << (out_shift - 1);
+            } else {
+                const int should_dither = isNBPS(c->srcFormat) || is16BPS(c->srcFormat);
+                const uint8_t *dither = should_dither ? ff_dither_8x8_128[y & 7] : NULL;
+
+                for (int x = 0; x < 8; x++)
+                    bias[x] = (dither ? dither[(x + fc.dither_offset) & 7] : 64) << 12;
+            }
+
+            for (int k = 0; k < 4; k++) {
+                const int row = av_clip(2 * y - bilinear + k, 0, fc.src_h - 1);
+                rows[k] = fc.src + row * fc.src_stride;
+            }
+
+            line_fn(&fc, line, rows, bias, mult, out_shift, out_max);
+        }
+    }
+
+    return dstSliceH;
+}
+
+static int supported_format(enum AVPixelFormat format, int max_depth)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int depth, bytes;
+
+    if (!desc || !isPlanarYUV(format) && !isGray(format))
+        return 0;
+    if (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                       AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_FLOAT |
+                       AV_PIX_FMT_FLAG_ALPHA))
+        return 0;
+
+    depth = desc->comp[0].depth;
+    bytes = depth > 8 ? 2 : 1;
+    if (depth > max_depth || bytes > 1 && isBE(format) != HAVE_BIGENDIAN)
+        return 0;
+
+    for (int i = 0; i < desc->nb_components; i++) {
+        const int step = isSemiPlanarYUV(format) && i ? 2 * bytes : bytes;
+
+        if (desc->comp[i].depth != depth || desc->comp[i].step != step)
+            return 0;
+    }
+
+    return 1;
+}
+
+void ff_sws_init_fused(SwsContext *c)
+{
+    enum FusedFilter type;
+    int max_depth;
+
+    c->convert_fused = NULL;
+    c->fused_filter  = FUSED_NONE;
+
+    if (c->flags & SWS_AREA)
+        type = FUSED_AREA;
+    else if (c->flags & SWS_BILINEAR)
+        type = FUSED_BILINEAR;
+    else
+        return;
+
+    /* the horizontal scaler must not drop any bits of the sum */
+    max_depth = type == FUSED_BILINEAR ? 12 : 14;
+
+    /* without accurate rounding the SIMD 8-bit vertical scalers round
+     * differently from the C code the fused path reproduces */
+    if (c->dstBpc == 8 && !(c->flags & SWS_ACCURATE_RND))
+        return;
+
+    /* tile contexts need their own tile filters, which are not set up
+     * for a fused context */
+    if (c->tile_dst_w)
+        return;
+
+    if ((c->flags & SWS_FAST_BILINEAR) || c->vChrDrop || c->gamma_flag ||
+        !supported_format(c->srcFormat, max_depth) ||
+        !supported_format(c->dstFormat, 14) ||
+        isGray(c->srcFormat) != isGray(c->dstFormat))
+        return;
+
+    if (!check_filter(c->hLumFilter, c->hLumFilterPos, c->hLumFilterSize,
+                      c->srcW, c->dstW, 1 << 14, type) ||
+        !check_filter(c->vLumFilter, c->vLumFilterPos, c->vLumFilterSize,
+                      c->srcH, c->dstH, 1 << 12, type))
+        return;
+
+    if (!isGray(c->srcFormat) &&
+        (!check_filter(c->hChrFilter, c->hChrFilterPos, c->hChrFilterSize,
+                       c->chrSrcW, c->chrDstW, 1 << 14, type) ||
+         !check_filter(c->vChrFilter, c->vChrFilterPos, c->vChrFilterSize,
+                       c->chrSrcH, c->chrDstH, 1 << 12, type)))
+        return;
+
+    c->fused_filter  = type;
+    c->convert_fused = fused_downscale;
+}
@@ -22,16 +22,19 @@
 
 typedef struct GammaContext
 {
-    uint16_t *table;
+    const uint16_t *table;
+    int step;
 } GammaContext;
 
-// gamma_convert expects 16 bit rgb format
-// it writes directly in src slice thus it must be modifiable (done through cascade context)
+// gamma_convert expects 16 bit little-endian rgb(a) lines
+// it converts the vertical scaler output in place, so only the lines of this slice are touched
 static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     GammaContext *instance = desc->instance;
-    uint16_t *table = instance->table;
-    int srcW = desc->src->width;
+    const uint16_t *table = instance->table;
+    const int step = instance->step;
+    const int width = desc->src->width * step;
+    const int simd_w = c->rgb16_gamma ? desc->src->width & ~15 : 0;
 
     int i;
     for (i = 0; i < sliceH; ++i) {
@@ -40,14 +43,16 @@ static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, i
 
         uint16_t *src1 = (uint16_t*)*(src+src_pos);
         int j;
-        for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
+        if (simd_w)
+            c->rgb16_gamma(src1, table, simd_w);
+        for (j = simd_w * step; j < width; j += step) {
+            uint16_t r = table[AV_RL16(src1 + j + 0)];
+            uint16_t g = table[AV_RL16(src1 + j + 1)];
+            uint16_t b = table[AV_RL16(src1 + j + 2)];
 
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
+            AV_WL16(src1 + j + 0, r);
+            AV_WL16(src1 + j + 1, g);
+            AV_WL16(src1 + j + 2, b);
         }
 
     }
@@ -55,12 +60,13 @@ static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, i
 }
 
 
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table)
+int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, const uint16_t *table)
 {
     GammaContext *li = av_malloc(sizeof(GammaContext));
     if (!li)
         return AVERROR(ENOMEM);
     li->table = table;
+    li->step  = av_pix_fmt_desc_get(src->fmt)->comp[0].step >> 1;
 
     desc->instance = li;
     desc->src = src;
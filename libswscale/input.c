@@ -248,6 +248,103 @@ RGB48FUNCS(rgb, BE, AV_PIX_FMT_RGB48)
 RGB48FUNCS(bgr, LE, AV_PIX_FMT_BGR48)
 RGB48FUNCS(bgr, BE, AV_PIX_FMT_BGR48)
 
+/* The internal context of gamma correct scaling reads little-endian RGB48 or
+ * RGBA64 and converts the samples to linear light through the table passed
+ * as opaque before the YUV matrix, so that the source is left untouched. */
+static av_always_inline void rgb16_linearToY_c_template(uint16_t *dst,
+                                                        const uint16_t *src,
+                                                        int width, int step,
+                                                        int32_t *rgb2yuv,
+                                                        const uint16_t *lut)
+{
+    int32_t ry = rgb2yuv[RY_IDX], gy = rgb2yuv[GY_IDX], by = rgb2yuv[BY_IDX];
+    int i;
+    for (i = 0; i < width; i++) {
+        unsigned r = lut[AV_RL16(&src[i * step + 0])];
+        unsigned g = lut[AV_RL16(&src[i * step + 1])];
+        unsigned b = lut[AV_RL16(&src[i * step + 2])];
+
+        dst[i] = (ry*r + gy*g + by*b + (0x2001 << (RGB2YUV_SHIFT - 1))) >> RGB2YUV_SHIFT;
+    }
+}
+
+static av_always_inline void rgb16_linearToUV_c_template(uint16_t *dstU,
+                                                         uint16_t *dstV,
+                                                         const uint16_t *src,
+                                                         int width, int step,
+                                                         int32_t *rgb2yuv,
+                                                         const uint16_t *lut)
+{
+    int i;
+    int32_t ru = rgb2yuv[RU_IDX], gu = rgb2yuv[GU_IDX], bu = rgb2yuv[BU_IDX];
+    int32_t rv = rgb2yuv[RV_IDX], gv = rgb2yuv[GV_IDX], bv = rgb2yuv[BV_IDX];
+    for (i = 0; i < width; i++) {
+        unsigned r = lut[AV_RL16(&src[i * step + 0])];
+        unsigned g = lut[AV_RL16(&src[i * step + 1])];
+        unsigned b = lut[AV_RL16(&src[i * step + 2])];
+
+        dstU[i] = (ru*r + gu*g + bu*b + (0x10001 << (RGB2YUV_SHIFT - 1))) >> RGB2YUV_SHIFT;
+        dstV[i] = (rv*r + gv*g + bv*b + (0x10001 << (RGB2YUV_SHIFT - 1))) >> RGB2YUV_SHIFT;
+    }
+}
+
+static av_always_inline void rgb16_linearToUV_half_c_template(uint16_t *dstU,
+                                                              uint16_t *dstV,
+                                                              const uint16_t *src,
+                                                              int width, int step,
+                                                              int32_t *rgb2yuv,
+                                                              const uint16_t *lut)
+{
+    int i;
+    int32_t ru = rgb2yuv[RU_IDX], gu = rgb2yuv[GU_IDX], bu = rgb2yuv[BU_IDX];
+    int32_t rv = rgb2yuv[RV_IDX], gv = rgb2yuv[GV_IDX], bv = rgb2yuv[BV_IDX];
+    for (i = 0; i < width; i++) {
+        unsigned r = (lut[AV_RL16(&src[2 * step * i + 0])] +
+                      lut[AV_RL16(&src[2 * step * i + step + 0])] + 1) >> 1;
+        unsigned g = (lut[AV_RL16(&src[2 * step * i + 1])] +
+                      lut[AV_RL16(&src[2 * step * i + step + 1])] + 1) >> 1;
+        unsigned b = (lut[AV_RL16(&src[2 * step * i + 2])] +
+                      lut[AV_RL16(&src[2 * step * i + step + 2])] + 1) >> 1;
+
+        dstU[i] = (ru*r + gu*g + bu*b + (0x10001 << (RGB2YUV_SHIFT - 1))) >> RGB2YUV_SHIFT;
+        dstV[i] = (rv*r + gv*g + bv*b + (0x10001 << (RGB2YUV_SHIFT - 1))) >> RGB2YUV_SHIFT;
+    }
+}
+
+#define RGB16_LINEAR_FUNCS(name, step)                                        \
+static void name ## _linearToY_c(uint8_t *dst, const uint8_t *src,            \
+                                 const uint8_t *unused0, const uint8_t *unused1, \
+                                 int width, uint32_t *rgb2yuv, void *opq)     \
+{                                                                             \
+    rgb16_linearToY_c_template((uint16_t *)dst, (const uint16_t *)src,        \
+                               width, step, rgb2yuv, opq);                    \
+}                                                                             \
+                                                                              \
+static void name ## _linearToUV_c(uint8_t *dstU, uint8_t *dstV,               \
+                                  const uint8_t *unused0, const uint8_t *src1, \
+                                  const uint8_t *src2, int width,             \
+                                  uint32_t *rgb2yuv, void *opq)               \
+{                                                                             \
+    av_assert1(src1 == src2);                                                 \
+    rgb16_linearToUV_c_template((uint16_t *)dstU, (uint16_t *)dstV,           \
+                                (const uint16_t *)src1, width, step,          \
+                                rgb2yuv, opq);                                \
+}                                                                             \
+                                                                              \
+static void name ## _linearToUV_half_c(uint8_t *dstU, uint8_t *dstV,          \
+                                       const uint8_t *unused0, const uint8_t *src1, \
+                                       const uint8_t *src2, int width,        \
+                                       uint32_t *rgb2yuv, void *opq)          \
+{                                                                             \
+    av_assert1(src1 == src2);                                                 \
+    rgb16_linearToUV_half_c_template((uint16_t *)dstU, (uint16_t *)dstV,      \
+                                     (const uint16_t *)src1, width, step,     \
+                                     rgb2yuv, opq);                           \
+}
+
+RGB16_LINEAR_FUNCS(rgb48le, 3)
+RGB16_LINEAR_FUNCS(rgba64le, 4)
+
 #define input_pixel(i) ((origin == AV_PIX_FMT_RGBA ||                      \
                          origin == AV_PIX_FMT_BGRA ||                      \
                          origin == AV_PIX_FMT_ARGB ||                      \
@@ -2018,4 +2115,19 @@ av_cold void ff_sws_init_input_funcs(SwsContext *c)
             break;
         }
     }
+
+    if (c->is_internal_gamma) {
+        switch (srcFormat) {
+        case AV_PIX_FMT_RGB48LE:
+            c->lumToYV12 = rgb48le_linearToY_c;
+            c->chrToYV12 = c->chrSrcHSubSample ? rgb48le_linearToUV_half_c
+                                               : rgb48le_linearToUV_c;
+            break;
+        case AV_PIX_FMT_RGBA64LE:
+            c->lumToYV12 = rgba64le_linearToY_c;
+            c->chrToYV12 = c->chrSrcHSubSample ? rgba64le_linearToUV_half_c
+                                               : rgba64le_linearToUV_c;
+            break;
+        }
+    }
 }
@@ -63,6 +63,10 @@ av_cold void rgb2rgb_init_loongarch(void)
 av_cold SwsFunc ff_yuv2rgb_init_loongarch(SwsContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
+    if (c->srcFormat != AV_PIX_FMT_YUV420P &&
+        c->srcFormat != AV_PIX_FMT_YUV422P &&
+        c->srcFormat != AV_PIX_FMT_YUVA420P)
+        return NULL;
     if (have_lasx(cpu_flags)) {
         switch (c->dstFormat) {
             case AV_PIX_FMT_RGB24:
@@ -81,6 +81,16 @@ static const AVOption swscale_options[] = {
 
     { "threads",         "number of threads",             OFFSET(nb_threads),   AV_OPT_TYPE_INT, {.i64 = 1 }, 0, INT_MAX, VE, "threads" },
         { "auto",        NULL,                            0,                  AV_OPT_TYPE_CONST, {.i64 = 0 },    .flags = VE, "threads" },
+    { "tile_width",      "scale in column tiles of this width, YUV and gray outputs only", OFFSET(tile_width), AV_OPT_TYPE_INT, {.i64 = 0 }, 0, INT_MAX, VE },
+
+    { "norm_mean_r",     "mean subtracted from red of float outputs",    OFFSET(norm_mean[0]), AV_OPT_TYPE_DOUBLE, { .dbl = 0 }, -1000,  1000, VE },
+    { "norm_mean_g",     "mean subtracted from green of float outputs",  OFFSET(norm_mean[1]), AV_OPT_TYPE_DOUBLE, { .dbl = 0 }, -1000,  1000, VE },
+    { "norm_mean_b",     "mean subtracted from blue of float outputs",   OFFSET(norm_mean[2]), AV_OPT_TYPE_DOUBLE, { .dbl = 0 }, -1000,  1000, VE },
+    { "norm_std_r",      "divisor of red of float outputs",              OFFSET(norm_std[0]),  AV_OPT_TYPE_DOUBLE, { .dbl = 1 }, 0.0001, 1000, VE },
+    { "norm_std_g",      "divisor of green of float outputs",            OFFSET(norm_std[1]),  AV_OPT_TYPE_DOUBLE, { .dbl = 1 }, 0.0001, 1000, VE },
+    { "norm_std_b",      "divisor of blue of float outputs",             OFFSET(norm_std[2]),  AV_OPT_TYPE_DOUBLE, { .dbl = 1 }, 0.0001, 1000, VE },
+    { "letterbox",       "keep the aspect ratio, padding float outputs", OFFSET(letterbox),    AV_OPT_TYPE_BOOL,   { .i64 = 0 }, 0,      1,    VE },
+    { "letterbox_pad",   "value of the letterbox padding",               OFFSET(letterbox_pad), AV_OPT_TYPE_DOUBLE, { .dbl = 0 }, 0,     1,    VE },
 
     { NULL }
 };
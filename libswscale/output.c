@@ -2411,7 +2411,8 @@ yuv2gbrpf32_full_X_c(SwsContext *c, const int16_t *lumFilter,
     const int32_t **chrUSrc = (const int32_t**)chrUSrcx;
     const int32_t **chrVSrc = (const int32_t**)chrVSrcx;
     const int32_t **alpSrc  = (const int32_t**)alpSrcx;
-    static const float float_mult = 1.0f / 65535.0f;
+    const float (*mul)[8] = c->float_norm_mul;
+    const float (*add)[8] = c->float_norm_add;
 
     for (i = 0; i < dstW; i++) {
         int j;
@@ -2454,11 +2455,11 @@ yuv2gbrpf32_full_X_c(SwsContext *c, const int16_t *lumFilter,
         G = av_clip_uintp2(((Y + G) >> 14) + (1<<15), 16);
         B = av_clip_uintp2(((Y + B) >> 14) + (1<<15), 16);
 
-        dest32[0][i] = av_float2int(float_mult * (float)G);
-        dest32[1][i] = av_float2int(float_mult * (float)B);
-        dest32[2][i] = av_float2int(float_mult * (float)R);
+        dest32[0][i] = av_float2int((float)G * mul[0][0] + add[0][0]);
+        dest32[1][i] = av_float2int((float)B * mul[1][0] + add[1][0]);
+        dest32[2][i] = av_float2int((float)R * mul[2][0] + add[2][0]);
         if (hasAlpha)
-            dest32[3][i] = av_float2int(float_mult * (float)(av_clip_uintp2(A, 30) >> 14));
+            dest32[3][i] = av_float2int((float)(av_clip_uintp2(A, 30) >> 14) * mul[3][0] + add[3][0]);
     }
     if ((!isBE(c->dstFormat)) != (!HAVE_BIGENDIAN)) {
         for (i = 0; i < dstW; i++) {
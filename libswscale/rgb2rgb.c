@@ -91,6 +91,28 @@ void (*interleaveBytes)(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
 void (*deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
                           int width, int height, int srcStride,
                           int dst1Stride, int dst2Stride);
+void (*interleaveWords)(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
+                        int width, int height, int src1Stride,
+                        int src2Stride, int dstStride, int shift);
+void (*deinterleaveWords)(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                          int width, int height, int srcStride,
+                          int dst1Stride, int dst2Stride, int shift);
+void (*shiftWords)(const uint8_t *src, uint8_t *dst, int width, int height,
+                   int srcStride, int dstStride, int shift);
+void (*y210toyuv422p10)(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                        const uint8_t *src, int width, int height,
+                        int lumStride, int chromStride, int srcStride);
+void (*yuv422p10toy210)(const uint8_t *ysrc, const uint8_t *usrc,
+                        const uint8_t *vsrc, uint8_t *dst,
+                        int width, int height,
+                        int lumStride, int chromStride, int dstStride);
+void (*packed30toplanar)(const uint8_t *src, uint8_t *dst0, uint8_t *dst1,
+                         uint8_t *dst2, int width, int height,
+                         int srcStride, int dstStride);
+void (*planartopacked30)(const uint8_t *src0, const uint8_t *src1,
+                         const uint8_t *src2, uint8_t *dst,
+                         int width, int height,
+                         int srcStride, int dstStride, uint32_t pad);
 void (*vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
                     uint8_t *dst1, uint8_t *dst2,
                     int width, int height,
@@ -139,6 +139,55 @@ extern void (*deinterleaveBytes)(const uint8_t *src, uint8_t *dst1, uint8_t *dst
                                  int width, int height, int srcStride,
                                  int dst1Stride, int dst2Stride);
 
+/**
+ * The following functions work on little-endian 16-bit words. The width is
+ * in words of each destination (resp. source) plane and shift is the number
+ * of bits by which the words are shifted left when interleaving and right
+ * when deinterleaving.
+ */
+extern void (*interleaveWords)(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
+                               int width, int height, int src1Stride,
+                               int src2Stride, int dstStride, int shift);
+
+extern void (*deinterleaveWords)(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                                 int width, int height, int srcStride,
+                                 int dst1Stride, int dst2Stride, int shift);
+
+/**
+ * Shift words left by shift if it is positive and right by -shift otherwise.
+ */
+extern void (*shiftWords)(const uint8_t *src, uint8_t *dst, int width, int height,
+                          int srcStride, int dstStride, int shift);
+
+/**
+ * Width should be a multiple of 2.
+ */
+extern void (*y210toyuv422p10)(uint8_t *ydst, uint8_t *udst, uint8_t *vdst, const uint8_t *src,
+                               int width, int height,
+                               int lumStride, int chromStride, int srcStride);
+
+/**
+ * Width should be a multiple of 2.
+ */
+extern void (*yuv422p10toy210)(const uint8_t *ysrc, const uint8_t *usrc, const uint8_t *vsrc, uint8_t *dst,
+                               int width, int height,
+                               int lumStride, int chromStride, int dstStride);
+
+/**
+ * Split little-endian 32-bit words holding three 10-bit components into
+ * 16-bit planes, dst0 gets the least significant component. The three
+ * planes share the same stride.
+ */
+extern void (*packed30toplanar)(const uint8_t *src, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+                                int width, int height, int srcStride, int dstStride);
+
+/**
+ * Inverse of packed30toplanar(), pad is ORed into each output word.
+ */
+extern void (*planartopacked30)(const uint8_t *src0, const uint8_t *src1, const uint8_t *src2,
+                                uint8_t *dst, int width, int height,
+                                int srcStride, int dstStride, uint32_t pad);
+
 extern void (*vu9_to_vu12)(const uint8_t *src1, const uint8_t *src2,
                            uint8_t *dst1, uint8_t *dst2,
                            int width, int height,
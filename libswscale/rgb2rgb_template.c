@@ -743,6 +743,142 @@ static void deinterleaveBytes_c(const uint8_t *src, uint8_t *dst1, uint8_t *dst2
     }
 }
 
+static void interleaveWords_c(const uint8_t *src1, const uint8_t *src2,
+                              uint8_t *dst, int width, int height,
+                              int src1Stride, int src2Stride, int dstStride,
+                              int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+        for (w = 0; w < width; w++) {
+            AV_WL16(dst + 4 * w,     AV_RL16(src1 + 2 * w) << shift);
+            AV_WL16(dst + 4 * w + 2, AV_RL16(src2 + 2 * w) << shift);
+        }
+        dst  += dstStride;
+        src1 += src1Stride;
+        src2 += src2Stride;
+    }
+}
+
+static void deinterleaveWords_c(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                                int width, int height, int srcStride,
+                                int dst1Stride, int dst2Stride, int shift)
+{
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+        for (w = 0; w < width; w++) {
+            AV_WL16(dst1 + 2 * w, AV_RL16(src + 4 * w)     >> shift);
+            AV_WL16(dst2 + 2 * w, AV_RL16(src + 4 * w + 2) >> shift);
+        }
+        src  += srcStride;
+        dst1 += dst1Stride;
+        dst2 += dst2Stride;
+    }
+}
+
+static void shiftWords_c(const uint8_t *src, uint8_t *dst, int width, int height,
+                         int srcStride, int dstStride, int shift)
+{
+    int lshift = FFMAX(shift, 0), rshift = FFMAX(-shift, 0);
+    int h;
+
+    for (h = 0; h < height; h++) {
+        int w;
+        for (w = 0; w < width; w++)
+            AV_WL16(dst + 2 * w, AV_RL16(src + 2 * w) >> rshift << lshift);
+        src += srcStride;
+        dst += dstStride;
+    }
+}
+
+static void y210toyuv422p10_c(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                              const uint8_t *src, int width, int height,
+                              int lumStride, int chromStride, int srcStride)
+{
+    int y;
+
+    for (y = 0; y < height; y++) {
+        int i;
+        for (i = 0; i < width / 2; i++) {
+            AV_WL16(ydst + 4 * i,     AV_RL16(src + 8 * i)     >> 6);
+            AV_WL16(udst + 2 * i,     AV_RL16(src + 8 * i + 2) >> 6);
+            AV_WL16(ydst + 4 * i + 2, AV_RL16(src + 8 * i + 4) >> 6);
+            AV_WL16(vdst + 2 * i,     AV_RL16(src + 8 * i + 6) >> 6);
+        }
+        src  += srcStride;
+        ydst += lumStride;
+        udst += chromStride;
+        vdst += chromStride;
+    }
+}
+
+static void yuv422p10toy210_c(const uint8_t *ysrc, const uint8_t *usrc,
+                              const uint8_t *vsrc, uint8_t *dst,
+                              int width, int height,
+                              int lumStride, int chromStride, int dstStride)
+{
+    int y;
+
+    for (y = 0; y < height; y++) {
+        int i;
+        for (i = 0; i < width / 2; i++) {
+            AV_WL16(dst + 8 * i,     AV_RL16(ysrc + 4 * i)     << 6);
+            AV_WL16(dst + 8 * i + 2, AV_RL16(usrc + 2 * i)     << 6);
+            AV_WL16(dst + 8 * i + 4, AV_RL16(ysrc + 4 * i + 2) << 6);
+            AV_WL16(dst + 8 * i + 6, AV_RL16(vsrc + 2 * i)     << 6);
+        }
+        ysrc += lumStride;
+        usrc += chromStride;
+        vsrc += chromStride;
+        dst  += dstStride;
+    }
+}
+
+static void packed30toplanar_c(const uint8_t *src, uint8_t *dst0, uint8_t *dst1,
+                               uint8_t *dst2, int width, int height,
+                               int srcStride, int dstStride)
+{
+    int y;
+
+    for (y = 0; y < height; y++) {
+        int i;
+        for (i = 0; i < width; i++) {
+            uint32_t v = AV_RL32(src + 4 * i);
+            AV_WL16(dst0 + 2 * i,  v        & 0x3FF);
+            AV_WL16(dst1 + 2 * i, (v >> 10) & 0x3FF);
+            AV_WL16(dst2 + 2 * i, (v >> 20) & 0x3FF);
+        }
+        src  += srcStride;
+        dst0 += dstStride;
+        dst1 += dstStride;
+        dst2 += dstStride;
+    }
+}
+
+static void planartopacked30_c(const uint8_t *src0, const uint8_t *src1,
+                               const uint8_t *src2, uint8_t *dst,
+                               int width, int height,
+                               int srcStride, int dstStride, uint32_t pad)
+{
+    int y;
+
+    for (y = 0; y < height; y++) {
+        int i;
+        for (i = 0; i < width; i++)
+            AV_WL32(dst + 4 * i, pad | AV_RL16(src0 + 2 * i) |
+                                 AV_RL16(src1 + 2 * i) << 10 |
+                                 (uint32_t)AV_RL16(src2 + 2 * i) << 20);
+        src0 += srcStride;
+        src1 += srcStride;
+        src2 += srcStride;
+        dst  += dstStride;
+    }
+}
+
 static inline void vu9_to_vu12_c(const uint8_t *src1, const uint8_t *src2,
                                  uint8_t *dst1, uint8_t *dst2,
                                  int width, int height,
@@ -982,6 +1118,13 @@ static av_cold void rgb2rgb_init_c(void)
     ff_rgb24toyv12     = ff_rgb24toyv12_c;
     interleaveBytes    = interleaveBytes_c;
     deinterleaveBytes  = deinterleaveBytes_c;
+    interleaveWords    = interleaveWords_c;
+    deinterleaveWords  = deinterleaveWords_c;
+    shiftWords         = shiftWords_c;
+    y210toyuv422p10    = y210toyuv422p10_c;
+    yuv422p10toy210    = yuv422p10toy210_c;
+    packed30toplanar   = packed30toplanar_c;
+    planartopacked30   = planartopacked30_c;
     vu9_to_vu12        = vu9_to_vu12_c;
     yvu9_to_yuy2       = yvu9_to_yuy2_c;
 
@@ -187,25 +187,29 @@ int ff_init_slice_from_src(SwsSlice * s, uint8_t *src[4], int stride[4], int src
 
 static void fill_ones(SwsSlice *s, int n, int bpc)
 {
+    const uint8_t *first = s->plane[0].line[0];
     int i, j, k, size, end;
 
+    if (bpc == 16) {
+        end = ((n>>1) + 1) * sizeof(int32_t);
+        for (k = 0; k < (n>>1) + 1; ++k)
+            ((int32_t*)(s->plane[0].line[0]))[k] = 1<<18;
+    } else if (bpc == 32) {
+        end = ((n>>2) + 1) * sizeof(int64_t);
+        for (k = 0; k < (n>>2) + 1; ++k)
+            ((int64_t*)(s->plane[0].line[0]))[k] = 1LL<<34;
+    } else {
+        end = (n + 1) * sizeof(int16_t);
+        for (k = 0; k < n + 1; ++k)
+            ((int16_t*)(s->plane[0].line[0]))[k] = 1<<14;
+    }
+
+    /* all lines have the same size, copy the first one */
     for (i = 0; i < 4; ++i) {
         size = s->plane[i].available_lines;
-        for (j = 0; j < size; ++j) {
-            if (bpc == 16) {
-                end = (n>>1) + 1;
-                for (k = 0; k < end; ++k)
-                    ((int32_t*)(s->plane[i].line[j]))[k] = 1<<18;
-            } else if (bpc == 32) {
-                end = (n>>2) + 1;
-                for (k = 0; k < end; ++k)
-                    ((int64_t*)(s->plane[i].line[j]))[k] = 1LL<<34;
-            } else {
-                end = n + 1;
-                for (k = 0; k < end; ++k)
-                    ((int16_t*)(s->plane[i].line[j]))[k] = 1<<14;
-            }
-        }
+        for (j = 0; j < size; ++j)
+            if (s->plane[i].line[j] != first)
+                memcpy(s->plane[i].line[j], first, end);
     }
 }
 
@@ -278,9 +282,9 @@ int ff_init_filters(SwsContext * c)
     num_cdesc = need_chr_conv ? 2 : 1;
 
     c->numSlice = FFMAX(num_ydesc, num_cdesc) + 2;
-    c->numDesc = num_ydesc + num_cdesc + num_vdesc + (need_gamma ? 2 : 0);
-    c->descIndex[0] = num_ydesc + (need_gamma ? 1 : 0);
-    c->descIndex[1] = num_ydesc + num_cdesc + (need_gamma ? 1 : 0);
+    c->numDesc = num_ydesc + num_cdesc + num_vdesc + need_gamma;
+    c->descIndex[0] = num_ydesc;
+    c->descIndex[1] = num_ydesc + num_cdesc;
 
     if (isFloat16(c->srcFormat)) {
         c->h2f_tables = av_malloc(sizeof(*c->h2f_tables));
@@ -290,6 +294,10 @@ int ff_init_filters(SwsContext * c)
         c->input_opaque = c->h2f_tables;
     }
 
+    // the input conversion linearizes the source, see ff_sws_init_input_funcs()
+    if (need_gamma)
+        c->input_opaque = (void *)c->inv_gamma;
+
     c->desc  = av_calloc(c->numDesc,  sizeof(*c->desc));
     if (!c->desc)
         return AVERROR(ENOMEM);
@@ -324,12 +332,6 @@ int ff_init_filters(SwsContext * c)
     srcIdx = 0;
     dstIdx = 1;
 
-    if (need_gamma) {
-        res = ff_init_gamma_convert(c->desc + index, c->slice + srcIdx, c->inv_gamma);
-        if (res < 0) goto cleanup;
-        ++index;
-    }
-
     if (need_lum_conv) {
         res = ff_init_desc_fmt_convert(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], pal);
         if (res < 0) goto cleanup;
@@ -588,7 +588,12 @@ static av_cold void sws_init_swscale(SwsContext *c)
 
 void ff_sws_init_scale(SwsContext *c)
 {
+    void (*hscale_c)(SwsContext *c, int16_t *dst, int dstW,
+                     const uint8_t *src, const int16_t *filter,
+                     const int32_t *filterPos, int filterSize);
+
     sws_init_swscale(c);
+    hscale_c = c->hyScale;
 
 #if ARCH_PPC
     ff_sws_init_swscale_ppc(c);
@@ -601,6 +606,12 @@ void ff_sws_init_scale(SwsContext *c)
 #elif ARCH_LOONGARCH64
     ff_sws_init_swscale_loongarch(c);
 #endif
+
+    /* the fused downscaler is plain C and only faster than the C scalers */
+    if (c->hyScale != hscale_c) {
+        c->convert_fused = NULL;
+        c->fused_filter  = 0;
+    }
 }
 
 static void reset_ptr(const uint8_t *src[], enum AVPixelFormat format)
@@ -825,38 +836,104 @@ static int scale_internal(SwsContext *c,
                           uint8_t *const dstSlice[], const int dstStride[],
                           int dstSliceY, int dstSliceH);
 
+static int scale_slice_threads(SwsContext *c, unsigned int slice_start,
+                               unsigned int slice_height)
+{
+    int nb_jobs = c->slice_ctx[0]->dither == SWS_DITHER_ED ? 1 : c->nb_slice_ctx;
+    int ret = 0;
+
+    c->dst_slice_start  = slice_start;
+    c->dst_slice_height = slice_height;
+
+    avpriv_slicethread_execute(c->slicethread, nb_jobs, 0);
+
+    for (int i = 0; i < c->nb_slice_ctx; i++) {
+        if (c->slice_err[i] < 0) {
+            ret = c->slice_err[i];
+            break;
+        }
+    }
+
+    memset(c->slice_err, 0, c->nb_slice_ctx * sizeof(*c->slice_err));
+
+    return ret;
+}
+
+/* run one stage of gamma correct scaling on the complete source, in the
+ * slice threads of the stage if it has them */
+static int scale_gamma_stage(SwsContext *c,
+                             const uint8_t * const src[], const int srcStride[],
+                             uint8_t * const dst[], const int dstStride[],
+                             int dstSliceY, int dstSliceH)
+{
+    int ret;
+
+    if (!c->slicethread)
+        return scale_internal(c->nb_slice_ctx ? c->slice_ctx[0] : c,
+                              src, srcStride, 0, c->srcH,
+                              dst, dstStride, dstSliceY, dstSliceH);
+
+    for (int i = 0; i < 4; i++) {
+        const int vshift = (i == 1 || i == 2) ? c->slice_ctx[0]->chrDstVSubSample : 0;
+        const ptrdiff_t offset = (ptrdiff_t)dstStride[i] * (dstSliceY >> vshift);
+
+        c->frame_src->data[i]     = (uint8_t *)src[i];
+        c->frame_src->linesize[i] = srcStride[i];
+        c->frame_dst->data[i]     = FF_PTR_ADD(dst[i], -offset);
+        c->frame_dst->linesize[i] = dstStride[i];
+    }
+
+    ret = scale_slice_threads(c, dstSliceY, dstSliceH);
+
+    av_frame_unref(c->frame_src);
+    av_frame_unref(c->frame_dst);
+
+    return ret < 0 ? ret : dstSliceH;
+}
+
 static int scale_gamma(SwsContext *c,
                        const uint8_t * const srcSlice[], const int srcStride[],
                        int srcSliceY, int srcSliceH,
                        uint8_t * const dstSlice[], const int dstStride[],
                        int dstSliceY, int dstSliceH)
 {
-    int ret = scale_internal(c->cascaded_context[0],
-                             srcSlice, srcStride, srcSliceY, srcSliceH,
-                             c->cascaded_tmp, c->cascaded_tmpStride, 0, c->srcH);
+    int ret;
+
+    if (srcSliceY == 0 && srcSliceH == c->srcH) {
+        ret = scale_gamma_stage(c->cascaded_context[0], srcSlice, srcStride,
+                                c->cascaded_tmp, c->cascaded_tmpStride, 0, c->srcH);
+    } else {
+        // partial source slices are collected in the intermediate frame
+        SwsContext *c0 = c->cascaded_context[0];
+
+        if (c0->nb_slice_ctx)
+            c0 = c0->slice_ctx[0];
 
+        ret = scale_internal(c0, srcSlice, srcStride, srcSliceY, srcSliceH,
+                             c->cascaded_tmp, c->cascaded_tmpStride, 0, c->srcH);
+        if (ret >= 0 && c0->sliceDir)
+            return 0;
+    }
     if (ret < 0)
         return ret;
 
-    if (c->cascaded_context[2])
-        ret = scale_internal(c->cascaded_context[1], (const uint8_t * const *)c->cascaded_tmp,
-                             c->cascaded_tmpStride, srcSliceY, srcSliceH,
-                             c->cascaded1_tmp, c->cascaded1_tmpStride, 0, c->dstH);
-    else
-        ret = scale_internal(c->cascaded_context[1], (const uint8_t * const *)c->cascaded_tmp,
-                             c->cascaded_tmpStride, srcSliceY, srcSliceH,
-                             dstSlice, dstStride, dstSliceY, dstSliceH);
+    if (!c->cascaded_context[2])
+        return scale_gamma_stage(c->cascaded_context[1],
+                                 (const uint8_t * const *)c->cascaded_tmp,
+                                 c->cascaded_tmpStride,
+                                 dstSlice, dstStride, dstSliceY, dstSliceH);
 
+    ret = scale_gamma_stage(c->cascaded_context[1],
+                            (const uint8_t * const *)c->cascaded_tmp,
+                            c->cascaded_tmpStride,
+                            c->cascaded1_tmp, c->cascaded1_tmpStride, 0, c->dstH);
     if (ret < 0)
         return ret;
 
-    if (c->cascaded_context[2]) {
-        ret = scale_internal(c->cascaded_context[2], (const uint8_t * const *)c->cascaded1_tmp,
-                             c->cascaded1_tmpStride, c->cascaded_context[1]->dstY - ret,
-                             c->cascaded_context[1]->dstY,
+    return scale_gamma_stage(c->cascaded_context[2],
+                             (const uint8_t * const *)c->cascaded1_tmp,
+                             c->cascaded1_tmpStride,
                              dstSlice, dstStride, dstSliceY, dstSliceH);
-    }
-    return ret;
 }
 
 static int scale_cascaded(SwsContext *c,
@@ -958,6 +1035,15 @@ static int scale_internal(SwsContext *c,
     } else if (scale_dst)
         c->sliceDir = 1;
 
+    /* range conversion may be enabled later by sws_setColorspaceDetails() */
+    if (c->convert_fused && !c->lumConvertRange &&
+        (scale_dst || srcSliceH == c->srcH)) {
+        ret = c->convert_fused(c, src2, srcStride2, dstSliceY, dstSliceH,
+                               dst2, dstStride2);
+        c->sliceDir = 0;
+        return ret;
+    }
+
     if (c->src0Alpha && !c->dst0Alpha && isALPHA(c->dstFormat)) {
         uint8_t *base;
         int x,y;
@@ -1037,6 +1123,7 @@ static int scale_internal(SwsContext *c,
             slice_h = dstSliceH;
         }
 
+        c->src_frame_complete = scale_dst;
         ret = c->convert_unscaled(c, src2, srcStride2, offset, slice_h,
                                   dst2, dstStride2);
         if (scale_dst)
@@ -1071,8 +1158,52 @@ static int scale_internal(SwsContext *c,
     return ret;
 }
 
+/* pointers to the letterboxed rectangle inside the output planes */
+static void letterbox_offsets(const SwsContext *c, uint8_t * const dst[],
+                              const int dstStride[], uint8_t *rect[4])
+{
+    for (int i = 0; i < 4; i++)
+        rect[i] = FF_PTR_ADD(dst[i], (ptrdiff_t)dstStride[i] * c->lb_y +
+                                     c->lb_x * sizeof(uint32_t));
+}
+
+static void fill_line32(uint8_t *line, int x, int w, uint32_t v)
+{
+    uint32_t *dst = (uint32_t *)line + x;
+
+    for (int i = 0; i < w; i++)
+        dst[i] = v;
+}
+
+/* fill the border around the letterboxed rectangle in the lines [y, y + h) */
+static void letterbox_fill(SwsContext *c, uint8_t * const dst[],
+                           const int dstStride[], int y, int h)
+{
+    const SwsContext *rect = c->letterbox_ctx;
+    const int nb_planes = av_pix_fmt_count_planes(c->dstFormat);
+    const int right     = c->lb_x + rect->dstW;
+
+    h = FFMIN(h, c->dstH - y);
+    for (int i = 0; i < nb_planes; i++) {
+        if (!dst[i])
+            continue;
+        for (int j = y; j < y + h; j++) {
+            uint8_t *line = dst[i] + (ptrdiff_t)dstStride[i] * j;
+
+            if (j < c->lb_y || j >= c->lb_y + rect->dstH) {
+                fill_line32(line, 0, c->dstW, c->lb_fill[i]);
+            } else {
+                fill_line32(line, 0, c->lb_x, c->lb_fill[i]);
+                fill_line32(line, right, c->dstW - right, c->lb_fill[i]);
+            }
+        }
+    }
+}
+
 void sws_frame_end(struct SwsContext *c)
 {
+    if (c->letterbox_ctx)
+        sws_frame_end(c->letterbox_ctx);
     av_frame_unref(c->frame_src);
     av_frame_unref(c->frame_dst);
     c->src_ranges.nb_ranges = 0;
@@ -1105,9 +1236,59 @@ int sws_frame_start(struct SwsContext *c, AVFrame *dst, const AVFrame *src)
         return ret;
     }
 
+    if (c->letterbox_ctx) {
+        AVFrame *rect = c->letterbox_ctx->frame_dst;
+
+        ret = sws_frame_start(c->letterbox_ctx, dst, src);
+        if (ret < 0) {
+            sws_frame_end(c);
+            if (allocated)
+                av_frame_unref(dst);
+
+            return ret;
+        }
+        letterbox_offsets(c, rect->data, rect->linesize, rect->data);
+        rect->width  = c->letterbox_ctx->dstW;
+        rect->height = c->letterbox_ctx->dstH;
+    }
+
     return 0;
 }
 
+static void tile_offsets(enum AVPixelFormat format, int x, ptrdiff_t offset[4])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+
+    memset(offset, 0, 4 * sizeof(*offset));
+    for (int i = desc->nb_components - 1; i >= 0; i--) {
+        const int shift = (i == 1 || i == 2) ? desc->log2_chroma_w : 0;
+        offset[desc->comp[i].plane] = (ptrdiff_t)(x >> shift) * desc->comp[i].step;
+    }
+}
+
+/* scale the columns of one tile, src and dst point to the full width */
+static int scale_tile(SwsContext *c, const uint8_t * const src[],
+                      const int srcStride[], int srcSliceY, int srcSliceH,
+                      uint8_t * const dst[], const int dstStride[],
+                      int dstSliceY, int dstSliceH)
+{
+    const SwsContext *parent = c->parent;
+    const uint8_t *src_tile[4];
+    uint8_t       *dst_tile[4];
+    ptrdiff_t src_offset[4], dst_offset[4];
+
+    tile_offsets(parent->srcFormat, c->tile_src_x, src_offset);
+    tile_offsets(parent->dstFormat, c->tile_dst_x, dst_offset);
+
+    for (int i = 0; i < 4; i++) {
+        src_tile[i] = FF_PTR_ADD(src[i], src_offset[i]);
+        dst_tile[i] = FF_PTR_ADD(dst[i], dst_offset[i]);
+    }
+
+    return scale_internal(c, src_tile, srcStride, srcSliceY, srcSliceH,
+                          dst_tile, dstStride, dstSliceY, dstSliceH);
+}
+
 int sws_send_slice(struct SwsContext *c, unsigned int slice_start,
                    unsigned int slice_height)
 {
@@ -1117,11 +1298,17 @@ int sws_send_slice(struct SwsContext *c, unsigned int slice_start,
     if (ret < 0)
         return ret;
 
+    if (c->letterbox_ctx)
+        return sws_send_slice(c->letterbox_ctx, slice_start, slice_height);
+
     return 0;
 }
 
 unsigned int sws_receive_slice_alignment(const struct SwsContext *c)
 {
+    if (c->letterbox_ctx)
+        return sws_receive_slice_alignment(c->letterbox_ctx);
+
     if (c->slice_ctx)
         return c->slice_ctx[0]->dst_slice_align;
 
@@ -1148,32 +1335,37 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
         return AVERROR(EINVAL);
     }
 
-    if (c->slicethread) {
-        int nb_jobs = c->slice_ctx[0]->dither == SWS_DITHER_ED ? 1 : c->nb_slice_ctx;
-        int ret = 0;
+    if (c->letterbox_ctx) {
+        SwsContext *rect = c->letterbox_ctx;
+        const int start  = FFMAX((int)slice_start, c->lb_y);
+        const int end    = FFMIN((int)(slice_start + slice_height), c->lb_y + rect->dstH);
 
-        c->dst_slice_start  = slice_start;
-        c->dst_slice_height = slice_height;
+        letterbox_fill(c, c->frame_dst->data, c->frame_dst->linesize,
+                       slice_start, slice_height);
+        if (start >= end)
+            return 0;
+        return sws_receive_slice(rect, start - c->lb_y, end - start);
+    }
 
-        avpriv_slicethread_execute(c->slicethread, nb_jobs, 0);
+    if (c->slicethread)
+        return scale_slice_threads(c, slice_start, slice_height);
 
-        for (int i = 0; i < c->nb_slice_ctx; i++) {
-            if (c->slice_err[i] < 0) {
-                ret = c->slice_err[i];
-                break;
-            }
-        }
+    for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++) {
+        const int vshift = (i == 1 || i == 2) ? c->chrDstVSubSample : 0;
+        ptrdiff_t offset = c->frame_dst->linesize[i] * (slice_start >> vshift);
+        dst[i] = FF_PTR_ADD(c->frame_dst->data[i], offset);
+    }
 
-        memset(c->slice_err, 0, c->nb_slice_ctx * sizeof(*c->slice_err));
+    if (c->nb_tiles) {
+        int ret = 0;
 
+        for (int i = 0; i < c->nb_tiles && ret >= 0; i++)
+            ret = scale_tile(c->slice_ctx[i], (const uint8_t * const *)c->frame_src->data,
+                             c->frame_src->linesize, 0, c->srcH,
+                             dst, c->frame_dst->linesize, slice_start, slice_height);
         return ret;
     }
 
-    for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++) {
-        ptrdiff_t offset = c->frame_dst->linesize[i] * (slice_start >> c->chrDstVSubSample);
-        dst[i] = FF_PTR_ADD(c->frame_dst->data[i], offset);
-    }
-
     return scale_internal(c, (const uint8_t * const *)c->frame_src->data,
                           c->frame_src->linesize, 0, c->srcH,
                           dst, c->frame_dst->linesize, slice_start, slice_height);
@@ -1206,6 +1398,34 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
                                   int srcSliceH, uint8_t *const dst[],
                                   const int dstStride[])
 {
+    if (c->letterbox_ctx && dst && dstStride) {
+        SwsContext *rect = c->letterbox_ctx;
+        uint8_t *dst2[4];
+        int ret;
+
+        letterbox_offsets(c, dst, dstStride, dst2);
+        ret = sws_scale(rect, srcSlice, srcStride, srcSliceY, srcSliceH,
+                        dst2, dstStride);
+        if (ret < 0)
+            return ret;
+
+        /* the border is filled once per frame, with the top source slice */
+        if (!srcSliceY) {
+            letterbox_fill(c, dst, dstStride, 0, c->dstH);
+            ret += c->dstH - rect->dstH;
+        }
+        return ret;
+    }
+
+    if (c->nb_tiles) {
+        int ret = 0;
+
+        for (int i = 0; i < c->nb_tiles && ret >= 0; i++)
+            ret = scale_tile(c->slice_ctx[i], srcSlice, srcStride, srcSliceY,
+                             srcSliceH, dst, dstStride, 0, c->dstH);
+        return ret;
+    }
+
     if (c->nb_slice_ctx)
         c = c->slice_ctx[0];
 
@@ -1244,3 +1464,25 @@ void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
 
     parent->slice_err[threadnr] = err;
 }
+
+void ff_sws_tile_worker(void *priv, int jobnr, int threadnr,
+                        int nb_jobs, int nb_threads)
+{
+    SwsContext *parent = priv;
+    SwsContext      *c = parent->slice_ctx[jobnr];
+    uint8_t *dst[4] = { NULL };
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(dst) && parent->frame_dst->data[i]; i++) {
+        const int vshift = (i == 1 || i == 2) ? c->chrDstVSubSample : 0;
+        const ptrdiff_t offset = parent->frame_dst->linesize[i] *
+            (parent->dst_slice_start >> vshift);
+
+        dst[i] = parent->frame_dst->data[i] + offset;
+    }
+
+    parent->slice_err[jobnr] =
+        scale_tile(c, (const uint8_t * const *)parent->frame_src->data,
+                   parent->frame_src->linesize, 0, c->srcH,
+                   dst, parent->frame_dst->linesize,
+                   parent->dst_slice_start, parent->dst_slice_height);
+}
@@ -195,6 +195,18 @@ struct SwsContext *sws_getContext(int srcW, int srcH, enum AVPixelFormat srcForm
                                   int flags, SwsFilter *srcFilter,
                                   SwsFilter *dstFilter, const double *param);
 
+/**
+ * Allocate and initialize a new context doing the same conversion as src,
+ * including its AVOptions and colorspace details. The scaler coefficients
+ * of src are reused instead of being computed again, which makes this much
+ * cheaper than setting up a context from scratch.
+ *
+ * @param src an initialized context, which was not initialized with
+ *            custom SwsFilter
+ * @return the new context, or NULL in case of error
+ */
+struct SwsContext *sws_clone_context(const struct SwsContext *src);
+
 /**
  * Scale the image slice in srcSlice and put the resulting scaled
  * slice in the image in dst. A slice is a sequence of consecutive
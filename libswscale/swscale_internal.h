@@ -360,8 +360,8 @@ typedef struct SwsContext {
     double gamma_value;
     int gamma_flag;
     int is_internal_gamma;
-    uint16_t *gamma;
-    uint16_t *inv_gamma;
+    const uint16_t *gamma;
+    const uint16_t *inv_gamma;
 
     int numDesc;
     int descIndex[2];
@@ -471,6 +471,15 @@ typedef struct SwsContext {
     int yuv2rgb_u2g_coeff;
     int yuv2rgb_u2b_coeff;
 
+    /**
+     * Float output normalization, per output plane (G, B, R, A), each
+     * value repeated for SIMD: out = in * float_norm_mul + float_norm_add
+     * with in being the 16-bit intermediate value. Also used by the x86
+     * asm, see output.asm.
+     */
+    DECLARE_ALIGNED(32, float, float_norm_mul)[4][8];
+    DECLARE_ALIGNED(32, float, float_norm_add)[4][8];
+
 #define RED_DITHER            "0*8"
 #define GREEN_DITHER          "1*8"
 #define BLUE_DITHER           "2*8"
@@ -574,6 +583,13 @@ typedef struct SwsContext {
                       const uint8_t *src1, const uint8_t *src2, const uint8_t *src3,
                       int width, uint32_t *pal, void *opq);
 
+    /**
+     * In place gamma correction of w pixels of the RGB48LE or RGBA64LE output
+     * of the vertical scaler, w being a multiple of 16. Optional, the
+     * remaining pixels are done in C.
+     */
+    void (*rgb16_gamma)(uint16_t *line, const uint16_t *lut, int w);
+
     /**
      * Functions to read planar input, such as planar RGB, and convert
      * internally to Y/UV/A.
@@ -677,11 +693,75 @@ typedef struct SwsContext {
     uint8_t     *xyz_scratch;
     unsigned int xyz_scratch_allocated;
 
+    // scratch buffer for converting bayer sources to YUV
+    // filled with a demosaiced row pair, in RGB24 or RGB48
+    uint8_t     *bayer_scratch;
+    unsigned int bayer_scratch_allocated;
+
     unsigned int dst_slice_align;
+    /**
+     * Set while convert_unscaled outputs a destination slice, the complete
+     * source frame is then available around the slice.
+     */
+    int src_frame_complete;
     atomic_int   stride_unaligned_warned;
     atomic_int   data_unaligned_warned;
 
     Half2FloatTables *h2f_tables;
+
+    /**
+     * Scaler converting directly from the source to the destination planes,
+     * used for whole frames. It is called with the range of destination lines
+     * to output instead of a source slice, see fused.c.
+     */
+    SwsFunc convert_fused;
+    int fused_filter;
+
+    /**
+     * Demosaic the columns [2, width - 2) of a row pair of a bayer source,
+     * used by the unscaled bayer converters. The bayer to YUV converter
+     * demosaics to RGB48 for 16-bit sources and to RGB24 otherwise.
+     */
+    void (*bayer_interpolate_inner)(const uint8_t *src, int src_stride,
+                                    uint8_t *dst, int dst_stride, int width);
+
+    /**
+     * Column tiling, see context_init_tiled(). The parent holds one
+     * context per tile in slice_ctx; each tile scales the full height of
+     * the output columns [tile_dst_x, tile_dst_x + dstW) from the input
+     * columns starting at tile_src_x.
+     */
+    int tile_width;
+    int nb_tiles;
+    int tile_dst_x;
+    int tile_dst_w;
+    int tile_src_x;
+
+    /* formats as set by the user, before sws_init_context() resolves the
+     * deprecated and alias formats, for sws_clone_context() */
+    enum AVPixelFormat user_src_format;
+    enum AVPixelFormat user_dst_format;
+    int user_filters;
+    /* the cached hLum, hChr, vLum and vChr filters this context was built
+     * with, before any in-place changes; NULL if not cacheable */
+    AVBufferRef *filter_ref[4];
+
+    /* normalization of float outputs: out = (in - mean) / std with in in
+     * [0, 1], per R, G and B channel; gray outputs use the R values */
+    double norm_mean[3];
+    double norm_std[3];
+    int float_norm;               ///< normalization differs from the identity
+
+    /**
+     * Letterboxing, see context_init_letterbox(). letterbox_ctx scales into
+     * the rectangle at (lb_x, lb_y) of the output, the border around it is
+     * filled with lb_fill, as stored in each output plane.
+     */
+    int letterbox;
+    double letterbox_pad;
+    struct SwsContext *letterbox_ctx;
+    int lb_x, lb_y;
+    uint32_t lb_fill[4];
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -967,6 +1047,7 @@ void ff_get_unscaled_swscale(SwsContext *c);
 void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
 void ff_get_unscaled_swscale_aarch64(SwsContext *c);
+void ff_get_unscaled_swscale_x86(SwsContext *c);
 
 void ff_sws_init_scale(SwsContext *c);
 
@@ -1016,6 +1097,14 @@ int ff_sws_alphablendaway(SwsContext *c, const uint8_t *src[],
                           int srcStride[], int srcSliceY, int srcSliceH,
                           uint8_t *dst[], int dstStride[]);
 
+/**
+ * Set up convert_fused if the conversion can be done without the
+ * intermediate buffers. Must be called before the horizontal filter
+ * coefficients are rearranged for SIMD. ff_sws_init_scale() clears it again
+ * if SIMD scalers are available.
+ */
+void ff_sws_init_fused(SwsContext *c);
+
 static inline void fillPlane16(uint8_t *plane, int stride, int width, int height, int y,
                                int alpha, int bits, const int big_endian)
 {
@@ -1128,7 +1217,7 @@ int ff_free_filters(SwsContext *c);
 int ff_rotate_slice(SwsSlice *s, int lum, int chr);
 
 /// initializes gamma conversion descriptor
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table);
+int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, const uint16_t *table);
 
 /// initializes lum pixel format conversion descriptor
 int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst, uint32_t *pal);
@@ -1154,6 +1243,8 @@ void ff_init_vscale_pfn(SwsContext *c, yuv2planar1_fn yuv2plane1, yuv2planarX_fn
 
 void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
                          int nb_jobs, int nb_threads);
+void ff_sws_tile_worker(void *priv, int jobnr, int threadnr,
+                        int nb_jobs, int nb_threads);
 
 //number of extra lines to process
 #define MAX_LINES_AHEAD 4
@@ -272,6 +272,147 @@ static int planarToP01xWrapper(SwsContext *c, const uint8_t *src8[],
     return srcSliceH;
 }
 
+static int semiPlanar16ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
+                                       int srcStride[], int srcSliceY,
+                                       int srcSliceH, uint8_t *dstParam[],
+                                       int dstStride[])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int shift    = desc->comp[0].shift;
+    int chrSliceY = srcSliceY >> c->chrSrcVSubSample;
+    int chrSliceH = AV_CEIL_RSHIFT(srcSliceH, c->chrSrcVSubSample);
+
+    shiftWords(src[0], dstParam[0] + dstStride[0] * srcSliceY, c->srcW, srcSliceH,
+               srcStride[0], dstStride[0], -shift);
+    deinterleaveWords(src[1], dstParam[1] + dstStride[1] * chrSliceY,
+                      dstParam[2] + dstStride[2] * chrSliceY, c->chrSrcW, chrSliceH,
+                      srcStride[1], dstStride[1], dstStride[2], shift);
+
+    return srcSliceH;
+}
+
+static int planarToSemiPlanar16Wrapper(SwsContext *c, const uint8_t *src[],
+                                       int srcStride[], int srcSliceY,
+                                       int srcSliceH, uint8_t *dstParam[],
+                                       int dstStride[])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+    int shift    = desc->comp[0].shift;
+    int chrSliceY = srcSliceY >> c->chrSrcVSubSample;
+    int chrSliceH = AV_CEIL_RSHIFT(srcSliceH, c->chrSrcVSubSample);
+
+    shiftWords(src[0], dstParam[0] + dstStride[0] * srcSliceY, c->srcW, srcSliceH,
+               srcStride[0], dstStride[0], shift);
+    interleaveWords(src[1], src[2], dstParam[1] + dstStride[1] * chrSliceY,
+                    c->chrSrcW, chrSliceH, srcStride[1], srcStride[2], dstStride[1],
+                    shift);
+
+    return srcSliceH;
+}
+
+static int y210ToYuv422p10Wrapper(SwsContext *c, const uint8_t *src[],
+                                  int srcStride[], int srcSliceY, int srcSliceH,
+                                  uint8_t *dstParam[], int dstStride[])
+{
+    uint8_t *ydst = dstParam[0] + dstStride[0] * srcSliceY;
+    uint8_t *udst = dstParam[1] + dstStride[1] * srcSliceY;
+    uint8_t *vdst = dstParam[2] + dstStride[2] * srcSliceY;
+
+    y210toyuv422p10(ydst, udst, vdst, src[0], c->srcW, srcSliceH, dstStride[0],
+                    dstStride[1], srcStride[0]);
+
+    return srcSliceH;
+}
+
+static int yuv422p10ToY210Wrapper(SwsContext *c, const uint8_t *src[],
+                                  int srcStride[], int srcSliceY, int srcSliceH,
+                                  uint8_t *dstParam[], int dstStride[])
+{
+    uint8_t *dst = dstParam[0] + dstStride[0] * srcSliceY;
+
+    yuv422p10toy210(src[0], src[1], src[2], dst, c->srcW, srcSliceH,
+                    srcStride[0], srcStride[1], dstStride[0]);
+
+    return srcSliceH;
+}
+
+static int y210ToP210Wrapper(SwsContext *c, const uint8_t *src[],
+                             int srcStride[], int srcSliceY, int srcSliceH,
+                             uint8_t *dstParam[], int dstStride[])
+{
+    uint8_t *ydst  = dstParam[0] + dstStride[0] * srcSliceY;
+    uint8_t *uvdst = dstParam[1] + dstStride[1] * srcSliceY;
+
+    /* The luma and the interleaved chroma words alternate. The low 6 bits
+     * are cleared on the way, like the generic path does. */
+    deinterleaveWords(src[0], ydst, uvdst, c->srcW, srcSliceH,
+                      srcStride[0], dstStride[0], dstStride[1], 6);
+    shiftWords(ydst,  ydst,  c->srcW, srcSliceH, dstStride[0], dstStride[0], 6);
+    shiftWords(uvdst, uvdst, c->srcW, srcSliceH, dstStride[1], dstStride[1], 6);
+
+    return srcSliceH;
+}
+
+/* planes receiving the components of a 30-bit packed pixel, lowest bits first */
+static void packed30Planes(enum AVPixelFormat fmt, int plane[3])
+{
+    if (fmt == AV_PIX_FMT_X2BGR10LE) {
+        plane[0] = 2; plane[1] = 0; plane[2] = 1;
+    } else { /* XV30LE: U Y V, X2RGB10LE: B G R */
+        plane[0] = 1; plane[1] = 0; plane[2] = 2;
+    }
+}
+
+static int packed30ToPlanarWrapper(SwsContext *c, const uint8_t *src[],
+                                   int srcStride[], int srcSliceY, int srcSliceH,
+                                   uint8_t *dstParam[], int dstStride[])
+{
+    uint8_t *dst[3];
+    int plane[3], i, y;
+
+    packed30Planes(c->srcFormat, plane);
+    for (i = 0; i < 3; i++)
+        dst[i] = dstParam[plane[i]] + dstStride[plane[i]] * srcSliceY;
+
+    if (dstStride[0] == dstStride[1] && dstStride[0] == dstStride[2]) {
+        packed30toplanar(src[0], dst[0], dst[1], dst[2], c->srcW, srcSliceH,
+                         srcStride[0], dstStride[0]);
+    } else {
+        for (y = 0; y < srcSliceH; y++)
+            packed30toplanar(src[0] + y * srcStride[0],
+                             dst[0] + y * dstStride[plane[0]],
+                             dst[1] + y * dstStride[plane[1]],
+                             dst[2] + y * dstStride[plane[2]], c->srcW, 1, 0, 0);
+    }
+
+    return srcSliceH;
+}
+
+static int planarToPacked30Wrapper(SwsContext *c, const uint8_t *src[],
+                                   int srcStride[], int srcSliceY, int srcSliceH,
+                                   uint8_t *dstParam[], int dstStride[])
+{
+    uint8_t *dst = dstParam[0] + dstStride[0] * srcSliceY;
+    /* the X bits are set in RGB, like the packed RGB writers do */
+    uint32_t pad = c->dstFormat == AV_PIX_FMT_XV30LE ? 0 : 3U << 30;
+    int plane[3], y;
+
+    packed30Planes(c->dstFormat, plane);
+
+    if (srcStride[0] == srcStride[1] && srcStride[0] == srcStride[2]) {
+        planartopacked30(src[plane[0]], src[plane[1]], src[plane[2]], dst,
+                         c->srcW, srcSliceH, srcStride[0], dstStride[0], pad);
+    } else {
+        for (y = 0; y < srcSliceH; y++)
+            planartopacked30(src[plane[0]] + y * srcStride[plane[0]],
+                             src[plane[1]] + y * srcStride[plane[1]],
+                             src[plane[2]] + y * srcStride[plane[2]],
+                             dst + y * dstStride[0], c->srcW, 1, 0, 0, pad);
+    }
+
+    return srcSliceH;
+}
+
 #if AV_HAVE_BIGENDIAN
 #define output_pixel(p, v) do { \
         uint16_t *pp = (p); \
@@ -1277,20 +1418,18 @@ static int rgbToPlanarRgbWrapper(SwsContext *c, const uint8_t *src[],
 #define BAYER_RENAME(x) bayer_rggb16be_to_##x
 #include "bayer_template.c"
 
-static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
-                                  int srcSliceH, uint8_t* dst[], int dstStride[])
-{
-    uint8_t *dstPtr= dst[0] + srcSliceY * dstStride[0];
-    const uint8_t *srcPtr= src[0];
-    int i;
-    void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
-    void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
+typedef void (*bayer_rgb_func)(const uint8_t *src, int src_stride,
+                               uint8_t *dst, int dst_stride, int width);
 
-    switch(c->srcFormat) {
+static bayer_rgb_func get_bayer_rgb_func(enum AVPixelFormat srcFormat, int rgb48, int inner)
+{
+    switch(srcFormat) {
 #define CASE(pixfmt, prefix) \
-    case pixfmt: copy        = bayer_##prefix##_to_rgb24_copy; \
-                 interpolate = bayer_##prefix##_to_rgb24_interpolate; \
-                 break;
+    case pixfmt: if (rgb48) \
+                     return inner ? bayer_##prefix##_to_rgb48_interpolate_inner \
+                                  : bayer_##prefix##_to_rgb48_copy; \
+                 return inner ? bayer_##prefix##_to_rgb24_interpolate_inner \
+                              : bayer_##prefix##_to_rgb24_copy;
     CASE(AV_PIX_FMT_BAYER_BGGR8,    bggr8)
     CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
     CASE(AV_PIX_FMT_BAYER_BGGR16BE, bggr16be)
@@ -1304,129 +1443,199 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
     CASE(AV_PIX_FMT_BAYER_GRBG16LE, grbg16le)
     CASE(AV_PIX_FMT_BAYER_GRBG16BE, grbg16be)
 #undef CASE
-    default: return 0;
+    default: return NULL;
     }
+}
 
-    av_assert0(srcSliceH > 1);
-
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-    srcPtr += 2 * srcStride[0];
-    dstPtr += 2 * dstStride[0];
-
-    for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-        srcPtr += 2 * srcStride[0];
-        dstPtr += 2 * dstStride[0];
+/**
+ * Return the number of rows to output for a bayer source slice, and in
+ * top and avail the number of source rows available above and from the
+ * start of the slice. When a destination slice is converted from a complete
+ * source frame, the rows around the slice are interpolated from, so that
+ * the output does not depend on the slicing. An odd last row of the frame
+ * is then output together with the slice above it.
+ */
+static int bayer_slice_rows(SwsContext *c, int srcSliceY, int srcSliceH,
+                            int *top, int *avail)
+{
+    if (!c->src_frame_complete) {
+        av_assert0(srcSliceH > 1);
+        *top   = 0;
+        *avail = srcSliceH;
+        return srcSliceH;
     }
 
-    if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
-    } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+    av_assert0(c->srcH > 1);
+    *top   = srcSliceY;
+    *avail = c->srcH - srcSliceY;
+    if (srcSliceH == 1 && *avail == 1)
+        return 0;
+    if (srcSliceH + 1 == *avail)
+        return *avail;
     return srcSliceH;
 }
 
-static int bayer_to_rgb48_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
-                                  int srcSliceH, uint8_t* dst[], int dstStride[])
+/**
+ * Demosaic the row pair at src to dst. The pair is interpolated from the rows
+ * around it if interpolate is set. A negative src_stride is used for the last
+ * row of an odd number of rows, which is then output together with the row
+ * above it.
+ */
+static void bayer_demosaic_rows(SwsContext *c, bayer_rgb_func copy,
+                                const uint8_t *src, int src_stride,
+                                uint8_t *dst, int dst_stride,
+                                int src_pixel, int dst_pixel, int interpolate)
 {
-    uint8_t *dstPtr= dst[0] + srcSliceY * dstStride[0];
-    const uint8_t *srcPtr= src[0];
-    int i;
-    void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
-    void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dst, int dst_stride, int width);
+    const int last = (c->srcW - 1) & ~1;
 
-    switch(c->srcFormat) {
-#define CASE(pixfmt, prefix) \
-    case pixfmt: copy        = bayer_##prefix##_to_rgb48_copy; \
-                 interpolate = bayer_##prefix##_to_rgb48_interpolate; \
-                 break;
-    CASE(AV_PIX_FMT_BAYER_BGGR8,    bggr8)
-    CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
-    CASE(AV_PIX_FMT_BAYER_BGGR16BE, bggr16be)
-    CASE(AV_PIX_FMT_BAYER_RGGB8,    rggb8)
-    CASE(AV_PIX_FMT_BAYER_RGGB16LE, rggb16le)
-    CASE(AV_PIX_FMT_BAYER_RGGB16BE, rggb16be)
-    CASE(AV_PIX_FMT_BAYER_GBRG8,    gbrg8)
-    CASE(AV_PIX_FMT_BAYER_GBRG16LE, gbrg16le)
-    CASE(AV_PIX_FMT_BAYER_GBRG16BE, gbrg16be)
-    CASE(AV_PIX_FMT_BAYER_GRBG8,    grbg8)
-    CASE(AV_PIX_FMT_BAYER_GRBG16LE, grbg16le)
-    CASE(AV_PIX_FMT_BAYER_GRBG16BE, grbg16be)
-#undef CASE
-    default: return 0;
+    if (!interpolate) {
+        copy(src, src_stride, dst, dst_stride, c->srcW);
+        return;
     }
+    copy(src, src_stride, dst, dst_stride, 2);
+    if (c->srcW > 2) {
+        c->bayer_interpolate_inner(src, src_stride, dst, dst_stride, c->srcW);
+        copy(src + last * src_pixel, src_stride,
+             dst + last * dst_pixel, dst_stride, 2);
+    }
+}
 
-    av_assert0(srcSliceH > 1);
+static int bayer_to_rgb_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
+                                int srcSliceH, uint8_t* dst[], int dstStride[])
+{
+    const int rgb48      = c->dstFormat == AV_PIX_FMT_RGB48;
+    const int src_pixel  = isBayer16BPS(c->srcFormat) ? 2 : 1;
+    const int dst_pixel  = rgb48 ? 6 : 3;
+    const bayer_rgb_func copy = get_bayer_rgb_func(c->srcFormat, rgb48, 0);
+    uint8_t *dstPtr= dst[0] + srcSliceY * dstStride[0];
+    const uint8_t *srcPtr= src[0];
+    int i, top, avail, end;
 
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-    srcPtr += 2 * srcStride[0];
-    dstPtr += 2 * dstStride[0];
+    if (!copy)
+        return 0;
 
-    for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+    end = bayer_slice_rows(c, srcSliceY, srcSliceH, &top, &avail);
+
+    for (i = 0; i < end; i += 2) {
+        if (i + 1 == end)
+            bayer_demosaic_rows(c, copy, srcPtr, -srcStride[0], dstPtr, -dstStride[0],
+                                src_pixel, dst_pixel, 0);
+        else
+            bayer_demosaic_rows(c, copy, srcPtr, srcStride[0], dstPtr, dstStride[0],
+                                src_pixel, dst_pixel, (i || top) && i + 2 < avail);
         srcPtr += 2 * srcStride[0];
         dstPtr += 2 * dstStride[0];
     }
-
-    if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstPtr, -dstStride[0], c->srcW);
-    } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
     return srcSliceH;
 }
 
+/**
+ * Convert a demosaiced row pair to YV12, taking the chroma of each 2x2 block
+ * from its top left pixel like ff_rgb24toyv12() does. 16-bit sources are
+ * demosaiced to RGB48, of which only the high bytes are used. The U and V
+ * outputs are swapped, as the bayer to YV12 converter always did.
+ */
+static av_always_inline void bayer_rgb_to_yv12_rows(const uint8_t *rgb, int rgb_stride,
+                                                    uint8_t *dstY, uint8_t *dstU,
+                                                    uint8_t *dstV, int luma_stride,
+                                                    int width, const int32_t *rgb2yuv,
+                                                    int rgb48)
+{
+    const int32_t ry = rgb2yuv[RY_IDX], gy = rgb2yuv[GY_IDX], by = rgb2yuv[BY_IDX];
+    const int32_t ru = rgb2yuv[RU_IDX], gu = rgb2yuv[GU_IDX], bu = rgb2yuv[BU_IDX];
+    const int32_t rv = rgb2yuv[RV_IDX], gv = rgb2yuv[GV_IDX], bv = rgb2yuv[BV_IDX];
+    const int pixel = rgb48 ? 6 : 3;
+    int x, i;
+
+    for (x = 0; x < width; x += 2) {
+        for (i = 0; i < 4; i++) {
+            const uint8_t *p = rgb + (i >> 1) * rgb_stride + (x + (i & 1)) * pixel;
+            unsigned int b, g, r;
+
+            if (rgb48) {
+                const uint16_t *p16 = (const uint16_t *)p;
+                b = p16[0] >> 8;
+                g = p16[1] >> 8;
+                r = p16[2] >> 8;
+            } else {
+                b = p[0];
+                g = p[1];
+                r = p[2];
+            }
+
+            dstY[(i >> 1) * luma_stride + x + (i & 1)] = ((ry * r + gy * g + by * b) >> RGB2YUV_SHIFT) + 16;
+            if (!i) {
+                dstV[x >> 1] = ((ru * r + gu * g + bu * b) >> RGB2YUV_SHIFT) + 128;
+                dstU[x >> 1] = ((rv * r + gv * g + bv * b) >> RGB2YUV_SHIFT) + 128;
+            }
+        }
+    }
+}
+
+static void bayer_rgb24_to_yv12_rows(const uint8_t *rgb, int rgb_stride,
+                                     uint8_t *dstY, uint8_t *dstU, uint8_t *dstV,
+                                     int luma_stride, int width, const int32_t *rgb2yuv)
+{
+    bayer_rgb_to_yv12_rows(rgb, rgb_stride, dstY, dstU, dstV, luma_stride,
+                           width, rgb2yuv, 0);
+}
+
+static void bayer_rgb48_to_yv12_rows(const uint8_t *rgb, int rgb_stride,
+                                     uint8_t *dstY, uint8_t *dstU, uint8_t *dstV,
+                                     int luma_stride, int width, const int32_t *rgb2yuv)
+{
+    bayer_rgb_to_yv12_rows(rgb, rgb_stride, dstY, dstU, dstV, luma_stride,
+                           width, rgb2yuv, 1);
+}
+
 static int bayer_to_yv12_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
                                  int srcSliceH, uint8_t* dst[], int dstStride[])
 {
+    const int rgb48      = isBayer16BPS(c->srcFormat);
+    const int src_pixel  = rgb48 ? 2 : 1;
+    const int rgb_pixel  = rgb48 ? 6 : 3;
+    /* an odd width is demosaiced up to the next even column */
+    const int rgb_stride = FFALIGN((c->srcW + 1) * rgb_pixel, 16);
+    const bayer_rgb_func copy = get_bayer_rgb_func(c->srcFormat, rgb48, 0);
+    void (*to_yv12)(const uint8_t *rgb, int rgb_stride, uint8_t *dstY, uint8_t *dstU,
+                    uint8_t *dstV, int luma_stride, int width, const int32_t *rgb2yuv) =
+        rgb48 ? bayer_rgb48_to_yv12_rows : bayer_rgb24_to_yv12_rows;
     const uint8_t *srcPtr= src[0];
     uint8_t *dstY= dst[0] + srcSliceY * dstStride[0];
     uint8_t *dstU= dst[1] + srcSliceY * dstStride[1] / 2;
     uint8_t *dstV= dst[2] + srcSliceY * dstStride[2] / 2;
-    int i;
-    void (*copy)       (const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv);
-    void (*interpolate)(const uint8_t *src, int src_stride, uint8_t *dstY, uint8_t *dstU, uint8_t *dstV, int luma_stride, int width, int32_t *rgb2yuv);
-
-    switch(c->srcFormat) {
-#define CASE(pixfmt, prefix) \
-    case pixfmt: copy        = bayer_##prefix##_to_yv12_copy; \
-                 interpolate = bayer_##prefix##_to_yv12_interpolate; \
-                 break;
-    CASE(AV_PIX_FMT_BAYER_BGGR8,    bggr8)
-    CASE(AV_PIX_FMT_BAYER_BGGR16LE, bggr16le)
-    CASE(AV_PIX_FMT_BAYER_BGGR16BE, bggr16be)
-    CASE(AV_PIX_FMT_BAYER_RGGB8,    rggb8)
-    CASE(AV_PIX_FMT_BAYER_RGGB16LE, rggb16le)
-    CASE(AV_PIX_FMT_BAYER_RGGB16BE, rggb16be)
-    CASE(AV_PIX_FMT_BAYER_GBRG8,    gbrg8)
-    CASE(AV_PIX_FMT_BAYER_GBRG16LE, gbrg16le)
-    CASE(AV_PIX_FMT_BAYER_GBRG16BE, gbrg16be)
-    CASE(AV_PIX_FMT_BAYER_GRBG8,    grbg8)
-    CASE(AV_PIX_FMT_BAYER_GRBG16LE, grbg16le)
-    CASE(AV_PIX_FMT_BAYER_GRBG16BE, grbg16be)
-#undef CASE
-    default: return 0;
-    }
-
-    av_assert0(srcSliceH > 1);
-
-    copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
-    srcPtr += 2 * srcStride[0];
-    dstY   += 2 * dstStride[0];
-    dstU   +=     dstStride[1];
-    dstV   +=     dstStride[1];
-
-    for (i = 2; i < srcSliceH - 2; i += 2) {
-        interpolate(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
+    int i, top, avail, end;
+
+    if (!copy)
+        return 0;
+
+    /* each row pair is demosaiced to a scratch buffer first, so that the
+     * SIMD versions of bayer_interpolate_inner() are used for it too */
+    av_fast_malloc(&c->bayer_scratch, &c->bayer_scratch_allocated, 2 * rgb_stride);
+    if (!c->bayer_scratch)
+        return AVERROR(ENOMEM);
+
+    end = bayer_slice_rows(c, srcSliceY, srcSliceH, &top, &avail);
+
+    for (i = 0; i < end; i += 2) {
+        if (i + 1 == end) {
+            bayer_demosaic_rows(c, copy, srcPtr, -srcStride[0],
+                                c->bayer_scratch + rgb_stride, -rgb_stride,
+                                src_pixel, rgb_pixel, 0);
+            to_yv12(c->bayer_scratch + rgb_stride, -rgb_stride,
+                    dstY, dstU, dstV, -dstStride[0], c->srcW, c->input_rgb2yuv_table);
+        } else {
+            bayer_demosaic_rows(c, copy, srcPtr, srcStride[0],
+                                c->bayer_scratch, rgb_stride, src_pixel, rgb_pixel,
+                                (i || top) && i + 2 < avail);
+            to_yv12(c->bayer_scratch, rgb_stride,
+                    dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
+        }
         srcPtr += 2 * srcStride[0];
         dstY   += 2 * dstStride[0];
         dstU   +=     dstStride[1];
         dstV   +=     dstStride[1];
     }
-
-    if (i + 1 == srcSliceH) {
-        copy(srcPtr, -srcStride[0], dstY, dstU, dstV, -dstStride[0], c->srcW, c->input_rgb2yuv_table);
-    } else if (i < srcSliceH)
-        copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
     return srcSliceH;
 }
 
@@ -1971,6 +2180,23 @@ static int planarCopyWrapper(SwsContext *c, const uint8_t *src[],
      (src_fmt == pix_fmt ## LE && dst_fmt == pix_fmt ## BE))
 
 
+/* little-endian 16-bit semi-planar YUV and planar YUV with the same depth
+ * and subsampling */
+static int isSemiPlanar16Planar(enum AVPixelFormat semi, enum AVPixelFormat planar)
+{
+    const AVPixFmtDescriptor *sdesc = av_pix_fmt_desc_get(semi);
+    const AVPixFmtDescriptor *pdesc = av_pix_fmt_desc_get(planar);
+
+    return isSemiPlanarYUV(semi) && sdesc->comp[0].step == 2 &&
+           sdesc->comp[1].offset < sdesc->comp[2].offset &&
+           isPlanarYUV(planar) && !isSemiPlanarYUV(planar) &&
+           pdesc->nb_components == 3 && pdesc->comp[0].depth > 8 &&
+           !((sdesc->flags | pdesc->flags) & AV_PIX_FMT_FLAG_BE) &&
+           sdesc->comp[0].depth == pdesc->comp[0].depth &&
+           sdesc->log2_chroma_w == pdesc->log2_chroma_w &&
+           sdesc->log2_chroma_h == pdesc->log2_chroma_h;
+}
+
 void ff_get_unscaled_swscale(SwsContext *c)
 {
     const enum AVPixelFormat srcFormat = c->srcFormat;
@@ -2006,10 +2232,14 @@ void ff_get_unscaled_swscale(SwsContext *c)
     }
     /* yuv2bgr */
     if ((srcFormat == AV_PIX_FMT_YUV420P || srcFormat == AV_PIX_FMT_YUV422P ||
-         srcFormat == AV_PIX_FMT_YUVA420P) && isAnyRGB(dstFormat) &&
+         srcFormat == AV_PIX_FMT_YUVA420P || srcFormat == AV_PIX_FMT_YUV444P ||
+         srcFormat == AV_PIX_FMT_YUVA444P || srcFormat == AV_PIX_FMT_YUV420P10) && isAnyRGB(dstFormat) &&
         !(flags & SWS_ACCURATE_RND) && (c->dither == SWS_DITHER_BAYER || c->dither == SWS_DITHER_AUTO) && !(dstH & 1)) {
-        c->convert_unscaled = ff_yuv2rgb_get_func_ptr(c);
-        c->dst_slice_align = 2;
+        SwsFunc func = ff_yuv2rgb_get_func_ptr(c);
+        if (func) {
+            c->convert_unscaled = func;
+            c->dst_slice_align = 2;
+        }
     }
     /* yuv420p1x_to_p01x */
     if ((srcFormat == AV_PIX_FMT_YUV420P10 || srcFormat == AV_PIX_FMT_YUVA420P10 ||
@@ -2025,6 +2255,35 @@ void ff_get_unscaled_swscale(SwsContext *c)
         c->convert_unscaled = planar8ToP01xleWrapper;
     }
 
+    /* 16-bit semi-planar <-> planar YUV */
+    if (isSemiPlanar16Planar(srcFormat, dstFormat))
+        c->convert_unscaled = semiPlanar16ToPlanarWrapper;
+    /* planarToP01xWrapper() keeps the pairs it handles, it leaves the last
+     * chroma pair of odd widths untouched */
+    if (isSemiPlanar16Planar(dstFormat, srcFormat) &&
+        c->convert_unscaled != planarToP01xWrapper)
+        c->convert_unscaled = planarToSemiPlanar16Wrapper;
+
+    /* packed 10-bit 4:2:2 */
+    if (!(c->srcW & 1)) {
+        if (srcFormat == AV_PIX_FMT_Y210LE && dstFormat == AV_PIX_FMT_YUV422P10LE)
+            c->convert_unscaled = y210ToYuv422p10Wrapper;
+        if (srcFormat == AV_PIX_FMT_YUV422P10LE && dstFormat == AV_PIX_FMT_Y210LE)
+            c->convert_unscaled = yuv422p10ToY210Wrapper;
+        if (srcFormat == AV_PIX_FMT_Y210LE && dstFormat == AV_PIX_FMT_P210LE)
+            c->convert_unscaled = y210ToP210Wrapper;
+    }
+
+    /* packed 30-bit 4:4:4 YUV and RGB */
+    if ((srcFormat == AV_PIX_FMT_XV30LE    && dstFormat == AV_PIX_FMT_YUV444P10LE) ||
+        (srcFormat == AV_PIX_FMT_X2RGB10LE && dstFormat == AV_PIX_FMT_GBRP10LE)    ||
+        (srcFormat == AV_PIX_FMT_X2BGR10LE && dstFormat == AV_PIX_FMT_GBRP10LE))
+        c->convert_unscaled = packed30ToPlanarWrapper;
+    if ((srcFormat == AV_PIX_FMT_YUV444P10LE && dstFormat == AV_PIX_FMT_XV30LE)    ||
+        (srcFormat == AV_PIX_FMT_GBRP10LE    && dstFormat == AV_PIX_FMT_X2RGB10LE) ||
+        (srcFormat == AV_PIX_FMT_GBRP10LE    && dstFormat == AV_PIX_FMT_X2BGR10LE))
+        c->convert_unscaled = planarToPacked30Wrapper;
+
     if (srcFormat == AV_PIX_FMT_YUV410P && !(dstH & 3) &&
         (dstFormat == AV_PIX_FMT_YUV420P || dstFormat == AV_PIX_FMT_YUVA420P) &&
         !(flags & SWS_BITEXACT)) {
@@ -2096,13 +2355,15 @@ void ff_get_unscaled_swscale(SwsContext *c)
 
     if (isBayer(srcFormat)) {
         c->dst_slice_align = 2;
-        if (dstFormat == AV_PIX_FMT_RGB24)
-            c->convert_unscaled = bayer_to_rgb24_wrapper;
-        else if (dstFormat == AV_PIX_FMT_RGB48)
-            c->convert_unscaled = bayer_to_rgb48_wrapper;
-        else if (dstFormat == AV_PIX_FMT_YUV420P)
-            c->convert_unscaled = bayer_to_yv12_wrapper;
-        else if (!isBayer(dstFormat)) {
+        if (dstFormat == AV_PIX_FMT_RGB24 || dstFormat == AV_PIX_FMT_RGB48) {
+            c->convert_unscaled        = bayer_to_rgb_wrapper;
+            c->bayer_interpolate_inner = get_bayer_rgb_func(srcFormat,
+                                                            dstFormat == AV_PIX_FMT_RGB48, 1);
+        } else if (dstFormat == AV_PIX_FMT_YUV420P) {
+            c->convert_unscaled        = bayer_to_yv12_wrapper;
+            c->bayer_interpolate_inner = get_bayer_rgb_func(srcFormat,
+                                                            isBayer16BPS(srcFormat), 1);
+        } else if (!isBayer(dstFormat)) {
             av_log(c, AV_LOG_ERROR, "unsupported bayer conversion\n");
             av_assert0(0);
         }
@@ -2229,6 +2490,8 @@ void ff_get_unscaled_swscale(SwsContext *c)
     ff_get_unscaled_swscale_arm(c);
 #elif ARCH_AARCH64
     ff_get_unscaled_swscale_aarch64(c);
+#elif ARCH_X86
+    ff_get_unscaled_swscale_x86(c);
 #endif
 }
 
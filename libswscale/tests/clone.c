@@ -0,0 +1,172 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that a context created by sws_clone_context() produces the same
+ * output as its source, also after the source has been freed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/macros.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+
+static const struct {
+    const char *src_fmt;
+    int src_w, src_h;
+    const char *dst_fmt;
+    int dst_w, dst_h;
+    const char *opts;
+    int colorspace;             ///< set custom colorspace details
+} tests[] = {
+    { "yuv420p",     352, 288, "yuv420p",   176, 144, "sws_flags=bilinear+accurate_rnd+bitexact" },
+    { "yuv420p",     352, 288, "rgb24",     500, 300, "sws_flags=bicubic+accurate_rnd+bitexact" },
+    { "yuv420p",     352, 288, "rgb24",     500, 300, "sws_flags=bicubic+accurate_rnd+bitexact", 1 },
+    { "yuv420p10le", 320, 240, "nv12",      640, 360, "sws_flags=lanczos+accurate_rnd+bitexact:threads=2" },
+    { "yuvj420p",    320, 240, "yuv420p",   200, 100, "sws_flags=area+accurate_rnd+bitexact" },
+    { "rgb24",       300, 200, "yuv444p",  1280, 100, "sws_flags=bicubic+accurate_rnd+bitexact:tile_width=256" },
+    { "gbrp",        200, 200, "yuv420p",   100,  50, "sws_flags=area+accurate_rnd+bitexact", 1 },
+    { "yuv420p",     352, 288, "rgb48le",   200, 150, "sws_flags=bicubic+accurate_rnd+bitexact:gamma=1" },
+    { "yuv420p",     352, 288, "grayf32le", 100, 100, "sws_flags=bilinear+accurate_rnd+bitexact:letterbox=1" },
+};
+
+static int scale(struct SwsContext *c, const AVFrame *src, AVFrame *dst, uint8_t *buf, int size)
+{
+    int ret = sws_scale_frame(c, dst, src);
+    if (ret < 0)
+        return ret;
+    return av_image_copy_to_buffer(buf, size, (const uint8_t * const *)dst->data,
+                                   dst->linesize, dst->format,
+                                   dst->width, dst->height, 1);
+}
+
+static int run_test(int n, AVLFG *lfg)
+{
+    enum AVPixelFormat src_fmt = av_get_pix_fmt(tests[n].src_fmt);
+    enum AVPixelFormat dst_fmt = av_get_pix_fmt(tests[n].dst_fmt);
+    struct SwsContext *c = sws_alloc_context(), *clone = NULL;
+    AVFrame *src = av_frame_alloc(), *dst = av_frame_alloc();
+    uint8_t *ref = NULL, *out = NULL;
+    int size, ret, differs = 0;
+
+    if (!c || !src || !dst) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    av_opt_set_int(c, "srcw",       tests[n].src_w, 0);
+    av_opt_set_int(c, "srch",       tests[n].src_h, 0);
+    av_opt_set_int(c, "src_format", src_fmt,        0);
+    av_opt_set_int(c, "dstw",       tests[n].dst_w, 0);
+    av_opt_set_int(c, "dsth",       tests[n].dst_h, 0);
+    av_opt_set_int(c, "dst_format", dst_fmt,        0);
+    if ((ret = av_set_options_string(c, tests[n].opts, "=", ":")) < 0 ||
+        (ret = sws_init_context(c, NULL, NULL)) < 0)
+        goto end;
+    if (tests[n].colorspace &&
+        (ret = sws_setColorspaceDetails(c, sws_getCoefficients(SWS_CS_ITU709), 1,
+                                        sws_getCoefficients(SWS_CS_ITU601), 0,
+                                        -(1 << 12), 3 << 15, 5 << 14)) < 0)
+        goto end;
+
+    src->format = src_fmt;
+    src->width  = tests[n].src_w;
+    src->height = tests[n].src_h;
+    if ((ret = av_frame_get_buffer(src, 0)) < 0)
+        goto end;
+    for (int p = 0; p < 4 && src->buf[p]; p++)
+        for (int i = 0; i < src->buf[p]->size; i++)
+            src->buf[p]->data[i] = av_lfg_get(lfg);
+    /* keep 10-bit samples in range */
+    if (av_pix_fmt_desc_get(src_fmt)->comp[0].depth == 10)
+        for (int p = 0; p < 4 && src->buf[p]; p++)
+            for (int i = 1; i < src->buf[p]->size; i += 2)
+                src->buf[p]->data[i] &= 3;
+
+    size = av_image_get_buffer_size(dst_fmt, tests[n].dst_w, tests[n].dst_h, 1);
+    ref  = av_malloc(size);
+    out  = av_malloc(size);
+    if (!ref || !out) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = scale(c, src, dst, ref, size)) < 0)
+        goto end;
+
+    clone = sws_clone_context(c);
+    if (!clone) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    printf("%s %dx%d -> %s %dx%d %s%s:", tests[n].src_fmt, tests[n].src_w,
+           tests[n].src_h, tests[n].dst_fmt, tests[n].dst_w, tests[n].dst_h,
+           tests[n].opts, tests[n].colorspace ? " colorspace" : "");
+
+    av_frame_unref(dst);
+    if ((ret = scale(clone, src, dst, out, size)) < 0)
+        goto end;
+    differs |= !!memcmp(ref, out, size);
+    printf(" clone %s", differs ? "differs" : "ok");
+
+    /* the clone must not depend on its source */
+    sws_freeContext(c);
+    c = NULL;
+    av_frame_unref(dst);
+    memset(out, 0, size);
+    if ((ret = scale(clone, src, dst, out, size)) < 0)
+        goto end;
+    printf(", without source %s\n", memcmp(ref, out, size) ? "differs" : "ok");
+    differs |= !!memcmp(ref, out, size);
+
+end:
+    sws_freeContext(c);
+    sws_freeContext(clone);
+    av_frame_free(&src);
+    av_frame_free(&dst);
+    av_free(ref);
+    av_free(out);
+    return ret < 0 ? ret : differs;
+}
+
+int main(void)
+{
+    AVLFG lfg;
+    int ret = 0;
+
+    av_lfg_init(&lfg, 1);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(tests); i++) {
+        int err = run_test(i, &lfg);
+        if (err < 0)
+            fprintf(stderr, "test %d failed: %s\n", i, av_err2str(err));
+        if (err)
+            ret = 1;
+    }
+
+    return ret;
+}
@@ -32,6 +32,9 @@
 #include "libavutil/crc.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/lfg.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/time.h"
 
 #include "libswscale/swscale.h"
 
@@ -78,6 +81,13 @@ struct Results {
     uint32_t crc;
 };
 
+/* number of timed sws_scale() calls per conversion, 0 disables timing */
+static int bench_runs;
+
+/* options of the tested context */
+static int nb_threads = 1;
+static int tile_width;
+
 // test by ref -> src -> dst -> out & compare out against ref
 // ref & out are YV12
 static int doTest(const uint8_t * const ref[4], int refStride[4], int w, int h,
@@ -165,8 +175,22 @@ static int doTest(const uint8_t * const ref[4], int refStride[4], int w, int h,
         }
     }
 
-    dstContext = sws_getContext(srcW, srcH, srcFormat, dstW, dstH, dstFormat,
-                                flags, NULL, NULL, NULL);
+    dstContext = sws_alloc_context();
+    if (dstContext) {
+        av_opt_set_int(dstContext, "srcw",       srcW,       0);
+        av_opt_set_int(dstContext, "srch",       srcH,       0);
+        av_opt_set_int(dstContext, "src_format", srcFormat,  0);
+        av_opt_set_int(dstContext, "dstw",       dstW,       0);
+        av_opt_set_int(dstContext, "dsth",       dstH,       0);
+        av_opt_set_int(dstContext, "dst_format", dstFormat,  0);
+        av_opt_set_int(dstContext, "sws_flags",  flags,      0);
+        av_opt_set_int(dstContext, "threads",    nb_threads, 0);
+        av_opt_set_int(dstContext, "tile_width", tile_width, 0);
+        if (sws_init_context(dstContext, NULL, NULL) < 0) {
+            sws_freeContext(dstContext);
+            dstContext = NULL;
+        }
+    }
     if (!dstContext) {
         fprintf(stderr, "Failed to get %s ---> %s\n",
                 desc_src->name, desc_dst->name);
@@ -182,6 +206,21 @@ static int doTest(const uint8_t * const ref[4], int refStride[4], int w, int h,
 
     sws_scale(dstContext, (const uint8_t * const*)src, srcStride, 0, srcH, dst, dstStride);
 
+    if (bench_runs) {
+        int64_t t = av_gettime_relative();
+        for (i = 0; i < bench_runs; i++)
+            sws_scale(dstContext, (const uint8_t * const*)src, srcStride, 0, srcH,
+                      dst, dstStride);
+        t = av_gettime_relative() - t;
+        printf(" %7.2fus", (double)t / bench_runs);
+
+        t = av_gettime_relative();
+        for (i = 0; i < bench_runs; i++)
+            sws_freeContext(sws_clone_context(dstContext));
+        t = av_gettime_relative() - t;
+        printf(" clone %7.2fus", (double)t / bench_runs);
+    }
+
     for (i = 0; i < 4 && dstStride[i]; i++)
         crc = av_crc(av_crc_get_table(AV_CRC_32_IEEE), crc, dst[i],
                      dstStride[i] * dstH);
@@ -260,8 +299,8 @@ static void selfTest(const uint8_t * const ref[4], int refStride[4],
                           SWS_X, SWS_POINT, SWS_AREA, 0 };
     const int srcW   = w;
     const int srcH   = h;
-    const int dstW[] = { srcW - srcW / 3, srcW, srcW + srcW / 3, 0 };
-    const int dstH[] = { srcH - srcH / 3, srcH, srcH + srcH / 3, 0 };
+    const int dstW[] = { srcW / 2, srcW - srcW / 3, srcW, srcW + srcW / 3, 0 };
+    const int dstH[] = { srcH / 2, srcH - srcH / 3, srcH, srcH + srcH / 3, 0 };
     enum AVPixelFormat srcFormat, dstFormat;
     const AVPixFmtDescriptor *desc_src, *desc_dst;
 
@@ -355,19 +394,17 @@ static int fileTest(const uint8_t * const ref[4], int refStride[4],
     return 0;
 }
 
-#define W 96
-#define H 96
-
 int main(int argc, char **argv)
 {
     enum AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
     enum AVPixelFormat dstFormat = AV_PIX_FMT_NONE;
-    uint8_t *rgb_data   = av_malloc(W * H * 4);
-    const uint8_t * const rgb_src[4] = { rgb_data, NULL, NULL, NULL };
-    int rgb_stride[4]   = { 4 * W, 0, 0, 0 };
-    uint8_t *data       = av_malloc(4 * W * H);
-    const uint8_t * const src[4] = { data, data + W * H, data + W * H * 2, data + W * H * 3 };
-    int stride[4]       = { W, W, W, W };
+    int W = 96, H = 96;
+    uint8_t *rgb_data = NULL;
+    const uint8_t *rgb_src[4] = { NULL };
+    int rgb_stride[4] = { 0 };
+    uint8_t *data = NULL;
+    const uint8_t *src[4];
+    int stride[4];
     int x, y;
     struct SwsContext *sws;
     AVLFG rand;
@@ -375,9 +412,6 @@ int main(int argc, char **argv)
     int i;
     FILE *fp = NULL;
 
-    if (!rgb_data || !data)
-        return -1;
-
     for (i = 1; i < argc; i += 2) {
         if (argv[i][0] != '-' || i + 1 == argc)
             goto bad_option;
@@ -395,6 +429,21 @@ int main(int argc, char **argv)
                 return ret;
             }
             av_force_cpu_flags(flags);
+        } else if (!strcmp(argv[i], "-bench")) {
+            bench_runs = atoi(argv[i + 1]);
+            if (bench_runs < 0) {
+                fprintf(stderr, "invalid number of runs %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-size")) {
+            if (av_parse_video_size(&W, &H, argv[i + 1]) < 0 || W < 12 || H < 12) {
+                fprintf(stderr, "invalid size %s\n", argv[i + 1]);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "-threads")) {
+            nb_threads = atoi(argv[i + 1]);
+        } else if (!strcmp(argv[i], "-tile_width")) {
+            tile_width = atoi(argv[i + 1]);
         } else if (!strcmp(argv[i], "-src")) {
             srcFormat = av_get_pix_fmt(argv[i + 1]);
             if (srcFormat == AV_PIX_FMT_NONE) {
@@ -414,6 +463,18 @@ bad_option:
         }
     }
 
+    rgb_data = av_malloc(W * H * 4);
+    data     = av_malloc(4 * W * H);
+    if (!rgb_data || !data)
+        goto error;
+
+    rgb_src[0]    = rgb_data;
+    rgb_stride[0] = 4 * W;
+    for (i = 0; i < 4; i++) {
+        src[i]    = data + W * H * i;
+        stride[i] = W;
+    }
+
     sws = sws_getContext(W / 12, H / 12, AV_PIX_FMT_RGB32, W, H,
                          AV_PIX_FMT_YUVA420P, SWS_BILINEAR, NULL, NULL, NULL);
 
@@ -428,7 +489,7 @@ bad_option:
         goto error;
     }
     sws_freeContext(sws);
-    av_free(rgb_data);
+    av_freep(&rgb_data);
 
     if(fp) {
         res = fileTest(src, stride, W, H, fp, srcFormat, dstFormat);
@@ -438,6 +499,7 @@ bad_option:
         res = 0;
     }
 error:
+    av_free(rgb_data);
     av_free(data);
 
     return res;
@@ -42,6 +42,7 @@
 #include "libavutil/avassert.h"
 #include "libavutil/cpu.h"
 #include "libavutil/imgutils.h"
+#include "libavutil/intfloat.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/libm.h"
 #include "libavutil/mathematics.h"
@@ -380,12 +381,12 @@ static const ScaleAlgorithm scale_algorithms[] = {
     { SWS_X,             "experimental",                    8 },
 };
 
-static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
-                              int *outFilterSize, int xInc, int srcW,
-                              int dstW, int filterAlign, int one,
-                              int flags, int cpu_flags,
-                              SwsVector *srcFilter, SwsVector *dstFilter,
-                              double param[2], int srcPos, int dstPos)
+static av_cold int build_filter(int16_t **outFilter, int32_t **filterPos,
+                                int *outFilterSize, int xInc, int srcW,
+                                int dstW, int filterAlign, int one,
+                                int flags, int cpu_flags,
+                                SwsVector *srcFilter, SwsVector *dstFilter,
+                                double param[2], int srcPos, int dstPos)
 {
     int i;
     int filterSize;
@@ -789,6 +790,228 @@ done:
     return ret;
 }
 
+/*
+ * Process-wide cache of the filters built by build_filter(), so that
+ * creating many contexts with the same sizes and flags, or recreating one
+ * in sws_getCachedContext(), does not recompute the coefficients each time.
+ * Filters with user vectors are not cached. The least recently used entry
+ * is evicted when the cache is full.
+ *
+ * The entries are reference counted and every context keeps a reference
+ * to the filters it was built with, so that sws_clone_context() can put
+ * them back into the cache even after they were evicted.
+ */
+#define FILTER_CACHE_ENTRIES   64
+#define FILTER_CACHE_MAX_BYTES (16 << 20)
+
+typedef struct FilterKey {
+    double param[2];
+    int xInc, srcW, dstW, filterAlign, one, flags, cpu_flags, srcPos, dstPos;
+} FilterKey;
+
+typedef struct SharedFilter {
+    FilterKey key;
+    int16_t  *filter;
+    int32_t  *filterPos;
+    int       filterSize;
+    size_t    size;
+} SharedFilter;
+
+typedef struct FilterCacheEntry {
+    AVBufferRef *filter;        ///< holds a SharedFilter
+    unsigned     last_use;
+} FilterCacheEntry;
+
+static AVMutex filter_cache_lock = AV_MUTEX_INITIALIZER;
+static FilterCacheEntry filter_cache[FILTER_CACHE_ENTRIES];
+static size_t   filter_cache_size;
+static unsigned filter_cache_clock;
+
+static void shared_filter_free(void *opaque, uint8_t *data)
+{
+    SharedFilter *sf = (SharedFilter *)data;
+
+    av_free(sf->filter);
+    av_free(sf->filterPos);
+    av_free(sf);
+}
+
+/* returns NULL for filters too large to be cached, or on allocation failure */
+static AVBufferRef *shared_filter_alloc(const FilterKey *key, const int16_t *filter,
+                                        const int32_t *filterPos, int filterSize)
+{
+    const size_t pos_size    = (key->dstW + 3) * sizeof(*filterPos);
+    const size_t filter_size = filterSize * (key->dstW + 3) * sizeof(*filter);
+    SharedFilter *sf;
+    AVBufferRef *buf;
+
+    if (pos_size + filter_size > FILTER_CACHE_MAX_BYTES / 4)
+        return NULL;
+
+    sf = av_mallocz(sizeof(*sf));
+    if (!sf)
+        return NULL;
+    sf->filter    = av_memdup(filter, filter_size);
+    sf->filterPos = av_memdup(filterPos, pos_size);
+    if (!sf->filter || !sf->filterPos) {
+        shared_filter_free(NULL, (uint8_t *)sf);
+        return NULL;
+    }
+    sf->key        = *key;
+    sf->filterSize = filterSize;
+    sf->size       = pos_size + filter_size;
+
+    buf = av_buffer_create((uint8_t *)sf, sizeof(*sf), shared_filter_free,
+                           NULL, AV_BUFFER_FLAG_READONLY);
+    if (!buf)
+        shared_filter_free(NULL, (uint8_t *)sf);
+    return buf;
+}
+
+static void filter_cache_evict(FilterCacheEntry *e)
+{
+    filter_cache_size -= ((const SharedFilter *)e->filter->data)->size;
+    av_buffer_unref(&e->filter);
+}
+
+static FilterCacheEntry *filter_cache_lru(void)
+{
+    FilterCacheEntry *lru = NULL;
+
+    for (int i = 0; i < FILTER_CACHE_ENTRIES; i++) {
+        FilterCacheEntry *e = &filter_cache[i];
+        if (e->filter && (!lru || e->last_use < lru->last_use))
+            lru = e;
+    }
+
+    return lru;
+}
+
+/* must be called with filter_cache_lock held */
+static FilterCacheEntry *filter_cache_find(const FilterKey *key)
+{
+    for (int i = 0; i < FILTER_CACHE_ENTRIES; i++) {
+        FilterCacheEntry *e = &filter_cache[i];
+        if (e->filter && !memcmp(&((const SharedFilter *)e->filter->data)->key,
+                                 key, sizeof(*key)))
+            return e;
+    }
+
+    return NULL;
+}
+
+/* returns a new reference to the cached filter, or NULL */
+static AVBufferRef *filter_cache_get(const FilterKey *key)
+{
+    AVBufferRef *buf = NULL;
+    FilterCacheEntry *e;
+
+    ff_mutex_lock(&filter_cache_lock);
+    e = filter_cache_find(key);
+    if (e) {
+        buf = av_buffer_ref(e->filter);
+        e->last_use = ++filter_cache_clock;
+    }
+    ff_mutex_unlock(&filter_cache_lock);
+
+    return buf;
+}
+
+/* add a reference to buf to the cache, or mark its entry as just used */
+static void filter_cache_put(AVBufferRef *buf)
+{
+    const SharedFilter *sf = (const SharedFilter *)buf->data;
+    FilterCacheEntry *e;
+
+    ff_mutex_lock(&filter_cache_lock);
+    e = filter_cache_find(&sf->key);
+    if (!e) {
+        while (filter_cache_size + sf->size > FILTER_CACHE_MAX_BYTES)
+            filter_cache_evict(filter_cache_lru());
+
+        for (int i = 0; i < FILTER_CACHE_ENTRIES && !e; i++)
+            if (!filter_cache[i].filter)
+                e = &filter_cache[i];
+        if (!e) {
+            e = filter_cache_lru();
+            filter_cache_evict(e);
+        }
+
+        e->filter = av_buffer_ref(buf);
+        if (e->filter)
+            filter_cache_size += sf->size;
+    }
+    e->last_use = ++filter_cache_clock;
+    ff_mutex_unlock(&filter_cache_lock);
+}
+
+/**
+ * Like build_filter(), but take the filter from the cache when possible.
+ * *shared is set to a reference to the cached filter, or to NULL if the
+ * filter is not cacheable.
+ */
+static av_cold int initFilter(int16_t **outFilter, int32_t **filterPos,
+                              int *outFilterSize, int xInc, int srcW,
+                              int dstW, int filterAlign, int one,
+                              int flags, int cpu_flags,
+                              SwsVector *srcFilter, SwsVector *dstFilter,
+                              double param[2], int srcPos, int dstPos,
+                              AVBufferRef **shared)
+{
+    const SharedFilter *sf;
+    FilterKey key;
+    int ret;
+
+    av_buffer_unref(shared);
+
+    if (srcFilter || dstFilter)
+        return build_filter(outFilter, filterPos, outFilterSize, xInc, srcW,
+                            dstW, filterAlign, one, flags, cpu_flags,
+                            srcFilter, dstFilter, param, srcPos, dstPos);
+
+    /* zeroed so that the padding compares equal */
+    memset(&key, 0, sizeof(key));
+    key.param[0]    = param[0];
+    key.param[1]    = param[1];
+    key.xInc        = xInc;
+    key.srcW        = srcW;
+    key.dstW        = dstW;
+    key.filterAlign = filterAlign;
+    key.one         = one;
+    key.flags       = flags;
+    key.cpu_flags   = cpu_flags;
+    key.srcPos      = srcPos;
+    key.dstPos      = dstPos;
+
+    *shared = filter_cache_get(&key);
+    if (!*shared) {
+        ret = build_filter(outFilter, filterPos, outFilterSize, xInc, srcW,
+                           dstW, filterAlign, one, flags, cpu_flags,
+                           NULL, NULL, param, srcPos, dstPos);
+        if (ret < 0)
+            return ret;
+
+        *shared = shared_filter_alloc(&key, *outFilter, *filterPos, *outFilterSize);
+        if (*shared)
+            filter_cache_put(*shared);
+        return ret;
+    }
+
+    /* the caller modifies the filter in place, hand out a copy */
+    sf = (const SharedFilter *)(*shared)->data;
+    *filterPos = av_memdup(sf->filterPos, (dstW + 3) * sizeof(**filterPos));
+    *outFilter = av_memdup(sf->filter, sf->filterSize * (dstW + 3) * sizeof(**outFilter));
+    if (!*outFilter || !*filterPos) {
+        av_freep(outFilter);
+        av_freep(filterPos);
+        av_buffer_unref(shared);
+        return AVERROR(ENOMEM);
+    }
+    *outFilterSize = sf->filterSize;
+
+    return 0;
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -1000,6 +1223,11 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     const AVPixFmtDescriptor *desc_src;
     int need_reinit = 0;
 
+    if (c->letterbox_ctx)
+        return sws_setColorspaceDetails(c->letterbox_ctx, inv_table, srcRange,
+                                        table, dstRange, brightness, contrast,
+                                        saturation);
+
     if (c->nb_slice_ctx) {
         int parent_ret = 0;
         for (int i = 0; i < c->nb_slice_ctx; i++) {
@@ -1051,6 +1279,17 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
     c->dstFormatBpp = av_get_bits_per_pixel(desc_dst);
     c->srcFormatBpp = av_get_bits_per_pixel(desc_src);
 
+    if (c->gamma_flag && c->cascaded_context[0]) {
+        /* the source side goes to the first stage, the destination side to
+         * the last one, the scaling in between is RGB to RGB */
+        int ret = sws_setColorspaceDetails(c->cascaded_context[0], inv_table, srcRange,
+                                           table, 0, brightness, contrast, saturation);
+        if (ret < 0 || !c->cascaded_context[2])
+            return ret;
+        return sws_setColorspaceDetails(c->cascaded_context[2], inv_table, 0,
+                                        table, dstRange, 0, 1 << 16, 1 << 16);
+    }
+
     if (c->cascaded_context[c->cascaded_mainindex])
         return sws_setColorspaceDetails(c->cascaded_context[c->cascaded_mainindex],inv_table, srcRange,table, dstRange, brightness,  contrast, saturation);
 
@@ -1068,6 +1307,12 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
             int dstW = c->dstW;
             int dstH = c->dstH;
             int ret;
+
+            if (c->tile_dst_w) {
+                av_log(c, AV_LOG_ERROR, "YUV->YUV color matrix conversion is not supported with tiled scaling\n");
+                return AVERROR(ENOSYS);
+            }
+
             av_log(c, AV_LOG_VERBOSE, "YUV color matrix differs for YUV->YUV, using intermediate RGB to convert\n");
 
             if (isNBPS(c->dstFormat) || is16BPS(c->dstFormat)) {
@@ -1156,6 +1401,11 @@ int sws_getColorspaceDetails(struct SwsContext *c, int **inv_table,
     if (!c )
         return -1;
 
+    if (c->letterbox_ctx)
+        return sws_getColorspaceDetails(c->letterbox_ctx, inv_table, srcRange,
+                                        table, dstRange, brightness, contrast,
+                                        saturation);
+
     if (c->nb_slice_ctx) {
         return sws_getColorspaceDetails(c->slice_ctx[0], inv_table, srcRange,
                                         table, dstRange, brightness, contrast,
@@ -1189,18 +1439,63 @@ SwsContext *sws_alloc_context(void)
     return c;
 }
 
-static uint16_t * alloc_gamma_tbl(double e)
+/* gamma_value is hardcoded to 2.2, so the tables are shared by all contexts:
+ * [0] converts to linear light, [1] back from it. The extra entry is for the
+ * x86 dword gathers, which read one entry past the last index. */
+static uint16_t gamma_tables[2][(1 << 16) + 1];
+static AVOnce gamma_tables_once = AV_ONCE_INIT;
+
+static av_cold void init_gamma_tables(void)
+{
+    for (int i = 0; i < 1 << 16; i++) {
+        gamma_tables[0][i] = lrint(pow(i / 65535.0,       2.2) * 65535.0);
+        gamma_tables[1][i] = lrint(pow(i / 65535.0, 1.0 / 2.2) * 65535.0);
+    }
+}
+
+/* intermediate format of gamma correct scaling, alpha is only carried
+ * through when both ends have it */
+static enum AVPixelFormat gamma_tmp_format(enum AVPixelFormat srcFormat,
+                                           enum AVPixelFormat dstFormat)
+{
+    return isALPHA(srcFormat) && isALPHA(dstFormat) ? AV_PIX_FMT_RGBA64LE
+                                                    : AV_PIX_FMT_RGB48LE;
+}
+
+/* the conversions to and from the intermediate format are scaled apart from
+ * the gamma correct scaling, each stage is threaded on its own */
+static int gamma_cascade_needed(const SwsContext *c)
+{
+    enum AVPixelFormat tmpFmt = gamma_tmp_format(c->srcFormat, c->dstFormat);
+
+    return c->gamma_flag && (c->srcW != c->dstW || c->srcH != c->dstH) &&
+           (c->srcFormat != tmpFmt || c->dstFormat != tmpFmt);
+}
+
+static SwsContext *alloc_gamma_stage(SwsContext *c,
+                                     int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                     int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                     SwsFilter *srcFilter, SwsFilter *dstFilter)
 {
-    int i = 0;
-    uint16_t * tbl;
-    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * 1 << 16);
-    if (!tbl)
+    SwsContext *stage = sws_alloc_set_opts(srcW, srcH, srcFormat,
+                                           dstW, dstH, dstFormat,
+                                           c->flags, c->param);
+    if (!stage)
         return NULL;
 
-    for (i = 0; i < 65536; ++i) {
-        tbl[i] = pow(i / 65535.0, e) * 65535.0;
+    stage->gamma_flag = c->gamma_flag;
+    stage->nb_threads = c->nb_threads;
+    stage->dither     = c->dither;
+    stage->alphablend = c->alphablend;
+    memcpy(stage->norm_mean, c->norm_mean, sizeof(c->norm_mean));
+    memcpy(stage->norm_std,  c->norm_std,  sizeof(c->norm_std));
+
+    if (sws_init_context(stage, srcFilter, dstFilter) < 0) {
+        sws_freeContext(stage);
+        return NULL;
     }
-    return tbl;
+
+    return stage;
 }
 
 static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
@@ -1261,9 +1556,125 @@ static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
     }
 }
 
+/**
+ * Set up the normalization of float outputs from the norm_mean and norm_std
+ * options. The factors apply to the 16-bit values the output functions
+ * convert to float, with the identity being exactly the plain conversion.
+ */
+static av_cold void init_float_norm(SwsContext *c)
+{
+    /* planar RGB is stored as G, B, R, gray uses the R values */
+    static const int rgb_chan[3] = { 1, 2, 0 };
+    const int gray = isGray(c->dstFormat);
+
+    c->float_norm = 0;
+    for (int p = 0; p < 4; p++) {
+        double mean = 0.0, std = 1.0;
+        float mul, add;
+
+        if (p < 3) {
+            const int ch = gray ? 0 : rgb_chan[p];
+            mean = c->norm_mean[ch];
+            std  = c->norm_std[ch];
+        }
+        mul = (1.0f / 65535.0f) * (float)(1.0 / std);
+        add = mean != 0.0 ? (float)(-mean / std) : 0.0f;
+
+        if (mean != 0.0 || std != 1.0)
+            c->float_norm = isFloat(c->dstFormat);
+
+        for (int i = 0; i < 8; i++) {
+            c->float_norm_mul[p][i] = mul;
+            c->float_norm_add[p][i] = add;
+        }
+    }
+}
+
+/* the last stage of a cascade writes the output for the parent */
+static void copy_float_norm(SwsContext *dst, const SwsContext *src)
+{
+    memcpy(dst->float_norm_mul, src->float_norm_mul, sizeof(src->float_norm_mul));
+    memcpy(dst->float_norm_add, src->float_norm_add, sizeof(src->float_norm_add));
+    dst->float_norm = src->float_norm;
+}
+
 static int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                    SwsFilter *dstFilter);
 
+static av_cold int crop_filter(int16_t **filter, int32_t **filterPos,
+                               int filterSize, int start, int w, int src_x)
+{
+    int16_t *new_filter = NULL;
+    int32_t *new_pos    = NULL;
+
+    if (!FF_ALLOC_TYPED_ARRAY(new_pos, w + 3) ||
+        !FF_ALLOC_TYPED_ARRAY(new_filter, filterSize * (w + 3))) {
+        av_free(new_pos);
+        return AVERROR(ENOMEM);
+    }
+
+    /* the last filter is repeated for the SIMD scalers reading over the end,
+     * as initFilter() does */
+    for (int i = 0; i < w + 3; i++) {
+        const int x = start + FFMIN(i, w - 1);
+
+        new_pos[i] = (*filterPos)[x] - src_x;
+        memcpy(new_filter + i * filterSize, *filter + x * filterSize,
+               filterSize * sizeof(*new_filter));
+    }
+
+    av_free(*filter);
+    av_free(*filterPos);
+    *filter    = new_filter;
+    *filterPos = new_pos;
+
+    return 0;
+}
+
+/**
+ * Restrict the horizontal filters of a column tile, built for the whole
+ * width, to its output columns and to the input columns they read.
+ * The coefficients are copied unchanged so that the tile output is
+ * identical to the corresponding columns of an untiled scale.
+ */
+static av_cold int init_tile_filters(SwsContext *c)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const int chr_shift = c->chrSrcHSubSample;
+    const int align     = 1 << FFMAX(chr_shift, desc->log2_chroma_w);
+    const int x0  = c->tile_dst_x;
+    const int x1  = x0 + c->tile_dst_w;
+    const int cx0 = x0 >> c->chrDstHSubSample;
+    const int cx1 = AV_CEIL_RSHIFT(x1, c->chrDstHSubSample);
+    int src_x0 = c->srcW, src_x1 = 0;
+    int ret;
+
+    for (int i = x0; i < x1; i++) {
+        src_x0 = FFMIN(src_x0, c->hLumFilterPos[i]);
+        src_x1 = FFMAX(src_x1, c->hLumFilterPos[i] + c->hLumFilterSize);
+    }
+    for (int i = cx0; i < cx1; i++) {
+        src_x0 = FFMIN(src_x0, c->hChrFilterPos[i] << chr_shift);
+        src_x1 = FFMAX(src_x1, (c->hChrFilterPos[i] + c->hChrFilterSize) << chr_shift);
+    }
+    src_x0 &= ~(align - 1);
+    src_x1  = FFMIN(src_x1, c->srcW);
+
+    if ((ret = crop_filter(&c->hLumFilter, &c->hLumFilterPos, c->hLumFilterSize,
+                           x0, x1 - x0, src_x0)) < 0 ||
+        (ret = crop_filter(&c->hChrFilter, &c->hChrFilterPos, c->hChrFilterSize,
+                           cx0, cx1 - cx0, src_x0 >> chr_shift)) < 0)
+        return ret;
+
+    c->tile_src_x = src_x0;
+    c->srcW       = src_x1 - src_x0;
+    c->dstW       = x1 - x0;
+    c->chrSrcW    = AV_CEIL_RSHIFT(c->srcW, chr_shift);
+    c->chrDstW    = cx1 - cx0;
+
+    return 0;
+}
+
 static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                            SwsFilter *dstFilter)
 {
@@ -1281,6 +1692,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
     const AVPixFmtDescriptor *desc_src;
     const AVPixFmtDescriptor *desc_dst;
     int ret = 0;
+    int shuffle_filters = 0;
     enum AVPixelFormat tmpFmt;
     static const float float_mult = 1.0f / 255.0f;
 
@@ -1301,6 +1713,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
     desc_src = av_pix_fmt_desc_get(srcFormat);
     desc_dst = av_pix_fmt_desc_get(dstFormat);
 
+    init_float_norm(c);
+
     // If the source has no alpha then disable alpha blendaway
     if (c->src0Alpha)
         c->alphablend = SWS_ALPHA_BLEND_NONE;
@@ -1561,63 +1975,49 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
 
     // hardcoded for now
     c->gamma_value = 2.2;
-    tmpFmt = AV_PIX_FMT_RGBA64LE;
-
-
-    if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
-        SwsContext *c2;
-        c->cascaded_context[0] = NULL;
-
-        ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
-                            srcW, srcH, tmpFmt, 64);
-        if (ret < 0)
-            return ret;
-
-        c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
-                                                srcW, srcH, tmpFmt,
-                                                flags, NULL, NULL, c->param);
-        if (!c->cascaded_context[0]) {
-            return AVERROR(ENOMEM);
-        }
-
-        c->cascaded_context[1] = sws_getContext(srcW, srcH, tmpFmt,
-                                                dstW, dstH, tmpFmt,
-                                                flags, srcFilter, dstFilter, c->param);
-
-        if (!c->cascaded_context[1])
-            return AVERROR(ENOMEM);
 
-        c2 = c->cascaded_context[1];
-        c2->is_internal_gamma = 1;
-        c2->gamma     = alloc_gamma_tbl(    c->gamma_value);
-        c2->inv_gamma = alloc_gamma_tbl(1.f/c->gamma_value);
-        if (!c2->gamma || !c2->inv_gamma)
-            return AVERROR(ENOMEM);
+    if (!unscaled && c->gamma_flag) {
+        tmpFmt = gamma_tmp_format(srcFormat, dstFormat);
 
-        // is_internal_flag is set after creating the context
-        // to properly create the gamma convert FilterDescriptor
-        // we have to re-initialize it
-        ff_free_filters(c2);
-        if ((ret = ff_init_filters(c2)) < 0) {
-            sws_freeContext(c2);
-            c->cascaded_context[1] = NULL;
-            return ret;
-        }
-
-        c->cascaded_context[2] = NULL;
-        if (dstFormat != tmpFmt) {
-            ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
-                                dstW, dstH, tmpFmt, 64);
+        if (srcFormat == tmpFmt && dstFormat == tmpFmt) {
+            ret = ff_thread_once(&gamma_tables_once, init_gamma_tables);
+            if (ret)
+                return AVERROR_UNKNOWN;
+            c->is_internal_gamma = 1;
+            c->gamma     = gamma_tables[1];
+            c->inv_gamma = gamma_tables[0];
+        } else {
+            ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
+                                srcW, srcH, tmpFmt, 64);
             if (ret < 0)
                 return ret;
 
-            c->cascaded_context[2] = sws_getContext(dstW, dstH, tmpFmt,
-                                                dstW, dstH, dstFormat,
-                                                flags, NULL, NULL, c->param);
-            if (!c->cascaded_context[2])
+            c->cascaded_context[0] = alloc_gamma_stage(c, srcW, srcH, srcFormat,
+                                                       srcW, srcH, tmpFmt,
+                                                       NULL, NULL);
+            if (!c->cascaded_context[0])
+                return AVERROR(ENOMEM);
+
+            c->cascaded_context[1] = alloc_gamma_stage(c, srcW, srcH, tmpFmt,
+                                                       dstW, dstH, tmpFmt,
+                                                       srcFilter, dstFilter);
+            if (!c->cascaded_context[1])
                 return AVERROR(ENOMEM);
+
+            if (dstFormat != tmpFmt) {
+                ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
+                                    dstW, dstH, tmpFmt, 64);
+                if (ret < 0)
+                    return ret;
+
+                c->cascaded_context[2] = alloc_gamma_stage(c, dstW, dstH, tmpFmt,
+                                                           dstW, dstH, dstFormat,
+                                                           NULL, NULL);
+                if (!c->cascaded_context[2])
+                    return AVERROR(ENOMEM);
+            }
+            return 0;
         }
-        return 0;
     }
 
     if (isBayer(srcFormat)) {
@@ -1642,6 +2042,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                                     flags, NULL, dstFilter, c->param);
             if (!c->cascaded_context[1])
                 return AVERROR(ENOMEM);
+            copy_float_norm(c->cascaded_context[1], c);
             return 0;
         }
     }
@@ -1695,6 +2096,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                 ret = sws_init_context(c->cascaded_context[1], srcFilter , dstFilter);
                 if (ret < 0)
                     return ret;
+                copy_float_norm(c->cascaded_context[1], c);
 
                 return 0;
             }
@@ -1717,8 +2119,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
         return 0;
     }
 
-    /* unscaled special cases */
-    if (unscaled && !usesHFilter && !usesVFilter &&
+    /* unscaled special cases, they do not normalize float outputs */
+    if (unscaled && !usesHFilter && !usesVFilter && !c->float_norm &&
         (c->srcRange == c->dstRange || isAnyRGB(dstFormat) ||
          isFloat(srcFormat) || isFloat(dstFormat))){
         ff_get_unscaled_swscale(c);
@@ -1815,10 +2217,9 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                            cpu_flags, srcFilter->lumH, dstFilter->lumH,
                            c->param,
                            get_local_pos(c, 0, 0, 0),
-                           get_local_pos(c, 0, 0, 0))) < 0)
+                           get_local_pos(c, 0, 0, 0),
+                           &c->filter_ref[0])) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hLumFilterPos, c->hLumFilterSize, c->hLumFilter, dstW) < 0)
-                goto nomem;
             if ((ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
                            &c->hChrFilterSize, c->chrXInc,
                            c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
@@ -1826,10 +2227,10 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                            cpu_flags, srcFilter->chrH, dstFilter->chrH,
                            c->param,
                            get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
-                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0))) < 0)
+                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0),
+                           &c->filter_ref[1])) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hChrFilterPos, c->hChrFilterSize, c->hChrFilter, c->chrDstW) < 0)
-                goto nomem;
+            shuffle_filters = 1;
         }
     } // initialize horizontal stuff
 
@@ -1845,7 +2246,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                        cpu_flags, srcFilter->lumV, dstFilter->lumV,
                        c->param,
                        get_local_pos(c, 0, 0, 1),
-                       get_local_pos(c, 0, 0, 1))) < 0)
+                       get_local_pos(c, 0, 0, 1),
+                       &c->filter_ref[2])) < 0)
             goto fail;
         if ((ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
                        c->chrYInc, c->chrSrcH, c->chrDstH,
@@ -1854,10 +2256,24 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                        cpu_flags, srcFilter->chrV, dstFilter->chrV,
                        c->param,
                        get_local_pos(c, c->chrSrcVSubSample, c->src_v_chr_pos, 1),
-                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1))) < 0)
+                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1),
+                       &c->filter_ref[3])) < 0)
 
             goto fail;
 
+        ff_sws_init_fused(c);
+
+        if (c->tile_dst_w && shuffle_filters) {
+            if ((ret = init_tile_filters(c)) < 0)
+                goto fail;
+        }
+
+        if (shuffle_filters) {
+            if (ff_shuffle_filter_coefficients(c, c->hLumFilterPos, c->hLumFilterSize, c->hLumFilter, c->dstW) < 0 ||
+                ff_shuffle_filter_coefficients(c, c->hChrFilterPos, c->hChrFilterSize, c->hChrFilter, c->chrDstW) < 0)
+                goto nomem;
+        }
+
 #if HAVE_ALTIVEC
         if (!FF_ALLOC_TYPED_ARRAY(c->vYCoeffsBank, c->vLumFilterSize * c->dstH) ||
             !FF_ALLOC_TYPED_ARRAY(c->vCCoeffsBank, c->vChrFilterSize * c->chrDstH))
@@ -1969,6 +2385,7 @@ fail: // FIXME replace things by appropriate error codes
                                                 flags, NULL, dstFilter, c->param);
         if (!c->cascaded_context[1])
             return AVERROR(ENOMEM);
+        copy_float_norm(c->cascaded_context[1], c);
         return 0;
     }
     return ret;
@@ -2023,6 +2440,172 @@ static int context_init_threaded(SwsContext *c,
     return 0;
 }
 
+static int tiling_supported(SwsContext *c)
+{
+    const AVPixFmtDescriptor *desc_src = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *desc_dst = av_pix_fmt_desc_get(c->dstFormat);
+    const int invalid = AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_PAL |
+                        AV_PIX_FMT_FLAG_HWACCEL;
+
+    if (!desc_src || !desc_dst)
+        return 0;
+
+    return !(desc_src->flags & invalid) && !(desc_dst->flags & invalid) &&
+           !isBayer(c->srcFormat) &&
+           c->srcFormat != AV_PIX_FMT_XYZ12LE && c->srcFormat != AV_PIX_FMT_XYZ12BE &&
+           (isPlanarYUV(c->dstFormat) || isSemiPlanarYUV(c->dstFormat) ||
+            (isGray(c->dstFormat) && desc_dst->nb_components == 1)) &&
+           !(c->flags & SWS_FAST_BILINEAR) && !c->gamma_flag &&
+           c->dither != SWS_DITHER_ED;
+}
+
+static void free_slice_ctx(SwsContext *c)
+{
+    for (int i = 0; i < c->nb_slice_ctx; i++)
+        sws_freeContext(c->slice_ctx[i]);
+    av_freep(&c->slice_ctx);
+    av_freep(&c->slice_err);
+    c->nb_slice_ctx = 0;
+}
+
+/**
+ * Split the output into columns of tile_width, each scaled by its own
+ * context over the full height. The line buffers of a tile are only as wide
+ * as the tile, so they stay in cache for very wide images, and the tiles
+ * are the jobs of the slice threads.
+ * If the conversion cannot be tiled, nb_tiles is left at 0.
+ */
+static int context_init_tiled(SwsContext *c,
+                              SwsFilter *src_filter, SwsFilter *dst_filter)
+{
+    /* a multiple of the widest SIMD store also for subsampled chroma,
+     * so that tiles never write into their neighbours */
+    const int tile_w   = FFALIGN(c->tile_width, 256);
+    const int nb_tiles = (c->dstW + tile_w - 1) / tile_w;
+    int ret;
+
+    if (nb_tiles < 2 || !tiling_supported(c))
+        return 0;
+
+    c->slice_ctx = av_calloc(nb_tiles, sizeof(*c->slice_ctx));
+    c->slice_err = av_calloc(nb_tiles, sizeof(*c->slice_err));
+    if (!c->slice_ctx || !c->slice_err)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < nb_tiles; i++) {
+        SwsContext *tile = c->slice_ctx[i] = sws_alloc_context();
+        if (!tile)
+            return AVERROR(ENOMEM);
+        c->nb_slice_ctx++;
+
+        tile->parent = c;
+
+        ret = av_opt_copy((void*)tile, (void*)c);
+        if (ret < 0)
+            return ret;
+
+        tile->nb_threads = 1;
+        tile->tile_dst_x = i * tile_w;
+        tile->tile_dst_w = FFMIN(tile_w, c->dstW - tile->tile_dst_x);
+
+        ret = sws_init_single_context(tile, src_filter, dst_filter);
+        if (ret < 0)
+            return ret;
+
+        /* a special converter was picked instead of the scaler */
+        if (tile->dstW != tile->tile_dst_w) {
+            av_log(c, AV_LOG_VERBOSE, "Conversion cannot be tiled, tile_width ignored.\n");
+            free_slice_ctx(c);
+            return 0;
+        }
+    }
+
+    if (c->nb_threads != 1) {
+        ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
+                                        ff_sws_tile_worker, NULL, c->nb_threads);
+        if (ret == AVERROR(ENOSYS))
+            ret = 1;
+        else if (ret < 0)
+            return ret;
+        c->nb_threads = ret;
+    }
+
+    c->nb_tiles = nb_tiles;
+    av_log(c, AV_LOG_VERBOSE, "Scaling in %d column tiles of width %d.\n",
+           nb_tiles, tile_w);
+
+    return 0;
+}
+
+/**
+ * Scale into the largest centered rectangle of the output with the aspect
+ * ratio of the input, using a context of the size of that rectangle, and
+ * fill the border around it with the normalized letterbox_pad value.
+ * Only float outputs can be letterboxed, otherwise letterbox_ctx is left
+ * at NULL.
+ */
+static av_cold int context_init_letterbox(SwsContext *c,
+                                          SwsFilter *src_filter,
+                                          SwsFilter *dst_filter)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+    SwsContext *inner;
+    int w = c->dstW, h = c->dstH;
+    int ret;
+
+    if (!desc || !isFloat(c->dstFormat) ||
+        (!(desc->flags & AV_PIX_FMT_FLAG_PLANAR) && desc->nb_components > 1)) {
+        av_log(c, AV_LOG_WARNING, "Letterboxing is only supported for planar "
+               "float output formats, ignoring it.\n");
+        return 0;
+    }
+
+    if ((int64_t)c->srcW * c->dstH > (int64_t)c->srcH * c->dstW)
+        h = FFMAX(1, av_rescale(c->dstW, c->srcH, c->srcW));
+    else
+        w = FFMAX(1, av_rescale(c->dstH, c->srcW, c->srcH));
+
+    if (w == c->dstW && h == c->dstH)
+        return 0;
+
+    inner = sws_alloc_context();
+    if (!inner)
+        return AVERROR(ENOMEM);
+    c->letterbox_ctx = inner;
+
+    ret = av_opt_copy(inner, c);
+    if (ret < 0)
+        return ret;
+    inner->dstW      = w;
+    inner->dstH      = h;
+    inner->letterbox = 0;
+
+    ret = sws_init_context(inner, src_filter, dst_filter);
+    if (ret < 0)
+        return ret;
+
+    c->lb_x = (c->dstW - w) / 2;
+    c->lb_y = (c->dstH - h) / 2;
+
+    for (int p = 0; p < 4; p++) {
+        const SwsContext *last = inner->nb_slice_ctx ? inner->slice_ctx[0] : inner;
+        float v = 1.0f;
+
+        /* the alpha plane is padded opaque */
+        if (p < 3)
+            v = (float)(c->letterbox_pad * 65535.0) * last->float_norm_mul[p][0] +
+                last->float_norm_add[p][0];
+        c->lb_fill[p] = av_float2int(v);
+        if (!isBE(c->dstFormat) != !HAVE_BIGENDIAN)
+            c->lb_fill[p] = av_bswap32(c->lb_fill[p]);
+    }
+
+    av_log(c, AV_LOG_VERBOSE, "Letterboxing into %dx%d at %d,%d.\n",
+           w, h, c->lb_x, c->lb_y);
+
+    return 0;
+}
+
 av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                              SwsFilter *dstFilter)
 {
@@ -2030,6 +2613,10 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     enum AVPixelFormat src_format, dst_format;
     int ret;
 
+    c->user_src_format = c->srcFormat;
+    c->user_dst_format = c->dstFormat;
+    c->user_filters    = srcFilter || dstFilter;
+
     c->frame_src = av_frame_alloc();
     c->frame_dst = av_frame_alloc();
     if (!c->frame_src || !c->frame_dst)
@@ -2046,7 +2633,19 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     if (src_format != c->srcFormat || dst_format != c->dstFormat)
         av_log(c, AV_LOG_WARNING, "deprecated pixel format used, make sure you did set range correctly\n");
 
-    if (c->nb_threads != 1) {
+    if (c->letterbox) {
+        ret = context_init_letterbox(c, srcFilter, dstFilter);
+        if (ret < 0 || c->letterbox_ctx)
+            return ret;
+    }
+
+    if (c->tile_width) {
+        ret = context_init_tiled(c, srcFilter, dstFilter);
+        if (ret < 0 || c->nb_tiles)
+            return ret;
+    }
+
+    if (c->nb_threads != 1 && !gamma_cascade_needed(c)) {
         ret = context_init_threaded(c, srcFilter, dstFilter);
         if (ret < 0 || c->nb_threads > 1)
             return ret;
@@ -2102,6 +2701,58 @@ SwsContext *sws_getContext(int srcW, int srcH, enum AVPixelFormat srcFormat,
     return c;
 }
 
+/* put the filters of c and its internal contexts back into the cache */
+static void share_filters(const SwsContext *c)
+{
+    for (int i = 0; i < FF_ARRAY_ELEMS(c->filter_ref); i++)
+        if (c->filter_ref[i])
+            filter_cache_put(c->filter_ref[i]);
+    for (int i = 0; i < c->nb_slice_ctx; i++)
+        share_filters(c->slice_ctx[i]);
+    for (int i = 0; i < FF_ARRAY_ELEMS(c->cascaded_context); i++)
+        if (c->cascaded_context[i])
+            share_filters(c->cascaded_context[i]);
+    if (c->letterbox_ctx)
+        share_filters(c->letterbox_ctx);
+}
+
+SwsContext *sws_clone_context(const SwsContext *src)
+{
+    const SwsContext *cs = src->letterbox_ctx ? src->letterbox_ctx : src;
+    SwsContext *c;
+
+    if (!src->frame_src || src->user_filters)
+        return NULL;
+    if (cs->nb_slice_ctx)
+        cs = cs->slice_ctx[0];
+
+    if (!(c = sws_alloc_context()))
+        return NULL;
+
+    if (av_opt_copy(c, src) < 0)
+        goto fail;
+    c->srcFormat = src->user_src_format;
+    c->dstFormat = src->user_dst_format;
+
+    /* the clone copies the filters of src out of the cache instead of
+     * computing them again, unless they are too large to be cached or
+     * another thread evicts them in between */
+    share_filters(src);
+    if (sws_init_context(c, NULL, NULL) < 0)
+        goto fail;
+
+    if (sws_setColorspaceDetails(c, cs->srcColorspaceTable, cs->srcRange,
+                                 cs->dstColorspaceTable, cs->dstRange,
+                                 cs->brightness, cs->contrast,
+                                 cs->saturation) < 0)
+        goto fail;
+
+    return c;
+fail:
+    sws_freeContext(c);
+    return NULL;
+}
+
 static int isnan_vec(SwsVector *a)
 {
     int i;
@@ -2418,10 +3069,7 @@ void sws_freeContext(SwsContext *c)
     if (!c)
         return;
 
-    for (i = 0; i < c->nb_slice_ctx; i++)
-        sws_freeContext(c->slice_ctx[i]);
-    av_freep(&c->slice_ctx);
-    av_freep(&c->slice_err);
+    free_slice_ctx(c);
 
     avpriv_slicethread_free(&c->slicethread);
 
@@ -2446,6 +3094,8 @@ void sws_freeContext(SwsContext *c)
     av_freep(&c->vChrFilterPos);
     av_freep(&c->hLumFilterPos);
     av_freep(&c->hChrFilterPos);
+    for (i = 0; i < FF_ARRAY_ELEMS(c->filter_ref); i++)
+        av_buffer_unref(&c->filter_ref[i]);
 
 #if HAVE_MMX_INLINE
 #if USE_MMAP
@@ -2473,14 +3123,14 @@ void sws_freeContext(SwsContext *c)
     sws_freeContext(c->cascaded_context[1]);
     sws_freeContext(c->cascaded_context[2]);
     memset(c->cascaded_context, 0, sizeof(c->cascaded_context));
+    sws_freeContext(c->letterbox_ctx);
+    c->letterbox_ctx = NULL;
     av_freep(&c->cascaded_tmp[0]);
     av_freep(&c->cascaded1_tmp[0]);
 
-    av_freep(&c->gamma);
-    av_freep(&c->inv_gamma);
-
     av_freep(&c->rgb0_scratch);
     av_freep(&c->xyz_scratch);
+    av_freep(&c->bayer_scratch);
 
     ff_free_filters(c);
 
@@ -2504,15 +3154,15 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context, int srcW,
         param = default_param;
 
     if (context &&
-        (context->srcW      != srcW      ||
-         context->srcH      != srcH      ||
-         context->srcFormat != srcFormat ||
-         context->dstW      != dstW      ||
-         context->dstH      != dstH      ||
-         context->dstFormat != dstFormat ||
-         context->flags     != flags     ||
-         context->param[0]  != param[0]  ||
-         context->param[1]  != param[1])) {
+        (context->srcW            != srcW      ||
+         context->srcH            != srcH      ||
+         context->user_src_format != srcFormat ||
+         context->dstW            != dstW      ||
+         context->dstH            != dstH      ||
+         context->user_dst_format != dstFormat ||
+         context->flags           != flags     ||
+         context->param[0]        != param[0]  ||
+         context->param[1]        != param[1])) {
 
         av_opt_get_int(context, "src_h_chr_pos", 0, &src_h_chr_pos);
         av_opt_get_int(context, "src_v_chr_pos", 0, &src_v_chr_pos);
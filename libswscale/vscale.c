@@ -17,6 +17,8 @@
  * License along with FFmpeg; if not, write to the Free Software
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
+#include "libavutil/bswap.h"
+#include "libavutil/intfloat.h"
 #include "swscale_internal.h"
 
 typedef struct VScalerContext
@@ -37,6 +39,24 @@ typedef struct VScalerContext
 } VScalerContext;
 
 
+/* gray float output is written as values in [0, 1], normalize it while
+ * the line is still in the cache */
+static void normalize_float_line(SwsContext *c, uint8_t *dst, int dstW)
+{
+    const float mul = c->float_norm_mul[0][0] * 65535.0f;
+    const float add = c->float_norm_add[0][0];
+
+    if (!isBE(c->dstFormat) != !HAVE_BIGENDIAN) {
+        uint32_t *dst32 = (uint32_t *)dst;
+        for (int i = 0; i < dstW; i++)
+            dst32[i] = av_bswap32(av_float2int(av_int2float(av_bswap32(dst32[i])) * mul + add));
+    } else {
+        float *dstf = (float *)dst;
+        for (int i = 0; i < dstW; i++)
+            dstf[i] = dstf[i] * mul + add;
+    }
+}
+
 static int lum_planar_vscale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     VScalerContext *inst = desc->instance;
@@ -54,6 +74,9 @@ static int lum_planar_vscale(SwsContext *c, SwsFilterDescriptor *desc, int slice
     else
         inst->pfn.yuv2planarX(filter, inst->filter_size, (const int16_t**)src, dst[0], dstW, c->lumDither8, 0);
 
+    if (c->float_norm)
+        normalize_float_line(c, dst[0], dstW);
+
     if (desc->alpha) {
         int sp = first - desc->src->plane[3].sliceY;
         int dp = sliceY - desc->dst->plane[3].sliceY;
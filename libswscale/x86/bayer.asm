@@ -0,0 +1,248 @@
+;******************************************************************************
+;* SIMD bayer demosaicing
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+pb_bayer8_1:       times 16 db 1
+pw_bayer16_1:      times  8 dw 1
+
+; green sites of a row starting at an even pixel
+pb_bayer8_even:    times  8 dw 0x00ff
+pb_bayer8_odd:     times  8 dw 0xff00
+pw_bayer16_even:   times  4 dd 0x0000ffff
+pw_bayer16_odd:    times  4 dd 0xffff0000
+
+pb_bayer16_bswap:  db  1,  0,  3,  2,  5,  4,  7,  6,  9,  8, 11, 10, 13, 12, 15, 14
+
+; interleave the R, G and B planes of a block into 48 bytes of RGB24 / RGB48
+pb_bayer8_r0:     db  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5
+pb_bayer8_g0:     db -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1
+pb_bayer8_b0:     db -1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1
+pb_bayer8_r1:     db -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1
+pb_bayer8_g1:     db  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10
+pb_bayer8_b1:     db -1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1
+pb_bayer8_r2:     db -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1
+pb_bayer8_g2:     db -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1
+pb_bayer8_b2:     db 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15
+
+pb_bayer16_r0:    db  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5, -1, -1
+pb_bayer16_g0:    db -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1,  4,  5
+pb_bayer16_b0:    db -1, -1, -1, -1,  0,  1, -1, -1, -1, -1,  2,  3, -1, -1, -1, -1
+pb_bayer16_r1:    db -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1, 10, 11
+pb_bayer16_g1:    db -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1, -1, -1
+pb_bayer16_b1:    db  4,  5, -1, -1, -1, -1,  6,  7, -1, -1, -1, -1,  8,  9, -1, -1
+pb_bayer16_r2:    db -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1, -1, -1
+pb_bayer16_g2:    db 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15, -1, -1
+pb_bayer16_b2:    db -1, -1, 10, 11, -1, -1, -1, -1, 12, 13, -1, -1, -1, -1, 14, 15
+
+SECTION .text
+
+; BAYER_AVG avg, src, parity
+; avg = (avg + src) >> 1, parity = (avg + src) & 1
+%macro BAYER_AVG 3
+    mova              %3, %1
+    pxor              %3, %2
+    pand              %3, m7
+    PAVG              %1, %2
+    PSUB              %1, %3
+%endmacro
+
+; BAYER_AVG4 avg, src, parity, src parity, tmp
+; avg = (a + b + c + d) >> 2, from avg = (a + b) >> 1, src = (c + d) >> 1 and
+; the parities of both sums
+%macro BAYER_AVG4 5
+    pand              %3, %4
+    mova              %5, %1
+    pxor              %5, %2
+    pand              %5, m7
+    pandn             %3, %5
+    PAVG              %1, %2
+    PSUB              %1, %3
+%endmacro
+
+; BAYER_BLEND dst, src, mask
+; dst = mask ? dst : src
+%macro BAYER_BLEND 3
+    pxor              %1, %2
+    pand              %1, %3
+    pxor              %1, %2
+%endmacro
+
+; BAYER_LOAD dst, src
+; load 16 bytes of samples, byte swapped to native order for big endian ones
+%macro BAYER_LOAD 2
+    movu              %1, %2
+%if BSWAP
+    pshufb            %1, [pb_bayer16_bswap]
+%endif
+%endmacro
+
+; BAYER_ROW above, row, below, dst, green sites, red, blue
+; output one row of a block, red and blue are m1 and m2 in either order
+%macro BAYER_ROW 7
+    BAYER_LOAD        m0, [%1 + xq - SIZEOF]
+    BAYER_LOAD        m1, [%1 + xq + SIZEOF]
+    BAYER_AVG         m0, m1, m2
+    BAYER_LOAD        m1, [%3 + xq - SIZEOF]
+    BAYER_LOAD        m3, [%3 + xq + SIZEOF]
+    BAYER_AVG         m1, m3, m4
+    BAYER_AVG4        m0, m1, m2, m4, m3    ; diagonal
+    BAYER_LOAD        m1, [%1 + xq]
+    BAYER_LOAD        m2, [%3 + xq]
+    BAYER_AVG         m1, m2, m3            ; vertical
+    BAYER_LOAD        m2, [%2 + xq - SIZEOF]
+    BAYER_LOAD        m4, [%2 + xq + SIZEOF]
+    BAYER_AVG         m2, m4, m5            ; horizontal
+    mova              m4, m1
+    BAYER_AVG4        m4, m2, m3, m5, m6    ; cross
+    BAYER_LOAD        m3, [%2 + xq]
+    BAYER_BLEND       m2, m3, %5            ; colour of this row
+    BAYER_BLEND       m3, m4, %5            ; green
+    BAYER_BLEND       m1, m0, %5            ; colour of the other row
+
+    mova              m4, %6
+    pshufb            m4, m10
+    mova              m5, m3
+    pshufb            m5, m11
+    por               m4, m5
+    mova              m5, %7
+    pshufb            m5, m12
+    por               m4, m5
+    movu   [%4 + dxq], m4
+    mova              m4, %6
+    pshufb            m4, m13
+    mova              m5, m3
+    pshufb            m5, m14
+    por               m4, m5
+    mova              m5, %7
+    pshufb            m5, m15
+    por               m4, m5
+    movu   [%4 + dxq + 16], m4
+    pshufb            %6, [SHUF_R2]
+    pshufb            m3, [SHUF_G2]
+    pshufb            %7, [SHUF_B2]
+    por               %6, m3
+    por               %6, %7
+    movu   [%4 + dxq + 32], %6
+%endmacro
+
+;------------------------------------------------------------------------------
+; void ff_bayer_<pattern>_to_<rgb>_interpolate_inner(const uint8_t *src,
+;                                                    int src_stride, uint8_t *dst,
+;                                                    int dst_stride, int width)
+;
+; Interpolate the pixels [2, width - 2) of the row pair at src in blocks of
+; 16 bytes per row, width must be even and at least 20. The last block
+; overlaps the previous one. 16-bit samples are output in native order.
+;------------------------------------------------------------------------------
+; %1 pattern, %2 depth, %3 output, %4/%5 green sites/red-ness of the first row,
+; %6/%7 of the second row
+%macro BAYER_INTERPOLATE 7
+cglobal bayer_%1%2_to_%3_interpolate_inner, 5, 11, 16, src, src_stride, dst, dst_stride, w, x, dx, xlast, xend, srcm1, src1
+    movsxdifnidn     src_strideq, src_strided
+    movsxdifnidn     dst_strideq, dst_strided
+    movsxdifnidn              wq, wd
+
+    mov                   srcm1q, srcq
+    sub                   srcm1q, src_strideq
+    lea                    src1q, [srcq + src_strideq]
+    lea              src_strideq, [srcq + src_strideq * 2]
+    add              dst_strideq, dstq
+    DEFINE_ARGS src, src2, dst, dst1, w, x, dx, xlast, xend, srcm1, src1
+
+    lea                    xendq, [wq * SIZEOF - 2 * SIZEOF]
+    lea                   xlastq, [xendq - 16]
+    mov                       xq, 2 * SIZEOF
+
+%if SIZEOF == 1
+    mova                      m7, [pb_bayer8_1]
+    mova                      m8, [pb_bayer8_even]
+    mova                      m9, [pb_bayer8_odd]
+    mova                     m10, [pb_bayer8_r0]
+    mova                     m11, [pb_bayer8_g0]
+    mova                     m12, [pb_bayer8_b0]
+    mova                     m13, [pb_bayer8_r1]
+    mova                     m14, [pb_bayer8_g1]
+    mova                     m15, [pb_bayer8_b1]
+%else
+    mova                      m7, [pw_bayer16_1]
+    mova                      m8, [pw_bayer16_even]
+    mova                      m9, [pw_bayer16_odd]
+    mova                     m10, [pb_bayer16_r0]
+    mova                     m11, [pb_bayer16_g0]
+    mova                     m12, [pb_bayer16_b0]
+    mova                     m13, [pb_bayer16_r1]
+    mova                     m14, [pb_bayer16_g1]
+    mova                     m15, [pb_bayer16_b1]
+%endif
+
+.loop:
+    cmp                       xq, xlastq
+    cmovg                     xq, xlastq
+    lea                      dxq, [xq + xq * 2]
+%if %5
+    BAYER_ROW srcm1q, srcq, src1q, dstq, %4, m2, m1
+%else
+    BAYER_ROW srcm1q, srcq, src1q, dstq, %4, m1, m2
+%endif
+%if %7
+    BAYER_ROW srcq, src1q, src2q, dst1q, %6, m2, m1
+%else
+    BAYER_ROW srcq, src1q, src2q, dst1q, %6, m1, m2
+%endif
+    add                       xq, 16
+    cmp                       xq, xendq
+    jl .loop
+    RET
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM ssse3
+%define BSWAP   0
+%define SIZEOF  1
+%define PAVG    pavgb
+%define PSUB    psubb
+%define SHUF_R2 pb_bayer8_r2
+%define SHUF_G2 pb_bayer8_g2
+%define SHUF_B2 pb_bayer8_b2
+BAYER_INTERPOLATE bggr, 8, rgb24, m9, 0, m8, 1
+BAYER_INTERPOLATE rggb, 8, rgb24, m9, 1, m8, 0
+BAYER_INTERPOLATE gbrg, 8, rgb24, m8, 0, m9, 1
+BAYER_INTERPOLATE grbg, 8, rgb24, m8, 1, m9, 0
+
+%define SIZEOF  2
+%define PAVG    pavgw
+%define PSUB    psubw
+%define SHUF_R2 pb_bayer16_r2
+%define SHUF_G2 pb_bayer16_g2
+%define SHUF_B2 pb_bayer16_b2
+BAYER_INTERPOLATE bggr, 16le, rgb48, m9, 0, m8, 1
+BAYER_INTERPOLATE rggb, 16le, rgb48, m9, 1, m8, 0
+BAYER_INTERPOLATE gbrg, 16le, rgb48, m8, 0, m9, 1
+BAYER_INTERPOLATE grbg, 16le, rgb48, m8, 1, m9, 0
+
+%define BSWAP   1
+BAYER_INTERPOLATE bggr, 16be, rgb48, m9, 0, m8, 1
+BAYER_INTERPOLATE rggb, 16be, rgb48, m9, 1, m8, 0
+BAYER_INTERPOLATE gbrg, 16be, rgb48, m8, 0, m9, 1
+BAYER_INTERPOLATE grbg, 16be, rgb48, m8, 1, m9, 0
+%endif
@@ -118,6 +118,19 @@ pb_shuffle16be:         db  1,  0,  3,  2, \
                             5,  4,  7,  6, \
                             9,  8, 11, 10, \
                            13, 12, 15, 14
+pb_rgb48_to_rg_gb:      db  0,  1,  2,  3,  2,  3,  4,  5, \
+                            6,  7,  8,  9,  8,  9, 10, 11, \
+                            0,  1,  2,  3,  2,  3,  4,  5, \
+                            6,  7,  8,  9,  8,  9, 10, 11
+pb_rgb48_to_rg_gb_hi4:  db  0,  1,  2,  3,  2,  3,  4,  5, \
+                            6,  7,  8,  9,  8,  9, 10, 11, \
+                            4,  5,  6,  7,  6,  7,  8,  9, \
+                           10, 11, 12, 13, 12, 13, 14, 15
+pd_permd_uv_half:       dd  0, 4, 1, 5, 2, 6, 3, 7
+pd_65535:               times 8 dd 65535
+pd_1:                   times 8 dd 1
+pd_rgb16_y_offset:      times 8 dd 0x2001 << 14
+pd_rgb16_uv_offset:     times 8 dd 0x10001 << 14
 SECTION .text
 
 ;-----------------------------------------------------------------------------
@@ -134,8 +147,8 @@ SECTION .text
 %macro RGB24_TO_Y_FN 2-3
 cglobal %2 %+ 24ToY, 6, 6, %1, dst, src, u1, u2, w, table
 %if ARCH_X86_64
-    mova           m8, [%2_Ycoeff_12x4]
-    mova           m9, [%2_Ycoeff_3x56]
+    VBROADCASTI128 m8, [%2_Ycoeff_12x4]
+    VBROADCASTI128 m9, [%2_Ycoeff_3x56]
 %define coeff1 m8
 %define coeff2 m9
 %else ; x86-32
@@ -147,10 +160,10 @@ cglobal %2 %+ 24ToY, 6, 6, %1, dst, src, u1, u2, w, table
 %else ; ARCH_X86_64 && %0 == 3
 .body:
 %if cpuflag(ssse3)
-    mova           m7, [shuf_rgb_12x4]
+    VBROADCASTI128 m7, [shuf_rgb_12x4]
 %define shuf_rgb1 m7
 %if ARCH_X86_64
-    mova          m10, [shuf_rgb_3x56]
+    VBROADCASTI128 m10, [shuf_rgb_3x56]
 %define shuf_rgb2 m10
 %else ; x86-32
 %define shuf_rgb2 [shuf_rgb_3x56]
@@ -165,9 +178,18 @@ cglobal %2 %+ 24ToY, 6, 6, %1, dst, src, u1, u2, w, table
 %if notcpuflag(ssse3)
     pxor           m7, m7
 %endif ; !cpuflag(ssse3)
-    mova           m4, [rgb_Yrnd]
+    VBROADCASTI128 m4, [rgb_Yrnd]
 .loop:
-%if cpuflag(ssse3)
+%if mmsize == 32
+    movu          xm0, [srcq+0]           ; (byte) { Bx, Gx, Rx }[0-3]
+    movu          xm2, [srcq+12]          ; (byte) { Bx, Gx, Rx }[4-7]
+    vinserti128    m0, m0, [srcq+24], 1   ; (byte) { Bx, Gx, Rx }[8-11]
+    vinserti128    m2, m2, [srcq+36], 1   ; (byte) { Bx, Gx, Rx }[12-15]
+    pshufb         m1, m0, shuf_rgb2      ; (word) { R0, B1, G1, R1, R2, B3, G3, R3 }
+    pshufb         m0, shuf_rgb1          ; (word) { B0, G0, R0, B1, B2, G2, R2, B3 }
+    pshufb         m3, m2, shuf_rgb2      ; (word) { R4, B5, G5, R5, R6, B7, G7, R7 }
+    pshufb         m2, shuf_rgb1          ; (word) { B4, G4, R4, B5, B6, G6, R6, B7 }
+%elif cpuflag(ssse3)
     movu           m0, [srcq+0]           ; (byte) { Bx, Gx, Rx }[0-3]
     movu           m2, [srcq+12]          ; (byte) { Bx, Gx, Rx }[4-7]
     pshufb         m1, m0, shuf_rgb2      ; (word) { R0, B1, G1, R1, R2, B3, G3, R3 }
@@ -204,9 +226,25 @@ cglobal %2 %+ 24ToY, 6, 6, %1, dst, src, u1, u2, w, table
     psrad          m0, 9
     psrad          m2, 9
     packssdw       m0, m2                 ; (word) { Y[0-7] }
+%if mmsize == 32
+    movu    [dstq+wq], m0
+    add            wq, mmsize
+    jge .end
+    cmp            wq, -mmsize
+    jle .loop
+    ; less than a full vector left, redo the end of the previous one
+    lea           u1q, [wq+wq*2]
+    sar           u1q, 1                  ; -3 * pixels left
+    sub          srcq, u1q
+    sub          srcq, 3 * mmsize / 2
+    mov            wq, -mmsize
+    jmp .loop
+.end:
+%else
     mova    [dstq+wq], m0
     add            wq, mmsize
     jl .loop
+%endif
     RET
 %endif ; ARCH_X86_64 && %0 == 3
 %endmacro
@@ -216,10 +254,10 @@ cglobal %2 %+ 24ToY, 6, 6, %1, dst, src, u1, u2, w, table
 %macro RGB24_TO_UV_FN 2-3
 cglobal %2 %+ 24ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
 %if ARCH_X86_64
-    mova           m8, [%2_Ucoeff_12x4]
-    mova           m9, [%2_Ucoeff_3x56]
-    mova          m10, [%2_Vcoeff_12x4]
-    mova          m11, [%2_Vcoeff_3x56]
+    VBROADCASTI128 m8, [%2_Ucoeff_12x4]
+    VBROADCASTI128 m9, [%2_Ucoeff_3x56]
+    VBROADCASTI128 m10, [%2_Vcoeff_12x4]
+    VBROADCASTI128 m11, [%2_Vcoeff_3x56]
 %define coeffU1 m8
 %define coeffU2 m9
 %define coeffV1 m10
@@ -235,10 +273,10 @@ cglobal %2 %+ 24ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
 %else ; ARCH_X86_64 && %0 == 3
 .body:
 %if cpuflag(ssse3)
-    mova           m7, [shuf_rgb_12x4]
+    VBROADCASTI128 m7, [shuf_rgb_12x4]
 %define shuf_rgb1 m7
 %if ARCH_X86_64
-    mova          m12, [shuf_rgb_3x56]
+    VBROADCASTI128 m12, [shuf_rgb_3x56]
 %define shuf_rgb2 m12
 %else ; x86-32
 %define shuf_rgb2 [shuf_rgb_3x56]
@@ -253,12 +291,19 @@ cglobal %2 %+ 24ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
     add         dstUq, wq
     add         dstVq, wq
     neg            wq
-    mova           m6, [rgb_UVrnd]
+    VBROADCASTI128 m6, [rgb_UVrnd]
 %if notcpuflag(ssse3)
     pxor           m7, m7
 %endif
 .loop:
-%if cpuflag(ssse3)
+%if mmsize == 32
+    movu          xm0, [srcq+0]           ; (byte) { Bx, Gx, Rx }[0-3]
+    movu          xm4, [srcq+12]          ; (byte) { Bx, Gx, Rx }[4-7]
+    vinserti128    m0, m0, [srcq+24], 1   ; (byte) { Bx, Gx, Rx }[8-11]
+    vinserti128    m4, m4, [srcq+36], 1   ; (byte) { Bx, Gx, Rx }[12-15]
+    pshufb         m1, m0, shuf_rgb2      ; (word) { R0, B1, G1, R1, R2, B3, G3, R3 }
+    pshufb         m0, shuf_rgb1          ; (word) { B0, G0, R0, B1, B2, G2, R2, B3 }
+%elif cpuflag(ssse3)
     movu           m0, [srcq+0]           ; (byte) { Bx, Gx, Rx }[0-3]
     movu           m4, [srcq+12]          ; (byte) { Bx, Gx, Rx }[4-7]
     pshufb         m1, m0, shuf_rgb2      ; (word) { R0, B1, G1, R1, R2, B3, G3, R3 }
@@ -309,10 +354,27 @@ cglobal %2 %+ 24ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
     psrad          m4, 9
     packssdw       m0, m1                 ; (word) { U[0-7] }
     packssdw       m2, m4                 ; (word) { V[0-7] }
+%if mmsize == 32
+    movu   [dstUq+wq], m0
+    movu   [dstVq+wq], m2
+    add            wq, mmsize
+    jge .end
+    cmp            wq, -mmsize
+    jle .loop
+    ; less than a full vector left, redo the end of the previous one
+    lea           u1q, [wq+wq*2]
+    sar           u1q, 1                  ; -3 * pixels left
+    sub          srcq, u1q
+    sub          srcq, 3 * mmsize / 2
+    mov            wq, -mmsize
+    jmp .loop
+.end:
+%else
     mova   [dstUq+wq], m0
     mova   [dstVq+wq], m2
     add            wq, mmsize
     jl .loop
+%endif
     RET
 %endif ; ARCH_X86_64 && %0 == 3
 %endmacro
@@ -337,12 +399,17 @@ INIT_XMM avx
 RGB24_FUNCS 11, 13
 %endif
 
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RGB24_FUNCS 11, 13
+%endif
+
 ; %1 = nr. of XMM registers
 ; %2-5 = rgba, bgra, argb or abgr (in individual characters)
 %macro RGB32_TO_Y_FN 5-6
 cglobal %2%3%4%5 %+ ToY, 6, 6, %1, dst, src, u1, u2, w, table
-    mova           m5, [rgba_Ycoeff_%2%4]
-    mova           m6, [rgba_Ycoeff_%3%5]
+    VBROADCASTI128 m5, [rgba_Ycoeff_%2%4]
+    VBROADCASTI128 m6, [rgba_Ycoeff_%3%5]
 %if %0 == 6
     jmp mangle(private_prefix %+ _ %+ %6 %+ ToY %+ SUFFIX).body
 %else ; %0 == 6
@@ -355,7 +422,7 @@ cglobal %2%3%4%5 %+ ToY, 6, 6, %1, dst, src, u1, u2, w, table
     lea          srcq, [srcq+wq*2]
     add          dstq, wq
     neg            wq
-    mova           m4, [rgb_Yrnd]
+    VBROADCASTI128 m4, [rgb_Yrnd]
     pcmpeqb        m7, m7
     psrlw          m7, 8                  ; (word) { 0x00ff } x4
 .loop:
@@ -374,7 +441,12 @@ cglobal %2%3%4%5 %+ ToY, 6, 6, %1, dst, src, u1, u2, w, table
     psrad          m0, 9
     psrad          m2, 9
     packssdw       m0, m2                 ; (word) { Y[0-7] }
+%if mmsize == 32
+    vpermq         m0, m0, q3120
+    movu    [dstq+wq], m0
+%else
     mova    [dstq+wq], m0
+%endif
     add            wq, mmsize
     jl .loop
     sub            wq, mmsize - 1
@@ -382,7 +454,7 @@ cglobal %2%3%4%5 %+ ToY, 6, 6, %1, dst, src, u1, u2, w, table
     add            srcq, 2*mmsize - 2
     add            dstq, mmsize - 1
 .loop2:
-    movd           m0, [srcq+wq*2+0]      ; (byte) { Bx, Gx, Rx, xx }[0-3]
+    movd          xm0, [srcq+wq*2+0]      ; (byte) { Bx, Gx, Rx, xx }[0-3]
     DEINTB          1,  0,  3,  2,  7     ; (word) { Gx, xx (m0/m2) or Bx, Rx (m1/m3) }[0-3]/[4-7]
     pmaddwd        m1, m5                 ; (dword) { Bx*BY + Rx*RY }[0-3]
     pmaddwd        m0, m6                 ; (dword) { Gx*GY }[0-3]
@@ -390,7 +462,7 @@ cglobal %2%3%4%5 %+ ToY, 6, 6, %1, dst, src, u1, u2, w, table
     paddd          m0, m1                 ; (dword) { Y[0-3] }
     psrad          m0, 9
     packssdw       m0, m0                 ; (word) { Y[0-7] }
-    movd    [dstq+wq], m0
+    movd    [dstq+wq], xm0
     add            wq, 2
     jl .loop2
 .end:
@@ -403,10 +475,10 @@ cglobal %2%3%4%5 %+ ToY, 6, 6, %1, dst, src, u1, u2, w, table
 %macro RGB32_TO_UV_FN 5-6
 cglobal %2%3%4%5 %+ ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
 %if ARCH_X86_64
-    mova           m8, [rgba_Ucoeff_%2%4]
-    mova           m9, [rgba_Ucoeff_%3%5]
-    mova          m10, [rgba_Vcoeff_%2%4]
-    mova          m11, [rgba_Vcoeff_%3%5]
+    VBROADCASTI128 m8, [rgba_Ucoeff_%2%4]
+    VBROADCASTI128 m9, [rgba_Ucoeff_%3%5]
+    VBROADCASTI128 m10, [rgba_Vcoeff_%2%4]
+    VBROADCASTI128 m11, [rgba_Vcoeff_%3%5]
 %define coeffU1 m8
 %define coeffU2 m9
 %define coeffV1 m10
@@ -434,7 +506,7 @@ cglobal %2%3%4%5 %+ ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
     neg            wq
     pcmpeqb        m7, m7
     psrlw          m7, 8                  ; (word) { 0x00ff } x4
-    mova           m6, [rgb_UVrnd]
+    VBROADCASTI128 m6, [rgb_UVrnd]
 .loop:
     ; FIXME check alignment and use mova
     movu           m0, [srcq+wq*2+0]      ; (byte) { Bx, Gx, Rx, xx }[0-3]
@@ -462,8 +534,15 @@ cglobal %2%3%4%5 %+ ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
     psrad          m1, 9
     packssdw       m0, m4                 ; (word) { U[0-7] }
     packssdw       m2, m1                 ; (word) { V[0-7] }
+%if mmsize == 32
+    vpermq         m0, m0, q3120
+    vpermq         m2, m2, q3120
+    movu   [dstUq+wq], m0
+    movu   [dstVq+wq], m2
+%else
     mova   [dstUq+wq], m0
     mova   [dstVq+wq], m2
+%endif
     add            wq, mmsize
     jl .loop
     sub            wq, mmsize - 1
@@ -472,7 +551,7 @@ cglobal %2%3%4%5 %+ ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
     add            dstUq, mmsize - 1
     add            dstVq, mmsize - 1
 .loop2:
-    movd           m0, [srcq+wq*2]        ; (byte) { Bx, Gx, Rx, xx }[0-3]
+    movd          xm0, [srcq+wq*2]        ; (byte) { Bx, Gx, Rx, xx }[0-3]
     DEINTB          1,  0,  5,  4,  7     ; (word) { Gx, xx (m0/m4) or Bx, Rx (m1/m5) }[0-3]/[4-7]
     pmaddwd        m3, m1, coeffV1        ; (dword) { Bx*BV + Rx*RV }[0-3]
     pmaddwd        m2, m0, coeffV2        ; (dword) { Gx*GV }[0-3]
@@ -486,8 +565,8 @@ cglobal %2%3%4%5 %+ ToUV, 7, 7, %1, dstU, dstV, u1, src, u2, w, table
     psrad          m2, 9
     packssdw       m0, m0                 ; (word) { U[0-7] }
     packssdw       m2, m2                 ; (word) { V[0-7] }
-    movd   [dstUq+wq], m0
-    movd   [dstVq+wq], m2
+    movd   [dstUq+wq], xm0
+    movd   [dstVq+wq], xm2
     add            wq, 2
     jl .loop2
 .end:
@@ -517,6 +596,11 @@ INIT_XMM avx
 RGB32_FUNCS 8, 12
 %endif
 
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RGB32_FUNCS 8, 12
+%endif
+
 ;-----------------------------------------------------------------------------
 ; YUYV/UYVY/NV12/NV21 packed pixel shuffling.
 ;
@@ -1157,4 +1241,213 @@ planar_rgb_uv_all_fn_decl
 planar_rgb_a_all_fn_decl
 %endif
 
+;-----------------------------------------------------------------------------
+; Linearizing RGB48LE/RGBA64LE readers of the gamma correct scaler, see
+; rgb16_linearToY_c_template() in input.c.
+;
+; void <fmt>_linearToY(uint8_t *dst, const uint8_t *src, const uint8_t *unused0,
+;                      const uint8_t *unused1, int w, uint32_t *rgb2yuv,
+;                      void *lut)
+; void <fmt>_linearToUV[_half](uint8_t *dstU, uint8_t *dstV,
+;                              const uint8_t *unused0, const uint8_t *src1,
+;                              const uint8_t *src2, int w, uint32_t *rgb2yuv,
+;                              void *lut)
+;
+; The samples are looked up with dword gathers, so the lut must be readable
+; one entry past its end. w must be at least 8, the end of the line is done
+; by redoing the last 8 pixels.
+;-----------------------------------------------------------------------------
+
+; %1 dst, %2 index
+%macro LUT16 2
+    pcmpeqd         m3, m3
+    vpgatherdd      %1, [lutq + %2 * 2], m3
+    pand            %1, [pd_65535]
+%endmacro
+
+; %1 words per pixel, %2-%4 linear r, g and b of 8 pixels, %5 offset from sptrq
+; clobbers m0-m3
+%macro LOAD_LINEAR_RGB 5
+    movu           xm0, [sptrq + %5]
+    vinserti128     m0, m0, [sptrq + %5 + 8 * %1], 1       ; pixels 0 1 | 4 5
+    movu           xm1, [sptrq + %5 + 4 * %1]
+%if %1 == 3
+    vinserti128     m1, m1, [sptrq + %5 + 32], 1           ; pixels 2 3 | 6 7, do not read past pixel 7
+    pshufb          m0, [pb_rgb48_to_rg_gb]
+    pshufb          m1, [pb_rgb48_to_rg_gb_hi4]
+%else
+    vinserti128     m1, m1, [sptrq + %5 + 48], 1           ; pixels 2 3 | 6 7
+%endif
+    shufps          m2, m0, m1, q3131                      ; b | a << 16, or g | b << 16
+    shufps          m0, m0, m1, q2020                      ; r | g << 16
+    psrld           m1, m0, 16
+%if %1 == 4
+    pand            m2, [pd_65535]
+%else
+    psrld           m2, 16
+%endif
+    pand            m0, [pd_65535]
+    LUT16           %2, m0
+    LUT16           %3, m1
+    LUT16           %4, m2
+%endmacro
+
+; %1 words per pixel, %2 pixels read per output
+%macro LINEAR_SRC_PTR 2
+%if 2 * %1 * %2 == 8
+    lea          sptrq, [srcq + xq * 8]
+%elif 2 * %1 * %2 == 6
+    lea          sptrq, [xq + xq * 2]
+    lea          sptrq, [srcq + sptrq * 2]
+%elif 2 * %1 * %2 == 12
+    lea          sptrq, [xq + xq * 2]
+    lea          sptrq, [srcq + sptrq * 4]
+%else
+    mov          sptrq, xq
+    shl          sptrq, 4
+    add          sptrq, srcq
+%endif
+%endmacro
+
+; after storing the 8 pixels at x, advance x or redo the end of the line
+%macro LINEAR_LOOP_END 0
+    cmp             xq, wq
+    jge .end
+    add             xq, 8
+    cmp             xq, wq
+    jle .loop
+    mov             xq, wq
+    jmp .loop
+.end:
+    RET
+%endmacro
+
+; %1 format, %2 words per pixel
+%macro RGB16_LINEAR_TO_Y_FN 2
+cglobal %1_linearToY, 7, 9, 11, dst, src, u0, u1, w, rgb2yuv, lut, x, sptr
+    VBROADCASTSS    m8, [rgb2yuvq + RY_IDX*4]
+    VBROADCASTSS    m9, [rgb2yuvq + GY_IDX*4]
+    VBROADCASTSS   m10, [rgb2yuvq + BY_IDX*4]
+    movsxdifnidn    wq, wd
+    sub             wq, 8
+    xor             xq, xq
+.loop:
+    LINEAR_SRC_PTR  %2, 1
+    LOAD_LINEAR_RGB %2, m4, m5, m6, 0
+    pmulld          m4, m8
+    pmulld          m5, m9
+    pmulld          m6, m10
+    paddd           m4, m5
+    paddd           m4, m6
+    paddd           m4, [pd_rgb16_y_offset]
+    psrld           m4, RGB2YUV_SHIFT
+    pand            m4, [pd_65535]                         ; the C code stores to uint16_t
+    vextracti128   xm5, m4, 1
+    packusdw       xm4, xm5
+    movu [dstq + xq * 2], xm4
+    LINEAR_LOOP_END
+%endmacro
+
+; %1 format, %2 words per pixel, %3 pixels read per output
+%macro RGB16_LINEAR_TO_UV_FN 3
+%if %3 == 2
+cglobal %1_linearToUV_half, 8, 10, 16, dstU, dstV, u0, src, u1, w, rgb2yuv, lut, x, sptr
+%else
+cglobal %1_linearToUV, 8, 10, 14, dstU, dstV, u0, src, u1, w, rgb2yuv, lut, x, sptr
+%endif
+    VBROADCASTSS    m8, [rgb2yuvq + RU_IDX*4]
+    VBROADCASTSS    m9, [rgb2yuvq + GU_IDX*4]
+    VBROADCASTSS   m10, [rgb2yuvq + BU_IDX*4]
+    VBROADCASTSS   m11, [rgb2yuvq + RV_IDX*4]
+    VBROADCASTSS   m12, [rgb2yuvq + GV_IDX*4]
+    VBROADCASTSS   m13, [rgb2yuvq + BV_IDX*4]
+    movsxdifnidn    wq, wd
+    sub             wq, 8
+    xor             xq, xq
+.loop:
+    LINEAR_SRC_PTR  %2, %3
+    LOAD_LINEAR_RGB %2, m4, m5, m6, 0
+%if %3 == 2
+    LOAD_LINEAR_RGB %2, m7, m14, m15, 16 * %2
+    phaddd          m4, m7                                 ; pixel pairs 0 1 4 5 | 2 3 6 7
+    phaddd          m5, m14
+    phaddd          m6, m15
+    paddd           m4, [pd_1]
+    paddd           m5, [pd_1]
+    paddd           m6, [pd_1]
+    psrld           m4, 1
+    psrld           m5, 1
+    psrld           m6, 1
+%endif
+    pmulld          m0, m4, m8
+    pmulld          m1, m5, m9
+    pmulld          m2, m6, m10
+    paddd           m0, m1
+    paddd           m0, m2
+    pmulld          m4, m11
+    pmulld          m5, m12
+    pmulld          m6, m13
+    paddd           m4, m5
+    paddd           m4, m6
+    paddd           m0, [pd_rgb16_uv_offset]
+    paddd           m4, [pd_rgb16_uv_offset]
+    psrld           m0, RGB2YUV_SHIFT
+    psrld           m4, RGB2YUV_SHIFT
+    pand            m0, [pd_65535]
+    pand            m4, [pd_65535]
+    packusdw        m0, m4
+%if %3 == 2
+    movu            m1, [pd_permd_uv_half]
+    vpermd          m0, m1, m0
+%else
+    vpermq          m0, m0, q3120
+%endif
+    movu [dstUq + xq * 2], xm0
+    vextracti128 [dstVq + xq * 2], m0, 1
+    LINEAR_LOOP_END
+%endmacro
+
+;-----------------------------------------------------------------------------
+; Gamma correction of the vertical scaler output, see gamma_convert().
+;
+; void <fmt>_gamma(uint16_t *line, const uint16_t *lut, int w)
+;
+; w must be a multiple of 16, the lut is padded like for the readers.
+;-----------------------------------------------------------------------------
+
+; %1 format, %2 words per pixel
+%macro RGB16_GAMMA_FN 2
+cglobal %1_gamma, 3, 3, 6, line, lut, w
+    imul            wd, wd, 2 * %2
+    movsxdifnidn    wq, wd
+    add          lineq, wq
+    neg             wq
+.loop:
+    vpmovzxwd       m1, [lineq + wq]
+    vpmovzxwd       m2, [lineq + wq + mmsize / 2]
+    LUT16           m4, m1
+    LUT16           m5, m2
+    packusdw        m4, m5
+    vpermq          m4, m4, q3120
+%if %2 == 4
+    vpblendw        m4, m4, [lineq + wq], 0x88             ; keep alpha
+%endif
+    movu [lineq + wq], m4
+    add             wq, mmsize
+    jl .loop
+    RET
+%endmacro
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+RGB16_GAMMA_FN rgb48le,  3
+RGB16_GAMMA_FN rgba64le, 4
+RGB16_LINEAR_TO_Y_FN  rgb48le,  3
+RGB16_LINEAR_TO_UV_FN rgb48le,  3, 1
+RGB16_LINEAR_TO_UV_FN rgb48le,  3, 2
+RGB16_LINEAR_TO_Y_FN  rgba64le, 4
+RGB16_LINEAR_TO_UV_FN rgba64le, 4, 1
+RGB16_LINEAR_TO_UV_FN rgba64le, 4, 2
+%endif
+
 %endif ; ARCH_X86_64
@@ -29,8 +29,13 @@ minshort:      times 8 dw 0x8000
 yuv2yuvX_16_start:  times 4 dd 0x4000 - 0x40000000
 yuv2yuvX_10_start:  times 4 dd 0x10000
 yuv2yuvX_9_start:   times 4 dd 0x20000
+yuv2yuvX_12_start:  times 4 dd 0x4000
+yuv2yuvX_14_start:  times 4 dd 0x1000
 yuv2yuvX_10_upper:  times 8 dw 0x3ff
 yuv2yuvX_9_upper:   times 8 dw 0x1ff
+yuv2yuvX_12_upper:  times 8 dw 0xfff
+yuv2yuvX_14_upper:  times 8 dw 0x3fff
+yuv2yuvX_16_perm:   dq 0, 2, 4, 6, 1, 3, 5, 7
 pd_4:          times 4 dd 4
 pd_4min0x40000:times 4 dd 4 - (0x40000)
 pw_16:         times 8 dw 16
@@ -38,7 +43,6 @@ pw_32:         times 8 dw 32
 pd_255:        times 8 dd 255
 pw_512:        times 8 dw 512
 pw_1024:       times 8 dw 1024
-pd_65535_invf:             times 8 dd 0x37800080 ;1.0/65535.0
 pd_yuv2gbrp16_start:       times 8 dd -0x40000000
 pd_yuv2gbrp_y_start:       times 8 dd  (1 << 9)
 pd_yuv2gbrp_uv_start:      times 8 dd  ((1 << 9) - (128 << 19))
@@ -337,6 +341,182 @@ yuv2planeX_fn  9,  7, 5
 yuv2planeX_fn 10,  7, 5
 %endif
 
+; AVX2/AVX-512 versions, x86-64 only. They handle any $dstW without writing
+; past the end of the line: the last partial vector is spilled to the stack
+; and copied out pixel by pixel. $src lines are read up to mmsize/2 - 1 pixels
+; past $dstW, which stays within the padding of the scaler's line buffers.
+%macro yuv2planeX_wide_fn 1
+%if %1 == 8
+%assign %%bps 1
+%if mmsize == 64
+%define %%out ym2
+%else
+%define %%out xm2
+%endif
+%else
+%assign %%bps 2
+%define %%out m2
+%endif
+
+cglobal yuv2planeX_%1, 7, 10, 9, mmsize, filter, fltsize, src, dst, w, dither, offset, x, j, line
+    movsxdifnidn fltsizeq, fltsized
+    movsxdifnidn     wq, wd
+    test             wq, wq
+    jle .end
+
+%if %1 == 8
+    ; dither covers 8 pixels and repeats in every 128-bit lane, lo holds
+    ; pixels 0-3 of each lane and hi pixels 4-7 after punpck[lh]wd
+    movq            xm7, [ditherq]
+    test        offsetd, offsetd
+    jz .no_rot
+    punpcklqdq      xm7, xm7
+    psrldq          xm7, 3
+.no_rot:
+    pmovzxbd        xm6, xm7
+    psrldq          xm7, 4
+    pmovzxbd        xm7, xm7
+    pslld           xm6, 12
+    pslld           xm7, 12
+%if mmsize == 64
+    vshufi32x4       m6, m6, m6, 0
+    vshufi32x4       m7, m7, m7, 0
+%else
+    vinserti128      m6, m6, xm6, 1
+    vinserti128      m7, m7, xm7, 1
+%endif
+%else ; %1 == 9/10/12/14/16
+    vpbroadcastd     m6, [yuv2yuvX_%1_start]
+%if %1 == 16
+    vpbroadcastd     m7, [minshort]
+%if mmsize == 64
+    movu             m8, [yuv2yuvX_16_perm]
+%endif
+%else
+    vpbroadcastd     m7, [yuv2yuvX_%1_upper]
+%endif
+%endif ; %1 == 8/9/10/12/14/16
+    xor              xq, xq
+
+.pixelloop:
+    mova             m2, m6
+%if %1 == 8
+    mova             m3, m7
+%else
+    mova             m3, m6
+%endif
+    xor              jq, jq
+.filterloop:
+    vpbroadcastd     m0, [filterq+jq*2]      ; coeff[j], coeff[j+1]
+    mov           lineq, [srcq+jq*gprsize]
+%if %1 == 16
+    pslld            m1, m0, 16
+    psrad            m1, 16                  ; coeff[j]
+    psrad            m0, 16                  ; coeff[j+1]
+    pmulld           m4, m1, [lineq+xq*4]
+    pmulld           m5, m1, [lineq+xq*4+mmsize]
+    mov           lineq, [srcq+jq*gprsize+gprsize]
+    paddd            m2, m4
+    paddd            m3, m5
+    pmulld           m4, m0, [lineq+xq*4]
+    pmulld           m5, m0, [lineq+xq*4+mmsize]
+    paddd            m2, m4
+    paddd            m3, m5
+%else ; %1 == 8/9/10/12/14
+    movu             m4, [lineq+xq*2]
+    mov           lineq, [srcq+jq*gprsize+gprsize]
+    movu             m5, [lineq+xq*2]
+    punpcklwd        m1, m4, m5
+    punpckhwd        m4, m5
+    pmaddwd          m1, m0
+    pmaddwd          m4, m0
+    paddd            m2, m1
+    paddd            m3, m4
+%endif
+    add              jq, 2
+    cmp              jq, fltsizeq
+    jl .filterloop
+
+%if %1 == 8
+    psrad            m2, 19
+    psrad            m3, 19
+    packssdw         m2, m3
+%if mmsize == 64
+    pxor             m1, m1
+    pmaxsw           m2, m1
+    vpmovuswb       ym2, m2
+%else
+    vextracti128    xm1, m2, 1
+    packuswb        xm2, xm1
+%endif
+%elif %1 == 16
+    psrad            m2, 15
+    psrad            m3, 15
+    packssdw         m2, m3
+%if mmsize == 64
+    vpermq           m2, m8, m2
+%else
+    vpermq           m2, m2, q3120
+%endif
+    paddw            m2, m7
+%else ; %1 == 9/10/12/14
+    psrad            m2, 27 - %1
+    psrad            m3, 27 - %1
+    packusdw         m2, m3
+    pminuw           m2, m7
+%endif
+
+    mov              jq, wq
+    sub              jq, xq
+    cmp              jq, mmsize/2
+    jl .tail
+    movu [dstq+xq*%%bps], %%out
+    add              xq, mmsize/2
+    cmp              xq, wq
+    jl .pixelloop
+.end:
+    RET
+
+.tail:
+    mova         [rsp], %%out
+    lea            dstq, [dstq+xq*%%bps]
+    xor              xq, xq
+.tailloop:
+%if %1 == 8
+    mov          lineb, [rsp+xq]
+    mov      [dstq+xq], lineb
+%else
+    mov          linew, [rsp+xq*2]
+    mov    [dstq+xq*2], linew
+%endif
+    inc              xq
+    cmp              xq, jq
+    jl .tailloop
+    RET
+%endmacro
+
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2planeX_wide_fn  8
+yuv2planeX_wide_fn  9
+yuv2planeX_wide_fn 10
+yuv2planeX_wide_fn 12
+yuv2planeX_wide_fn 14
+yuv2planeX_wide_fn 16
+%endif
+
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+yuv2planeX_wide_fn  8
+yuv2planeX_wide_fn  9
+yuv2planeX_wide_fn 10
+yuv2planeX_wide_fn 12
+yuv2planeX_wide_fn 14
+yuv2planeX_wide_fn 16
+%endif
+%endif
+
 ; %1=outout-bpc, %2=alignment (u/a)
 %macro yuv2plane1_mainloop 2
 .loop_%2:
@@ -589,6 +769,9 @@ struc SwsContext
     .yuv2rgb_v2g_coeff: resd 1
     .yuv2rgb_u2g_coeff: resd 1
     .yuv2rgb_u2b_coeff: resd 1
+    .padding1:          resb 4
+    .float_norm_mul:    resd 4*8   ; offsetof(SwsContext, float_norm_mul) == 40320
+    .float_norm_add:    resd 4*8
 endstruc
 
 %define R m0
@@ -794,7 +977,12 @@ endstruc
     %define A_CLIP2P 27
 %endif
 
+%if FLOAT
+cglobal yuv2%1_full_X, 12, 15, 16, ptr, lumFilter, lumSrcx, lumFilterSize, chrFilter, chrUSrcx, chrVSrcx, chrFilterSize, alpSrcx, dest, dstW, y, x, j, norm
+    lea normq, [ptrq + SwsContext.float_norm_mul]
+%else
 cglobal yuv2%1_full_X, 12, 14, 16, ptr, lumFilter, lumSrcx, lumFilterSize, chrFilter, chrUSrcx, chrVSrcx, chrFilterSize, alpSrcx, dest, dstW, y, x, j
+%endif
     VBROADCASTSS m10, dword [ptrq + SwsContext.yuv2rgb_y_offset]
     VBROADCASTSS m11, dword [ptrq + SwsContext.yuv2rgb_y_coeff]
     VBROADCASTSS m12, dword [ptrq + SwsContext.yuv2rgb_v2r_coeff]
@@ -906,12 +1094,16 @@ cglobal yuv2%1_full_X, 12, 14, 16, ptr, lumFilter, lumSrcx, lumFilterSize, chrFi
 %endif
 
 %if FLOAT
+        ; per plane normalization, float_norm_mul/add are indexed G, B, R, A
         cvtdq2ps R, R
         cvtdq2ps G, G
         cvtdq2ps B, B
-        mulps R, [pd_65535_invf]
-        mulps G, [pd_65535_invf]
-        mulps B, [pd_65535_invf]
+        mulps R, [normq + 2*32]
+        mulps G, [normq + 0*32]
+        mulps B, [normq + 1*32]
+        addps R, [normq + 6*32]
+        addps G, [normq + 4*32]
+        addps B, [normq + 5*32]
 %endif
         STORE_PIXELS [destq +  0], 1, DEPTH, IS_BE ; G
         STORE_PIXELS [destq +  8], 2, DEPTH, IS_BE ; B
@@ -924,7 +1116,8 @@ cglobal yuv2%1_full_X, 12, 14, 16, ptr, lumFilter, lumSrcx, lumFilterSize, chrFi
             psrad A, A_SHIFT
 %if FLOAT
             cvtdq2ps A, A
-            mulps A, [pd_65535_invf]
+            mulps A, [normq + 3*32]
+            addps A, [normq + 7*32]
 %endif
             STORE_PIXELS [destq + 24], 3, DEPTH, IS_BE
         %%skip_alpha_store:
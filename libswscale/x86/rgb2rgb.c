@@ -136,6 +136,52 @@ void ff_uyvytoyuv422_sse2(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
 void ff_uyvytoyuv422_avx(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
                          const uint8_t *src, int width, int height,
                          int lumStride, int chromStride, int srcStride);
+
+void ff_interleave_words_sse2(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
+                              int width, int height, int src1Stride,
+                              int src2Stride, int dstStride, int shift);
+void ff_deinterleave_words_sse2(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                                int width, int height, int srcStride,
+                                int dst1Stride, int dst2Stride, int shift);
+void ff_shift_words_sse2(const uint8_t *src, uint8_t *dst, int width, int height,
+                         int srcStride, int dstStride, int shift);
+void ff_y210_to_yuv422p10_sse2(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                               const uint8_t *src, int width, int height,
+                               int lumStride, int chromStride, int srcStride);
+void ff_yuv422p10_to_y210_sse2(const uint8_t *ysrc, const uint8_t *usrc,
+                               const uint8_t *vsrc, uint8_t *dst,
+                               int width, int height,
+                               int lumStride, int chromStride, int dstStride);
+void ff_packed30_to_planar_sse2(const uint8_t *src, uint8_t *dst0, uint8_t *dst1,
+                                uint8_t *dst2, int width, int height,
+                                int srcStride, int dstStride);
+void ff_planar_to_packed30_sse2(const uint8_t *src0, const uint8_t *src1,
+                                const uint8_t *src2, uint8_t *dst,
+                                int width, int height,
+                                int srcStride, int dstStride, uint32_t pad);
+
+void ff_interleave_words_avx2(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
+                              int width, int height, int src1Stride,
+                              int src2Stride, int dstStride, int shift);
+void ff_deinterleave_words_avx2(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                                int width, int height, int srcStride,
+                                int dst1Stride, int dst2Stride, int shift);
+void ff_shift_words_avx2(const uint8_t *src, uint8_t *dst, int width, int height,
+                         int srcStride, int dstStride, int shift);
+void ff_y210_to_yuv422p10_avx2(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                               const uint8_t *src, int width, int height,
+                               int lumStride, int chromStride, int srcStride);
+void ff_yuv422p10_to_y210_avx2(const uint8_t *ysrc, const uint8_t *usrc,
+                               const uint8_t *vsrc, uint8_t *dst,
+                               int width, int height,
+                               int lumStride, int chromStride, int dstStride);
+void ff_packed30_to_planar_avx2(const uint8_t *src, uint8_t *dst0, uint8_t *dst1,
+                                uint8_t *dst2, int width, int height,
+                                int srcStride, int dstStride);
+void ff_planar_to_packed30_avx2(const uint8_t *src0, const uint8_t *src1,
+                                const uint8_t *src2, uint8_t *dst,
+                                int width, int height,
+                                int srcStride, int dstStride, uint32_t pad);
 #endif
 
 av_cold void rgb2rgb_init_x86(void)
@@ -156,7 +202,14 @@ av_cold void rgb2rgb_init_x86(void)
     }
     if (EXTERNAL_SSE2(cpu_flags)) {
 #if ARCH_X86_64
-        uyvytoyuv422 = ff_uyvytoyuv422_sse2;
+        uyvytoyuv422      = ff_uyvytoyuv422_sse2;
+        interleaveWords   = ff_interleave_words_sse2;
+        deinterleaveWords = ff_deinterleave_words_sse2;
+        shiftWords        = ff_shift_words_sse2;
+        y210toyuv422p10   = ff_y210_to_yuv422p10_sse2;
+        yuv422p10toy210   = ff_yuv422p10_to_y210_sse2;
+        packed30toplanar  = ff_packed30_to_planar_sse2;
+        planartopacked30  = ff_planar_to_packed30_sse2;
 #endif
     }
     if (EXTERNAL_SSSE3(cpu_flags)) {
@@ -173,6 +226,13 @@ av_cold void rgb2rgb_init_x86(void)
         shuffle_bytes_1230 = ff_shuffle_bytes_1230_avx2;
         shuffle_bytes_3012 = ff_shuffle_bytes_3012_avx2;
         shuffle_bytes_3210 = ff_shuffle_bytes_3210_avx2;
+        interleaveWords    = ff_interleave_words_avx2;
+        deinterleaveWords  = ff_deinterleave_words_avx2;
+        shiftWords         = ff_shift_words_avx2;
+        y210toyuv422p10    = ff_y210_to_yuv422p10_avx2;
+        yuv422p10toy210    = ff_yuv422p10_to_y210_avx2;
+        packed30toplanar   = ff_packed30_to_planar_avx2;
+        planartopacked30   = ff_planar_to_packed30_avx2;
     }
     if (EXTERNAL_AVX(cpu_flags)) {
         uyvytoyuv422 = ff_uyvytoyuv422_avx;
@@ -310,3 +310,573 @@ UYVY_TO_YUV422
 INIT_XMM avx
 UYVY_TO_YUV422
 %endif
+
+; fix up the qword order after in-lane packs, or before in-lane unpacks
+%macro PERMUTE_LANES 1-*
+%if cpuflag(avx2)
+%rep %0
+    vpermq     %1, %1, q3120
+%rotate 1
+%endrep
+%endif
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; interleave_words(const uint8_t *src1, const uint8_t *src2, uint8_t *dst,
+;                  int width, int height, int src1Stride,
+;                  int src2Stride, int dstStride, int shift)
+;-----------------------------------------------------------------------------------------------
+%macro INTERLEAVE_WORDS 0
+cglobal interleave_words, 9, 12, 5, src1, src2, dst, w, h, src1_stride, src2_stride, dst_stride, shift, x, wmain, tmp
+    movd                   xm4, shiftd
+    movsxdifnidn             wq, wd
+    movsxdifnidn   src1_strideq, src1_strided
+    movsxdifnidn   src2_strideq, src2_strided
+    movsxdifnidn    dst_strideq, dst_strided
+
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize / 2 - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [src1q + xq * 2]
+        movu                m1, [src2q + xq * 2]
+        psllw               m0, xm4
+        psllw               m1, xm4
+        PERMUTE_LANES       m0, m1
+        punpckhwd           m2, m0, m1
+        punpcklwd           m0, m1
+        movu [dstq + xq * 4         ], m0
+        movu [dstq + xq * 4 + mmsize], m2
+        add                 xq, mmsize / 2
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        movzx             tmpd, word [src1q + xq * 2]
+        movd               xm0, tmpd
+        movzx             tmpd, word [src2q + xq * 2]
+        movd               xm1, tmpd
+        psllw              xm0, xm4
+        psllw              xm1, xm4
+        movd              tmpd, xm0
+        mov [dstq + xq * 4    ], tmpw
+        movd              tmpd, xm1
+        mov [dstq + xq * 4 + 2], tmpw
+        inc                 xq
+        jmp .loop_scalar
+
+    .end_line:
+        add              src1q, src1_strideq
+        add              src2q, src2_strideq
+        add               dstq, dst_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; deinterleave_words(const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+;                    int width, int height, int srcStride,
+;                    int dst1Stride, int dst2Stride, int shift)
+;-----------------------------------------------------------------------------------------------
+%macro DEINTERLEAVE_WORDS 0
+cglobal deinterleave_words, 9, 12, 5, src, dst1, dst2, w, h, src_stride, dst1_stride, dst2_stride, shift, x, wmain, tmp
+    movd                   xm4, shiftd
+    movsxdifnidn             wq, wd
+    movsxdifnidn    src_strideq, src_strided
+    movsxdifnidn   dst1_strideq, dst1_strided
+    movsxdifnidn   dst2_strideq, dst2_strided
+
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize / 2 - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [srcq + xq * 4         ]
+        movu                m1, [srcq + xq * 4 + mmsize]
+        ; sign extend both words of each dword so that the packs are exact
+        pslld               m2, m0, 16
+        pslld               m3, m1, 16
+        psrad               m2, 16
+        psrad               m3, 16
+        psrad               m0, 16
+        psrad               m1, 16
+        packssdw            m2, m3
+        packssdw            m0, m1
+        PERMUTE_LANES       m2, m0
+        psrlw               m2, xm4
+        psrlw               m0, xm4
+        movu [dst1q + xq * 2], m2
+        movu [dst2q + xq * 2], m0
+        add                 xq, mmsize / 2
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        movzx             tmpd, word [srcq + xq * 4    ]
+        movd               xm0, tmpd
+        movzx             tmpd, word [srcq + xq * 4 + 2]
+        movd               xm1, tmpd
+        psrlw              xm0, xm4
+        psrlw              xm1, xm4
+        movd              tmpd, xm0
+        mov [dst1q + xq * 2], tmpw
+        movd              tmpd, xm1
+        mov [dst2q + xq * 2], tmpw
+        inc                 xq
+        jmp .loop_scalar
+
+    .end_line:
+        add               srcq, src_strideq
+        add              dst1q, dst1_strideq
+        add              dst2q, dst2_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; shift_words(const uint8_t *src, uint8_t *dst, int width, int height,
+;             int srcStride, int dstStride, int shift)
+;-----------------------------------------------------------------------------------------------
+%macro SHIFT_WORDS 0
+cglobal shift_words, 7, 10, 6, src, dst, w, h, src_stride, dst_stride, shift, x, wmain, tmp
+    ; xm4 = right shift, xm5 = left shift
+    xor                   tmpd, tmpd
+    mov                     xd, shiftd
+    neg                     xd
+    cmovl                   xd, tmpd
+    movd                   xm4, xd
+    mov                     xd, shiftd
+    test                    xd, xd
+    cmovl                   xd, tmpd
+    movd                   xm5, xd
+
+    movsxdifnidn             wq, wd
+    movsxdifnidn    src_strideq, src_strided
+    movsxdifnidn    dst_strideq, dst_strided
+
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [srcq + xq * 2         ]
+        movu                m1, [srcq + xq * 2 + mmsize]
+        psrlw               m0, xm4
+        psrlw               m1, xm4
+        psllw               m0, xm5
+        psllw               m1, xm5
+        movu [dstq + xq * 2         ], m0
+        movu [dstq + xq * 2 + mmsize], m1
+        add                 xq, mmsize
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        movzx             tmpd, word [srcq + xq * 2]
+        movd               xm0, tmpd
+        psrlw              xm0, xm4
+        psllw              xm0, xm5
+        movd              tmpd, xm0
+        mov [dstq + xq * 2], tmpw
+        inc                 xq
+        jmp .loop_scalar
+
+    .end_line:
+        add               srcq, src_strideq
+        add               dstq, dst_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; y210_to_yuv422p10(uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+;                   const uint8_t *src, int width, int height,
+;                   int lumStride, int chromStride, int srcStride)
+;-----------------------------------------------------------------------------------------------
+%macro Y210_TO_YUV422P10 0
+cglobal y210_to_yuv422p10, 9, 12, 7, ydst, udst, vdst, src, w, h, lum_stride, chrom_stride, src_stride, x, wmain, tmp
+    pcmpeqw                 m4, m4
+    psrld                   m4, 16
+
+    movsxdifnidn             wq, wd
+    movsxdifnidn    lum_strideq, lum_strided
+    movsxdifnidn  chrom_strideq, chrom_strided
+    movsxdifnidn    src_strideq, src_strided
+
+    and                     wq, ~1
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [srcq + xq * 4             ]
+        movu                m1, [srcq + xq * 4 + mmsize    ]
+        movu                m2, [srcq + xq * 4 + mmsize * 2]
+        movu                m3, [srcq + xq * 4 + mmsize * 3]
+        psrlw               m0, 6
+        psrlw               m1, 6
+        psrlw               m2, 6
+        psrlw               m3, 6
+
+        ; Y
+        pand                m5, m0, m4
+        pand                m6, m1, m4
+        packssdw            m5, m6
+        PERMUTE_LANES       m5
+        movu [ydstq + xq * 2], m5
+        pand                m5, m2, m4
+        pand                m6, m3, m4
+        packssdw            m5, m6
+        PERMUTE_LANES       m5
+        movu [ydstq + xq * 2 + mmsize], m5
+
+        ; UV
+        psrld               m0, 16
+        psrld               m1, 16
+        psrld               m2, 16
+        psrld               m3, 16
+        packssdw            m0, m1
+        packssdw            m2, m3
+        PERMUTE_LANES       m0, m2
+
+        ; U
+        pand                m1, m0, m4
+        pand                m3, m2, m4
+        packssdw            m1, m3
+
+        ; V
+        psrld               m0, 16
+        psrld               m2, 16
+        packssdw            m0, m2
+
+        PERMUTE_LANES       m1, m0
+        movu  [udstq + xq], m1
+        movu  [vdstq + xq], m0
+
+        add                 xq, mmsize
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        movzx             tmpd, word [srcq + xq * 4    ]
+        shr               tmpd, 6
+        mov [ydstq + xq * 2    ], tmpw
+        movzx             tmpd, word [srcq + xq * 4 + 2]
+        shr               tmpd, 6
+        mov [udstq + xq        ], tmpw
+        movzx             tmpd, word [srcq + xq * 4 + 4]
+        shr               tmpd, 6
+        mov [ydstq + xq * 2 + 2], tmpw
+        movzx             tmpd, word [srcq + xq * 4 + 6]
+        shr               tmpd, 6
+        mov [vdstq + xq        ], tmpw
+        add                 xq, 2
+        jmp .loop_scalar
+
+    .end_line:
+        add               srcq, src_strideq
+        add              ydstq, lum_strideq
+        add              udstq, chrom_strideq
+        add              vdstq, chrom_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; yuv422p10_to_y210(const uint8_t *ysrc, const uint8_t *usrc, const uint8_t *vsrc,
+;                   uint8_t *dst, int width, int height,
+;                   int lumStride, int chromStride, int dstStride)
+;-----------------------------------------------------------------------------------------------
+%macro YUV422P10_TO_Y210 0
+cglobal yuv422p10_to_y210, 9, 12, 5, ysrc, usrc, vsrc, dst, w, h, lum_stride, chrom_stride, dst_stride, x, wmain, tmp
+    movsxdifnidn             wq, wd
+    movsxdifnidn    lum_strideq, lum_strided
+    movsxdifnidn  chrom_strideq, chrom_strided
+    movsxdifnidn    dst_strideq, dst_strided
+
+    and                     wq, ~1
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [ysrcq + xq * 2         ]
+        movu                m1, [ysrcq + xq * 2 + mmsize]
+        movu                m2, [usrcq + xq]
+        movu                m3, [vsrcq + xq]
+        psllw               m0, 6
+        psllw               m1, 6
+        psllw               m2, 6
+        psllw               m3, 6
+
+        PERMUTE_LANES       m2, m3
+        punpckhwd           m4, m2, m3 ; UVUV... second half
+        punpcklwd           m2, m3     ; UVUV... first half
+
+        PERMUTE_LANES       m0, m2
+        punpckhwd           m3, m0, m2
+        punpcklwd           m0, m2
+        movu [dstq + xq * 4             ], m0
+        movu [dstq + xq * 4 + mmsize    ], m3
+
+        PERMUTE_LANES       m1, m4
+        punpckhwd           m3, m1, m4
+        punpcklwd           m1, m4
+        movu [dstq + xq * 4 + mmsize * 2], m1
+        movu [dstq + xq * 4 + mmsize * 3], m3
+
+        add                 xq, mmsize
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        movzx             tmpd, word [ysrcq + xq * 2    ]
+        shl               tmpd, 6
+        mov [dstq + xq * 4    ], tmpw
+        movzx             tmpd, word [usrcq + xq        ]
+        shl               tmpd, 6
+        mov [dstq + xq * 4 + 2], tmpw
+        movzx             tmpd, word [ysrcq + xq * 2 + 2]
+        shl               tmpd, 6
+        mov [dstq + xq * 4 + 4], tmpw
+        movzx             tmpd, word [vsrcq + xq        ]
+        shl               tmpd, 6
+        mov [dstq + xq * 4 + 6], tmpw
+        add                 xq, 2
+        jmp .loop_scalar
+
+    .end_line:
+        add              ysrcq, lum_strideq
+        add              usrcq, chrom_strideq
+        add              vsrcq, chrom_strideq
+        add               dstq, dst_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; packed30_to_planar(const uint8_t *src, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2,
+;                    int width, int height, int srcStride, int dstStride)
+;-----------------------------------------------------------------------------------------------
+%macro PACKED30_TO_PLANAR 0
+cglobal packed30_to_planar, 8, 12, 5, src, dst0, dst1, dst2, w, h, src_stride, dst_stride, x, wmain, tmp, tmp2
+    pcmpeqd                 m4, m4
+    psrld                   m4, 22
+
+    movsxdifnidn             wq, wd
+    movsxdifnidn    src_strideq, src_strided
+    movsxdifnidn    dst_strideq, dst_strided
+
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize / 2 - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [srcq + xq * 4         ]
+        movu                m1, [srcq + xq * 4 + mmsize]
+
+        pand                m2, m0, m4
+        pand                m3, m1, m4
+        packssdw            m2, m3
+        PERMUTE_LANES       m2
+        movu [dst0q + xq * 2], m2
+
+        psrld               m2, m0, 10
+        psrld               m3, m1, 10
+        pand                m2, m4
+        pand                m3, m4
+        packssdw            m2, m3
+        PERMUTE_LANES       m2
+        movu [dst1q + xq * 2], m2
+
+        psrld               m0, 20
+        psrld               m1, 20
+        pand                m0, m4
+        pand                m1, m4
+        packssdw            m0, m1
+        PERMUTE_LANES       m0
+        movu [dst2q + xq * 2], m0
+
+        add                 xq, mmsize / 2
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        mov               tmpd, [srcq + xq * 4]
+        mov              tmp2d, tmpd
+        and              tmp2d, 0x3FF
+        mov [dst0q + xq * 2], tmp2w
+        mov              tmp2d, tmpd
+        shr              tmp2d, 10
+        and              tmp2d, 0x3FF
+        mov [dst1q + xq * 2], tmp2w
+        shr               tmpd, 20
+        and               tmpd, 0x3FF
+        mov [dst2q + xq * 2], tmpw
+        inc                 xq
+        jmp .loop_scalar
+
+    .end_line:
+        add               srcq, src_strideq
+        add              dst0q, dst_strideq
+        add              dst1q, dst_strideq
+        add              dst2q, dst_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------------------------
+; planar_to_packed30(const uint8_t *src0, const uint8_t *src1, const uint8_t *src2,
+;                    uint8_t *dst, int width, int height,
+;                    int srcStride, int dstStride, uint32_t pad)
+;-----------------------------------------------------------------------------------------------
+%macro PLANAR_TO_PACKED30 0
+cglobal planar_to_packed30, 9, 13, 7, src0, src1, src2, dst, w, h, src_stride, dst_stride, pad, x, wmain, tmp, tmp2
+    movd                   xm5, padd
+%if cpuflag(avx2)
+    vpbroadcastd            m5, xm5
+%else
+    pshufd                  m5, m5, 0
+%endif
+    pxor                    m4, m4
+
+    movsxdifnidn             wq, wd
+    movsxdifnidn    src_strideq, src_strided
+    movsxdifnidn    dst_strideq, dst_strided
+
+    mov                 wmainq, wq
+    and                 wmainq, ~(mmsize / 2 - 1)
+
+.loop_line:
+    xor                     xq, xq
+    test                wmainq, wmainq
+    jz .loop_scalar
+
+    .loop_simd:
+        movu                m0, [src0q + xq * 2]
+        movu                m1, [src1q + xq * 2]
+        movu                m2, [src2q + xq * 2]
+        PERMUTE_LANES       m0, m1, m2
+
+        punpckhwd           m3, m0, m4
+        punpcklwd           m0, m4
+        por                 m0, m5
+        por                 m3, m5
+
+        punpckhwd           m6, m1, m4
+        punpcklwd           m1, m4
+        pslld               m1, 10
+        pslld               m6, 10
+        por                 m0, m1
+        por                 m3, m6
+
+        punpckhwd           m6, m2, m4
+        punpcklwd           m2, m4
+        pslld               m2, 20
+        pslld               m6, 20
+        por                 m0, m2
+        por                 m3, m6
+
+        movu [dstq + xq * 4         ], m0
+        movu [dstq + xq * 4 + mmsize], m3
+
+        add                 xq, mmsize / 2
+        cmp                 xq, wmainq
+        jl .loop_simd
+
+    .loop_scalar:
+        cmp                 xq, wq
+        jge .end_line
+        movzx             tmpd, word [src1q + xq * 2]
+        shl               tmpd, 10
+        movzx            tmp2d, word [src2q + xq * 2]
+        shl              tmp2d, 20
+        or                tmpd, tmp2d
+        movzx            tmp2d, word [src0q + xq * 2]
+        or                tmpd, tmp2d
+        or                tmpd, padd
+        mov [dstq + xq * 4], tmpd
+        inc                 xq
+        jmp .loop_scalar
+
+    .end_line:
+        add              src0q, src_strideq
+        add              src1q, src_strideq
+        add              src2q, src_strideq
+        add               dstq, dst_strideq
+        sub                 hd, 1
+        jg .loop_line
+
+    RET
+%endmacro
+
+%if ARCH_X86_64
+INIT_XMM sse2
+INTERLEAVE_WORDS
+DEINTERLEAVE_WORDS
+SHIFT_WORDS
+Y210_TO_YUV422P10
+YUV422P10_TO_Y210
+PACKED30_TO_PLANAR
+PLANAR_TO_PACKED30
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+INTERLEAVE_WORDS
+DEINTERLEAVE_WORDS
+SHIFT_WORDS
+Y210_TO_YUV422P10
+YUV422P10_TO_Y210
+PACKED30_TO_PLANAR
+PLANAR_TO_PACKED30
+%endif
+%endif
@@ -280,6 +280,15 @@ VSCALEX_FUNCS(sse4);
 VSCALEX_FUNC(16, sse4);
 VSCALEX_FUNCS(avx);
 
+#define VSCALEX_WIDE_FUNCS(opt) \
+    VSCALEX_FUNCS(opt); \
+    VSCALEX_FUNC(12, opt); \
+    VSCALEX_FUNC(14, opt); \
+    VSCALEX_FUNC(16, opt)
+
+VSCALEX_WIDE_FUNCS(avx2);
+VSCALEX_WIDE_FUNCS(avx512);
+
 #define VSCALE_FUNC(size, opt) \
 void ff_yuv2plane1_ ## size ## _ ## opt(const int16_t *src, uint8_t *dst, int dstW, \
                                         const uint8_t *dither, int offset)
@@ -323,6 +332,30 @@ INPUT_FUNCS(ssse3);
 INPUT_FUNCS(avx);
 
 #if ARCH_X86_64
+INPUT_FUNC(rgba,  avx2);
+INPUT_FUNC(bgra,  avx2);
+INPUT_FUNC(argb,  avx2);
+INPUT_FUNC(abgr,  avx2);
+INPUT_FUNC(rgb24, avx2);
+INPUT_FUNC(bgr24, avx2);
+
+#define INPUT_LINEAR_FUNCS(fmt, opt) \
+void ff_ ## fmt ## _linearToY_ ## opt(uint8_t *dst, const uint8_t *src, \
+                                      const uint8_t *unused0, const uint8_t *unused1, \
+                                      int w, uint32_t *rgb2yuv, void *opq); \
+void ff_ ## fmt ## _linearToUV_ ## opt(uint8_t *dstU, uint8_t *dstV, \
+                                       const uint8_t *unused0, const uint8_t *src1, \
+                                       const uint8_t *src2, int w, \
+                                       uint32_t *rgb2yuv, void *opq); \
+void ff_ ## fmt ## _linearToUV_half_ ## opt(uint8_t *dstU, uint8_t *dstV, \
+                                            const uint8_t *unused0, const uint8_t *src1, \
+                                            const uint8_t *src2, int w, \
+                                            uint32_t *rgb2yuv, void *opq); \
+void ff_ ## fmt ## _gamma_ ## opt(uint16_t *line, const uint16_t *lut, int w)
+
+INPUT_LINEAR_FUNCS(rgb48le,  avx2);
+INPUT_LINEAR_FUNCS(rgba64le, avx2);
+
 #define YUV2NV_DECL(fmt, opt) \
 void ff_yuv2 ## fmt ## cX_ ## opt(enum AVPixelFormat format, const uint8_t *dither, \
                                   const int16_t *filter, int filterSize, \
@@ -625,6 +658,15 @@ switch(c->dstBpc){ \
     default:  hscalefn = ff_hscale8to15_X4_avx2; break; \
              break; \
     }
+#define ASSIGN_WIDE_VSCALEX_FUNC(vscalefn, opt) \
+    switch (c->dstBpc) { \
+    case 16: if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_16_ ## opt; break; \
+    case 14: if (!isBE(c->dstFormat) && !isSemiPlanarYUV(c->dstFormat)) vscalefn = ff_yuv2planeX_14_ ## opt; break; \
+    case 12: if (!isBE(c->dstFormat) && !isSemiPlanarYUV(c->dstFormat)) vscalefn = ff_yuv2planeX_12_ ## opt; break; \
+    case 10: if (!isBE(c->dstFormat) && !isSemiPlanarYUV(c->dstFormat)) vscalefn = ff_yuv2planeX_10_ ## opt; break; \
+    case 9:  if (!isBE(c->dstFormat)) vscalefn = ff_yuv2planeX_9_  ## opt; break; \
+    case 8:  if (!c->use_mmx_vfilter) vscalefn = ff_yuv2planeX_8_  ## opt; break; \
+    }
 
     if (EXTERNAL_AVX2_FAST(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
         if ((c->srcBpc == 8) && (c->dstBpc <= 14)) {
@@ -634,6 +676,7 @@ switch(c->dstBpc){ \
     }
 
     if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+        ASSIGN_WIDE_VSCALEX_FUNC(c->yuv2planeX, avx2);
         switch (c->dstFormat) {
         case AV_PIX_FMT_NV12:
         case AV_PIX_FMT_NV24:
@@ -646,8 +689,44 @@ switch(c->dstBpc){ \
         default:
             break;
         }
+        /* the packed RGB readers need at least one full vector per line */
+        if (c->srcW >= 16) {
+            switch (c->srcFormat) {
+            case_rgb(rgb24, RGB24, avx2);
+            case_rgb(bgr24, BGR24, avx2);
+            case_rgb(bgra,  BGRA,  avx2);
+            case_rgb(rgba,  RGBA,  avx2);
+            case_rgb(abgr,  ABGR,  avx2);
+            case_rgb(argb,  ARGB,  avx2);
+            default:
+                break;
+            }
+        }
+#define case_linear(x, X, opt) \
+        case AV_PIX_FMT_ ## X: \
+            c->lumToYV12 = ff_ ## x ## _linearToY_ ## opt; \
+            c->chrToYV12 = c->chrSrcHSubSample ? ff_ ## x ## _linearToUV_half_ ## opt \
+                                               : ff_ ## x ## _linearToUV_ ## opt; \
+            break
+        /* the gathers of the linear light lookups are slow on some cpus */
+        if (c->is_internal_gamma && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
+            if (c->srcW >= 16) {
+                switch (c->srcFormat) {
+                case_linear(rgb48le,  RGB48LE,  avx2);
+                case_linear(rgba64le, RGBA64LE, avx2);
+                default:
+                    break;
+                }
+            }
+            if (c->dstFormat == AV_PIX_FMT_RGB48LE)
+                c->rgb16_gamma = ff_rgb48le_gamma_avx2;
+            else if (c->dstFormat == AV_PIX_FMT_RGBA64LE)
+                c->rgb16_gamma = ff_rgba64le_gamma_avx2;
+        }
     }
 
+    if (EXTERNAL_AVX512(cpu_flags))
+        ASSIGN_WIDE_VSCALEX_FUNC(c->yuv2planeX, avx512);
 
 #define INPUT_PLANER_RGB_A_FUNC_CASE(fmt, name, opt)                  \
         case fmt:                                                     \
@@ -749,6 +828,7 @@ switch(c->dstBpc){ \
         /* yuv2gbrp uses the SwsContext for yuv coefficients
            if struct offsets change the asm needs to be updated too */
         av_assert0(offsetof(SwsContext, yuv2rgb_y_offset) == 40292);
+        av_assert0(offsetof(SwsContext, float_norm_mul) == 40320);
 
 #define YUV2ANYX_FUNC_CASE(fmt, name, opt)              \
         case fmt:                                       \
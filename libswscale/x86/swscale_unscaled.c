@@ -0,0 +1,80 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/cpu.h"
+#include "libavutil/x86/cpu.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define BAYER_FUNCS(pattern, opt)                                                       \
+void ff_bayer_##pattern##8_to_rgb24_interpolate_inner_##opt(const uint8_t *src,         \
+                                                            int src_stride,             \
+                                                            uint8_t *dst,               \
+                                                            int dst_stride, int width); \
+void ff_bayer_##pattern##16le_to_rgb48_interpolate_inner_##opt(const uint8_t *src,      \
+                                                               int src_stride,          \
+                                                               uint8_t *dst,            \
+                                                               int dst_stride, int width); \
+void ff_bayer_##pattern##16be_to_rgb48_interpolate_inner_##opt(const uint8_t *src,      \
+                                                               int src_stride,          \
+                                                               uint8_t *dst,            \
+                                                               int dst_stride, int width);
+
+BAYER_FUNCS(bggr, ssse3)
+BAYER_FUNCS(rggb, ssse3)
+BAYER_FUNCS(gbrg, ssse3)
+BAYER_FUNCS(grbg, ssse3)
+
+av_cold void ff_get_unscaled_swscale_x86(SwsContext *c)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    /* the kernels process blocks of 16 bytes per row, the last one
+     * overlapping the previous ones. The bayer to YUV converter demosaics
+     * 8-bit sources to RGB24 and 16-bit ones to RGB48 too. */
+    if (ARCH_X86_64 && EXTERNAL_SSSE3(cpu_flags) &&
+        c->srcW >= 20 && !(c->srcW & 1)) {
+        switch (c->srcFormat) {
+#define CASE(pixfmt, dstfmt, func)                                   \
+        case pixfmt:                                                 \
+            if (c->dstFormat == dstfmt ||                            \
+                c->dstFormat == AV_PIX_FMT_YUV420P)                  \
+                c->bayer_interpolate_inner = ff_bayer_##func##_ssse3; \
+            break;
+        CASE(AV_PIX_FMT_BAYER_BGGR8,    AV_PIX_FMT_RGB24,   bggr8_to_rgb24_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_RGGB8,    AV_PIX_FMT_RGB24,   rggb8_to_rgb24_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_GBRG8,    AV_PIX_FMT_RGB24,   gbrg8_to_rgb24_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_GRBG8,    AV_PIX_FMT_RGB24,   grbg8_to_rgb24_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_BGGR16LE, AV_PIX_FMT_RGB48LE, bggr16le_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_RGGB16LE, AV_PIX_FMT_RGB48LE, rggb16le_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_GBRG16LE, AV_PIX_FMT_RGB48LE, gbrg16le_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_GRBG16LE, AV_PIX_FMT_RGB48LE, grbg16le_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_BGGR16BE, AV_PIX_FMT_RGB48LE, bggr16be_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_RGGB16BE, AV_PIX_FMT_RGB48LE, rggb16be_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_GBRG16BE, AV_PIX_FMT_RGB48LE, gbrg16be_to_rgb48_interpolate_inner)
+        CASE(AV_PIX_FMT_BAYER_GRBG16BE, AV_PIX_FMT_RGB48LE, grbg16be_to_rgb48_interpolate_inner)
+#undef CASE
+        default:
+            break;
+        }
+    }
+}
@@ -63,6 +63,53 @@
 #define RENAME(a) a ## _ssse3
 #include "yuv2rgb_template.c"
 
+//AVX2 versions
+#if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+#undef RENAME
+#define RENAME(a) a ## _avx2
+#include "yuv2rgb_template.c"
+#endif
+
+//AVX-512 versions
+#if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+#undef RENAME
+#define RENAME(a) a ## _avx512
+#include "yuv2rgb_template.c"
+#endif
+
+#if ARCH_X86_64
+#define YUV2RGB_FUNCS(in, opt)                                      \
+    switch (c->dstFormat) {                                         \
+    case AV_PIX_FMT_RGB32:  return yuv ## in ## _rgb32_ ## opt;     \
+    case AV_PIX_FMT_BGR32:  return yuv ## in ## _bgr32_ ## opt;     \
+    case AV_PIX_FMT_RGB24:  return yuv ## in ## _rgb24_ ## opt;     \
+    case AV_PIX_FMT_BGR24:  return yuv ## in ## _bgr24_ ## opt;     \
+    case AV_PIX_FMT_RGB565: return yuv ## in ## _rgb16_ ## opt;     \
+    case AV_PIX_FMT_RGB555: return yuv ## in ## _rgb15_ ## opt;     \
+    }
+
+#define YUVA2RGB_FUNCS(in, opt)                                     \
+    if (CONFIG_SWSCALE_ALPHA && isALPHA(c->srcFormat)) {            \
+        if (c->dstFormat == AV_PIX_FMT_RGB32)                       \
+            return yuva ## in ## _rgb32_ ## opt;                    \
+        if (c->dstFormat == AV_PIX_FMT_BGR32)                       \
+            return yuva ## in ## _bgr32_ ## opt;                    \
+    }                                                               \
+    YUV2RGB_FUNCS(in, opt)
+
+/* the SSSE3, AVX2 and AVX-512 versions need one full vector of pixels */
+#define WIDE_INPUT_FUNCS(opt)                                       \
+    switch (c->srcFormat) {                                         \
+    case AV_PIX_FMT_YUV444P:                                        \
+    case AV_PIX_FMT_YUVA444P:                                       \
+        YUVA2RGB_FUNCS(444, opt)                                    \
+        break;                                                      \
+    case AV_PIX_FMT_YUV420P10LE:                                    \
+        YUV2RGB_FUNCS(420p10, opt)                                  \
+        break;                                                      \
+    }
+#endif
+
 #endif /* HAVE_X86ASM */
 
 av_cold SwsFunc ff_yuv2rgb_init_x86(SwsContext *c)
@@ -70,7 +117,38 @@ av_cold SwsFunc ff_yuv2rgb_init_x86(SwsContext *c)
 #if HAVE_X86ASM
     int cpu_flags = av_get_cpu_flags();
 
-    if (EXTERNAL_SSSE3(cpu_flags)) {
+    /* 4:4:4 and 10-bit 4:2:0 input only have x86-64 versions */
+    if (c->srcFormat != AV_PIX_FMT_YUV420P &&
+        c->srcFormat != AV_PIX_FMT_YUV422P &&
+        c->srcFormat != AV_PIX_FMT_YUVA420P) {
+#if ARCH_X86_64
+#if HAVE_AVX512_EXTERNAL
+        if (EXTERNAL_AVX512(cpu_flags) && c->dstW >= 64)
+            WIDE_INPUT_FUNCS(avx512)
+#endif
+#if HAVE_AVX2_EXTERNAL
+        if (EXTERNAL_AVX2_FAST(cpu_flags) && c->dstW >= 32)
+            WIDE_INPUT_FUNCS(avx2)
+#endif
+        if (EXTERNAL_SSSE3(cpu_flags) && c->dstW >= 16)
+            WIDE_INPUT_FUNCS(ssse3)
+#endif
+        return NULL;
+    }
+
+#if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+    if (EXTERNAL_AVX512(cpu_flags) && c->dstW >= 64) {
+        YUVA2RGB_FUNCS(420, avx512)
+    }
+#endif
+
+#if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+    if (EXTERNAL_AVX2_FAST(cpu_flags) && c->dstW >= 32) {
+        YUVA2RGB_FUNCS(420, avx2)
+    }
+#endif
+
+    if (EXTERNAL_SSSE3(cpu_flags) && c->dstW >= 16) {
         switch (c->dstFormat) {
         case AV_PIX_FMT_RGB32:
             if (c->srcFormat == AV_PIX_FMT_YUVA420P) {
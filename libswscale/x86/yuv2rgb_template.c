@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 
+#include "libavutil/pixdesc.h"
 #include "libavutil/x86/asm.h"
 #include "libswscale/swscale_internal.h"
 
@@ -31,7 +32,7 @@
     if (h_size * depth > FFABS(dstStride[0]))                        \
         h_size -= 8;                                                 \
                                                                      \
-    vshift = c->srcFormat != AV_PIX_FMT_YUV422P;                        \
+    vshift = av_pix_fmt_desc_get(c->srcFormat)->log2_chroma_h;       \
                                                                      \
     for (y = 0; y < srcSliceH; y++) {                                \
         uint8_t *image    = dst[0] + (y + srcSliceY) * dstStride[0]; \
@@ -194,3 +195,89 @@ static inline int RENAME(yuv420_bgr24)(SwsContext *c, const uint8_t *src[],
     return srcSliceH;
 }
 #endif
+
+#if ARCH_X86_64 && defined(COMPILE_TEMPLATE_SSSE3)
+/* 4:4:4 and 10-bit 4:2:0 input: the chroma of 4:4:4 and the 16-bit samples
+ * are addressed with twice the index of 8-bit 4:2:0 */
+#define YUV2RGB_DITHER_0
+#define YUV2RGB_DITHER_15                                            \
+        c->blueDither  = ff_dither8[y       & 1];                    \
+        c->greenDither = ff_dither8[y       & 1];                    \
+        c->redDither   = ff_dither8[(y + 1) & 1];
+#define YUV2RGB_DITHER_16                                            \
+        c->blueDither  = ff_dither8[y       & 1];                    \
+        c->greenDither = ff_dither4[y       & 1];                    \
+        c->redDither   = ff_dither8[(y + 1) & 1];
+
+#define YUV2RGB_WIDE_FUNC(in, out, depth, ystep, cstep, dither)                    \
+extern void RENAME(ff_yuv_ ## in ## _ ## out)(x86_reg index, uint8_t *image,          \
+                                             const uint8_t *pu_index,                \
+                                             const uint8_t *pv_index,                \
+                                             const uint64_t *pointer_c_dither,       \
+                                             const uint8_t *py_2index);              \
+                                                                                     \
+static inline int RENAME(yuv ## in ## _ ## out)(SwsContext *c, const uint8_t *src[],  \
+                                               int srcStride[],                      \
+                                               int srcSliceY, int srcSliceH,         \
+                                               uint8_t *dst[], int dstStride[])      \
+{                                                                                    \
+    int y, h_size, vshift;                                                           \
+                                                                                     \
+    YUV2RGB_LOOP(depth)                                                              \
+                                                                                     \
+        YUV2RGB_DITHER_ ## dither                                                    \
+        RENAME(ff_yuv_ ## in ## _ ## out)(index, image, pu - cstep * index,          \
+                                          pv - cstep * index, &(c->redDither),       \
+                                          py - ystep * index);                       \
+    }                                                                                \
+    return srcSliceH;                                                                \
+}
+
+#define YUV2RGB_WIDE_FUNCS(in, ystep, cstep)                         \
+YUV2RGB_WIDE_FUNC(in, rgb24, 3, ystep, cstep, 0)                     \
+YUV2RGB_WIDE_FUNC(in, bgr24, 3, ystep, cstep, 0)                     \
+YUV2RGB_WIDE_FUNC(in, rgb32, 4, ystep, cstep, 0)                     \
+YUV2RGB_WIDE_FUNC(in, bgr32, 4, ystep, cstep, 0)                     \
+YUV2RGB_WIDE_FUNC(in, rgb15, 2, ystep, cstep, 15)                    \
+YUV2RGB_WIDE_FUNC(in, rgb16, 2, ystep, cstep, 16)
+
+YUV2RGB_WIDE_FUNCS(444,    2, 2)
+YUV2RGB_WIDE_FUNCS(420p10, 4, 2)
+
+extern void RENAME(ff_yuva_444_rgb32)(x86_reg index, uint8_t *image, const uint8_t *pu_index,
+                                      const uint8_t *pv_index, const uint64_t *pointer_c_dither,
+                                      const uint8_t *py_2index, const uint8_t *pa_2index);
+extern void RENAME(ff_yuva_444_bgr32)(x86_reg index, uint8_t *image, const uint8_t *pu_index,
+                                      const uint8_t *pv_index, const uint64_t *pointer_c_dither,
+                                      const uint8_t *py_2index, const uint8_t *pa_2index);
+
+static inline int RENAME(yuva444_rgb32)(SwsContext *c, const uint8_t *src[],
+                                        int srcStride[],
+                                        int srcSliceY, int srcSliceH,
+                                        uint8_t *dst[], int dstStride[])
+{
+    int y, h_size, vshift;
+
+    YUV2RGB_LOOP(4)
+
+        const uint8_t *pa = src[3] + y * srcStride[3];
+        RENAME(ff_yuva_444_rgb32)(index, image, pu - 2 * index, pv - 2 * index, &(c->redDither), py - 2 * index, pa - 2 * index);
+    }
+    return srcSliceH;
+}
+
+static inline int RENAME(yuva444_bgr32)(SwsContext *c, const uint8_t *src[],
+                                        int srcStride[],
+                                        int srcSliceY, int srcSliceH,
+                                        uint8_t *dst[], int dstStride[])
+{
+    int y, h_size, vshift;
+
+    YUV2RGB_LOOP(4)
+
+        const uint8_t *pa = src[3] + y * srcStride[3];
+        RENAME(ff_yuva_444_bgr32)(index, image, pu - 2 * index, pv - 2 * index, &(c->redDither), py - 2 * index, pa - 2 * index);
+    }
+    return srcSliceH;
+}
+#endif
@@ -23,20 +23,22 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 64
 
 ; below variables are named like mask_dwXY, which means to preserve dword No.X & No.Y
-mask_dw036 : db -1, -1,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1,  0,  0
-mask_dw147 : db  0,  0, -1, -1,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1
-mask_dw25  : db  0,  0,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0
-rgb24_shuf1: db  0,  1,  6,  7, 12, 13,  2,  3,  8,  9, 14, 15,  4,  5, 10, 11
-rgb24_shuf2: db 10, 11,  0,  1,  6,  7, 12, 13,  2,  3,  8,  9, 14, 15,  4,  5
-rgb24_shuf3: db  4,  5, 10, 11,  0,  1,  6,  7, 12, 13,  2,  3,  8,  9, 14, 15
-pw_00ff: times 8 dw 255
-pb_f8:   times 16 db 248
-pb_e0:   times 16 db 224
-pb_03:   times 16 db 3
-pb_07:   times 16 db 7
+mask_dw036 : times 4 db -1, -1,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1,  0,  0
+mask_dw147 : times 4 db  0,  0, -1, -1,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1
+mask_dw25  : times 4 db  0,  0,  0,  0, -1, -1,  0,  0,  0,  0, -1, -1,  0,  0,  0,  0
+rgb24_shuf1: times 4 db  0,  1,  6,  7, 12, 13,  2,  3,  8,  9, 14, 15,  4,  5, 10, 11
+rgb24_shuf2: times 4 db 10, 11,  0,  1,  6,  7, 12, 13,  2,  3,  8,  9, 14, 15,  4,  5
+rgb24_shuf3: times 4 db  4,  5, 10, 11,  0,  1,  6,  7, 12, 13,  2,  3,  8,  9, 14, 15
+pw_00ff: times 32 dw 255
+pb_f8:   times 64 db 248
+pb_e0:   times 64 db 224
+pb_03:   times 64 db 3
+pb_07:   times 64 db 7
+; qword order that undoes the in-lane packssdw of two zmm registers
+pq_pack_order: dq 0, 2, 4, 6, 1, 3, 5, 7
 
 mask_1101: dw -1, -1,  0, -1
 mask_0010: dw  0,  0, -1,  0
@@ -53,17 +55,26 @@ SECTION .text
 ; G = Y - ((ugCoff * (u - 128) + vgCoff * (v - 128)) >> 8)
 ; B = Y + ((ubCoff * (u - 128)) >> 8)
 ;
+; The 444 versions take one chroma sample per pixel, the 420p10 versions
+; 10-bit samples, which are scaled to the same 11 bits as 8-bit input << 3,
+; so both use the coefficients of 8-bit 4:2:0. They only exist on x86-64.
+;
+; The SSSE3, AVX2 and AVX-512 versions need at least one full vector of
+; pixels per line; a last partial vector is handled by recomputing the end
+; of the previous one, so nothing is written past the (8-aligned) width.
+;
 ;-----------------------------------------------------------------------------
 
 %macro MOV_H2L 1
 %if mmsize == 8
     psrlq %1, 32
-%else ; mmsize == 16
+%else ; mmsize == 16/32/64
     psrldq %1, 8
 %endif
 %endmacro
 
-%macro yuv2rgb_fn 3
+; %1 = yuv/yuva, %2 = rgb/bgr, %3 = output depth, %4 = 420/444/420p10 input
+%macro yuv2rgb_fn 3-4 420
 
 %if %3 == 32
     %ifidn %1, yuva
@@ -102,8 +113,8 @@ SECTION .text
 %define y_coff   [pointer_c_ditherq + 3  * 8]
 %define ub_coff  [pointer_c_ditherq + 5  * 8]
 %define vr_coff  [pointer_c_ditherq + 4  * 8]
-%elif mmsize == 16
-%define time_num 2
+%else ; mmsize == 16/32/64
+%define time_num (mmsize / 8)
 %if ARCH_X86_32
 %define reg_num 8
 %define my_offset [pointer_c_ditherq + 8  * 8]
@@ -125,13 +136,21 @@ SECTION .text
 %define ub_coff  m14
 %define vr_coff  m15
 %endif ; ARCH_X86_32/64
-%endif ; coeff define mmsize == 8/16
+%endif ; coeff define mmsize == 8/16/32/64
+
+%ifidn %4, 420
+%define yuv_shift 3
+%elifidn %4, 444
+%define yuv_shift 3
+%else ; 420p10
+%define yuv_shift 1
+%endif
 
-cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
+cglobal %1_%4_%2%3, GPR_num, GPR_num, reg_num, parameters
 
 %if ARCH_X86_64
     movsxd indexq, indexd
-%if mmsize == 16
+%if mmsize >= 16
     VBROADCASTSD y_offset, [pointer_c_ditherq + 8  * 8]
     VBROADCASTSD u_offset, [pointer_c_ditherq + 9  * 8]
     VBROADCASTSD v_offset, [pointer_c_ditherq + 10 * 8]
@@ -143,20 +162,98 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
 %endif
 %endif
 .loop0:
+%ifidn %4, 444
     movu m_y, [py_2indexq + 2 * indexq]
+    movu m4,  [pu_indexq  + 2 * indexq]
+    movu m5,  [pv_indexq  + 2 * indexq]
+    mova m2, [pw_00ff]
+    psrlw m7, m6, 8 ; Y1 Y3 Y5 Y7 ...
+    psrlw m0, m4, 8 ; U1 U3 U5 U7 ...
+    psrlw m1, m5, 8 ; V1 V3 V5 V7 ...
+    pand m6, m2     ; Y0 Y2 Y4 Y6 ...
+    pand m4, m2     ; U0 U2 U4 U6 ...
+    pand m5, m2     ; V0 V2 V4 V6 ...
+    psllw m4, 3
+    psllw m5, 3
+%else
+%ifidn %4, 420p10
+    movu m6,  [py_2indexq + 4 * indexq]
+    movu m7,  [py_2indexq + 4 * indexq + mmsize]
+    movu m_u, [pu_indexq  + 2 * indexq]
+    movu m_v, [pv_indexq  + 2 * indexq]
+    ; split the samples into even and odd pixels, as words in line order
+    psrld m2, m6, 16
+    psrld m3, m7, 16
+    pslld m6, 16
+    pslld m7, 16
+    psrld m6, 16
+    psrld m7, 16
+    packssdw m6, m7 ; Y0 Y2 Y4 Y6 ...
+    packssdw m2, m3 ; Y1 Y3 Y5 Y7 ...
+%if mmsize == 64
+    mova m3, [pq_pack_order]
+    vpermq m6, m3, m6
+    vpermq m7, m3, m2
+%elif mmsize == 32
+    vpermq m6, m6, q3120
+    vpermq m7, m2, q3120
+%else
+    mova m7, m2
+%endif
+%else ; 420
+    movu m_y, [py_2indexq + 2 * indexq]
+%if mmsize >= 32
+    pmovzxbw m_u, [pu_indexq + indexq]
+    pmovzxbw m_v, [pv_indexq + indexq]
+    mova m7, m6
+%else
     movh m_u, [pu_indexq  +     indexq]
     movh m_v, [pv_indexq  +     indexq]
     pxor m4, m4
     mova m7, m6
     punpcklbw m0, m4
     punpcklbw m1, m4
+%endif
     mova m2, [pw_00ff]
     pand m6, m2
     psrlw m7, 8
-    psllw m0, 3
-    psllw m1, 3
-    psllw m6, 3
-    psllw m7, 3
+%endif ; 420p10/420
+%endif ; 444
+    psllw m0, yuv_shift
+    psllw m1, yuv_shift
+    psllw m6, yuv_shift
+    psllw m7, yuv_shift
+%ifidn %4, 444
+    ; one chroma sample per pixel: compute the odd pixels first, then the
+    ; even ones, and rename the registers to the 4:2:0 layout for packing
+    psubsw m0, u_offset
+    psubsw m1, v_offset
+    psubsw m4, u_offset
+    psubsw m5, v_offset
+    psubw  m6, y_offset
+    psubw  m7, y_offset
+    pmulhw m6, y_coff
+    pmulhw m7, y_coff
+    pmulhw m2, m0, ug_coff
+    pmulhw m3, m1, vg_coff
+    pmulhw m0, ub_coff
+    pmulhw m1, vr_coff
+    paddsw m2, m3
+    paddsw m0, m7 ; B1 B3 B5 B7 ...
+    paddsw m1, m7 ; R1 R3 R5 R7 ...
+    paddsw m7, m2 ; G1 G3 G5 G7 ...
+    pmulhw m2, m4, ug_coff
+    pmulhw m3, m5, vg_coff
+    pmulhw m4, ub_coff
+    pmulhw m5, vr_coff
+    paddsw m2, m3
+    paddsw m4, m6 ; B0 B2 B4 B6 ...
+    paddsw m5, m6 ; R0 R2 R4 R6 ...
+    paddsw m2, m6 ; G0 G2 G4 G6 ...
+    SWAP 0, 4
+    SWAP 1, 5
+    SWAP 3, 4
+%else ; 420/420p10
 %if (ARCH_X86_32 && mmsize == 16)
     VBROADCASTSD m2, mu_offset
     VBROADCASTSD m3, mv_offset
@@ -199,6 +296,7 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
     paddsw m0, m6 ; B0 B2 B4 B6 ...
     paddsw m1, m6 ; R0 R2 R4 R6 ...
     paddsw m2, m6 ; G0 G2 G4 G6 ...
+%endif ; 444
 
 %if %3 == 24 ; PACK RGB24
 %define depth 3
@@ -249,7 +347,7 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
     movd [imageq + 20], m2 ; -- -- G7 B7
     movd [imageq + 18], m5 ; R6 G6 B6 R7
 %endif ; mmsize = 8
-%else ; mmsize == 16
+%else ; mmsize == 16/32/64
     pshufb m3, [rgb24_shuf1] ; r0  g0  r6  g6  r12 g12 r2  g2  r8  g8  r14 g14 r4  g4  r10 g10
     pshufb m6, [rgb24_shuf2] ; b10 r11 b0  r1  b6  r7  b12 r13 b2  r3  b8  r9  b14 r15 b4  r5
     pshufb m2, [rgb24_shuf3] ; g5  b5  g11 b11 g1  b1  g7  b7  g13 b13 g3  b3  g9  b9  g15 b15
@@ -271,10 +369,29 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
     por    m2, m7
     por    m1, m6          ; g5  b5  r6  g6  b6  r7  g7  b7  r8  g8  b8  r9  g9  b9  r10 g10
     por    m2, m3          ; b10 r11 g11 b11 r12 g12 b12 r13 g13 b13 r14 g14 b14 r15 g15 b15
+%if mmsize == 64
+    ; each lane holds 16 pixels, store the 4 x 48 bytes in order
+%assign i 0
+%rep 4
+    vextracti32x4 [imageq + 48 * i],      m0, i
+    vextracti32x4 [imageq + 48 * i + 16], m1, i
+    vextracti32x4 [imageq + 48 * i + 32], m2, i
+%assign i i+1
+%endrep
+%elif mmsize == 32
+    ; each lane holds 16 pixels, put the 2 x 48 bytes back in order
+    vperm2i128 m3, m0, m1, 0x20
+    vperm2i128 m4, m2, m0, 0x30
+    vperm2i128 m5, m1, m2, 0x31
+    movu [imageq], m3
+    movu [imageq + 32], m4
+    movu [imageq + 64], m5
+%else
     movu [imageq], m0
     movu [imageq + 16], m1
     movu [imageq + 32], m2
-%endif ; mmsize = 16
+%endif
+%endif ; mmsize = 16/32/64
 %else ; PACK RGB15/16/32
     packuswb m0, m1
     packuswb m3, m5
@@ -287,7 +404,11 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
 %if %3 == 32 ; PACK RGB32
 %define depth 4
 %ifidn %1, yuv
+%if mmsize == 64
+    vpternlogd m3, m3, m3, 0xff ; Set alpha empty
+%else
     pcmpeqd m3, m3 ; Set alpha empty
+%endif
 %else
     movu m3, [pa_2indexq + 2 * indexq] ; Load alpha
 %endif
@@ -303,10 +424,35 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
     punpckhwd m_green, m_red
     punpcklwd m5, m6
     punpckhwd m_alpha, m6
+%if mmsize == 64
+    ; transpose the 4 x 4 lanes of 4 pixels
+    vshufi64x2 m4, m_blue, m_green, q1010 ; A0 A1 B0 B1
+    vshufi64x2 m6, m5, m_alpha, q1010     ; C0 C1 D0 D1
+    vshufi64x2 m_blue, m_blue, m_green, q3232
+    vshufi64x2 m5, m5, m_alpha, q3232
+    vshufi64x2 m_green, m4, m6, q2020     ; A0 B0 C0 D0
+    vshufi64x2 m4, m4, m6, q3131
+    vshufi64x2 m6, m_blue, m5, q2020
+    vshufi64x2 m_blue, m_blue, m5, q3131
+    movu [imageq + 0], m_green
+    movu [imageq + 64], m4
+    movu [imageq + 128], m6
+    movu [imageq + 192], m_blue
+%elif mmsize == 32
+    vperm2i128 m4, m_blue, m_green, 0x20
+    vperm2i128 m6, m5, m_alpha, 0x20
+    vperm2i128 m_blue, m_blue, m_green, 0x31
+    vperm2i128 m5, m5, m_alpha, 0x31
+    movu [imageq + 0], m4
+    movu [imageq + 32], m6
+    movu [imageq + 64], m_blue
+    movu [imageq + 96], m5
+%else
     movu [imageq + 0], m_blue
     movu [imageq + 8  * time_num], m_green
     movu [imageq + 16 * time_num], m5
     movu [imageq + 24 * time_num], m_alpha
+%endif
 %else ; PACK RGB15/16
 %define depth 2
 %if cpuflag(ssse3)
@@ -345,14 +491,44 @@ cglobal %1_420_%2%3, GPR_num, GPR_num, reg_num, parameters
     mova m2, m0
     punpcklbw m0, m1
     punpckhbw m2, m1
+%if mmsize == 64
+    vshufi64x2 m1, m0, m2, q1010
+    vshufi64x2 m0, m0, m2, q3232
+    vshufi64x2 m1, m1, m1, q3120
+    vshufi64x2 m0, m0, m0, q3120
+    movu [imageq], m1
+    movu [imageq + 64], m0
+%elif mmsize == 32
+    vperm2i128 m1, m0, m2, 0x20
+    vperm2i128 m0, m0, m2, 0x31
+    movu [imageq], m1
+    movu [imageq + 32], m0
+%else
     movu [imageq], m0
     movu [imageq + 8 * time_num], m2
+%endif
 %endif ; PACK RGB15/16
 %endif ; PACK RGB15/16/32
 
+%if mmsize >= 16
+add indexq, 4 * time_num
+jge .end
+add imageq, 8 * depth * time_num
+cmp indexq, -4 * time_num
+jle .loop0
+; less than a full vector left: move back so that the last iteration
+; ends at the end of the line, recomputing a few pixels
+add indexq, 4 * time_num
+imul indexq, 2 * depth
+sub imageq, indexq
+mov indexq, -4 * time_num
+jmp .loop0
+.end:
+%else
 add imageq, 8 * depth * time_num
 add indexq, 4 * time_num
 js .loop0
+%endif
 
 RET
 
@@ -370,12 +546,36 @@ INIT_MMX mmxext
 yuv2rgb_fn yuv, rgb, 24
 yuv2rgb_fn yuv, bgr, 24
 
+%macro yuv2rgb_fns 1 ; input
+yuv2rgb_fn yuv,  rgb, 24, %1
+yuv2rgb_fn yuv,  bgr, 24, %1
+yuv2rgb_fn yuv,  rgb, 32, %1
+yuv2rgb_fn yuv,  bgr, 32, %1
+%ifnidn %1, 420p10
+yuv2rgb_fn yuva, rgb, 32, %1
+yuv2rgb_fn yuva, bgr, 32, %1
+%endif
+yuv2rgb_fn yuv,  rgb, 15, %1
+yuv2rgb_fn yuv,  rgb, 16, %1
+%endmacro
+
 INIT_XMM ssse3
-yuv2rgb_fn yuv,  rgb, 24
-yuv2rgb_fn yuv,  bgr, 24
-yuv2rgb_fn yuv,  rgb, 32
-yuv2rgb_fn yuv,  bgr, 32
-yuv2rgb_fn yuva, rgb, 32
-yuv2rgb_fn yuva, bgr, 32
-yuv2rgb_fn yuv,  rgb, 15
-yuv2rgb_fn yuv,  rgb, 16
+yuv2rgb_fns 420
+%if ARCH_X86_64
+yuv2rgb_fns 444
+yuv2rgb_fns 420p10
+%endif
+
+%if ARCH_X86_64 && HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+yuv2rgb_fns 420
+yuv2rgb_fns 444
+yuv2rgb_fns 420p10
+%endif
+
+%if ARCH_X86_64 && HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+yuv2rgb_fns 420
+yuv2rgb_fns 444
+yuv2rgb_fns 420p10
+%endif
@@ -690,6 +690,12 @@ SwsFunc ff_yuv2rgb_get_func_ptr(SwsContext *c)
     if (t)
         return t;
 
+    /* there are no C versions for the other inputs, the scaler handles them */
+    if (c->srcFormat != AV_PIX_FMT_YUV420P &&
+        c->srcFormat != AV_PIX_FMT_YUV422P &&
+        c->srcFormat != AV_PIX_FMT_YUVA420P)
+        return NULL;
+
     av_log(c, AV_LOG_WARNING,
            "No accelerated colorspace conversion found from %s to %s.\n",
            av_get_pix_fmt_name(c->srcFormat), av_get_pix_fmt_name(c->dstFormat));
@@ -173,6 +173,9 @@ static const struct {
     #endif
 #endif
 #if CONFIG_AVFILTER
+    #if CONFIG_ADM_FILTER
+        { "vf_adm", checkasm_check_vf_adm },
+    #endif
     #if CONFIG_AFIR_FILTER
         { "af_afir", checkasm_check_afir },
     #endif
@@ -191,20 +194,45 @@ static const struct {
     #if CONFIG_HFLIP_FILTER
         { "vf_hflip", checkasm_check_vf_hflip },
     #endif
+    #if CONFIG_IDET_FILTER
+        { "vf_idet", checkasm_check_vf_idet },
+    #endif
     #if CONFIG_NLMEANS_FILTER
         { "vf_nlmeans", checkasm_check_nlmeans },
     #endif
     #if CONFIG_THRESHOLD_FILTER
         { "vf_threshold", checkasm_check_vf_threshold },
     #endif
+    #if CONFIG_TMIX_FILTER
+        { "vf_tmix", checkasm_check_vf_tmix },
+    #endif
     #if CONFIG_SOBEL_FILTER
         { "vf_sobel", checkasm_check_vf_sobel },
     #endif
+    #if CONFIG_TONEMAP_FILTER
+        { "vf_tonemap", checkasm_check_vf_tonemap },
+    #endif
+    #if CONFIG_VIF_FILTER
+        { "vf_vif", checkasm_check_vf_vif },
+    #endif
+    #if CONFIG_VMAFMOTION_FILTER
+        { "vf_vmafmotion", checkasm_check_vf_vmafmotion },
+    #endif
+    #if CONFIG_LENSCORRECTION_FILTER || CONFIG_PERSPECTIVE_FILTER || \
+        CONFIG_REMAP_FILTER || CONFIG_V360_FILTER
+        { "vf_warp", checkasm_check_vf_warp },
+    #endif
+#endif
+#if CONFIG_SWRESAMPLE
+    { "swr_dither", checkasm_check_swr_dither },
+    { "swr_rematrix", checkasm_check_swr_rematrix },
+    { "swr_resample", checkasm_check_swr_resample },
 #endif
 #if CONFIG_SWSCALE
     { "sw_gbrp", checkasm_check_sw_gbrp },
     { "sw_rgb", checkasm_check_sw_rgb },
     { "sw_scale", checkasm_check_sw_scale },
+    { "sw_yuv2rgb", checkasm_check_sw_yuv2rgb },
 #endif
 #if CONFIG_AVUTIL
         { "fixed_dsp", checkasm_check_fixed_dsp },
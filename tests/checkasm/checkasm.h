@@ -75,18 +75,29 @@ void checkasm_check_opusdsp(void);
 void checkasm_check_pixblockdsp(void);
 void checkasm_check_sbrdsp(void);
 void checkasm_check_synth_filter(void);
+void checkasm_check_swr_dither(void);
+void checkasm_check_swr_rematrix(void);
+void checkasm_check_swr_resample(void);
 void checkasm_check_sw_gbrp(void);
 void checkasm_check_sw_rgb(void);
 void checkasm_check_sw_scale(void);
+void checkasm_check_sw_yuv2rgb(void);
 void checkasm_check_utvideodsp(void);
 void checkasm_check_v210dec(void);
 void checkasm_check_v210enc(void);
 void checkasm_check_vc1dsp(void);
+void checkasm_check_vf_adm(void);
 void checkasm_check_vf_eq(void);
 void checkasm_check_vf_gblur(void);
 void checkasm_check_vf_hflip(void);
+void checkasm_check_vf_idet(void);
 void checkasm_check_vf_threshold(void);
+void checkasm_check_vf_tmix(void);
 void checkasm_check_vf_sobel(void);
+void checkasm_check_vf_tonemap(void);
+void checkasm_check_vf_vif(void);
+void checkasm_check_vf_vmafmotion(void);
+void checkasm_check_vf_warp(void);
 void checkasm_check_vp8dsp(void);
 void checkasm_check_vp9dsp(void);
 void checkasm_check_videodsp(void);
@@ -142,6 +142,16 @@ static void check_output_yuv2gbrp(void)
     ctx->yuv2rgb_u2g_coeff = rnd();
     ctx->yuv2rgb_u2b_coeff = rnd();
 
+    /* float output normalization */
+    for (i = 0; i < 4; i++) {
+        const float mul = (rnd() % 1000 + 1) / (1000.0f * 65535.0f);
+        const float add = (int)(rnd() % 2001 - 1000) / 1000.0f;
+        for (int j = 0; j < 8; j++) {
+            ctx->float_norm_mul[i][j] = mul;
+            ctx->float_norm_add[i][j] = add;
+        }
+    }
+
     for (fmi = 0; fmi < FF_ARRAY_ELEMS(planar_fmts); fmi++) {
         for (fsi = 0; fsi < FILTER_SIZES; fsi++) {
             for (isi = 0; isi < INPUT_SIZES; isi++ ) {
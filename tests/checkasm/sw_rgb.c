@@ -22,8 +22,11 @@
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
 
 #include "libswscale/rgb2rgb.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
 
 #include "checkasm.h"
 
@@ -179,8 +182,621 @@ static void check_interleave_bytes(void)
     }
 }
 
+#define MAX_LINE_SIZE 1920
+static void check_interleave_words(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src0_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, src1_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, dst0_buf, [2*MAX_STRIDE*MAX_HEIGHT+4]);
+    LOCAL_ALIGNED_16(uint8_t, dst1_buf, [2*MAX_STRIDE*MAX_HEIGHT+4]);
+    uint8_t *src0 = src0_buf + 2;
+    uint8_t *src1 = src1_buf + 2;
+    uint8_t *dst0 = dst0_buf + 4;
+    uint8_t *dst1 = dst1_buf + 4;
+
+    declare_func(void, const uint8_t *, const uint8_t *, uint8_t *,
+                 int, int, int, int, int, int);
+
+    randomize_buffers(src0, MAX_STRIDE * MAX_HEIGHT);
+    randomize_buffers(src1, MAX_STRIDE * MAX_HEIGHT);
+
+    if (check_func(interleaveWords, "interleave_words")) {
+        for (int i = 0; i <= 16; i++) {
+            // Try all widths [1,16], and try one random width.
+            int w = i > 0 ? i : (1 + (rnd() % (MAX_STRIDE/2-2)));
+            int h = 1 + (rnd() % (MAX_HEIGHT-2));
+            int shift = rnd() % 16;
+
+            int src0_offset = 0, src0_stride = MAX_STRIDE;
+            int src1_offset = 0, src1_stride = MAX_STRIDE;
+            int dst_offset  = 0, dst_stride  = 2 * MAX_STRIDE;
+
+            memset(dst0, 0, 2 * MAX_STRIDE * MAX_HEIGHT);
+            memset(dst1, 0, 2 * MAX_STRIDE * MAX_HEIGHT);
+
+            if (i & 1) {
+                src0_offset = (h-1)*src0_stride;
+                src0_stride = -src0_stride;
+            }
+            if (i & 2) {
+                src1_offset = (h-1)*src1_stride;
+                src1_stride = -src1_stride;
+            }
+            if (i & 4) {
+                dst_offset = (h-1)*dst_stride;
+                dst_stride = -dst_stride;
+            }
+
+            call_ref(src0 + src0_offset, src1 + src1_offset, dst0 + dst_offset,
+                     w, h, src0_stride, src1_stride, dst_stride, shift);
+            call_new(src0 + src0_offset, src1 + src1_offset, dst1 + dst_offset,
+                     w, h, src0_stride, src1_stride, dst_stride, shift);
+            checkasm_check(uint16_t, (uint16_t *)dst0, 2*MAX_STRIDE,
+                           (uint16_t *)dst1, 2*MAX_STRIDE, 2 * w + 2, h + 1, "dst");
+        }
+
+        bench_new(src0_buf, src1_buf, dst1_buf, MAX_STRIDE/2, MAX_HEIGHT,
+                  MAX_STRIDE, MAX_STRIDE, 2*MAX_STRIDE, 6);
+    }
+}
+
+static void check_deinterleave_words(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src_buf,   [2*MAX_STRIDE*MAX_HEIGHT+4]);
+    LOCAL_ALIGNED_16(uint8_t, dst0u_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, dst0v_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1u_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1v_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    uint8_t *src   = src_buf   + 4;
+    uint8_t *dst0u = dst0u_buf + 2;
+    uint8_t *dst0v = dst0v_buf + 2;
+    uint8_t *dst1u = dst1u_buf + 2;
+    uint8_t *dst1v = dst1v_buf + 2;
+
+    declare_func(void, const uint8_t *src, uint8_t *dst1, uint8_t *dst2,
+                 int width, int height, int srcStride,
+                 int dst1Stride, int dst2Stride, int shift);
+
+    randomize_buffers(src, 2 * MAX_STRIDE * MAX_HEIGHT);
+
+    if (check_func(deinterleaveWords, "deinterleave_words")) {
+        for (int i = 0; i <= 16; i++) {
+            // Try all widths [1,16], and try one random width.
+            int w = i > 0 ? i : (1 + (rnd() % (MAX_STRIDE/2-2)));
+            int h = 1 + (rnd() % (MAX_HEIGHT-2));
+            int shift = rnd() % 16;
+
+            int src_offset   = 0, src_stride    = 2 * MAX_STRIDE;
+            int dst_u_offset = 0, dst_u_stride  = MAX_STRIDE;
+            int dst_v_offset = 0, dst_v_stride  = MAX_STRIDE;
+
+            memset(dst0u, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst0v, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst1u, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst1v, 0, MAX_STRIDE * MAX_HEIGHT);
+
+            if (i & 1) {
+                src_offset = (h-1)*src_stride;
+                src_stride = -src_stride;
+            }
+            if (i & 2) {
+                dst_u_offset = (h-1)*dst_u_stride;
+                dst_u_stride = -dst_u_stride;
+            }
+            if (i & 4) {
+                dst_v_offset = (h-1)*dst_v_stride;
+                dst_v_stride = -dst_v_stride;
+            }
+
+            call_ref(src + src_offset, dst0u + dst_u_offset, dst0v + dst_v_offset,
+                     w, h, src_stride, dst_u_stride, dst_v_stride, shift);
+            call_new(src + src_offset, dst1u + dst_u_offset, dst1v + dst_v_offset,
+                     w, h, src_stride, dst_u_stride, dst_v_stride, shift);
+            checkasm_check(uint16_t, (uint16_t *)dst0u, MAX_STRIDE,
+                           (uint16_t *)dst1u, MAX_STRIDE, w + 1, h + 1, "dst_u");
+            checkasm_check(uint16_t, (uint16_t *)dst0v, MAX_STRIDE,
+                           (uint16_t *)dst1v, MAX_STRIDE, w + 1, h + 1, "dst_v");
+        }
+
+        bench_new(src_buf, dst1u_buf, dst1v_buf, MAX_STRIDE/2, MAX_HEIGHT,
+                  2*MAX_STRIDE, MAX_STRIDE, MAX_STRIDE, 6);
+    }
+}
+
+static void check_shift_words(void)
+{
+    LOCAL_ALIGNED_16(uint8_t, src_buf,  [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, dst0_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1_buf, [MAX_STRIDE*MAX_HEIGHT+2]);
+    uint8_t *src  = src_buf  + 2;
+    uint8_t *dst0 = dst0_buf + 2;
+    uint8_t *dst1 = dst1_buf + 2;
+
+    declare_func(void, const uint8_t *src, uint8_t *dst, int width, int height,
+                 int srcStride, int dstStride, int shift);
+
+    randomize_buffers(src, MAX_STRIDE * MAX_HEIGHT);
+
+    if (check_func(shiftWords, "shift_words")) {
+        for (int i = 0; i <= 16; i++) {
+            // Try all widths [1,16], and try one random width.
+            int w = i > 0 ? i : (1 + (rnd() % (MAX_STRIDE/2-2)));
+            int h = 1 + (rnd() % (MAX_HEIGHT-2));
+            int shift = (int)(rnd() % 31) - 15;
+
+            int src_offset = 0, src_stride = MAX_STRIDE;
+            int dst_offset = 0, dst_stride = MAX_STRIDE;
+
+            memset(dst0, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst1, 0, MAX_STRIDE * MAX_HEIGHT);
+
+            if (i & 1) {
+                src_offset = (h-1)*src_stride;
+                src_stride = -src_stride;
+            }
+            if (i & 2) {
+                dst_offset = (h-1)*dst_stride;
+                dst_stride = -dst_stride;
+            }
+
+            call_ref(src + src_offset, dst0 + dst_offset, w, h,
+                     src_stride, dst_stride, shift);
+            call_new(src + src_offset, dst1 + dst_offset, w, h,
+                     src_stride, dst_stride, shift);
+            checkasm_check(uint16_t, (uint16_t *)dst0, MAX_STRIDE,
+                           (uint16_t *)dst1, MAX_STRIDE, w + 1, h + 1, "dst");
+        }
+
+        bench_new(src_buf, dst1_buf, MAX_STRIDE/2, MAX_HEIGHT,
+                  MAX_STRIDE, MAX_STRIDE, -6);
+    }
+}
+
+static void check_y210_to_yuv422p10(void)
+{
+    int i;
+
+    LOCAL_ALIGNED_32(uint8_t, src,     [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_y_0, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst_y_1, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst_u_0, [(MAX_STRIDE/2) * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst_u_1, [(MAX_STRIDE/2) * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst_v_0, [(MAX_STRIDE/2) * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst_v_1, [(MAX_STRIDE/2) * MAX_HEIGHT]);
+
+    declare_func(void, uint8_t *ydst, uint8_t *udst, uint8_t *vdst,
+                 const uint8_t *src, int width, int height,
+                 int lumStride, int chromStride, int srcStride);
+
+    randomize_buffers(src, MAX_STRIDE * MAX_HEIGHT * 2);
+
+    if (check_func(y210toyuv422p10, "y210toyuv422p10")) {
+        for (i = 0; i < 6; i ++) {
+            int w = planes[i].w / 2, s = planes[i].s * 2;
+
+            memset(dst_y_0, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst_y_1, 0, MAX_STRIDE * MAX_HEIGHT);
+            memset(dst_u_0, 0, (MAX_STRIDE/2) * MAX_HEIGHT);
+            memset(dst_u_1, 0, (MAX_STRIDE/2) * MAX_HEIGHT);
+            memset(dst_v_0, 0, (MAX_STRIDE/2) * MAX_HEIGHT);
+            memset(dst_v_1, 0, (MAX_STRIDE/2) * MAX_HEIGHT);
+
+            call_ref(dst_y_0, dst_u_0, dst_v_0, src, w, planes[i].h,
+                     MAX_STRIDE, MAX_STRIDE / 2, s);
+            call_new(dst_y_1, dst_u_1, dst_v_1, src, w, planes[i].h,
+                     MAX_STRIDE, MAX_STRIDE / 2, s);
+            if (memcmp(dst_y_0, dst_y_1, MAX_STRIDE * MAX_HEIGHT) ||
+                memcmp(dst_u_0, dst_u_1, (MAX_STRIDE/2) * MAX_HEIGHT) ||
+                memcmp(dst_v_0, dst_v_1, (MAX_STRIDE/2) * MAX_HEIGHT))
+                fail();
+        }
+        bench_new(dst_y_1, dst_u_1, dst_v_1, src, MAX_STRIDE / 2, MAX_HEIGHT,
+                  MAX_STRIDE, MAX_STRIDE / 2, MAX_STRIDE * 2);
+    }
+}
+
+static void check_yuv422p10_to_y210(void)
+{
+    int i;
+
+    LOCAL_ALIGNED_32(uint8_t, src_y, [MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, src_u, [(MAX_STRIDE/2) * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, src_v, [(MAX_STRIDE/2) * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,  [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,  [MAX_STRIDE * MAX_HEIGHT * 2]);
+
+    declare_func(void, const uint8_t *ysrc, const uint8_t *usrc, const uint8_t *vsrc,
+                 uint8_t *dst, int width, int height,
+                 int lumStride, int chromStride, int dstStride);
+
+    randomize_buffers(src_y, MAX_STRIDE * MAX_HEIGHT);
+    randomize_buffers(src_u, (MAX_STRIDE/2) * MAX_HEIGHT);
+    randomize_buffers(src_v, (MAX_STRIDE/2) * MAX_HEIGHT);
+
+    if (check_func(yuv422p10toy210, "yuv422p10toy210")) {
+        for (i = 0; i < 6; i ++) {
+            int w = planes[i].w / 2, s = planes[i].s * 2;
+
+            memset(dst0, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+            memset(dst1, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+
+            call_ref(src_y, src_u, src_v, dst0, w, planes[i].h,
+                     MAX_STRIDE, MAX_STRIDE / 2, s);
+            call_new(src_y, src_u, src_v, dst1, w, planes[i].h,
+                     MAX_STRIDE, MAX_STRIDE / 2, s);
+            if (memcmp(dst0, dst1, MAX_STRIDE * MAX_HEIGHT * 2))
+                fail();
+        }
+        bench_new(src_y, src_u, src_v, dst1, MAX_STRIDE / 2, MAX_HEIGHT,
+                  MAX_STRIDE, MAX_STRIDE / 2, MAX_STRIDE * 2);
+    }
+}
+
+static void check_packed30(void)
+{
+    static const uint32_t pads[] = { 0, 3U << 30 };
+    LOCAL_ALIGNED_32(uint8_t, src,   [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0,  [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1,  [MAX_STRIDE * MAX_HEIGHT * 2]);
+    LOCAL_ALIGNED_32(uint8_t, plane0, [3 * MAX_STRIDE * MAX_HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, plane1, [3 * MAX_STRIDE * MAX_HEIGHT]);
+    const int plane_size = MAX_STRIDE * MAX_HEIGHT;
+    int i;
+
+    randomize_buffers(src, MAX_STRIDE * MAX_HEIGHT * 2);
+
+    if (check_func(packed30toplanar, "packed30toplanar")) {
+        declare_func(void, const uint8_t *src, uint8_t *dst0, uint8_t *dst1,
+                     uint8_t *dst2, int width, int height,
+                     int srcStride, int dstStride);
+
+        for (i = 0; i < 6; i++) {
+            int w = planes[i].w / 2, s = planes[i].s * 2;
+
+            memset(plane0, 0, 3 * plane_size);
+            memset(plane1, 0, 3 * plane_size);
+
+            call_ref(src, plane0, plane0 + plane_size, plane0 + 2 * plane_size,
+                     w, planes[i].h, s, MAX_STRIDE);
+            call_new(src, plane1, plane1 + plane_size, plane1 + 2 * plane_size,
+                     w, planes[i].h, s, MAX_STRIDE);
+            if (memcmp(plane0, plane1, 3 * plane_size))
+                fail();
+        }
+        bench_new(src, plane1, plane1 + plane_size, plane1 + 2 * plane_size,
+                  MAX_STRIDE / 2, MAX_HEIGHT, MAX_STRIDE * 2, MAX_STRIDE);
+    }
+
+    randomize_buffers(plane0, 3 * plane_size);
+
+    if (check_func(planartopacked30, "planartopacked30")) {
+        declare_func(void, const uint8_t *src0, const uint8_t *src1,
+                     const uint8_t *src2, uint8_t *dst, int width, int height,
+                     int srcStride, int dstStride, uint32_t pad);
+
+        for (i = 0; i < 6; i++) {
+            int w = planes[i].w / 2, s = planes[i].s * 2;
+            uint32_t pad = pads[i & 1];
+
+            memset(dst0, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+            memset(dst1, 0, MAX_STRIDE * MAX_HEIGHT * 2);
+
+            call_ref(plane0, plane0 + plane_size, plane0 + 2 * plane_size, dst0,
+                     w, planes[i].h, MAX_STRIDE, s, pad);
+            call_new(plane0, plane0 + plane_size, plane0 + 2 * plane_size, dst1,
+                     w, planes[i].h, MAX_STRIDE, s, pad);
+            if (memcmp(dst0, dst1, MAX_STRIDE * MAX_HEIGHT * 2))
+                fail();
+        }
+        bench_new(plane0, plane0 + plane_size, plane0 + 2 * plane_size, dst1,
+                  MAX_STRIDE / 2, MAX_HEIGHT, MAX_STRIDE, MAX_STRIDE * 2, pads[1]);
+    }
+}
+
+static void check_bayer_to_rgb(void)
+{
+    static const struct {
+        enum AVPixelFormat src, dst;
+    } fmts[] = {
+        { AV_PIX_FMT_BAYER_BGGR8,    AV_PIX_FMT_RGB24 },
+        { AV_PIX_FMT_BAYER_RGGB8,    AV_PIX_FMT_RGB24 },
+        { AV_PIX_FMT_BAYER_GBRG8,    AV_PIX_FMT_RGB24 },
+        { AV_PIX_FMT_BAYER_GRBG8,    AV_PIX_FMT_RGB24 },
+        { AV_PIX_FMT_BAYER_BGGR16LE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_RGGB16LE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_GBRG16LE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_GRBG16LE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_BGGR16BE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_RGGB16BE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_GBRG16BE, AV_PIX_FMT_RGB48 },
+        { AV_PIX_FMT_BAYER_GRBG16BE, AV_PIX_FMT_RGB48 },
+        /* demosaiced to RGB24 or RGB48 before the YUV conversion */
+        { AV_PIX_FMT_BAYER_BGGR8,    AV_PIX_FMT_YUV420P },
+        { AV_PIX_FMT_BAYER_RGGB16LE, AV_PIX_FMT_YUV420P },
+        { AV_PIX_FMT_BAYER_GBRG16BE, AV_PIX_FMT_YUV420P },
+    };
+    static const int widths[] = {20, 22, 36, MAX_STRIDE};
+    const int src_stride = MAX_STRIDE * 2, dst_stride = MAX_STRIDE * 6;
+    LOCAL_ALIGNED_32(uint8_t, src,  [4 * MAX_STRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [2 * MAX_STRIDE * 6]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [2 * MAX_STRIDE * 6]);
+
+    declare_func(void, const uint8_t *src, int src_stride, uint8_t *dst,
+                 int dst_stride, int width);
+
+    randomize_buffers(src, 4 * src_stride);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        struct SwsContext *ctx = sws_getContext(MAX_STRIDE, 4, fmts[i].src,
+                                                MAX_STRIDE, 4, fmts[i].dst,
+                                                SWS_BILINEAR, NULL, NULL, NULL);
+        if (!ctx) {
+            fail();
+            continue;
+        }
+
+        /* the row pair is interpolated from the rows above and below it */
+        if (check_func(ctx->bayer_interpolate_inner, "%s_to_%s",
+                       av_get_pix_fmt_name(fmts[i].src),
+                       av_get_pix_fmt_name(fmts[i].dst))) {
+            for (int j = 0; j < FF_ARRAY_ELEMS(widths); j++) {
+                memset(dst0, 0, 2 * dst_stride);
+                memset(dst1, 0, 2 * dst_stride);
+
+                call_ref(src + src_stride, src_stride, dst0, dst_stride, widths[j]);
+                call_new(src + src_stride, src_stride, dst1, dst_stride, widths[j]);
+                if (memcmp(dst0, dst1, 2 * dst_stride))
+                    fail();
+            }
+            bench_new(src + src_stride, src_stride, dst1, dst_stride, MAX_STRIDE);
+        }
+        sws_freeContext(ctx);
+    }
+}
+
+static const int input_sizes[] = {16, 21, 40, 128, 144, 256, MAX_LINE_SIZE};
+static const enum AVPixelFormat rgb_formats[] = {
+        AV_PIX_FMT_RGB24,
+        AV_PIX_FMT_BGR24,
+        AV_PIX_FMT_RGBA,
+        AV_PIX_FMT_BGRA,
+        AV_PIX_FMT_ABGR,
+        AV_PIX_FMT_ARGB,
+};
+
+static void check_rgb_to_y(struct SwsContext *ctx)
+{
+    LOCAL_ALIGNED_32(uint8_t, src24,  [MAX_LINE_SIZE * 3 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, src32,  [MAX_LINE_SIZE * 4 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_y, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_y, [MAX_LINE_SIZE * 2]);
+
+    declare_func(void, uint8_t *dst, const uint8_t *src,
+                 const uint8_t *unused1, const uint8_t *unused2, int width,
+                 uint32_t *rgb2yuv, void *opq);
+
+    randomize_buffers(src24, MAX_LINE_SIZE * 3 + 64);
+    randomize_buffers(src32, MAX_LINE_SIZE * 4 + 64);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb_formats); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb_formats[i]);
+        const uint8_t *src = desc->comp[0].step == 3 ? src24 : src32;
+
+        ctx->srcFormat = rgb_formats[i];
+        ff_sws_init_scale(ctx);
+
+        for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+            int w = input_sizes[j];
+
+            if (check_func(ctx->lumToYV12, "%s_to_y_%d", desc->name, w)) {
+                memset(dst0_y, 0xFA, MAX_LINE_SIZE * 2);
+                memset(dst1_y, 0xFA, MAX_LINE_SIZE * 2);
+
+                call_ref(dst0_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, NULL);
+                call_new(dst1_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, NULL);
+
+                if (memcmp(dst0_y, dst1_y, w * 2))
+                    fail();
+
+                bench_new(dst1_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, NULL);
+            }
+        }
+    }
+}
+
+static void check_rgb_to_uv(struct SwsContext *ctx)
+{
+    LOCAL_ALIGNED_32(uint8_t, src24,  [MAX_LINE_SIZE * 3 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, src32,  [MAX_LINE_SIZE * 4 + 64]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_u, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_v, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_u, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_v, [MAX_LINE_SIZE * 2]);
+
+    declare_func(void, uint8_t *dstU, uint8_t *dstV,
+                 const uint8_t *src1, const uint8_t *src2, const uint8_t *src3,
+                 int width, uint32_t *pal, void *opq);
+
+    randomize_buffers(src24, MAX_LINE_SIZE * 3 + 64);
+    randomize_buffers(src32, MAX_LINE_SIZE * 4 + 64);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb_formats); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb_formats[i]);
+        const uint8_t *src = desc->comp[0].step == 3 ? src24 : src32;
+
+        /* only the full resolution chroma readers have SIMD versions */
+        ctx->srcFormat        = rgb_formats[i];
+        ctx->chrSrcHSubSample = 0;
+        ff_sws_init_scale(ctx);
+
+        for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+            int w = input_sizes[j];
+
+            if (check_func(ctx->chrToYV12, "%s_to_uv_%d", desc->name, w)) {
+                memset(dst0_u, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst0_v, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst1_u, 0xFF, MAX_LINE_SIZE * 2);
+                memset(dst1_v, 0xFF, MAX_LINE_SIZE * 2);
+
+                call_ref(dst0_u, dst0_v, NULL, src, src, w, ctx->input_rgb2yuv_table, NULL);
+                call_new(dst1_u, dst1_v, NULL, src, src, w, ctx->input_rgb2yuv_table, NULL);
+
+                if (memcmp(dst0_u, dst1_u, w * 2) ||
+                    memcmp(dst0_v, dst1_v, w * 2))
+                    fail();
+
+                bench_new(dst1_u, dst1_v, NULL, src, src, w, ctx->input_rgb2yuv_table, NULL);
+            }
+        }
+    }
+}
+
+static const enum AVPixelFormat rgb16_formats[] = {
+        AV_PIX_FMT_RGB48LE,
+        AV_PIX_FMT_RGBA64LE,
+};
+
+/* gamma table with the extra entry read by the gathers */
+static uint16_t gamma_lut[(1 << 16) + 1];
+
+static void check_rgb16_linear(struct SwsContext *ctx)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,    [MAX_LINE_SIZE * 16]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_y, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_y, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_u, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst0_v, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_u, [MAX_LINE_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1_v, [MAX_LINE_SIZE * 2]);
+
+    randomize_buffers(src, MAX_LINE_SIZE * 16);
+
+    ctx->is_internal_gamma = 1;
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb16_formats); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb16_formats[i]);
+
+        ctx->srcFormat = rgb16_formats[i];
+        for (int sub = 0; sub < 2; sub++) {
+            ctx->chrSrcHSubSample = sub;
+            ff_sws_init_scale(ctx);
+
+            for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+                int w = input_sizes[j];
+
+                if (!sub && check_func(ctx->lumToYV12, "%s_linear_to_y_%d", desc->name, w)) {
+                    declare_func(void, uint8_t *dst, const uint8_t *src,
+                                 const uint8_t *unused1, const uint8_t *unused2, int width,
+                                 uint32_t *rgb2yuv, void *opq);
+
+                    memset(dst0_y, 0xFA, MAX_LINE_SIZE * 2);
+                    memset(dst1_y, 0xFA, MAX_LINE_SIZE * 2);
+
+                    call_ref(dst0_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, gamma_lut);
+                    call_new(dst1_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, gamma_lut);
+
+                    if (memcmp(dst0_y, dst1_y, MAX_LINE_SIZE * 2))
+                        fail();
+
+                    bench_new(dst1_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table, gamma_lut);
+                }
+
+                if (check_func(ctx->chrToYV12, "%s_linear_to_uv%s_%d", desc->name,
+                               sub ? "_half" : "", w)) {
+                    declare_func(void, uint8_t *dstU, uint8_t *dstV,
+                                 const uint8_t *src1, const uint8_t *src2, const uint8_t *src3,
+                                 int width, uint32_t *pal, void *opq);
+
+                    memset(dst0_u, 0xFF, MAX_LINE_SIZE * 2);
+                    memset(dst0_v, 0xFF, MAX_LINE_SIZE * 2);
+                    memset(dst1_u, 0xFF, MAX_LINE_SIZE * 2);
+                    memset(dst1_v, 0xFF, MAX_LINE_SIZE * 2);
+
+                    call_ref(dst0_u, dst0_v, NULL, src, src, w, ctx->input_rgb2yuv_table, gamma_lut);
+                    call_new(dst1_u, dst1_v, NULL, src, src, w, ctx->input_rgb2yuv_table, gamma_lut);
+
+                    if (memcmp(dst0_u, dst1_u, MAX_LINE_SIZE * 2) ||
+                        memcmp(dst0_v, dst1_v, MAX_LINE_SIZE * 2))
+                        fail();
+
+                    bench_new(dst1_u, dst1_v, NULL, src, src, w, ctx->input_rgb2yuv_table, gamma_lut);
+                }
+            }
+        }
+    }
+    ctx->is_internal_gamma = 0;
+}
+
+static void rgb16_gamma_c(uint16_t *line, const uint16_t *lut, int w, int step)
+{
+    for (int i = 0; i < w * step; i += step) {
+        line[i + 0] = lut[line[i + 0]];
+        line[i + 1] = lut[line[i + 1]];
+        line[i + 2] = lut[line[i + 2]];
+    }
+}
+
+static void rgb48le_gamma_c(uint16_t *line, const uint16_t *lut, int w)
+{
+    rgb16_gamma_c(line, lut, w, 3);
+}
+
+static void rgba64le_gamma_c(uint16_t *line, const uint16_t *lut, int w)
+{
+    rgb16_gamma_c(line, lut, w, 4);
+}
+
+static void check_rgb16_gamma(struct SwsContext *ctx)
+{
+    static void (* const gamma_c[])(uint16_t *line, const uint16_t *lut, int w) = {
+        rgb48le_gamma_c, rgba64le_gamma_c,
+    };
+    LOCAL_ALIGNED_32(uint16_t, src,  [MAX_LINE_SIZE * 4]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [MAX_LINE_SIZE * 4]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [MAX_LINE_SIZE * 4]);
+    enum AVPixelFormat dst_format = ctx->dstFormat;
+
+    declare_func(void, uint16_t *line, const uint16_t *lut, int w);
+
+    randomize_buffers((uint8_t *)src, MAX_LINE_SIZE * 8);
+
+    ctx->is_internal_gamma = 1;
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb16_formats); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb16_formats[i]);
+
+        /* the C version is the loop in gamma_convert() */
+        ctx->dstFormat   = rgb16_formats[i];
+        ctx->rgb16_gamma = NULL;
+        ff_sws_init_scale(ctx);
+        if (!ctx->rgb16_gamma)
+            ctx->rgb16_gamma = gamma_c[i];
+
+        for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+            int w = input_sizes[j] & ~15;
+
+            if (check_func(ctx->rgb16_gamma, "%s_gamma_%d", desc->name, w)) {
+                memcpy(dst0, src, MAX_LINE_SIZE * 8);
+                memcpy(dst1, src, MAX_LINE_SIZE * 8);
+
+                call_ref(dst0, gamma_lut, w);
+                call_new(dst1, gamma_lut, w);
+
+                if (memcmp(dst0, dst1, MAX_LINE_SIZE * 8))
+                    fail();
+
+                bench_new(dst1, gamma_lut, w);
+            }
+        }
+    }
+    ctx->dstFormat         = dst_format;
+    ctx->is_internal_gamma = 0;
+    ctx->rgb16_gamma       = NULL;
+    ff_sws_init_scale(ctx);
+}
+
 void checkasm_check_sw_rgb(void)
 {
+    struct SwsContext *ctx;
+
     ff_sws_rgb2rgb_init();
 
     check_shuffle_bytes(shuffle_bytes_2103, "shuffle_bytes_2103");
@@ -203,4 +819,48 @@ void checkasm_check_sw_rgb(void)
 
     check_interleave_bytes();
     report("interleave_bytes");
+
+    check_interleave_words();
+    report("interleave_words");
+
+    check_deinterleave_words();
+    report("deinterleave_words");
+
+    check_shift_words();
+    report("shift_words");
+
+    check_y210_to_yuv422p10();
+    report("y210toyuv422p10");
+
+    check_yuv422p10_to_y210();
+    report("yuv422p10toy210");
+
+    check_packed30();
+    report("packed30");
+
+    check_bayer_to_rgb();
+    report("bayer_to_rgb");
+
+    ctx = sws_getContext(MAX_LINE_SIZE, MAX_LINE_SIZE, AV_PIX_FMT_RGB24,
+                         MAX_LINE_SIZE, MAX_LINE_SIZE, AV_PIX_FMT_YUV420P,
+                         SWS_ACCURATE_RND | SWS_BITEXACT, NULL, NULL, NULL);
+    if (!ctx)
+        fail();
+
+    check_rgb_to_y(ctx);
+    report("rgb_to_y");
+
+    check_rgb_to_uv(ctx);
+    report("rgb_to_uv");
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(gamma_lut); i++)
+        gamma_lut[i] = rnd();
+
+    check_rgb16_linear(ctx);
+    report("rgb16_linear");
+
+    check_rgb16_gamma(ctx);
+    report("rgb16_gamma");
+
+    sws_freeContext(ctx);
 }
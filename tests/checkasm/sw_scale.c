@@ -253,6 +253,86 @@ static void check_yuv2yuvX(int accurate)
 #undef FILTER_SIZES
 }
 
+static void check_yuv2planeX_hbd(void)
+{
+    struct SwsContext *ctx;
+    int bi, fsi, isi, i;
+    static const int depths[] = { 9, 10, 12, 14, 16 };
+    static const enum AVPixelFormat dst_formats[] = {
+        AV_PIX_FMT_YUV420P9, AV_PIX_FMT_YUV420P10, AV_PIX_FMT_YUV420P12,
+        AV_PIX_FMT_YUV420P14, AV_PIX_FMT_YUV420P16,
+    };
+    static const int filter_sizes[] = { 2, 4, 8, 16 };
+    // odd widths exercise the tail handling of the SIMD versions
+    static const int input_sizes[] = { 1, 7, 24, 129, 255, 512 };
+#define PLANEX_PADDING 64
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    const int16_t *src[LARGEST_FILTER];
+    // 15-bit samples in int16_t for depths up to 14, 19-bit samples in
+    // int32_t for 16, with padding for SIMD overreads
+    LOCAL_ALIGNED_32(int32_t, src_pixels, [LARGEST_FILTER * (LARGEST_INPUT_SIZE + PLANEX_PADDING)]);
+    LOCAL_ALIGNED_32(int16_t, filter_coeff, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_32(uint16_t, dst0, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_32(uint16_t, dst1, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+
+    memset(dither, 0, 8);
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (bi = 0; bi < FF_ARRAY_ELEMS(depths); bi++) {
+        randomize_buffers((uint8_t *)src_pixels,
+                          LARGEST_FILTER * (LARGEST_INPUT_SIZE + PLANEX_PADDING) * sizeof(int32_t));
+        if (depths[bi] == 16) {
+            for (i = 0; i < LARGEST_FILTER * (LARGEST_INPUT_SIZE + PLANEX_PADDING); i++)
+                src_pixels[i] &= 0x7ffff;
+        }
+
+        ctx->dstFormat = dst_formats[bi];
+        ctx->dstBpc    = depths[bi];
+        ff_sws_init_scale(ctx);
+
+        for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+            const int fs = filter_sizes[fsi];
+            // same properties as the filter in check_yuv2yuvX()
+            for (i = 0; i < fs; i++)
+                filter_coeff[i] = -((1 << 12) / (fs - 1));
+            filter_coeff[rnd() % fs] = (1 << 13) - 1;
+            for (i = 0; i < fs; i++) {
+                if (depths[bi] == 16)
+                    src[i] = (const int16_t *)&src_pixels[i * (LARGEST_INPUT_SIZE + PLANEX_PADDING)];
+                else
+                    src[i] = (const int16_t *)src_pixels + i * (LARGEST_INPUT_SIZE + PLANEX_PADDING);
+            }
+
+            for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+                const int dstW = input_sizes[isi];
+                if (check_func(ctx->yuv2planeX, "yuv2planeX_%d_%d_%d", depths[bi], fs, dstW)) {
+                    memset(dst0, 0, LARGEST_INPUT_SIZE * sizeof(dst0[0]));
+                    memset(dst1, 0, LARGEST_INPUT_SIZE * sizeof(dst1[0]));
+
+                    call_ref(filter_coeff, fs, src, (uint8_t *)dst0, dstW, dither, 0);
+                    call_new(filter_coeff, fs, src, (uint8_t *)dst1, dstW, dither, 0);
+                    if (memcmp(dst0, dst1, dstW * sizeof(dst0[0]))) {
+                        fail();
+                        printf("failed: yuv2planeX_%d_%d_%d\n", depths[bi], fs, dstW);
+                        show_differences((uint8_t *)dst0, (uint8_t *)dst1,
+                                         dstW * sizeof(dst0[0]));
+                    }
+                    if (dstW == LARGEST_INPUT_SIZE)
+                        bench_new(filter_coeff, fs, src, (uint8_t *)dst1, dstW, dither, 0);
+                }
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
 #undef SRC_PIXELS
 #define SRC_PIXELS 512
 
@@ -262,10 +342,28 @@ static void check_hscale(void)
 #define FILTER_SIZES 6
     static const int filter_sizes[FILTER_SIZES] = { 4, 8, 12, 16, 32, 40 };
 
-#define HSCALE_PAIRS 2
+#define HSCALE_PAIRS 12
     static const int hscale_pairs[HSCALE_PAIRS][2] = {
-        { 8, 14 },
-        { 8, 18 },
+        {  8, 14 },
+        {  8, 18 },
+        {  9, 14 },
+        {  9, 18 },
+        { 10, 14 },
+        { 10, 18 },
+        { 12, 14 },
+        { 12, 18 },
+        { 14, 14 },
+        { 14, 18 },
+        { 16, 14 },
+        { 16, 18 },
+    };
+    static const enum AVPixelFormat src_formats[17] = {
+        [8]  = AV_PIX_FMT_YUV420P,
+        [9]  = AV_PIX_FMT_YUV420P9,
+        [10] = AV_PIX_FMT_YUV420P10,
+        [12] = AV_PIX_FMT_YUV420P12,
+        [14] = AV_PIX_FMT_YUV420P14,
+        [16] = AV_PIX_FMT_YUV420P16,
     };
 
 #define LARGEST_INPUT_SIZE 512
@@ -275,8 +373,8 @@ static void check_hscale(void)
     int i, j, fsi, hpi, width, dstWi;
     struct SwsContext *ctx;
 
-    // padded
-    LOCAL_ALIGNED_32(uint8_t, src, [FFALIGN(SRC_PIXELS + MAX_FILTER_WIDTH - 1, 4)]);
+    // padded, holds either 8-bit or 16-bit samples
+    LOCAL_ALIGNED_32(uint8_t, src, [FFALIGN(SRC_PIXELS + MAX_FILTER_WIDTH - 1, 4) * 2]);
     LOCAL_ALIGNED_32(uint32_t, dst0, [SRC_PIXELS]);
     LOCAL_ALIGNED_32(uint32_t, dst1, [SRC_PIXELS]);
 
@@ -296,15 +394,21 @@ static void check_hscale(void)
     if (sws_init_context(ctx, NULL, NULL) < 0)
         fail();
 
-    randomize_buffers(src, SRC_PIXELS + MAX_FILTER_WIDTH - 1);
-
     for (hpi = 0; hpi < HSCALE_PAIRS; hpi++) {
+        randomize_buffers(src, (SRC_PIXELS + MAX_FILTER_WIDTH - 1) * 2);
+        if (hscale_pairs[hpi][0] > 8) {
+            uint16_t *src16 = (uint16_t *)src;
+            for (i = 0; i < SRC_PIXELS + MAX_FILTER_WIDTH - 1; i++)
+                src16[i] &= (1 << hscale_pairs[hpi][0]) - 1;
+        }
+
         for (fsi = 0; fsi < FILTER_SIZES; fsi++) {
             for (dstWi = 0; dstWi < INPUT_SIZES; dstWi++) {
                 width = filter_sizes[fsi];
 
                 ctx->srcBpc = hscale_pairs[hpi][0];
                 ctx->dstBpc = hscale_pairs[hpi][1];
+                ctx->srcFormat = src_formats[ctx->srcBpc];
                 ctx->hLumFilterSize = ctx->hChrFilterSize = width;
 
                 for (i = 0; i < SRC_PIXELS; i++) {
@@ -322,12 +426,15 @@ static void check_hscale(void)
                     //   at (1<<15) - 1
                     //
                     // The coefficients sum to the 1.0 point for the hscale
-                    // functions (1 << 14).
+                    // functions (1 << 14). The 16-bit functions rely on the
+                    // sum being exact.
 
                     for (j = 0; j < width; j++) {
                         filter[i * width + j] = -((1 << 14) / (width - 1));
                     }
-                    filter[i * width + (rnd() % width)] = ((1 << 15) - 1);
+                    filter[i * width + (rnd() % width)] = ctx->srcBpc == 16 ?
+                        (1 << 14) + (width - 1) * ((1 << 14) / (width - 1)) :
+                        ((1 << 15) - 1);
                 }
 
                 for (i = 0; i < MAX_FILTER_WIDTH; i++) {
@@ -346,11 +453,11 @@ static void check_hscale(void)
                     memset(dst0, 0, SRC_PIXELS * sizeof(dst0[0]));
                     memset(dst1, 0, SRC_PIXELS * sizeof(dst1[0]));
 
-                    call_ref(NULL, dst0, ctx->dstW, src, filter, filterPos, width);
-                    call_new(NULL, dst1, ctx->dstW, src, filterAvx2, filterPosAvx, width);
+                    call_ref(ctx, dst0, ctx->dstW, src, filter, filterPos, width);
+                    call_new(ctx, dst1, ctx->dstW, src, filterAvx2, filterPosAvx, width);
                     if (memcmp(dst0, dst1, ctx->dstW * sizeof(dst0[0])))
                         fail();
-                    bench_new(NULL, dst0, ctx->dstW, src, filter, filterPosAvx, width);
+                    bench_new(ctx, dst0, ctx->dstW, src, filter, filterPosAvx, width);
                 }
             }
         }
@@ -368,4 +475,6 @@ void checkasm_check_sw_scale(void)
     check_yuv2yuvX(0);
     check_yuv2yuvX(1);
     report("yuv2yuvX");
+    check_yuv2planeX_hbd();
+    report("yuv2planeX_hbd");
 }
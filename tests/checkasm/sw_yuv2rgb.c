@@ -0,0 +1,265 @@
+/*
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/log.h"
+#include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j+=4)       \
+            AV_WN32(buf + j, rnd());      \
+    } while (0)
+
+#define MAX_WIDTH  1920
+#define NUM_LINES  2
+
+static const int dst_fmts[] = {
+    AV_PIX_FMT_RGB24,
+    AV_PIX_FMT_BGR24,
+    AV_PIX_FMT_RGB32,
+    AV_PIX_FMT_BGR32,
+    AV_PIX_FMT_RGB565,
+    AV_PIX_FMT_RGB555,
+};
+
+/* the SIMD versions round the coefficients differently from the C tables */
+static int cmp_line(const uint8_t *ref, const uint8_t *new, int w, int fmt)
+{
+    int i, k;
+
+    if (fmt == AV_PIX_FMT_RGB565 || fmt == AV_PIX_FMT_RGB555) {
+        const int gbits = fmt == AV_PIX_FMT_RGB565 ? 6 : 5;
+        const int shift[3] = { 0, 5, 5 + gbits };
+        const int mask[3]  = { 31, (1 << gbits) - 1, 31 };
+
+        for (i = 0; i < w; i++) {
+            int a = AV_RN16(ref + 2 * i), b = AV_RN16(new + 2 * i);
+            for (k = 0; k < 3; k++)
+                if (FFABS(((a >> shift[k]) & mask[k]) - ((b >> shift[k]) & mask[k])) > 2)
+                    return 1;
+        }
+    } else {
+        const int bpp = av_get_bits_per_pixel(av_pix_fmt_desc_get(fmt)) >> 3;
+        for (i = 0; i < w * bpp; i++)
+            if (FFABS(ref[i] - new[i]) > 3)
+                return 1;
+    }
+    return 0;
+}
+
+/* nothing may be written past the end of the line */
+static int check_guard(const uint8_t *line, int w, int stride, int fmt)
+{
+    /* rounded up, RGB555 has 15 bits per pixel */
+    const int bpp = (av_get_bits_per_pixel(av_pix_fmt_desc_get(fmt)) + 7) >> 3;
+    int i;
+
+    for (i = w * bpp; i < stride; i++)
+        if (line[i] != 0xFF)
+            return 1;
+    return 0;
+}
+
+#if ARCH_X86
+/* exact model of the SIMD arithmetic, for the inputs without a C version */
+static void yuv2rgb_ref(struct SwsContext *c, const uint8_t *src[], const int src_stride[],
+                        uint8_t *dst, int dst_stride, int w, int fmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const int high  = desc->comp[0].depth > 8;
+    const int shift = high ? 1 : 3;
+    const int16_t y_coeff  = c->yCoeff,  y_offset = c->yOffset;
+    const int16_t u_offset = c->uOffset, v_offset = c->vOffset;
+    const int16_t ub_coeff = c->ubCoeff, ug_coeff = c->ugCoeff;
+    const int16_t vg_coeff = c->vgCoeff, vr_coeff = c->vrCoeff;
+    int x, y;
+
+    for (y = 0; y < NUM_LINES; y++) {
+        const uint8_t *dither_r = (const uint8_t *)&ff_dither8[(y + 1) & 1];
+        const uint8_t *dither_g = (const uint8_t *)(fmt == AV_PIX_FMT_RGB565 ?
+                                                    &ff_dither4[y & 1] : &ff_dither8[y & 1]);
+        const uint8_t *dither_b = (const uint8_t *)&ff_dither8[y & 1];
+        const uint8_t *py = src[0] + y * src_stride[0];
+        const uint8_t *pu = src[1] + (y >> desc->log2_chroma_h) * src_stride[1];
+        const uint8_t *pv = src[2] + (y >> desc->log2_chroma_h) * src_stride[2];
+        const uint8_t *pa = src[3] + y * src_stride[3];
+        uint8_t *out = dst + y * dst_stride;
+
+        for (x = 0; x < w; x++) {
+            const int cx = x >> desc->log2_chroma_w;
+            const int a  = isALPHA(c->srcFormat) ? pa[x] : 255;
+            int Y = high ? AV_RN16(py + 2 * x)  : py[x];
+            int U = high ? AV_RN16(pu + 2 * cx) : pu[cx];
+            int V = high ? AV_RN16(pv + 2 * cx) : pv[cx];
+            int r, g, b;
+
+            Y = (int16_t)((Y << shift) - y_offset);
+            U = av_clip_int16((U << shift) - u_offset);
+            V = av_clip_int16((V << shift) - v_offset);
+            Y = (Y * y_coeff) >> 16;
+            b = av_clip_uint8(Y + ((U * ub_coeff) >> 16));
+            r = av_clip_uint8(Y + ((V * vr_coeff) >> 16));
+            g = av_clip_uint8(Y + av_clip_int16(((U * ug_coeff) >> 16) +
+                                                ((V * vg_coeff) >> 16)));
+
+            switch (fmt) {
+            case AV_PIX_FMT_RGB24:
+                out[3 * x] = r; out[3 * x + 1] = g; out[3 * x + 2] = b;
+                break;
+            case AV_PIX_FMT_BGR24:
+                out[3 * x] = b; out[3 * x + 1] = g; out[3 * x + 2] = r;
+                break;
+            case AV_PIX_FMT_RGB32:
+                AV_WN32(out + 4 * x, (unsigned)a << 24 | r << 16 | g << 8 | b);
+                break;
+            case AV_PIX_FMT_BGR32:
+                AV_WN32(out + 4 * x, (unsigned)a << 24 | b << 16 | g << 8 | r);
+                break;
+            case AV_PIX_FMT_RGB565:
+            case AV_PIX_FMT_RGB555:
+                r = FFMIN(r + dither_r[x & 7], 255);
+                g = FFMIN(g + dither_g[x & 7], 255);
+                b = FFMIN(b + dither_b[x & 7], 255);
+                AV_WN16(out + 2 * x, fmt == AV_PIX_FMT_RGB565 ?
+                        (r >> 3) << 11 | (g >> 2) << 5 | b >> 3 :
+                        (r >> 3) << 10 | (g >> 3) << 5 | b >> 3);
+                break;
+            }
+        }
+    }
+}
+#endif
+
+static void check_yuv2rgb(int src_fmt)
+{
+    /* the 15/16 bpp C converters only write multiples of 8 pixels */
+    static const int input_sizes[] = {16, 32, 40, 72, 128, 1920};
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(src_fmt);
+    const int high = src_desc->comp[0].depth > 8;
+    /* the C versions only exist for 8-bit 4:2:0 input */
+    const int exact = high || !src_desc->log2_chroma_w;
+    int fmi, isi, i, log_level;
+    struct SwsContext *ctx;
+
+    declare_func_emms(AV_CPU_FLAG_MMX, int, struct SwsContext *c,
+                      const uint8_t *src[], int srcStride[], int srcSliceY,
+                      int srcSliceH, uint8_t *dst[], int dstStride[]);
+
+    LOCAL_ALIGNED_32(uint8_t, src_y, [MAX_WIDTH * 2 * NUM_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, src_u, [MAX_WIDTH * 2 * NUM_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, src_v, [MAX_WIDTH * 2 * NUM_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, src_a, [MAX_WIDTH * NUM_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [MAX_WIDTH * 4 * NUM_LINES]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [MAX_WIDTH * 4 * NUM_LINES]);
+
+    const int chroma_w     = (MAX_WIDTH >> src_desc->log2_chroma_w) << high;
+    const uint8_t *src[4]  = { src_y, src_u, src_v, src_a };
+    int src_stride[4]      = { MAX_WIDTH << high, chroma_w, chroma_w, MAX_WIDTH };
+    uint8_t *dst0_p[4]     = { dst0 };
+    uint8_t *dst1_p[4]     = { dst1 };
+    int dst_stride[4]      = { MAX_WIDTH * 4 };
+
+    randomize_buffers(src_y, MAX_WIDTH * 2 * NUM_LINES);
+    randomize_buffers(src_u, MAX_WIDTH * 2 * NUM_LINES);
+    randomize_buffers(src_v, MAX_WIDTH * 2 * NUM_LINES);
+    randomize_buffers(src_a, MAX_WIDTH * NUM_LINES);
+    if (high) {
+        for (i = 0; i < MAX_WIDTH * 2 * NUM_LINES; i += 2) {
+            AV_WN16(src_y + i, AV_RN16(src_y + i) & 0x3FF);
+            AV_WN16(src_u + i, AV_RN16(src_u + i) & 0x3FF);
+            AV_WN16(src_v + i, AV_RN16(src_v + i) & 0x3FF);
+        }
+    }
+
+    for (fmi = 0; fmi < FF_ARRAY_ELEMS(dst_fmts); fmi++) {
+        const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(dst_fmts[fmi]);
+
+        for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+            const int w = input_sizes[isi];
+
+            /* formats without a special converter warn about it */
+            log_level = av_log_get_level();
+            av_log_set_level(AV_LOG_ERROR);
+            ctx = sws_getContext(w, NUM_LINES, src_fmt, w, NUM_LINES, dst_fmts[fmi],
+                                 SWS_BILINEAR, NULL, NULL, NULL);
+            av_log_set_level(log_level);
+            if (!ctx)
+                fail();
+
+            if (ctx->convert_unscaled &&
+                check_func(ctx->convert_unscaled, "%s_%s_%d",
+                           src_desc->name, dst_desc->name, w)) {
+                memset(dst0, 0xFF, MAX_WIDTH * 4 * NUM_LINES);
+                memset(dst1, 0xFF, MAX_WIDTH * 4 * NUM_LINES);
+
+#if ARCH_X86
+                if (exact)
+                    yuv2rgb_ref(ctx, src, src_stride, dst0, dst_stride[0], w, dst_fmts[fmi]);
+                else
+#endif
+                call_ref(ctx, src, src_stride, 0, NUM_LINES, dst0_p, dst_stride);
+                call_new(ctx, src, src_stride, 0, NUM_LINES, dst1_p, dst_stride);
+
+                for (i = 0; i < NUM_LINES; i++) {
+                    const uint8_t *line0 = dst0 + i * dst_stride[0];
+                    const uint8_t *line1 = dst1 + i * dst_stride[0];
+                    if (exact ? memcmp(line0, line1, dst_stride[0]) :
+                                cmp_line(line0, line1, w, dst_fmts[fmi]))
+                        fail();
+                    if (check_guard(line1, w, dst_stride[0], dst_fmts[fmi]))
+                        fail();
+                }
+
+                bench_new(ctx, src, src_stride, 0, NUM_LINES, dst1_p, dst_stride);
+            }
+            sws_freeContext(ctx);
+        }
+    }
+}
+
+void checkasm_check_sw_yuv2rgb(void)
+{
+    check_yuv2rgb(AV_PIX_FMT_YUV420P);
+    report("yuv420p");
+
+    check_yuv2rgb(AV_PIX_FMT_YUVA420P);
+    report("yuva420p");
+
+#if ARCH_X86
+    check_yuv2rgb(AV_PIX_FMT_YUV444P);
+    report("yuv444p");
+
+    check_yuv2rgb(AV_PIX_FMT_YUVA444P);
+    report("yuva444p");
+
+    check_yuv2rgb(AV_PIX_FMT_YUV420P10);
+    report("yuv420p10");
+#endif
+}
@@ -0,0 +1,182 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+#include "libavutil/opt.h"
+
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define LEN 240
+
+static void check_noise_shaping(int sample_rate, const char *method)
+{
+    LOCAL_ALIGNED_32(float, coeffs,  [8 + 4 * NS_TAPS]);
+    LOCAL_ALIGNED_32(float, errors0, [4 * 2 * NS_TAPS]);
+    LOCAL_ALIGNED_32(float, errors1, [4 * 2 * NS_TAPS]);
+    LOCAL_ALIGNED_32(float, src,     [4 * LEN]);
+    LOCAL_ALIGNED_32(float, noise,   [4 * LEN]);
+    LOCAL_ALIGNED_32(float, dst0,    [4 * LEN]);
+    LOCAL_ALIGNED_32(float, dst1,    [4 * LEN]);
+    AVChannelLayout layout = AV_CHANNEL_LAYOUT_QUAD;
+    SwrContext *s = NULL;
+    int i, j, taps, pos;
+
+    declare_func(void, float *dst, const float *src, const float *noise, float *errors,
+                 const float *coeffs, integer taps, integer pos, integer len);
+
+    if (swr_alloc_set_opts2(&s, &layout, AV_SAMPLE_FMT_S16, sample_rate,
+                            &layout, AV_SAMPLE_FMT_FLT, sample_rate, 0, NULL) < 0 ||
+        av_opt_set(s, "dither_method", method, 0) < 0 ||
+        swr_init(s) < 0) {
+        swr_free(&s);
+        fail();
+        return;
+    }
+
+    taps = s->dither.ns_taps;
+    for (i = 0; i < 4; i++) {
+        coeffs[i    ] = s->dither.ns_scale_1;
+        coeffs[i + 4] = s->dither.ns_scale;
+        for (j = 0; j < NS_TAPS; j++)
+            coeffs[8 + 4 * j + i] = s->dither.ns_coeffs[j];
+    }
+    for (i = 0; i < 4 * LEN; i++) {
+        src[i]   = (int32_t)rnd() / (float)INT32_MAX;
+        noise[i] = (int32_t)rnd() / (float)INT32_MAX;
+    }
+    for (i = 0; i < 4 * taps; i++)
+        errors0[i] = errors0[i + 4 * taps] = (int32_t)rnd() / (float)INT32_MAX * 0.5f;
+    pos = rnd() % taps;
+
+    if (check_func(s->dither.ns_x4_simd ? s->dither.ns_x4_simd : s->dither.ns_x4_f,
+                   "noise_shaping_float_x4_%s_%d", method, sample_rate)) {
+        memcpy(errors1, errors0, 4 * 2 * taps * sizeof(*errors0));
+        call_ref(dst0, src, noise, errors0, coeffs, taps, pos, LEN);
+        call_new(dst1, src, noise, errors1, coeffs, taps, pos, LEN);
+        if (memcmp(dst0, dst1, 4 * LEN * sizeof(*dst0)) ||
+            memcmp(errors0, errors1, 4 * 2 * taps * sizeof(*errors0)))
+            fail();
+        bench_new(dst1, src, noise, errors1, coeffs, taps, pos, LEN);
+    }
+
+    swr_free(&s);
+}
+
+/* Whole planes through swri_noise_shaping_float_simd(), which groups the
+ * channels by 4 and cuts them in blocks, against swri_noise_shaping_float(). */
+#define COUNT 600
+
+static SwrContext *alloc_ns(int nb_ch, const char *method)
+{
+    AVChannelLayout layout;
+    SwrContext *s = NULL;
+
+    av_channel_layout_default(&layout, nb_ch);
+    if (swr_alloc_set_opts2(&s, &layout, AV_SAMPLE_FMT_S16P, 44100,
+                            &layout, AV_SAMPLE_FMT_FLTP, 44100, 0, NULL) < 0 ||
+        av_opt_set(s, "dither_method", method, 0) < 0 ||
+        swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static void check_noise_shaping_planes(int nb_ch, const char *method)
+{
+    LOCAL_ALIGNED_32(float, src,   [6 * COUNT]);
+    LOCAL_ALIGNED_32(float, noise, [6 * COUNT]);
+    LOCAL_ALIGNED_32(float, dst0,  [6 * COUNT]);
+    LOCAL_ALIGNED_32(float, dst1,  [6 * COUNT]);
+    SwrContext *s0 = alloc_ns(nb_ch, method);
+    SwrContext *s1 = alloc_ns(nb_ch, method);
+    AudioData srcs   = { .ch_count = nb_ch, .bps = 4, .planar = 1, .fmt = AV_SAMPLE_FMT_FLTP };
+    AudioData noises = srcs, dsts0 = srcs, dsts1 = srcs;
+    int i, j, taps;
+
+    declare_func(void, SwrContext *s, AudioData *dsts, const AudioData *srcs,
+                 const AudioData *noises, int count);
+
+    if (!s0 || !s1) {
+        swr_free(&s0);
+        swr_free(&s1);
+        fail();
+        return;
+    }
+
+    for (i = 0; i < nb_ch; i++) {
+        srcs.ch[i]   = (uint8_t *)(src   + i * COUNT);
+        noises.ch[i] = (uint8_t *)(noise + i * COUNT);
+        dsts0.ch[i]  = (uint8_t *)(dst0  + i * COUNT);
+        dsts1.ch[i]  = (uint8_t *)(dst1  + i * COUNT);
+    }
+    for (i = 0; i < nb_ch * COUNT; i++) {
+        src[i]   = (int32_t)rnd() / (float)INT32_MAX;
+        noise[i] = (int32_t)rnd() / (float)INT32_MAX;
+    }
+    taps = s0->dither.ns_taps;
+    for (i = 0; i < nb_ch; i++)
+        for (j = 0; j < taps; j++)
+            s0->dither.ns_errors[i][j] = s0->dither.ns_errors[i][j + taps] =
+                (int32_t)rnd() / (float)INT32_MAX * 0.5f;
+    memcpy(s1->dither.ns_errors, s0->dither.ns_errors, sizeof(s0->dither.ns_errors));
+    s0->dither.ns_pos = s1->dither.ns_pos = rnd() % taps;
+
+    if (check_func(s1->dither.ns_x4_simd ? swri_noise_shaping_float_simd : swri_noise_shaping_float,
+                   "noise_shaping_float_%dch_%s", nb_ch, method)) {
+        /* two calls, the second one starts from the state left by the first */
+        for (i = 0; i < 2; i++) {
+            int count = i ? COUNT - 333 : 333;
+
+            s0->dither.noise_pos = s1->dither.noise_pos = i ? 333 : 0;
+            for (j = 0; j < nb_ch; j++) {
+                dsts0.ch[j] = (uint8_t *)(dst0 + j * COUNT + (i ? 333 : 0));
+                dsts1.ch[j] = (uint8_t *)(dst1 + j * COUNT + (i ? 333 : 0));
+                srcs.ch[j]  = (uint8_t *)(src  + j * COUNT + (i ? 333 : 0));
+            }
+            call_ref(s0, &dsts0, &srcs, &noises, count);
+            call_new(s1, &dsts1, &srcs, &noises, count);
+        }
+        if (memcmp(dst0, dst1, nb_ch * COUNT * sizeof(*dst0)) ||
+            memcmp(s0->dither.ns_errors, s1->dither.ns_errors, sizeof(s0->dither.ns_errors)) ||
+            s0->dither.ns_pos != s1->dither.ns_pos)
+            fail();
+    }
+
+    swr_free(&s0);
+    swr_free(&s1);
+}
+
+void checkasm_check_swr_dither(void)
+{
+    check_noise_shaping(44100, "lipshitz");
+    check_noise_shaping(44100, "low_shibata");
+    check_noise_shaping(44100, "shibata");
+    check_noise_shaping(48000, "shibata");
+    report("noise_shaping_float_x4");
+
+    check_noise_shaping_planes(1, "shibata");
+    check_noise_shaping_planes(3, "shibata");
+    check_noise_shaping_planes(6, "shibata");
+    check_noise_shaping_planes(6, "lipshitz");
+    report("noise_shaping_float");
+}
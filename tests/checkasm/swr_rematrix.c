@@ -0,0 +1,130 @@
+/*
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/swresample_internal.h"
+
+#include "checkasm.h"
+
+#define LEN 256
+
+static void randomize_samples(uint8_t *buf, enum AVSampleFormat fmt, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P:
+            ((int16_t *)buf)[i] = rnd();
+            break;
+        case AV_SAMPLE_FMT_S32P:
+            ((int32_t *)buf)[i] = rnd();
+            break;
+        case AV_SAMPLE_FMT_FLTP:
+            ((float *)buf)[i]   = (int32_t)rnd() / (float)INT32_MAX;
+            break;
+        }
+    }
+}
+
+static void check_mix_n_1(enum AVSampleFormat fmt, const AVChannelLayout *in_layout,
+                          const char *in_name, const AVChannelLayout *out_layout,
+                          const char *out_name)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [(SWR_CH_MAX + 1) * LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [LEN * 4]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [LEN * 4]);
+    const uint8_t *in[SWR_CH_MAX + 1];
+    const uint8_t *coeffp, *coeffp_new;
+    SwrContext *s = NULL;
+    int bps = av_get_bytes_per_sample(fmt);
+    int i, out_i = 0, nb_in;
+
+    declare_func(void, void *out, const void * const *in, const void *coeffp,
+                 integer nb_in, integer len);
+
+    if (swr_alloc_set_opts2(&s, out_layout, fmt, 48000, in_layout, fmt, 48000, 0, NULL) < 0 ||
+        av_opt_set_sample_fmt(s, "internal_sample_fmt", fmt, 0) < 0 ||
+        swr_init(s) < 0) {
+        swr_free(&s);
+        fail();
+        return;
+    }
+
+    /* test the output with the most inputs */
+    for (i = 0; i < out_layout->nb_channels; i++)
+        if (s->matrix_ch[i][0] > s->matrix_ch[out_i][0])
+            out_i = i;
+    nb_in  = s->matrix_ch[out_i][0];
+    coeffp = s->native_matrix_n + out_i * NATIVE_MATRIX_N_STRIDE(s);
+    /* the SIMD functions may use another coefficient layout */
+    coeffp_new = s->mix_n_1_simd && s->native_simd_matrix_n ?
+                 s->native_simd_matrix_n + out_i * NATIVE_MATRIX_N_STRIDE(s) : coeffp;
+
+    randomize_samples(src, fmt, (nb_in + 1) * LEN);
+    for (i = 0; i < nb_in; i++)
+        in[i] = src + i * LEN * bps;
+    /* the int16 functions read one extra input for odd nb_in */
+    in[nb_in] = src + nb_in * LEN * bps;
+
+    if (check_func(s->mix_n_1_simd ? s->mix_n_1_simd : s->mix_n_1_f, "mix_n_1_%s_%s_%s",
+                   av_get_sample_fmt_name(fmt), in_name, out_name)) {
+        memset(dst0, 0, LEN * bps);
+        memset(dst1, 0, LEN * bps);
+        /* the previous SIMD version may not take the C coefficient layout,
+         * so always compare against the C function */
+        s->mix_n_1_f(dst0, (const void * const *)in, coeffp, nb_in, LEN);
+        call_new(dst1, (const void * const *)in, coeffp_new, nb_in, LEN);
+        if (memcmp(dst0, dst1, LEN * bps))
+            fail();
+        bench_new(dst1, (const void * const *)in, coeffp_new, nb_in, LEN);
+    }
+
+    swr_free(&s);
+}
+
+void checkasm_check_swr_rematrix(void)
+{
+    static const struct {
+        AVChannelLayout in, out;
+        const char *in_name, *out_name;
+    } layouts[] = {
+        { AV_CHANNEL_LAYOUT_5POINT1,        AV_CHANNEL_LAYOUT_STEREO,  "5.1",           "stereo" },
+        { AV_CHANNEL_LAYOUT_7POINT1,        AV_CHANNEL_LAYOUT_STEREO,  "7.1",           "stereo" },
+        { AV_CHANNEL_LAYOUT_HEXADECAGONAL,  AV_CHANNEL_LAYOUT_5POINT1, "hexadecagonal", "5.1"    },
+        { AV_CHANNEL_LAYOUT_HEXADECAGONAL,  AV_CHANNEL_LAYOUT_STEREO,  "hexadecagonal", "stereo" },
+    };
+    static const enum AVSampleFormat fmts[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_S32P, AV_SAMPLE_FMT_FLTP,
+    };
+    int i, j;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++)
+        for (j = 0; j < FF_ARRAY_ELEMS(layouts); j++)
+            check_mix_n_1(fmts[i], &layouts[j].in, layouts[j].in_name,
+                          &layouts[j].out, layouts[j].out_name);
+    report("mix_n_1");
+}
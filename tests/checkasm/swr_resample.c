@@ -0,0 +1,139 @@
+/*
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define DST_SIZE 256
+/* enough input for downsampling by 2, plus the filter and SIMD overreads */
+#define SRC_SIZE (DST_SIZE * 2 + 256)
+
+static void randomize_samples(void *buf, enum AVSampleFormat fmt, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P:
+            ((int16_t *)buf)[i] = rnd();
+            break;
+        case AV_SAMPLE_FMT_FLTP:
+            ((float *)buf)[i]   = (int32_t)rnd() / (float)INT32_MAX;
+            break;
+        case AV_SAMPLE_FMT_DBLP:
+            ((double *)buf)[i]  = (int32_t)rnd() / (double)INT32_MAX;
+            break;
+        }
+    }
+}
+
+static int cmp_samples(const void *ref, const void *new, enum AVSampleFormat fmt, int n)
+{
+    switch (fmt) {
+    case AV_SAMPLE_FMT_FLTP:
+        return !float_near_abs_eps_array(ref, new, 1e-5f, n);
+    case AV_SAMPLE_FMT_DBLP:
+        return !double_near_abs_eps_array(ref, new, 1e-12, n);
+    default:
+        return memcmp(ref, new, n * av_get_bytes_per_sample(fmt));
+    }
+}
+
+static void check_resample(enum AVSampleFormat fmt, int in_rate, int out_rate,
+                           int filter_size)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [SRC_SIZE * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_SIZE * 8]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_SIZE * 8]);
+    ResampleContext *c;
+    int linear;
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    /* exact_rational off to get a nonzero dst_incr_mod for the linear path */
+    c = swri_resampler.init(NULL, out_rate, in_rate, filter_size, 10, 1, 0, fmt,
+                            SWR_FILTER_TYPE_KAISER, 9, 0, 0, 0, 1, 0, 0);
+    if (!c) {
+        fail();
+        return;
+    }
+
+    randomize_samples(src, fmt, SRC_SIZE);
+
+    for (linear = 0; linear < 2; linear++) {
+        swri_resample_dsp_init(c);
+        if (check_func(linear ? c->dsp.resample_linear : c->dsp.resample_common,
+                       "resample_%s_%s_%d_%d_%d", linear ? "linear" : "common",
+                       av_get_sample_fmt_name(fmt), in_rate, out_rate, c->filter_length)) {
+            int index = rnd() % c->phase_count;
+            int frac  = rnd() % c->src_incr;
+            int ref_ret, new_ret, ref_index, ref_frac;
+
+            memset(dst0, 0, DST_SIZE * 8);
+            memset(dst1, 0, DST_SIZE * 8);
+
+            c->index = index;
+            c->frac  = frac;
+            ref_ret   = call_ref(c, dst0, src, DST_SIZE, 1);
+            ref_index = c->index;
+            ref_frac  = c->frac;
+
+            c->index = index;
+            c->frac  = frac;
+            new_ret  = call_new(c, dst1, src, DST_SIZE, 1);
+
+            if (ref_ret != new_ret || ref_index != c->index || ref_frac != c->frac ||
+                cmp_samples(dst0, dst1, fmt, DST_SIZE))
+                fail();
+
+            c->index = index;
+            c->frac  = frac;
+            bench_new(c, dst1, src, DST_SIZE, 0);
+        }
+    }
+
+    swri_resampler.free(&c);
+}
+
+void checkasm_check_swr_resample(void)
+{
+    static const enum AVSampleFormat fmts[] = {
+        AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+    };
+    /* filter lengths that are not a multiple of the vector size exercise
+     * the zero padded end of the filter rows */
+    static const int filter_sizes[] = { 6, 13, 32, 50 };
+    int i, j;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(fmts); i++) {
+        for (j = 0; j < FF_ARRAY_ELEMS(filter_sizes); j++) {
+            check_resample(fmts[i], 48000, 44100, filter_sizes[j]);
+            check_resample(fmts[i], 44100, 48000, filter_sizes[j]);
+        }
+    }
+    report("resample");
+}
@@ -0,0 +1,141 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/adm.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 509
+#define PADDED_WIDTH 512
+#define PAD 8
+
+#define randomize_buffer(buf, size)                       \
+    do {                                                  \
+        for (int i = 0; i < size; i++)                    \
+            buf[i] = (rnd() & 0xFFFF) / 256.f - 128.f;    \
+    } while (0)
+
+static void check_dwt_v(const ADMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, src,    [4 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, lo_ref, [PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, lo_new, [PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, hi_ref, [PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, hi_new, [PADDED_WIDTH]);
+    const float *lines[4];
+
+    declare_func(void, float *lo, float *hi, const float *const *src, int w);
+
+    randomize_buffer(src, 4 * PADDED_WIDTH);
+    for (int k = 0; k < 4; k++)
+        lines[k] = src + k * PADDED_WIDTH;
+
+    if (check_func(dsp->dwt_v, "adm_dwt_v")) {
+        call_ref(lo_ref, hi_ref, lines, WIDTH);
+        call_new(lo_new, hi_new, lines, WIDTH);
+        if (memcmp(lo_ref, lo_new, WIDTH * sizeof(*lo_ref)) ||
+            memcmp(hi_ref, hi_new, WIDTH * sizeof(*hi_ref)))
+            fail();
+        bench_new(lo_new, hi_new, lines, WIDTH);
+    }
+}
+
+static void check_dwt_h(const ADMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, src,    [2 * PADDED_WIDTH + 4 * PAD]);
+    LOCAL_ALIGNED_32(float, lo_ref, [PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, lo_new, [PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, hi_ref, [PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, hi_new, [PADDED_WIDTH]);
+
+    declare_func(void, float *lo, float *hi, const float *src, int w);
+
+    randomize_buffer(src, 2 * PADDED_WIDTH + 4 * PAD);
+
+    if (check_func(dsp->dwt_h, "adm_dwt_h")) {
+        call_ref(lo_ref, hi_ref, src + PAD, WIDTH);
+        call_new(lo_new, hi_new, src + PAD, WIDTH);
+        if (memcmp(lo_ref, lo_new, WIDTH * sizeof(*lo_ref)) ||
+            memcmp(hi_ref, hi_new, WIDTH * sizeof(*hi_ref)))
+            fail();
+        bench_new(lo_new, hi_new, src + PAD, WIDTH);
+    }
+}
+
+static int check_bands(const float *ref, const float *new)
+{
+    for (int b = 0; b < 3; b++) {
+        if (memcmp(ref + b * PADDED_WIDTH, new + b * PADDED_WIDTH,
+                   WIDTH * sizeof(*ref)))
+            return 1;
+    }
+    return 0;
+}
+
+static void check_decouple(const ADMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(float, ref,   [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, dis,   [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, r_ref, [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, r_new, [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, a_ref, [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, a_new, [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, f_ref, [3 * PADDED_WIDTH]);
+    LOCAL_ALIGNED_32(float, f_new, [3 * PADDED_WIDTH]);
+    const float factors[4] = { 0.0357f, 0.0357f, 0.0502f, 100.f };
+
+    declare_func(void, float *r, float *a, float *f, const float *ref,
+                 const float *dis, ptrdiff_t band_stride,
+                 const float *factors, int w);
+
+    randomize_buffer(ref, 3 * PADDED_WIDTH);
+    /* mostly small distortions, so that all branches of the gain limit are taken */
+    for (int i = 0; i < 3 * PADDED_WIDTH; i++) {
+        switch (rnd() & 3) {
+        case 0:  dis[i] = 0.f;                                    break;
+        case 1:  dis[i] = (rnd() & 0xFFFF) / 256.f - 128.f;       break;
+        default: dis[i] = ref[i] * ((rnd() & 0xFF) / 128.f - 0.5f); break;
+        }
+    }
+
+    if (check_func(dsp->decouple, "adm_decouple")) {
+        call_ref(r_ref, a_ref, f_ref, ref, dis, PADDED_WIDTH, factors, WIDTH);
+        call_new(r_new, a_new, f_new, ref, dis, PADDED_WIDTH, factors, WIDTH);
+        if (check_bands(r_ref, r_new) || check_bands(a_ref, a_new) ||
+            check_bands(f_ref, f_new))
+            fail();
+        bench_new(r_new, a_new, f_new, ref, dis, PADDED_WIDTH, factors, WIDTH);
+    }
+}
+
+void checkasm_check_vf_adm(void)
+{
+    ADMDSPContext dsp;
+
+    ff_adm_init_dsp(&dsp);
+
+    check_dwt_v(&dsp);
+    report("dwt_v");
+
+    check_dwt_h(&dsp);
+    report("dwt_h");
+
+    check_decouple(&dsp);
+    report("decouple");
+}
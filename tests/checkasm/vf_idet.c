@@ -0,0 +1,71 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "checkasm.h"
+#include "libavfilter/vf_idet.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 1920
+
+static void check_filter_line(int for_16b)
+{
+    const int bytes = for_16b ? 2 : 1;
+    LOCAL_ALIGNED_32(uint8_t, a, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, b, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, c, [WIDTH * 2]);
+    IDETContext idet = { 0 };
+
+    declare_func(int, const uint8_t *a, const uint8_t *b, const uint8_t *c, int w);
+
+    for (int i = 0; i < WIDTH; i++) {
+        if (for_16b) {
+            AV_WN16A(a + 2 * i, rnd());
+            AV_WN16A(b + 2 * i, rnd());
+            AV_WN16A(c + 2 * i, rnd());
+        } else {
+            a[i] = rnd();
+            b[i] = rnd();
+            c[i] = rnd();
+        }
+    }
+
+    ff_idet_init(&idet, for_16b);
+
+    if (check_func(idet.filter_line, "idet_filter_line_%dbit", bytes * 8)) {
+        /* odd widths exercise the C tail of the SIMD wrappers */
+        static const int widths[] = { WIDTH, WIDTH - 1, 33, 7 };
+
+        for (int i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            int ref = call_ref(a, b, c, widths[i]);
+            int new = call_new(a, b, c, widths[i]);
+            if (ref != new)
+                fail();
+        }
+        bench_new(a, b, c, WIDTH);
+    }
+}
+
+void checkasm_check_vf_idet(void)
+{
+    check_filter_line(0);
+    report("idet_filter_line_8bit");
+
+    check_filter_line(1);
+    report("idet_filter_line_16bit");
+}
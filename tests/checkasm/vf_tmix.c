@@ -0,0 +1,88 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/tmix.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 509
+#define FRAMES 7
+
+static void check_slide(int depth, int weight)
+{
+    LOCAL_ALIGNED_32(uint8_t,  add,     [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t,  sub,     [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t,  dst_ref, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t,  dst_new, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint32_t, sum,     [WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, sum_ref, [WIDTH]);
+    LOCAL_ALIGNED_32(uint32_t, sum_new, [WIDTH]);
+    const int max = (1 << depth) - 1;
+    const float factor = 1.f / (FRAMES * weight);
+    const int bytes = depth <= 8 ? 1 : 2;
+    TMixDSPContext dsp;
+
+    declare_func(void, uint8_t *dst, uint32_t *sum, const uint8_t *add,
+                 const uint8_t *sub, int w, int weight, int max, float factor);
+
+    ff_tmix_init_dsp(&dsp, depth);
+
+    /* the sums hold the window the sub pixels are leaving */
+    for (int x = 0; x < WIDTH; x++) {
+        const int a = rnd() & max;
+        const int s = rnd() & max;
+
+        if (bytes == 1) {
+            add[x] = a;
+            sub[x] = s;
+        } else {
+            AV_WN16A(add + x * 2, a);
+            AV_WN16A(sub + x * 2, s);
+        }
+        sum[x] = s;
+        for (int i = 1; i < FRAMES; i++)
+            sum[x] += rnd() & max;
+    }
+
+    if (check_func(dsp.slide, "tmix_slide_%d_w%d", depth, weight)) {
+        memset(dst_ref, 0, WIDTH * bytes);
+        memset(dst_new, 0, WIDTH * bytes);
+        memcpy(sum_ref, sum, WIDTH * sizeof(*sum));
+        memcpy(sum_new, sum, WIDTH * sizeof(*sum));
+        call_ref(dst_ref, sum_ref, add, sub, WIDTH, weight, max, factor);
+        call_new(dst_new, sum_new, add, sub, WIDTH, weight, max, factor);
+        if (memcmp(dst_ref, dst_new, WIDTH * bytes) ||
+            memcmp(sum_ref, sum_new, WIDTH * sizeof(*sum)))
+            fail();
+        /* keep the sums consistent across iterations by sliding back and forth */
+        bench_new(dst_new, sum, add, add, WIDTH, weight, max, factor);
+    }
+}
+
+void checkasm_check_vf_tmix(void)
+{
+    check_slide(8, 1);
+    check_slide(8, 3);
+    report("slide_8");
+
+    check_slide(10, 1);
+    check_slide(16, 1);
+    report("slide_16");
+}
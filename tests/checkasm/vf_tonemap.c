@@ -0,0 +1,209 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_tonemap_init.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 1920
+
+#define randomize_buffers(buf, size)                          \
+    do {                                                      \
+        for (int j = 0; j < size; j++)                        \
+            buf[j] = (float)(rnd() & 0xFFFF) / 0xFFFF * 10.0f; \
+    } while (0)
+
+static const char *const algo_names[TONEMAP_MAX] = {
+    "none", "linear", "gamma", "clip", "reinhard", "hable", "mobius",
+};
+
+static const double algo_params[TONEMAP_MAX] = {
+    1.0, 1.0, 1.8, 1.0, 1.0, 1.0, 0.3,
+};
+
+static void check_tonemap(void)
+{
+    LOCAL_ALIGNED_32(float, src,     [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float, dst_ref, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float, dst_new, [3 * WIDTH]);
+    TonemapDSPContext dsp;
+    TonemapParams p;
+
+    declare_func(void, float *dst_r, float *dst_g, float *dst_b,
+                 const float *src_r, const float *src_g, const float *src_b,
+                 const TonemapParams *p, int w);
+
+    ff_tonemap_init(&dsp);
+
+    for (int algo = 0; algo < TONEMAP_MAX; algo++) {
+        for (int desat = 0; desat < 2; desat++) {
+            ff_tonemap_params_init(&p, algo, algo_params[algo], 10.0);
+            p.desat     = desat ? 2.0f : 0.0f;
+            p.coeffs[0] = 0.2627f;
+            p.coeffs[1] = 0.6780f;
+            p.coeffs[2] = 0.0593f;
+
+            if (check_func(dsp.tonemap[algo], "tonemap_%s%s", algo_names[algo],
+                           desat ? "_desat" : "")) {
+                randomize_buffers(src, 3 * WIDTH);
+                memset(dst_ref, 0, 3 * WIDTH * sizeof(*dst_ref));
+                memset(dst_new, 0, 3 * WIDTH * sizeof(*dst_new));
+
+                call_ref(dst_ref, dst_ref + WIDTH, dst_ref + 2 * WIDTH,
+                         src, src + WIDTH, src + 2 * WIDTH, &p, WIDTH);
+                call_new(dst_new, dst_new + WIDTH, dst_new + 2 * WIDTH,
+                         src, src + WIDTH, src + 2 * WIDTH, &p, WIDTH);
+                if (!float_near_abs_eps_array(dst_ref, dst_new, 1e-5f, 3 * WIDTH))
+                    fail();
+                bench_new(dst_new, dst_new + WIDTH, dst_new + 2 * WIDTH,
+                          src, src + WIDTH, src + 2 * WIDTH, &p, WIDTH);
+            }
+        }
+    }
+}
+
+static void init_yuv_params(TonemapYUVParams *p, float *lin_lut, float *delin_lut,
+                            int shift)
+{
+    static const float yuv2rgb[3][3] = {
+        { 1.0f,  0.0f,       1.4746f   },
+        { 1.0f, -0.164553f, -0.571353f },
+        { 1.0f,  1.8814f,    0.0f      },
+    };
+
+    for (int n = 0; n < TONEMAP_LIN_LUT_SIZE; n++)
+        lin_lut[n] = powf(n / (float)(TONEMAP_LIN_LUT_SIZE - 1), 2.4f) * 10.0f;
+    for (int n = 0; n < TONEMAP_DELIN_LUT_SIZE; n++)
+        delin_lut[n] = powf(n / (float)(TONEMAP_DELIN_LUT_SIZE - 1), 1.0f / 2.4f);
+
+    memcpy(p->yuv2rgb, yuv2rgb, sizeof(yuv2rgb));
+    p->rgb2y[0]     = 0.2627f;
+    p->rgb2y[1]     = 0.6780f;
+    p->rgb2y[2]     = 0.0593f;
+    p->in_scale[0]  = 1.0f / 876;
+    p->in_scale[1]  = 1.0f / 896;
+    p->in_offset[0] = -64.0f / 876;
+    p->in_offset[1] = -512.0f / 896;
+    p->out_scale    = 876;
+    p->out_offset   = 64;
+    p->in_shift     = shift;
+    p->out_shift    = shift;
+    p->out_max      = 1023;
+    p->lin_lut      = lin_lut;
+    p->delin_lut    = delin_lut;
+}
+
+static void check_yuv2linear(void)
+{
+    LOCAL_ALIGNED_32(uint16_t, src_y,   [WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, src_uv,  [WIDTH]);
+    LOCAL_ALIGNED_32(float,    dst_ref, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float,    dst_new, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float,    lin_lut,   [TONEMAP_LIN_LUT_SIZE]);
+    LOCAL_ALIGNED_32(float,    delin_lut, [TONEMAP_DELIN_LUT_SIZE]);
+    TonemapDSPContext dsp;
+    TonemapYUVParams p;
+
+    declare_func(void, float *dst_r, float *dst_g, float *dst_b,
+                 const uint16_t *src_y, const uint16_t *src_u,
+                 const uint16_t *src_v, const TonemapYUVParams *p, int w);
+
+    ff_tonemap_init(&dsp);
+
+    for (int nv = 0; nv < 2; nv++) {
+        const uint16_t *src_u = src_uv;
+        const uint16_t *src_v = nv ? src_uv + 1 : src_uv + WIDTH / 2;
+        const int shift = nv ? 6 : 0;
+
+        init_yuv_params(&p, lin_lut, delin_lut, shift);
+
+        if (check_func(dsp.yuv2linear[nv], "tonemap_yuv2linear_%s", nv ? "nv" : "planar")) {
+            /* covers the whole 10-bit range, including values the
+             * matrix maps out of [0, 1] */
+            for (int i = 0; i < WIDTH; i++) {
+                src_y[i]  = (rnd() & 0x3FF) << shift;
+                src_uv[i] = (rnd() & 0x3FF) << shift;
+            }
+            memset(dst_ref, 0, 3 * WIDTH * sizeof(*dst_ref));
+            memset(dst_new, 0, 3 * WIDTH * sizeof(*dst_new));
+
+            call_ref(dst_ref, dst_ref + WIDTH, dst_ref + 2 * WIDTH,
+                     src_y, src_u, src_v, &p, WIDTH);
+            call_new(dst_new, dst_new + WIDTH, dst_new + 2 * WIDTH,
+                     src_y, src_u, src_v, &p, WIDTH);
+            if (!float_near_abs_eps_array(dst_ref, dst_new, 1e-5f, 3 * WIDTH))
+                fail();
+            bench_new(dst_new, dst_new + WIDTH, dst_new + 2 * WIDTH,
+                      src_y, src_u, src_v, &p, WIDTH);
+        }
+    }
+}
+
+static void check_linear2y(void)
+{
+    LOCAL_ALIGNED_32(float,    src,     [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float,    rgb_ref, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(float,    rgb_new, [3 * WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [WIDTH]);
+    LOCAL_ALIGNED_32(float,    lin_lut,   [TONEMAP_LIN_LUT_SIZE]);
+    LOCAL_ALIGNED_32(float,    delin_lut, [TONEMAP_DELIN_LUT_SIZE]);
+    TonemapDSPContext dsp;
+    TonemapYUVParams p;
+
+    declare_func(void, uint16_t *dst_y, float *r, float *g, float *b,
+                 const TonemapYUVParams *p, int w);
+
+    ff_tonemap_init(&dsp);
+
+    for (int shift = 0; shift <= 6; shift += 6) {
+        init_yuv_params(&p, lin_lut, delin_lut, shift);
+
+        if (check_func(dsp.linear2y, "tonemap_linear2y%s", shift ? "_msb" : "")) {
+            /* slightly out of range on both sides to exercise the clamping */
+            for (int i = 0; i < 3 * WIDTH; i++)
+                src[i] = (float)(rnd() & 0xFFFF) / 0xFFFF * 1.2f - 0.1f;
+            memcpy(rgb_ref, src, 3 * WIDTH * sizeof(*src));
+            memcpy(rgb_new, src, 3 * WIDTH * sizeof(*src));
+            memset(dst_ref, 0, WIDTH * sizeof(*dst_ref));
+            memset(dst_new, 0, WIDTH * sizeof(*dst_new));
+
+            call_ref(dst_ref, rgb_ref, rgb_ref + WIDTH, rgb_ref + 2 * WIDTH, &p, WIDTH);
+            call_new(dst_new, rgb_new, rgb_new + WIDTH, rgb_new + 2 * WIDTH, &p, WIDTH);
+            if (memcmp(dst_ref, dst_new, WIDTH * sizeof(*dst_ref)) ||
+                !float_near_abs_eps_array(rgb_ref, rgb_new, 1e-6f, 3 * WIDTH))
+                fail();
+            memcpy(rgb_new, src, 3 * WIDTH * sizeof(*src));
+            bench_new(dst_new, rgb_new, rgb_new + WIDTH, rgb_new + 2 * WIDTH, &p, WIDTH);
+        }
+    }
+}
+
+void checkasm_check_vf_tonemap(void)
+{
+    check_tonemap();
+    report("tonemap");
+
+    check_yuv2linear();
+    report("yuv2linear");
+
+    check_linear2y();
+    report("linear2y");
+}
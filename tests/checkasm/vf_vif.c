@@ -0,0 +1,101 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vif.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 509
+#define MAX_TAPS 17
+
+#define randomize_buffer(buf, size)                       \
+    do {                                                  \
+        for (int i = 0; i < size; i++)                    \
+            buf[i] = (rnd() & 0xFFFF) / 256.f - 128.f;    \
+    } while (0)
+
+static void check_filter_h(const VIFDSPContext *dsp, const float *filter, int filt_w)
+{
+    LOCAL_ALIGNED_32(float, src,     [WIDTH + MAX_TAPS]);
+    LOCAL_ALIGNED_32(float, dst_ref, [WIDTH]);
+    LOCAL_ALIGNED_32(float, dst_new, [WIDTH]);
+
+    declare_func(void, float *dst, const float *src,
+                 const float *filter, int filt_w, int w);
+
+    randomize_buffer(src, WIDTH + MAX_TAPS);
+
+    if (check_func(dsp->filter_h, "vif_filter_h_%d", filt_w)) {
+        memset(dst_ref, 0, WIDTH * sizeof(*dst_ref));
+        memset(dst_new, 0, WIDTH * sizeof(*dst_new));
+        call_ref(dst_ref, src, filter, filt_w, WIDTH);
+        call_new(dst_new, src, filter, filt_w, WIDTH);
+        if (memcmp(dst_ref, dst_new, WIDTH * sizeof(*dst_ref)))
+            fail();
+        bench_new(dst_new, src, filter, filt_w, WIDTH);
+    }
+}
+
+static void check_filter_v(const VIFDSPContext *dsp, const float *filter, int filt_w)
+{
+    LOCAL_ALIGNED_32(float, src,     [MAX_TAPS * WIDTH]);
+    LOCAL_ALIGNED_32(float, dst_ref, [WIDTH]);
+    LOCAL_ALIGNED_32(float, dst_new, [WIDTH]);
+    const float *lines[MAX_TAPS];
+
+    declare_func(void, float *dst, const float *const *src,
+                 const float *filter, int filt_w, int w);
+
+    randomize_buffer(src, MAX_TAPS * WIDTH);
+    for (int k = 0; k < filt_w; k++)
+        lines[k] = src + k * WIDTH;
+
+    if (check_func(dsp->filter_v, "vif_filter_v_%d", filt_w)) {
+        memset(dst_ref, 0, WIDTH * sizeof(*dst_ref));
+        memset(dst_new, 0, WIDTH * sizeof(*dst_new));
+        call_ref(dst_ref, lines, filter, filt_w, WIDTH);
+        call_new(dst_new, lines, filter, filt_w, WIDTH);
+        if (memcmp(dst_ref, dst_new, WIDTH * sizeof(*dst_ref)))
+            fail();
+        bench_new(dst_new, lines, filter, filt_w, WIDTH);
+    }
+}
+
+void checkasm_check_vf_vif(void)
+{
+    static const int widths[] = { 17, 9, 5, 3 };
+    VIFDSPContext dsp;
+    float filter[MAX_TAPS];
+
+    ff_vif_init_dsp(&dsp);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        for (int k = 0; k < widths[i]; k++)
+            filter[k] = (rnd() & 0xFFFF) / 65536.f;
+        check_filter_h(&dsp, filter, widths[i]);
+    }
+    report("filter_h");
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+        for (int k = 0; k < widths[i]; k++)
+            filter[k] = (rnd() & 0xFFFF) / 65536.f;
+        check_filter_v(&dsp, filter, widths[i]);
+    }
+    report("filter_v");
+}
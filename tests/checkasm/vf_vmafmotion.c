@@ -0,0 +1,132 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vmaf_motion.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  250
+#define HEIGHT 16
+#define PAD    32
+
+static const uint16_t filter[5] = { 1785, 8002, 13193, 8002, 1785 };
+
+static void check_convolution_y(int bpp)
+{
+    const int bytes = bpp > 8 ? 2 : 1;
+    const int mask  = (1 << bpp) - 1;
+    LOCAL_ALIGNED_32(uint8_t, src,      [5 * (WIDTH + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [WIDTH + PAD]);
+    const uint8_t *lines[5];
+    VMAFMotionDSPContext dsp;
+
+    declare_func(void, const uint16_t *filter, const uint8_t *const *src,
+                 uint16_t *dst, int w);
+
+    ff_vmafmotion_init_dsp(&dsp, bpp);
+
+    for (int i = 0; i < 5 * (WIDTH + PAD); i++) {
+        if (bytes == 1)
+            src[i] = rnd();
+        else
+            AV_WN16A(src + 2 * i, rnd() & mask);
+    }
+    for (int k = 0; k < 5; k++)
+        lines[k] = src + k * (WIDTH + PAD) * bytes;
+
+    if (check_func(dsp.convolution_y, "vmafmotion_convolution_y_%dbit", bpp)) {
+        memset(dst_ref, 0, (WIDTH + PAD) * sizeof(*dst_ref));
+        memset(dst_new, 0, (WIDTH + PAD) * sizeof(*dst_new));
+        call_ref(filter, lines, dst_ref, WIDTH);
+        call_new(filter, lines, dst_new, WIDTH);
+        if (memcmp(dst_ref, dst_new, WIDTH * sizeof(*dst_ref)))
+            fail();
+        bench_new(filter, lines, dst_new, WIDTH);
+    }
+}
+
+static void check_convolution_x(void)
+{
+    LOCAL_ALIGNED_32(uint16_t, src,     [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [WIDTH + PAD]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [WIDTH + PAD]);
+    VMAFMotionDSPContext dsp;
+
+    declare_func(void, const uint16_t *filter, const uint16_t *src,
+                 uint16_t *dst, int w);
+
+    ff_vmafmotion_init_dsp(&dsp, 8);
+
+    /* the vertical pass never outputs more than 15 bits */
+    for (int i = 0; i < WIDTH + PAD; i++)
+        src[i] = rnd() & 0x7FFF;
+
+    if (check_func(dsp.convolution_x, "vmafmotion_convolution_x")) {
+        memset(dst_ref, 0, (WIDTH + PAD) * sizeof(*dst_ref));
+        memset(dst_new, 0, (WIDTH + PAD) * sizeof(*dst_new));
+        call_ref(filter, src + 2, dst_ref, WIDTH - 4);
+        call_new(filter, src + 2, dst_new, WIDTH - 4);
+        if (memcmp(dst_ref, dst_new, (WIDTH - 4) * sizeof(*dst_ref)))
+            fail();
+        bench_new(filter, src + 2, dst_new, WIDTH - 4);
+    }
+}
+
+static void check_sad(void)
+{
+    const ptrdiff_t stride = (WIDTH + PAD) * sizeof(uint16_t);
+    LOCAL_ALIGNED_32(uint16_t, img1, [(WIDTH + PAD) * HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, img2, [(WIDTH + PAD) * HEIGHT]);
+    VMAFMotionDSPContext dsp;
+
+    declare_func(uint64_t, const uint16_t *img1, const uint16_t *img2, int w, int h,
+                 ptrdiff_t img1_stride, ptrdiff_t img2_stride);
+
+    ff_vmafmotion_init_dsp(&dsp, 8);
+
+    for (int i = 0; i < (WIDTH + PAD) * HEIGHT; i++) {
+        img1[i] = rnd() & 0x7FFF;
+        img2[i] = rnd() & 0x7FFF;
+    }
+
+    if (check_func(dsp.sad, "vmafmotion_sad")) {
+        for (int w = WIDTH - 16; w <= WIDTH; w += 3) {
+            uint64_t sad_ref = call_ref(img1, img2, w, HEIGHT, stride, stride);
+            uint64_t sad_new = call_new(img1, img2, w, HEIGHT, stride, stride);
+            if (sad_ref != sad_new)
+                fail();
+        }
+        bench_new(img1, img2, WIDTH, HEIGHT, stride, stride);
+    }
+}
+
+void checkasm_check_vf_vmafmotion(void)
+{
+    check_convolution_y(8);
+    check_convolution_y(10);
+    report("convolution_y");
+
+    check_convolution_x();
+    report("convolution_x");
+
+    check_sad();
+    report("sad");
+}
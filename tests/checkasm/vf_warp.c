@@ -0,0 +1,124 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/warp.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define SRC_W 64
+#define SRC_H 32
+#define WIDTH 256
+#define PAD   16
+
+/**
+ * 1-D weights with negative lobes for ws 3 and 4, to push the sums of
+ * extreme source pixels below 0 and above the maximum.
+ */
+static void signed_weights(const WarpContext *cubic, int ws, int *w)
+{
+    if (ws == 4) {
+        const int16_t *kernel = cubic->kernel[rnd() % WARP_KERNEL_SIZE];
+        for (int i = 0; i < 4; i++)
+            w[i] = kernel[i];
+    } else {
+        const int d = (rnd() % WARP_KERNEL_SIZE) * 16;
+        w[0] = -2048 - d;
+        w[1] = 16384 + 4096 + 2 * d;
+        w[2] = -2048 - d;
+    }
+}
+
+static void check_warp_line(int ws, int depth, int cubic)
+{
+    const int bytes = depth <= 8 ? 1 : 2;
+    const int elements = ws * ws;
+    LOCAL_ALIGNED_32(uint8_t, src,     [SRC_W * SRC_H * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [(WIDTH + PAD) * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [(WIDTH + PAD) * 2]);
+    LOCAL_ALIGNED_32(int16_t, u,       [(WIDTH + PAD) * 16]);
+    LOCAL_ALIGNED_32(int16_t, v,       [(WIDTH + PAD) * 16]);
+    LOCAL_ALIGNED_32(int16_t, ker,     [(WIDTH + PAD) * 16]);
+    WarpContext warp;
+
+    declare_func(void, uint8_t *dst, int width, const uint8_t *const src,
+                 ptrdiff_t in_linesize, const int16_t *const u,
+                 const int16_t *const v, const int16_t *const ker);
+
+    for (int i = 0; i < SRC_W * SRC_H; i++) {
+        /* only the extremes for signed weights, to hit both clips */
+        const int max = (1 << (bytes * 8)) - 1;
+        const int val = cubic ? (rnd() & 1) * max : rnd() & max;
+        if (bytes == 1)
+            src[i] = val;
+        else
+            AV_WN16A(src + 2 * i, val);
+    }
+
+    memset(u, 0, (WIDTH + PAD) * 16 * sizeof(*u));
+    memset(v, 0, (WIDTH + PAD) * 16 * sizeof(*v));
+    memset(ker, 0, (WIDTH + PAD) * 16 * sizeof(*ker));
+    /* 14-bit weights, as the line functions take */
+    ff_warp_init(&warp, WARP_BICUBIC, 16);
+    for (int x = 0; x < WIDTH; x++) {
+        int cx[4], cy[4];
+        int sum = 0;
+
+        if (cubic) {
+            signed_weights(&warp, ws, cx);
+            signed_weights(&warp, ws, cy);
+        }
+        for (int i = 0; i < elements; i++) {
+            u[x * elements + i] = rnd() % SRC_W;
+            v[x * elements + i] = rnd() % SRC_H;
+            if (cubic)
+                ker[x * elements + i] = (cx[i % ws] * cy[i / ws] + (1 << 13)) >> 14;
+            else
+                ker[x * elements + i] = rnd() % (16384 / elements);
+            sum += ker[x * elements + i];
+        }
+        /* positive weights add up to unity, the bilinear versions do not clip */
+        if (!cubic)
+            ker[x * elements] += 16384 - sum;
+    }
+
+    if (check_func(ff_warp_get_line_fn(ws, depth), "warp_line%d_%dbit%s", ws, bytes * 8,
+                   cubic ? "_signed" : "")) {
+        memset(dst_ref, 0, (WIDTH + PAD) * 2);
+        memset(dst_new, 0, (WIDTH + PAD) * 2);
+        call_ref(dst_ref, WIDTH, src, SRC_W * bytes, u, v, ker);
+        call_new(dst_new, WIDTH, src, SRC_W * bytes, u, v, ker);
+        if (memcmp(dst_ref, dst_new, WIDTH * bytes))
+            fail();
+        bench_new(dst_new, WIDTH, src, SRC_W * bytes, u, v, ker);
+    }
+}
+
+void checkasm_check_vf_warp(void)
+{
+    for (int ws = 1; ws <= 4; ws++) {
+        check_warp_line(ws, 8, 0);
+        check_warp_line(ws, 16, 0);
+    }
+    for (int ws = 3; ws <= 4; ws++) {
+        check_warp_line(ws, 8, 1);
+        check_warp_line(ws, 16, 1);
+    }
+    report("warp_line");
+}
@@ -0,0 +1,100 @@
+# Copyright (c) 2026
+#
+# This file is part of FFmpeg.
+#
+# FFmpeg is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# FFmpeg is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with FFmpeg; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+# ==============================================================================
+
+# Write a native model with random weights and the layer shapes of ESPCN
+# (x2 super resolution of the luma plane), for benchmarking the native
+# backend without tensorflow, e.g.:
+#
+#   python3 tests/dnn/gen_benchmark_model.py espcn_bench.model
+#   ffmpeg -benchmark -f lavfi -i testsrc2=s=480x270:d=1,format=gray \
+#          -vf dnn_processing=dnn_backend=native:model=espcn_bench.model:input=x:output=y:backend_configs=conv2d_threads=4 \
+#          -f null -
+#
+# The model has no use beyond measuring speed.
+
+import argparse
+import os
+import random
+import struct
+import sys
+
+# the model file header is shared with the converters in tools/python
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tools', 'python'))
+import convert_header as header
+
+DLT_CONV2D, DLT_DEPTH_TO_SPACE, DLT_DENSE = 1, 2, 8
+SAME = 1
+TANH, SIGMOID = 1, 2
+DOT_INPUT, DOT_OUTPUT, DOT_INTERMEDIATE = 1, 2, 3
+DNN_FLOAT = 1
+
+def u32(f, *values):
+    f.write(struct.pack('<%dI' % len(values), *[v & 0xffffffff for v in values]))
+
+def floats(f, n):
+    f.write(struct.pack('<%df' % n, *[random.uniform(-0.1, 0.1) for _ in range(n)]))
+
+def conv2d(f, inp, out, in_channels, out_channels, kernel_size, activation):
+    u32(f, DLT_CONV2D, 1, SAME, activation, in_channels, out_channels, kernel_size, 1)
+    floats(f, out_channels * kernel_size * kernel_size * in_channels)
+    floats(f, out_channels)
+    u32(f, inp, out)
+
+def dense(f, inp, out, in_channels, out_channels, activation):
+    u32(f, DLT_DENSE, activation, in_channels, out_channels, 1)
+    floats(f, out_channels * in_channels)
+    floats(f, out_channels)
+    u32(f, inp, out)
+
+def get_arguments():
+    parser = argparse.ArgumentParser(description='generate a native model with random weights for benchmarking')
+    parser.add_argument('outfile', help='path of the generated model')
+    parser.add_argument('--dense', type=int, default=0, help='number of dense layers inserted after the second convolution')
+    return parser.parse_args()
+
+def main():
+    args = get_arguments()
+    random.seed(0)
+
+    # operand 0 is the input, the last one is the output
+    nb_layers = 4 + args.dense
+    names = ['x'] + ['op%d' % i for i in range(1, nb_layers)] + ['y']
+    channels = [1, 64, 32] + [32] * args.dense + [4, 1]
+
+    with open(args.outfile, 'wb') as f:
+        f.write(header.str.encode('utf-8'))
+        u32(f, header.major, header.minor)
+
+        conv2d(f, 0, 1, 1, 64, 5, TANH)
+        conv2d(f, 1, 2, 64, 32, 3, TANH)
+        for i in range(args.dense):
+            dense(f, 2 + i, 3 + i, 32, 32, TANH)
+        conv2d(f, 2 + args.dense, 3 + args.dense, 32, 4, 3, SIGMOID)
+        u32(f, DLT_DEPTH_TO_SPACE, 2, 3 + args.dense, 4 + args.dense)
+
+        for i, name in enumerate(names):
+            iotype = DOT_INPUT if i == 0 else DOT_OUTPUT if i == len(names) - 1 else DOT_INTERMEDIATE
+            u32(f, i, len(name))
+            f.write(name.encode('utf-8'))
+            u32(f, iotype, DNN_FLOAT, 1, -1, -1, channels[i])
+
+        u32(f, nb_layers, len(names))
+
+if __name__ == '__main__':
+    main()
@@ -32,18 +32,29 @@ FATE_CHECKASM = fate-checkasm-aacpsdsp                                  \
                 fate-checkasm-sw_gbrp                                   \
                 fate-checkasm-sw_rgb                                    \
                 fate-checkasm-sw_scale                                  \
+                fate-checkasm-sw_yuv2rgb                                \
+                fate-checkasm-swr_dither                                \
+                fate-checkasm-swr_rematrix                              \
+                fate-checkasm-swr_resample                              \
                 fate-checkasm-utvideodsp                                \
                 fate-checkasm-v210dec                                   \
                 fate-checkasm-v210enc                                   \
                 fate-checkasm-vc1dsp                                    \
+                fate-checkasm-vf_adm                                    \
                 fate-checkasm-vf_blend                                  \
                 fate-checkasm-vf_colorspace                             \
                 fate-checkasm-vf_eq                                     \
                 fate-checkasm-vf_gblur                                  \
                 fate-checkasm-vf_hflip                                  \
+                fate-checkasm-vf_idet                                   \
                 fate-checkasm-vf_nlmeans                                \
                 fate-checkasm-vf_threshold                              \
+                fate-checkasm-vf_tmix                                   \
                 fate-checkasm-vf_sobel                                  \
+                fate-checkasm-vf_tonemap                                \
+                fate-checkasm-vf_vif                                    \
+                fate-checkasm-vf_vmafmotion                             \
+                fate-checkasm-vf_warp                                   \
                 fate-checkasm-videodsp                                  \
                 fate-checkasm-vorbisdsp                                 \
                 fate-checkasm-vp8dsp                                    \
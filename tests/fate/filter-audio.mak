@@ -183,6 +183,11 @@ fate-filter-pan-downmix2: tests/data/asynth-44100-11.wav
 fate-filter-pan-downmix2: SRC = $(TARGET_PATH)/tests/data/asynth-44100-11.wav
 fate-filter-pan-downmix2: CMD = framecrc -ss 3.14 -i $(SRC) -frames:a 20 -filter:a "pan=5C|c0=0.7*c0+0.7*c10|c1=c9|c2=c8|c3=c7|c4=c6"
 
+FATE_AFILTER-$(call FILTERDEMDECENCMUX, PAN AFORMAT ARESAMPLE ASETNSAMPLES, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-pan-fltp
+fate-filter-pan-fltp: tests/data/asynth-44100-4.wav
+fate-filter-pan-fltp: SRC = $(TARGET_PATH)/tests/data/asynth-44100-4.wav
+fate-filter-pan-fltp: CMD = framecrc -ss 3.14 -i $(SRC) -frames:a 20 -filter:a "aresample,aformat=fltp,asetnsamples=1001,pan=4C|c0=c0-0.5*c1|c1=0.25*c1+0.25*c2+0.5*c3|c2=0*c0|c3=c3,aresample,aformat=s16"
+
 FATE_AFILTER-$(call ALLYES, LAVFI_INDEV, AEVALSRC_FILTER SILENCEREMOVE_FILTER) += fate-filter-silenceremove
 fate-filter-silenceremove: CMD = framecrc -auto_conversion_filters -f lavfi -i "aevalsrc=between(t\,1\,2)+between(t\,4\,5)+between(t\,7\,9):d=10:n=8192,silenceremove=start_periods=0:start_duration=0:start_threshold=0:stop_periods=-1:stop_duration=0:stop_threshold=-90dB:window=0:detection=peak"
 
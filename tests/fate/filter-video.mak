@@ -361,6 +361,18 @@ FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 CHROMASHIFT) += fate-filter-chromash
 fate-filter-chromashift-smear: CMD = framecrc -lavfi testsrc2=r=5:d=1,chromashift=cbh=-1:cbv=1:crh=2:crv=-2:edge=smear -pix_fmt yuv420p
 fate-filter-chromashift-wrap:  CMD = framecrc -lavfi testsrc2=r=5:d=1,chromashift=cbh=-1:cbv=1:crh=2:crv=-2:edge=wrap  -pix_fmt yuv420p
 
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FORMAT LENSCORRECTION) += $(addprefix fate-filter-lenscorrection-, nearest bilinear nearest-yuv420p10)
+fate-filter-lenscorrection-nearest:          CMD = framecrc -lavfi testsrc2=s=320x240:r=5:d=1,format=yuv420p,lenscorrection=k1=-0.4:k2=0.2
+fate-filter-lenscorrection-bilinear:         CMD = framecrc -lavfi testsrc2=s=320x240:r=5:d=1,format=yuv420p,lenscorrection=k1=-0.4:k2=0.2:i=bilinear
+fate-filter-lenscorrection-nearest-yuv420p10: CMD = framecrc -lavfi testsrc2=s=320x240:r=5:d=1,format=yuv420p10le,lenscorrection=k1=-0.4:k2=0.2 -pix_fmt yuv420p10le
+
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FORMAT PERSPECTIVE) += fate-filter-perspective-linear fate-filter-perspective-cubic
+fate-filter-perspective-linear: CMD = framecrc -lavfi testsrc2=s=320x240:r=5:d=1,format=yuv420p,perspective=x0=20:y0=10:x1=300:y1=30:x2=10:y2=230:x3=310:y3=220
+fate-filter-perspective-cubic:  CMD = framecrc -lavfi testsrc2=s=320x240:r=5:d=1,format=yuv420p,perspective=x0=20:y0=10:x1=300:y1=30:x2=10:y2=230:x3=310:y3=220:interpolation=cubic
+
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 NULLSRC FORMAT GEQ REMAP) += fate-filter-remap
+fate-filter-remap: CMD = framecrc -lavfi "testsrc2=s=320x240:r=5:d=1,format=yuv444p[src]\;nullsrc=s=320x240:r=5:d=1,format=gray16,geq=lum=W-1-X+Y/8[x]\;nullsrc=s=320x240:r=5:d=1,format=gray16,geq=lum=H-1-Y+X/16[y]\;[src][x][y]remap"
+
 FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 FPS DECIMATE) += fate-filter-decimate
 fate-filter-decimate: CMD = framecrc -lavfi testsrc2=r=24:d=10,fps=60,decimate=5,decimate=4,decimate=3 -pix_fmt yuv420p
 
@@ -408,6 +420,15 @@ fate-filter-scale200: CMD = video_filter "scale=w=200:h=200"
 FATE_FILTER_VSYNTH_VIDEO_FILTER-$(CONFIG_SCALE_FILTER) += fate-filter-scale500
 fate-filter-scale500: CMD = video_filter "scale=w=500:h=500"
 
+FATE_FILTER_VSYNTH_VIDEO_FILTER-$(CONFIG_SCALE_FILTER) += fate-filter-scale200-gamma
+fate-filter-scale200-gamma: CMD = video_filter "scale=w=200:h=200:gamma=1"
+
+FATE_FILTER_VSYNTH_VIDEO_FILTER-$(CONFIG_SCALE_FILTER) += fate-filter-scale500-gamma
+fate-filter-scale500-gamma: CMD = video_filter "scale=w=500:h=500:gamma=1:threads=4"
+
+FATE_FILTER_VSYNTH_VIDEO_FILTER-$(call ALLYES, FORMAT_FILTER SCALE_FILTER) += fate-filter-scale-gamma-rgba64
+fate-filter-scale-gamma-rgba64: CMD = video_filter "scale,format=rgba64le,scale=w=200:h=200:gamma=1"
+
 FATE_FILTER_VSYNTH-$(call ALLYES, TESTSRC_FILTER SCALE2REF_FILTER NULLSINK_FILTER FRAMEMD5_MUXER FILE_PROTOCOL PIPE_PROTOCOL) += fate-filter-scale2ref_keep_aspect
 fate-filter-scale2ref_keep_aspect: tests/data/filtergraphs/scale2ref_keep_aspect
 fate-filter-scale2ref_keep_aspect: CMD = framemd5 -frames:v 5 -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/scale2ref_keep_aspect -map "[main]"
@@ -661,6 +682,55 @@ FATE_METADATA_FILTER-$(call ALLYES, $(SIGNALSTATS_DEPS)) += fate-filter-metadata
 fate-filter-metadata-signalstats-yuv420p: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;color=white:duration=1:r=1,signalstats"
 fate-filter-metadata-signalstats-yuv420p10: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;color=white:duration=1:r=1,format=yuv420p10,signalstats"
 
+QCSTATS_DEPS = LAVFI_INDEV MPTESTSRC_FILTER SCALE_FILTER QCSTATS_FILTER
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS)) += fate-filter-metadata-qcstats
+fate-filter-metadata-qcstats: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;mptestsrc=r=25:d=0.4:m=51,qcstats=crop_skip=0"
+
+# each qcstats metric must match the metadata of the standalone filter it replaces
+QCSTATS_SRC = sws_flags=+accurate_rnd+bitexact;mptestsrc=r=25:d=0.4:m=51
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) BLACKDETECT_FILTER) += fate-filter-metadata-qcstats-blackdetect fate-filter-metadata-qcstats-blackdetect-separate
+fate-filter-metadata-qcstats-blackdetect: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),qcstats=metrics=blackdetect:black_duration=0"
+fate-filter-metadata-qcstats-blackdetect-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),blackdetect=d=0"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) CROPDETECT_FILTER) += fate-filter-metadata-qcstats-cropdetect fate-filter-metadata-qcstats-cropdetect-separate
+fate-filter-metadata-qcstats-cropdetect: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),qcstats=metrics=cropdetect:crop_skip=0"
+fate-filter-metadata-qcstats-cropdetect-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),cropdetect=skip=0"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) IDET_FILTER) += fate-filter-metadata-qcstats-idet fate-filter-metadata-qcstats-idet-separate
+fate-filter-metadata-qcstats-idet: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),qcstats=metrics=idet"
+fate-filter-metadata-qcstats-idet-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),idet"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) SCDET_FILTER) += fate-filter-metadata-qcstats-scdet fate-filter-metadata-qcstats-scdet-separate
+fate-filter-metadata-qcstats-scdet: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),qcstats=metrics=scdet"
+fate-filter-metadata-qcstats-scdet-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),scdet"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) SIGNALSTATS_FILTER) += fate-filter-metadata-qcstats-signalstats fate-filter-metadata-qcstats-signalstats-separate
+fate-filter-metadata-qcstats-signalstats: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),qcstats=metrics=signalstats"
+fate-filter-metadata-qcstats-signalstats-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC),signalstats"
+# testsrc at 1 fps resampled to 25 fps, i.e. frozen for one second at a time
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) TESTSRC_FILTER FPS_FILTER FREEZEDETECT_FILTER) += fate-filter-metadata-qcstats-freezedetect fate-filter-metadata-qcstats-freezedetect-separate
+fate-filter-metadata-qcstats-freezedetect: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;testsrc=s=64x64:r=1:d=4,fps=25,qcstats=metrics=freezedetect:freeze_duration=0.5"
+fate-filter-metadata-qcstats-freezedetect-separate: CMD = run $(FILTER_METADATA_COMMAND) "sws_flags=+accurate_rnd+bitexact;testsrc=s=64x64:r=1:d=4,fps=25,freezedetect=d=0.5"
+# and at high bit depths
+QCSTATS_SRC10 = $(QCSTATS_SRC),format=yuv422p10
+QCSTATS_SRC16 = $(QCSTATS_SRC),format=yuv420p16
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) FORMAT_FILTER CROPDETECT_FILTER) += fate-filter-metadata-qcstats-cropdetect-10bit fate-filter-metadata-qcstats-cropdetect-10bit-separate
+fate-filter-metadata-qcstats-cropdetect-10bit: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),qcstats=metrics=cropdetect:crop_skip=0"
+fate-filter-metadata-qcstats-cropdetect-10bit-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),cropdetect=skip=0"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) FORMAT_FILTER CROPDETECT_FILTER) += fate-filter-metadata-qcstats-cropdetect-16bit fate-filter-metadata-qcstats-cropdetect-16bit-separate
+fate-filter-metadata-qcstats-cropdetect-16bit: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC16),qcstats=metrics=cropdetect:crop_skip=0"
+fate-filter-metadata-qcstats-cropdetect-16bit-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC16),cropdetect=skip=0"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) FORMAT_FILTER IDET_FILTER) += fate-filter-metadata-qcstats-idet-10bit fate-filter-metadata-qcstats-idet-10bit-separate
+fate-filter-metadata-qcstats-idet-10bit: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),qcstats=metrics=idet"
+fate-filter-metadata-qcstats-idet-10bit-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),idet"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) FORMAT_FILTER SCDET_FILTER) += fate-filter-metadata-qcstats-scdet-10bit fate-filter-metadata-qcstats-scdet-10bit-separate
+fate-filter-metadata-qcstats-scdet-10bit: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),qcstats=metrics=scdet"
+fate-filter-metadata-qcstats-scdet-10bit-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),scdet"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) FORMAT_FILTER SIGNALSTATS_FILTER) += fate-filter-metadata-qcstats-signalstats-10bit fate-filter-metadata-qcstats-signalstats-10bit-separate
+fate-filter-metadata-qcstats-signalstats-10bit: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),qcstats=metrics=signalstats"
+fate-filter-metadata-qcstats-signalstats-10bit-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC10),signalstats"
+FATE_METADATA_FILTER-$(call ALLYES, $(QCSTATS_DEPS) FORMAT_FILTER SIGNALSTATS_FILTER) += fate-filter-metadata-qcstats-signalstats-16bit fate-filter-metadata-qcstats-signalstats-16bit-separate
+fate-filter-metadata-qcstats-signalstats-16bit: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC16),qcstats=metrics=signalstats"
+fate-filter-metadata-qcstats-signalstats-16bit-separate: CMD = run $(FILTER_METADATA_COMMAND) "$(QCSTATS_SRC16),signalstats"
+
+fate-filter-metadata-qcstats-%-separate: REF = $(SRC_PATH)/tests/ref/fate/$(@:fate-filter-metadata-qcstats-%-separate=filter-metadata-qcstats-%)
+
 SILENCEDETECT_DEPS = LAVFI_INDEV FILE_PROTOCOL AMOVIE_FILTER TTA_DEMUXER TTA_DECODER SILENCEDETECT_FILTER
 FATE_METADATA_FILTER-$(call ALLYES, $(SILENCEDETECT_DEPS)) += fate-filter-metadata-silencedetect
 fate-filter-metadata-silencedetect: SRC = $(TARGET_SAMPLES)/lossless-audio/inside.tta
@@ -367,16 +367,16 @@ fate-swr-resample_async-$(3)-$(1)-$(2): FUZZ = 0.1
 fate-swr-resample_async-$(3)-$(1)-$(2): REF = tests/data/asynth-$(1)-1.wav
 endef
 
-fate-swr-resample_async-fltp-44100-8000: CMP_TARGET = 4020.60
+fate-swr-resample_async-fltp-44100-8000: CMP_TARGET = 4017.31
 fate-swr-resample_async-fltp-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_async-fltp-8000-44100: CMP_TARGET = 11186.66
+fate-swr-resample_async-fltp-8000-44100: CMP_TARGET = 11188.27
 fate-swr-resample_async-fltp-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_async-s16p-44100-8000: CMP_TARGET = 4020.71
+fate-swr-resample_async-s16p-44100-8000: CMP_TARGET = 4017.41
 fate-swr-resample_async-s16p-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_async-s16p-8000-44100: CMP_TARGET = 11186.94
+fate-swr-resample_async-s16p-8000-44100: CMP_TARGET = 11188.55
 fate-swr-resample_async-s16p-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
 define ARESAMPLE_EXACT
@@ -641,76 +641,76 @@ fate-swr-resample_exact_async-$(3)-$(1)-$(2): FUZZ = 0.1
 fate-swr-resample_exact_async-$(3)-$(1)-$(2): REF = tests/data/asynth-$(1)-1.wav
 endef
 
-fate-swr-resample_exact_async-dblp-44100-48000: CMP_TARGET = 7791.50
+fate-swr-resample_exact_async-dblp-44100-48000: CMP_TARGET = 7781.38
 fate-swr-resample_exact_async-dblp-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_async-dblp-44100-8000: CMP_TARGET = 4022.87
+fate-swr-resample_exact_async-dblp-44100-8000: CMP_TARGET = 4019.69
 fate-swr-resample_exact_async-dblp-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_async-dblp-48000-44100: CMP_TARGET = 1923.97
+fate-swr-resample_exact_async-dblp-48000-44100: CMP_TARGET = 1963.18
 fate-swr-resample_exact_async-dblp-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_async-dblp-48000-8000: CMP_TARGET = 2592.00
+fate-swr-resample_exact_async-dblp-48000-8000: CMP_TARGET = 2696.78
 fate-swr-resample_exact_async-dblp-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_async-dblp-8000-44100: CMP_TARGET = 11187.24
+fate-swr-resample_exact_async-dblp-8000-44100: CMP_TARGET = 11188.87
 fate-swr-resample_exact_async-dblp-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-dblp-8000-48000: CMP_TARGET = 11326.80
+fate-swr-resample_exact_async-dblp-8000-48000: CMP_TARGET = 11327.11
 fate-swr-resample_exact_async-dblp-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-fltp-44100-48000: CMP_TARGET = 7791.50
+fate-swr-resample_exact_async-fltp-44100-48000: CMP_TARGET = 7781.38
 fate-swr-resample_exact_async-fltp-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_async-fltp-44100-8000: CMP_TARGET = 4022.87
+fate-swr-resample_exact_async-fltp-44100-8000: CMP_TARGET = 4019.69
 fate-swr-resample_exact_async-fltp-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_async-fltp-48000-44100: CMP_TARGET = 1923.97
+fate-swr-resample_exact_async-fltp-48000-44100: CMP_TARGET = 1963.18
 fate-swr-resample_exact_async-fltp-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_async-fltp-48000-8000: CMP_TARGET = 2592.00
+fate-swr-resample_exact_async-fltp-48000-8000: CMP_TARGET = 2696.78
 fate-swr-resample_exact_async-fltp-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_async-fltp-8000-44100: CMP_TARGET = 11187.24
+fate-swr-resample_exact_async-fltp-8000-44100: CMP_TARGET = 11188.87
 fate-swr-resample_exact_async-fltp-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-fltp-8000-48000: CMP_TARGET = 11326.80
+fate-swr-resample_exact_async-fltp-8000-48000: CMP_TARGET = 11327.11
 fate-swr-resample_exact_async-fltp-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-s16p-44100-48000: CMP_TARGET = 7791.50
+fate-swr-resample_exact_async-s16p-44100-48000: CMP_TARGET = 7781.38
 fate-swr-resample_exact_async-s16p-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_async-s16p-44100-8000: CMP_TARGET = 4023.05
+fate-swr-resample_exact_async-s16p-44100-8000: CMP_TARGET = 4019.87
 fate-swr-resample_exact_async-s16p-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_async-s16p-48000-44100: CMP_TARGET = 1923.96
+fate-swr-resample_exact_async-s16p-48000-44100: CMP_TARGET = 1963.17
 fate-swr-resample_exact_async-s16p-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_async-s16p-48000-8000: CMP_TARGET = 2592.15
+fate-swr-resample_exact_async-s16p-48000-8000: CMP_TARGET = 2696.92
 fate-swr-resample_exact_async-s16p-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_async-s16p-8000-44100: CMP_TARGET = 11187.58
+fate-swr-resample_exact_async-s16p-8000-44100: CMP_TARGET = 11189.21
 fate-swr-resample_exact_async-s16p-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-s16p-8000-48000: CMP_TARGET = 11327.48
+fate-swr-resample_exact_async-s16p-8000-48000: CMP_TARGET = 11327.78
 fate-swr-resample_exact_async-s16p-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-s32p-44100-48000: CMP_TARGET = 7791.50
+fate-swr-resample_exact_async-s32p-44100-48000: CMP_TARGET = 7781.38
 fate-swr-resample_exact_async-s32p-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_async-s32p-44100-8000: CMP_TARGET = 4022.87
+fate-swr-resample_exact_async-s32p-44100-8000: CMP_TARGET = 4019.70
 fate-swr-resample_exact_async-s32p-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_async-s32p-48000-44100: CMP_TARGET = 1923.96
+fate-swr-resample_exact_async-s32p-48000-44100: CMP_TARGET = 1963.17
 fate-swr-resample_exact_async-s32p-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_async-s32p-48000-8000: CMP_TARGET = 2592.00
+fate-swr-resample_exact_async-s32p-48000-8000: CMP_TARGET = 2696.78
 fate-swr-resample_exact_async-s32p-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_async-s32p-8000-44100: CMP_TARGET = 11187.24
+fate-swr-resample_exact_async-s32p-8000-44100: CMP_TARGET = 11188.87
 fate-swr-resample_exact_async-s32p-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_async-s32p-8000-48000: CMP_TARGET = 11326.79
+fate-swr-resample_exact_async-s32p-8000-48000: CMP_TARGET = 11327.10
 fate-swr-resample_exact_async-s32p-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
 define ARESAMPLE_EXACT_LIN
@@ -975,76 +975,76 @@ fate-swr-resample_exact_lin_async-$(3)-$(1)-$(2): FUZZ = 0.1
 fate-swr-resample_exact_lin_async-$(3)-$(1)-$(2): REF = tests/data/asynth-$(1)-1.wav
 endef
 
-fate-swr-resample_exact_lin_async-dblp-44100-48000: CMP_TARGET = 7791.72
+fate-swr-resample_exact_lin_async-dblp-44100-48000: CMP_TARGET = 7781.39
 fate-swr-resample_exact_lin_async-dblp-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_lin_async-dblp-44100-8000: CMP_TARGET = 4023.01
+fate-swr-resample_exact_lin_async-dblp-44100-8000: CMP_TARGET = 4019.69
 fate-swr-resample_exact_lin_async-dblp-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_lin_async-dblp-48000-44100: CMP_TARGET = 1923.79
+fate-swr-resample_exact_lin_async-dblp-48000-44100: CMP_TARGET = 1963.18
 fate-swr-resample_exact_lin_async-dblp-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_lin_async-dblp-48000-8000: CMP_TARGET = 2591.72
+fate-swr-resample_exact_lin_async-dblp-48000-8000: CMP_TARGET = 2696.53
 fate-swr-resample_exact_lin_async-dblp-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_lin_async-dblp-8000-44100: CMP_TARGET = 11187.24
+fate-swr-resample_exact_lin_async-dblp-8000-44100: CMP_TARGET = 11188.86
 fate-swr-resample_exact_lin_async-dblp-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-dblp-8000-48000: CMP_TARGET = 11326.80
+fate-swr-resample_exact_lin_async-dblp-8000-48000: CMP_TARGET = 11327.10
 fate-swr-resample_exact_lin_async-dblp-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-fltp-44100-48000: CMP_TARGET = 7791.72
+fate-swr-resample_exact_lin_async-fltp-44100-48000: CMP_TARGET = 7781.39
 fate-swr-resample_exact_lin_async-fltp-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_lin_async-fltp-44100-8000: CMP_TARGET = 4023.01
+fate-swr-resample_exact_lin_async-fltp-44100-8000: CMP_TARGET = 4019.69
 fate-swr-resample_exact_lin_async-fltp-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_lin_async-fltp-48000-44100: CMP_TARGET = 1923.79
+fate-swr-resample_exact_lin_async-fltp-48000-44100: CMP_TARGET = 1963.18
 fate-swr-resample_exact_lin_async-fltp-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_lin_async-fltp-48000-8000: CMP_TARGET = 2591.72
+fate-swr-resample_exact_lin_async-fltp-48000-8000: CMP_TARGET = 2696.53
 fate-swr-resample_exact_lin_async-fltp-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_lin_async-fltp-8000-44100: CMP_TARGET = 11187.25
+fate-swr-resample_exact_lin_async-fltp-8000-44100: CMP_TARGET = 11188.86
 fate-swr-resample_exact_lin_async-fltp-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-fltp-8000-48000: CMP_TARGET = 11326.80
+fate-swr-resample_exact_lin_async-fltp-8000-48000: CMP_TARGET = 11327.10
 fate-swr-resample_exact_lin_async-fltp-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-s16p-44100-48000: CMP_TARGET = 7791.72
+fate-swr-resample_exact_lin_async-s16p-44100-48000: CMP_TARGET = 7781.39
 fate-swr-resample_exact_lin_async-s16p-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_lin_async-s16p-44100-8000: CMP_TARGET = 4023.19
+fate-swr-resample_exact_lin_async-s16p-44100-8000: CMP_TARGET = 4019.87
 fate-swr-resample_exact_lin_async-s16p-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_lin_async-s16p-48000-44100: CMP_TARGET = 1923.79
+fate-swr-resample_exact_lin_async-s16p-48000-44100: CMP_TARGET = 1963.17
 fate-swr-resample_exact_lin_async-s16p-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_lin_async-s16p-48000-8000: CMP_TARGET = 2591.85
+fate-swr-resample_exact_lin_async-s16p-48000-8000: CMP_TARGET = 2696.72
 fate-swr-resample_exact_lin_async-s16p-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_lin_async-s16p-8000-44100: CMP_TARGET = 11187.57
+fate-swr-resample_exact_lin_async-s16p-8000-44100: CMP_TARGET = 11189.19
 fate-swr-resample_exact_lin_async-s16p-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-s16p-8000-48000: CMP_TARGET = 11327.48
+fate-swr-resample_exact_lin_async-s16p-8000-48000: CMP_TARGET = 11327.78
 fate-swr-resample_exact_lin_async-s16p-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-s32p-44100-48000: CMP_TARGET = 7791.72
+fate-swr-resample_exact_lin_async-s32p-44100-48000: CMP_TARGET = 7781.39
 fate-swr-resample_exact_lin_async-s32p-44100-48000: SIZE_TOLERANCE = 529200 - 20300
 
-fate-swr-resample_exact_lin_async-s32p-44100-8000: CMP_TARGET = 4023.02
+fate-swr-resample_exact_lin_async-s32p-44100-8000: CMP_TARGET = 4019.70
 fate-swr-resample_exact_lin_async-s32p-44100-8000: SIZE_TOLERANCE = 529200 - 20310
 
-fate-swr-resample_exact_lin_async-s32p-48000-44100: CMP_TARGET = 1923.77
+fate-swr-resample_exact_lin_async-s32p-48000-44100: CMP_TARGET = 1963.17
 fate-swr-resample_exact_lin_async-s32p-48000-44100: SIZE_TOLERANCE = 576000 - 20298
 
-fate-swr-resample_exact_lin_async-s32p-48000-8000: CMP_TARGET = 2591.71
+fate-swr-resample_exact_lin_async-s32p-48000-8000: CMP_TARGET = 2696.53
 fate-swr-resample_exact_lin_async-s32p-48000-8000: SIZE_TOLERANCE = 576000 - 20304
 
-fate-swr-resample_exact_lin_async-s32p-8000-44100: CMP_TARGET = 11187.25
+fate-swr-resample_exact_lin_async-s32p-8000-44100: CMP_TARGET = 11188.86
 fate-swr-resample_exact_lin_async-s32p-8000-44100: SIZE_TOLERANCE = 96000 - 20344
 
-fate-swr-resample_exact_lin_async-s32p-8000-48000: CMP_TARGET = 11326.81
+fate-swr-resample_exact_lin_async-s32p-8000-48000: CMP_TARGET = 11327.11
 fate-swr-resample_exact_lin_async-s32p-8000-48000: SIZE_TOLERANCE = 96000 - 20344
 
 $(call CROSS_TEST,$(SAMPLERATES),ARESAMPLE,s16p,s16le,s16)
@@ -1094,5 +1094,27 @@ fate-swr-audioconvert: CMP = stddev
 fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
+
+# 5.1 to mono mixes 5 inputs, with a gain of 1.0 and saturation for s16p
+FATE_SWR_REMATRIX-$(call FILTERDEMDECENCMUX, ARESAMPLE AFORMAT, WAV, PCM_S16LE, PCM_S16LE, PCM_S16LE) += fate-swr-rematrix-s16p
+fate-swr-rematrix-s16p: tests/data/asynth-44100-6.wav
+fate-swr-rematrix-s16p: CMD = md5 -guess_layout_max 6 -i $(TARGET_PATH)/tests/data/asynth-44100-6.wav -af aresample=internal_sample_fmt=s16p:rematrix_maxval=4:rematrix_volume=1,aformat=sample_fmts=s16:channel_layouts=mono -f s16le
+
+FATE_SWR_REMATRIX-$(call FILTERDEMDECENCMUX, ARESAMPLE AFORMAT, WAV, PCM_S16LE, PCM_S32LE, PCM_S32LE) += fate-swr-rematrix-s32p
+fate-swr-rematrix-s32p: tests/data/asynth-44100-6.wav
+fate-swr-rematrix-s32p: CMD = md5 -guess_layout_max 6 -i $(TARGET_PATH)/tests/data/asynth-44100-6.wav -af aresample=internal_sample_fmt=s32p,aformat=sample_fmts=s32:channel_layouts=mono -f s32le
+
+fate-swr-rematrix: $(FATE_SWR_REMATRIX-yes)
+FATE_SWR += $(FATE_SWR_REMATRIX-yes)
 FATE_FFMPEG += $(FATE_SWR)
-fate-swr: $(FATE_SWR)
+
+FATE_LIBSWRESAMPLE += fate-swr-drift
+fate-swr-drift: libswresample/tests/drift$(EXESUF)
+fate-swr-drift: CMD = run libswresample/tests/drift$(EXESUF)
+
+FATE_LIBSWRESAMPLE += fate-swr-latency
+fate-swr-latency: libswresample/tests/latency$(EXESUF)
+fate-swr-latency: CMD = run libswresample/tests/latency$(EXESUF)
+
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_LIBSWRESAMPLE)
+fate-swr: $(FATE_SWR) $(FATE_LIBSWRESAMPLE)
@@ -2,6 +2,10 @@ FATE_LIBSWSCALE += fate-sws-pixdesc-query
 fate-sws-pixdesc-query: libswscale/tests/pixdesc_query$(EXESUF)
 fate-sws-pixdesc-query: CMD = run libswscale/tests/pixdesc_query$(EXESUF)
 
+FATE_LIBSWSCALE += fate-sws-clone
+fate-sws-clone: libswscale/tests/clone$(EXESUF)
+fate-sws-clone: CMD = run libswscale/tests/clone$(EXESUF)
+
 FATE_LIBSWSCALE += fate-sws-floatimg-cmp
 fate-sws-floatimg-cmp: libswscale/tests/floatimg_cmp$(EXESUF)
 fate-sws-floatimg-cmp: CMD = run libswscale/tests/floatimg_cmp$(EXESUF)
@@ -33,6 +37,33 @@ fate-sws-yuv-range: CMD = framecrc \
   -frames 1 \
   -vf scale=in_color_matrix=bt601:in_range=limited:out_color_matrix=bt601:out_range=full:flags=+accurate_rnd+bitexact
 
+# unscaled converters of 10 to 16-bit packed and semi-planar formats
+SWS_UNSCALED_PAIRS = p010le-yuv420p10le yuv420p10le-p010le \
+                     p012le-yuv420p12le yuv420p12le-p012le \
+                     p016le-yuv420p16le yuv420p16le-p016le \
+                     p210le-yuv422p10le yuv422p10le-p210le \
+                     p216le-yuv422p16le yuv422p16le-p216le \
+                     p410le-yuv444p10le yuv444p10le-p410le \
+                     p416le-yuv444p16le yuv444p16le-p416le \
+                     y210le-yuv422p10le yuv422p10le-y210le \
+                     y210le-p210le                         \
+                     xv30le-yuv444p10le yuv444p10le-xv30le \
+                     x2rgb10le-gbrp10le gbrp10le-x2rgb10le \
+                     x2bgr10le-gbrp10le gbrp10le-x2bgr10le
+
+define SWS_UNSCALED
+FATE_SWS_UNSCALED += fate-sws-unscaled-$(1)-$(2)
+fate-sws-unscaled-$(1)-$(2): tests/data/vsynth1.yuv
+fate-sws-unscaled-$(1)-$(2): CMD = framecrc \
+  -f rawvideo -s 352x288 -pix_fmt yuv420p -i $(TARGET_PATH)/tests/data/vsynth1.yuv \
+  -frames 1 -vf crop=350:288:0:0,scale,format=$(1),scale=flags=+bitexact,format=$(2)
+endef
+
+$(foreach P,$(SWS_UNSCALED_PAIRS),$(eval $(call SWS_UNSCALED,$(firstword $(subst -, ,$(P))),$(lastword $(subst -, ,$(P))))))
+
+FATE_LIBSWSCALE-$(call ALLYES, RAWVIDEO_DEMUXER CROP_FILTER FORMAT_FILTER SCALE_FILTER) += $(FATE_SWS_UNSCALED)
+fate-sws-unscaled: $(FATE_SWS_UNSCALED)
+
 FATE_LIBSWSCALE += $(FATE_LIBSWSCALE-yes)
 FATE_LIBSWSCALE_SAMPLES += $(FATE_LIBSWSCALE_SAMPLES-yes)
 FATE-$(CONFIG_SWSCALE) += $(FATE_LIBSWSCALE)